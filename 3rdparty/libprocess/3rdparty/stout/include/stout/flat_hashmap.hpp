@@ -0,0 +1,482 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __STOUT_FLAT_HASHMAP_HPP__
+#define __STOUT_FLAT_HASHMAP_HPP__
+
+#include <stdint.h>
+
+#include <functional>
+#include <iterator>
+#include <list>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "foreach.hpp"
+#include "hashset.hpp"
+#include "none.hpp"
+#include "option.hpp"
+
+
+// A hash map with open addressing that stores its entries in one
+// flat allocation, as an opt-in alternative to 'hashmap' (which
+// wraps the node-based 'std::unordered_map' and allocates a node
+// per entry). Collisions are resolved with robin hood hashing and
+// deletions use backward shifting, keeping probe sequences short and
+// lookups on contiguous memory; this matters for maps walked in hot
+// loops, like the allocator's.
+//
+// The convenience interface matches 'hashmap' (contains, put, get,
+// keys, values, ...) along with the commonly used parts of the
+// standard interface. Semantic differences from 'hashmap':
+//
+//   1) Insertion and erasure invalidate all iterators and
+//      references, since entries are stored (and moved) in the flat
+//      allocation.
+//   2) Iterators expose the key as non-const; mutating it corrupts
+//      the map.
+//   3) Keys and values must be movable.
+template <typename Key,
+          typename Value,
+          typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class flat_hashmap
+{
+public:
+  typedef std::pair<Key, Value> value_type;
+
+private:
+  template <bool is_const>
+  class iterator_base
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef flat_hashmap::value_type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef typename std::conditional<
+        is_const, const value_type*, value_type*>::type pointer;
+    typedef typename std::conditional<
+        is_const, const value_type&, value_type&>::type reference;
+
+    typedef typename std::conditional<
+        is_const, const flat_hashmap, flat_hashmap>::type map_type;
+
+    iterator_base() : map(NULL), index(0) {}
+
+    iterator_base(map_type* _map, size_t _index)
+      : map(_map), index(_index)
+    {
+      skip();
+    }
+
+    // Allow converting a mutable iterator to a const iterator.
+    iterator_base(const iterator_base<false>& that)
+      : map(that.map), index(that.index) {}
+
+    reference operator*() const { return map->entries[index]; }
+    pointer operator->() const { return &map->entries[index]; }
+
+    iterator_base& operator++()
+    {
+      index++;
+      skip();
+      return *this;
+    }
+
+    iterator_base operator++(int)
+    {
+      iterator_base result = *this;
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const iterator_base& that) const
+    {
+      return index == that.index;
+    }
+
+    bool operator!=(const iterator_base& that) const
+    {
+      return index != that.index;
+    }
+
+  private:
+    friend class flat_hashmap;
+    friend class iterator_base<true>;
+
+    // Advances to the next occupied slot (or the end).
+    void skip()
+    {
+      while (index < map->capacity && map->distances[index] == 0) {
+        index++;
+      }
+    }
+
+    map_type* map;
+    size_t index;
+  };
+
+public:
+  typedef iterator_base<false> iterator;
+  typedef iterator_base<true> const_iterator;
+
+  flat_hashmap() : entries(NULL), capacity(0), occupied(0) {}
+
+  flat_hashmap(std::initializer_list<std::pair<Key, Value>> list)
+    : entries(NULL), capacity(0), occupied(0)
+  {
+    for (auto iterator = list.begin(); iterator != list.end(); ++iterator) {
+      put(iterator->first, iterator->second);
+    }
+  }
+
+  flat_hashmap(const flat_hashmap& that)
+    : entries(NULL), capacity(0), occupied(0)
+  {
+    foreachpair (const Key& key, const Value& value, that) {
+      put(key, value);
+    }
+  }
+
+  flat_hashmap(flat_hashmap&& that)
+    : distances(std::move(that.distances)),
+      entries(that.entries),
+      capacity(that.capacity),
+      occupied(that.occupied)
+  {
+    that.entries = NULL;
+    that.capacity = 0;
+    that.occupied = 0;
+  }
+
+  flat_hashmap& operator=(const flat_hashmap& that)
+  {
+    if (this != &that) {
+      clear();
+      foreachpair (const Key& key, const Value& value, that) {
+        put(key, value);
+      }
+    }
+    return *this;
+  }
+
+  flat_hashmap& operator=(flat_hashmap&& that)
+  {
+    if (this != &that) {
+      destroy();
+      distances = std::move(that.distances);
+      entries = that.entries;
+      capacity = that.capacity;
+      occupied = that.occupied;
+      that.entries = NULL;
+      that.capacity = 0;
+      that.occupied = 0;
+    }
+    return *this;
+  }
+
+  ~flat_hashmap()
+  {
+    destroy();
+  }
+
+  size_t size() const { return occupied; }
+  bool empty() const { return occupied == 0; }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, capacity); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, capacity); }
+
+  iterator find(const Key& key)
+  {
+    return iterator(this, indexOf(key));
+  }
+
+  const_iterator find(const Key& key) const
+  {
+    return const_iterator(this, indexOf(key));
+  }
+
+  size_t count(const Key& key) const
+  {
+    return indexOf(key) == capacity ? 0 : 1;
+  }
+
+  Value& operator[](const Key& key)
+  {
+    size_t index = indexOf(key);
+    if (index != capacity) {
+      return entries[index].second;
+    }
+    return insert_(Key(key), Value());
+  }
+
+  Value& at(const Key& key)
+  {
+    size_t index = indexOf(key);
+    if (index == capacity) {
+      throw std::out_of_range("flat_hashmap::at");
+    }
+    return entries[index].second;
+  }
+
+  const Value& at(const Key& key) const
+  {
+    size_t index = indexOf(key);
+    if (index == capacity) {
+      throw std::out_of_range("flat_hashmap::at");
+    }
+    return entries[index].second;
+  }
+
+  std::pair<iterator, bool> insert(const value_type& entry)
+  {
+    size_t index = indexOf(entry.first);
+    if (index != capacity) {
+      return std::make_pair(iterator(this, index), false);
+    }
+
+    insert_(Key(entry.first), Value(entry.second));
+    return std::make_pair(find(entry.first), true);
+  }
+
+  size_t erase(const Key& key)
+  {
+    size_t index = indexOf(key);
+    if (index == capacity) {
+      return 0;
+    }
+
+    erase_(index);
+    return 1;
+  }
+
+  void clear()
+  {
+    for (size_t i = 0; i < capacity; i++) {
+      if (distances[i] != 0) {
+        entries[i].~value_type();
+        distances[i] = 0;
+      }
+    }
+    occupied = 0;
+  }
+
+  // Checks whether this map contains a binding for a key.
+  bool contains(const Key& key) const
+  {
+    return count(key) > 0;
+  }
+
+  // Checks whether there exists a bound value in this map.
+  bool containsValue(const Value& v) const
+  {
+    foreachvalue (const Value& value, *this) {
+      if (value == v) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Inserts a key, value pair into the map replacing an old value
+  // if the key is already present.
+  void put(const Key& key, const Value& value)
+  {
+    size_t index = indexOf(key);
+    if (index != capacity) {
+      entries[index].second = value;
+    } else {
+      insert_(Key(key), Value(value));
+    }
+  }
+
+  // Returns an Option for the binding to the key.
+  Option<Value> get(const Key& key) const
+  {
+    size_t index = indexOf(key);
+    if (index == capacity) {
+      return None();
+    }
+    return entries[index].second;
+  }
+
+  // Returns the set of keys in this map.
+  hashset<Key> keys() const
+  {
+    hashset<Key> result;
+    foreachkey (const Key& key, *this) {
+      result.insert(key);
+    }
+    return result;
+  }
+
+  // Returns the list of values in this map.
+  std::list<Value> values() const
+  {
+    std::list<Value> result;
+    foreachvalue (const Value& value, *this) {
+      result.push_back(value);
+    }
+    return result;
+  }
+
+private:
+  // Returns the slot holding 'key', or 'capacity' if not present.
+  // With robin hood hashing a probe can stop as soon as it reaches
+  // an entry closer to its ideal slot than the probed key would be.
+  size_t indexOf(const Key& key) const
+  {
+    if (capacity == 0) {
+      return capacity;
+    }
+
+    size_t index = Hash()(key) & (capacity - 1);
+    uint32_t distance = 1; // Stored distances are offset by one.
+
+    while (true) {
+      uint32_t stored = distances[index];
+
+      if (stored == 0 || stored < distance) {
+        return capacity;
+      }
+
+      if (Equal()(entries[index].first, key)) {
+        return index;
+      }
+
+      index = (index + 1) & (capacity - 1);
+      distance++;
+    }
+  }
+
+  // Inserts an entry whose key is known not to be present, claiming
+  // slots from entries closer to their ideal slot (robin hood).
+  Value& insert_(Key key, Value value)
+  {
+    reserveFor(occupied + 1);
+
+    size_t index = Hash()(key) & (capacity - 1);
+    uint32_t distance = 1;
+
+    // The slot where the inserted key ended up (it may subsequently
+    // displace other entries further down the probe sequence).
+    size_t inserted = capacity;
+
+    while (true) {
+      uint32_t stored = distances[index];
+
+      if (stored == 0) {
+        new (&entries[index]) value_type(std::move(key), std::move(value));
+        distances[index] = distance;
+        occupied++;
+        return entries[inserted == capacity ? index : inserted].second;
+      }
+
+      if (stored < distance) {
+        std::swap(entries[index].first, key);
+        std::swap(entries[index].second, value);
+        std::swap(distances[index], distance);
+
+        if (inserted == capacity) {
+          inserted = index;
+        }
+      }
+
+      index = (index + 1) & (capacity - 1);
+      distance++;
+    }
+  }
+
+  // Removes the entry at 'index', shifting the following probe
+  // sequence backwards so no tombstones are left behind.
+  void erase_(size_t index)
+  {
+    entries[index].~value_type();
+    distances[index] = 0;
+
+    size_t next = (index + 1) & (capacity - 1);
+
+    while (distances[next] > 1) {
+      new (&entries[index]) value_type(std::move(entries[next]));
+      entries[next].~value_type();
+      distances[index] = distances[next] - 1;
+      distances[next] = 0;
+
+      index = next;
+      next = (next + 1) & (capacity - 1);
+    }
+
+    occupied--;
+  }
+
+  // Grows the table when adding 'size' entries would exceed the
+  // maximum load factor (3/4).
+  void reserveFor(size_t size)
+  {
+    if (capacity == 0) {
+      allocate(16);
+      return;
+    }
+
+    if (size * 4 > capacity * 3) {
+      std::vector<uint32_t> oldDistances = std::move(distances);
+      value_type* oldEntries = entries;
+      size_t oldCapacity = capacity;
+
+      allocate(capacity * 2);
+      occupied = 0;
+
+      for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldDistances[i] != 0) {
+          insert_(
+              std::move(oldEntries[i].first),
+              std::move(oldEntries[i].second));
+          oldEntries[i].~value_type();
+        }
+      }
+
+      ::operator delete(oldEntries);
+    }
+  }
+
+  void allocate(size_t _capacity)
+  {
+    distances.assign(_capacity, 0);
+    entries = static_cast<value_type*>(
+        ::operator new(sizeof(value_type) * _capacity));
+    capacity = _capacity;
+  }
+
+  void destroy()
+  {
+    clear();
+    ::operator delete(entries);
+    entries = NULL;
+    capacity = 0;
+  }
+
+  // Probe distance (offset by one) per slot; zero marks an empty
+  // slot. Kept separate from the entries so that probing scans a
+  // dense array and entries need not be default constructible.
+  std::vector<uint32_t> distances;
+
+  value_type* entries;
+  size_t capacity;
+  size_t occupied;
+};
+
+#endif // __STOUT_FLAT_HASHMAP_HPP__
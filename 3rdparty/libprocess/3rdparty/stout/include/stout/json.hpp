@@ -22,12 +22,15 @@
 #include <picojson.h>
 #define __STDC_FORMAT_MACROS
 
+#include <cstdlib>
+
 #include <iomanip>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <boost/type_traits/is_arithmetic.hpp>
@@ -37,6 +40,7 @@
 #include <stout/check.hpp>
 #include <stout/foreach.hpp>
 #include <stout/numify.hpp>
+#include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
@@ -697,66 +701,455 @@ inline std::ostream& operator<<(std::ostream& out, const Null&)
 
 namespace internal {
 
-inline Value convert(const picojson::value& value)
-{
-  if (value.is<picojson::null>()) {
-    return Null();
-  } else if (value.is<bool>()) {
-    return Boolean(value.get<bool>());
-  } else if (value.is<picojson::value::object>()) {
-    Object object;
-    foreachpair (const std::string& name,
-                 const picojson::value& value,
-                 value.get<picojson::value::object>()) {
-      object.values[name] = convert(value);
-    }
-    return object;
-  } else if (value.is<picojson::value::array>()) {
-    Array array;
-    foreach (const picojson::value& value,
-             value.get<picojson::value::array>()) {
-      array.values.push_back(convert(value));
-    }
-    return array;
-  } else if (value.is<int64_t>()) {
-    return Number(value.get<int64_t>());
-  } else if (value.is<double>()) {
-    return Number(value.get<double>());
-  } else if (value.is<std::string>()) {
-    return String(value.get<std::string>());
-  }
-  return Null();
-}
+// A single pass recursive descent parser which builds the resulting
+// 'JSON::Value' directly. Parsing through PicoJson materializes a
+// complete 'picojson::value' tree which then has to be converted into
+// 'JSON::Value', copying every string and re-inserting every object
+// and array member; workloads that parse large documents (e.g.,
+// Docker image manifests, master state endpoints) are measurably
+// allocation-bound on that intermediate tree.
+//
+// The grammar accepted is that of RFC 4627, with the same semantics
+// as parsing through PicoJson: integers that fit in a signed 64-bit
+// value parse as Number::SIGNED_INTEGER and everything else parses as
+// a double, and the first of any duplicate object keys wins.
+class Parser
+{
+public:
+  Parser(const char* begin, const char* _end)
+    : position(begin), end(_end) {}
+
+  Try<Value> parse()
+  {
+    skipWhitespace();
+
+    Value value;
+
+    Option<Error> error = parseValue(&value);
+    if (error.isSome()) {
+      return error.get();
+    }
+
+    skipWhitespace();
+
+    return value;
+  }
+
+  // Returns the position of the first character not consumed by
+  // 'parse' so that callers can check for trailing garbage.
+  const char* remaining() const { return position; }
+
+private:
+  void skipWhitespace()
+  {
+    while (position != end &&
+           (*position == ' ' || *position == '\t' ||
+            *position == '\r' || *position == '\n')) {
+      ++position;
+    }
+  }
+
+  // Consumes the given literal (e.g., "true"), returning false
+  // without consuming anything if the input does not match.
+  bool consume(const char* literal)
+  {
+    const char* current = position;
+
+    while (*literal != '\0') {
+      if (current == end || *current != *literal) {
+        return false;
+      }
+      ++current;
+      ++literal;
+    }
+
+    position = current;
+    return true;
+  }
+
+  Option<Error> parseValue(Value* value)
+  {
+    if (position == end) {
+      return Error("Unexpected end of JSON input");
+    }
+
+    switch (*position) {
+      case '{':
+        return parseObject(value);
+      case '[':
+        return parseArray(value);
+      case '"': {
+        *value = String();
+        return parseString(&boost::get<String>(value)->value);
+      }
+      case 't':
+        if (!consume("true")) {
+          return Error("Expected 'true' in JSON input");
+        }
+        *value = Boolean(true);
+        return None();
+      case 'f':
+        if (!consume("false")) {
+          return Error("Expected 'false' in JSON input");
+        }
+        *value = Boolean(false);
+        return None();
+      case 'n':
+        if (!consume("null")) {
+          return Error("Expected 'null' in JSON input");
+        }
+        *value = Null();
+        return None();
+      default:
+        return parseNumber(value);
+    }
+  }
+
+  Option<Error> parseObject(Value* value)
+  {
+    ++position; // Consume '{'.
+
+    *value = Object();
+    Object* object = boost::get<Object>(value);
+
+    skipWhitespace();
+
+    if (position != end && *position == '}') {
+      ++position;
+      return None();
+    }
+
+    while (true) {
+      skipWhitespace();
+
+      if (position == end || *position != '"') {
+        return Error("Expected string key in JSON object");
+      }
+
+      std::string key;
+
+      Option<Error> error = parseString(&key);
+      if (error.isSome()) {
+        return error;
+      }
+
+      skipWhitespace();
+
+      if (position == end || *position != ':') {
+        return Error("Expected ':' in JSON object");
+      }
+
+      ++position;
+      skipWhitespace();
+
+      // NOTE: As with PicoJson, the first of any duplicate keys
+      // wins; later values are still parsed (to consume the input)
+      // but discarded.
+      std::pair<std::map<std::string, Value>::iterator, bool> entry =
+        object->values.insert(std::make_pair(key, Value()));
+
+      Value discarded;
+
+      error = parseValue(entry.second ? &entry.first->second : &discarded);
+      if (error.isSome()) {
+        return error;
+      }
+
+      skipWhitespace();
+
+      if (position != end && *position == ',') {
+        ++position;
+      } else if (position != end && *position == '}') {
+        ++position;
+        return None();
+      } else {
+        return Error("Expected ',' or '}' in JSON object");
+      }
+    }
+  }
+
+  Option<Error> parseArray(Value* value)
+  {
+    ++position; // Consume '['.
+
+    *value = Array();
+    Array* array = boost::get<Array>(value);
+
+    skipWhitespace();
+
+    if (position != end && *position == ']') {
+      ++position;
+      return None();
+    }
+
+    while (true) {
+      skipWhitespace();
+
+      array->values.push_back(Value());
+
+      Option<Error> error = parseValue(&array->values.back());
+      if (error.isSome()) {
+        return error;
+      }
+
+      skipWhitespace();
+
+      if (position != end && *position == ',') {
+        ++position;
+      } else if (position != end && *position == ']') {
+        ++position;
+        return None();
+      } else {
+        return Error("Expected ',' or ']' in JSON array");
+      }
+    }
+  }
+
+  // Parses the contents of a string (assumes '*position' is the
+  // opening '"'), appending the unescaped characters to 'result'.
+  Option<Error> parseString(std::string* result)
+  {
+    ++position; // Consume '"'.
+
+    while (position != end) {
+      unsigned char c = static_cast<unsigned char>(*position);
+
+      if (c == '"') {
+        ++position;
+        return None();
+      } else if (c == '\\') {
+        ++position;
+
+        Option<Error> error = parseEscape(result);
+        if (error.isSome()) {
+          return error;
+        }
+      } else if (c < 0x20) {
+        return Error("Unescaped control character in JSON string");
+      } else {
+        result->push_back(*position);
+        ++position;
+      }
+    }
+
+    return Error("Unterminated JSON string");
+  }
+
+  // Parses an escape sequence (assumes the leading '\\' has been
+  // consumed), appending the unescaped characters to 'result'.
+  Option<Error> parseEscape(std::string* result)
+  {
+    if (position == end) {
+      return Error("Unterminated escape in JSON string");
+    }
+
+    char c = *position;
+    ++position;
+
+    switch (c) {
+      case '"': result->push_back('"'); return None();
+      case '\\': result->push_back('\\'); return None();
+      case '/': result->push_back('/'); return None();
+      case 'b': result->push_back('\b'); return None();
+      case 'f': result->push_back('\f'); return None();
+      case 'n': result->push_back('\n'); return None();
+      case 'r': result->push_back('\r'); return None();
+      case 't': result->push_back('\t'); return None();
+      case 'u': break;
+      default:
+        return Error("Invalid escape in JSON string");
+    }
+
+    // A '\uXXXX' escape, possibly followed by the low half of a
+    // UTF-16 surrogate pair.
+    Option<uint32_t> codepoint = parseHex4();
+    if (codepoint.isNone()) {
+      return Error("Invalid unicode escape in JSON string");
+    }
+
+    uint32_t unicode = codepoint.get();
+
+    if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+      if (end - position < 2 || position[0] != '\\' || position[1] != 'u') {
+        return Error("Expected low surrogate in JSON string");
+      }
+
+      position += 2;
+
+      Option<uint32_t> low = parseHex4();
+      if (low.isNone() || low.get() < 0xDC00 || low.get() > 0xDFFF) {
+        return Error("Invalid low surrogate in JSON string");
+      }
+
+      unicode = 0x10000 +
+        ((unicode - 0xD800) << 10) +
+        (low.get() - 0xDC00);
+    } else if (unicode >= 0xDC00 && unicode <= 0xDFFF) {
+      return Error("Unexpected low surrogate in JSON string");
+    }
+
+    // UTF-8 encode the codepoint.
+    if (unicode < 0x80) {
+      result->push_back(static_cast<char>(unicode));
+    } else if (unicode < 0x800) {
+      result->push_back(static_cast<char>(0xC0 | (unicode >> 6)));
+      result->push_back(static_cast<char>(0x80 | (unicode & 0x3F)));
+    } else if (unicode < 0x10000) {
+      result->push_back(static_cast<char>(0xE0 | (unicode >> 12)));
+      result->push_back(static_cast<char>(0x80 | ((unicode >> 6) & 0x3F)));
+      result->push_back(static_cast<char>(0x80 | (unicode & 0x3F)));
+    } else {
+      result->push_back(static_cast<char>(0xF0 | (unicode >> 18)));
+      result->push_back(static_cast<char>(0x80 | ((unicode >> 12) & 0x3F)));
+      result->push_back(static_cast<char>(0x80 | ((unicode >> 6) & 0x3F)));
+      result->push_back(static_cast<char>(0x80 | (unicode & 0x3F)));
+    }
+
+    return None();
+  }
+
+  // Parses exactly 4 hexadecimal digits.
+  Option<uint32_t> parseHex4()
+  {
+    if (end - position < 4) {
+      return None();
+    }
+
+    uint32_t result = 0;
+
+    for (int i = 0; i < 4; ++i) {
+      char c = *position;
+      ++position;
+
+      result <<= 4;
+
+      if (c >= '0' && c <= '9') {
+        result |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        result |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        result |= c - 'A' + 10;
+      } else {
+        return None();
+      }
+    }
+
+    return result;
+  }
+
+  Option<Error> parseNumber(Value* value)
+  {
+    const char* begin = position;
+
+    bool negative = false;
+    if (position != end && *position == '-') {
+      negative = true;
+      ++position;
+    }
+
+    if (position == end || *position < '0' || *position > '9') {
+      return Error("Invalid JSON number");
+    }
+
+    bool integral = true;
+    bool overflow = false;
+    uint64_t integer = 0;
+
+    while (position != end && *position >= '0' && *position <= '9') {
+      uint64_t digit = *position - '0';
+
+      if (integer > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+        overflow = true;
+      } else {
+        integer = integer * 10 + digit;
+      }
+
+      ++position;
+    }
+
+    if (position != end && *position == '.') {
+      integral = false;
+      ++position;
+
+      if (position == end || *position < '0' || *position > '9') {
+        return Error("Invalid fraction in JSON number");
+      }
+
+      while (position != end && *position >= '0' && *position <= '9') {
+        ++position;
+      }
+    }
+
+    if (position != end && (*position == 'e' || *position == 'E')) {
+      integral = false;
+      ++position;
+
+      if (position != end && (*position == '+' || *position == '-')) {
+        ++position;
+      }
+
+      if (position == end || *position < '0' || *position > '9') {
+        return Error("Invalid exponent in JSON number");
+      }
+
+      while (position != end && *position >= '0' && *position <= '9') {
+        ++position;
+      }
+    }
+
+    // As with PicoJson, integers that fit in a signed 64-bit value
+    // are represented exactly and everything else (fractions,
+    // exponents, out of range integers) falls back to a double.
+    if (integral && !overflow) {
+      const uint64_t max =
+        static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+
+      if (!negative && integer <= max) {
+        *value = Number(static_cast<int64_t>(integer));
+        return None();
+      }
+
+      if (negative && integer <= max) {
+        *value = Number(-static_cast<int64_t>(integer));
+        return None();
+      }
+
+      if (negative && integer == max + 1) {
+        *value = Number(std::numeric_limits<int64_t>::min());
+        return None();
+      }
+    }
+
+    *value = Number(strtod(std::string(begin, position).c_str(), NULL));
+    return None();
+  }
+
+  const char* position;
+  const char* const end;
+};
 
 } // namespace internal {
 
 
 inline Try<Value> parse(const std::string& s)
 {
-  const char* parseBegin = s.c_str();
-  picojson::value value;
-  std::string error;
+  internal::Parser parser(s.c_str(), s.c_str() + s.size());
 
-  // Because PicoJson supports repeated parsing of multiple objects/arrays in a
-  // stream, it will quietly ignore trailing non-whitespace characters. We would
-  // rather throw an error, however, so use `last_char` to check for this.
-  const char* lastVisibleChar =
-    parseBegin + s.find_last_not_of(strings::WHITESPACE);
+  Try<Value> value = parser.parse();
 
-  // Parse the string, returning a pointer to the character
-  // immediately following the last one parsed.
-  const char* parseEnd =
-    picojson::parse(value, parseBegin, parseBegin + s.size(), &error);
+  if (value.isError()) {
+    return value;
+  }
 
-  if (!error.empty()) {
-    return Error(error);
-  } else if (parseEnd != lastVisibleChar + 1) {
+  // We would rather throw an error on trailing non-whitespace
+  // characters than quietly ignore them.
+  if (parser.remaining() != s.c_str() + s.size()) {
     return Error(
         "Parsed JSON included non-whitespace trailing characters: "
-        + s.substr(parseEnd - parseBegin, lastVisibleChar + 1 - parseEnd));
+        + s.substr(parser.remaining() - s.c_str()));
   }
 
-  return internal::convert(value);
+  return value;
 }
 
 
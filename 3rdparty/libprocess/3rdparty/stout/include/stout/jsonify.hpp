@@ -290,6 +290,19 @@ public:
     ++count_;
   }
 
+  // Writes an element that has already been serialized to JSON. The
+  // string is written verbatim and must therefore be a valid JSON
+  // value. This enables assembling an array from fragments that were
+  // rendered separately (e.g., in parallel on multiple threads).
+  void raw(const std::string& value)
+  {
+    if (count_ > 0) {
+      *stream_ << ',';
+    }
+    *stream_ << value;
+    ++count_;
+  }
+
 private:
   std::ostream* stream_;
   std::size_t count_;
@@ -0,0 +1,135 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __STOUT_OS_MMAP_HPP__
+#define __STOUT_OS_MMAP_HPP__
+
+// Windows does not provide mmap(2); callers there use os::read.
+#ifndef __WINDOWS__
+
+#include <fcntl.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <string>
+
+#include <stout/error.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/read.hpp>
+
+namespace os {
+
+// A read-only, zero-copy view of a whole file's contents. The
+// underlying memory is shared between copies and released when the
+// last copy is destroyed. Depending on how the view was created the
+// memory is either a file mapping or a heap buffer (see os::mmap
+// below), which is transparent to the consumer.
+class MappedRegion
+{
+public:
+  const char* data() const
+  {
+    return static_cast<const char*>(memory.get());
+  }
+
+  size_t size() const
+  {
+    return length;
+  }
+
+private:
+  friend Try<MappedRegion> mmap(const std::string& path);
+
+  MappedRegion(const std::shared_ptr<void>& _memory, size_t _length)
+    : memory(_memory), length(_length) {}
+
+  std::shared_ptr<void> memory;
+  size_t length;
+};
+
+
+// Returns a read-only view of the contents of the file, mapped into
+// memory with mmap(2) so that the data is not copied into userspace
+// buffers. If the file cannot be mapped (e.g., it resides on a
+// filesystem without mmap support) we gracefully fall back to
+// reading it into a heap buffer, so callers only observe an error
+// when the file cannot be read at all.
+inline Try<MappedRegion> mmap(const std::string& path)
+{
+  Try<int> fd = os::open(
+      path,
+      O_RDONLY | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (fd.isError()) {
+    return Error("Failed to open file '" + path + "': " + fd.error());
+  }
+
+  struct stat s;
+  if (::fstat(fd.get(), &s) < 0) {
+    ErrnoError error("Failed to fstat file '" + path + "'");
+    os::close(fd.get());
+    return error;
+  }
+
+  size_t length = static_cast<size_t>(s.st_size);
+
+  // mmap(2) fails with EINVAL for a zero length mapping; represent
+  // an empty file as an empty view.
+  if (length == 0) {
+    os::close(fd.get());
+    return MappedRegion(std::shared_ptr<void>(), 0);
+  }
+
+  void* address = ::mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+
+  if (address != MAP_FAILED) {
+    os::close(fd.get());
+
+    return MappedRegion(
+        std::shared_ptr<void>(
+            address,
+            [length](void* address) { ::munmap(address, length); }),
+        length);
+  }
+
+  // Fall back to reading the file into a heap buffer, e.g., for
+  // filesystems that do not support mmap.
+  Result<std::string> data = os::read(fd.get(), length);
+
+  os::close(fd.get());
+
+  if (data.isError()) {
+    return Error("Failed to read file '" + path + "': " + data.error());
+  } else if (data.isNone() || data.get().size() < length) {
+    return Error("Failed to read file '" + path + "': hit EOF unexpectedly");
+  }
+
+  std::shared_ptr<std::string> buffer(new std::string(data.get()));
+
+  return MappedRegion(
+      std::shared_ptr<void>(
+          buffer, const_cast<char*>(buffer->data())),
+      length);
+}
+
+} // namespace os {
+
+#endif // __WINDOWS__
+
+#endif // __STOUT_OS_MMAP_HPP__
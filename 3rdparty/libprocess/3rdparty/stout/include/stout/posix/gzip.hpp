@@ -23,12 +23,102 @@
 
 
 // Compression utilities.
-// TODO(bmahler): Provide streaming compression / decompression as well.
+// TODO(bmahler): Provide streaming decompression as well.
 namespace gzip {
 
 // We use a 16KB buffer with zlib compression / decompression.
 #define GZIP_BUFFER_SIZE 16384
 
+// Provides streaming gzip compression: input gets fed incrementally
+// via 'compress' and the gzip stream is terminated with 'finalize'.
+// Unlike 'compress' below this does not require the entire input (or
+// output) to be held in memory at once.
+class Compressor
+{
+public:
+  explicit Compressor(int level = Z_DEFAULT_COMPRESSION)
+  {
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    int code = deflateInit2(
+        &stream,
+        level,          // Compression level.
+        Z_DEFLATED,     // Compression method.
+        MAX_WBITS + 16, // Zlib magic for gzip compression / decompression.
+        8,              // Default memLevel value.
+        Z_DEFAULT_STRATEGY);
+
+    initialized = (code == Z_OK);
+  }
+
+  ~Compressor()
+  {
+    if (initialized) {
+      deflateEnd(&stream);
+    }
+  }
+
+  // Compresses the input, returning whatever compressed data is
+  // available so far. Note that the result may be empty: zlib
+  // buffers input until it can produce a full block.
+  Try<std::string> compress(const std::string& input)
+  {
+    return deflate_(input, Z_NO_FLUSH);
+  }
+
+  // Terminates the gzip stream, returning the remaining compressed
+  // data. The compressor must not be used afterwards.
+  Try<std::string> finalize()
+  {
+    return deflate_(std::string(), Z_FINISH);
+  }
+
+private:
+  // Not copyable, not assignable (the z_stream holds internal
+  // pointers).
+  Compressor(const Compressor&);
+  Compressor& operator=(const Compressor&);
+
+  Try<std::string> deflate_(const std::string& input, int flush)
+  {
+    if (!initialized) {
+      return Error("Failed to initialize zlib for compression");
+    }
+
+    stream.next_in =
+      const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+
+    std::string result;
+    char buffer[GZIP_BUFFER_SIZE];
+
+    do {
+      stream.next_out = reinterpret_cast<Bytef*>(buffer);
+      stream.avail_out = GZIP_BUFFER_SIZE;
+
+      int code = deflate(&stream, flush);
+
+      if (code == Z_STREAM_ERROR) {
+        Error error(std::string(stream.msg != NULL
+            ? stream.msg : "Failed to compress"));
+        deflateEnd(&stream);
+        initialized = false;
+        return error;
+      }
+
+      result.append(buffer, GZIP_BUFFER_SIZE - stream.avail_out);
+    } while (stream.avail_out == 0);
+
+    return result;
+  }
+
+  z_stream_s stream;
+  bool initialized;
+};
+
+
 // Returns a gzip compressed version of the provided string.
 // The compression level should be within the range [-1, 9].
 // See zlib.h:
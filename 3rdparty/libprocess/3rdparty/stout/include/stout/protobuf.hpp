@@ -44,6 +44,7 @@
 #include <stout/try.hpp>
 
 #include <stout/os/close.hpp>
+#include <stout/os/mmap.hpp>
 #include <stout/os/open.hpp>
 #include <stout/os/read.hpp>
 #include <stout/os/write.hpp>
@@ -268,9 +269,108 @@ struct Read<google::protobuf::RepeatedPtrField<T>>
   }
 };
 
+#ifndef __WINDOWS__
+
+// Reads a single message of type T out of a memory region at the
+// given offset, based on the format written by 'write' above. The
+// message is parsed directly from the region, avoiding the
+// intermediate copy the fd based Read<T> makes for every record.
+// NOTE: This struct is used by the public 'read' function.
+// See comments there for the reason why we need this.
+template <typename T>
+struct ReadRegion
+{
+  Result<T> operator()(
+      const os::MappedRegion& region,
+      size_t* offset,
+      bool ignorePartial)
+  {
+    if (*offset == region.size()) {
+      return None(); // No more protobufs to read.
+    }
+
+    uint32_t size;
+
+    if (region.size() - *offset < sizeof(size)) {
+      // Hit EOF unexpectedly.
+      if (ignorePartial) {
+        return None();
+      }
+      return Error(
+          "Failed to read size: hit EOF unexpectedly, possible corruption");
+    }
+
+    // Parse the size from the bytes.
+    memcpy((void*) &size, (void*) (region.data() + *offset), sizeof(size));
+
+    if (region.size() - *offset - sizeof(size) < size) {
+      // Hit EOF unexpectedly.
+      if (ignorePartial) {
+        return None();
+      }
+      return Error("Failed to read message of size " + stringify(size) +
+                   " bytes: hit EOF unexpectedly, possible corruption");
+    }
+
+    T message;
+    google::protobuf::io::ArrayInputStream stream(
+        region.data() + *offset + sizeof(size), size);
+
+    if (!message.ParseFromZeroCopyStream(&stream)) {
+      return Error("Failed to deserialize message");
+    }
+
+    *offset += sizeof(size) + size;
+
+    return message;
+  }
+};
+
+
+// Partial specialization for RepeatedPtrField<T>, the analogue of
+// Read<RepeatedPtrField<T>> above.
+template <typename T>
+struct ReadRegion<google::protobuf::RepeatedPtrField<T>>
+{
+  Result<google::protobuf::RepeatedPtrField<T>> operator()(
+      const os::MappedRegion& region,
+      size_t* offset,
+      bool ignorePartial)
+  {
+    google::protobuf::RepeatedPtrField<T> result;
+    for (;;) {
+      Result<T> message = ReadRegion<T>()(region, offset, ignorePartial);
+      if (message.isError()) {
+        return Error(message.error());
+      } else if (message.isNone()) {
+        break;
+      } else {
+        result.Add()->CopyFrom(message.get());
+      }
+    }
+    return result;
+  }
+};
+
+#endif // __WINDOWS__
+
 }  // namespace internal {
 
 
+#ifndef __WINDOWS__
+
+// Reads the protobuf message(s) from a memory mapped file (see the
+// fd based 'read' below for the semantics of 'ignorePartial').
+template <typename T>
+Result<T> read(const os::MappedRegion& region, bool ignorePartial = false)
+{
+  size_t offset = 0;
+  return internal::ReadRegion<T>()(region, &offset, ignorePartial);
+}
+
+#endif // __WINDOWS__
+
+
 // Reads the protobuf message(s) from a given fd based on the format
 // written by write() above. We use partial specialization of
 //   - internal::Read<T> vs
@@ -289,10 +389,22 @@ Result<T> read(int fd, bool ignorePartial = false, bool undoFailed = false)
 
 
 // A wrapper function that wraps the above read() with open and
-// closing the file.
+// closing the file. Where available the file is memory mapped and
+// the message(s) parsed directly out of the mapping, which avoids
+// double-buffering the whole file (e.g., every checkpoint recovered
+// by the slave).
 template <typename T>
 Result<T> read(const std::string& path)
 {
+#ifndef __WINDOWS__
+  Try<os::MappedRegion> region = os::mmap(path);
+
+  if (region.isError()) {
+    return Error(region.error());
+  }
+
+  return read<T>(region.get());
+#else
   Try<int> fd = os::open(
       path,
       O_RDONLY | O_CLOEXEC,
@@ -310,6 +422,7 @@ Result<T> read(const std::string& path)
   os::close(fd.get());
 
   return result;
+#endif // __WINDOWS__
 }
 
 
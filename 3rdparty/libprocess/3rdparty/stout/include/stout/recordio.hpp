@@ -15,6 +15,7 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <string>
@@ -66,7 +67,18 @@ public:
   std::string encode(const T& record) const
   {
     std::string s = serialize(record);
-    return stringify(s.size()) + "\n" + s;
+    std::string header = stringify(s.size());
+
+    // NOTE: Assembled with a single allocation and one copy of the
+    // serialized record, rather than concatenation operators which
+    // would copy the record an additional time.
+    std::string result;
+    result.reserve(header.size() + 1 + s.size());
+    result += header;
+    result += '\n';
+    result += s;
+
+    return result;
   }
 
 private:
@@ -105,14 +117,22 @@ public:
 
     std::deque<Try<T>> records;
 
-    foreach (char c, data) {
+    size_t offset = 0;
+
+    while (offset < data.size()) {
       if (state == HEADER) {
-        // Keep reading until we have the entire header.
-        if (c != '\n') {
-          buffer += c;
-          continue;
+        size_t index = data.find('\n', offset);
+
+        // Keep the incomplete header (headers are small) until
+        // more data arrives.
+        if (index == std::string::npos) {
+          buffer.append(data, offset, data.size() - offset);
+          break;
         }
 
+        buffer.append(data, offset, index - offset);
+        offset = index + 1;
+
         Try<size_t> numify = ::numify<size_t>(buffer);
 
         // If we were unable to decode the length header, do not
@@ -133,14 +153,33 @@ public:
           records.push_back(deserialize(buffer));
           state = HEADER;
         }
-      } else if (state == RECORD) {
+      } else {
         CHECK_SOME(length);
         CHECK_LT(buffer.size(), length.get());
 
-        buffer += c;
+        size_t remaining = length.get() - buffer.size();
+
+        // Fast path: nothing of this record has been buffered yet
+        // and the rest of it is contained in this chunk, so there
+        // is no need to accumulate it into the buffer first.
+        if (buffer.empty() && data.size() - offset >= remaining) {
+          records.push_back(deserialize(data.substr(offset, remaining)));
+          offset += remaining;
+          state = HEADER;
+          continue;
+        }
+
+        size_t copy = std::min(remaining, data.size() - offset);
+
+        buffer.append(data, offset, copy);
+        offset += copy;
 
         if (buffer.size() == length.get()) {
           records.push_back(deserialize(buffer));
+
+          // NOTE: `clear` retains the underlying allocation, so a
+          // busy stream re-uses the buffer for subsequent fragmented
+          // records rather than re-allocating for each one.
           buffer.clear();
           state = HEADER;
         }
@@ -158,8 +197,9 @@ private:
     FAILED
   } state;
 
-  // TODO(bmahler): Avoid string here as it will not free
-  // its underlying memory allocation when we clear it.
+  // Holds an in-progress header or record that spans chunks.
+  // TODO(bmahler): Shrink the buffer after an unusually large
+  // record so that its allocation is not retained forever.
   std::string buffer;
   Option<size_t> length;
 
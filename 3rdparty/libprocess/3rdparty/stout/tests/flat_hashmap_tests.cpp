@@ -0,0 +1,189 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <ctype.h>
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <stout/flat_hashmap.hpp>
+#include <stout/foreach.hpp>
+#include <stout/gtest.hpp>
+#include <stout/stringify.hpp>
+
+using std::string;
+
+
+TEST(FlatHashMapTest, InitializerList)
+{
+  flat_hashmap<string, int> map{{"hello", 1}};
+  EXPECT_EQ(1, map.size());
+
+  EXPECT_TRUE((flat_hashmap<int, int>{}.empty()));
+
+  flat_hashmap<int, int> map2{{1, 2}, {2, 3}, {3, 4}};
+  EXPECT_EQ(3, map2.size());
+  EXPECT_SOME_EQ(2, map2.get(1));
+  EXPECT_SOME_EQ(3, map2.get(2));
+  EXPECT_SOME_EQ(4, map2.get(3));
+  EXPECT_NONE(map2.get(4));
+}
+
+
+TEST(FlatHashMapTest, Insert)
+{
+  flat_hashmap<string, int> map;
+  map["abc"] = 1;
+  map.put("def", 2);
+
+  ASSERT_SOME_EQ(1, map.get("abc"));
+  ASSERT_SOME_EQ(2, map.get("def"));
+
+  map.put("def", 4);
+  ASSERT_SOME_EQ(4, map.get("def"));
+  ASSERT_EQ(2, map.size());
+}
+
+
+TEST(FlatHashMapTest, Contains)
+{
+  flat_hashmap<string, int> map;
+  map["abc"] = 1;
+
+  ASSERT_TRUE(map.contains("abc"));
+  ASSERT_TRUE(map.containsValue(1));
+
+  ASSERT_FALSE(map.contains("def"));
+  ASSERT_FALSE(map.containsValue(2));
+}
+
+
+TEST(FlatHashMapTest, Erase)
+{
+  flat_hashmap<string, int> map;
+  map["abc"] = 1;
+  map["def"] = 2;
+
+  EXPECT_EQ(1, map.erase("abc"));
+  EXPECT_EQ(0, map.erase("abc"));
+
+  EXPECT_FALSE(map.contains("abc"));
+  EXPECT_NONE(map.get("abc"));
+  EXPECT_SOME_EQ(2, map.get("def"));
+  EXPECT_EQ(1, map.size());
+}
+
+
+// Grow the map well past its initial capacity and then remove most
+// entries again, so the open addressing table is exercised through
+// several rehashes and backward shift deletions.
+TEST(FlatHashMapTest, Rehash)
+{
+  flat_hashmap<int, string> map;
+
+  for (int i = 0; i < 1000; i++) {
+    map[i] = stringify(i);
+  }
+
+  EXPECT_EQ(1000, map.size());
+
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_SOME_EQ(stringify(i), map.get(i));
+  }
+
+  for (int i = 0; i < 1000; i += 2) {
+    EXPECT_EQ(1, map.erase(i));
+  }
+
+  EXPECT_EQ(500, map.size());
+
+  for (int i = 0; i < 1000; i++) {
+    if (i % 2 == 0) {
+      EXPECT_NONE(map.get(i));
+    } else {
+      EXPECT_SOME_EQ(stringify(i), map.get(i));
+    }
+  }
+}
+
+
+TEST(FlatHashMapTest, Foreach)
+{
+  flat_hashmap<string, int> map{{"a", 1}, {"b", 2}, {"c", 3}};
+
+  int sum = 0;
+  string keys;
+  foreachpair (const string& key, int value, map) {
+    keys += key;
+    sum += value;
+  }
+
+  EXPECT_EQ(6, sum);
+  EXPECT_EQ(3, keys.size());
+
+  // Iteration must visit each entry exactly once.
+  EXPECT_NE(string::npos, keys.find("a"));
+  EXPECT_NE(string::npos, keys.find("b"));
+  EXPECT_NE(string::npos, keys.find("c"));
+}
+
+
+TEST(FlatHashMapTest, CustomHashAndEqual)
+{
+  struct CaseInsensitiveHash
+  {
+    size_t operator()(const string& key) const
+    {
+      size_t seed = 0;
+      foreach (const char c, key) {
+        boost::hash_combine(seed, ::tolower(c));
+      }
+      return seed;
+    }
+  };
+
+  struct CaseInsensitiveEqual
+  {
+    bool operator()(const string& left, const string& right) const
+    {
+      if (left.size() != right.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < left.size(); ++i) {
+        if (::tolower(left[i]) != ::tolower(right[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  flat_hashmap<string, int, CaseInsensitiveHash, CaseInsensitiveEqual> map;
+
+  map["abc"] = 1;
+  map.put("def", 2);
+  EXPECT_SOME_EQ(1, map.get("Abc"));
+  EXPECT_SOME_EQ(2, map.get("dEf"));
+
+  map.put("Abc", 3);
+  map["DEF"] = 4;
+  EXPECT_SOME_EQ(3, map.get("abc"));
+  EXPECT_SOME_EQ(4, map.get("def"));
+
+  EXPECT_EQ(2, map.size());
+  EXPECT_TRUE(map.contains("abc"));
+  EXPECT_TRUE(map.contains("aBc"));
+}
@@ -14,6 +14,7 @@
 
 #include <sys/stat.h>
 
+#include <limits>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -270,6 +271,87 @@ TEST(JsonTest, ParseError)
     " ";
 
   EXPECT_ERROR(JSON::parse<JSON::Object>(jsonString));
+
+  // Unterminated and malformed constructs.
+  EXPECT_ERROR(JSON::parse("[1,]"));
+  EXPECT_ERROR(JSON::parse("[1 2]"));
+  EXPECT_ERROR(JSON::parse("{\"key\":}"));
+  EXPECT_ERROR(JSON::parse("\"unterminated"));
+  EXPECT_ERROR(JSON::parse("tru"));
+  EXPECT_ERROR(JSON::parse("-"));
+  EXPECT_ERROR(JSON::parse("1."));
+  EXPECT_ERROR(JSON::parse("1e"));
+
+  // Control characters must be escaped within strings.
+  EXPECT_ERROR(JSON::parse("\"a\tb\""));
+}
+
+
+TEST(JsonTest, ParseStringEscapes)
+{
+  // Simple escapes.
+  EXPECT_SOME_EQ(
+      JSON::String("a\"b\\c/d\b\f\n\r\t"),
+      JSON::parse<JSON::String>("\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\""));
+
+  // Unicode escapes are decoded to UTF-8, including astral plane
+  // codepoints encoded as UTF-16 surrogate pairs.
+  EXPECT_SOME_EQ(
+      JSON::String("A\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80"),
+      JSON::parse<JSON::String>("\"\\u0041\\u00e9\\u4e2d\\ud83d\\ude00\""));
+
+  // UTF-8 input passes through untouched.
+  EXPECT_SOME_EQ(
+      JSON::String("caf\xC3\xA9"),
+      JSON::parse<JSON::String>("\"caf\xC3\xA9\""));
+
+  EXPECT_ERROR(JSON::parse("\"\\x41\""));  // Invalid escape.
+  EXPECT_ERROR(JSON::parse("\"\\u12\""));  // Truncated unicode escape.
+  EXPECT_ERROR(JSON::parse("\"\\ud83d\"")); // Lone high surrogate.
+  EXPECT_ERROR(JSON::parse("\"\\ude00\"")); // Lone low surrogate.
+}
+
+
+TEST(JsonTest, ParseNumbers)
+{
+  Try<JSON::Number> number = JSON::parse<JSON::Number>("42");
+  ASSERT_SOME(number);
+  EXPECT_EQ(JSON::Number::SIGNED_INTEGER, number.get().type);
+  EXPECT_EQ(42, number.get().as<int64_t>());
+
+  number = JSON::parse<JSON::Number>("-9223372036854775808");
+  ASSERT_SOME(number);
+  EXPECT_EQ(JSON::Number::SIGNED_INTEGER, number.get().type);
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), number.get().as<int64_t>());
+
+  number = JSON::parse<JSON::Number>("9223372036854775807");
+  ASSERT_SOME(number);
+  EXPECT_EQ(JSON::Number::SIGNED_INTEGER, number.get().type);
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), number.get().as<int64_t>());
+
+  // Integers that do not fit in a signed 64-bit value parse as
+  // doubles, for compatibility with parsing through PicoJson.
+  number = JSON::parse<JSON::Number>("9223372036854775808");
+  ASSERT_SOME(number);
+  EXPECT_EQ(JSON::Number::FLOATING, number.get().type);
+
+  number = JSON::parse<JSON::Number>("1.5e3");
+  ASSERT_SOME(number);
+  EXPECT_EQ(JSON::Number::FLOATING, number.get().type);
+  EXPECT_EQ(1500.0, number.get().as<double>());
+}
+
+
+TEST(JsonTest, ParseDuplicateKeys)
+{
+  // The first of any duplicate keys wins, for compatibility with
+  // parsing through PicoJson.
+  Try<JSON::Object> object =
+    JSON::parse<JSON::Object>("{\"key\": 1, \"key\": 2}");
+
+  ASSERT_SOME(object);
+  ASSERT_EQ(1u, object.get().values.size());
+  EXPECT_EQ(1, object.get().values["key"].as<JSON::Number>().as<int64_t>());
 }
 
 
@@ -153,6 +153,17 @@ TEST(RecordIOTest, Decoder)
 
   EXPECT_SOME_EQ(records, decoder.decode("S"));
 
+  // A chunk can contain complete records followed by a partial one.
+  records.clear();
+  records.push_back("hi");
+
+  EXPECT_SOME_EQ(records, decoder.decode("2\nHI5\nWOR"));
+
+  records.clear();
+  records.push_back("world");
+
+  EXPECT_SOME_EQ(records, decoder.decode("LD"));
+
   // If the format is bad, the decoder should fail permanently.
   EXPECT_ERROR(decoder.decode("not a number\n"));
   EXPECT_ERROR(decoder.decode("1\n"));
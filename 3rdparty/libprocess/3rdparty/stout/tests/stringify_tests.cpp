@@ -0,0 +1,63 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <stout/stringify.hpp>
+
+using std::numeric_limits;
+using std::string;
+
+
+TEST(StringifyTest, Integers)
+{
+  EXPECT_EQ("0", stringify(0));
+  EXPECT_EQ("42", stringify(42));
+  EXPECT_EQ("-42", stringify(-42));
+
+  EXPECT_EQ("0", stringify(0u));
+  EXPECT_EQ("42", stringify(42u));
+
+  // The extremes exercise the negation of the minimum value, whose
+  // magnitude is not representable in the signed type.
+  EXPECT_EQ(
+      "9223372036854775807", stringify(numeric_limits<int64_t>::max()));
+  EXPECT_EQ(
+      "-9223372036854775808", stringify(numeric_limits<int64_t>::min()));
+  EXPECT_EQ(
+      "18446744073709551615", stringify(numeric_limits<uint64_t>::max()));
+}
+
+
+TEST(StringifyTest, FloatingPoint)
+{
+  // The fast path must match the default stream formatting (i.e., 6
+  // significant digits).
+  EXPECT_EQ("0", stringify(0.0));
+  EXPECT_EQ("0.5", stringify(0.5));
+  EXPECT_EQ("-0.5", stringify(-0.5));
+  EXPECT_EQ("3.14159", stringify(3.14159265358979));
+  EXPECT_EQ("1e+06", stringify(1000000.0));
+  EXPECT_EQ("0.1", stringify(0.1f));
+}
+
+
+TEST(StringifyTest, Bool)
+{
+  EXPECT_EQ("true", stringify(true));
+  EXPECT_EQ("false", stringify(false));
+}
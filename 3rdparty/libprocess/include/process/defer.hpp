@@ -58,6 +58,13 @@ Deferred<void()> defer(const Process<T>* process, void (T::*method)())
 // libc++) we can't use std::bind with a std::function so we have to
 // explicitely use the std::function<R(P...)>::operator() (see
 // http://stackoverflow.com/questions/20097616/stdbind-to-a-stdfunction-crashes-with-clang).
+
+// NOTE: We move the parameters into the dispatch (a no-op for
+// parameters declared as const references) so that methods taking
+// their parameters by value receive them without a deep copy when
+// the deferred function is invoked with rvalues.
+#define MOVE_PARAM(Z, N, DATA) std::move(p##N)
+
 #define TEMPLATE(Z, N, DATA)                                            \
   template <typename T,                                                 \
             ENUM_PARAMS(N, typename P),                                 \
@@ -69,7 +76,7 @@ Deferred<void()> defer(const Process<T>* process, void (T::*method)())
   {                                                                     \
     std::function<void(ENUM_PARAMS(N, P))> f(                           \
         [=](ENUM_BINARY_PARAMS(N, P, p)) {                              \
-          dispatch(pid, method, ENUM_PARAMS(N, p));                     \
+          dispatch(pid, method, ENUM(N, MOVE_PARAM, _));                \
         });                                                             \
     return std::bind(&std::function<void(ENUM_PARAMS(N, P))>::operator(), std::move(f), ENUM_PARAMS(N, a)); /* NOLINT(whitespace/line_length) */ \
   }                                                                     \
@@ -132,7 +139,7 @@ Deferred<Future<R>()> defer(const Process<T>* process, Future<R> (T::*method)())
   {                                                                     \
     std::function<Future<R>(ENUM_PARAMS(N, P))> f(                      \
         [=](ENUM_BINARY_PARAMS(N, P, p)) {                              \
-          return dispatch(pid, method, ENUM_PARAMS(N, p));              \
+          return dispatch(pid, method, ENUM(N, MOVE_PARAM, _));         \
         });                                                             \
     return std::bind(&std::function<Future<R>(ENUM_PARAMS(N, P))>::operator(), std::move(f), ENUM_PARAMS(N, a)); /* NOLINT(whitespace/line_length) */ \
   }                                                                     \
@@ -197,7 +204,7 @@ Deferred<Future<R>()> defer(const Process<T>* process, R (T::*method)())
   {                                                                     \
     std::function<Future<R>(ENUM_PARAMS(N, P))> f(                      \
         [=](ENUM_BINARY_PARAMS(N, P, p)) {                              \
-          return dispatch(pid, method, ENUM_PARAMS(N, p));              \
+          return dispatch(pid, method, ENUM(N, MOVE_PARAM, _));         \
         });                                                             \
     return std::bind(&std::function<Future<R>(ENUM_PARAMS(N, P))>::operator(), std::move(f), ENUM_PARAMS(N, a)); /* NOLINT(whitespace/line_length) */ \
   }                                                                     \
@@ -231,6 +238,8 @@ Deferred<Future<R>()> defer(const Process<T>* process, R (T::*method)())
   REPEAT_FROM_TO(1, 11, TEMPLATE, _) // Args A0 -> A9.
 #undef TEMPLATE
 
+#undef MOVE_PARAM
+
 
 // Now we define defer calls for functors (with and without a PID):
 
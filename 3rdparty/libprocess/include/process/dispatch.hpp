@@ -16,6 +16,8 @@
 #include <functional>
 #include <memory> // TODO(benh): Replace shared_ptr with unique_ptr.
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include <process/process.hpp>
 
@@ -106,6 +108,24 @@ void dispatch(const Process<T>* process, void (T::*method)())
 // Due to a bug (http://gcc.gnu.org/bugzilla/show_bug.cgi?id=41933)
 // with variadic templates and lambdas, we still need to do
 // preprocessor expansions.
+
+// Each argument of a dispatch is moved (or copied, if the caller
+// passed an lvalue) into a heap allocation that is shared with the
+// closure and then moved again into the method invocation. This
+// means callers can pass expensive-to-copy arguments (e.g., large
+// collections of resources) through a dispatch without any deep
+// copies by moving them into the dispatch, provided the method takes
+// its parameters by value. We decay the argument types so that,
+// among other things, string literals decay to 'const char*' before
+// we try to heap allocate them.
+#define DECL_ARG(Z, N, DATA)                                            \
+  std::shared_ptr<typename std::decay<A##N>::type> CAT(arg, N)(         \
+      new typename std::decay<A##N>::type(std::forward<A##N>(a##N)));
+
+#define MOVE_ARG(Z, N, DATA) std::move(*CAT(arg, N))
+
+#define FORWARD_ARG(Z, N, DATA) std::forward<A##N>(a##N)
+
 #define TEMPLATE(Z, N, DATA)                                            \
   template <typename T,                                                 \
             ENUM_PARAMS(N, typename P),                                 \
@@ -113,15 +133,16 @@ void dispatch(const Process<T>* process, void (T::*method)())
   void dispatch(                                                        \
       const PID<T>& pid,                                                \
       void (T::*method)(ENUM_PARAMS(N, P)),                             \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
+    REPEAT(N, DECL_ARG, _)                                              \
     std::shared_ptr<std::function<void(ProcessBase*)>> f(               \
         new std::function<void(ProcessBase*)>(                          \
             [=](ProcessBase* process) {                                 \
               assert(process != NULL);                                  \
               T* t = dynamic_cast<T*>(process);                         \
               assert(t != NULL);                                        \
-              (t->*method)(ENUM_PARAMS(N, a));                          \
+              (t->*method)(ENUM(N, MOVE_ARG, _));                       \
             }));                                                        \
                                                                         \
     internal::dispatch(pid, f, &typeid(method));                        \
@@ -133,9 +154,9 @@ void dispatch(const Process<T>* process, void (T::*method)())
   void dispatch(                                                        \
       const Process<T>& process,                                        \
       void (T::*method)(ENUM_PARAMS(N, P)),                             \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
-    dispatch(process.self(), method, ENUM_PARAMS(N, a));                \
+    dispatch(process.self(), method, ENUM(N, FORWARD_ARG, _));          \
   }                                                                     \
                                                                         \
   template <typename T,                                                 \
@@ -144,9 +165,9 @@ void dispatch(const Process<T>* process, void (T::*method)())
   void dispatch(                                                        \
       const Process<T>* process,                                        \
       void (T::*method)(ENUM_PARAMS(N, P)),                             \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
-    dispatch(process->self(), method, ENUM_PARAMS(N, a));               \
+    dispatch(process->self(), method, ENUM(N, FORWARD_ARG, _));         \
   }
 
   REPEAT_FROM_TO(1, 11, TEMPLATE, _) // Args A0 -> A9.
@@ -194,8 +215,9 @@ Future<R> dispatch(const Process<T>* process, Future<R> (T::*method)())
   Future<R> dispatch(                                                   \
       const PID<T>& pid,                                                \
       Future<R> (T::*method)(ENUM_PARAMS(N, P)),                        \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
+    REPEAT(N, DECL_ARG, _)                                              \
     std::shared_ptr<Promise<R>> promise(new Promise<R>());              \
                                                                         \
     std::shared_ptr<std::function<void(ProcessBase*)>> f(               \
@@ -204,7 +226,7 @@ Future<R> dispatch(const Process<T>* process, Future<R> (T::*method)())
               assert(process != NULL);                                  \
               T* t = dynamic_cast<T*>(process);                         \
               assert(t != NULL);                                        \
-              promise->associate((t->*method)(ENUM_PARAMS(N, a)));      \
+              promise->associate((t->*method)(ENUM(N, MOVE_ARG, _)));   \
             }));                                                        \
                                                                         \
     internal::dispatch(pid, f, &typeid(method));                        \
@@ -219,9 +241,9 @@ Future<R> dispatch(const Process<T>* process, Future<R> (T::*method)())
   Future<R> dispatch(                                                   \
       const Process<T>& process,                                        \
       Future<R> (T::*method)(ENUM_PARAMS(N, P)),                        \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
-    return dispatch(process.self(), method, ENUM_PARAMS(N, a));         \
+    return dispatch(process.self(), method, ENUM(N, FORWARD_ARG, _));   \
   }                                                                     \
                                                                         \
   template <typename R,                                                 \
@@ -231,9 +253,9 @@ Future<R> dispatch(const Process<T>* process, Future<R> (T::*method)())
   Future<R> dispatch(                                                   \
       const Process<T>* process,                                        \
       Future<R> (T::*method)(ENUM_PARAMS(N, P)),                        \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
-    return dispatch(process->self(), method, ENUM_PARAMS(N, a));        \
+    return dispatch(process->self(), method, ENUM(N, FORWARD_ARG, _));  \
   }
 
   REPEAT_FROM_TO(1, 11, TEMPLATE, _) // Args A0 -> A9.
@@ -281,8 +303,9 @@ Future<R> dispatch(const Process<T>* process, R (T::*method)())
   Future<R> dispatch(                                                   \
       const PID<T>& pid,                                                \
       R (T::*method)(ENUM_PARAMS(N, P)),                                \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
+    REPEAT(N, DECL_ARG, _)                                              \
     std::shared_ptr<Promise<R>> promise(new Promise<R>());              \
                                                                         \
     std::shared_ptr<std::function<void(ProcessBase*)>> f(               \
@@ -291,7 +314,7 @@ Future<R> dispatch(const Process<T>* process, R (T::*method)())
               assert(process != NULL);                                  \
               T* t = dynamic_cast<T*>(process);                         \
               assert(t != NULL);                                        \
-              promise->set((t->*method)(ENUM_PARAMS(N, a)));            \
+              promise->set((t->*method)(ENUM(N, MOVE_ARG, _)));         \
             }));                                                        \
                                                                         \
     internal::dispatch(pid, f, &typeid(method));                        \
@@ -306,9 +329,9 @@ Future<R> dispatch(const Process<T>* process, R (T::*method)())
   Future<R> dispatch(                                                   \
       const Process<T>& process,                                        \
       R (T::*method)(ENUM_PARAMS(N, P)),                                \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
-    return dispatch(process.self(), method, ENUM_PARAMS(N, a));         \
+    return dispatch(process.self(), method, ENUM(N, FORWARD_ARG, _));   \
   }                                                                     \
                                                                         \
   template <typename R,                                                 \
@@ -318,21 +341,31 @@ Future<R> dispatch(const Process<T>* process, R (T::*method)())
   Future<R> dispatch(                                                   \
       const Process<T>* process,                                        \
       R (T::*method)(ENUM_PARAMS(N, P)),                                \
-      ENUM_BINARY_PARAMS(N, A, a))                                      \
+      ENUM_BINARY_PARAMS(N, A, &&a))                                    \
   {                                                                     \
-    return dispatch(process->self(), method, ENUM_PARAMS(N, a));        \
+    return dispatch(process->self(), method, ENUM(N, FORWARD_ARG, _));  \
   }
 
   REPEAT_FROM_TO(1, 11, TEMPLATE, _) // Args A0 -> A9.
 #undef TEMPLATE
 
+#undef DECL_ARG
+#undef MOVE_ARG
+#undef FORWARD_ARG
 
-inline void dispatch(const UPID& pid, const std::function<void()>& f)
+
+// NOTE: These overloads take the function by value and move it into
+// the closure so that an rvalue function (e.g., a just constructed
+// closure with expensive captured state) does not get deep copied.
+inline void dispatch(const UPID& pid, std::function<void()> f)
 {
+  std::shared_ptr<std::function<void()>> f__(
+      new std::function<void()>(std::move(f)));
+
   std::shared_ptr<std::function<void(ProcessBase*)>> f_(
       new std::function<void(ProcessBase*)>(
           [=](ProcessBase*) {
-            f();
+            (*f__)();
           }));
 
   internal::dispatch(pid, f_);
@@ -340,14 +373,17 @@ inline void dispatch(const UPID& pid, const std::function<void()>& f)
 
 
 template <typename R>
-Future<R> dispatch(const UPID& pid, const std::function<Future<R>()>& f)
+Future<R> dispatch(const UPID& pid, std::function<Future<R>()> f)
 {
+  std::shared_ptr<std::function<Future<R>()>> f__(
+      new std::function<Future<R>()>(std::move(f)));
+
   std::shared_ptr<Promise<R>> promise(new Promise<R>());
 
   std::shared_ptr<std::function<void(ProcessBase*)>> f_(
       new std::function<void(ProcessBase*)>(
           [=](ProcessBase*) {
-            promise->associate(f());
+            promise->associate((*f__)());
           }));
 
   internal::dispatch(pid, f_);
@@ -357,14 +393,17 @@ Future<R> dispatch(const UPID& pid, const std::function<Future<R>()>& f)
 
 
 template <typename R>
-Future<R> dispatch(const UPID& pid, const std::function<R()>& f)
+Future<R> dispatch(const UPID& pid, std::function<R()> f)
 {
+  std::shared_ptr<std::function<R()>> f__(
+      new std::function<R()>(std::move(f)));
+
   std::shared_ptr<Promise<R>> promise(new Promise<R>());
 
   std::shared_ptr<std::function<void(ProcessBase*)>> f_(
       new std::function<void(ProcessBase*)>(
           [=](ProcessBase*) {
-            promise->set(f());
+            promise->set((*f__)());
           }));
 
   internal::dispatch(pid, f_);
@@ -13,8 +13,11 @@
 #ifndef __PROCESS_EVENT_HPP__
 #define __PROCESS_EVENT_HPP__
 
+#include <stddef.h>
+
 #include <memory> // TODO(benh): Replace shared_ptr with unique_ptr.
 
+#include <process/freelist.hpp>
 #include <process/future.hpp>
 #include <process/http.hpp>
 #include <process/message.hpp>
@@ -22,6 +25,7 @@
 
 #include <stout/abort.hpp>
 #include <stout/lambda.hpp>
+#include <stout/stopwatch.hpp>
 
 namespace process {
 
@@ -81,6 +85,11 @@ struct Event
     }
     return *result;
   }
+
+  // Started when the event gets enqueued (see ProcessBase::enqueue)
+  // so that the time an event spends waiting in a process's queue
+  // and being serviced can be traced (see ProcessBase::trace).
+  Stopwatch stopwatch;
 };
 
 
@@ -102,6 +111,23 @@ struct MessageEvent : Event
     visitor->visit(*this);
   }
 
+  // One of these gets allocated for every delivered message, so they
+  // are recycled through a per-thread free list rather than going to
+  // the allocator each time (and likewise for Message itself, see
+  // message.hpp).
+  static void* operator new(size_t size)
+  {
+    if (size != sizeof(MessageEvent)) {
+      return ::operator new(size);
+    }
+    return internal::FreeList<MessageEvent>::allocate();
+  }
+
+  static void operator delete(void* pointer)
+  {
+    internal::FreeList<MessageEvent>::deallocate(pointer);
+  }
+
   Message* const message;
 
 private:
@@ -161,6 +187,21 @@ struct DispatchEvent : Event
     visitor->visit(*this);
   }
 
+  // One of these gets allocated for every dispatch, so they are
+  // recycled through a per-thread free list (see MessageEvent).
+  static void* operator new(size_t size)
+  {
+    if (size != sizeof(DispatchEvent)) {
+      return ::operator new(size);
+    }
+    return internal::FreeList<DispatchEvent>::allocate();
+  }
+
+  static void operator delete(void* pointer)
+  {
+    internal::FreeList<DispatchEvent>::deallocate(pointer);
+  }
+
   // PID receiving the dispatch.
   const UPID pid;
 
@@ -0,0 +1,338 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_EVENT_QUEUE_HPP__
+#define __PROCESS_EVENT_QUEUE_HPP__
+
+#include <atomic>
+
+#include <process/event.hpp>
+#include <process/freelist.hpp>
+
+namespace process {
+
+// A lock-free multiple-producer single-consumer queue of events,
+// used as the mailbox of a process. Enqueueing is wait-free (a
+// single atomic exchange) so senders never block one another or the
+// consumer, and dequeueing does not take any locks (the consumer
+// only ever waits for the one producer that has swung the tail but
+// not yet linked its node, see 'dequeue' below).
+//
+// The implementation is a set of intrusively linked lists in the
+// style of Vyukov's non-intrusive MPSC queue: producers atomically
+// exchange the tail and then link their node from the previous tail,
+// while the consumer follows the 'next' pointers from a stub node at
+// the head. Events enqueued with 'inject' go on a separate list that
+// the consumer always drains first (they are delivered ahead of
+// ordinary events, e.g., for injected terminate events).
+//
+// Events are further split into priority classes (see 'Priority'):
+// latency-critical messages, ordinary events, and background events
+// such as HTTP requests. The consumer drains higher classes first
+// but reserves a few dequeues of every cycle for the lower classes
+// (see 'dequeue'), so under overload background work degrades
+// without being starved entirely. Note that delivery order is only
+// guaranteed between events of the same class.
+//
+// The consumer side ('dequeue', 'empty', 'count', 'visit') must only
+// ever be called from a single thread at a time, i.e., the thread
+// currently running the process.
+class EventQueue
+{
+public:
+  // Priority classes for enqueued events. Within a class events are
+  // delivered in order; across classes higher priority events are
+  // delivered first, modulo the anti-starvation slots (see
+  // 'dequeue').
+  enum Priority
+  {
+    HIGH,   // Latency-critical messages (see ProcessBase::prioritize).
+    NORMAL, // Ordinary messages, dispatches, exited events.
+    LOW,    // Background work, e.g., HTTP requests.
+  };
+
+  EventQueue() : decommissioned(false), depth_(0), watermark_(0), slot(0) {}
+
+  ~EventQueue()
+  {
+    // Delete any remaining events (e.g., events that raced with
+    // 'decommission' and got enqueued after the terminating process
+    // drained its queue).
+    injected.destroy();
+    high.destroy();
+    ordinary.destroy();
+    low.destroy();
+  }
+
+  // Enqueues the event, returning false if the queue has been
+  // decommissioned in which case the caller retains ownership of the
+  // event. May be called concurrently from any number of threads.
+  bool enqueue(Event* event, Priority priority = NORMAL, bool inject = false)
+  {
+    if (decommissioned.load()) {
+      return false;
+    }
+
+    Node* node = new Node(event);
+
+    if (inject) {
+      injected.enqueue(node);
+    } else if (priority == HIGH) {
+      high.enqueue(node);
+    } else if (priority == LOW) {
+      low.enqueue(node);
+    } else {
+      ordinary.enqueue(node);
+    }
+
+    // Track the queue depth and its high-watermark. All relaxed: the
+    // counters are approximate instrumentation (they deliberately do
+    // not order with the queue operations) so producers pay no more
+    // than uncontended atomic increments.
+    size_t depth = depth_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    size_t watermark = watermark_.load(std::memory_order_relaxed);
+    while (depth > watermark &&
+           !watermark_.compare_exchange_weak(
+               watermark, depth, std::memory_order_relaxed)) {}
+
+    return true;
+  }
+
+  // Returns the next event, or NULL if the queue is empty. Note that
+  // NULL may also be returned while a producer has swung the tail
+  // but not yet linked its node; callers are expected to re-check
+  // 'empty' after publishing that they are blocked (see
+  // ProcessManager::resume) so no event is ever lost.
+  Event* dequeue()
+  {
+    Event* event = injected.dequeue();
+
+    // Starvation-proof weighted round robin across the priority
+    // classes: most dequeues drain the highest class first, but out
+    // of every 8 dequeues 2 offer the normal class first and 1
+    // offers the low class first, so sustained high priority load
+    // degrades the lower classes rather than starving them.
+    if (event == NULL) {
+      switch (slot++ % 8) {
+        case 3:
+        case 6:
+          event = ordinary.dequeue();
+          break;
+        case 7:
+          event = low.dequeue();
+          break;
+        default:
+          break;
+      }
+    }
+
+    if (event == NULL) {
+      event = high.dequeue();
+    }
+
+    if (event == NULL) {
+      event = ordinary.dequeue();
+    }
+
+    if (event == NULL) {
+      event = low.dequeue();
+    }
+
+    if (event != NULL) {
+      depth_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    return event;
+  }
+
+  // Returns the approximate number of enqueued events, and the most
+  // events that have ever been enqueued at once. May be called from
+  // any thread (the counters are only approximate, see 'enqueue').
+  size_t depth() const
+  {
+    return depth_.load(std::memory_order_relaxed);
+  }
+
+  size_t watermark() const
+  {
+    return watermark_.load(std::memory_order_relaxed);
+  }
+
+  // Returns true if there are no enqueued events. Events that are
+  // currently being linked by a producer are accounted for (i.e., if
+  // 'dequeue' returned NULL spuriously then 'empty' returns false).
+  bool empty()
+  {
+    return injected.empty() && high.empty() && ordinary.empty() &&
+           low.empty();
+  }
+
+  // Prevents any further events from being enqueued. Note that an
+  // enqueue that raced with the decommission may still deposit an
+  // event in the queue; such events get deleted in the destructor.
+  void decommission()
+  {
+    decommissioned.store(true);
+  }
+
+  // Returns the number of events of the specified type. Only the
+  // consumer may call this (it traverses the lists concurrently with
+  // producers and may miss events that are still being linked).
+  template <typename T>
+  size_t count()
+  {
+    return injected.count<T>() + high.count<T>() + ordinary.count<T>() +
+           low.count<T>();
+  }
+
+  // Visits each enqueued event, per class in delivery order. Only
+  // the consumer may call this (see 'count' above).
+  void visit(EventVisitor* visitor)
+  {
+    injected.visit(visitor);
+    high.visit(visitor);
+    ordinary.visit(visitor);
+    low.visit(visitor);
+  }
+
+private:
+  struct Node
+  {
+    explicit Node(Event* _event = NULL) : event(_event), next(NULL) {}
+
+    // A node is allocated per enqueue and freed per dequeue, so like
+    // the events themselves nodes are recycled through a per-thread
+    // free list (see freelist.hpp).
+    static void* operator new(size_t size)
+    {
+      if (size != sizeof(Node)) {
+        return ::operator new(size);
+      }
+      return internal::FreeList<Node>::allocate();
+    }
+
+    static void operator delete(void* pointer)
+    {
+      internal::FreeList<Node>::deallocate(pointer);
+    }
+
+    Event* event;
+    std::atomic<Node*> next;
+  };
+
+  // A single multiple-producer single-consumer linked list. The
+  // 'head' always points to a stub node whose 'event' has already
+  // been consumed (or was never set); the next event to deliver is
+  // in 'head->next'.
+  struct List
+  {
+    List()
+    {
+      head = new Node();
+      tail.store(head);
+    }
+
+    void enqueue(Node* node)
+    {
+      // Wait-free: a producer only performs a single atomic exchange
+      // and is immediately done, even if other producers or the
+      // consumer get descheduled.
+      Node* prev = tail.exchange(node);
+      prev->next.store(node);
+    }
+
+    Event* dequeue()
+    {
+      Node* next = head->next.load();
+
+      if (next == NULL) {
+        return NULL;
+      }
+
+      // Move the head forward, making 'next' the new stub after
+      // taking ownership of its event, and delete the old stub.
+      Event* event = next->event;
+      next->event = NULL;
+
+      Node* stub = head;
+      head = next;
+      delete stub;
+
+      return event;
+    }
+
+    bool empty()
+    {
+      // Note that we check the tail rather than 'head->next' so that
+      // an event whose node has not yet been linked by its producer
+      // still renders the list non-empty.
+      return tail.load() == head;
+    }
+
+    template <typename T>
+    size_t count()
+    {
+      size_t count = 0;
+      for (Node* node = head->next.load();
+           node != NULL;
+           node = node->next.load()) {
+        if (node->event->is<T>()) {
+          count++;
+        }
+      }
+      return count;
+    }
+
+    void visit(EventVisitor* visitor)
+    {
+      for (Node* node = head->next.load();
+           node != NULL;
+           node = node->next.load()) {
+        node->event->visit(visitor);
+      }
+    }
+
+    void destroy()
+    {
+      Node* node = head;
+      while (node != NULL) {
+        Node* next = node->next.load();
+        delete node->event;
+        delete node;
+        node = next;
+      }
+    }
+
+    std::atomic<Node*> tail;
+    Node* head; // Only accessed by the consumer.
+  };
+
+  List injected;
+  List high;
+  List ordinary;
+  List low;
+
+  std::atomic<bool> decommissioned;
+
+  // Approximate queue depth and high-watermark (see 'enqueue').
+  std::atomic<size_t> depth_;
+  std::atomic<size_t> watermark_;
+
+  // Dequeue slot used for the anti-starvation round robin (see
+  // 'dequeue'). Only accessed by the consumer.
+  size_t slot;
+};
+
+} // namespace process {
+
+#endif // __PROCESS_EVENT_QUEUE_HPP__
@@ -0,0 +1,93 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_FREELIST_HPP__
+#define __PROCESS_FREELIST_HPP__
+
+#include <stddef.h>
+
+#include <new>
+
+#include <stout/thread_local.hpp>
+
+namespace process {
+namespace internal {
+
+// A bounded per-thread free list of fixed size memory blocks, used to
+// recycle the small allocations on the message hot path (events,
+// messages and their queue nodes) instead of going through the
+// allocator for every delivered message, where the allocator's
+// central free list becomes a point of contention.
+//
+// Blocks are typically allocated on a sender thread and freed on the
+// thread running the receiving process, so blocks migrate between
+// the threads' lists over time. Each list is therefore bounded:
+// deallocating onto a full list and allocating from an empty one
+// fall back to the global operator new/delete.
+template <typename T>
+class FreeList
+{
+public:
+  static void* allocate()
+  {
+    if (head != NULL) {
+      Block* block = head;
+      head = block->next;
+      size--;
+      return block;
+    }
+
+    return ::operator new(
+        sizeof(T) > sizeof(Block) ? sizeof(T) : sizeof(Block));
+  }
+
+  static void deallocate(void* pointer)
+  {
+    if (size < CAPACITY) {
+      Block* block = static_cast<Block*>(pointer);
+      block->next = head;
+      head = block;
+      size++;
+      return;
+    }
+
+    ::operator delete(pointer);
+  }
+
+private:
+  // A freed block is reused to link the list, so no memory beyond
+  // the blocks themselves is ever allocated.
+  struct Block
+  {
+    Block* next;
+  };
+
+  // Bounds the number of blocks each thread holds on to. With the
+  // small types recycled here this caps the memory retained per
+  // thread and per type to well under a megabyte.
+  static const size_t CAPACITY = 1024;
+
+  static THREAD_LOCAL Block* head;
+  static THREAD_LOCAL size_t size;
+};
+
+
+template <typename T>
+THREAD_LOCAL typename FreeList<T>::Block* FreeList<T>::head = NULL;
+
+template <typename T>
+THREAD_LOCAL size_t FreeList<T>::size = 0;
+
+} // namespace internal {
+} // namespace process {
+
+#endif // __PROCESS_FREELIST_HPP__
@@ -0,0 +1,272 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_HISTOGRAM_HPP__
+#define __PROCESS_HISTOGRAM_HPP__
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include <process/clock.hpp>
+#include <process/statistics.hpp>
+#include <process/time.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/option.hpp>
+
+namespace process {
+
+// A fixed-bucket histogram of non-negative double values, in the
+// style of HDR histograms: the buckets are log-linear, i.e., each
+// power of two is split into SUBBUCKETS equal-width buckets, so the
+// relative error of a recorded value is at most 1 / SUBBUCKETS.
+//
+// Recording a value is a few relaxed atomic increments and computing
+// Statistics is a single O(buckets) pass over the bucket counts, so
+// unlike Statistics<T>::from() no samples are retained, sorted, or
+// allocated.
+//
+// If a window is specified the histogram only reflects (roughly) the
+// values recorded within it: two sets of buckets are kept and
+// rotated every half window, so the reported distribution covers
+// between half and one full window. Without a window the histogram
+// covers its whole lifetime.
+//
+// NOTE: Rotation is racy with respect to concurrent recording: a
+// value recorded while a rotation is clearing the stale buckets may
+// be lost. This is an acceptable trade-off for metrics; it keeps the
+// recording path lock-free.
+class Histogram
+{
+public:
+  explicit Histogram(const Option<Duration>& window = None())
+    : window(window),
+      active(0),
+      lastRotation(Clock::now().duration().ns())
+  {
+    epochs[0].reset();
+    epochs[1].reset();
+  }
+
+  void record(double value)
+  {
+    rotate();
+
+    Epoch& epoch = epochs[active.load(std::memory_order_relaxed)];
+
+    epoch.counts[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    epoch.count.fetch_add(1, std::memory_order_relaxed);
+
+    // Maintain the exact extrema so 'min' and 'max' (and the
+    // percentiles, which are clamped to them) are not subject to
+    // the bucket resolution.
+    double current = epoch.min.load(std::memory_order_relaxed);
+    while (value < current &&
+           !epoch.min.compare_exchange_weak(current, value)) {}
+
+    current = epoch.max.load(std::memory_order_relaxed);
+    while (value > current &&
+           !epoch.max.compare_exchange_weak(current, value)) {}
+  }
+
+  // Returns Statistics over the recorded values, or None() if fewer
+  // than 2 values have been recorded (consistent with
+  // Statistics<T>::from()).
+  Option<Statistics<double>> statistics()
+  {
+    rotate();
+
+    uint64_t counts[BUCKETS];
+    uint64_t count = 0;
+
+    double min = INFINITY;
+    double max = -INFINITY;
+
+    for (size_t i = 0; i < BUCKETS; i++) {
+      counts[i] = 0;
+    }
+
+    // Aggregate over both epochs: the active one and the previous
+    // (possibly empty) half window.
+    for (size_t i = 0; i < 2; i++) {
+      for (size_t j = 0; j < BUCKETS; j++) {
+        counts[j] += epochs[i].counts[j].load(std::memory_order_relaxed);
+      }
+
+      count += epochs[i].count.load(std::memory_order_relaxed);
+
+      min = std::min(min, epochs[i].min.load(std::memory_order_relaxed));
+      max = std::max(max, epochs[i].max.load(std::memory_order_relaxed));
+    }
+
+    if (count < 2) {
+      return None();
+    }
+
+    Statistics<double> statistics;
+
+    statistics.count = count;
+
+    statistics.min = min;
+    statistics.max = max;
+
+    statistics.p50 = percentile(counts, count, min, max, 0.5);
+    statistics.p90 = percentile(counts, count, min, max, 0.90);
+    statistics.p95 = percentile(counts, count, min, max, 0.95);
+    statistics.p99 = percentile(counts, count, min, max, 0.99);
+    statistics.p999 = percentile(counts, count, min, max, 0.999);
+    statistics.p9999 = percentile(counts, count, min, max, 0.9999);
+
+    return statistics;
+  }
+
+private:
+  // Each power of two in [2 ^ MIN_EXPONENT, 2 ^ MAX_EXPONENT) is
+  // split into SUBBUCKETS buckets; bucket 0 holds everything below
+  // the range (including zero) and the last bucket everything above.
+  // The range comfortably covers durations from fractions of a
+  // microsecond up to hours, expressed in any Duration unit.
+  static const int MIN_EXPONENT = -20;
+  static const int MAX_EXPONENT = 44;
+  static const size_t SUBBUCKETS = 32;
+  static const size_t BUCKETS =
+    (MAX_EXPONENT - MIN_EXPONENT) * SUBBUCKETS + 2;
+
+  struct Epoch
+  {
+    void reset()
+    {
+      for (size_t i = 0; i < BUCKETS; i++) {
+        counts[i].store(0, std::memory_order_relaxed);
+      }
+
+      count.store(0, std::memory_order_relaxed);
+
+      min.store(INFINITY, std::memory_order_relaxed);
+      max.store(-INFINITY, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<double> min;
+    std::atomic<double> max;
+  };
+
+  static size_t bucket(double value)
+  {
+    if (std::isnan(value) || value <= 0.0) {
+      return 0;
+    }
+
+    int exponent;
+    double fraction = std::frexp(value, &exponent); // fraction in [0.5, 1).
+
+    if (exponent <= MIN_EXPONENT) {
+      return 0;
+    }
+
+    if (exponent > MAX_EXPONENT) {
+      return BUCKETS - 1;
+    }
+
+    size_t sub = static_cast<size_t>((fraction - 0.5) * 2 * SUBBUCKETS);
+
+    return (exponent - MIN_EXPONENT - 1) * SUBBUCKETS + sub + 1;
+  }
+
+  // The midpoint of the bucket, used as the representative value
+  // when reporting percentiles.
+  static double midpoint(size_t index)
+  {
+    if (index == 0) {
+      return 0.0;
+    }
+
+    index -= 1;
+
+    int exponent = MIN_EXPONENT + 1 + static_cast<int>(index / SUBBUCKETS);
+    size_t sub = index % SUBBUCKETS;
+
+    double lower = std::ldexp(0.5 + 0.5 * sub / SUBBUCKETS, exponent);
+    double upper = std::ldexp(0.5 + 0.5 * (sub + 1) / SUBBUCKETS, exponent);
+
+    return (lower + upper) / 2;
+  }
+
+  static double percentile(
+      const uint64_t (&counts)[BUCKETS],
+      uint64_t count,
+      double min,
+      double max,
+      double percentile)
+  {
+    // The (zero-based) rank of the percentile, mirroring the
+    // positioning used by Statistics<T>::from().
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile * (count - 1)));
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+      cumulative += counts[i];
+      if (cumulative > rank) {
+        // Clamp to the exact extrema since the bucket midpoint can
+        // fall outside of them.
+        return std::max(min, std::min(max, midpoint(i)));
+      }
+    }
+
+    return max;
+  }
+
+  // Rotates the epochs if more than half the window has elapsed
+  // since the last rotation, dropping values recorded before the
+  // previous rotation.
+  void rotate()
+  {
+    if (window.isNone()) {
+      return;
+    }
+
+    int64_t now = Clock::now().duration().ns();
+    int64_t last = lastRotation.load(std::memory_order_relaxed);
+
+    if (now - last < window.get().ns() / 2) {
+      return;
+    }
+
+    // Whoever wins the exchange performs the rotation.
+    if (lastRotation.compare_exchange_strong(last, now)) {
+      size_t next = active.load(std::memory_order_relaxed) == 0 ? 1 : 0;
+      epochs[next].reset();
+      active.store(next, std::memory_order_relaxed);
+
+      // If the histogram was idle for more than the whole window
+      // then the previous epoch is stale as well.
+      if (now - last >= window.get().ns()) {
+        epochs[next == 0 ? 1 : 0].reset();
+      }
+    }
+  }
+
+  const Option<Duration> window;
+
+  Epoch epochs[2];
+
+  std::atomic<size_t> active;
+  std::atomic<int64_t> lastRotation;
+};
+
+} // namespace process {
+
+#endif // __PROCESS_HISTOGRAM_HPP__
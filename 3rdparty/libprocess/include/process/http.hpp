@@ -342,7 +342,9 @@ public:
     // Returns false if the data could not be written because
     // either end of the pipe was already closed. Note that an
     // empty write has no effect.
-    bool write(const std::string& s);
+    // NOTE: Taken by value so that callers writing a temporary
+    // (e.g., a freshly encoded event) incur a move, not a copy.
+    bool write(std::string s);
 
     // Closing the write-end of the pipe will send end-of-file
     // to the reader. Returns false if the write-end of the pipe
@@ -359,6 +361,11 @@ public:
     // was unable to continue reading!
     Future<Nothing> readerClosed() const;
 
+    // Returns the number of bytes written to the pipe that have
+    // not yet been read. This lets a writer detect a reader that
+    // is not keeping up, rather than buffering without bound.
+    size_t outstanding() const;
+
     // Comparison operators useful for checking connection equality.
     bool operator==(const Writer& other) const { return data == other.data; }
     bool operator!=(const Writer& other) const { return !(*this == other); }
@@ -390,7 +397,8 @@ private:
   {
     Data()
       : readEnd(Reader::OPEN),
-        writeEnd(Writer::OPEN) {}
+        writeEnd(Writer::OPEN),
+        writesSize(0) {}
 
     // Rather than use a process to serialize access to the pipe's
     // internal data we use a 'std::atomic_flag'.
@@ -406,6 +414,9 @@ private:
     // empty strings as they serve as a signal for end-of-file.
     std::queue<std::string> writes;
 
+    // Total number of bytes in 'writes'.
+    size_t writesSize;
+
     // Signals when the read-end is closed before the write-end.
     Promise<Nothing> readerClosure;
 
@@ -506,6 +517,21 @@ struct Accepted : Response
 };
 
 
+struct PartialContent : Response
+{
+  PartialContent() : Response(Status::PARTIAL_CONTENT) {}
+
+  explicit PartialContent(const std::string& body)
+    : Response(body, Status::PARTIAL_CONTENT) {}
+};
+
+
+struct NotModified : Response
+{
+  NotModified() : Response(Status::NOT_MODIFIED) {}
+};
+
+
 struct TemporaryRedirect : Response
 {
   explicit TemporaryRedirect(const std::string& url)
@@ -627,6 +653,16 @@ struct UnsupportedMediaType : Response
 };
 
 
+struct RequestedRangeNotSatisfiable : Response
+{
+  RequestedRangeNotSatisfiable()
+    : Response(Status::REQUESTED_RANGE_NOT_SATISFIABLE) {}
+
+  explicit RequestedRangeNotSatisfiable(const std::string& body)
+    : Response(body, Status::REQUESTED_RANGE_NOT_SATISFIABLE) {}
+};
+
+
 struct InternalServerError : Response
 {
   InternalServerError() : Response(Status::INTERNAL_SERVER_ERROR) {}
@@ -50,6 +50,11 @@ public:
   // Discarding this future cancels this acquisition.
   virtual Future<Nothing> acquire();
 
+  // Adjusts the rate at which permits are issued. The new rate only
+  // affects the spacing of permits issued after the adjustment;
+  // permits already scheduled are not re-spaced.
+  virtual void setPermitsPerSecond(double permitsPerSecond);
+
 private:
   // Not copyable, not assignable.
   RateLimiter(const RateLimiter&);
@@ -110,6 +115,12 @@ public:
     return Nothing();
   }
 
+  void setPermitsPerSecond(double _permitsPerSecond)
+  {
+    CHECK_GT(_permitsPerSecond, 0);
+    permitsPerSecond = _permitsPerSecond;
+  }
+
 private:
   // Not copyable, not assignable.
   RateLimiterProcess(const RateLimiterProcess&);
@@ -184,6 +195,12 @@ inline Future<Nothing> RateLimiter::acquire()
   return dispatch(process, &RateLimiterProcess::acquire);
 }
 
+
+inline void RateLimiter::setPermitsPerSecond(double permitsPerSecond)
+{
+  dispatch(process, &RateLimiterProcess::setPermitsPerSecond, permitsPerSecond);
+}
+
 } // namespace process {
 
 #endif // __PROCESS_LIMITER_HPP__
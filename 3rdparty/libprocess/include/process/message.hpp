@@ -13,8 +13,11 @@
 #ifndef __PROCESS_MESSAGE_HPP__
 #define __PROCESS_MESSAGE_HPP__
 
+#include <stddef.h>
+
 #include <string>
 
+#include <process/freelist.hpp>
 #include <process/pid.hpp>
 
 namespace process {
@@ -25,6 +28,22 @@ struct Message
   UPID from;
   UPID to;
   std::string body;
+
+  // Messages are allocated and freed on the message hot path, so
+  // they are recycled through a per-thread free list rather than
+  // going to the allocator each time.
+  static void* operator new(size_t size)
+  {
+    if (size != sizeof(Message)) {
+      return ::operator new(size);
+    }
+    return internal::FreeList<Message>::allocate();
+  }
+
+  static void operator delete(void* pointer)
+  {
+    internal::FreeList<Message>::deallocate(pointer);
+  }
 };
 
 } // namespace process {
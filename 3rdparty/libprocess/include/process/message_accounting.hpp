@@ -0,0 +1,51 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_MESSAGE_ACCOUNTING_HPP__
+#define __PROCESS_MESSAGE_ACCOUNTING_HPP__
+
+#include <string>
+
+#include <stout/duration.hpp>
+
+namespace process {
+namespace messages {
+
+// Per-message-type accounting of sizes and (de)serialization costs,
+// exposed through the metrics endpoint as monotonic counters:
+//
+//   libprocess/messages/<name>/received_bytes
+//   libprocess/messages/<name>/parse_ns
+//   libprocess/messages/<name>/sent_bytes
+//   libprocess/messages/<name>/serialize_ns
+//
+// Counters are created lazily on the first occurrence of a message
+// type and live for the duration of the process; the set of message
+// types is fixed at compile time so the registry is bounded.
+//
+// NOTE: Times are accumulated in nanoseconds rather than microseconds
+// since cheap messages routinely parse in well under a microsecond
+// and would otherwise truncate to zero.
+
+// Records an incoming message along with the time spent parsing it.
+void received(const std::string& name, size_t bytes, const Duration& parse);
+
+// Records the time spent serializing an outgoing message.
+void serialized(const std::string& name, const Duration& duration);
+
+// Records an outgoing message of the given size.
+void sent(const std::string& name, size_t bytes);
+
+} // namespace messages {
+} // namespace process {
+
+#endif // __PROCESS_MESSAGE_ACCOUNTING_HPP__
@@ -0,0 +1,83 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_METRICS_HISTOGRAM_HPP__
+#define __PROCESS_METRICS_HISTOGRAM_HPP__
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include <process/timeseries.hpp>
+
+#include <process/metrics/metric.hpp>
+
+namespace process {
+namespace metrics {
+
+// A Metric that tracks the distribution of observed values with a
+// fixed-bucket (HDR-style) histogram. Observing a value is a few
+// lock-free atomic increments and computing the percentiles for a
+// statistics snapshot is O(buckets) and allocation free, unlike
+// metrics backed by a time series of samples which retain and sort
+// the samples on every snapshot.
+//
+// The value of the metric is the last observation.
+class Histogram : public Metric
+{
+public:
+  // 'name' is the unique name for the instance of Histogram being
+  // constructed. It will be the key exposed in the JSON endpoint.
+  //
+  // 'window' is the amount of history to keep for this Metric.
+  Histogram(
+      const std::string& name,
+      const Option<Duration>& window = TIME_SERIES_WINDOW)
+    : Metric(name, window, true),
+      data(new Data())
+  {}
+
+  virtual ~Histogram() {}
+
+  virtual Future<double> value() const
+  {
+    double value = data->lastValue.load();
+
+    if (std::isnan(value)) {
+      return Failure("No value");
+    }
+
+    return value;
+  }
+
+  // Records 'value' into the distribution.
+  void observe(double value)
+  {
+    data->lastValue.store(value);
+    push(value);
+  }
+
+private:
+  struct Data
+  {
+    Data() : lastValue(NAN) {}
+
+    std::atomic<double> lastValue;
+  };
+
+  std::shared_ptr<Data> data;
+};
+
+} // namespace metrics {
+} // namespace process {
+
+#endif // __PROCESS_METRICS_HISTOGRAM_HPP__
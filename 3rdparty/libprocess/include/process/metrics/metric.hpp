@@ -18,6 +18,7 @@
 #include <string>
 
 #include <process/future.hpp>
+#include <process/histogram.hpp>
 #include <process/owned.hpp>
 #include <process/statistics.hpp>
 #include <process/timeseries.hpp>
@@ -45,7 +46,9 @@ public:
   {
     Option<Statistics<double>> statistics = None();
 
-    if (data->history.isSome()) {
+    if (data->histogram.isSome()) {
+      statistics = data->histogram.get()->statistics();
+    } else if (data->history.isSome()) {
       synchronized (data->lock) {
         statistics = Statistics<double>::from(*data->history.get());
       }
@@ -55,13 +58,22 @@ public:
   }
 
 protected:
-  // Only derived classes can construct.
-  Metric(const std::string& name, const Option<Duration>& window)
-    : data(new Data(name, window)) {}
+  // Only derived classes can construct. If 'histogram' is true the
+  // distribution over the window is tracked with a fixed-bucket
+  // Histogram rather than a time series of samples: pushes are
+  // lock-free and computing statistics is O(buckets) and allocation
+  // free, at the cost of percentiles being approximated by the
+  // bucket resolution ('min' and 'max' remain exact).
+  Metric(const std::string& name,
+         const Option<Duration>& window,
+         bool histogram = false)
+    : data(new Data(name, window, histogram)) {}
 
   // Inserts 'value' into the history for this metric.
   void push(double value) {
-    if (data->history.isSome()) {
+    if (data->histogram.isSome()) {
+      data->histogram.get()->record(value);
+    } else if (data->history.isSome()) {
       Time now = Clock::now();
 
       synchronized (data->lock) {
@@ -72,13 +84,24 @@ protected:
 
 private:
   struct Data {
-    Data(const std::string& _name, const Option<Duration>& window)
+    Data(
+        const std::string& _name,
+        const Option<Duration>& window,
+        bool _histogram)
       : name(_name),
-        history(None())
+        history(None()),
+        histogram(None())
     {
       if (window.isSome()) {
-        history =
-          Owned<TimeSeries<double>>(new TimeSeries<double>(window.get()));
+        if (_histogram) {
+          histogram = Owned<Histogram>(new Histogram(window.get()));
+        } else {
+          // NOTE: we use the tiered time series since metrics are
+          // pushed at high frequency (e.g. Timer) and are always
+          // sampled in time order.
+          history = Owned<TieredTimeSeries<double>>(
+              new TieredTimeSeries<double>(window.get()));
+        }
       }
     }
 
@@ -86,7 +109,9 @@ private:
 
     std::atomic_flag lock = ATOMIC_FLAG_INIT;
 
-    Option<Owned<TimeSeries<double>>> history;
+    Option<Owned<TieredTimeSeries<double>>> history;
+
+    Option<Owned<Histogram>> histogram;
   };
 
   std::shared_ptr<Data> data;
@@ -0,0 +1,96 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_METRICS_PUSH_GAUGE_HPP__
+#define __PROCESS_METRICS_PUSH_GAUGE_HPP__
+
+#include <memory>
+#include <string>
+
+#include <process/metrics/metric.hpp>
+
+namespace process {
+namespace metrics {
+
+// A Metric that represents an instantaneous measurement of a value
+// that is _pushed_ by the owner whenever it changes, rather than
+// _pulled_ out of the owner when the value is requested.
+//
+// Unlike a pull-based `Gauge`, reading a `PushGauge` is a single
+// atomic load and does not dispatch into the owning actor. This
+// means a snapshot of the metrics does not inject any work into
+// busy actors (e.g., the master), at the cost of requiring the
+// owner to keep the value up-to-date at each mutation site.
+//
+// NOTE: Prefer a `PushGauge` over a pull-based `Gauge` whenever the
+// value is cheap to maintain incrementally.
+class PushGauge : public Metric
+{
+public:
+  // 'name' is the unique name for the instance of PushGauge being
+  // constructed. It will be the key exposed in the JSON endpoint.
+  PushGauge(const std::string& name, const Option<Duration>& window = None())
+    : Metric(name, window), data(new Data()) {}
+
+  virtual ~PushGauge() {}
+
+  virtual Future<double> value() const
+  {
+    return static_cast<double>(data->value.load());
+  }
+
+  PushGauge& operator=(int64_t v)
+  {
+    data->value.store(v);
+    push(v);
+    return *this;
+  }
+
+  PushGauge& operator++()
+  {
+    return *this += 1;
+  }
+
+  PushGauge& operator+=(int64_t v)
+  {
+    int64_t prev = data->value.fetch_add(v);
+    push(prev + v);
+    return *this;
+  }
+
+  PushGauge& operator--()
+  {
+    return *this -= 1;
+  }
+
+  PushGauge& operator-=(int64_t v)
+  {
+    int64_t prev = data->value.fetch_sub(v);
+    push(prev - v);
+    return *this;
+  }
+
+private:
+  struct Data
+  {
+    explicit Data() : value(0) {}
+
+    std::atomic<int64_t> value;
+  };
+
+  std::shared_ptr<Data> data;
+};
+
+} // namespace metrics {
+} // namespace process {
+
+#endif // __PROCESS_METRICS_PUSH_GAUGE_HPP__
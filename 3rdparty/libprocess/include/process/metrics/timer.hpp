@@ -38,8 +38,12 @@ class Timer : public Metric
 {
 public:
   // The Timer name will have a unit suffix added automatically.
+  // NOTE: When a window is specified the distribution is tracked
+  // with a fixed-bucket Histogram rather than a time series of
+  // samples, since latencies are pushed at high frequency and the
+  // samples would otherwise be sorted on every statistics snapshot.
   Timer(const std::string& name, const Option<Duration>& window = None())
-    : Metric(name + "_" + T::units(), window),
+    : Metric(name + "_" + T::units(), window, true),
       data(new Data()) {}
 
   Future<double> value() const
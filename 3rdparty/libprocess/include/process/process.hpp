@@ -15,13 +15,18 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <queue>
+#include <set>
+#include <string>
 #include <vector>
 
 #include <process/address.hpp>
 #include <process/clock.hpp>
 #include <process/event.hpp>
+#include <process/event_queue.hpp>
 #include <process/filter.hpp>
 #include <process/firewall.hpp>
 #include <process/http.hpp>
@@ -197,6 +202,20 @@ protected:
     delegates[name] = pid;
   }
 
+  /**
+   * Marks messages with the specified name as latency-critical.
+   *
+   * Such messages are delivered ahead of ordinary events and of
+   * (background) HTTP requests, modulo the anti-starvation slots of
+   * the event queue, so that under overload a process degrades its
+   * background work rather than its critical messages. Note that
+   * delivery order is only guaranteed between events of the same
+   * priority class.
+   *
+   * @see process::EventQueue::Priority
+   */
+  void prioritize(const std::string& name);
+
   /**
    * Any function which takes a `process::http::Request` and returns a
    * `process::http::Response`.
@@ -312,18 +331,14 @@ protected:
 
   /**
    * Returns the number of events of the given type currently on the event
-   * queue.
+   * queue. Must be called from within the process itself (i.e., from an
+   * event handler) since the event queue may only be inspected by the
+   * thread currently running the process.
    */
   template <typename T>
   size_t eventCount()
   {
-    size_t count = 0U;
-
-    synchronized (mutex) {
-      count = std::count_if(events.begin(), events.end(), isEventType<T>);
-    }
-
-    return count;
+    return events.count<T>();
   }
 
 private:
@@ -332,8 +347,12 @@ private:
   friend class ProcessReference;
   friend void* schedule(void*);
 
-  // Process states.
-  enum
+  // Process states. The state is atomic so that producers delivering
+  // events and the thread running the process can race to transition
+  // a BLOCKED process to READY without any locking (whoever wins the
+  // transition is responsible for making the process runnable), see
+  // ProcessBase::enqueue and ProcessManager::resume.
+  enum State
   {
     BOTTOM,
     READY,
@@ -341,17 +360,9 @@ private:
     BLOCKED,
     TERMINATING,
     TERMINATED
-  } state;
-
-  template <typename T>
-  static bool isEventType(const Event* event)
-  {
-    return event->is<T>();
-  }
+  };
 
-  // Mutex protecting internals.
-  // TODO(benh): Consider replacing with a spinlock, on multi-core systems.
-  std::recursive_mutex mutex;
+  std::atomic<State> state;
 
   // Enqueue the specified message, request, or function call.
   void enqueue(Event* event, bool inject = false);
@@ -402,8 +413,49 @@ private:
   // Static assets(s) to provide.
   std::map<std::string, Asset> assets;
 
-  // Queue of received events, requires lock()ed access!
-  std::deque<Event*> events;
+  // Queue of received events. Senders enqueue without taking any
+  // locks; only the thread currently running the process may dequeue.
+  EventQueue events;
+
+  // Names of the latency-critical messages (see 'prioritize'). Read
+  // by senders in 'enqueue' concurrently with updates, hence the
+  // copy-on-write shared pointer (accessed via std::atomic_load and
+  // std::atomic_store).
+  std::shared_ptr<const std::set<std::string>> prioritized;
+
+  // A trace of a serviced event: what the event was, how long it
+  // waited in the queue, and how long the handler took. Rendered by
+  // the /__processes__ endpoint for chasing tail latencies.
+  struct EventTrace
+  {
+    std::string type;
+    std::string name; // Message name, dispatch type, or HTTP path.
+    Duration queued;  // Time spent waiting in the event queue.
+    Duration served;  // Time spent in the handler.
+  };
+
+  // Records a (sampled) trace of a serviced event into 'traces'.
+  // Invoked by ProcessManager::resume, hence like the event queue
+  // only the thread currently running the process accesses the
+  // traces.
+  void trace(
+      const Event& event,
+      const Duration& queued,
+      const Duration& served);
+
+  // Only every TRACE_SAMPLE_INTERVAL'th serviced event is traced so
+  // that the bookkeeping stays off the hot path, and only the last
+  // TRACE_CAPACITY samples are kept.
+  static const size_t TRACE_SAMPLE_INTERVAL = 64;
+  static const size_t TRACE_CAPACITY = 32;
+
+  std::vector<EventTrace> traces;
+
+  // Index of the oldest entry in 'traces' once it is at capacity.
+  size_t tracesIndex;
+
+  // Number of events serviced, used for sampling.
+  size_t serviced;
 
   // Active references.
   std::atomic_long refs;
@@ -550,6 +602,21 @@ void post(const UPID& from,
           size_t length = 0);
 
 
+/**
+ * Returns whether the link to the given process has more queued
+ * outgoing bytes than the send queue high watermark (default 64MB,
+ * override with LIBPROCESS_SEND_QUEUE_HIGH_WATERMARK).
+ *
+ * This is advisory: libprocess never drops queued messages itself,
+ * but senders can consult this to defer or drop their own work
+ * rather than growing the queue without bound while a remote is
+ * stuck (e.g., during a partial network failure).
+ *
+ * @param to A process on the remote in question.
+ */
+bool congested(const UPID& to);
+
+
 /**
  * @copydoc process::terminate
  */
@@ -17,6 +17,7 @@
 
 #include <process/future.hpp>
 #include <process/http.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 
 namespace process {
@@ -33,11 +34,13 @@ protected:
   {
     route("/start", START_HELP(), &Profiler::start);
     route("/stop", STOP_HELP(), &Profiler::stop);
+    route("/profile", PROFILE_HELP(), &Profiler::profile);
   }
 
 private:
   static const std::string START_HELP();
   static const std::string STOP_HELP();
+  static const std::string PROFILE_HELP();
 
   // HTTP endpoints.
 
@@ -49,6 +52,21 @@ private:
   // in the working directory.
   Future<http::Response> stop(const http::Request& request);
 
+  // Collects a sampling CPU profile over the requested duration
+  // (default 10 seconds, 'duration' request parameter) and responds
+  // with folded stacks suitable for generating a flame graph. Unlike
+  // start/stop above this does not require gperftools or any special
+  // build: samples are taken with a SIGPROF handler.
+  Future<http::Response> profile(const http::Request& request);
+
+  // Invoked once the sampling window of an in-progress profile has
+  // elapsed.
+  void _profile();
+
+  // Satisfied with the rendered profile once sampling finishes.
+  // NULL when no profile is in progress.
+  Owned<Promise<http::Response>> promise;
+
   bool started;
 };
 
@@ -18,15 +18,18 @@
 #include <google/protobuf/message.h>
 #include <google/protobuf/repeated_field.h>
 
+#include <memory>
 #include <set>
 #include <vector>
 
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
+#include <process/message_accounting.hpp>
 #include <process/process.hpp>
 
 #include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
+#include <stout/stopwatch.hpp>
 
 
 // Provides an implementation of process::post that for a protobuf.
@@ -36,7 +39,10 @@ inline void post(const process::UPID& to,
                  const google::protobuf::Message& message)
 {
   std::string data;
+  Stopwatch stopwatch;
+  stopwatch.start();
   message.SerializeToString(&data);
+  messages::serialized(message.GetTypeName(), stopwatch.elapsed());
   post(to, message.GetTypeName(), data.data(), data.size());
 }
 
@@ -46,7 +52,10 @@ inline void post(const process::UPID& from,
                  const google::protobuf::Message& message)
 {
   std::string data;
+  Stopwatch stopwatch;
+  stopwatch.start();
   message.SerializeToString(&data);
+  messages::serialized(message.GetTypeName(), stopwatch.elapsed());
   post(from, to, message.GetTypeName(), data.data(), data.size());
 }
 
@@ -111,7 +120,10 @@ protected:
             const google::protobuf::Message& message)
   {
     std::string data;
+    Stopwatch stopwatch;
+    stopwatch.start();
     message.SerializeToString(&data);
+    process::messages::serialized(message.GetTypeName(), stopwatch.elapsed());
     process::Process<T>::send(to, message.GetTypeName(),
                               data.data(), data.size());
   }
@@ -121,23 +133,29 @@ protected:
   void reply(const google::protobuf::Message& message)
   {
     CHECK(from) << "Attempting to reply without a sender";
-    std::string data;
-    message.SerializeToString(&data);
     send(from, message);
   }
 
   // TODO(vinod): Use ENUM_PARAMS for the overloads.
+  // NOTE: Each handler reuses a single message instance across
+  // invocations (bound into the handler at install time) rather than
+  // parsing into a fresh message every time: clearing a message
+  // retains its internal allocations (strings, repeated fields,
+  // sub-messages) so high-rate message types stop churning malloc.
+  // This is safe because the handlers of a process are never invoked
+  // concurrently. Note that the message passed to a handler is only
+  // valid for the duration of the invocation (which was already the
+  // case when it lived on the stack).
   // Installs that take the sender as the first argument.
   template <typename M>
   void install(void (T::*method)(const process::UPID&, const M&))
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handlerM<M>,
-                   t, method,
+                   t, method, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M>
@@ -158,13 +176,12 @@ protected:
       void (T::*method)(const process::UPID&, P1C),
       P1 (M::*param1)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler1<M, P1, P1C>,
-                   t, method, param1,
+                   t, method, param1, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -175,13 +192,12 @@ protected:
       P1 (M::*p1)() const,
       P2 (M::*p2)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler2<M, P1, P1C, P2, P2C>,
-                   t, method, p1, p2,
+                   t, method, p1, p2, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -194,13 +210,12 @@ protected:
       P2 (M::*p2)() const,
       P3 (M::*p3)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler3<M, P1, P1C, P2, P2C, P3, P3C>,
-                   t, method, p1, p2, p3,
+                   t, method, p1, p2, p3, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -215,13 +230,12 @@ protected:
       P3 (M::*p3)() const,
       P4 (M::*p4)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler4<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C>,
-                   t, method, p1, p2, p3, p4,
+                   t, method, p1, p2, p3, p4, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -238,13 +252,12 @@ protected:
       P4 (M::*p4)() const,
       P5 (M::*p5)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler5<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C, P5, P5C>,
-                   t, method, p1, p2, p3, p4, p5,
+                   t, method, p1, p2, p3, p4, p5, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -263,27 +276,25 @@ protected:
       P5 (M::*p5)() const,
       P6 (M::*p6)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler6<M, P1, P1C, P2, P2C, P3, P3C,
                                 P4, P4C, P5, P5C, P6, P6C>,
-                   t, method, p1, p2, p3, p4, p5, p6,
+                   t, method, p1, p2, p3, p4, p5, p6, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   // Installs that do not take the sender.
   template <typename M>
   void install(void (T::*method)(const M&))
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handlerM<M>,
-                   t, method,
+                   t, method, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M>
@@ -304,13 +315,12 @@ protected:
       void (T::*method)(P1C),
       P1 (M::*param1)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler1<M, P1, P1C>,
-                   t, method, param1,
+                   t, method, param1, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -321,13 +331,12 @@ protected:
       P1 (M::*p1)() const,
       P2 (M::*p2)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler2<M, P1, P1C, P2, P2C>,
-                   t, method, p1, p2,
+                   t, method, p1, p2, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -340,13 +349,12 @@ protected:
       P2 (M::*p2)() const,
       P3 (M::*p3)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler3<M, P1, P1C, P2, P2C, P3, P3C>,
-                   t, method, p1, p2, p3,
+                   t, method, p1, p2, p3, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -361,13 +369,12 @@ protected:
       P3 (M::*p3)() const,
       P4 (M::*p4)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler4<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C>,
-                   t, method, p1, p2, p3, p4,
+                   t, method, p1, p2, p3, p4, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -384,13 +391,12 @@ protected:
       P4 (M::*p4)() const,
       P5 (M::*p5)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler5<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C, P5, P5C>,
-                   t, method, p1, p2, p3, p4, p5,
+                   t, method, p1, p2, p3, p4, p5, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   template <typename M,
@@ -409,34 +415,45 @@ protected:
       P5 (M::*p5)() const,
       P6 (M::*p6)() const)
   {
-    google::protobuf::Message* m = new M();
+    std::shared_ptr<M> m(new M());
     T* t = static_cast<T*>(this);
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler6<M, P1, P1C, P2, P2C, P3, P3C,
                                  P4, P4C, P5, P5C, P6, P6C>,
-                   t, method, p1, p2, p3, p4, p5, p6,
+                   t, method, p1, p2, p3, p4, p5, p6, m,
                    lambda::_1, lambda::_2);
-    delete m;
   }
 
   using process::Process<T>::install;
 
 private:
+  // Parses 'data' into 'm', accounting the message size and time
+  // spent parsing against the message type's metrics.
+  template <typename M>
+  static void parse(const std::shared_ptr<M>& m, const std::string& data)
+  {
+    Stopwatch stopwatch;
+    stopwatch.start();
+    m->ParseFromString(data);
+    process::messages::received(
+        m->GetTypeName(), data.size(), stopwatch.elapsed());
+  }
+
   // Handlers that take the sender as the first argument.
   template <typename M>
   static void handlerM(
       T* t,
       void (T::*method)(const process::UPID&, const M&),
+      const std::shared_ptr<M>& m,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(sender, m);
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(sender, *m);
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -455,16 +472,16 @@ private:
       T* t,
       void (T::*method)(const process::UPID&, P1C),
       P1 (M::*p1)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(sender, google::protobuf::convert((&m->*p1)()));
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(sender, google::protobuf::convert((m.get()->*p1)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -476,18 +493,18 @@ private:
       void (T::*method)(const process::UPID&, P1C, P2C),
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
+    parse(m, data);
+    if (m->IsInitialized()) {
       (t->*method)(sender,
-                   google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()));
+                   google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -501,19 +518,19 @@ private:
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
+    parse(m, data);
+    if (m->IsInitialized()) {
       (t->*method)(sender,
-                   google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()));
+                   google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -529,20 +546,20 @@ private:
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
+    parse(m, data);
+    if (m->IsInitialized()) {
       (t->*method)(sender,
-                   google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()),
-                   google::protobuf::convert((&m->*p4)()));
+                   google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()),
+                   google::protobuf::convert((m.get()->*p4)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -560,21 +577,21 @@ private:
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
+    parse(m, data);
+    if (m->IsInitialized()) {
       (t->*method)(sender,
-                   google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()),
-                   google::protobuf::convert((&m->*p4)()),
-                   google::protobuf::convert((&m->*p5)()));
+                   google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()),
+                   google::protobuf::convert((m.get()->*p4)()),
+                   google::protobuf::convert((m.get()->*p5)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -594,22 +611,22 @@ private:
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
       P6 (M::*p6)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
+    parse(m, data);
+    if (m->IsInitialized()) {
       (t->*method)(sender,
-                   google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()),
-                   google::protobuf::convert((&m->*p4)()),
-                   google::protobuf::convert((&m->*p5)()),
-                   google::protobuf::convert((&m->*p6)()));
+                   google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()),
+                   google::protobuf::convert((m.get()->*p4)()),
+                   google::protobuf::convert((m.get()->*p5)()),
+                   google::protobuf::convert((m.get()->*p6)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -619,16 +636,16 @@ private:
   static void _handlerM(
       T* t,
       void (T::*method)(const M&),
+      const std::shared_ptr<M>& m,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(m);
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(*m);
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -647,16 +664,16 @@ private:
       T* t,
       void (T::*method)(P1C),
       P1 (M::*p1)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(google::protobuf::convert((&m->*p1)()));
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(google::protobuf::convert((m.get()->*p1)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -668,17 +685,17 @@ private:
       void (T::*method)(P1C, P2C),
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()));
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -692,18 +709,18 @@ private:
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()));
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -719,19 +736,19 @@ private:
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()),
-                   google::protobuf::convert((&m->*p4)()));
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()),
+                   google::protobuf::convert((m.get()->*p4)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -749,20 +766,20 @@ private:
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()),
-                   google::protobuf::convert((&m->*p4)()),
-                   google::protobuf::convert((&m->*p5)()));
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()),
+                   google::protobuf::convert((m.get()->*p4)()),
+                   google::protobuf::convert((m.get()->*p5)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
@@ -782,21 +799,21 @@ private:
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
       P6 (M::*p6)() const,
+      const std::shared_ptr<M>& m,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
-    if (m.IsInitialized()) {
-      (t->*method)(google::protobuf::convert((&m->*p1)()),
-                   google::protobuf::convert((&m->*p2)()),
-                   google::protobuf::convert((&m->*p3)()),
-                   google::protobuf::convert((&m->*p4)()),
-                   google::protobuf::convert((&m->*p5)()),
-                   google::protobuf::convert((&m->*p6)()));
+    parse(m, data);
+    if (m->IsInitialized()) {
+      (t->*method)(google::protobuf::convert((m.get()->*p1)()),
+                   google::protobuf::convert((m.get()->*p2)()),
+                   google::protobuf::convert((m.get()->*p3)()),
+                   google::protobuf::convert((m.get()->*p4)()),
+                   google::protobuf::convert((m.get()->*p5)()),
+                   google::protobuf::convert((m.get()->*p6)()));
     } else {
       LOG(WARNING) << "Initialization errors: "
-                   << m.InitializationErrorString();
+                   << m->InitializationErrorString();
     }
   }
 
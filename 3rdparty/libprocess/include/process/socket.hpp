@@ -15,6 +15,7 @@
 
 #ifndef __WINDOWS__
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 #endif // __WINDOWS__
 
@@ -141,6 +142,18 @@ public:
     virtual Future<Nothing> connect(const Address& address) = 0;
     virtual Future<size_t> recv(char* data, size_t size) = 0;
     virtual Future<size_t> send(const char* data, size_t size) = 0;
+
+    /**
+     * An overload of `send` that performs a gather write of the
+     * specified array of buffers. The default implementation simply
+     * sends the first non-empty buffer (callers already treat the
+     * result as a potentially partial send and follow up with the
+     * remaining data); implementations backed by a connected file
+     * descriptor override this to write all the buffers with a
+     * single writev.
+     */
+    virtual Future<size_t> send(const iovec* iov, int iovcnt);
+
     virtual Future<size_t> sendfile(int fd, off_t offset, size_t size) = 0;
 
     /**
@@ -283,6 +296,11 @@ public:
     return impl->send(data, size);
   }
 
+  Future<size_t> send(const iovec* iov, int iovcnt) const
+  {
+    return impl->send(iov, iovcnt);
+  }
+
   Future<size_t> sendfile(int fd, off_t offset, size_t size) const
   {
     return impl->sendfile(fd, offset, size);
@@ -35,8 +35,17 @@ struct Statistics
   // performance.
   static Option<Statistics<T> > from(const TimeSeries<T>& timeseries)
   {
-    std::vector<typename TimeSeries<T>::Value> values_ = timeseries.get();
+    return from(timeseries.get());
+  }
 
+  static Option<Statistics<T> > from(const TieredTimeSeries<T>& timeseries)
+  {
+    return from(timeseries.get());
+  }
+
+  static Option<Statistics<T> > from(
+      const std::vector<typename TimeSeries<T>::Value>& values_)
+  {
     // We need at least 2 values to compute aggregates.
     if (values_.size() < 2) {
       return None();
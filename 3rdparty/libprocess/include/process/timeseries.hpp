@@ -14,6 +14,7 @@
 #define __PROCESS_TIMESERIES_HPP__
 
 #include <algorithm> // For max.
+#include <deque>
 #include <map>
 #include <vector>
 
@@ -21,6 +22,7 @@
 #include <process/time.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/foreach.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 
@@ -249,6 +251,172 @@ private:
   Option<size_t> index;
 };
 
+
+// An append-only time series with O(1) insertion, designed for
+// high-frequency, monotonically increasing samples (e.g. monitoring
+// data). Values are stored in a hierarchy of bounded buffers ("tiers")
+// of increasing granularity: recent samples are kept verbatim and,
+// once evicted from the raw tier, are downsampled into coarser tiers
+// (at most one sample per tier granularity). Compared to TimeSeries
+// this avoids both the per-insert tree rebalancing and the
+// sparsification scans, at the cost of only supporting in-order
+// insertion: out-of-order samples are dropped.
+template <typename T>
+struct TieredTimeSeries
+{
+  typedef typename TimeSeries<T>::Value Value;
+
+  TieredTimeSeries(const Duration& _window = TIME_SERIES_WINDOW,
+                   size_t capacity = TIME_SERIES_CAPACITY)
+    : window(_window)
+  {
+    // Half of the capacity holds raw samples and the remainder is
+    // split across the downsampled tiers, mirroring the granularity
+    // distribution that TimeSeries converges to.
+    tiers.push_back(Tier(Duration::zero(), std::max((size_t) 1, capacity / 2)));
+    tiers.push_back(Tier(Seconds(10), std::max((size_t) 1, capacity / 4)));
+    tiers.push_back(Tier(Minutes(1), std::max((size_t) 1, capacity / 4)));
+  }
+
+  void set(const T& value, const Time& time = Clock::now())
+  {
+    // NOTE: we only support in-order insertion: all callers sample
+    // with Clock::now(), and accepting older samples would require
+    // a sorted container, which is what we're avoiding here.
+    if (!tiers[0].values.empty() && time < tiers[0].values.back().time) {
+      return;
+    }
+
+    Option<Value> evicted = tiers[0].push(Value(time, value));
+
+    // Cascade evictions into the coarser tiers. Each tier accepts at
+    // most one sample per granularity and drops the rest, so this is
+    // O(# tiers) per insertion.
+    for (size_t i = 1; evicted.isSome() && i < tiers.size(); i++) {
+      if (!tiers[i].values.empty() &&
+          evicted.get().time - tiers[i].values.back().time <
+            tiers[i].granularity) {
+        evicted = None();
+      } else {
+        evicted = tiers[i].push(evicted.get());
+      }
+    }
+
+    truncate();
+  }
+
+  // Returns the time series within the (optional) time range, in
+  // time order. Note that the tiers hold disjoint, ordered time
+  // ranges by construction: values are only ever evicted from the
+  // old end of a tier into the next coarser one.
+  std::vector<Value> get(
+      const Option<Time>& start = None(),
+      const Option<Time>& stop = None()) const
+  {
+    // Ignore invalid ranges.
+    if (start.isSome() && stop.isSome() && start.get() > stop.get()) {
+      return std::vector<Value>();
+    }
+
+    std::vector<Value> result;
+
+    for (size_t i = tiers.size(); i-- > 0;) {
+      foreach (const Value& value, tiers[i].values) {
+        if (start.isSome() && value.time < start.get()) {
+          continue;
+        }
+        if (stop.isSome() && value.time > stop.get()) {
+          break;
+        }
+        result.push_back(value);
+      }
+    }
+
+    return result;
+  }
+
+  Option<Value> latest() const
+  {
+    for (size_t i = 0; i < tiers.size(); i++) {
+      if (!tiers[i].values.empty()) {
+        return tiers[i].values.back();
+      }
+    }
+
+    return None();
+  }
+
+  bool empty() const
+  {
+    foreach (const Tier& tier, tiers) {
+      if (!tier.values.empty()) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Removes values outside the time window, ensuring at least one
+  // value remains. This is called automatically when writing to the
+  // time series.
+  void truncate()
+  {
+    Time expired = Clock::now() - window;
+
+    size_t size = 0;
+    foreach (const Tier& tier, tiers) {
+      size += tier.values.size();
+    }
+
+    for (size_t i = tiers.size(); i-- > 0;) {
+      std::deque<Value>& values = tiers[i].values;
+      while (size > 1 && !values.empty() && values.front().time < expired) {
+        values.pop_front();
+        size--;
+      }
+    }
+  }
+
+private:
+  struct Tier
+  {
+    Tier(const Duration& _granularity, size_t _capacity)
+      : granularity(_granularity), capacity(_capacity) {}
+
+    // Appends the value, returning the evicted oldest value when
+    // at capacity.
+    Option<Value> push(const Value& value)
+    {
+      Option<Value> evicted = None();
+
+      if (values.size() >= capacity) {
+        evicted = values.front();
+        values.pop_front();
+      }
+
+      values.push_back(value);
+
+      return evicted;
+    }
+
+    // The minimum time between consecutive samples in this tier;
+    // zero for the raw tier.
+    Duration granularity;
+    size_t capacity;
+
+    // Values in time order, oldest first.
+    std::deque<Value> values;
+  };
+
+  // Non-const for assignability.
+  Duration window;
+
+  // Tiers in increasing granularity: values enter at the front
+  // (raw) tier and are downsampled towards the back.
+  std::vector<Tier> tiers;
+};
+
 } // namespace process {
 
 #endif // __PROCESS_TIMESERIES_HPP__
@@ -39,10 +39,27 @@ using std::set;
 
 namespace process {
 
-// We store the timers in a map of lists indexed by the timeout of the
-// timer so that we can have two timers that have the same timeout. We
-// exploit that the map is SORTED!
-static map<Time, list<Timer>>* timers = new map<Time, list<Timer>>();
+// We shard the timers across a number of independently locked maps,
+// hashed by timer id, so that arming and canceling timers on
+// different threads doesn't contend on a single global lock (timer
+// churn from health checks and timeouts is visible in profiles).
+// Each shard is a map of lists indexed by the timeout of the timer so
+// that we can have two timers that have the same timeout. We exploit
+// that the map is SORTED!
+static const size_t TIMER_SHARDS = 16;
+
+struct TimerShard
+{
+  std::mutex mutex;
+  map<Time, list<Timer>> timers;
+};
+
+static TimerShard* timer_shards = new TimerShard[TIMER_SHARDS];
+
+// Protects the clock related variables below (and 'ticks'). To avoid
+// deadlock, 'timers_mutex' may be acquired while holding a shard
+// mutex but a shard mutex must never be acquired while holding
+// 'timers_mutex'.
 static recursive_mutex* timers_mutex = new recursive_mutex();
 
 
@@ -77,32 +94,26 @@ lambda::function<void(const list<Timer>&)>* callback =
 set<Time>* ticks = new set<Time>();
 
 
-// Helper for determining the time when the next timer elapses,
-// or None if no timers are pending, or the clock is paused and no
-// timers are expired. Note that we don't manipulate 'timers' directly
-// so that it's clear from the callsite that the use of 'timers' is
-// within a 'synchronized' block.
-//
-// TODO(benh): Create a generic 'Timers' abstraction which hides this
-// and more away (i.e., all manipulations of 'timers' below).
-Option<Time> next(const map<Time, list<Timer>>& timers)
+// Helper for determining the time when the next timer elapses across
+// all of the shards, or None if no timers are pending. Note that this
+// acquires each shard mutex in turn and therefore must not be called
+// while holding 'timers_mutex'.
+Option<Time> earliest()
 {
-  if (!timers.empty()) {
-    Time first = timers.begin()->first;
-
-    // If the clock is paused and no timers are expired, the
-    // timers cannot fire until the clock is advanced, so we
-    // return None() here. Note that we pass NULL to ensure
-    // that this looks at the global clock, since this can be
-    // called from a Process context through Clock::timer.
-    if (Clock::paused() && first > Clock::now(NULL)) {
-      return None();
+  Option<Time> result = None();
+
+  for (size_t i = 0; i < TIMER_SHARDS; i++) {
+    synchronized (timer_shards[i].mutex) {
+      if (!timer_shards[i].timers.empty()) {
+        const Time& first = timer_shards[i].timers.begin()->first;
+        if (result.isNone() || first < result.get()) {
+          result = first;
+        }
+      }
     }
-
-    return first;
   }
 
-  return None();
+  return result;
 }
 
 
@@ -110,79 +121,101 @@ Option<Time> next(const map<Time, list<Timer>>& timers)
 void tick(const Time& time);
 
 
-// Helper for scheduling the next clock tick, if applicable. Note
-// that we don't manipulate 'timers' or 'ticks' directly so that
-// it's clear from the callsite that this needs to be called within
-// a 'synchronized' block.
-// TODO(bmahler): Consider taking an optional 'now' to avoid
-// excessive syscalls via Clock::now(NULL).
-void scheduleTick(const map<Time, list<Timer>>& timers, set<Time>* ticks)
+// Helper for scheduling a clock tick for the timer(s) elapsing at
+// 'next', if applicable. Note that we don't manipulate 'ticks'
+// directly so that it's clear from the callsite that this needs to be
+// called within a 'synchronized' block. Since 'tick' must remain
+// robust to arbitrary invocations it's always safe to schedule a
+// tick, we just avoid redundant ones.
+void scheduleTick(const Time& next, set<Time>* ticks)
 {
-  // Determine when the next 'tick' should fire.
-  const Option<Time> next = clock::next(timers);
-
-  if (next.isSome()) {
-    // Don't schedule a 'tick' if there is a 'tick' scheduled for
-    // an earlier time, to avoid excessive pending timers.
-    if (ticks->empty() || next.get() < (*ticks->begin())) {
-      ticks->insert(next.get());
-
-      // The delay can be negative if the timer is expired, this
-      // is expected will result in a 'tick' firing immediately.
-      const Duration delay = next.get() - Clock::now(NULL);
-      EventLoop::delay(delay, lambda::bind(tick, next.get()));
-    }
+  // If the clock is paused and the timer is not expired, the timer
+  // cannot fire until the clock is advanced, so there is nothing to
+  // schedule. Note that we pass NULL to ensure that this looks at the
+  // global clock, since this can be called from a Process context
+  // through Clock::timer.
+  if (Clock::paused() && next > Clock::now(NULL)) {
+    return;
+  }
+
+  // Don't schedule a 'tick' if there is a 'tick' scheduled for
+  // an earlier time, to avoid excessive pending timers.
+  if (ticks->empty() || next < (*ticks->begin())) {
+    ticks->insert(next);
+
+    // The delay can be negative if the timer is expired, this
+    // is expected will result in a 'tick' firing immediately.
+    const Duration delay = next - Clock::now(NULL);
+    EventLoop::delay(delay, lambda::bind(tick, next));
   }
 }
 
 
 // NOTE: This method must remain robust to arbitrary invocations.
-// i.e. `tick` should not make any assumptions of what is held in `timers`,
-// which can be empty or have timers that trigger later than the current time.
+// i.e. `tick` should not make any assumptions of what is held in the
+// timer shards, which can be empty or have timers that trigger later
+// than the current time.
 void tick(const Time& time)
 {
   list<Timer> timedout;
 
-  synchronized (timers_mutex) {
-    // We pass NULL to be explicit about the fact that we want the
-    // global clock time, even though it's unnecessary ('tick' is
-    // called from the event loop, not a Process context).
-    Time now = Clock::now(NULL);
+  // We pass NULL to be explicit about the fact that we want the
+  // global clock time, even though it's unnecessary ('tick' is
+  // called from the event loop, not a Process context).
+  Time now = Clock::now(NULL);
 
-    VLOG(3) << "Handling timers up to " << now;
+  VLOG(3) << "Handling timers up to " << now;
 
-    foreachkey (const Time& timeout, *timers) {
-      if (timeout > now) {
-        break;
-      }
+  for (size_t i = 0; i < TIMER_SHARDS; i++) {
+    synchronized (timer_shards[i].mutex) {
+      map<Time, list<Timer>>& timers = timer_shards[i].timers;
 
-      VLOG(3) << "Have timeout(s) at " << timeout;
+      foreachkey (const Time& timeout, timers) {
+        if (timeout > now) {
+          break;
+        }
 
-      // Need to toggle 'settling' so that we don't prematurely say
-      // we're settled until after the timers are executed below,
-      // outside of the critical section.
-      if (clock::paused) {
-        clock::settling = true;
-      }
+        VLOG(3) << "Have timeout(s) at " << timeout;
+
+        // Need to toggle 'settling' so that we don't prematurely say
+        // we're settled until after the timers are executed below,
+        // outside of the critical section. Note that we must do this
+        // while still holding the shard mutex, _before_ erasing the
+        // expired timers, so that Clock::settled() either still sees
+        // the timers in the shard or sees 'settling' set.
+        if (clock::paused) {
+          synchronized (timers_mutex) {
+            clock::settling = true;
+          }
+        }
 
-      foreach (const Timer& timer, (*timers)[timeout]) {
-        timedout.push_back(timer);
+        foreach (const Timer& timer, timers[timeout]) {
+          timedout.push_back(timer);
+        }
       }
-    }
 
-    // Now erase the range of timers that timed out.
-    timers->erase(timers->begin(), timers->upper_bound(now));
+      // Now erase the range of timers that timed out.
+      timers.erase(timers.begin(), timers.upper_bound(now));
+
+      // Okay, so the timeout for the next timer should not have fired.
+      CHECK(timers.empty() || (timers.begin()->first > now));
+    }
+  }
 
-    // Okay, so the timeout for the next timer should not have fired.
-    CHECK(timers->empty() || (timers->begin()->first > now));
+  // Determine the next pending timer _before_ acquiring
+  // 'timers_mutex' (see the lock ordering comment above).
+  Option<Time> next = clock::earliest();
 
+  synchronized (timers_mutex) {
     // Remove this tick from the scheduled 'ticks', it may have
     // been removed already if the clock was paused / manipulated
     // in the interim.
     ticks->erase(time);
 
     // Schedule another "tick" if necessary.
-    scheduleTick(*timers, ticks);
+    if (next.isSome()) {
+      scheduleTick(next.get(), ticks);
+    }
   }
 
   (*clock::callback)(timedout);
@@ -190,10 +223,11 @@ void tick(const Time& time)
   // Mark 'settling' as false since there are not any more timers
   // that will expire before the paused time and we've finished
   // executing expired timers.
+  next = clock::earliest();
+
   synchronized (timers_mutex) {
     if (clock::paused &&
-        (timers->size() == 0 ||
-         timers->begin()->first > *clock::current)) {
+        (next.isNone() || next.get() > *clock::current)) {
       VLOG(3) << "Clock has settled";
       clock::settling = false;
     }
@@ -215,14 +249,16 @@ void Clock::finalize()
   // Finalization only handles cleanup of a running clock.
   CHECK(!clock::paused) << "Clock must not be paused when finalizing";
 
-  synchronized (timers_mutex) {
-    // NOTE: `currents` is only non-empty when the clock is paused.
+  // NOTE: `currents` is only non-empty when the clock is paused.
 
-    // This, along with the `timers_mutex`, is all that is required to clean
-    // up any pending timers.  Timers are triggered via "ticks".  However,
-    // we do not need to clear `ticks` because a "tick" with an empty `timers`
-    // map will effectively be a no-op.
-    timers->clear();
+  // This is all that is required to clean up any pending timers.
+  // Timers are triggered via "ticks". However, we do not need to
+  // clear `ticks` because a "tick" with empty timer shards will
+  // effectively be a no-op.
+  for (size_t i = 0; i < TIMER_SHARDS; i++) {
+    synchronized (timer_shards[i].mutex) {
+      timer_shards[i].timers.clear();
+    }
   }
 }
 
@@ -279,20 +315,18 @@ Timer Clock::timer(
   VLOG(3) << "Created a timer for " << pid << " in " << stringify(duration)
           << " in the future (" << timeout.time() << ")";
 
-  // Add the timer.
+  // Add the timer to its shard. Note that timers on different shards
+  // are armed without any shared lock.
+  TimerShard* shard = &timer_shards[timer.id % TIMER_SHARDS];
+
+  synchronized (shard->mutex) {
+    shard->timers[timer.timeout().time()].push_back(timer);
+  }
+
+  // Schedule another "tick" if this timer fires earlier than the
+  // currently scheduled ticks ('scheduleTick' is a no-op otherwise).
   synchronized (timers_mutex) {
-    if (timers->size() == 0 ||
-        timer.timeout().time() < timers->begin()->first) {
-      // Need to interrupt the loop to update/set timer repeat.
-      (*timers)[timer.timeout().time()].push_back(timer);
-
-      // Schedule another "tick" if necessary.
-      clock::scheduleTick(*timers, clock::ticks);
-    } else {
-      // Timer repeat is adequate, just add the timeout.
-      CHECK(timers->size() >= 1);
-      (*timers)[timer.timeout().time()].push_back(timer);
-    }
+    clock::scheduleTick(timer.timeout().time(), clock::ticks);
   }
 
   return timer;
@@ -302,16 +336,19 @@ Timer Clock::timer(
 bool Clock::cancel(const Timer& timer)
 {
   bool canceled = false;
-  synchronized (timers_mutex) {
+
+  TimerShard* shard = &timer_shards[timer.id % TIMER_SHARDS];
+
+  synchronized (shard->mutex) {
     // Check if the timeout is still pending, and if so, erase it. In
     // addition, erase an empty list if we just removed the last
     // timeout.
     Time time = timer.timeout().time();
-    if (timers->count(time) > 0) {
+    if (shard->timers.count(time) > 0) {
       canceled = true;
-      (*timers)[time].remove(timer);
-      if ((*timers)[time].empty()) {
-        timers->erase(time);
+      shard->timers[time].remove(timer);
+      if (shard->timers[time].empty()) {
+        shard->timers.erase(time);
       }
     }
   }
@@ -363,9 +400,18 @@ void Clock::resume()
       clock::paused = false;
       clock::settling = false;
       clock::currents->clear();
+    }
+  }
+
+  // Schedule another "tick" if necessary. Note that we determine the
+  // next pending timer outside of 'timers_mutex' since that requires
+  // acquiring the shard mutexes. A timer that gets armed in between
+  // schedules its own "tick" after seeing the resumed clock.
+  Option<Time> next = clock::earliest();
 
-      // Schedule another "tick" if necessary.
-      clock::scheduleTick(*timers, clock::ticks);
+  synchronized (timers_mutex) {
+    if (!clock::paused && next.isSome()) {
+      clock::scheduleTick(next.get(), clock::ticks);
     }
   }
 }
@@ -374,16 +420,27 @@ void Clock::resume()
 void Clock::advance(const Duration& duration)
 {
   synchronized (timers_mutex) {
-    if (clock::paused) {
-      *clock::advanced += duration;
-      *clock::current += duration;
+    if (!clock::paused) {
+      return;
+    }
 
-      VLOG(2) << "Clock advanced ("  << duration << ") to " << clock::current;
+    *clock::advanced += duration;
+    *clock::current += duration;
 
-      // Schedule another "tick" if necessary. Only "ticks" that
-      // fire immediately will be scheduled here, since the clock
-      // is paused.
-      clock::scheduleTick(*timers, clock::ticks);
+    VLOG(2) << "Clock advanced ("  << duration << ") to " << clock::current;
+  }
+
+  // Schedule another "tick" if necessary. Only "ticks" that fire
+  // immediately will be scheduled here, since the clock is paused.
+  // Note that we determine the next pending timer _after_ updating
+  // 'current' and outside of 'timers_mutex' since that requires
+  // acquiring the shard mutexes. A timer that gets armed in between
+  // schedules its own "tick" against the advanced time.
+  Option<Time> next = clock::earliest();
+
+  synchronized (timers_mutex) {
+    if (clock::paused && next.isSome()) {
+      clock::scheduleTick(next.get(), clock::ticks);
     }
   }
 }
@@ -411,17 +468,24 @@ void Clock::advance(ProcessBase* process, const Duration& duration)
 void Clock::update(const Time& time)
 {
   synchronized (timers_mutex) {
-    if (clock::paused) {
-      if (*clock::current < time) {
-        *clock::advanced += (time - *clock::current);
-        *clock::current = Time(time);
-        VLOG(2) << "Clock updated to " << clock::current;
-
-        // Schedule another "tick" if necessary. Only "ticks" that
-        // fire immediately will be scheduled here, since the clock
-        // is paused.
-        clock::scheduleTick(*timers, clock::ticks);
-      }
+    if (!clock::paused || *clock::current >= time) {
+      return;
+    }
+
+    *clock::advanced += (time - *clock::current);
+    *clock::current = Time(time);
+    VLOG(2) << "Clock updated to " << clock::current;
+  }
+
+  // Schedule another "tick" if necessary. Only "ticks" that fire
+  // immediately will be scheduled here, since the clock is paused.
+  // See the comment in the global advance() above for why this is
+  // done outside of 'timers_mutex'.
+  Option<Time> next = clock::earliest();
+
+  synchronized (timers_mutex) {
+    if (clock::paused && next.isSome()) {
+      clock::scheduleTick(next.get(), clock::ticks);
     }
   }
 }
@@ -454,14 +518,20 @@ void Clock::order(ProcessBase* from, ProcessBase* to)
 
 bool Clock::settled()
 {
+  // Note that we determine the next pending timer _before_ checking
+  // 'settling': 'tick' sets 'settling' before it erases expired
+  // timers from a shard, so if we observe an already erased shard
+  // here we are guaranteed to subsequently observe 'settling' (until
+  // the expired timers have actually been executed).
+  Option<Time> next = clock::earliest();
+
   synchronized (timers_mutex) {
     CHECK(clock::paused);
 
     if (clock::settling) {
       VLOG(3) << "Clock still not settled";
       return false;
-    } else if (timers->size() == 0 ||
-               timers->begin()->first > *clock::current) {
+    } else if (next.isNone() || next.get() > *clock::current) {
       VLOG(3) << "Clock is settled";
       return true;
     }
@@ -17,8 +17,11 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <climits>
 #include <deque>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/http.hpp>
@@ -35,6 +38,13 @@
 
 namespace process {
 
+// Maximum number of bytes reserved for a message body up front based
+// on the 'Content-Length' header. The announced length is not trusted
+// beyond this since it is attacker controlled; larger bodies simply
+// grow the buffer as the data actually arrives.
+const size_t MAX_BODY_RESERVATION = 10 * 1024 * 1024;
+
+
 // TODO(benh): Make DataDecoder abstract and make RequestDecoder a
 // concrete subclass.
 class DataDecoder
@@ -73,8 +83,8 @@ public:
     }
 
     if (!requests.empty()) {
-      std::deque<http::Request*> result = requests;
-      requests.clear();
+      std::deque<http::Request*> result;
+      result.swap(requests);
       return result;
     }
 
@@ -182,7 +192,7 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->request->headers[decoder->field] = decoder->value;
+      decoder->request->headers[decoder->field] = std::move(decoder->value);
       decoder->field.clear();
       decoder->value.clear();
     }
@@ -209,7 +219,7 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     // Add final header.
-    decoder->request->headers[decoder->field] = decoder->value;
+    decoder->request->headers[decoder->field] = std::move(decoder->value);
     decoder->field.clear();
     decoder->value.clear();
 
@@ -218,6 +228,18 @@ private:
 
     decoder->request->keepAlive = http_should_keep_alive(&decoder->parser);
 
+    // Reserve the body buffer up front when the length is known, so
+    // that large message bodies are not repeatedly reallocated as
+    // chunks arrive.
+#if (HTTP_PARSER_VERSION_MAJOR >= 2)
+    if (decoder->parser.content_length != ULLONG_MAX) {
+#else
+    if (decoder->parser.content_length > 0) {
+#endif
+      decoder->request->body.reserve(std::min<uint64_t>(
+          decoder->parser.content_length, MAX_BODY_RESERVATION));
+    }
+
     return 0;
   }
 
@@ -322,8 +344,8 @@ public:
     }
 
     if (!responses.empty()) {
-      std::deque<http::Response*> result = responses;
-      responses.clear();
+      std::deque<http::Response*> result;
+      result.swap(responses);
       return result;
     }
 
@@ -386,7 +408,7 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->response->headers[decoder->field] = decoder->value;
+      decoder->response->headers[decoder->field] = std::move(decoder->value);
       decoder->field.clear();
       decoder->value.clear();
     }
@@ -413,10 +435,22 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     // Add final header.
-    decoder->response->headers[decoder->field] = decoder->value;
+    decoder->response->headers[decoder->field] = std::move(decoder->value);
     decoder->field.clear();
     decoder->value.clear();
 
+    // Reserve the body buffer up front when the length is known, so
+    // that large response bodies are not repeatedly reallocated as
+    // chunks arrive.
+#if (HTTP_PARSER_VERSION_MAJOR >= 2)
+    if (decoder->parser.content_length != ULLONG_MAX) {
+#else
+    if (decoder->parser.content_length > 0) {
+#endif
+      decoder->response->body.reserve(std::min<uint64_t>(
+          decoder->parser.content_length, MAX_BODY_RESERVATION));
+    }
+
     return 0;
   }
 
@@ -544,8 +578,8 @@ public:
     }
 
     if (!responses.empty()) {
-      std::deque<http::Response*> result = responses;
-      responses.clear();
+      std::deque<http::Response*> result;
+      result.swap(responses);
       return result;
     }
 
@@ -614,7 +648,7 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->response->headers[decoder->field] = decoder->value;
+      decoder->response->headers[decoder->field] = std::move(decoder->value);
       decoder->field.clear();
       decoder->value.clear();
     }
@@ -643,7 +677,7 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     // Add final header.
-    decoder->response->headers[decoder->field] = decoder->value;
+    decoder->response->headers[decoder->field] = std::move(decoder->value);
     decoder->field.clear();
     decoder->value.clear();
 
@@ -13,13 +13,22 @@
 #ifndef __ENCODER_HPP__
 #define __ENCODER_HPP__
 
+#include <limits.h>
 #include <stdint.h>
 #include <time.h>
 
+#include <sys/uio.h>
+
+#include <glog/logging.h>
+
 #include <map>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <process/http.hpp>
+#include <process/message_accounting.hpp>
 #include <process/process.hpp>
 
 #include <stout/foreach.hpp>
@@ -65,11 +74,19 @@ private:
 };
 
 
+// Encodes one or more data buffers. The buffers are kept separate so
+// that they can be written to a socket with a single gather write
+// (writev) rather than getting copied into one contiguous buffer
+// (e.g., an encoded message keeps the serialized body it was
+// constructed with, see MessageEncoder below).
 class DataEncoder : public Encoder
 {
 public:
-  DataEncoder(const network::Socket& s, const std::string& _data)
-    : Encoder(s), data(_data), index(0) {}
+  DataEncoder(const network::Socket& s, const std::string& data)
+    : Encoder(s), buffers(1, data), index(0) {}
+
+  DataEncoder(const network::Socket& s, std::vector<std::string>&& _buffers)
+    : Encoder(s), buffers(std::move(_buffers)), index(0) {}
 
   virtual ~DataEncoder() {}
 
@@ -78,12 +95,43 @@ public:
     return Encoder::DATA;
   }
 
-  virtual const char* next(size_t* length)
+  // Fills an array of iovecs with the remaining data and advances
+  // past it (like 'next' of a single buffer, a caller is expected to
+  // 'backup' by however much did not actually get sent). The array
+  // is owned by the encoder and remains valid until the next call to
+  // 'next' or until the encoder is destructed; 'length' gets the
+  // total number of bytes referenced by the returned iovecs.
+  virtual const iovec* next(int* iovcnt, size_t* length)
   {
-    size_t temp = index;
-    index = data.size();
-    *length = data.size() - temp;
-    return data.data() + temp;
+    iov.clear();
+    *length = 0;
+
+    size_t skip = index;
+
+    foreach (const std::string& buffer, buffers) {
+      if (skip >= buffer.size()) {
+        skip -= buffer.size();
+        continue;
+      }
+
+      // Bound the scatter/gather array by what a single writev can
+      // take; anything past this is handed out by a later call.
+      if (iov.size() == IOV_MAX) {
+        break;
+      }
+
+      iovec entry;
+      entry.iov_base = const_cast<char*>(buffer.data()) + skip;
+      entry.iov_len = buffer.size() - skip;
+      iov.push_back(entry);
+
+      *length += entry.iov_len;
+      skip = 0;
+    }
+
+    index += *length;
+    *iovcnt = static_cast<int>(iov.size());
+    return iov.data();
   }
 
   virtual void backup(size_t length)
@@ -95,12 +143,40 @@ public:
 
   virtual size_t remaining() const
   {
-    return data.size() - index;
+    size_t size = 0;
+
+    foreach (const std::string& buffer, buffers) {
+      size += buffer.size();
+    }
+
+    return size - index;
+  }
+
+  // Takes over the buffers of 'that' encoder, to be written after
+  // this encoder's remaining data. This lets a queue of encoders
+  // destined for the same socket be flushed with a single gather
+  // write instead of a syscall per encoder. Note that 'that' must
+  // not have handed out any of its data yet.
+  void append(DataEncoder* that)
+  {
+    CHECK_EQ(0u, that->index);
+
+    foreach (std::string& buffer, that->buffers) {
+      buffers.push_back(std::move(buffer));
+    }
+
+    that->buffers.clear();
   }
 
 private:
-  const std::string data;
+  std::vector<std::string> buffers;
+
+  // Number of bytes (across all buffers) that have been handed to
+  // the caller via 'next'.
   size_t index;
+
+  // Scatter/gather array handed out by 'next'.
+  std::vector<iovec> iov;
 };
 
 
@@ -117,8 +193,10 @@ public:
     }
   }
 
-  static std::string encode(Message* message)
+  static std::vector<std::string> encode(Message* message)
   {
+    std::vector<std::string> buffers;
+
     std::ostringstream out;
 
     if (message != NULL) {
@@ -138,19 +216,30 @@ public:
           << "Connection: Keep-Alive\r\n"
           << "Host: \r\n";
 
+      // Account the message here rather than at the send call sites
+      // so that relayed messages are counted as well.
+      messages::sent(message->name, message->body.size());
+
       if (message->body.size() > 0) {
         out << "Transfer-Encoding: chunked\r\n\r\n"
             << std::hex << message->body.size() << "\r\n";
-        out.write(message->body.data(), message->body.size());
-        out << "\r\n"
-            << "0\r\n"
-            << "\r\n";
+
+        buffers.push_back(out.str());
+
+        // Keep the body as its own buffer so that it gets gather
+        // written to the socket rather than copied (the encoder owns
+        // the message so we can simply steal the body).
+        buffers.push_back(std::move(message->body));
+
+        buffers.push_back("\r\n0\r\n\r\n");
       } else {
         out << "\r\n";
+
+        buffers.push_back(out.str());
       }
     }
 
-    return out.str();
+    return buffers;
   }
 
 private:
@@ -167,10 +256,12 @@ public:
       const http::Request& request)
     : DataEncoder(s, encode(response, request)) {}
 
-  static std::string encode(
+  static std::vector<std::string> encode(
       const http::Response& response,
       const http::Request& request)
   {
+    std::vector<std::string> buffers;
+
     std::ostringstream out;
 
     // TODO(benh): Check version?
@@ -230,19 +321,23 @@ public:
     // Use a CRLF to mark end of headers.
     out << "\r\n";
 
-    // Add the body if necessary.
+    buffers.push_back(out.str());
+
+    // Add the body (as its own buffer so that it gets gather written
+    // to the socket rather than copied after the headers) if
+    // necessary.
     if (response.type == http::Response::BODY) {
       // If the Content-Length header was supplied, only write as much data
       // as the length specifies.
       Result<uint32_t> length = numify<uint32_t>(headers.get("Content-Length"));
       if (length.isSome() && length.get() <= body.length()) {
-        out.write(body.data(), length.get());
-      } else {
-        out.write(body.data(), body.size());
+        body.resize(length.get());
       }
+
+      buffers.push_back(std::move(body));
     }
 
-    return out.str();
+    return buffers;
   }
 };
 
@@ -20,6 +20,7 @@
 #include <cstring>
 #include <deque>
 #include <iomanip>
+#include <list>
 #include <ostream>
 #include <map>
 #include <memory>
@@ -35,11 +36,13 @@
 #include <process/future.hpp>
 #include <process/http.hpp>
 #include <process/id.hpp>
+#include <process/once.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/socket.hpp>
 
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/ip.hpp>
 #include <stout/lambda.hpp>
 #include <stout/net.hpp>
@@ -51,6 +54,7 @@
 #include <stout/try.hpp>
 
 #include "decoder.hpp"
+#include "resolver.hpp"
 
 using std::deque;
 using std::istringstream;
@@ -395,6 +399,7 @@ Future<string> Pipe::Reader::read()
       future = Failure("closed");
     } else if (!data->writes.empty()) {
       future = data->writes.front();
+      data->writesSize -= data->writes.front().size();
       data->writes.pop();
     } else if (data->writeEnd == Writer::CLOSED) {
       future = ""; // End-of-file.
@@ -423,6 +428,7 @@ bool Pipe::Reader::close()
       while (!data->writes.empty()) {
         data->writes.pop();
       }
+      data->writesSize = 0;
 
       // Extract the pending reads so we can fail them.
       std::swap(data->reads, reads);
@@ -452,7 +458,7 @@ bool Pipe::Reader::close()
 }
 
 
-bool Pipe::Writer::write(const string& s)
+bool Pipe::Writer::write(string s)
 {
   bool written = false;
   Owned<Promise<string>> read;
@@ -463,7 +469,8 @@ bool Pipe::Writer::write(const string& s)
       // Don't bother surfacing empty writes to the readers.
       if (!s.empty()) {
         if (data->reads.empty()) {
-          data->writes.push(s);
+          data->writesSize += s.size();
+          data->writes.push(std::move(s));
         } else {
           read = data->reads.front();
           data->reads.pop();
@@ -476,7 +483,7 @@ bool Pipe::Writer::write(const string& s)
   // NOTE: We set the promise outside the critical section to avoid
   // triggering callbacks that try to reacquire the lock.
   if (read.get() != NULL) {
-    read->set(s);
+    read->set(std::move(s));
   }
 
   return written;
@@ -542,6 +549,18 @@ Future<Nothing> Pipe::Writer::readerClosed() const
 }
 
 
+size_t Pipe::Writer::outstanding() const
+{
+  size_t size;
+
+  synchronized (data->lock) {
+    size = data->writesSize;
+  }
+
+  return size;
+}
+
+
 OK::OK(const JSON::Value& value, const Option<string>& jsonp)
   : Response(Status::OK)
 {
@@ -1210,28 +1229,8 @@ Future<Nothing> Connection::disconnected()
 }
 
 
-Future<Connection> connect(const URL& url)
+static Future<Connection> _connect(const URL& url, Address address)
 {
-  // TODO(bmahler): Move address resolution into the URL class?
-  Address address;
-
-  if (url.ip.isNone() && url.domain.isNone()) {
-    return Failure("Expected URL.ip or URL.domain to be set");
-  }
-
-  if (url.ip.isSome()) {
-    address.ip = url.ip.get();
-  } else {
-    Try<net::IP> ip = net::getIP(url.domain.get(), AF_INET);
-
-    if (ip.isError()) {
-      return Failure("Failed to determine IP of domain '" +
-                     url.domain.get() + "': " + ip.error());
-    }
-
-    address.ip = ip.get();
-  }
-
   if (url.port.isNone()) {
     return Failure("Expecting url.port to be set");
   }
@@ -1266,29 +1265,250 @@ Future<Connection> connect(const URL& url)
 }
 
 
+Future<Connection> connect(const URL& url)
+{
+  // TODO(bmahler): Move address resolution into the URL class?
+  Address address;
+
+  if (url.ip.isNone() && url.domain.isNone()) {
+    return Failure("Expected URL.ip or URL.domain to be set");
+  }
+
+  if (url.ip.isSome()) {
+    address.ip = url.ip.get();
+    return _connect(url, address);
+  }
+
+  // Resolve the domain on a resolver thread so that a slow DNS
+  // server never blocks the caller.
+  const std::string domain = url.domain.get();
+
+  return process::internal::Resolver::instance()
+    ->resolve(domain, AF_INET)
+    .repair([domain](const Future<net::IP>& future) -> Future<net::IP> {
+      return Failure("Failed to determine IP of domain '" +
+                     domain + "': " + future.failure());
+    })
+    .then([url, address](const net::IP& ip) {
+      Address resolved = address;
+      resolved.ip = ip;
+      return _connect(url, resolved);
+    });
+}
+
+
 namespace internal {
 
-Future<Response> request(const Request& request, bool streamedResponse)
+// Maximum number of idle keep-alive connections retained per
+// endpoint.
+static const size_t MAX_IDLE_CONNECTIONS_PER_ENDPOINT = 5;
+
+
+// Returns the pool key of the endpoint a URL refers to, i.e., the
+// URL stripped of everything but its scheme, host and port.
+static string endpoint(const URL& url)
+{
+  std::ostringstream out;
+
+  out << url.scheme.getOrElse("http") << "://";
+
+  if (url.domain.isSome()) {
+    out << url.domain.get();
+  } else if (url.ip.isSome()) {
+    out << url.ip.get();
+  }
+
+  out << ":" << stringify(url.port.getOrElse(80));
+
+  return out.str();
+}
+
+
+// Caches idle keep-alive connections per endpoint so that repeated
+// requests to the same server (e.g., fetching layers from a docker
+// registry, health checking a task) skip the TCP (and SSL) handshake
+// of a fresh connection. The pool is purely an optimization: a
+// cached connection gets pruned when the server closes it while it
+// is idle, and a request that races with such a close gets retried
+// on a fresh connection (see 'request' below).
+class ConnectionPoolProcess : public Process<ConnectionPoolProcess>
 {
-  // We rely on the connection closing after the response.
-  CHECK(!request.keepAlive);
+public:
+  ConnectionPoolProcess()
+    : ProcessBase(ID::generate("__http_connection_pool__")) {}
+
+  static ConnectionPoolProcess* instance()
+  {
+    static ConnectionPoolProcess* singleton = NULL;
+    static Once* initialized = new Once();
+
+    if (!initialized->once()) {
+      singleton = new ConnectionPoolProcess();
+      spawn(singleton);
+      initialized->done();
+    }
+
+    return singleton;
+  }
+
+  // Returns a cached idle connection for the endpoint, if any.
+  Option<Connection> acquire(const string& endpoint)
+  {
+    if (!connections.contains(endpoint)) {
+      return None();
+    }
+
+    Connection connection = connections[endpoint].front();
+    connections[endpoint].pop_front();
+
+    if (connections[endpoint].empty()) {
+      connections.erase(endpoint);
+    }
+
+    return connection;
+  }
+
+  void release(const string& endpoint, const Connection& connection)
+  {
+    // NOTE: 'Connection::disconnect' and 'Connection::disconnected'
+    // are not const, so we operate on a copy (which shares the
+    // underlying connection).
+    Connection copy = connection;
 
-  // This is a one time request which will close the connection when
-  // the response is received. Since 'Connection' is reference-counted,
-  // we must keep a copy around until the disconnection occurs. Note
-  // that in order to avoid a deadlock (Connection destruction occurring
-  // from the ConnectionProcess execution context), we use 'async'.
-  return http::connect(request.url)
-    .then([=](Connection connection) {
-      Future<Response> response = connection.send(request, streamedResponse);
+    if (connections[endpoint].size() >= MAX_IDLE_CONNECTIONS_PER_ENDPOINT) {
+      copy.disconnect();
+      return;
+    }
 
-      Connection* copy = new Connection(std::move(connection));
-      auto deleter = [copy](){ delete copy; };
+    connections[endpoint].push_back(connection);
 
-      copy->disconnected()
-        .onAny([=]() { async(deleter); });
+    // Prune the connection when (if) the server closes it while it
+    // sits idle in the pool. Note that a connection that gets
+    // released, acquired and released again simply registers
+    // multiple prunes; pruning is idempotent.
+    copy.disconnected()
+      .onAny(defer(self(), &Self::prune, endpoint, connection));
+  }
+
+private:
+  void prune(const string& endpoint, const Connection& connection)
+  {
+    if (connections.contains(endpoint)) {
+      connections[endpoint].remove(connection);
+
+      if (connections[endpoint].empty()) {
+        connections.erase(endpoint);
+      }
+    }
+  }
+
+  hashmap<string, std::list<Connection>> connections;
+};
+
+
+// Issues the request on the specified connection, returning the
+// connection to the pool once the response completes (a failed
+// response means the connection is broken, so it simply gets
+// dropped). Since 'Connection' is reference-counted, we must keep a
+// copy around until then. Note that in order to avoid a deadlock
+// (Connection destruction occurring from the ConnectionProcess
+// execution context), we use 'async'.
+static Future<Response> _request(
+    const Connection& connection,
+    const Request& request,
+    bool streamedResponse,
+    const string& endpoint)
+{
+  Connection* copy = new Connection(connection);
+
+  Future<Response> response = copy->send(request, streamedResponse);
+
+  response
+    .onAny([copy, endpoint](const Future<Response>& response) {
+      bool succeeded = response.isReady();
+      async([copy, endpoint, succeeded]() {
+        if (succeeded) {
+          dispatch(
+              ConnectionPoolProcess::instance()->self(),
+              &ConnectionPoolProcess::release,
+              endpoint,
+              *copy);
+        }
+        delete copy;
+      });
+    });
+
+  return response;
+}
+
+
+Future<Response> request(const Request& request, bool streamedResponse)
+{
+  if (!request.keepAlive) {
+    // This is a one time request which will close the connection when
+    // the response is received. Since 'Connection' is reference-counted,
+    // we must keep a copy around until the disconnection occurs. Note
+    // that in order to avoid a deadlock (Connection destruction occurring
+    // from the ConnectionProcess execution context), we use 'async'.
+    return http::connect(request.url)
+      .then([=](Connection connection) {
+        Future<Response> response = connection.send(request, streamedResponse);
+
+        Connection* copy = new Connection(std::move(connection));
+        auto deleter = [copy](){ delete copy; };
+
+        copy->disconnected()
+          .onAny([=]() { async(deleter); });
+
+        return response;
+      });
+  }
+
+  // Reuse a pooled keep-alive connection for the endpoint if one is
+  // available, otherwise open a new connection (which gets pooled
+  // once the response completes).
+  const string endpoint = internal::endpoint(request.url);
+
+  // Only idempotent requests may reuse a pooled connection: a reused
+  // connection may die after the request was fully delivered and the
+  // server committed its side effect, and the retry below would then
+  // silently execute a non-idempotent request (e.g., POST) twice.
+  // Non-idempotent requests are sent one-shot on a fresh connection
+  // (which still gets pooled once the response completes).
+  const bool idempotent =
+    request.method == "GET" ||
+    request.method == "HEAD" ||
+    request.method == "DELETE";
+
+  if (!idempotent) {
+    return http::connect(request.url)
+      .then([=](const Connection& connection) {
+        return _request(connection, request, streamedResponse, endpoint);
+      });
+  }
+
+  return dispatch(
+      ConnectionPoolProcess::instance()->self(),
+      &ConnectionPoolProcess::acquire,
+      endpoint)
+    .then([=](const Option<Connection>& connection) -> Future<Response> {
+      if (connection.isNone()) {
+        return http::connect(request.url)
+          .then([=](const Connection& connection) {
+            return _request(connection, request, streamedResponse, endpoint);
+          });
+      }
 
-      return response;
+      // The server may have closed the connection while it sat idle
+      // in the pool (racing with our acquisition), so we retry on a
+      // fresh connection if the reused one fails.
+      return _request(connection.get(), request, streamedResponse, endpoint)
+        .repair([=](const Future<Response>&) {
+          return http::connect(request.url)
+            .then([=](const Connection& connection) {
+              return _request(connection, request, streamedResponse, endpoint);
+            });
+        });
     });
 }
 
@@ -1302,7 +1522,7 @@ Future<Response> get(
   Request request;
   request.method = "GET";
   request.url = url;
-  request.keepAlive = false;
+  request.keepAlive = true;
 
   if (headers.isSome()) {
     request.headers = headers.get();
@@ -1353,7 +1573,7 @@ Future<Response> post(
   Request request;
   request.method = "POST";
   request.url = url;
-  request.keepAlive = false;
+  request.keepAlive = true;
 
   if (headers.isSome()) {
     request.headers = headers.get();
@@ -1396,7 +1616,7 @@ Future<Response> requestDelete(
   Request request;
   request.method = "DELETE";
   request.url = url;
-  request.keepAlive = false;
+  request.keepAlive = true;
 
   if (headers.isSome()) {
     request.headers = headers.get();
@@ -1433,7 +1653,7 @@ Future<Response> get(
   Request request;
   request.method = "GET";
   request.url = url;
-  request.keepAlive = false;
+  request.keepAlive = true;
 
   if (headers.isSome()) {
     request.headers = headers.get();
@@ -1484,7 +1704,7 @@ Future<Response> post(
   Request request;
   request.method = "POST";
   request.url = url;
-  request.keepAlive = false;
+  request.keepAlive = true;
 
   if (body.isSome()) {
     request.body = body.get();
@@ -14,10 +14,17 @@
 
 #include <mutex>
 #include <queue>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <stout/duration.hpp>
+#include <stout/exit.hpp>
 #include <stout/lambda.hpp>
 #include <stout/nothing.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
 #include <stout/thread_local.hpp>
 
 #include "event_loop.hpp"
@@ -25,38 +32,46 @@
 
 namespace process {
 
-ev_async async_watcher;
-// We need an asynchronous watcher to receive the request to shutdown.
-ev_async shutdown_watcher;
+// We need asynchronous watchers for each loop to receive the request
+// to shutdown.
+static ev_async* shutdown_watchers = NULL;
 
 // Define the initial values for all of the declarations made in
 // libev.hpp (since these need to live in the static data space).
-struct ev_loop* loop = NULL;
+size_t num_event_loops = 1;
 
-std::queue<ev_io*>* watchers = new std::queue<ev_io*>();
+struct ev_loop** loops = NULL;
 
-std::mutex* watchers_mutex = new std::mutex();
+ev_async* async_watchers = NULL;
 
-std::queue<lambda::function<void()>>* functions =
-  new std::queue<lambda::function<void()>>();
+std::queue<ev_io*>* watchers = NULL;
+
+std::mutex* watchers_mutexes = NULL;
+
+std::queue<lambda::function<void()>>* functions = NULL;
 
 THREAD_LOCAL bool* _in_event_loop_ = NULL;
 
+THREAD_LOCAL size_t* _event_loop_index_ = NULL;
 
-void handle_async(struct ev_loop* loop, ev_async* _, int revents)
+
+void handle_async(struct ev_loop* loop, ev_async* watcher, int revents)
 {
+  // The index of this loop is stashed in the watcher's data.
+  size_t index = reinterpret_cast<size_t>(watcher->data);
+
   std::queue<lambda::function<void()>> run_functions;
-  synchronized (watchers_mutex) {
+  synchronized (&watchers_mutexes[index]) {
     // Start all the new I/O watchers.
-    while (!watchers->empty()) {
-      ev_io* watcher = watchers->front();
-      watchers->pop();
+    while (!watchers[index].empty()) {
+      ev_io* watcher = watchers[index].front();
+      watchers[index].pop();
       ev_io_start(loop, watcher);
     }
 
     // Swap the functions into a temporary queue so that we can invoke
     // them outside of the mutex.
-    std::swap(run_functions, *functions);
+    std::swap(run_functions, functions[index]);
   }
 
   // Running the functions outside of the mutex reduces locking
@@ -82,13 +97,46 @@ void handle_shutdown(struct ev_loop* loop, ev_async* _, int revents)
 
 void EventLoop::initialize()
 {
-  loop = ev_default_loop(EVFLAG_AUTO);
+  // Allow the number of event loops to be configured so that I/O
+  // heavy applications (e.g., a master with tens of thousands of
+  // connected sockets) can shard socket polling across cores.
+  Option<std::string> value = os::getenv("LIBPROCESS_EVENT_LOOPS");
+
+  if (value.isSome()) {
+    Try<size_t> number = numify<size_t>(value.get());
+
+    if (number.isError() || number.get() == 0) {
+      EXIT(EXIT_FAILURE)
+        << "LIBPROCESS_EVENT_LOOPS=" << value.get()
+        << " is not a valid number of event loops";
+    }
+
+    num_event_loops = number.get();
+  }
 
-  ev_async_init(&async_watcher, handle_async);
-  ev_async_init(&shutdown_watcher, handle_shutdown);
+  loops = new struct ev_loop*[num_event_loops];
+  async_watchers = new ev_async[num_event_loops];
+  shutdown_watchers = new ev_async[num_event_loops];
+  watchers = new std::queue<ev_io*>[num_event_loops];
+  watchers_mutexes = new std::mutex[num_event_loops];
+  functions = new std::queue<lambda::function<void()>>[num_event_loops];
 
-  ev_async_start(loop, &async_watcher);
-  ev_async_start(loop, &shutdown_watcher);
+  for (size_t index = 0; index < num_event_loops; index++) {
+    // The default loop stays 'loops[0]' (e.g., timers run there).
+    loops[index] = index == 0
+      ? ev_default_loop(EVFLAG_AUTO)
+      : ev_loop_new(EVFLAG_AUTO);
+
+    ev_async_init(&async_watchers[index], handle_async);
+    ev_async_init(&shutdown_watchers[index], handle_shutdown);
+
+    // Stash the loop index so that 'handle_async' knows which queues
+    // to drain.
+    async_watchers[index].data = reinterpret_cast<void*>(index);
+
+    ev_async_start(loops[index], &async_watchers[index]);
+    ev_async_start(loops[index], &shutdown_watchers[index]);
+  }
 }
 
 
@@ -125,11 +173,22 @@ Future<Nothing> delay(
   const double repeat = 0.0;
 
   ev_timer_init(timer, handle_delay, after, repeat);
-  ev_timer_start(loop, timer);
+  ev_timer_start(loops[0], timer);
 
   return Nothing();
 }
 
+
+void run(size_t index)
+{
+  __in_event_loop__ = true;
+  __event_loop_index__ = index;
+
+  ev_loop(loops[index], 0);
+
+  __in_event_loop__ = false;
+}
+
 } // namespace internal {
 
 
@@ -151,16 +210,28 @@ double EventLoop::time()
 
 void EventLoop::run()
 {
-  __in_event_loop__ = true;
+  // Run any extra loops on their own threads; the default loop runs
+  // on this thread so that this function (as before) only returns
+  // once the event loop has been stopped.
+  std::vector<std::thread*> threads;
 
-  ev_loop(loop, 0);
+  for (size_t index = 1; index < num_event_loops; index++) {
+    threads.push_back(new std::thread(&internal::run, index));
+  }
 
-  __in_event_loop__ = false;
+  internal::run(0);
+
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i]->join();
+    delete threads[i];
+  }
 }
 
 void EventLoop::stop()
 {
-  ev_async_send(loop, &shutdown_watcher);
+  for (size_t index = 0; index < num_event_loops; index++) {
+    ev_async_send(loops[index], &shutdown_watchers[index]);
+  }
 }
 
 } // namespace process {
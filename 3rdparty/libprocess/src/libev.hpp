@@ -27,22 +27,31 @@
 
 namespace process {
 
-// Event loop.
-extern struct ev_loop* loop;
-
-// Asynchronous watcher for interrupting loop to specifically deal
-// with IO watchers and functions (via run_in_event_loop).
-extern ev_async async_watcher;
-
-// Queue of I/O watchers to be asynchronously added to the event loop
-// (protected by 'watchers' below).
-// TODO(benh): Replace this queue with functions that we put in
+// The number of event loops, set once in EventLoop::initialize from
+// the LIBPROCESS_EVENT_LOOPS environment variable (defaults to 1).
+// I/O polling is sharded across the loops by file descriptor so that
+// socket readiness handling can utilize multiple cores, while timers
+// always run on the default loop ('loops[0]').
+extern size_t num_event_loops;
+
+// Event loops. 'loops[0]' is the default loop.
+extern struct ev_loop** loops;
+
+// Asynchronous watchers for interrupting each loop to specifically
+// deal with IO watchers and functions (via run_in_event_loop).
+extern ev_async* async_watchers;
+
+// Per loop queues of I/O watchers to be asynchronously added to the
+// event loop (each protected by the corresponding mutex in
+// 'watchers_mutexes' below).
+// TODO(benh): Replace these queues with functions that we put in
 // 'functions' below that perform the ev_io_start themselves.
 extern std::queue<ev_io*>* watchers;
-extern std::mutex* watchers_mutex;
+extern std::mutex* watchers_mutexes;
 
-// Queue of functions to be invoked asynchronously within the vent
-// loop (protected by 'watchers' above).
+// Per loop queues of functions to be invoked asynchronously within
+// the event loop (each protected by the corresponding mutex in
+// 'watchers_mutexes' above).
 extern std::queue<lambda::function<void()>>* functions;
 
 // Per thread bool pointer. We use a pointer to lazily construct the
@@ -52,6 +61,13 @@ extern THREAD_LOCAL bool* _in_event_loop_;
 #define __in_event_loop__ *(_in_event_loop_ == NULL ?                \
   _in_event_loop_ = new bool(false) : _in_event_loop_)
 
+// Per thread event loop index pointer (i.e., which of 'loops' this
+// thread is running, only meaningful if '__in_event_loop__').
+extern THREAD_LOCAL size_t* _event_loop_index_;
+
+#define __event_loop_index__ *(_event_loop_index_ == NULL ?          \
+  _event_loop_index_ = new size_t(0) : _event_loop_index_)
+
 
 // Wrapper around function we want to run in the event loop.
 template <typename T>
@@ -68,12 +84,17 @@ void _run_in_event_loop(
 }
 
 
-// Helper for running a function in the event loop.
+// Helper for running a function in the event loop with the specified
+// index (the default loop unless the caller shards, e.g., by file
+// descriptor).
 template <typename T>
-Future<T> run_in_event_loop(const lambda::function<Future<T>()>& f)
+Future<T> run_in_event_loop(
+    const lambda::function<Future<T>()>& f,
+    size_t index = 0)
 {
-  // If this is already the event loop then just run the function.
-  if (__in_event_loop__) {
+  // If this is already the target event loop then just run the
+  // function.
+  if (__in_event_loop__ && __event_loop_index__ == index) {
     return f();
   }
 
@@ -81,13 +102,24 @@ Future<T> run_in_event_loop(const lambda::function<Future<T>()>& f)
 
   Future<T> future = promise->future();
 
-  // Enqueue the function.
-  synchronized (watchers_mutex) {
-    functions->push(lambda::bind(&_run_in_event_loop<T>, f, promise));
+  // Enqueue the function. Note that only the producer that finds the
+  // queue empty interrupts the loop: if the queue was non-empty then
+  // an interrupt for it is already on its way (or the loop is
+  // already draining the queue, which swaps out the whole queue
+  // under the mutex and hence will pick this function up too), so a
+  // burst of cross-thread enqueues results in a single wakeup
+  // instead of one per function.
+  bool interrupt = false;
+
+  synchronized (&watchers_mutexes[index]) {
+    interrupt = functions[index].empty();
+    functions[index].push(lambda::bind(&_run_in_event_loop<T>, f, promise));
   }
 
   // Interrupt the loop.
-  ev_async_send(loop, &async_watcher);
+  if (interrupt) {
+    ev_async_send(loops[index], &async_watchers[index]);
+  }
 
   return future;
 }
@@ -90,13 +90,13 @@ namespace io {
 namespace internal {
 
 // Helper/continuation of 'poll' on future discard.
-void _poll(const std::shared_ptr<ev_async>& async)
+void _poll(const std::shared_ptr<ev_async>& async, size_t index)
 {
-  ev_async_send(loop, async.get());
+  ev_async_send(loops[index], async.get());
 }
 
 
-Future<short> poll(int fd, short events)
+Future<short> poll(int fd, short events, size_t index)
 {
   Poll* poll = new Poll();
 
@@ -109,7 +109,7 @@ Future<short> poll(int fd, short events)
 
   // Initialize and start the async watcher.
   ev_async_init(poll->watcher.async.get(), discard_poll);
-  ev_async_start(loop, poll->watcher.async.get());
+  ev_async_start(loops[index], poll->watcher.async.get());
 
   // Make sure we stop polling if a discard occurs on our future.
   // Note that it's possible that we'll invoke '_poll' when someone
@@ -117,11 +117,11 @@ Future<short> poll(int fd, short events)
   // in this case while we will interrupt the event loop since the
   // async watcher has already been stopped we won't cause
   // 'discard_poll' to get invoked.
-  future.onDiscard(lambda::bind(&_poll, poll->watcher.async));
+  future.onDiscard(lambda::bind(&_poll, poll->watcher.async, index));
 
   // Initialize and start the I/O watcher.
   ev_io_init(poll->watcher.io.get(), polled, fd, events);
-  ev_io_start(loop, poll->watcher.io.get());
+  ev_io_start(loops[index], poll->watcher.io.get());
 
   return future;
 }
@@ -135,7 +135,14 @@ Future<short> poll(int fd, short events)
 
   // TODO(benh): Check if the file descriptor is non-blocking?
 
-  return run_in_event_loop<short>(lambda::bind(&internal::poll, fd, events));
+  // Shard polling across the event loops by file descriptor so that
+  // socket readiness handling can utilize multiple cores (note that
+  // all the watchers for a given file descriptor always end up on
+  // the same loop).
+  size_t index = fd % num_event_loops;
+
+  return run_in_event_loop<short>(
+      lambda::bind(&internal::poll, fd, events, index), index);
 }
 
 } // namespace io {
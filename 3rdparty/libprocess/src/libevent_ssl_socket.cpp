@@ -20,9 +20,12 @@
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 
+#include <mutex>
+
 #include <process/queue.hpp>
 #include <process/socket.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/net.hpp>
 #include <stout/synchronized.hpp>
 
@@ -76,6 +79,23 @@ static Synchronized<bufferevent> synchronize(bufferevent* bev)
 namespace process {
 namespace network {
 
+// A cache of established SSL sessions keyed by peer address. OpenSSL
+// only caches sessions on the server side, so in order to resume a
+// session as a client we save the session once a connection has been
+// established and offer it on subsequent connects to the same peer.
+// A resumed session uses an abbreviated handshake that skips the
+// expensive key exchange, which would otherwise be serialized on the
+// event loop thread during reconnect storms (e.g., after a master
+// failover).
+//
+// NOTE: The cache retains a reference to each session (they are
+// reference counted by OpenSSL) and releases it when the session is
+// replaced by a newer one for the same peer.
+static std::mutex* client_sessions_mutex = new std::mutex();
+static hashmap<Address, SSL_SESSION*>* client_sessions =
+  new hashmap<Address, SSL_SESSION*>();
+
+
 Try<std::shared_ptr<Socket::Impl>> LibeventSSLSocketImpl::create(int s)
 {
   openssl::initialize();
@@ -406,6 +426,24 @@ void LibeventSSLSocketImpl::event_callback(short events)
       return;
     }
 
+    // Cache the negotiated session so that subsequent connections to
+    // this peer can attempt to resume it.
+    if (peer_address.isSome()) {
+      SSL_SESSION* session = SSL_get1_session(ssl);
+      if (session != NULL) {
+        synchronized (client_sessions_mutex) {
+          Option<SSL_SESSION*> previous =
+            client_sessions->get(peer_address.get());
+
+          if (previous.isSome()) {
+            SSL_SESSION_free(previous.get());
+          }
+
+          client_sessions->put(peer_address.get(), session);
+        }
+      }
+    }
+
     current_connect_request->promise.set(Nothing());
   } else if (events & BEV_EVENT_ERROR) {
     CHECK(EVUTIL_SOCKET_ERROR() != 0);
@@ -483,6 +521,24 @@ Future<Nothing> LibeventSSLSocketImpl::connect(const Address& address)
     return Failure("Failed to connect: SSL_new");
   }
 
+  // Offer a cached session for this peer, if we have one, so that
+  // the server can resume it with an abbreviated handshake. If the
+  // server does not recognize the session (e.g., it expired or the
+  // server restarted) the handshake transparently falls back to a
+  // full one.
+  synchronized (client_sessions_mutex) {
+    Option<SSL_SESSION*> session = client_sessions->get(address);
+    if (session.isSome()) {
+      // NOTE: 'SSL_set_session' takes its own reference on the
+      // session so the cache keeps ownership of its reference.
+      SSL_set_session(ssl, session.get());
+    }
+  }
+
+  // Remember the peer address so that we can cache the negotiated
+  // session once the connection has been established.
+  peer_address = address;
+
   ssl_connect_fd = ::dup(get());
   if (ssl_connect_fd < 0) {
     return Failure("Failed to 'dup' socket for new openssl socket handle");
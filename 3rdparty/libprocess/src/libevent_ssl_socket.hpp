@@ -179,6 +179,10 @@ private:
 
   Option<std::string> peer_hostname;
 
+  // The address passed to 'connect', used to key the client-side
+  // SSL session cache. Remains none for accepted sockets.
+  Option<Address> peer_address;
+
   // Socket descriptor/handle used by libevent_ssl.
   // Ownership semantics:
   //  This class owns this handle and is responsible for creating (via dup)
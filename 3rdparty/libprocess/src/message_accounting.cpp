@@ -0,0 +1,101 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <mutex>
+#include <string>
+
+#include <process/message_accounting.hpp>
+
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+#include <stout/synchronized.hpp>
+
+namespace process {
+namespace messages {
+
+namespace {
+
+struct Accounting
+{
+  explicit Accounting(const std::string& name)
+    : received_bytes("libprocess/messages/" + name + "/received_bytes"),
+      parse_ns("libprocess/messages/" + name + "/parse_ns"),
+      sent_bytes("libprocess/messages/" + name + "/sent_bytes"),
+      serialize_ns("libprocess/messages/" + name + "/serialize_ns")
+  {
+    metrics::add(received_bytes);
+    metrics::add(parse_ns);
+    metrics::add(sent_bytes);
+    metrics::add(serialize_ns);
+  }
+
+  metrics::Counter received_bytes;
+  metrics::Counter parse_ns;
+  metrics::Counter sent_bytes;
+  metrics::Counter serialize_ns;
+};
+
+
+std::mutex mutex;
+
+// NOTE: Entries are created on the first occurrence of a message type
+// and never removed, so the lock is only contended while the registry
+// is warming up; steady state is a lookup under the lock followed by
+// atomic counter increments outside of it.
+hashmap<std::string, Accounting*> registry;
+
+
+Accounting* accounting(const std::string& name)
+{
+  Accounting* result = NULL;
+
+  synchronized (mutex) {
+    Option<Accounting*> entry = registry.get(name);
+    if (entry.isSome()) {
+      result = entry.get();
+    } else {
+      result = new Accounting(name);
+      registry[name] = result;
+    }
+  }
+
+  return result;
+}
+
+} // namespace {
+
+
+void received(const std::string& name, size_t bytes, const Duration& parse)
+{
+  Accounting* entry = accounting(name);
+  entry->received_bytes += bytes;
+  entry->parse_ns += parse.ns();
+}
+
+
+void serialized(const std::string& name, const Duration& duration)
+{
+  accounting(name)->serialize_ns += duration.ns();
+}
+
+
+void sent(const std::string& name, size_t bytes)
+{
+  accounting(name)->sent_bytes += bytes;
+}
+
+} // namespace messages {
+} // namespace process {
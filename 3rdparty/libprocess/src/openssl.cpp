@@ -339,12 +339,22 @@ void reinitialize()
   CHECK(ctx) << "Failed to create SSL context: "
              << ERR_error_string(ERR_get_error(), NULL);
 
-  // Disable SSL session caching.
-  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
-
-  // Set a session id to avoid connection termination upon
-  // re-connect. We can use something more relevant when we care
-  // about session caching.
+  // Enable server-side SSL session caching so that reconnecting
+  // peers can resume a previous session with an abbreviated
+  // handshake that skips the expensive key exchange. This matters
+  // most during reconnect storms (e.g., after a master failover)
+  // when many peers re-establish connections at once. Clients that
+  // support session tickets (RFC 5077) resume statelessly; the
+  // internal cache covers session id based resumption.
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+
+  // Bound the size of the internal session cache. Note that this is
+  // the number of sessions, not bytes; sessions are small (< 1 KB).
+  SSL_CTX_sess_set_cache_size(ctx, 1024 * 16);
+
+  // Set a session id context, which is required for session
+  // resumption: the server will only resume sessions that were
+  // created with the same context.
   const uint64_t session_ctx = 7;
 
   const unsigned char* session_id =
@@ -31,6 +31,7 @@
 #include <stout/os.hpp>
 
 #include "config.hpp"
+#include "resolver.hpp"
 
 using std::ios_base;
 using std::istream;
@@ -121,8 +122,12 @@ istream& operator>>(istream& stream, UPID& pid)
     return stream;
   }
 
+  // NOTE: Extraction is a synchronous interface, so the lookup
+  // cannot be deferred to a resolver thread; the resolver's cache
+  // bounds how often parsing a PID for the same host can block on
+  // DNS (the master PID gets parsed on every message from it).
   // TODO(evelinad): Extend this to support IPv6.
-  Try<net::IP> ip = net::getIP(host, AF_INET);
+  Try<net::IP> ip = internal::Resolver::instance()->lookup(host, AF_INET);
 
   if (ip.isError()) {
     VLOG(2) << ip.error();
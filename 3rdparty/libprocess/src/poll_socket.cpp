@@ -12,6 +12,8 @@
 
 #include <netinet/tcp.h>
 
+#include <sys/uio.h>
+
 #include <process/io.hpp>
 #include <process/network.hpp>
 #include <process/socket.hpp>
@@ -111,6 +113,19 @@ Future<Nothing> connect(const Socket& socket)
     return Failure("Socket error while connecting");
   }
 
+  // Turn off Nagle (TCP_NODELAY) so pipelined requests don't wait.
+  // We already do this for accepted sockets; without it outgoing
+  // links (e.g., an executor sending status updates to its local
+  // agent) can have small back-to-back messages delayed by the
+  // Nagle / delayed-ACK interaction.
+  int on = 1;
+  if (setsockopt(s, SOL_TCP, TCP_NODELAY, &on, sizeof(on)) < 0) {
+    const string error = os::strerror(errno);
+    VLOG(1) << "Failed to turn off the Nagle algorithm: " << error;
+    return Failure(
+      "Failed to turn off the Nagle algorithm: " + stringify(error));
+  }
+
   return Nothing();
 }
 
@@ -177,6 +192,44 @@ Future<size_t> socket_send_data(int s, const char* data, size_t size)
 }
 
 
+Future<size_t> socket_send_data_v(int s, const iovec* iov, int iovcnt)
+{
+  CHECK(iovcnt > 0);
+
+  while (true) {
+    // Note that we rely on process::initialize having ignored
+    // SIGPIPE (writev does not take MSG_NOSIGNAL).
+    ssize_t length = ::writev(s, iov, iovcnt);
+
+    if (length < 0 && (errno == EINTR)) {
+      // Interrupted, try again now.
+      continue;
+    } else if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // Might block, try again later.
+      return io::poll(s, io::WRITE)
+        .then(lambda::bind(&internal::socket_send_data_v, s, iov, iovcnt));
+    } else if (length <= 0) {
+      // Socket error or closed.
+      if (length < 0) {
+        const string error = os::strerror(errno);
+        VLOG(1) << "Socket error while sending: " << error;
+      } else {
+        VLOG(1) << "Socket closed while sending";
+      }
+      if (length == 0) {
+        return length;
+      } else {
+        return Failure(ErrnoError("Socket writev failed"));
+      }
+    } else {
+      CHECK(length > 0);
+
+      return length;
+    }
+  }
+}
+
+
 Future<size_t> socket_send_file(int s, int fd, off_t offset, size_t size)
 {
   CHECK(size > 0);
@@ -222,6 +275,17 @@ Future<size_t> PollSocketImpl::send(const char* data, size_t size)
 }
 
 
+Future<size_t> PollSocketImpl::send(const iovec* iov, int iovcnt)
+{
+  // Note that the caller must keep the iovec array (and the buffers
+  // it references) alive until the returned future is completed,
+  // just like the 'data' of the plain send above (the encoders own
+  // both and outlive the send).
+  return io::poll(get(), io::WRITE)
+    .then(lambda::bind(&internal::socket_send_data_v, get(), iov, iovcnt));
+}
+
+
 Future<size_t> PollSocketImpl::sendfile(int fd, off_t offset, size_t size)
 {
   return io::poll(get(), io::WRITE)
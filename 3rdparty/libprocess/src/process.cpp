@@ -13,6 +13,9 @@
 #include <errno.h>
 #include <limits.h>
 #include <netdb.h>
+#ifdef __linux__
+#include <sched.h>
+#endif // __linux__
 #include <signal.h>
 #include <stdarg.h>
 #include <stdint.h>
@@ -51,12 +54,14 @@
 #include <stack>
 #include <stdexcept>
 #include <thread>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
 #include <process/address.hpp>
 #include <process/check.hpp>
 #include <process/clock.hpp>
+#include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
@@ -79,10 +84,15 @@
 #include <process/time.hpp>
 #include <process/timer.hpp>
 
+#include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/push_gauge.hpp>
+#include <process/metrics/timer.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/foreach.hpp>
+#include <stout/gzip.hpp>
 #include <stout/lambda.hpp>
 #include <stout/net.hpp>
 #include <stout/numify.hpp>
@@ -197,10 +207,20 @@ protected:
   void initialize() override;
 
 private:
-  // Starts "waiting" on the next available future response.
+  // How many pipelined responses we wait on concurrently. Responses
+  // are always sent in request order; the lookahead just lets queued
+  // requests make progress (e.g., get demuxed and encoded) without a
+  // serial wake-up per item, which matters for monitoring clients
+  // that pipeline many requests on one connection.
+  static const size_t PIPELINE_LOOKAHEAD = 16;
+
+  // Starts "waiting" on the next available future responses (up to
+  // 'PIPELINE_LOOKAHEAD' of them) and sends those responses at the
+  // front of the queue that are ready, in order.
   void next();
 
-  // Invoked once a future response has been satisfied.
+  // Invoked once one of the waited on future responses has been
+  // satisfied (not necessarily the front of the queue).
   void waited(const Future<Response>& future);
 
   // Demuxes and handles a response.
@@ -224,10 +244,20 @@ private:
     Future<Response> future; // Make a copy.
   };
 
-  queue<Item*> items;
+  deque<Item*> items;
+
+  // The number of items at the front of the queue that we have
+  // attached a 'waited' callback to. Since waiters are attached in
+  // queue order they always cover a prefix of 'items'.
+  size_t waiting;
 
   Option<http::Pipe::Reader> pipe; // Current pipe, if streaming.
 
+  // Compresses the current stream, if the client asked for gzip via
+  // 'Accept-Encoding' (NULL otherwise). Note that non-streaming
+  // responses get compressed in HttpResponseEncoder instead.
+  Owned<gzip::Compressor> compressor;
+
   // We sequence the authentication results exposed to the caller
   // in order to satisfy HTTP pipelining.
   //
@@ -295,6 +325,12 @@ public:
   SocketManager();
   ~SocketManager();
 
+  // Registers the socket manager metrics. This is called from
+  // initialize() (rather than from the constructor) because the
+  // SocketManager is constructed before the metrics process can be
+  // spawned.
+  void initializeMetrics();
+
   void accepted(const Socket& socket);
 
   void link(ProcessBase* process,
@@ -312,6 +348,13 @@ public:
 
   Encoder* next(int s);
 
+  // Returns true if the number of bytes queued for sending to the
+  // given address exceeds the send queue high watermark. This is
+  // advisory: libprocess never drops queued messages itself, but
+  // senders can consult congestion and defer or drop work of their
+  // own (e.g., offers) while a link is backed up.
+  bool congested(const Address& address);
+
   void close(int s);
 
   void exited(const Address& address);
@@ -375,6 +418,19 @@ private:
   // Map from socket to outgoing queue.
   map<int, queue<Encoder*>> outgoing;
 
+  // Number of bytes queued in 'outgoing', per socket. Used to answer
+  // 'congested' and exposed in aggregate via the
+  // 'libprocess/sockets/send_queue_bytes' gauge.
+  map<int, size_t> outgoing_bytes;
+
+  // Total number of bytes across all the outgoing queues.
+  metrics::PushGauge send_queue_bytes;
+
+  // Tracks the time taken to establish link connections. With many
+  // remote links re-connecting at once (e.g., agents after a master
+  // failover) this is a useful signal of re-link progress.
+  metrics::Timer<Milliseconds> link_establishment;
+
   // HTTP proxies.
   map<int, HttpProxy*> proxies;
 
@@ -383,12 +439,52 @@ private:
 };
 
 
+// A metric that reports an externally measured duration (in
+// milliseconds). Unlike metrics::Timer, which measures the interval
+// between its own start() and stop(), this can be fed durations that
+// were measured elsewhere (e.g., with an event's stopwatch).
+class DurationMetric : public metrics::Metric
+{
+public:
+  explicit DurationMetric(const std::string& name)
+    : metrics::Metric(name, None()),
+      data(new std::atomic<double>(0.0)) {}
+
+  virtual Future<double> value() const
+  {
+    return data->load(std::memory_order_relaxed);
+  }
+
+  void record(const Duration& duration)
+  {
+    data->store(duration.ms(), std::memory_order_relaxed);
+
+    push(duration.ms());
+  }
+
+private:
+  // Shared so that copies of the metric (e.g., the one registered
+  // with the metrics process) see recorded values.
+  std::shared_ptr<std::atomic<double>> data;
+};
+
+
 class ProcessManager
 {
 public:
   explicit ProcessManager(const string& delegate);
   ~ProcessManager();
 
+  // Registers the metrics below. This cannot happen at construction
+  // since the ProcessManager gets constructed during initialization,
+  // before the metrics process can be spawned (see initialize()).
+  void initializeMetrics();
+
+  // Age of events at dequeue, i.e., how long events waited in a
+  // process's mailbox. Only sampled events get recorded (see
+  // ProcessBase::trace).
+  DurationMetric event_queue_age;
+
   // Initializes the processing threads and the event loop thread,
   // and returns the number of processing threads created.
   long init_threads();
@@ -422,6 +518,11 @@ public:
   void enqueue(ProcessBase* process);
   ProcessBase* dequeue();
 
+  // Pins the calling worker thread to the cpus of its assigned NUMA
+  // node. A no-op unless NUMA awareness is enabled (see
+  // 'init_threads').
+  void pin_worker(long index);
+
   void settle();
 
   // The /__processes__ route.
@@ -438,13 +539,47 @@ private:
   // Gates for waiting threads (protected by processes_mutex).
   map<ProcessBase*, Gate*> gates;
 
-  // Queue of runnable processes (implemented using list).
-  list<ProcessBase*> runq;
-  std::recursive_mutex runq_mutex;
+  // Per worker thread queue of runnable processes. Workers pull from
+  // the front of their own queue (most recently enqueued first, for
+  // cache locality) and steal from the back of other workers' queues
+  // when their own is empty (see 'dequeue'), so at high dispatch
+  // rates threads do not all contend on a single shared queue.
+  struct WorkQueue
+  {
+    std::deque<ProcessBase*> processes;
+    std::mutex mutex;
+  };
+
+  // One queue per worker thread, created at construction and const
+  // thereafter (only the queues themselves are mutated).
+  vector<WorkQueue*> queues;
+
+  // Number of worker threads (and thus queues).
+  long num_worker_threads;
+
+  // The cpu ids of each NUMA node and the node each worker thread is
+  // assigned to (indexed by worker). Both are empty unless NUMA
+  // awareness is enabled, and const after 'init_threads'. Workers
+  // pinned to a node prefer stealing work from workers on the same
+  // node (see 'dequeue') so hot processes tend to stay on one socket.
+  vector<vector<unsigned int>> numa_node_cpus;
+  vector<int> worker_numa_node;
+
+  // Used to distribute enqueues from non-worker threads across the
+  // queues.
+  std::atomic<size_t> next_queue;
 
   // Number of running processes, to support Clock::settle operation.
   std::atomic_long running;
 
+  // Number of processes waiting in the work queues, maintained with
+  // relaxed operations (it is instrumentation only) and exposed via
+  // the 'libprocess/run_queue' gauge.
+  std::atomic_long runnable;
+
+  // See 'runnable'.
+  metrics::Gauge run_queue;
+
   // Stores the thread handles so that we can join during shutdown.
   vector<std::thread*> threads;
 
@@ -463,6 +598,12 @@ static uint32_t __id__ = 0;
 // Server socket listen backlog.
 static const int LISTEN_BACKLOG = 500000;
 
+// High watermark for the number of bytes queued for sending to a
+// single remote address, beyond which the link is reported as
+// congested (see 'process::congested'). Overridable with the
+// LIBPROCESS_SEND_QUEUE_HIGH_WATERMARK environment variable.
+static size_t send_queue_high_watermark = 64 * 1024 * 1024;
+
 // Local server socket.
 static Socket* __s__ = NULL;
 
@@ -478,6 +619,10 @@ static ProcessManager* process_manager = NULL;
 // Scheduling gate that threads wait at when there is nothing to run.
 static Gate* gate = new Gate();
 
+// Index of this thread's run queue, or -1 if this is not a worker
+// thread (e.g., a thread calling into libprocess).
+static THREAD_LOCAL long __worker__ = -1;
+
 // Used for authenticating HTTP requests.
 static AuthenticatorManager* authenticator_manager = NULL;
 
@@ -863,6 +1008,17 @@ void initialize(const string& delegate)
     __address__.ip = ip.get();
   }
 
+  // Check environment for the send queue watermark.
+  value = os::getenv("LIBPROCESS_SEND_QUEUE_HIGH_WATERMARK");
+  if (value.isSome()) {
+    Try<Bytes> bytes = Bytes::parse(value.get());
+    if (bytes.isError()) {
+      LOG(FATAL) << "Parsing LIBPROCESS_SEND_QUEUE_HIGH_WATERMARK="
+                 << value.get() << " failed: " << bytes.error();
+    }
+    send_queue_high_watermark = bytes.get().bytes();
+  }
+
   // Check environment for port.
   value = os::getenv("LIBPROCESS_PORT");
   if (value.isSome()) {
@@ -982,6 +1138,11 @@ void initialize(const string& delegate)
 
   CHECK_NOTNULL(metricsProcess);
 
+  // Now that the metrics process is running we can register the
+  // socket manager metrics.
+  socket_manager->initializeMetrics();
+  process_manager->initializeMetrics();
+
   // Initialize the mime types.
   mime::initialize();
 
@@ -1038,7 +1199,8 @@ Address address()
 
 HttpProxy::HttpProxy(const Socket& _socket)
   : ProcessBase(ID::generate("__http__")),
-    socket(_socket) {}
+    socket(_socket),
+    waiting(0) {}
 
 
 HttpProxy::~HttpProxy()
@@ -1070,7 +1232,7 @@ HttpProxy::~HttpProxy()
       }
     });
 
-    items.pop();
+    items.pop_front();
     delete item;
   }
 }
@@ -1094,44 +1256,57 @@ void HttpProxy::enqueue(const Response& response, const Request& request)
 
 void HttpProxy::handle(const Future<Response>& future, const Request& request)
 {
-  items.push(new Item(request, future));
+  items.push_back(new Item(request, future));
 
-  if (items.size() == 1) {
-    next();
-  }
+  next();
 }
 
 
 void HttpProxy::next()
 {
-  if (items.size() > 0) {
-    // Wait for any transition of the future.
-    items.front()->future.onAny(
+  // Wait for any transition of the futures of up to
+  // 'PIPELINE_LOOKAHEAD' queued items. Waiters are attached in queue
+  // order so they always cover a prefix of the queue.
+  while (waiting < items.size() && waiting < PIPELINE_LOOKAHEAD) {
+    items[waiting]->future.onAny(
         defer(self(), &HttpProxy::waited, lambda::_1));
+    waiting++;
   }
-}
 
+  // Send the responses that are ready at the front of the queue, in
+  // request order. Note that we cannot demux the next response while
+  // a previous response is still streaming.
+  while (pipe.isNone() && !items.empty() && !items.front()->future.isPending()) {
+    Item* item = items.front();
 
-void HttpProxy::waited(const Future<Response>& future)
-{
-  CHECK(items.size() > 0);
-  Item* item = items.front();
+    // Process the item and determine if we're done or not (so we know
+    // whether to continue processing subsequent responses).
+    bool processed = process(item->future, item->request);
 
-  CHECK(future == item->future);
+    items.pop_front();
 
-  // Process the item and determine if we're done or not (so we know
-  // whether to start waiting on the next responses).
-  bool processed = process(item->future, item->request);
+    CHECK(waiting > 0);
+    waiting--;
 
-  items.pop();
-  delete item;
+    delete item;
 
-  if (processed) {
-    next();
+    if (!processed) {
+      break; // Started streaming; 'stream' resumes us when finished.
+    }
   }
 }
 
 
+void HttpProxy::waited(const Future<Response>& future)
+{
+  // The future corresponds to one of the items we are waiting on,
+  // which is not necessarily the front of the queue (and may have
+  // completed while a previous response was streaming), so just let
+  // 'next' send whatever responses have become sendable.
+  next();
+}
+
+
 bool HttpProxy::process(const Future<Response>& future, const Request& request)
 {
   if (!future.isReady()) {
@@ -1150,7 +1325,11 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
     response.body.clear();
 
     const string& path = response.path;
-    int fd = open(path.c_str(), O_RDONLY);
+
+    // NOTE: The file descriptor is used across asynchronous sends by
+    // FileEncoder, so make sure it does not leak into any subprocess
+    // forked in the interim.
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
     if (fd < 0) {
       if (errno == ENOENT || errno == ENOTDIR) {
           VLOG(1) << "Returning '404 Not Found' for path '" << path << "'";
@@ -1204,6 +1383,18 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
     // header, we fill in (or overwrite) 'Transfer-Encoding' header.
     response.headers["Transfer-Encoding"] = "chunked";
 
+    // Compress the stream if the client asked for it and the
+    // response is not already encoded. Streams can be very large
+    // (e.g., master state for monitoring) and compress well, so this
+    // cuts the bandwidth ~10x; unlike the non-streaming path (see
+    // HttpResponseEncoder) compression happens incrementally per
+    // chunk, without ever buffering the entire response.
+    if (!response.headers.contains("Content-Encoding") &&
+        request.acceptsEncoding("gzip")) {
+      response.headers["Content-Encoding"] = "gzip";
+      compressor = Owned<gzip::Compressor>(new gzip::Compressor());
+    }
+
     VLOG(3) << "Starting \"chunked\" streaming";
 
     socket_manager->send(
@@ -1241,13 +1432,56 @@ void HttpProxy::stream(
     std::ostringstream out;
 
     if (chunk.get().empty()) {
-      // Finished reading.
+      // Finished reading. Terminate the gzip stream (which may
+      // produce a final chunk of buffered compressed data) before
+      // the terminating chunk.
+      if (compressor.get() != NULL) {
+        Try<string> compressed = compressor->finalize();
+
+        if (compressed.isError()) {
+          // The client receives a truncated compressed stream, which
+          // it will detect; all we can do is log.
+          VLOG(1) << "Failed to finalize compressed stream: "
+                  << compressed.error();
+        } else if (!compressed.get().empty()) {
+          out << std::hex << compressed.get().size() << "\r\n";
+          out << compressed.get();
+          out << "\r\n";
+        }
+
+        compressor = Owned<gzip::Compressor>();
+      }
+
       out << "0\r\n" << "\r\n";
       finished = true;
     } else {
-      out << std::hex << chunk.get().size() << "\r\n";
-      out << chunk.get();
-      out << "\r\n";
+      string data = chunk.get();
+
+      if (compressor.get() != NULL) {
+        Try<string> compressed = compressor->compress(data);
+
+        if (compressed.isError()) {
+          VLOG(1) << "Failed to compress stream: " << compressed.error();
+          // TODO(bmahler): Have to close connection if headers were sent!
+          socket_manager->send(InternalServerError(), request, socket);
+          reader.close();
+          pipe = None();
+          compressor = Owned<gzip::Compressor>();
+          next();
+          return;
+        }
+
+        data = compressed.get();
+      }
+
+      // Note that the compressor may have buffered the input without
+      // producing output yet, in which case there is nothing to send
+      // (a zero length would terminate the chunked encoding).
+      if (!data.empty()) {
+        out << std::hex << data.size() << "\r\n";
+        out << data;
+        out << "\r\n";
+      }
 
       // Keep reading.
       reader.read()
@@ -1255,9 +1489,11 @@ void HttpProxy::stream(
     }
 
     // Always persist the connection when streaming is not finished.
-    socket_manager->send(
-        new DataEncoder(socket, out.str()),
-        finished ? request.keepAlive : true);
+    if (!out.str().empty()) {
+      socket_manager->send(
+          new DataEncoder(socket, out.str()),
+          finished ? request.keepAlive : true);
+    }
   } else if (chunk.isFailed()) {
     VLOG(1) << "Failed to read from stream: " << chunk.failure();
     // TODO(bmahler): Have to close connection if headers were sent!
@@ -1273,17 +1509,27 @@ void HttpProxy::stream(
   if (finished) {
     reader.close();
     pipe = None();
+    compressor = Owned<gzip::Compressor>();
     next();
   }
 }
 
 
-SocketManager::SocketManager() {}
+SocketManager::SocketManager()
+  : link_establishment("libprocess/link/establishment"),
+    send_queue_bytes("libprocess/sockets/send_queue_bytes") {}
 
 
 SocketManager::~SocketManager() {}
 
 
+void SocketManager::initializeMetrics()
+{
+  metrics::add(link_establishment);
+  metrics::add(send_queue_bytes);
+}
+
+
 void SocketManager::accepted(const Socket& socket)
 {
   synchronized (mutex) {
@@ -1478,7 +1724,12 @@ void SocketManager::link(
 
   if (connect) {
     CHECK_SOME(socket);
-    Socket(socket.get()).connect(to.address) // Copy to drop const.
+    Future<Nothing> connected =
+      Socket(socket.get()).connect(to.address); // Copy to drop const.
+
+    link_establishment.time(connected);
+
+    connected
       .onAny(lambda::bind(
           &SocketManager::link_connect,
           this,
@@ -1534,9 +1785,11 @@ void send(Encoder* encoder, Socket* socket)
 {
   switch (encoder->kind()) {
     case Encoder::DATA: {
+      int iovcnt;
       size_t size;
-      const char* data = reinterpret_cast<DataEncoder*>(encoder)->next(&size);
-      socket->send(data, size)
+      const iovec* iov =
+        reinterpret_cast<DataEncoder*>(encoder)->next(&iovcnt, &size);
+      socket->send(iov, iovcnt)
         .onAny(lambda::bind(
             &internal::_send,
             lambda::_1,
@@ -1610,6 +1863,8 @@ void SocketManager::send(Encoder* encoder, bool persist)
       }
 
       if (outgoing.count(socket) > 0) {
+        outgoing_bytes[socket] += encoder->remaining();
+        send_queue_bytes += encoder->remaining();
         outgoing[socket].push(encoder);
         encoder = NULL;
       } else {
@@ -1761,7 +2016,10 @@ void SocketManager::send(Message* message, const Socket::Kind& kind)
       }
 
       if (outgoing.count(socket.get()) > 0) {
-        outgoing[socket.get()].push(new MessageEncoder(socket.get(), message));
+        Encoder* encoder = new MessageEncoder(socket.get(), message);
+        outgoing_bytes[socket.get()] += encoder->remaining();
+        send_queue_bytes += encoder->remaining();
+        outgoing[socket.get()].push(encoder);
         return;
       } else {
         // Initialize the outgoing queue.
@@ -1840,10 +2098,35 @@ Encoder* SocketManager::next(int s)
         // More messages!
         Encoder* encoder = outgoing[s].front();
         outgoing[s].pop();
+
+        outgoing_bytes[s] -= encoder->remaining();
+        send_queue_bytes -= encoder->remaining();
+
+        // Coalesce any immediately following data encoders into this
+        // one so that a burst of small messages that queued up while
+        // the previous write was in flight gets flushed with a
+        // single gather write instead of a syscall per message.
+        if (encoder->kind() == Encoder::DATA) {
+          while (!outgoing[s].empty() &&
+                 outgoing[s].front()->kind() == Encoder::DATA) {
+            Encoder* coalesced = outgoing[s].front();
+            outgoing[s].pop();
+
+            outgoing_bytes[s] -= coalesced->remaining();
+            send_queue_bytes -= coalesced->remaining();
+
+            reinterpret_cast<DataEncoder*>(encoder)->append(
+                reinterpret_cast<DataEncoder*>(coalesced));
+
+            delete coalesced;
+          }
+        }
+
         return encoder;
       } else {
         // No more messages ... erase the outgoing queue.
         outgoing.erase(s);
+        outgoing_bytes.erase(s);
 
         if (dispose.count(s) > 0) {
           // This is either a temporary socket we created or it's a
@@ -1899,6 +2182,28 @@ Encoder* SocketManager::next(int s)
 }
 
 
+bool SocketManager::congested(const Address& address)
+{
+  size_t bytes = 0;
+
+  synchronized (mutex) {
+    if (persists.count(address) > 0) {
+      bytes += outgoing_bytes.count(persists[address]) > 0
+        ? outgoing_bytes[persists[address]]
+        : 0;
+    }
+
+    if (temps.count(address) > 0) {
+      bytes += outgoing_bytes.count(temps[address]) > 0
+        ? outgoing_bytes[temps[address]]
+        : 0;
+    }
+  }
+
+  return bytes >= send_queue_high_watermark;
+}
+
+
 void SocketManager::close(int s)
 {
   HttpProxy* proxy = NULL; // Non-null if needs to be terminated.
@@ -1914,11 +2219,13 @@ void SocketManager::close(int s)
       if (outgoing.count(s) > 0) {
         while (!outgoing[s].empty()) {
           Encoder* encoder = outgoing[s].front();
+          send_queue_bytes -= encoder->remaining();
           delete encoder;
           outgoing[s].pop();
         }
 
         outgoing.erase(s);
+        outgoing_bytes.erase(s);
       }
 
       // Clean up after sockets used for remote communication.
@@ -2137,6 +2444,11 @@ void SocketManager::swap_implementing_socket(const Socket& from, Socket* to)
     outgoing[to_fd] = std::move(outgoing[from_fd]);
     outgoing.erase(from_fd);
 
+    if (outgoing_bytes.count(from_fd) > 0) {
+      outgoing_bytes[to_fd] = outgoing_bytes[from_fd];
+      outgoing_bytes.erase(from_fd);
+    }
+
     // Update the fd any proxies are associated with.
     if (proxies.count(from_fd) > 0) {
       proxies[to_fd] = proxies[from_fd];
@@ -2146,10 +2458,45 @@ void SocketManager::swap_implementing_socket(const Socket& from, Socket* to)
 }
 
 
+void ProcessManager::initializeMetrics()
+{
+  metrics::add(event_queue_age);
+  metrics::add(run_queue);
+}
+
+
 ProcessManager::ProcessManager(const string& _delegate)
-  : delegate(_delegate)
+  : event_queue_age("libprocess/event_queue/age_ms"),
+    delegate(_delegate),
+    run_queue(
+        "libprocess/run_queue",
+        lambda::function<Future<double>()>(
+            [this]() -> Future<double> {
+              return static_cast<double>(
+                  runnable.load(std::memory_order_relaxed));
+            }))
 {
+  // We create no fewer than 8 threads because some tests require
+  // more worker threads than `sysconf(_SC_NPROCESSORS_ONLN)` on
+  // computers with fewer cores.
+  // e.g. https://issues.apache.org/jira/browse/MESOS-818
+  //
+  // TODO(xujyan): Use a smarter algorithm to allocate threads.
+  // Allocating a static number of threads can cause starvation if
+  // there are more waiting Processes than the number of worker
+  // threads.
+  num_worker_threads = std::max(8L, sysconf(_SC_NPROCESSORS_ONLN));
+
+  // The queues must exist before any enqueue, i.e., before any
+  // process gets spawned, hence they are created here rather than in
+  // 'init_threads'.
+  for (long i = 0; i < num_worker_threads; i++) {
+    queues.push_back(new WorkQueue());
+  }
+
+  next_queue.store(0);
   running.store(0);
+  runnable.store(0);
 }
 
 
@@ -2182,6 +2529,83 @@ ProcessManager::~ProcessManager()
     thread->join();
     delete thread;
   }
+
+  foreach (WorkQueue* queue, queues) {
+    delete queue;
+  }
+}
+
+
+// Returns the cpu ids of each NUMA node on the system, read from
+// sysfs. Returns an empty vector if the topology cannot be
+// determined (e.g., not running on Linux).
+static vector<vector<unsigned int>> numa_topology()
+{
+  vector<vector<unsigned int>> nodes;
+
+#ifdef __linux__
+  for (size_t node = 0; true; node++) {
+    Try<string> read = os::read(
+        "/sys/devices/system/node/node" + stringify(node) + "/cpulist");
+
+    if (read.isError()) {
+      break;
+    }
+
+    vector<unsigned int> cpus;
+
+    // The cpulist is a comma separated list of cpu ranges,
+    // e.g., "0-7,16-23".
+    foreach (const string& range, strings::tokenize(read.get(), ",")) {
+      vector<string> bounds = strings::tokenize(strings::trim(range), "-");
+
+      if (bounds.empty()) {
+        continue;
+      }
+
+      Try<unsigned int> from = numify<unsigned int>(strings::trim(bounds[0]));
+      Try<unsigned int> to = bounds.size() > 1
+        ? numify<unsigned int>(strings::trim(bounds[1]))
+        : from;
+
+      if (from.isError() || to.isError()) {
+        return vector<vector<unsigned int>>();
+      }
+
+      for (unsigned int cpu = from.get(); cpu <= to.get(); cpu++) {
+        cpus.push_back(cpu);
+      }
+    }
+
+    if (!cpus.empty()) {
+      nodes.push_back(cpus);
+    }
+  }
+#endif // __linux__
+
+  return nodes;
+}
+
+
+void ProcessManager::pin_worker(long index)
+{
+#ifdef __linux__
+  if (worker_numa_node.empty()) {
+    return;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  foreach (unsigned int cpu, numa_node_cpus[worker_numa_node[index]]) {
+    CPU_SET(cpu, &set);
+  }
+
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    PLOG(WARNING) << "Failed to set the NUMA cpu affinity of worker thread "
+                  << index;
+  }
+#endif // __linux__
 }
 
 
@@ -2189,25 +2613,50 @@ long ProcessManager::init_threads()
 {
   joining_threads.store(false);
 
-  // We create no fewer than 8 threads because some tests require
-  // more worker threads than `sysconf(_SC_NPROCESSORS_ONLN)` on
-  // computers with fewer cores.
-  // e.g. https://issues.apache.org/jira/browse/MESOS-818
-  //
-  // TODO(xujyan): Use a smarter algorithm to allocate threads.
-  // Allocating a static number of threads can cause starvation if
-  // there are more waiting Processes than the number of worker
-  // threads.
-  long cpus = std::max(8L, sysconf(_SC_NPROCESSORS_ONLN));
+  long cpus = num_worker_threads;
   threads.reserve(cpus+1);
 
+  // Optionally pin each worker thread to the cpus of one NUMA node,
+  // assigning workers to nodes round robin. Combined with the per
+  // worker run queues and node local work stealing (see 'dequeue'),
+  // hot processes then tend to stay on one socket instead of
+  // bouncing between them and trashing the L3 caches, and the memory
+  // the workers touch ends up node local under the kernel's first
+  // touch policy.
+  Option<string> numa = os::getenv("LIBPROCESS_NUMA_AWARE");
+  if (numa.isSome() && numa.get() == "1") {
+    numa_node_cpus = numa_topology();
+
+    if (numa_node_cpus.size() > 1) {
+      worker_numa_node.resize(cpus);
+      for (long i = 0; i < cpus; i++) {
+        worker_numa_node[i] = i % numa_node_cpus.size();
+      }
+
+      VLOG(1) << "Pinning " << cpus << " worker threads across "
+              << numa_node_cpus.size() << " NUMA nodes";
+    } else {
+      LOG(WARNING) << "LIBPROCESS_NUMA_AWARE is set but the NUMA topology"
+                   << " could not be determined or the system has a single"
+                   << " node; not pinning worker threads";
+      numa_node_cpus.clear();
+    }
+  }
+
   // Create processing threads.
   for (long i = 0; i < cpus; i++) {
     // Retain the thread handles so that we can join when shutting down.
     threads.emplace_back(
         // We pass a constant reference to `joining` to make it clear that this
         // value is only being tested (read), and not manipulated.
-        new std::thread(std::bind([](const std::atomic_bool& joining) {
+        new std::thread(std::bind([](long index, const std::atomic_bool& joining) {
+          // Mark which run queue is ours (see 'enqueue'/'dequeue').
+          __worker__ = index;
+
+          // Pin this thread to its NUMA node (if enabled) before
+          // doing any work, so that what it touches is first touched
+          // node locally.
+          process_manager->pin_worker(index);
           do {
             ProcessBase* process = process_manager->dequeue();
             if (process == NULL) {
@@ -2226,6 +2675,7 @@ long ProcessManager::init_threads()
             process_manager->resume(process);
           } while (true);
         },
+        i,
         std::cref(joining_threads))));
   }
 
@@ -2514,17 +2964,28 @@ void ProcessManager::resume(ProcessBase* process)
   }
 
   while (!terminate && !blocked) {
-    Event* event = NULL;
-
-    synchronized (process->mutex) {
-      if (process->events.size() > 0) {
-        event = process->events.front();
-        process->events.pop_front();
-        process->state = ProcessBase::RUNNING;
-      } else {
-        process->state = ProcessBase::BLOCKED;
-        blocked = true;
+    Event* event = process->events.dequeue();
+
+    if (event == NULL) {
+      // Publish that we are blocked and then recheck the queue: a
+      // sender that enqueued an event before seeing BLOCKED would
+      // not have made the process runnable, so we race the senders
+      // for the BLOCKED to READY transition (see
+      // ProcessBase::enqueue). If we win we keep running, if a
+      // sender wins it has enqueued the process and we must stop.
+      process->state.store(ProcessBase::BLOCKED);
+
+      if (!process->events.empty()) {
+        ProcessBase::State expected = ProcessBase::BLOCKED;
+        if (process->state.compare_exchange_strong(
+                expected, ProcessBase::RUNNING)) {
+          continue;
+        }
       }
+
+      blocked = true;
+    } else {
+      process->state.store(ProcessBase::RUNNING);
     }
 
     if (!blocked) {
@@ -2573,6 +3034,10 @@ void ProcessManager::resume(ProcessBase* process)
       // Determine if we should terminate.
       terminate = event->is<TerminateEvent>();
 
+      // How long the event waited in the queue (the stopwatch was
+      // started when the event got enqueued).
+      Duration queued = event->stopwatch.elapsed();
+
       // Now service the event.
       try {
         process->serve(*event);
@@ -2587,6 +3052,8 @@ void ProcessManager::resume(ProcessBase* process)
         terminate = true;
       }
 
+      process->trace(*event, queued, event->stopwatch.elapsed() - queued);
+
       delete event;
 
       if (terminate) {
@@ -2606,28 +3073,25 @@ void ProcessManager::cleanup(ProcessBase* process)
 {
   VLOG(2) << "Cleaning up " << process->pid;
 
-  // First, set the terminating state so no more events will get
-  // enqueued and delete al the pending events. We want to delete the
-  // events before we hold the processes lock because deleting an
-  // event could cause code outside libprocess to get executed which
-  // might cause a deadlock with the processes lock. Likewise,
-  // deleting the events now rather than later has the nice property
-  // of making sure that any events that might have gotten enqueued on
-  // the process we are cleaning up will get dropped (since it's
-  // terminating) and eliminates the potential of enqueueing them on
-  // another process that gets spawned with the same PID.
-  deque<Event*> events;
-
-  synchronized (process->mutex) {
-    process->state = ProcessBase::TERMINATING;
-    events = process->events;
-    process->events.clear();
-  }
-
-  // Delete pending events.
-  while (!events.empty()) {
-    Event* event = events.front();
-    events.pop_front();
+  // First, set the terminating state and decommission the event
+  // queue so no more events will get enqueued, then delete all the
+  // pending events. We want to delete the events before we hold the
+  // processes lock because deleting an event could cause code
+  // outside libprocess to get executed which might cause a deadlock
+  // with the processes lock. Likewise, deleting the events now
+  // rather than later has the nice property of making sure that any
+  // events that might have gotten enqueued on the process we are
+  // cleaning up will get dropped (since it's terminating) and
+  // eliminates the potential of enqueueing them on another process
+  // that gets spawned with the same PID.
+  process->state.store(ProcessBase::TERMINATING);
+  process->events.decommission();
+
+  // Delete pending events. Note that an enqueue racing with the
+  // decommission may still deposit an event after this drain; such
+  // events get deleted when the event queue itself is destructed.
+  Event* event = NULL;
+  while ((event = process->events.dequeue()) != NULL) {
     delete event;
   }
 
@@ -2643,23 +3107,19 @@ void ProcessManager::cleanup(ProcessBase* process)
 #endif
     }
 
-    synchronized (process->mutex) {
-      CHECK(process->events.empty());
+    processes.erase(process->pid.id);
 
-      processes.erase(process->pid.id);
-
-      // Lookup gate to wake up waiting threads.
-      map<ProcessBase*, Gate*>::iterator it = gates.find(process);
-      if (it != gates.end()) {
-        gate = it->second;
-        // N.B. The last thread that leaves the gate also free's it.
-        gates.erase(it);
-      }
-
-      CHECK(process->refs.load() == 0);
-      process->state = ProcessBase::TERMINATED;
+    // Lookup gate to wake up waiting threads.
+    map<ProcessBase*, Gate*>::iterator it = gates.find(process);
+    if (it != gates.end()) {
+      gate = it->second;
+      // N.B. The last thread that leaves the gate also free's it.
+      gates.erase(it);
     }
 
+    CHECK(process->refs.load() == 0);
+    process->state.store(ProcessBase::TERMINATED);
+
     // Note that we don't remove the process from the clock during
     // cleanup, but rather the clock is reset for a process when it is
     // created (see ProcessBase::ProcessBase). We do this so that
@@ -2771,24 +3231,37 @@ bool ProcessManager::wait(const UPID& pid)
       // Check if it is runnable in order to donate this thread.
       if (process->state == ProcessBase::BOTTOM ||
           process->state == ProcessBase::READY) {
-        synchronized (runq_mutex) {
-          list<ProcessBase*>::iterator it =
-            find(runq.begin(), runq.end(), process);
-          if (it != runq.end()) {
-            // Found it! Remove it from the run queue since we'll be
-            // donating our thread and also increment 'running' before
-            // leaving this 'runq' protected critical section so that
-            // everyone that is waiting for the processes to settle
-            // continue to wait (otherwise they could see nothing in
-            // 'runq' and 'running' equal to 0 between when we exit
-            // this critical section and increment 'running').
-            runq.erase(it);
-            running.fetch_add(1);
-          } else {
-            // Another thread has resumed the process ...
-            process = NULL;
+        // Search all the run queues since we don't know which one
+        // the process was enqueued on.
+        bool found = false;
+
+        foreach (WorkQueue* queue, queues) {
+          synchronized (queue->mutex) {
+            std::deque<ProcessBase*>::iterator it = find(
+                queue->processes.begin(), queue->processes.end(), process);
+            if (it != queue->processes.end()) {
+              // Found it! Remove it from the run queue since we'll be
+              // donating our thread and also increment 'running'
+              // before leaving this queue's critical section so that
+              // everyone that is waiting for the processes to settle
+              // continue to wait (otherwise they could see an empty
+              // queue and 'running' equal to 0 between when we exit
+              // this critical section and increment 'running').
+              queue->processes.erase(it);
+              running.fetch_add(1);
+              found = true;
+            }
+          }
+
+          if (found) {
+            break;
           }
         }
+
+        if (!found) {
+          // Another thread has resumed the process ...
+          process = NULL;
+        }
       } else {
         // Process is not runnable, so no need to donate ...
         process = NULL;
@@ -2874,16 +3347,27 @@ void ProcessManager::enqueue(ProcessBase* process)
     return;
   }
 
-  // TODO(benh): Check and see if this process has it's own thread. If
-  // it does, push it on that threads runq, and wake up that thread if
-  // it's not running. Otherwise, check and see which thread this
-  // process was last running on, and put it on that threads runq.
-
-  synchronized (runq_mutex) {
-    CHECK(find(runq.begin(), runq.end(), process) == runq.end());
-    runq.push_back(process);
+  // NOTE: A process is never enqueued twice (enforced by the
+  // BLOCKED/READY state transitions, see 'resume'), so we don't need
+  // to scan the queue for duplicates here.
+  if (__worker__ >= 0) {
+    // Push to the front of this worker's own queue: the process was
+    // just made runnable by code running on this core so its state
+    // is hot in cache, and this worker will pop it first.
+    WorkQueue* queue = queues[__worker__];
+    synchronized (queue->mutex) {
+      queue->processes.push_front(process);
+    }
+  } else {
+    // Non-worker threads distribute processes across the queues.
+    WorkQueue* queue = queues[next_queue.fetch_add(1) % queues.size()];
+    synchronized (queue->mutex) {
+      queue->processes.push_back(process);
+    }
   }
 
+  runnable.fetch_add(1, std::memory_order_relaxed);
+
   // Wake up the processing thread if necessary.
   gate->open();
 }
@@ -2891,24 +3375,64 @@ void ProcessManager::enqueue(ProcessBase* process)
 
 ProcessBase* ProcessManager::dequeue()
 {
-  // TODO(benh): Remove a process from this thread's runq. If there
-  // are no processes to run, and this is not a dedicated thread, then
-  // steal one from another threads runq.
+  // Try this worker's own queue first and then steal from the other
+  // queues. Non-worker threads (which can end up here during
+  // initialization and shutdown) simply start at the first queue.
+  const size_t start = __worker__ >= 0 ? __worker__ : 0;
+
+  // When the workers are pinned to NUMA nodes we steal in two
+  // passes: first from workers on our own node and only then from
+  // the rest, so that a process tends to stay on its socket as long
+  // as there is local work.
+  const int node = worker_numa_node.empty() ? -1 : worker_numa_node[start];
+
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < queues.size(); i++) {
+      const size_t index = (start + i) % queues.size();
+
+      if (i != 0 && node >= 0 &&
+          (worker_numa_node[index] == node) != (pass == 0)) {
+        continue;
+      }
 
-  ProcessBase* process = NULL;
+      WorkQueue* queue = queues[index];
+
+      ProcessBase* process = NULL;
+
+      synchronized (queue->mutex) {
+        if (!queue->processes.empty()) {
+          if (i == 0) {
+            // Our own queue: pop the most recently enqueued process
+            // (LIFO) since its state is most likely still in cache.
+            process = queue->processes.front();
+            queue->processes.pop_front();
+          } else {
+            // Steal the oldest process from the victim's queue so we
+            // don't race the victim for the cache-hot front.
+            process = queue->processes.back();
+            queue->processes.pop_back();
+          }
+
+          // Increment the running count of processes in order to
+          // support the Clock::settle() operation (this must be done
+          // atomically with removing the process from the queue).
+          running.fetch_add(1);
+        }
+      }
 
-  synchronized (runq_mutex) {
-    if (!runq.empty()) {
-      process = runq.front();
-      runq.pop_front();
-      // Increment the running count of processes in order to support
-      // the Clock::settle() operation (this must be done atomically
-      // with removing the process from the runq).
-      running.fetch_add(1);
+      if (process != NULL) {
+        runnable.fetch_sub(1, std::memory_order_relaxed);
+        return process;
+      }
+    }
+
+    if (node < 0) {
+      // Not pinned: the first pass already covered all the queues.
+      break;
     }
   }
 
-  return process;
+  return NULL;
 }
 
 
@@ -2932,21 +3456,37 @@ void ProcessManager::settle()
 
     done = true; // Assume to start that we are settled.
 
-    synchronized (runq_mutex) {
-      if (!runq.empty()) {
-        done = false;
-        continue;
-      }
+    // Check the queues and the running count while holding every
+    // queue's mutex, making the combined check atomic: 'running' is
+    // only incremented while holding a queue's mutex (see 'dequeue')
+    // and is only decremented after any re-enqueues the resumed
+    // process performed (which themselves need a queue's mutex), so
+    // a process that is about to reappear on an already scanned
+    // queue is still reflected in 'running'. Scanning the queues one
+    // lock at a time would let such a process slip between the scan
+    // and the 'running' check and declare the system settled while a
+    // queue holds a runnable process.
+    foreach (WorkQueue* queue, queues) {
+      queue->mutex.lock();
+    }
 
-      if (running.load() > 0) {
+    foreach (WorkQueue* queue, queues) {
+      if (!queue->processes.empty()) {
         done = false;
-        continue;
+        break;
       }
+    }
 
-      if (!Clock::settled()) {
-        done = false;
-        continue;
-      }
+    if (done && running.load() > 0) {
+      done = false;
+    }
+
+    foreach (WorkQueue* queue, queues) {
+      queue->mutex.unlock();
+    }
+
+    if (done && !Clock::settled()) {
+      done = false;
     }
   } while (!done);
 }
@@ -2954,14 +3494,26 @@ void ProcessManager::settle()
 
 Future<Response> ProcessManager::__processes__(const Request&)
 {
-  JSON::Array array;
+  // The event queue of a process may only be inspected by the thread
+  // currently running the process, so we dispatch a function into
+  // each process that renders its own queue and await the results.
+  // Note that we need a timeout because a process that terminates
+  // before servicing the dispatch will never answer (we simply omit
+  // such processes from the output, just like processes that
+  // terminate between us grabbing the list of processes and the
+  // dispatch getting delivered).
+  list<Future<Option<JSON::Object>>> futures;
 
   synchronized (processes_mutex) {
     foreachvalue (ProcessBase* process, process_manager->processes) {
-      JSON::Object object;
-      object.values["id"] = process->pid.id;
+      std::shared_ptr<Promise<Option<JSON::Object>>> promise(
+          new Promise<Option<JSON::Object>>());
 
-      JSON::Array events;
+      futures.push_back(promise->future().after(
+          Seconds(15),
+          [](const Future<Option<JSON::Object>>&) {
+            return Future<Option<JSON::Object>>(None());
+          }));
 
       struct JSONVisitor : EventVisitor
       {
@@ -3017,20 +3569,65 @@ Future<Response> ProcessManager::__processes__(const Request&)
         }
 
         JSON::Array* events;
-      } visitor(&events);
+      };
 
-      synchronized (process->mutex) {
-        foreach (Event* event, process->events) {
-          event->visit(&visitor);
-        }
-      }
+      std::shared_ptr<std::function<void(ProcessBase*)>> f(
+          new std::function<void(ProcessBase*)>(
+              [promise](ProcessBase* process) {
+                JSON::Object object;
+                object.values["id"] = process->pid.id;
+
+                // Approximate mailbox depth and its high-watermark
+                // (see EventQueue).
+                object.values["mailbox_depth"] = process->events.depth();
+                object.values["mailbox_watermark"] = process->events.watermark();
+
+                JSON::Array events;
+
+                JSONVisitor visitor(&events);
+                process->events.visit(&visitor);
+
+                object.values["events"] = events;
+
+                // Render the sampled traces of recently serviced
+                // events, oldest first.
+                JSON::Array traces;
 
-      object.values["events"] = events;
-      array.values.push_back(object);
+                for (size_t i = 0; i < process->traces.size(); i++) {
+                  const ProcessBase::EventTrace& trace =
+                    process->traces[
+                        (process->tracesIndex + i) % process->traces.size()];
+
+                  JSON::Object entry;
+                  entry.values["type"] = trace.type;
+                  entry.values["name"] = trace.name;
+                  entry.values["queued_ns"] = trace.queued.ns();
+                  entry.values["served_ns"] = trace.served.ns();
+
+                  traces.values.push_back(entry);
+                }
+
+                object.values["traces"] = traces;
+
+                promise->set(Option<JSON::Object>(object));
+              }));
+
+      internal::dispatch(process->self(), f);
     }
   }
 
-  return OK(array);
+  return await(futures)
+    .then([](const list<Future<Option<JSON::Object>>>& futures) -> Response {
+      JSON::Array array;
+
+      foreach (const Future<Option<JSON::Object>>& future, futures) {
+        if (future.isReady() && future.get().isSome()) {
+          array.values.push_back(future.get().get());
+        }
+      }
+
+      return OK(array);
+    });
 }
 
 
@@ -3042,6 +3639,9 @@ ProcessBase::ProcessBase(const string& id)
 
   refs = 0;
 
+  tracesIndex = 0;
+  serviced = 0;
+
   pid.id = id != "" ? id : ID::generate();
   pid.address = __address__;
 
@@ -3057,30 +3657,137 @@ ProcessBase::ProcessBase(const string& id)
 ProcessBase::~ProcessBase() {}
 
 
+void ProcessBase::trace(
+    const Event& event,
+    const Duration& queued,
+    const Duration& served)
+{
+  // Only trace a sample of the serviced events so that the
+  // bookkeeping (in particular the string copies below) stays off
+  // the hot path.
+  if ((serviced++ % TRACE_SAMPLE_INTERVAL) != 0) {
+    return;
+  }
+
+  // Export the mailbox age of the sampled event: a growing age on a
+  // process (e.g., the master) signals overload well before callers
+  // start timing out.
+  process_manager->event_queue_age.record(queued);
+
+  EventTrace trace;
+  trace.queued = queued;
+  trace.served = served;
+
+  struct TraceVisitor : EventVisitor
+  {
+    explicit TraceVisitor(EventTrace* _trace) : trace(_trace) {}
+
+    virtual void visit(const MessageEvent& event)
+    {
+      trace->type = "MESSAGE";
+      trace->name = event.message->name;
+    }
+
+    virtual void visit(const DispatchEvent& event)
+    {
+      trace->type = "DISPATCH";
+      if (event.functionType.isSome()) {
+        trace->name = event.functionType.get()->name();
+      }
+    }
+
+    virtual void visit(const HttpEvent& event)
+    {
+      trace->type = "HTTP";
+      trace->name = event.request->url.path;
+    }
+
+    virtual void visit(const ExitedEvent& event)
+    {
+      trace->type = "EXITED";
+    }
+
+    virtual void visit(const TerminateEvent& event)
+    {
+      trace->type = "TERMINATE";
+    }
+
+    EventTrace* trace;
+  } visitor(&trace);
+
+  event.visit(&visitor);
+
+  if (traces.size() < TRACE_CAPACITY) {
+    traces.push_back(trace);
+  } else {
+    // At capacity: overwrite the oldest entry.
+    traces[tracesIndex] = trace;
+    tracesIndex = (tracesIndex + 1) % TRACE_CAPACITY;
+  }
+}
+
+
 void ProcessBase::enqueue(Event* event, bool inject)
 {
   CHECK(event != NULL);
 
-  synchronized (mutex) {
-    if (state != TERMINATING && state != TERMINATED) {
-      if (!inject) {
-        events.push_back(event);
-      } else {
-        events.push_front(event);
-      }
+  // Start the clock on the event so that the time it spends waiting
+  // in the queue can be traced (see ProcessBase::trace).
+  event->stopwatch.start();
 
-      if (state == BLOCKED) {
-        state = READY;
-        process_manager->enqueue(this);
-      }
+  // Classify the event: HTTP requests are background work, and
+  // messages whose names the process has marked latency-critical
+  // (see 'prioritize') go ahead of ordinary events.
+  EventQueue::Priority priority = EventQueue::NORMAL;
 
-      CHECK(state == BOTTOM ||
-            state == READY ||
-            state == RUNNING);
-    } else {
-      delete event;
+  if (event->is<HttpEvent>()) {
+    priority = EventQueue::LOW;
+  } else if (event->is<MessageEvent>()) {
+    std::shared_ptr<const std::set<std::string>> names =
+      std::atomic_load(&prioritized);
+
+    if (names &&
+        names->count(event->as<MessageEvent>().message->name) > 0) {
+      priority = EventQueue::HIGH;
     }
   }
+
+  // The event queue gets decommissioned when the process starts
+  // terminating, at which point we simply drop the event.
+  if (!events.enqueue(event, priority, inject)) {
+    delete event;
+    return;
+  }
+
+  // Wake up the process if it is blocked. Note that we race with the
+  // thread running the process which rechecks the queue after
+  // publishing that it is blocked (see ProcessManager::resume);
+  // whoever wins the BLOCKED to READY transition is responsible for
+  // making the process runnable, so the process never gets enqueued
+  // twice and no event is ever lost.
+  State expected = BLOCKED;
+  if (state.compare_exchange_strong(expected, READY)) {
+    process_manager->enqueue(this);
+  }
+}
+
+
+void ProcessBase::prioritize(const string& name)
+{
+  // Copy-on-write so that senders concurrently classifying events in
+  // 'enqueue' never observe a set that is being mutated.
+  std::shared_ptr<const std::set<string>> current =
+    std::atomic_load(&prioritized);
+
+  std::shared_ptr<std::set<string>> copy = current
+    ? std::make_shared<std::set<string>>(*current)
+    : std::make_shared<std::set<string>>();
+
+  copy->insert(name);
+
+  std::atomic_store(
+      &prioritized,
+      std::shared_ptr<const std::set<string>>(copy));
 }
 
 
@@ -3465,6 +4172,18 @@ void post(const UPID& from,
 }
 
 
+bool congested(const UPID& to)
+{
+  process::initialize();
+
+  if (!to) {
+    return false;
+  }
+
+  return socket_manager->congested(to.address);
+}
+
+
 namespace inject {
 
 bool exited(const UPID& from, const UPID& to)
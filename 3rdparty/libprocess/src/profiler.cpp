@@ -10,7 +10,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/time.h>
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <glog/logging.h>
 
@@ -18,15 +34,19 @@
 #include <gperftools/profiler.h>
 #endif
 
+#include "process/delay.hpp"
 #include "process/future.hpp"
 #include "process/help.hpp"
 #include "process/http.hpp"
 #include "process/profiler.hpp"
 
+#include "stout/duration.hpp"
+#include "stout/foreach.hpp"
 #include "stout/format.hpp"
 #include "stout/option.hpp"
 #include "stout/os.hpp"
 #include "stout/os/strerror.hpp"
+#include "stout/try.hpp"
 
 namespace process {
 
@@ -34,6 +54,65 @@ namespace {
 
 const char PROFILE_FILE[] = "perftools.out";
 
+// State for the sampling profiler behind the /profiler/profile
+// endpoint. The SIGPROF handler writes into a buffer that gets
+// preallocated before the profiling timer is started, so the handler
+// itself never allocates.
+
+const long SAMPLE_FREQUENCY = 100; // Samples per second.
+const int MAX_STACK_DEPTH = 64;
+
+struct Stack
+{
+  int depth;
+  void* frames[MAX_STACK_DEPTH];
+};
+
+std::vector<Stack> samples;
+std::atomic<size_t> count(0);
+std::atomic<bool> sampling(false);
+
+
+void sample(int signal)
+{
+  // The handler can still get invoked after sampling was turned off
+  // (a timer expiration may already be in flight).
+  if (!sampling.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  size_t index = count.fetch_add(1, std::memory_order_relaxed);
+
+  if (index < samples.size()) {
+    samples[index].depth =
+      ::backtrace(samples[index].frames, MAX_STACK_DEPTH);
+  }
+}
+
+
+// Renders the frame as the demangled symbol containing the program
+// counter, or the raw address if it cannot be resolved.
+void render(std::ostringstream* out, void* frame)
+{
+  Dl_info info;
+
+  if (dladdr(frame, &info) != 0 && info.dli_sname != NULL) {
+    int status = 0;
+    char* demangled =
+      abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+
+    if (status == 0 && demangled != NULL) {
+      *out << demangled;
+    } else {
+      *out << info.dli_sname;
+    }
+
+    free(demangled);
+  } else {
+    *out << frame;
+  }
+}
+
 }  // namespace {
 
 const std::string Profiler::START_HELP()
@@ -56,6 +135,24 @@ const std::string Profiler::STOP_HELP()
 }
 
 
+const std::string Profiler::PROFILE_HELP()
+{
+  return HELP(
+    TLDR(
+        "Collects a sampling CPU profile."),
+    DESCRIPTION(
+        "Samples the stacks of the running threads with SIGPROF for",
+        "the requested duration and responds with the folded stacks,",
+        "one stack per line with the sample count appended, suitable",
+        "for generating a flame graph.",
+        "",
+        "Query parameters:",
+        "",
+        ">        duration=VALUE          Duration to sample for",
+        ">                                (e.g., '30secs', default 10secs)."));
+}
+
+
 Future<http::Response> Profiler::start(const http::Request& request)
 {
 #ifdef HAS_GPERFTOOLS
@@ -126,4 +223,138 @@ Future<http::Response> Profiler::stop(const http::Request& request)
 #endif
 }
 
+
+Future<http::Response> Profiler::profile(const http::Request& request)
+{
+  Duration duration = Seconds(10);
+
+  Option<std::string> parameter = request.url.query.get("duration");
+
+  if (parameter.isSome()) {
+    Try<Duration> parse = Duration::parse(parameter.get());
+
+    if (parse.isError()) {
+      return http::BadRequest(
+          "Invalid 'duration': " + parse.error() + ".\n");
+    }
+
+    duration = parse.get();
+  }
+
+  if (duration <= Duration::zero() || duration > Minutes(10)) {
+    return http::BadRequest(
+        "The 'duration' must be in (0secs, 10mins].\n");
+  }
+
+  if (promise.get() != NULL) {
+    return http::BadRequest("A profile is already in progress.\n");
+  }
+
+  LOG(INFO) << "Collecting a CPU profile for " << duration;
+
+  // Preallocate the sample buffer (with slack since SIGPROF delivery
+  // is not perfectly paced) so the handler never allocates.
+  samples.resize(
+      static_cast<size_t>(2 * SAMPLE_FREQUENCY * duration.secs()) + 1);
+
+  count.store(0);
+
+  // Prime 'backtrace' before taking samples from the signal handler:
+  // its first invocation may allocate (it loads libgcc lazily).
+  void* frames[MAX_STACK_DEPTH];
+  ::backtrace(frames, MAX_STACK_DEPTH);
+
+  // Install the handler and start the profiling timer. The kernel
+  // delivers SIGPROF to a thread that is currently executing, which
+  // is exactly the bias a CPU profile wants.
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = sample;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+
+  if (sigaction(SIGPROF, &action, NULL) != 0) {
+    return http::InternalServerError(
+        "Failed to install the SIGPROF handler: " +
+        os::strerror(errno) + ".\n");
+  }
+
+  sampling.store(true);
+
+  struct itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  timer.it_interval.tv_usec = 1000000 / SAMPLE_FREQUENCY;
+  timer.it_value = timer.it_interval;
+
+  if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+    sampling.store(false);
+    return http::InternalServerError(
+        "Failed to start the profiling timer: " +
+        os::strerror(errno) + ".\n");
+  }
+
+  promise = Owned<Promise<http::Response>>(new Promise<http::Response>());
+
+  delay(duration, self(), &Profiler::_profile);
+
+  return promise->future();
+}
+
+
+void Profiler::_profile()
+{
+  CHECK(promise.get() != NULL);
+
+  // Stop the timer and the handler before reading the samples.
+  struct itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  setitimer(ITIMER_PROF, &timer, NULL);
+
+  sampling.store(false);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = SIG_IGN;
+  sigaction(SIGPROF, &action, NULL);
+
+  size_t total = std::min(count.load(), samples.size());
+
+  LOG(INFO) << "Collected " << total << " samples";
+
+  // Fold identical stacks together, rendering each stack root first
+  // in the format consumed by flame graph tooling:
+  //
+  //   main;foo;bar 42
+  std::map<std::string, size_t> folded;
+
+  for (size_t i = 0; i < total; i++) {
+    const Stack& stack = samples[i];
+
+    std::ostringstream out;
+
+    // Note that 'backtrace' returns the leaf frame first.
+    for (int j = stack.depth - 1; j >= 0; j--) {
+      if (j < stack.depth - 1) {
+        out << ";";
+      }
+
+      render(&out, stack.frames[j]);
+    }
+
+    folded[out.str()]++;
+  }
+
+  std::ostringstream body;
+
+  foreachpair (const std::string& stack, size_t samples_, folded) {
+    body << stack << " " << samples_ << "\n";
+  }
+
+  // Release the sample buffer.
+  std::vector<Stack>().swap(samples);
+
+  promise->set(http::Response(http::OK(body.str())));
+  promise = Owned<Promise<http::Response>>();
+}
+
 } // namespace process {
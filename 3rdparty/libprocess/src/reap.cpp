@@ -12,12 +12,19 @@
 
 #include <glog/logging.h>
 
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
+#include <process/io.hpp>
 #include <process/once.hpp>
 #include <process/owned.hpp>
 #include <process/reap.hpp>
@@ -59,6 +66,28 @@ const size_t HIGH_PID_COUNT = 500;
 Duration MAX_REAP_INTERVAL() { return Seconds(1); }
 
 
+// A self-pipe written from the SIGCHLD handler to wake up the reaper
+// so that child exits are noticed immediately instead of on the next
+// poll. Only async-signal-safe operations are allowed in the handler
+// (so no locks, allocation, or libprocess primitives).
+static int signals[2] = {-1, -1};
+
+
+static void handler(int)
+{
+  // Preserve errno since 'write' may clobber it.
+  int saved = errno;
+
+  // The pipe is non-blocking: if it is full a wakeup is already
+  // pending and the byte can be safely dropped.
+  ssize_t result = ::write(signals[1], "", 1);
+
+  (void) result; // Silence unused result warnings.
+
+  errno = saved;
+}
+
+
 class ReaperProcess : public Process<ReaperProcess>
 {
 public:
@@ -77,9 +106,50 @@ public:
   }
 
 protected:
-  virtual void initialize() { wait(); }
+  virtual void initialize()
+  {
+    // Install a SIGCHLD handler that wakes us up through the
+    // self-pipe so that a child exit triggers an immediate scan. The
+    // periodic scan below remains as a fallback: it is still needed
+    // for registered pids that are not our children, for which no
+    // SIGCHLD is delivered.
+    if (::pipe(signals) == 0) {
+      CHECK_SOME(os::nonblock(signals[0]));
+      CHECK_SOME(os::nonblock(signals[1]));
+      CHECK_SOME(os::cloexec(signals[0]));
+      CHECK_SOME(os::cloexec(signals[1]));
+
+      struct sigaction action;
+      memset(&action, 0, sizeof(action));
+      action.sa_handler = &handler;
+      sigemptyset(&action.sa_mask);
+      action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+
+      if (::sigaction(SIGCHLD, &action, NULL) != 0) {
+        PLOG(WARNING) << "Failed to install SIGCHLD handler, "
+                      << "falling back to polling for reaping";
+        ::close(signals[0]);
+        ::close(signals[1]);
+        signals[0] = signals[1] = -1;
+      } else {
+        listen();
+      }
+    } else {
+      PLOG(WARNING) << "Failed to create a self-pipe for reaping, "
+                    << "falling back to polling";
+    }
+
+    wait();
+  }
 
   void wait()
+  {
+    scan();
+
+    delay(interval(), self(), &ReaperProcess::wait); // Reap forever!
+  }
+
+  void scan()
   {
     // There are two cases to consider for each pid when it terminates:
     //   1) The process is our child. In this case, we will reap the process and
@@ -101,8 +171,24 @@ protected:
         notify(pid, None());
       }
     }
+  }
 
-    delay(interval(), self(), &ReaperProcess::wait); // Reap forever!
+  void listen()
+  {
+    io::poll(signals[0], io::READ)
+      .onAny(defer(self(), &ReaperProcess::signaled));
+  }
+
+  void signaled()
+  {
+    // Drain the pipe: multiple signals may have coalesced into a
+    // single wakeup.
+    char buffer[256];
+    while (::read(signals[0], buffer, sizeof(buffer)) > 0) {}
+
+    scan();
+
+    listen();
   }
 
   void notify(pid_t pid, Result<int> status)
@@ -0,0 +1,169 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <string>
+#include <utility>
+
+#include <process/clock.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/option.hpp>
+#include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
+
+#include "resolver.hpp"
+
+using std::string;
+
+namespace process {
+namespace internal {
+
+// Number of dedicated resolver threads. Lookups beyond this many
+// in-flight queue up, but the queue only ever delays other lookups,
+// never message processing.
+static const size_t RESOLVER_THREADS = 2;
+
+// How long successful resolutions are served from the cache.
+static const Duration RESOLVER_CACHE_TTL = Seconds(60);
+
+
+static string key(const string& hostname, int family)
+{
+  return hostname + "/" + stringify(family);
+}
+
+
+Resolver* Resolver::instance()
+{
+  // NOTE: The singleton is intentionally leaked: the resolver
+  // threads run until the program exits.
+  static Resolver* resolver = new Resolver();
+  return resolver;
+}
+
+
+Resolver::Resolver()
+{
+  for (size_t i = 0; i < RESOLVER_THREADS; i++) {
+    threads.push_back(new std::thread(&Resolver::run, this));
+  }
+}
+
+
+Option<net::IP> Resolver::cached(const string& key)
+{
+  Option<Entry> entry = cache.get(key);
+
+  if (entry.isSome() && entry.get().expiration > Clock::now()) {
+    return entry.get().ip;
+  }
+
+  return None();
+}
+
+
+Future<net::IP> Resolver::resolve(const string& hostname, int family)
+{
+  synchronized (mutex) {
+    Option<net::IP> ip = cached(key(hostname, family));
+
+    if (ip.isSome()) {
+      return ip.get();
+    }
+  }
+
+  Request request;
+  request.hostname = hostname;
+  request.family = family;
+  request.promise = Owned<Promise<net::IP>>(new Promise<net::IP>());
+
+  Future<net::IP> future = request.promise->future();
+
+  synchronized (mutex) {
+    requests.push(std::move(request));
+  }
+
+  condition.notify_one();
+
+  return future;
+}
+
+
+Try<net::IP> Resolver::lookup(const string& hostname, int family)
+{
+  synchronized (mutex) {
+    Option<net::IP> ip = cached(key(hostname, family));
+
+    if (ip.isSome()) {
+      return ip.get();
+    }
+  }
+
+  Try<net::IP> ip = net::getIP(hostname, family);
+
+  if (ip.isSome()) {
+    Entry entry{ip.get(), Clock::now() + RESOLVER_CACHE_TTL};
+
+    synchronized (mutex) {
+      cache.put(key(hostname, family), entry);
+    }
+  }
+
+  return ip;
+}
+
+
+void Resolver::run()
+{
+  while (true) {
+    Request request;
+
+    synchronized (mutex) {
+      while (requests.empty()) {
+        synchronized_wait(&condition, &mutex);
+      }
+
+      request = std::move(requests.front());
+      requests.pop();
+    }
+
+    // Check the cache again: an identical lookup may have completed
+    // while this request was queued.
+    synchronized (mutex) {
+      Option<net::IP> ip = cached(key(request.hostname, request.family));
+
+      if (ip.isSome()) {
+        request.promise->set(ip.get());
+        continue;
+      }
+    }
+
+    Try<net::IP> ip = net::getIP(request.hostname, request.family);
+
+    if (ip.isError()) {
+      request.promise->fail(
+          "Failed to resolve '" + request.hostname + "': " + ip.error());
+      continue;
+    }
+
+    Entry entry{ip.get(), Clock::now() + RESOLVER_CACHE_TTL};
+
+    synchronized (mutex) {
+      cache.put(key(request.hostname, request.family), entry);
+    }
+
+    request.promise->set(ip.get());
+  }
+}
+
+} // namespace internal {
+} // namespace process {
@@ -0,0 +1,94 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __RESOLVER_HPP__
+#define __RESOLVER_HPP__
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/time.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/net.hpp>
+#include <stout/try.hpp>
+
+namespace process {
+namespace internal {
+
+// Performs DNS resolution on dedicated threads, with a small
+// TTL-bounded cache of successful resolutions. A slow DNS server
+// would otherwise stall the libprocess worker thread performing the
+// blocking `getaddrinfo`, and with it every process multiplexed onto
+// that thread.
+class Resolver
+{
+public:
+  // Returns the singleton, constructing it (and starting the
+  // resolver threads) on first use.
+  static Resolver* instance();
+
+  // Asynchronously resolves the hostname. The lookup runs on a
+  // resolver thread, consulting the cache first; the returned future
+  // never blocks the caller.
+  Future<net::IP> resolve(const std::string& hostname, int family);
+
+  // Returns a cached resolution if one is still fresh, otherwise
+  // resolves on the calling thread (and caches the result). Intended
+  // for callers with synchronous interfaces (e.g., UPID parsing),
+  // for which the cache bounds how often they can block.
+  Try<net::IP> lookup(const std::string& hostname, int family);
+
+private:
+  struct Request
+  {
+    std::string hostname;
+    int family;
+    Owned<Promise<net::IP>> promise;
+  };
+
+  struct Entry
+  {
+    net::IP ip;
+    Time expiration;
+  };
+
+  Resolver();
+
+  // Not copyable, not assignable.
+  Resolver(const Resolver&);
+  Resolver& operator=(const Resolver&);
+
+  // Resolver thread body: performs queued lookups.
+  void run();
+
+  // Returns the cached resolution, if present and not expired.
+  // Expects `mutex` to be held by the caller.
+  Option<net::IP> cached(const std::string& key);
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::queue<Request> requests;
+  hashmap<std::string, Entry> cache;
+  std::vector<std::thread*> threads;
+};
+
+} // namespace internal {
+} // namespace process {
+
+#endif // __RESOLVER_HPP__
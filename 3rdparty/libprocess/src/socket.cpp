@@ -235,6 +235,23 @@ static Future<Nothing> _send(
 }
 
 
+Future<size_t> Socket::Impl::send(const iovec* iov, int iovcnt)
+{
+  // Default to sending the first non-empty buffer: callers already
+  // treat the result as a potentially partial send and follow up
+  // with the remaining data. Implementations that can perform a
+  // gather write (e.g., PollSocketImpl using writev) override this.
+  for (int i = 0; i < iovcnt; i++) {
+    if (iov[i].iov_len > 0) {
+      return send(reinterpret_cast<const char*>(iov[i].iov_base),
+                  iov[i].iov_len);
+    }
+  }
+
+  return 0;
+}
+
+
 Future<Nothing> Socket::Impl::send(const std::string& _data)
 {
   Owned<string> data(new string(_data));
@@ -10,6 +10,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
@@ -179,6 +180,85 @@ static int childMain(
 }
 
 
+// Spawns the child process using 'posix_spawnp', which is backed by
+// 'vfork' and thus avoids duplicating the parent's page tables the
+// way 'fork' does; for a parent with a large resident set (e.g., an
+// agent) this noticeably reduces spawn latency. This is only usable
+// when the caller specified no 'setup' or 'clone' hooks, since no
+// arbitrary code can run between the spawn and the exec.
+//
+// NOTE: All the redirection file descriptors are close-on-exec in the
+// parent by this point (see the 'cloexec' call in 'subprocess') and
+// 'adddup2' duplicates without the close-on-exec flag, so the child
+// ends up with exactly stdin/stdout/stderr and whatever the caller
+// intentionally leaked.
+//
+// On failure, returns -1 with 'errno' set.
+static pid_t posixSpawn(
+    const string& path,
+    char** argv,
+    char** envp,
+    int stdinFd[2],
+    int stdoutFd[2],
+    int stderrFd[2])
+{
+  posix_spawn_file_actions_t actions;
+
+  // NOTE: The 'posix_spawn' family returns error numbers rather than
+  // setting 'errno'.
+  int error = posix_spawn_file_actions_init(&actions);
+  if (error != 0) {
+    errno = error;
+    return -1;
+  }
+
+  posix_spawnattr_t attributes;
+
+  error = posix_spawnattr_init(&attributes);
+  if (error != 0) {
+    posix_spawn_file_actions_destroy(&actions);
+    errno = error;
+    return -1;
+  }
+
+#ifdef POSIX_SPAWN_USEVFORK
+  // Ask glibc to use 'vfork' rather than 'fork'. Newer versions
+  // always spawn with vfork semantics and ignore this flag.
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_USEVFORK);
+#endif
+
+  error = posix_spawn_file_actions_adddup2(
+      &actions, stdinFd[0], STDIN_FILENO);
+
+  if (error == 0) {
+    error = posix_spawn_file_actions_adddup2(
+        &actions, stdoutFd[1], STDOUT_FILENO);
+  }
+
+  if (error == 0) {
+    error = posix_spawn_file_actions_adddup2(
+        &actions, stderrFd[1], STDERR_FILENO);
+  }
+
+  pid_t pid = -1;
+
+  if (error == 0) {
+    error = posix_spawnp(
+        &pid, path.c_str(), &actions, &attributes, argv, envp);
+  }
+
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attributes);
+
+  if (error != 0) {
+    errno = error;
+    return -1;
+  }
+
+  return pid;
+}
+
+
 Try<Subprocess> subprocess(
     const string& path,
     vector<string> argv,
@@ -355,24 +435,40 @@ Try<Subprocess> subprocess(
     envp[index] = NULL;
   }
 
-  // Determine the function to clone the child process. If the user
-  // does not specify the clone function, we will use the default.
-  lambda::function<pid_t(const lambda::function<int()>&)> clone =
-    (_clone.isSome() ? _clone.get() : defaultClone);
-
-  // Now, clone the child process.
-  pid_t pid = clone(lambda::bind(
-      &childMain,
-      path,
-      _argv,
-      in,
-      out,
-      err,
-      envp,
-      setup,
-      stdinFd,
-      stdoutFd,
-      stderrFd));
+  pid_t pid;
+
+  if (setup.isNone() &&
+      _clone.isNone() &&
+      stdinFd[0] > STDERR_FILENO &&
+      stdoutFd[1] > STDERR_FILENO &&
+      stderrFd[1] > STDERR_FILENO) {
+    // Without 'setup' or 'clone' hooks there is no need to run any
+    // code in the child before the exec, so we can use the cheaper
+    // 'posix_spawn' rather than fork the (potentially very large)
+    // parent. We require the redirection file descriptors to be
+    // outside of the standard three since the spawn file actions
+    // 'dup2' onto those in place.
+    pid = posixSpawn(path, _argv, envp, stdinFd, stdoutFd, stderrFd);
+  } else {
+    // Determine the function to clone the child process. If the user
+    // does not specify the clone function, we will use the default.
+    lambda::function<pid_t(const lambda::function<int()>&)> clone =
+      (_clone.isSome() ? _clone.get() : defaultClone);
+
+    // Now, clone the child process.
+    pid = clone(lambda::bind(
+        &childMain,
+        path,
+        _argv,
+        in,
+        out,
+        err,
+        envp,
+        setup,
+        stdinFd,
+        stdoutFd,
+        stderrFd));
+  }
 
   delete[] _argv;
 
@@ -385,7 +481,7 @@ Try<Subprocess> subprocess(
 
   if (pid == -1) {
     // Save the errno as 'close' below might overwrite it.
-    ErrnoError error("Failed to clone");
+    ErrnoError error("Failed to spawn child process");
     internal::close(stdinFd, stdoutFd, stderrFd);
     return error;
   }
@@ -39,8 +39,11 @@ TEST(EncoderTest, Response)
   http::Request request;
   const http::OK response("body");
 
-  // Encode the response.
-  const string encoded = HttpResponseEncoder::encode(response, request);
+  // Encode the response (concatenating the gather write buffers).
+  string encoded;
+  for (const string& buffer : HttpResponseEncoder::encode(response, request)) {
+    encoded += buffer;
+  }
 
   // Now decode it back, and verify the encoding was correct.
   ResponseDecoder decoder;
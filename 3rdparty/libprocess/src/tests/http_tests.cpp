@@ -296,6 +296,39 @@ TEST(HTTPTest, PipeReaderCloses)
 }
 
 
+TEST(HTTPTest, PipeOutstanding)
+{
+  http::Pipe pipe;
+  http::Pipe::Reader reader = pipe.reader();
+  http::Pipe::Writer writer = pipe.writer();
+
+  EXPECT_EQ(0u, writer.outstanding());
+
+  // Unread writes are counted.
+  EXPECT_TRUE(writer.write("hello"));
+  EXPECT_TRUE(writer.write("world"));
+  EXPECT_EQ(10u, writer.outstanding());
+
+  // Reads drain the accounting.
+  AWAIT_EQ("hello", reader.read());
+  EXPECT_EQ(5u, writer.outstanding());
+
+  // A write that satisfies a pending read is never buffered.
+  Future<string> read = reader.read();
+  AWAIT_EQ("world", read);
+
+  read = reader.read();
+  EXPECT_TRUE(writer.write("!"));
+  AWAIT_EQ("!", read);
+  EXPECT_EQ(0u, writer.outstanding());
+
+  // Closing the read end discards any unread data.
+  EXPECT_TRUE(writer.write("discarded"));
+  EXPECT_TRUE(reader.close());
+  EXPECT_EQ(0u, writer.outstanding());
+}
+
+
 TEST(HTTPTest, Encode)
 {
   string unencoded = "a$&+,/:;=?@ \"<>#%{}|\\^~[]`\x19\x80\xFF";
@@ -28,7 +28,9 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
+#include <process/metrics/histogram.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/push_gauge.hpp>
 #include <process/metrics/timer.hpp>
 
 namespace http = process::http;
@@ -40,6 +42,8 @@ using http::Response;
 
 using metrics::Counter;
 using metrics::Gauge;
+using metrics::Histogram;
+using metrics::PushGauge;
 using metrics::Timer;
 
 using process::Clock;
@@ -130,6 +134,37 @@ TEST(MetricsTest, Gauge)
 }
 
 
+// A push gauge's value is read directly, without dispatching
+// into the owning actor.
+TEST(MetricsTest, PushGauge)
+{
+  PushGauge gauge("test/push_gauge");
+
+  AWAIT_READY(metrics::add(gauge));
+
+  AWAIT_EXPECT_EQ(0.0, gauge.value());
+
+  ++gauge;
+  AWAIT_EXPECT_EQ(1.0, gauge.value());
+
+  gauge += 42;
+  AWAIT_EXPECT_EQ(43.0, gauge.value());
+
+  --gauge;
+  AWAIT_EXPECT_EQ(42.0, gauge.value());
+
+  gauge -= 42;
+  AWAIT_EXPECT_EQ(0.0, gauge.value());
+
+  gauge = 42;
+  AWAIT_EXPECT_EQ(42.0, gauge.value());
+
+  EXPECT_NONE(gauge.statistics());
+
+  AWAIT_READY(metrics::remove(gauge));
+}
+
+
 TEST(MetricsTest, Statistics)
 {
   Counter counter("test/counter", process::TIME_SERIES_WINDOW);
@@ -404,6 +439,75 @@ TEST(MetricsTest, SnapshotStatistics)
 }
 
 
+TEST(MetricsTest, Histogram)
+{
+  Histogram histogram("test/histogram");
+
+  AWAIT_READY(metrics::add(histogram));
+
+  for (size_t i = 1; i <= 1000; i++) {
+    histogram.observe(i);
+  }
+
+  AWAIT_EXPECT_EQ(1000.0, histogram.value());
+
+  Option<Statistics<double>> statistics = histogram.statistics();
+  ASSERT_SOME(statistics);
+
+  EXPECT_EQ(1000u, statistics.get().count);
+
+  // The extrema are tracked exactly.
+  EXPECT_FLOAT_EQ(1.0, statistics.get().min);
+  EXPECT_FLOAT_EQ(1000.0, statistics.get().max);
+
+  // The percentiles are approximated by the bucket resolution: with
+  // 32 sub-buckets per power of two the relative error is at most
+  // ~3%.
+  EXPECT_NEAR(500.0, statistics.get().p50, 500.0 * 0.04);
+  EXPECT_NEAR(900.0, statistics.get().p90, 900.0 * 0.04);
+  EXPECT_NEAR(950.0, statistics.get().p95, 950.0 * 0.04);
+  EXPECT_NEAR(990.0, statistics.get().p99, 990.0 * 0.04);
+
+  AWAIT_READY(metrics::remove(histogram));
+}
+
+
+TEST(MetricsTest, HistogramWindow)
+{
+  Clock::pause();
+
+  // The histogram rotates its buckets every half window, covering
+  // between half and one full window of observations.
+  Histogram histogram("test/histogram", Seconds(10));
+
+  histogram.observe(1.0);
+  histogram.observe(2.0);
+
+  Clock::advance(Seconds(6));
+
+  histogram.observe(3.0);
+  histogram.observe(4.0);
+
+  // Both half windows are reflected.
+  Option<Statistics<double>> statistics = histogram.statistics();
+  ASSERT_SOME(statistics);
+  EXPECT_EQ(4u, statistics.get().count);
+  EXPECT_FLOAT_EQ(1.0, statistics.get().min);
+  EXPECT_FLOAT_EQ(4.0, statistics.get().max);
+
+  // Another rotation drops the first two observations.
+  Clock::advance(Seconds(6));
+
+  statistics = histogram.statistics();
+  ASSERT_SOME(statistics);
+  EXPECT_EQ(2u, statistics.get().count);
+  EXPECT_FLOAT_EQ(3.0, statistics.get().min);
+  EXPECT_FLOAT_EQ(4.0, statistics.get().max);
+
+  Clock::resume();
+}
+
+
 TEST(MetricsTest, Timer)
 {
   metrics::Timer<Nanoseconds> timer("test/timer");
@@ -1368,7 +1368,10 @@ TEST(ProcessTest, Remote)
   message.from = UPID();
   message.to = process.self();
 
-  const string data = MessageEncoder::encode(&message);
+  string data;
+  for (const string& buffer : MessageEncoder::encode(&message)) {
+    data += buffer;
+  }
 
   AWAIT_READY(socket.send(data));
 
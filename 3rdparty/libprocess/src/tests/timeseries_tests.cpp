@@ -214,3 +214,105 @@ TEST(TimeSeriesTest, Truncate)
   // Done!
   Clock::resume();
 }
+
+
+list<int> toList(const process::TieredTimeSeries<int>& series)
+{
+  list<int> result;
+  foreach (const process::TieredTimeSeries<int>::Value& value, series.get()) {
+    result.push_back(value.data);
+  }
+  return result;
+}
+
+
+TEST(TieredTimeSeriesTest, Set)
+{
+  process::TieredTimeSeries<int> series;
+
+  ASSERT_TRUE(series.empty());
+
+  series.set(1);
+
+  ASSERT_FALSE(series.empty());
+
+  const Option<process::TieredTimeSeries<int>::Value> latest =
+    series.latest();
+
+  ASSERT_SOME(latest);
+  ASSERT_EQ(1, latest.get().data);
+}
+
+
+TEST(TieredTimeSeriesTest, Downsample)
+{
+  Clock::pause();
+  Time now = Clock::now();
+
+  // With a capacity of 8, the raw tier holds 4 values and each
+  // downsampled tier holds 2.
+  process::TieredTimeSeries<int> series(Duration::max(), 8);
+
+  series.set(0, now);
+  series.set(1, now + Seconds(1));
+  series.set(2, now + Seconds(2));
+  series.set(3, now + Seconds(3));
+
+  ASSERT_EQ(list<int>({0, 1, 2, 3}), toList(series));
+
+  // '0' is evicted from the raw tier into the 10 second tier.
+  series.set(4, now + Seconds(4));
+  ASSERT_EQ(list<int>({0, 1, 2, 3, 4}), toList(series));
+
+  // '1' through '3' are within 10 seconds of '0', so they are
+  // dropped when evicted from the raw tier.
+  series.set(5, now + Seconds(5));
+  series.set(6, now + Seconds(6));
+  series.set(7, now + Seconds(7));
+  ASSERT_EQ(list<int>({0, 4, 5, 6, 7}), toList(series));
+
+  series.set(10, now + Seconds(10));
+  series.set(11, now + Seconds(11));
+  series.set(12, now + Seconds(12));
+  series.set(13, now + Seconds(13));
+
+  // '4' through '7' are likewise dropped when evicted, since they
+  // are all within 10 seconds of '0'.
+  ASSERT_EQ(list<int>({0, 10, 11, 12, 13}), toList(series));
+
+  // Out-of-order samples are dropped.
+  series.set(14, now + Seconds(1));
+  ASSERT_EQ(list<int>({0, 10, 11, 12, 13}), toList(series));
+
+  Clock::resume();
+}
+
+
+TEST(TieredTimeSeriesTest, Truncate)
+{
+  Clock::pause();
+  Time now = Clock::now();
+
+  process::TieredTimeSeries<int> series(Seconds(10), 8);
+
+  series.set(0, now);
+  series.set(1, now + Seconds(1));
+  series.set(2, now + Seconds(2));
+  series.set(3, now + Seconds(3));
+
+  ASSERT_EQ(list<int>({0, 1, 2, 3}), toList(series));
+
+  // Cause the first 2 values to fall outside the window.
+  Clock::advance(Seconds(10 + 2));
+  series.truncate();
+
+  ASSERT_EQ(list<int>({2, 3}), toList(series));
+
+  // At least one value always remains.
+  Clock::advance(Seconds(10));
+  series.truncate();
+
+  ASSERT_EQ(list<int>({3}), toList(series));
+
+  Clock::resume();
+}
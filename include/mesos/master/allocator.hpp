@@ -30,6 +30,7 @@
 #include <mesos/resources.hpp>
 
 #include <process/future.hpp>
+#include <process/time.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
@@ -42,6 +43,71 @@ namespace mesos {
 namespace master {
 namespace allocator {
 
+/**
+ * Describes a single resource recovery, i.e., one invocation of
+ * `Allocator::recoverResources`. Used by the bulk overload of that
+ * method below.
+ */
+struct ResourceRecovery
+{
+  FrameworkID frameworkId;
+  SlaveID slaveId;
+  Resources resources;
+  Option<Filters> filters;
+};
+
+
+/**
+ * Describes a single unavailability update, i.e., one invocation of
+ * `Allocator::updateUnavailability`. Used by the bulk overload of
+ * that method below.
+ */
+struct UnavailabilityUpdate
+{
+  SlaveID slaveId;
+  Option<Unavailability> unavailability;
+};
+
+
+/**
+ * Describes a single inverse offer update, i.e., one invocation of
+ * `Allocator::updateInverseOffer`. Used by the bulk overload of that
+ * method below.
+ */
+struct InverseOfferUpdate
+{
+  SlaveID slaveId;
+  FrameworkID frameworkId;
+  Option<UnavailableResources> unavailableResources;
+  Option<InverseOfferStatus> status;
+  Option<Filters> filters;
+};
+
+
+/**
+ * A snapshot of a single sorter client (a role, or a framework within
+ * a role) as maintained by an allocator, used for introspection via
+ * the master's '/allocator' endpoint. See `Allocator::getSorterState`.
+ */
+struct ClientState
+{
+  std::string name;
+
+  // The weight applied to the client's share.
+  double weight;
+
+  // The client's dominant share of the total resources, in [0, 1].
+  double share;
+
+  // Whether the client is currently considered for allocation.
+  bool active;
+
+  // Total allocated scalar resources, aggregated across agents and
+  // keyed by resource name (e.g., "cpus").
+  hashmap<std::string, double> allocation;
+};
+
+
 /**
  * Basic model of an allocator: resources are allocated to a framework
  * in the form of offers. A framework can refuse some resources in
@@ -89,7 +155,7 @@ public:
       const Duration& allocationInterval,
       const lambda::function<
           void(const FrameworkID&,
-               const hashmap<SlaveID, Resources>&)>& offerCallback,
+               hashmap<SlaveID, Resources>)>& offerCallback,
       const lambda::function<
           void(const FrameworkID&,
                const hashmap<SlaveID, UnavailableResources>&)>&
@@ -281,6 +347,18 @@ public:
       const SlaveID& slaveId,
       const Option<Unavailability>& unavailability) = 0;
 
+  /**
+   * Updates unavailabilities in bulk.
+   *
+   * Semantically equivalent to calling the above overload once per
+   * element, except that the allocator may coalesce the resulting
+   * allocations into a single pass over the affected agents. The
+   * master uses this when applying a maintenance schedule, where the
+   * number of agents transitioned at once can be large.
+   */
+  virtual void updateUnavailability(
+      const std::vector<UnavailabilityUpdate>& updates) = 0;
+
   /**
    * Updates inverse offer.
    *
@@ -306,6 +384,17 @@ public:
       const Option<InverseOfferStatus>& status,
       const Option<Filters>& filters = None()) = 0;
 
+  /**
+   * Updates inverse offers in bulk.
+   *
+   * Semantically equivalent to calling the above overload once per
+   * element, but incurs only a single call into the allocator. The
+   * master uses this when rescinding the inverse offers of many
+   * agents at once (e.g., when a maintenance schedule changes).
+   */
+  virtual void updateInverseOffer(
+      const std::vector<InverseOfferUpdate>& updates) = 0;
+
   /**
    * Retrieves the status of all inverse offers maintained by the allocator.
    */
@@ -313,6 +402,23 @@ public:
       hashmap<SlaveID, hashmap<FrameworkID, mesos::master::InverseOfferStatus>>>
     getInverseOfferStatuses() = 0;
 
+  /**
+   * Retrieves the state of the allocator's sorters.
+   *
+   * Returns a snapshot of each sorter's clients (shares, weights and
+   * aggregated allocations), keyed by a sorter name (e.g., "roles",
+   * or "frameworks/<role>" for the per-role framework sorters).
+   * Exposed via the master's '/allocator' endpoint so that operators
+   * can inspect the shares the allocator actually sorts on.
+   *
+   * Implementations should maintain this state incrementally so that
+   * taking the snapshot is O(clients) and does not perturb the
+   * allocation cycle.
+   */
+  virtual process::Future<
+      hashmap<std::string, std::vector<ClientState>>>
+    getSorterState() = 0;
+
   /**
    * Recovers resources.
    *
@@ -326,6 +432,18 @@ public:
       const Resources& resources,
       const Option<Filters>& filters) = 0;
 
+  /**
+   * Recovers resources in bulk.
+   *
+   * Semantically equivalent to calling the above overload once per
+   * element, but incurs only a single call into the allocator. The
+   * master uses this on paths that produce many recoveries at once
+   * (e.g., removing a framework with a large number of tasks), where
+   * per-recovery calls would be prohibitively expensive.
+   */
+  virtual void recoverResources(
+      const std::vector<ResourceRecovery>& recoveries) = 0;
+
   /**
    * Suppresses offers.
    *
@@ -341,6 +459,19 @@ public:
   virtual void reviveOffers(
       const FrameworkID& frameworkId) = 0;
 
+  /**
+   * Informs the allocator when the framework started holding its
+   * oldest outstanding (unaccepted) offer, or that it no longer
+   * holds any offers (`heldSince` is none). Offers held longer than
+   * `threshold` weigh increasingly on the framework's fair share so
+   * that hoarding frameworks are pushed down the allocation order
+   * instead of distorting fairness for everybody else.
+   */
+  virtual void updateOfferHolding(
+      const FrameworkID& frameworkId,
+      const Option<process::Time>& heldSince,
+      const Duration& threshold) = 0;
+
   /**
    * Informs the allocator to set quota for the given role.
    *
@@ -19,6 +19,7 @@
 
 #include <map>
 #include <iosfwd>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -197,6 +198,10 @@ public:
   /*implicit*/
   Resources(const google::protobuf::RepeatedPtrField<Resource>& _resources);
 
+  // NOTE: Copying shares the underlying resources with the source
+  // object; a private copy is only made when one of the objects is
+  // mutated (copy-on-write). This makes the pervasive pass-by-value
+  // usage of Resources cheap.
   Resources(const Resources& that) : resources(that.resources) {}
 
   Resources& operator=(const Resources& that)
@@ -207,7 +212,10 @@ public:
     return *this;
   }
 
-  bool empty() const { return resources.size() == 0; }
+  bool empty() const
+  {
+    return resources.get() == NULL || resources->size() == 0;
+  }
 
   // Checks if this Resources is a superset of the given Resources.
   bool contains(const Resources& that) const;
@@ -323,11 +331,13 @@ public:
   typedef google::protobuf::RepeatedPtrField<Resource>::const_iterator
   const_iterator;
 
-  iterator begin() { return resources.begin(); }
-  iterator end() { return resources.end(); }
+  // NOTE: Mutable iteration makes a private copy of the underlying
+  // resources if they are currently shared with other objects.
+  iterator begin();
+  iterator end();
 
-  const_iterator begin() const { return resources.begin(); }
-  const_iterator end() const { return resources.end(); }
+  const_iterator begin() const;
+  const_iterator end() const;
 
   // Using this operator makes it easy to copy a resources object into
   // a protocol buffer field.
@@ -361,12 +371,38 @@ private:
   // ensure this is warranted.
   bool _contains(const Resource& that) const;
 
+  // Similar to 'operator+=(const Resource&)' but skips the validity
+  // and emptiness checks. This can be used to avoid the performance
+  // overhead of validation when the resource can be assumed valid
+  // (e.g. it's inside another Resources). Resource arithmetic is on
+  // the master's hot path during offer cycles, where both operands
+  // are always already validated.
+  void add(const Resource& that);
+
+  // Similar to 'operator-=(const Resource&)' but skips the validity
+  // and emptiness checks, see the note above.
+  void subtract(const Resource& that);
+
+  // Returns the underlying repeated field, which may be shared with
+  // other Resources objects. Returns a canonical empty field if this
+  // object has never held any resources.
+  const google::protobuf::RepeatedPtrField<Resource>& repeated() const;
+
+  // Returns a mutable reference to the underlying repeated field,
+  // making a private copy of it first if it is currently shared with
+  // other Resources objects (copy-on-write).
+  google::protobuf::RepeatedPtrField<Resource>& unshared();
+
   // Similar to the public 'find', but only for a single Resource
   // object. The target resource may span multiple roles, so this
   // returns Resources.
   Option<Resources> find(const Resource& target) const;
 
-  google::protobuf::RepeatedPtrField<Resource> resources;
+  // The underlying resources, shared between copies of this object
+  // until one of them is mutated (copy-on-write). A NULL pointer is
+  // equivalent to an empty field, which keeps default construction
+  // of the (very common) empty Resources allocation free.
+  std::shared_ptr<google::protobuf::RepeatedPtrField<Resource>> resources;
 };
 
 
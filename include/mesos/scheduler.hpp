@@ -241,6 +241,19 @@ public:
   // will be dropped (these semantics may be changed in the future).
   virtual Status killTask(const TaskID& taskId) = 0;
 
+  // Kills the specified tasks, with the same (unreliable) semantics
+  // as 'killTask'. The default implementation simply kills the tasks
+  // one at a time; drivers may override this to batch the kills into
+  // fewer messages.
+  virtual Status killTasks(const std::vector<TaskID>& taskIds)
+  {
+    Status status = DRIVER_RUNNING;
+    for (size_t i = 0; i < taskIds.size(); i++) {
+      status = killTask(taskIds[i]);
+    }
+    return status;
+  }
+
   // Accepts the given offers and performs a sequence of operations on
   // those accepted offers. See Offer.Operation in mesos.proto for the
   // set of available operations. Available resources are aggregated
@@ -408,6 +421,8 @@ public:
 
   virtual Status killTask(const TaskID& taskId);
 
+  virtual Status killTasks(const std::vector<TaskID>& taskIds);
+
   virtual Status acceptOffers(
       const std::vector<OfferID>& offerIds,
       const std::vector<Offer::Operation>& operations,
@@ -19,17 +19,21 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <mesos/resources.hpp>
 
 // ONLY USEFUL AFTER RUNNING PROTOC.
 #include <mesos/slave/isolator.pb.h>
 
+#include <process/collect.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/option.hpp>
 #include <stout/try.hpp>
@@ -49,6 +53,16 @@ public:
       const std::list<ContainerState>& states,
       const hashset<ContainerID>& orphans) = 0;
 
+  // Returns whether this isolator's 'prepare' may run concurrently
+  // with that of other isolators which also permit it. Isolators
+  // whose preparation mutates state that other isolators observe
+  // (e.g., mounting the container's filesystem) must return false,
+  // in which case 'prepare' is invoked according to the isolator
+  // ordering and completes before any subsequent isolator's
+  // 'prepare' is started. This defaults to false since concurrent
+  // preparation is not safe in general.
+  virtual bool supportsParallelPrepare() { return false; }
+
   // Prepare for isolation of the executor. Any steps that require
   // execution in the containerized context (e.g. inside a network
   // namespace) can be returned in the optional CommandInfo and they
@@ -80,6 +94,37 @@ public:
   virtual process::Future<ResourceStatistics> usage(
       const ContainerID& containerId) = 0;
 
+  // Gather resource usage statistics for all the given containers.
+  // The default implementation simply issues one 'usage' call per
+  // container; isolators that can collect statistics for many
+  // containers in a single pass should override this. Statistics
+  // that could not be gathered are omitted from the result.
+  virtual process::Future<hashmap<ContainerID, ResourceStatistics>> usages(
+      const std::vector<ContainerID>& containerIds)
+  {
+    std::list<process::Future<ResourceStatistics>> futures;
+    foreach (const ContainerID& containerId, containerIds) {
+      futures.push_back(usage(containerId));
+    }
+
+    return process::await(futures)
+      .then([containerIds](
+          const std::list<process::Future<ResourceStatistics>>& futures)
+            -> hashmap<ContainerID, ResourceStatistics> {
+        hashmap<ContainerID, ResourceStatistics> statistics;
+
+        size_t i = 0;
+        foreach (const process::Future<ResourceStatistics>& future, futures) {
+          if (future.isReady()) {
+            statistics.put(containerIds[i], future.get());
+          }
+          i++;
+        }
+
+        return statistics;
+      });
+  }
+
   // Clean up a terminated container. This is called after the
   // executor and all processes in the container have terminated.
   virtual process::Future<Nothing> cleanup(
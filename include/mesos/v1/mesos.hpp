@@ -17,6 +17,7 @@
 #ifndef __MESOS_V1_HPP__
 #define __MESOS_V1_HPP__
 
+#include <functional>
 #include <iosfwd>
 #include <string>
 #include <vector>
@@ -361,9 +362,11 @@ struct hash<mesos::v1::ContainerID>
 
   result_type operator()(const argument_type& containerId) const
   {
-    size_t seed = 0;
-    boost::hash_combine(seed, containerId.value());
-    return seed;
+    // NOTE: This (and the other ID hashes below) intentionally uses
+    // 'std::hash' on the underlying string rather than
+    // 'boost::hash_combine'; see the corresponding specializations
+    // in 'mesos/type_utils.hpp'.
+    return std::hash<std::string>()(containerId.value());
   }
 };
 
@@ -377,9 +380,7 @@ struct hash<mesos::v1::ExecutorID>
 
   result_type operator()(const argument_type& executorId) const
   {
-    size_t seed = 0;
-    boost::hash_combine(seed, executorId.value());
-    return seed;
+    return std::hash<std::string>()(executorId.value());
   }
 };
 
@@ -393,9 +394,7 @@ struct hash<mesos::v1::FrameworkID>
 
   result_type operator()(const argument_type& frameworkId) const
   {
-    size_t seed = 0;
-    boost::hash_combine(seed, frameworkId.value());
-    return seed;
+    return std::hash<std::string>()(frameworkId.value());
   }
 };
 
@@ -409,9 +408,7 @@ struct hash<mesos::v1::OfferID>
 
   result_type operator()(const argument_type& offerId) const
   {
-    size_t seed = 0;
-    boost::hash_combine(seed, offerId.value());
-    return seed;
+    return std::hash<std::string>()(offerId.value());
   }
 };
 
@@ -425,9 +422,7 @@ struct hash<mesos::v1::AgentID>
 
   result_type operator()(const argument_type& agentId) const
   {
-    size_t seed = 0;
-    boost::hash_combine(seed, agentId.value());
-    return seed;
+    return std::hash<std::string>()(agentId.value());
   }
 };
 
@@ -441,9 +436,7 @@ struct hash<mesos::v1::TaskID>
 
   result_type operator()(const argument_type& taskId) const
   {
-    size_t seed = 0;
-    boost::hash_combine(seed, taskId.value());
-    return seed;
+    return std::hash<std::string>()(taskId.value());
   }
 };
 
@@ -374,7 +374,14 @@ public:
   explicit CRAMMD5AuthenticatorSession(const UPID& pid)
   {
     process = new CRAMMD5AuthenticatorSessionProcess(pid);
-    spawn(process);
+
+    // Let libprocess delete the session process once it terminates
+    // so that tearing a session down does not require a blocking
+    // 'wait' here. The destructor runs on the authenticator actor,
+    // and blocking it on session cleanup serializes the whole
+    // authentication pipeline when many agents re-authenticate at
+    // once (e.g., during a master failover).
+    spawn(process, true);
   }
 
   virtual ~CRAMMD5AuthenticatorSession()
@@ -384,8 +391,6 @@ public:
     // CRAMMD5AuthenticatorSessionProcess queue instead of at the front.
     // The long term fix for this is https://reviews.apache.org/r/25945/.
     terminate(process, false);
-    wait(process);
-    delete process;
   }
 
   virtual Future<Option<string>> authenticate()
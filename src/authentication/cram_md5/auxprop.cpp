@@ -36,7 +36,9 @@ namespace internal {
 namespace cram_md5 {
 
 // Storage for the static members.
-Multimap<string, Property> InMemoryAuxiliaryPropertyPlugin::properties;
+std::shared_ptr<const Multimap<string, Property>>
+  InMemoryAuxiliaryPropertyPlugin::properties(
+      new Multimap<string, Property>());
 sasl_auxprop_plug_t InMemoryAuxiliaryPropertyPlugin::plugin;
 std::mutex InMemoryAuxiliaryPropertyPlugin::mutex;
 
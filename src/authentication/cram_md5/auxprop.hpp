@@ -17,6 +17,7 @@
 #ifndef __AUTHENTICATION_CRAM_MD5_AUXPROP_HPP__
 #define __AUTHENTICATION_CRAM_MD5_AUXPROP_HPP__
 
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -47,8 +48,11 @@ public:
 
   static void load(const Multimap<std::string, Property>& _properties)
   {
+    std::shared_ptr<const Multimap<std::string, Property>> snapshot(
+        new Multimap<std::string, Property>(_properties));
+
     synchronized (mutex) {
-      properties = _properties;
+      properties = snapshot;
     }
   }
 
@@ -56,12 +60,20 @@ public:
       const std::string& user,
       const std::string& name)
   {
+    // Grab an immutable snapshot of the properties so that the
+    // critical section is just a pointer copy: concurrent
+    // authenticator sessions then walk the properties without
+    // serializing on the lock.
+    std::shared_ptr<const Multimap<std::string, Property>> snapshot;
+
     synchronized (mutex) {
-      if (properties.contains(user)) {
-        foreach (const Property& property, properties.get(user)) {
-          if (property.name == name) {
-            return property.values;
-          }
+      snapshot = properties;
+    }
+
+    if (snapshot->contains(user)) {
+      foreach (const Property& property, snapshot->get(user)) {
+        if (property.name == name) {
+          return property.values;
         }
       }
     }
@@ -91,12 +103,12 @@ private:
 
   // TODO(tillt): For allowing multiple authenticators with differing
   // credentials, consider using a non-static credential properties.
-  static Multimap<std::string, Property> properties;
+  static std::shared_ptr<const Multimap<std::string, Property>> properties;
 
   static sasl_auxprop_plug_t plugin;
 
-  // Access to 'properties' has to be protected as multiple
-  // authenticator instances may be active concurrently.
+  // Protects the 'properties' pointer; the pointed-to snapshot is
+  // immutable and safe to read without the lock.
   static std::mutex mutex;
 };
 
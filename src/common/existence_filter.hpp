@@ -0,0 +1,103 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __COMMON_EXISTENCE_FILTER_HPP__
+#define __COMMON_EXISTENCE_FILTER_HPP__
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <stout/check.hpp>
+
+namespace mesos {
+namespace internal {
+
+// A compact counting bloom filter used to front exact membership
+// structures: when 'possiblyContains' returns false the element was
+// definitely never added (or has since been removed), so callers can
+// skip walking the exact (often nested) maps in the common miss
+// case. A positive answer may be a false positive and must fall
+// through to the exact check.
+//
+// Elements are identified by their hash; use 'combine' to derive a
+// single hash for compound keys. Since the filter counts insertions
+// it supports removal, but every removal must match a prior
+// addition or the filter may later claim a present element is
+// absent.
+class ExistenceFilter
+{
+public:
+  // NOTE: 'slots' must be a power of two. With the two probes used
+  // here the false positive rate stays under ~1% while the number of
+  // resident elements is below a tenth of the slots; beyond that the
+  // filter degrades gracefully to letting most checks fall through.
+  explicit ExistenceFilter(size_t slots = 16384)
+    : counters(slots, 0), mask(slots - 1)
+  {
+    CHECK(slots > 0 && (slots & mask) == 0)
+      << "Number of slots must be a power of two";
+  }
+
+  // Mixes a hash into a seed (the mixing used by boost's
+  // hash_combine), for filtering on compound keys.
+  static size_t combine(size_t seed, size_t hash)
+  {
+    return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+  }
+
+  void add(size_t hash)
+  {
+    ++counters[first(hash)];
+    ++counters[second(hash)];
+  }
+
+  void remove(size_t hash)
+  {
+    CHECK_GT(counters[first(hash)], 0u);
+    CHECK_GT(counters[second(hash)], 0u);
+
+    --counters[first(hash)];
+    --counters[second(hash)];
+  }
+
+  // Returns false only if the element is definitely absent.
+  bool possiblyContains(size_t hash) const
+  {
+    return counters[first(hash)] != 0 && counters[second(hash)] != 0;
+  }
+
+private:
+  size_t first(size_t hash) const
+  {
+    return hash & mask;
+  }
+
+  size_t second(size_t hash) const
+  {
+    // Derive an independent probe with a cheap multiplicative remix.
+    return static_cast<size_t>(
+        (hash * UINT64_C(0x9e3779b97f4a7c15)) >> 16) & mask;
+  }
+
+  std::vector<uint16_t> counters;
+  size_t mask;
+};
+
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __COMMON_EXISTENCE_FILTER_HPP__
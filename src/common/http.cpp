@@ -17,10 +17,13 @@
 #include <map>
 #include <ostream>
 #include <set>
+#include <streambuf>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <process/async.hpp>
+
 #include <mesos/attributes.hpp>
 #include <mesos/http.hpp>
 #include <mesos/resources.hpp>
@@ -40,8 +43,70 @@ using std::set;
 using std::string;
 using std::vector;
 
+using process::http::OK;
+using process::http::Pipe;
+using process::http::Response;
+
+
 namespace mesos {
 
+namespace {
+
+// A streambuf that flushes its buffer into a pipe writer in bounded
+// chunks, used to stream serialized output into a chunked response
+// without materializing the whole body in memory.
+class PipeWriterStreambuf : public std::streambuf
+{
+public:
+  explicit PipeWriterStreambuf(
+      const Pipe::Writer& _writer,
+      size_t chunk = 64 * 1024)
+    : writer(_writer),
+      buffer(chunk)
+  {
+    setp(&buffer[0], &buffer[0] + buffer.size());
+  }
+
+protected:
+  virtual int overflow(int c)
+  {
+    flush();
+
+    if (c != EOF) {
+      *pptr() = static_cast<char>(c);
+      pbump(1);
+    }
+
+    return c;
+  }
+
+  virtual int sync()
+  {
+    flush();
+    return 0;
+  }
+
+private:
+  void flush()
+  {
+    size_t size = pptr() - pbase();
+
+    if (size > 0) {
+      // NOTE: A failed write means the reader has gone away (e.g.,
+      // the client disconnected); we keep serializing into the void
+      // since there is no way to abort the serialization function.
+      writer.write(string(pbase(), size));
+      setp(&buffer[0], &buffer[0] + buffer.size());
+    }
+  }
+
+  Pipe::Writer writer;
+  std::vector<char> buffer;
+};
+
+} // namespace {
+
+
 ostream& operator<<(ostream& stream, ContentType contentType)
 {
   switch (contentType) {
@@ -58,6 +123,54 @@ ostream& operator<<(ostream& stream, ContentType contentType)
 
 namespace internal {
 
+Response streamed(
+    const std::function<void(std::ostream*)>& serialize,
+    const Option<string>& jsonp)
+{
+  Pipe pipe;
+
+  OK response;
+  response.type = Response::PIPE;
+  response.reader = pipe.reader();
+
+  if (jsonp.isSome()) {
+    response.headers["Content-Type"] = "text/javascript";
+  } else {
+    response.headers["Content-Type"] = "application/json";
+  }
+
+  // Serialize on a worker thread so that the first bytes reach the
+  // client immediately and the actor serving the request is not
+  // blocked on serialization of a potentially very large body.
+  // NOTE: We wrap the work in a 'std::function' since mutable
+  // lambdas cannot be invoked through the const reference that
+  // 'async' takes.
+  Pipe::Writer writer = pipe.writer();
+
+  std::function<void()> work = [serialize, writer, jsonp]() mutable {
+    PipeWriterStreambuf streambuf(writer);
+    std::ostream out(&streambuf);
+
+    if (jsonp.isSome()) {
+      out << jsonp.get() << "(";
+    }
+
+    serialize(&out);
+
+    if (jsonp.isSome()) {
+      out << ");";
+    }
+
+    out.flush();
+    writer.close();
+  };
+
+  process::async(work);
+
+  return response;
+}
+
+
 string serialize(
     ContentType contentType,
     const google::protobuf::Message& message)
@@ -473,6 +586,118 @@ void json(JSON::ObjectWriter* writer, const CommandInfo& command)
 }
 
 
+// NOTE: The protobuf message writers below (and their helpers) must
+// produce exactly the JSON that the reflection based conversion in
+// 'stout/protobuf.hpp' produces, since they replace it on the
+// '/state' serving path: fields appear in declaration order, unset
+// optional fields with an explicit default are included, and empty
+// repeated fields are omitted.
+void json(JSON::ObjectWriter* writer, const ContainerInfo& containerInfo)
+{
+  writer->field("type", ContainerInfo::Type_Name(containerInfo.type()));
+
+  if (containerInfo.volumes().size() > 0) {
+    writer->field("volumes", containerInfo.volumes());
+  }
+
+  if (containerInfo.has_hostname()) {
+    writer->field("hostname", containerInfo.hostname());
+  }
+
+  if (containerInfo.has_docker()) {
+    writer->field("docker", containerInfo.docker());
+  }
+
+  if (containerInfo.has_mesos()) {
+    writer->field("mesos", containerInfo.mesos());
+  }
+
+  if (containerInfo.network_infos().size() > 0) {
+    writer->field("network_infos", [&containerInfo](JSON::ArrayWriter* writer) {
+      foreach (const NetworkInfo& info, containerInfo.network_infos()) {
+        // NOTE: We write 'NetworkInfo' out field by field here rather
+        // than using the overload below, which serves the webui
+        // format that omits the deprecated 'protocol' and
+        // 'ip_address' fields and writes labels as a bare array.
+        writer->element([&info](JSON::ObjectWriter* writer) {
+          if (info.ip_addresses().size() > 0) {
+            writer->field("ip_addresses", info.ip_addresses());
+          }
+
+          if (info.has_protocol()) {
+            writer->field(
+                "protocol", NetworkInfo::Protocol_Name(info.protocol()));
+          }
+
+          if (info.has_ip_address()) {
+            writer->field("ip_address", info.ip_address());
+          }
+
+          if (info.groups().size() > 0) {
+            writer->field("groups", info.groups());
+          }
+
+          if (info.has_labels()) {
+            writer->field("labels", [&info](JSON::ObjectWriter* writer) {
+              if (info.labels().labels().size() > 0) {
+                writer->field("labels", info.labels().labels());
+              }
+            });
+          }
+        });
+      }
+    });
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const ContainerInfo::DockerInfo& docker)
+{
+  writer->field("image", docker.image());
+  writer->field(
+      "network", ContainerInfo::DockerInfo::Network_Name(docker.network()));
+
+  if (docker.port_mappings().size() > 0) {
+    writer->field("port_mappings", docker.port_mappings());
+  }
+
+  writer->field("privileged", docker.privileged());
+
+  if (docker.parameters().size() > 0) {
+    writer->field("parameters", docker.parameters());
+  }
+
+  if (docker.has_force_pull_image()) {
+    writer->field("force_pull_image", docker.force_pull_image());
+  }
+
+  if (docker.has_volume_driver()) {
+    writer->field("volume_driver", docker.volume_driver());
+  }
+}
+
+
+void json(
+    JSON::ObjectWriter* writer,
+    const ContainerInfo::DockerInfo::PortMapping& mapping)
+{
+  writer->field("host_port", mapping.host_port());
+  writer->field("container_port", mapping.container_port());
+
+  if (mapping.has_protocol()) {
+    writer->field("protocol", mapping.protocol());
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const ContainerInfo::MesosInfo& mesos)
+{
+  if (mesos.has_image()) {
+    writer->field("image", mesos.image());
+  }
+}
+
+
 void json(JSON::ObjectWriter* writer, const ContainerStatus& status)
 {
   if (status.network_infos().size() > 0) {
@@ -481,6 +706,66 @@ void json(JSON::ObjectWriter* writer, const ContainerStatus& status)
 }
 
 
+void json(JSON::ObjectWriter* writer, const Credential& credential)
+{
+  writer->field("principal", credential.principal());
+
+  if (credential.has_secret()) {
+    writer->field("secret", credential.secret());
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const DiscoveryInfo& discovery)
+{
+  writer->field(
+      "visibility", DiscoveryInfo::Visibility_Name(discovery.visibility()));
+
+  if (discovery.has_name()) {
+    writer->field("name", discovery.name());
+  }
+
+  if (discovery.has_environment()) {
+    writer->field("environment", discovery.environment());
+  }
+
+  if (discovery.has_location()) {
+    writer->field("location", discovery.location());
+  }
+
+  if (discovery.has_version()) {
+    writer->field("version", discovery.version());
+  }
+
+  if (discovery.has_ports()) {
+    writer->field("ports", discovery.ports());
+  }
+
+  if (discovery.has_labels()) {
+    writer->field("labels", [&discovery](JSON::ObjectWriter* writer) {
+      if (discovery.labels().labels().size() > 0) {
+        writer->field("labels", discovery.labels().labels());
+      }
+    });
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const Environment& environment)
+{
+  if (environment.variables().size() > 0) {
+    writer->field("variables", environment.variables());
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const Environment::Variable& variable)
+{
+  writer->field("name", variable.name());
+  writer->field("value", variable.value());
+}
+
+
 void json(JSON::ObjectWriter* writer, const ExecutorInfo& executorInfo)
 {
   writer->field("executor_id", executorInfo.executor_id().value());
@@ -491,6 +776,58 @@ void json(JSON::ObjectWriter* writer, const ExecutorInfo& executorInfo)
 }
 
 
+void json(JSON::ObjectWriter* writer, const Image& image)
+{
+  writer->field("type", Image::Type_Name(image.type()));
+
+  if (image.has_appc()) {
+    writer->field("appc", image.appc());
+  }
+
+  if (image.has_docker()) {
+    writer->field("docker", image.docker());
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const Image::Appc& appc)
+{
+  writer->field("name", appc.name());
+
+  if (appc.has_id()) {
+    writer->field("id", appc.id());
+  }
+
+  if (appc.has_labels()) {
+    writer->field("labels", [&appc](JSON::ObjectWriter* writer) {
+      if (appc.labels().labels().size() > 0) {
+        writer->field("labels", appc.labels().labels());
+      }
+    });
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const Image::Docker& docker)
+{
+  writer->field("name", docker.name());
+
+  if (docker.has_credential()) {
+    writer->field("credential", docker.credential());
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const Label& label)
+{
+  writer->field("key", label.key());
+
+  if (label.has_value()) {
+    writer->field("value", label.value());
+  }
+}
+
+
 void json(JSON::ArrayWriter* writer, const Labels& labels)
 {
   json(writer, labels.labels());
@@ -517,6 +854,61 @@ void json(JSON::ObjectWriter* writer, const NetworkInfo& info)
 }
 
 
+void json(JSON::ObjectWriter* writer, const NetworkInfo::IPAddress& ipAddress)
+{
+  if (ipAddress.has_protocol()) {
+    writer->field(
+        "protocol", NetworkInfo::Protocol_Name(ipAddress.protocol()));
+  }
+
+  if (ipAddress.has_ip_address()) {
+    writer->field("ip_address", ipAddress.ip_address());
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const Parameter& parameter)
+{
+  writer->field("key", parameter.key());
+  writer->field("value", parameter.value());
+}
+
+
+void json(JSON::ObjectWriter* writer, const Port& port)
+{
+  writer->field("number", port.number());
+
+  if (port.has_name()) {
+    writer->field("name", port.name());
+  }
+
+  if (port.has_protocol()) {
+    writer->field("protocol", port.protocol());
+  }
+
+  if (port.has_visibility()) {
+    writer->field(
+        "visibility", DiscoveryInfo::Visibility_Name(port.visibility()));
+  }
+
+  if (port.has_labels()) {
+    writer->field("labels", [&port](JSON::ObjectWriter* writer) {
+      if (port.labels().labels().size() > 0) {
+        writer->field("labels", port.labels().labels());
+      }
+    });
+  }
+}
+
+
+void json(JSON::ObjectWriter* writer, const Ports& ports)
+{
+  if (ports.ports().size() > 0) {
+    writer->field("ports", ports.ports());
+  }
+}
+
+
 void json(JSON::ObjectWriter* writer, const Resources& resources)
 {
   hashmap<std::string, double> scalars = {{"cpus", 0}, {"mem", 0}, {"disk", 0}};
@@ -566,6 +958,21 @@ void json(JSON::ObjectWriter* writer, const TaskStatus& status)
 }
 
 
+void json(JSON::ObjectWriter* writer, const Volume& volume)
+{
+  writer->field("mode", Volume::Mode_Name(volume.mode()));
+  writer->field("container_path", volume.container_path());
+
+  if (volume.has_host_path()) {
+    writer->field("host_path", volume.host_path());
+  }
+
+  if (volume.has_image()) {
+    writer->field("image", volume.image());
+  }
+}
+
+
 void json(JSON::NumberWriter* writer, const Value::Scalar& scalar)
 {
   writer->set(scalar.value());
@@ -17,14 +17,21 @@
 #ifndef __COMMON_HTTP_HPP__
 #define __COMMON_HTTP_HPP__
 
+#include <functional>
+#include <ostream>
+#include <string>
 #include <vector>
 
 #include <mesos/http.hpp>
 #include <mesos/mesos.hpp>
 
+#include <process/http.hpp>
+
 #include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/jsonify.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
 #include <stout/protobuf.hpp>
 
 namespace mesos {
@@ -73,6 +80,36 @@ Try<Message> deserialize(
 }
 
 
+// Returns an OK response whose body is produced by the given
+// serialization function, streamed to the client through a pipe
+// using chunked transfer encoding in bounded chunks instead of being
+// materialized in memory up front. Serialization runs on a worker
+// thread, so the function must not reference state that may be
+// mutated or destroyed concurrently. If 'jsonp' is provided the
+// output is wrapped accordingly. Prefer the 'streamingOK' wrapper
+// below for values serializable via 'jsonify'.
+process::http::Response streamed(
+    const std::function<void(std::ostream*)>& serialize,
+    const Option<std::string>& jsonp = None());
+
+
+// Returns an OK response whose body is the JSON serialization of
+// 'value' (via 'jsonify'), streamed to the client through a chunked
+// response. The value is copied since serialization happens on a
+// worker thread; any callbacks inside it must capture by value.
+template <typename T>
+process::http::Response streamingOK(
+    const T& value,
+    const Option<std::string>& jsonp = None())
+{
+  return streamed(
+      [value](std::ostream* out) {
+        *out << jsonify(value);
+      },
+      jsonp);
+}
+
+
 JSON::Object model(const Resources& resources);
 JSON::Object model(const hashmap<std::string, Resources>& roleResources);
 JSON::Object model(const Attributes& attributes);
@@ -99,6 +136,15 @@ void json(JSON::ArrayWriter* writer, const Labels& labels);
 void json(JSON::ObjectWriter* writer, const Resources& resources);
 void json(JSON::ObjectWriter* writer, const TaskStatus& status);
 
+// Direct serializers for message types that used to be converted via
+// the reflection based 'JSON::protobuf' in stout. They produce the
+// same JSON but without the per-field reflection lookups, which show
+// up prominently in profiles of '/state' serving.
+void json(JSON::ObjectWriter* writer, const ContainerInfo& containerInfo);
+void json(JSON::ObjectWriter* writer, const DiscoveryInfo& discovery);
+void json(JSON::ObjectWriter* writer, const Environment& environment);
+void json(JSON::ObjectWriter* writer, const Label& label);
+
 } // namespace mesos {
 
 #endif // __COMMON_HTTP_HPP__
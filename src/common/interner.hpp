@@ -0,0 +1,96 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __COMMON_INTERNER_HPP__
+#define __COMMON_INTERNER_HPP__
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <stout/hashmap.hpp>
+#include <stout/synchronized.hpp>
+
+namespace mesos {
+namespace internal {
+
+// Interns immutable copies of protobuf messages: all callers holding
+// identical messages share a single heap allocation. This matters for
+// "info" messages (e.g., ExecutorInfo) that are stored once per
+// bookkeeping structure and are typically identical across thousands
+// of entries. The returned messages must not be mutated; updated
+// messages should simply be interned again (copy-on-update).
+//
+// The interner only holds weak references, so an interned message is
+// freed when the last caller drops it.
+template <typename T>
+class Interner
+{
+public:
+  Interner() : threshold(SWEEP_THRESHOLD) {}
+
+  std::shared_ptr<const T> intern(const T& message)
+  {
+    // NOTE: Protobuf serialization is not canonical in general, but
+    // within a single build identical messages serialize identically,
+    // which is all that is relied upon here: a spurious mismatch only
+    // costs a duplicate allocation.
+    const std::string key = message.SerializeAsString();
+
+    std::shared_ptr<const T> shared;
+
+    synchronized (mutex) {
+      shared = interned[key].lock();
+
+      if (shared == NULL) {
+        shared.reset(new T(message));
+        interned[key] = shared;
+      }
+
+      // Sweep expired entries (messages whose last reference has been
+      // dropped) once the map has grown enough since the last sweep
+      // that they could dominate it. This keeps the sweep amortized
+      // constant time per intern.
+      if (interned.size() >= threshold) {
+        auto iterator = interned.begin();
+        while (iterator != interned.end()) {
+          if (iterator->second.expired()) {
+            iterator = interned.erase(iterator);
+          } else {
+            ++iterator;
+          }
+        }
+
+        threshold = std::max(size_t(SWEEP_THRESHOLD), interned.size() * 2);
+      }
+    }
+
+    return shared;
+  }
+
+private:
+  static const size_t SWEEP_THRESHOLD = 1024;
+
+  std::mutex mutex;
+  hashmap<std::string, std::weak_ptr<const T>> interned;
+  size_t threshold;
+};
+
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __COMMON_INTERNER_HPP__
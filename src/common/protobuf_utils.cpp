@@ -184,6 +184,37 @@ Task createTask(
 }
 
 
+// 64-bit FNV-1a over the given data, optionally seeded with the
+// result of a previous call to chain multiple fields.
+static uint64_t fnv1a(
+    const string& data,
+    uint64_t hash = 14695981039346656037ULL)
+{
+  foreach (char c, data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+
+uint64_t taskDigest(const TaskID& taskId, const TaskState& state)
+{
+  // NOTE: The state is hashed by its numeric value (not its name) so
+  // that renaming an enum constant does not change digests.
+  return fnv1a(
+      stringify(static_cast<int>(state)),
+      fnv1a(taskId.value() + ":"));
+}
+
+
+uint64_t executorDigest(const ExecutorID& executorId)
+{
+  return fnv1a("executor:" + executorId.value());
+}
+
+
 Option<bool> getTaskHealth(const Task& task)
 {
   Option<bool> healthy = None();
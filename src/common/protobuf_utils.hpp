@@ -80,6 +80,21 @@ Task createTask(
     const FrameworkID& frameworkId);
 
 
+// Stable 64-bit hashes used for the differential agent
+// re-registration digests (see 'ReregisterSlaveMessage.digests').
+// The per-framework digest is the XOR of the hashes of every task
+// (identity and latest state) and executor held for the framework,
+// which makes it order independent and cheap to maintain
+// incrementally as tasks are added, removed, or change state. The
+// hashes must agree between the master and agents across versions
+// and processes, so 'std::hash' (which is implementation defined)
+// cannot be used here.
+uint64_t taskDigest(const TaskID& taskId, const TaskState& state);
+
+
+uint64_t executorDigest(const ExecutorID& executorId);
+
+
 Option<bool> getTaskHealth(const Task& task);
 
 
@@ -708,11 +708,35 @@ Resources::Resources(const RepeatedPtrField<Resource>& _resources)
 }
 
 
+Resources::iterator Resources::begin()
+{
+  return unshared().begin();
+}
+
+
+Resources::iterator Resources::end()
+{
+  return unshared().end();
+}
+
+
+Resources::const_iterator Resources::begin() const
+{
+  return repeated().begin();
+}
+
+
+Resources::const_iterator Resources::end() const
+{
+  return repeated().end();
+}
+
+
 bool Resources::contains(const Resources& that) const
 {
   Resources remaining = *this;
 
-  foreach (const Resource& resource, that.resources) {
+  foreach (const Resource& resource, that.repeated()) {
     // NOTE: We use _contains because Resources only contain valid
     // Resource objects, and we don't want the performance hit of the
     // validity check.
@@ -740,7 +764,7 @@ Resources Resources::filter(
     const lambda::function<bool(const Resource&)>& predicate) const
 {
   Resources result;
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     if (predicate(resource)) {
       result += resource;
     }
@@ -753,7 +777,7 @@ hashmap<string, Resources> Resources::reserved() const
 {
   hashmap<string, Resources> result;
 
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     if (isReserved(resource)) {
       result[resource.role()] += resource;
     }
@@ -800,7 +824,7 @@ Resources Resources::flatten(
 {
   Resources flattened;
 
-  foreach (Resource resource, resources) {
+  foreach (Resource resource, repeated()) {
     resource.set_role(role);
     if (reservation.isNone()) {
       resource.clear_reservation();
@@ -984,7 +1008,7 @@ Option<Value::Scalar> Resources::get(const string& name) const
   Value::Scalar total;
   bool found = false;
 
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     if (resource.name() == name &&
         resource.type() == Value::SCALAR) {
       total += resource.scalar();
@@ -1006,7 +1030,7 @@ Option<Value::Set> Resources::get(const string& name) const
   Value::Set total;
   bool found = false;
 
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     if (resource.name() == name &&
         resource.type() == Value::SET) {
       total += resource.set();
@@ -1028,7 +1052,7 @@ Option<Value::Ranges> Resources::get(const string& name) const
   Value::Ranges total;
   bool found = false;
 
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     if (resource.name() == name &&
         resource.type() == Value::RANGES) {
       total += resource.ranges();
@@ -1063,7 +1087,7 @@ Resources Resources::scalars() const
 set<string> Resources::names() const
 {
   set<string> result;
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     result.insert(resource.name());
   }
 
@@ -1074,7 +1098,7 @@ set<string> Resources::names() const
 map<string, Value_Type> Resources::types() const
 {
   map<string, Value_Type> result;
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     result[resource.name()] = resource.type();
   }
 
@@ -1141,9 +1165,41 @@ Option<Value::Ranges> Resources::ephemeral_ports() const
 // Private member functions.
 /////////////////////////////////////////////////
 
+const RepeatedPtrField<Resource>& Resources::repeated() const
+{
+  if (resources.get() != NULL) {
+    return *resources;
+  }
+
+  // A canonical empty field shared by all Resources objects that
+  // have never held any resources.
+  // NOTE: This is intentionally leaked to sidestep destruction order
+  // issues during shutdown.
+  static const RepeatedPtrField<Resource>* empty =
+    new RepeatedPtrField<Resource>();
+
+  return *empty;
+}
+
+
+RepeatedPtrField<Resource>& Resources::unshared()
+{
+  if (resources.get() == NULL) {
+    resources.reset(new RepeatedPtrField<Resource>());
+  } else if (!resources.unique()) {
+    // The underlying resources are shared with at least one other
+    // Resources object, so we need a private copy before mutating
+    // (copy-on-write).
+    resources.reset(new RepeatedPtrField<Resource>(*resources));
+  }
+
+  return *resources;
+}
+
+
 bool Resources::_contains(const Resource& that) const
 {
-  foreach (const Resource& resource, resources) {
+  foreach (const Resource& resource, repeated()) {
     if (internal::contains(resource, that)) {
       return true;
     }
@@ -1198,7 +1254,7 @@ Option<Resources> Resources::find(const Resource& target) const
 
 Resources::operator const RepeatedPtrField<Resource>&() const
 {
-  return resources;
+  return repeated();
 }
 
 
@@ -1230,32 +1286,46 @@ Resources Resources::operator+(const Resources& that) const
 }
 
 
-Resources& Resources::operator+=(const Resource& that)
+void Resources::add(const Resource& that)
 {
-  if (validate(that).isNone() && !isEmpty(that)) {
-    bool found = false;
-    foreach (Resource& resource, resources) {
-      if (internal::addable(resource, that)) {
-        resource += that;
-        found = true;
-        break;
-      }
-    }
+  if (isEmpty(that)) {
+    return;
+  }
+
+  RepeatedPtrField<Resource>& resources_ = unshared();
 
-    // Cannot be combined with any existing Resource object.
-    if (!found) {
-      resources.Add()->CopyFrom(that);
+  bool found = false;
+  foreach (Resource& resource, resources_) {
+    if (internal::addable(resource, that)) {
+      resource += that;
+      found = true;
+      break;
     }
   }
 
+  // Cannot be combined with any existing Resource object.
+  if (!found) {
+    resources_.Add()->CopyFrom(that);
+  }
+}
+
+
+Resources& Resources::operator+=(const Resource& that)
+{
+  if (validate(that).isNone()) {
+    add(that);
+  }
+
   return *this;
 }
 
 
 Resources& Resources::operator+=(const Resources& that)
 {
-  foreach (const Resource& resource, that.resources) {
-    *this += resource;
+  // NOTE: We use 'add' because resources within a Resources object
+  // are always valid, hence validating them again is wasted work.
+  foreach (const Resource& resource, that.repeated()) {
+    add(resource);
   }
 
   return *this;
@@ -1278,26 +1348,38 @@ Resources Resources::operator-(const Resources& that) const
 }
 
 
-Resources& Resources::operator-=(const Resource& that)
+void Resources::subtract(const Resource& that)
 {
-  if (validate(that).isNone() && !isEmpty(that)) {
-    for (int i = 0; i < resources.size(); i++) {
-      Resource* resource = resources.Mutable(i);
+  if (isEmpty(that)) {
+    return;
+  }
 
-      if (internal::subtractable(*resource, that)) {
-        *resource -= that;
+  RepeatedPtrField<Resource>& resources_ = unshared();
 
-        // Remove the resource if it becomes invalid or zero. We need
-        // to do the validation because we want to strip negative
-        // scalar Resource object.
-        if (validate(*resource).isSome() || isEmpty(*resource)) {
-          resources.DeleteSubrange(i, 1);
-        }
+  for (int i = 0; i < resources_.size(); i++) {
+    Resource* resource = resources_.Mutable(i);
 
-        break;
+    if (internal::subtractable(*resource, that)) {
+      *resource -= that;
+
+      // Remove the resource if it becomes invalid or zero. We need
+      // to do the validation because we want to strip negative
+      // scalar Resource object.
+      if (validate(*resource).isSome() || isEmpty(*resource)) {
+        resources_.DeleteSubrange(i, 1);
       }
+
+      break;
     }
   }
+}
+
+
+Resources& Resources::operator-=(const Resource& that)
+{
+  if (validate(that).isNone()) {
+    subtract(that);
+  }
 
   return *this;
 }
@@ -1305,8 +1387,11 @@ Resources& Resources::operator-=(const Resource& that)
 
 Resources& Resources::operator-=(const Resources& that)
 {
-  foreach (const Resource& resource, that.resources) {
-    *this -= resource;
+  // NOTE: We use 'subtract' because resources within a Resources
+  // object are always valid, hence validating them again is wasted
+  // work.
+  foreach (const Resource& resource, that.repeated()) {
+    subtract(resource);
   }
 
   return *this;
@@ -49,27 +49,39 @@ Try<vector<string>> parse(const string& text)
 // \x0c is form feed (whitespace);
 // \x0d is carriage return (whitespace);
 // \x20 is space (whitespace);
-// \x2f is slash ('/');
 // \x7f is backspace (del);
-static const string INVALID_CHARACTERS = "\x09\x0a\x0b\x0c\x0d\x20\x2f\x7f";
+static const string INVALID_CHARACTERS = "\x09\x0a\x0b\x0c\x0d\x20\x7f";
 
 
 Option<Error> validate(const string& role)
 {
+  // Role names form a hierarchy of '/' separated components (e.g.
+  // "eng/data"), so we validate each component independently. Note
+  // that a leading, trailing or doubled slash produces an empty
+  // component, which is rejected below.
   if (role.empty()) {
     return Error("Empty role name is invalid.");
-  } else if (role == ".") {
-    return Error("Role name '.' is invalid.");
-  } else if (role == "..") {
-    return Error("Role name '..' is invalid.");
-  } else if (strings::startsWith(role, "-")) {
-    return Error("Role name '" + role + "' is invalid "
-                 "because it starts with a dash.");
   }
 
-  if (role.find_first_of(INVALID_CHARACTERS) != string::npos) {
-    return Error("Role name '" + role + "' is invalid "
-                 "because it contains slash, backspace or whitespace.");
+  foreach (const string& component, strings::split(role, "/")) {
+    if (component.empty()) {
+      return Error("Role name '" + role + "' is invalid "
+                   "because it contains an empty component.");
+    } else if (component == ".") {
+      return Error("Role name '" + role + "' is invalid "
+                   "because it contains the component '.'.");
+    } else if (component == "..") {
+      return Error("Role name '" + role + "' is invalid "
+                   "because it contains the component '..'.");
+    } else if (strings::startsWith(component, "-")) {
+      return Error("Role name '" + role + "' is invalid "
+                   "because a component starts with a dash.");
+    }
+
+    if (component.find_first_of(INVALID_CHARACTERS) != string::npos) {
+      return Error("Role name '" + role + "' is invalid "
+                   "because it contains backspace or whitespace.");
+    }
   }
 
   return None();
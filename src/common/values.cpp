@@ -32,6 +32,7 @@
 
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/interval.hpp>
 #include <stout/strings.hpp>
 
 using std::max;
@@ -233,46 +234,38 @@ void coalesce(Value::Ranges* result, const Value::Range& addedRange)
 }
 
 
-// Removes a range from already coalesced ranges.
-// The algorithms constructs a new vector of ranges which is then
-// coalesced into a Value::Ranges instance.
-static void remove(Value::Ranges* _ranges, const Value::Range& removal)
+// Converts the given ranges to an interval set. The interval set
+// coalesces implicitly on insertion and provides logarithmic
+// arithmetic, which keeps ports arithmetic cheap even when the
+// ranges are fragmented across many tasks.
+static IntervalSet<uint64_t> toIntervalSet(const Value::Ranges& ranges)
 {
-  vector<internal::Range> ranges;
-  ranges.reserve(_ranges->range_size());
+  IntervalSet<uint64_t> set;
 
-  foreach (const Value::Range& range, _ranges->range()) {
-    // Skip if the entire range is subsumed by `removal`.
-    if (range.begin() >= removal.begin() && range.end() <= removal.end()) {
-      continue;
-    }
+  foreach (const Value::Range& range, ranges.range()) {
+    set += (Bound<uint64_t>::closed(range.begin()),
+            Bound<uint64_t>::closed(range.end()));
+  }
 
-    // Divide if the range subsumes the `removal`.
-    if (range.begin() < removal.begin() && range.end() > removal.end()) {
-      // Front.
-      ranges.emplace_back(internal::Range{range.begin(), removal.begin() - 1});
-      // Back.
-      ranges.emplace_back(internal::Range{removal.end() + 1, range.end()});
-    }
+  return set;
+}
 
-    // Fully Emplace if the range doesn't intersect.
-    if (range.end() < removal.begin() || range.begin() > removal.end()) {
-      ranges.emplace_back(internal::Range{range.begin(), range.end()});
-    } else {
-      // Trim if the range does intersect.
-      if (range.end() > removal.end()) {
-        // Trim front.
-        ranges.emplace_back(internal::Range{removal.end() + 1, range.end()});
-      } else {
-        // Trim back.
-        CHECK(range.begin() < removal.begin());
-        ranges.emplace_back(
-            internal::Range{range.begin(), removal.begin() - 1});
-      }
-    }
+
+// Converts the given interval set back to ranges. Note that the
+// returned ranges are coalesced and sorted as a result of the
+// conversion.
+static Value::Ranges toRanges(const IntervalSet<uint64_t>& set)
+{
+  Value::Ranges ranges;
+  ranges.mutable_range()->Reserve(static_cast<int>(set.intervalCount()));
+
+  foreach (const Interval<uint64_t>& interval, set) {
+    Value::Range* range = ranges.add_range();
+    range->set_begin(interval.lower());
+    range->set_end(interval.upper() - 1);
   }
 
-  internal::coalesce(_ranges, std::move(ranges));
+  return ranges;
 }
 
 
@@ -290,94 +283,44 @@ ostream& operator<<(ostream& stream, const Value::Ranges& ranges)
 }
 
 
-bool operator==(const Value::Ranges& _left, const Value::Ranges& _right)
+bool operator==(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges left;
-  coalesce(&left, {_left});
-
-  Value::Ranges right;
-  coalesce(&right, {_right});
-
-  if (left.range_size() == right.range_size()) {
-    for (int i = 0; i < left.range_size(); i++) {
-      // Make sure this range is equal to a range in the right.
-      bool found = false;
-      for (int j = 0; j < right.range_size(); j++) {
-        if (left.range(i).begin() == right.range(j).begin() &&
-            left.range(i).end() == right.range(j).end()) {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found) {
-        return false;
-      }
-    }
-
-    return true;
-  }
-
-  return false;
+  return toIntervalSet(left) == toIntervalSet(right);
 }
 
 
-bool operator<=(const Value::Ranges& _left, const Value::Ranges& _right)
+bool operator<=(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges left;
-  coalesce(&left, {_left});
-
-  Value::Ranges right;
-  coalesce(&right, {_right});
-
-  for (int i = 0; i < left.range_size(); i++) {
-    // Make sure this range is a subset of a range in right.
-    bool matched = false;
-    for (int j = 0; j < right.range_size(); j++) {
-      if (left.range(i).begin() >= right.range(j).begin() &&
-          left.range(i).end() <= right.range(j).end()) {
-        matched = true;
-        break;
-      }
-    }
-    if (!matched) {
-      return false;
-    }
-  }
-
-  return true;
+  return toIntervalSet(right).contains(toIntervalSet(left));
 }
 
 
 Value::Ranges operator+(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges result;
-  coalesce(&result, {left, right});
-  return result;
+  IntervalSet<uint64_t> set = toIntervalSet(left);
+  set += toIntervalSet(right);
+  return toRanges(set);
 }
 
 
 Value::Ranges operator-(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges result;
-  coalesce(&result, {left});
-  return result -= right;
+  IntervalSet<uint64_t> set = toIntervalSet(left);
+  set -= toIntervalSet(right);
+  return toRanges(set);
 }
 
 
 Value::Ranges& operator+=(Value::Ranges& left, const Value::Ranges& right)
 {
-  coalesce(&left, {right});
+  left = left + right;
   return left;
 }
 
 
 Value::Ranges& operator-=(Value::Ranges& left, const Value::Ranges& right)
 {
-  coalesce(&left);
-  for (int i = 0; i < right.range_size(); ++i) {
-    remove(&left, right.range(i));
-  }
+  left = left - right;
   return left;
 }
 
@@ -14,6 +14,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
 #include <map>
 #include <vector>
 
@@ -26,7 +31,9 @@
 
 #include <process/check.hpp>
 #include <process/collect.hpp>
+#include <process/http.hpp>
 #include <process/io.hpp>
+#include <process/network.hpp>
 
 #include "common/status_utils.hpp"
 
@@ -136,6 +143,69 @@ void commandDiscarded(const Subprocess& s, const string& cmd)
 }
 
 
+Future<http::Response> Docker::request(const string& endpoint) const
+{
+  const string socketPath =
+    strings::remove(socket, "unix://", strings::Mode::PREFIX);
+
+  Try<int> sock = network::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock.isError()) {
+    return Failure("Failed to create socket: " + sock.error());
+  }
+
+  int fd = sock.get();
+
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    os::close(fd);
+    return Failure("Docker socket path '" + socketPath + "' is too long");
+  }
+
+  strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+  // NOTE: Connecting to a local unix socket either succeeds or fails
+  // immediately, so we connect before making the file descriptor
+  // non-blocking for the asynchronous reads and writes below.
+  if (::connect(fd, (struct sockaddr*) &address, sizeof(address)) < 0) {
+    ErrnoError error;
+    os::close(fd);
+    return Failure("Failed to connect to '" + socketPath + "': " +
+                   error.message);
+  }
+
+  Try<Nothing> nonblock = os::nonblock(fd);
+  if (nonblock.isError()) {
+    os::close(fd);
+    return Failure("Failed to make socket non-blocking: " + nonblock.error());
+  }
+
+  // We ask the daemon to close the connection once the response
+  // completes, so that reading the socket to EOF always yields
+  // exactly one complete response.
+  const string request =
+    "GET " + endpoint + " HTTP/1.1\r\n"
+    "Host: docker\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+  return io::write(fd, request)
+    .then([fd]() { return io::read(fd); })
+    .then([](const string& data) -> Future<http::Response> {
+      Try<vector<http::Response>> responses = http::decodeResponses(data);
+
+      if (responses.isError()) {
+        return Failure("Failed to decode response: " + responses.error());
+      }
+
+      return responses.get().front();
+    })
+    .onAny([fd]() { os::close(fd); });
+}
+
+
 Future<Version> Docker::version() const
 {
   string cmd = path + " -H " + socket + " --version";
@@ -743,15 +813,18 @@ Future<Docker::Container> Docker::inspect(
 {
   Owned<Promise<Docker::Container>> promise(new Promise<Docker::Container>());
 
-  const string cmd =  path + " -H " + socket + " inspect " + containerName;
-  _inspect(cmd, promise, retryInterval);
+  // This is the remote API endpoint backing 'docker inspect'.
+  const string endpoint = "/containers/" + containerName + "/json";
+
+  _inspect(*this, endpoint, promise, retryInterval);
 
   return promise->future();
 }
 
 
 void Docker::_inspect(
-    const string& cmd,
+    const Docker& docker,
+    const string& endpoint,
     const Owned<Promise<Docker::Container>>& promise,
     const Option<Duration>& retryInterval)
 {
@@ -760,101 +833,59 @@ void Docker::_inspect(
     return;
   }
 
-  VLOG(1) << "Running " << cmd;
+  VLOG(1) << "Getting " << endpoint;
 
-  Try<Subprocess> s = subprocess(
-      cmd,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE(),
-      Subprocess::PIPE());
-
-  if (s.isError()) {
-    promise->fail(s.error());
-    return;
-  }
-
-  // Start reading from stdout so writing to the pipe won't block
-  // to handle cases where the output is larger than the pipe
-  // capacity.
-  const Future<string> output = io::read(s.get().out().get());
-
-  s.get().status()
-    .onAny([=]() { __inspect(cmd, promise, retryInterval, output, s.get()); });
+  docker.request(endpoint)
+    .onAny([=](const Future<http::Response>& response) {
+      __inspect(docker, endpoint, promise, retryInterval, response);
+    });
 }
 
 
 void Docker::__inspect(
-    const string& cmd,
+    const Docker& docker,
+    const string& endpoint,
     const Owned<Promise<Docker::Container>>& promise,
     const Option<Duration>& retryInterval,
-    Future<string> output,
-    const Subprocess& s)
+    const Future<http::Response>& response)
 {
   if (promise->future().hasDiscard()) {
     promise->discard();
-    output.discard();
     return;
   }
 
-  // Check the exit status of 'docker inspect'.
-  CHECK_READY(s.status());
-
-  Option<int> status = s.status().get();
-
-  if (!status.isSome()) {
-    promise->fail("No status found from '" + cmd + "'");
-  } else if (status.get() != 0) {
-    output.discard();
-
+  // Retry on failures and error responses (e.g., the container has
+  // not been created yet) if an interval is given. This mirrors the
+  // retry on a non-zero exit status of 'docker inspect'.
+  if (!response.isReady() || response.get().code != http::Status::OK) {
     if (retryInterval.isSome()) {
-      VLOG(1) << "Retrying inspect with non-zero status code. cmd: '"
-              << cmd << "', interval: " << stringify(retryInterval.get());
-      Clock::timer(retryInterval.get(),
-                   [=]() { _inspect(cmd, promise, retryInterval); } );
+      VLOG(1) << "Retrying inspect since '" << endpoint << "' "
+              << (response.isReady()
+                    ? "returned '" + response.get().status + "'"
+                    : "failed")
+              << ", interval: " << stringify(retryInterval.get());
+      Clock::timer(retryInterval.get(), [=]() {
+        _inspect(docker, endpoint, promise, retryInterval);
+      });
       return;
     }
 
-    CHECK_SOME(s.err());
-    io::read(s.err().get())
-      .then(lambda::bind(
-                failure<Nothing>,
-                cmd,
-                status.get(),
-                lambda::_1))
-      .onAny([=](const Future<Nothing>& future) {
-          CHECK_FAILED(future);
-          promise->fail(future.failure());
-      });
-    return;
-  }
-
-  // Read to EOF.
-  CHECK_SOME(s.out());
-  output
-    .onAny([=](const Future<string>& output) {
-      ___inspect(cmd, promise, retryInterval, output);
-    });
-}
-
-
-void Docker::___inspect(
-    const string& cmd,
-    const Owned<Promise<Docker::Container>>& promise,
-    const Option<Duration>& retryInterval,
-    const Future<string>& output)
-{
-  if (promise->future().hasDiscard()) {
-    promise->discard();
-    return;
-  }
-
-  if (!output.isReady()) {
-    promise->fail(output.isFailed() ? output.failure() : "future discarded");
+    if (!response.isReady()) {
+      promise->fail(
+          "Failed to get '" + endpoint + "': " +
+          (response.isFailed() ? response.failure() : "future discarded"));
+    } else {
+      promise->fail(
+          "Failed to get '" + endpoint + "': " + response.get().status);
+    }
     return;
   }
 
+  // NOTE: The CLI wraps the inspect output in an array. We do the
+  // same with the remote API response so that the 'output' field of
+  // the container keeps its format.
   Try<Docker::Container> container = Docker::Container::create(
-      output.get());
+      "[" + response.get().body + "]");
 
   if (container.isError()) {
     promise->fail("Unable to create container: " + container.error());
@@ -862,10 +893,11 @@ void Docker::___inspect(
   }
 
   if (retryInterval.isSome() && !container.get().started) {
-    VLOG(1) << "Retrying inspect since container not yet started. cmd: '"
-            << cmd << "', interval: " << stringify(retryInterval.get());
-    Clock::timer(retryInterval.get(),
-                 [=]() { _inspect(cmd, promise, retryInterval); } );
+    VLOG(1) << "Retrying inspect since container not yet started. endpoint: '"
+            << endpoint << "', interval: " << stringify(retryInterval.get());
+    Clock::timer(retryInterval.get(), [=]() {
+      _inspect(docker, endpoint, promise, retryInterval);
+    });
     return;
   }
 
@@ -877,78 +909,73 @@ Future<list<Docker::Container>> Docker::ps(
     bool all,
     const Option<string>& prefix) const
 {
-  string cmd = path + " -H " + socket + (all ? " ps -a" : " ps");
+  // This is the remote API endpoint backing 'docker ps'.
+  const string endpoint =
+    all ? "/containers/json?all=1" : "/containers/json";
 
-  VLOG(1) << "Running " << cmd;
-
-  Try<Subprocess> s = subprocess(
-      cmd,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE(),
-      Subprocess::PIPE());
-
-  if (s.isError()) {
-    return Failure(s.error());
-  }
-
-  // Start reading from stdout so writing to the pipe won't block
-  // to handle cases where the output is larger than the pipe
-  // capacity.
-  const Future<string>& output = io::read(s.get().out().get());
+  VLOG(1) << "Getting " << endpoint;
 
-  return s.get().status()
-    .then(lambda::bind(&Docker::_ps, *this, cmd, s.get(), prefix, output));
+  return request(endpoint)
+    .then(lambda::bind(&Docker::_ps, *this, endpoint, prefix, lambda::_1));
 }
 
 
 Future<list<Docker::Container>> Docker::_ps(
     const Docker& docker,
-    const string& cmd,
-    const Subprocess& s,
+    const string& endpoint,
     const Option<string>& prefix,
-    Future<string> output)
+    const http::Response& response)
 {
-  Option<int> status = s.status().get();
+  if (response.code != http::Status::OK) {
+    return Failure("Failed to get '" + endpoint + "': " + response.status);
+  }
 
-  if (!status.isSome()) {
-    output.discard();
-    return Failure("No status found from '" + cmd + "'");
-  } else if (status.get() != 0) {
-    output.discard();
-    CHECK_SOME(s.err());
-    return io::read(s.err().get())
-      .then(lambda::bind(
-                failure<list<Docker::Container>>,
-                cmd,
-                status.get(),
-                lambda::_1));
+  Try<JSON::Array> parse = JSON::parse<JSON::Array>(response.body);
+  if (parse.isError()) {
+    return Failure("Failed to parse JSON: " + parse.error());
   }
 
-  // Read to EOF.
-  return output.then(lambda::bind(&Docker::__ps, docker, prefix, lambda::_1));
-}
+  Owned<vector<string>> names(new vector<string>());
 
+  foreach (const JSON::Value& value, parse.get().values) {
+    if (!value.is<JSON::Object>()) {
+      return Failure("Container JSON value expected to be JSON::Object");
+    }
 
-Future<list<Docker::Container>> Docker::__ps(
-    const Docker& docker,
-    const Option<string>& prefix,
-    const string& output)
-{
-  Owned<vector<string>> lines(new vector<string>());
-  *lines = strings::tokenize(output, "\n");
+    Result<JSON::Array> namesValue =
+      value.as<JSON::Object>().find<JSON::Array>("Names");
+
+    if (namesValue.isError()) {
+      return Failure("Error finding Names in container: " +
+                     namesValue.error());
+    } else if (namesValue.isNone()) {
+      return Failure("Unable to find Names in container");
+    }
 
-  // Skip the header.
-  CHECK(!lines->empty());
-  lines->erase(lines->begin());
+    foreach (const JSON::Value& nameValue, namesValue.get().values) {
+      if (!nameValue.is<JSON::String>()) {
+        return Failure("Name JSON value expected to be JSON::String");
+      }
+
+      const string name = strings::remove(
+          nameValue.as<JSON::String>().value, "/", strings::Mode::PREFIX);
+
+      // Skip link aliases ('other/alias'); only the primary name
+      // identifies the container.
+      if (!strings::contains(name, "/")) {
+        names->push_back(name);
+      }
+    }
+  }
 
   Owned<list<Docker::Container>> containers(new list<Docker::Container>());
 
   Owned<Promise<list<Docker::Container>>> promise(
     new Promise<list<Docker::Container>>());
 
-  // Limit number of parallel calls to docker inspect at once to prevent
+  // Limit number of parallel calls to inspect at once to prevent
   // reaching system's open file descriptor limit.
-  inspectBatches(containers, lines, promise, docker, prefix);
+  inspectBatches(containers, names, promise, docker, prefix);
 
   return promise->future();
 }
@@ -957,24 +984,24 @@ Future<list<Docker::Container>> Docker::__ps(
 // within libprocess.
 void Docker::inspectBatches(
     Owned<list<Docker::Container>> containers,
-    Owned<vector<string>> lines,
+    Owned<vector<string>> names,
     Owned<Promise<list<Docker::Container>>> promise,
     const Docker& docker,
     const Option<string>& prefix)
 {
   list<Future<Docker::Container>> batch =
-    createInspectBatch(lines, docker, prefix);
+    createInspectBatch(names, docker, prefix);
 
   collect(batch).onAny([=](const Future<list<Docker::Container>>& c) {
     if (c.isReady()) {
       foreach (const Docker::Container& container, c.get()) {
         containers->push_back(container);
       }
-      if (lines->empty()) {
+      if (names->empty()) {
         promise->set(*containers);
       }
       else {
-        inspectBatches(containers, lines, promise, docker, prefix);
+        inspectBatches(containers, names, promise, docker, prefix);
       }
     } else {
       if (c.isFailed()) {
@@ -989,22 +1016,18 @@ void Docker::inspectBatches(
 
 
 list<Future<Docker::Container>> Docker::createInspectBatch(
-    Owned<vector<string>> lines,
+    Owned<vector<string>> names,
     const Docker& docker,
     const Option<string>& prefix)
 {
   list<Future<Docker::Container>> batch;
 
-  while (!lines->empty() && batch.size() < DOCKER_PS_MAX_INSPECT_CALLS) {
-    string line = lines->back();
-    lines->pop_back();
+  while (!names->empty() && batch.size() < DOCKER_PS_MAX_INSPECT_CALLS) {
+    string name = names->back();
+    names->pop_back();
 
     // Inspect the containers that we are interested in depending on
     // whether or not a 'prefix' was specified.
-    vector<string> columns = strings::split(strings::trim(line), " ");
-
-    // We expect the name column to be the last column from ps.
-    string name = columns[columns.size() - 1];
     if (prefix.isNone() || strings::startsWith(name, prefix.get())) {
       batch.push_back(docker.inspect(name));
     }
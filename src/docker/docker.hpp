@@ -22,6 +22,7 @@
 #include <string>
 
 #include <process/future.hpp>
+#include <process/http.hpp>
 #include <process/owned.hpp>
 #include <process/subprocess.hpp>
 
@@ -142,14 +143,16 @@ public:
       const std::string& containerName,
       bool force = false) const;
 
-  // Performs 'docker inspect CONTAINER'. If retryInterval is set,
-  // we will keep retrying inspect until the container is started or
-  // the future is discarded.
+  // Performs the equivalent of 'docker inspect CONTAINER' via the
+  // Docker remote API. If retryInterval is set, we will keep
+  // retrying inspect until the container is started or the future
+  // is discarded.
   virtual process::Future<Container> inspect(
       const std::string& containerName,
       const Option<Duration>& retryInterval = None()) const;
 
-  // Performs 'docker ps (-a)'.
+  // Performs the equivalent of 'docker ps (-a)' via the Docker
+  // remote API.
   virtual process::Future<std::list<Container>> ps(
       bool all = false,
       const Option<std::string>& prefix = None()) const;
@@ -191,45 +194,40 @@ private:
       const process::Subprocess& s,
       bool remove);
 
+  // Issues an HTTP GET request for the given endpoint of the remote
+  // API to the Docker daemon over its unix socket. This avoids
+  // forking the Docker CLI for queries on the container hot path.
+  process::Future<process::http::Response> request(
+      const std::string& endpoint) const;
+
   static void _inspect(
-      const std::string& cmd,
+      const Docker& docker,
+      const std::string& endpoint,
       const process::Owned<process::Promise<Container>>& promise,
       const Option<Duration>& retryInterval);
 
   static void __inspect(
-      const std::string& cmd,
-      const process::Owned<process::Promise<Container>>& promise,
-      const Option<Duration>& retryInterval,
-      process::Future<std::string> output,
-      const process::Subprocess& s);
-
-  static void ___inspect(
-      const std::string& cmd,
+      const Docker& docker,
+      const std::string& endpoint,
       const process::Owned<process::Promise<Container>>& promise,
       const Option<Duration>& retryInterval,
-      const process::Future<std::string>& output);
+      const process::Future<process::http::Response>& response);
 
   static process::Future<std::list<Container>> _ps(
       const Docker& docker,
-      const std::string& cmd,
-      const process::Subprocess& s,
+      const std::string& endpoint,
       const Option<std::string>& prefix,
-      process::Future<std::string> output);
-
-  static process::Future<std::list<Container>> __ps(
-      const Docker& docker,
-      const Option<std::string>& prefix,
-      const std::string& output);
+      const process::http::Response& response);
 
   static void inspectBatches(
       process::Owned<std::list<Docker::Container>> containers,
-      process::Owned<std::vector<std::string>> lines,
+      process::Owned<std::vector<std::string>> names,
       process::Owned<process::Promise<std::list<Docker::Container>>> promise,
       const Docker& docker,
       const Option<std::string>& prefix);
 
   static std::list<process::Future<Docker::Container>> createInspectBatch(
-      process::Owned<std::vector<std::string>> lines,
+      process::Owned<std::vector<std::string>> names,
       const Docker& docker,
       const Option<std::string>& prefix);
 
@@ -36,6 +36,8 @@
 #include "docker/docker.hpp"
 #include "docker/executor.hpp"
 
+#include "health-check/health_checker.hpp"
+
 #include "logging/flags.hpp"
 #include "logging/logging.hpp"
 
@@ -72,12 +74,9 @@ public:
       const string& containerName,
       const string& sandboxDirectory,
       const string& mappedDirectory,
-      const Duration& stopTimeout,
-      const string& healthCheckDir)
+      const Duration& stopTimeout)
     : killed(false),
       killedByHealthCheck(false),
-      healthPid(-1),
-      healthCheckDir(healthCheckDir),
       docker(docker),
       containerName(containerName),
       sandboxDirectory(sandboxDirectory),
@@ -194,9 +193,9 @@ public:
   {
     cout << "Killing docker task" << endl;
     shutdown(driver);
-    if (healthPid != -1) {
-      // Cleanup health check process.
-      os::killtree(healthPid, SIGKILL);
+    if (checker.get() != NULL) {
+      // Stop health checking the task.
+      checker->stop();
     }
   }
 
@@ -366,46 +365,31 @@ private:
           return;
       }
 
-      JSON::Object json = JSON::protobuf(healthCheck);
-
-      // Launch the subprocess using 'exec' style so that quotes can
-      // be properly handled.
-      vector<string> argv;
-      string path = path::join(healthCheckDir, "mesos-health-check");
-      argv.push_back(path);
-      argv.push_back("--executor=" + stringify(self()));
-      argv.push_back("--health_check_json=" + stringify(json));
-      argv.push_back("--task_id=" + task.task_id().value());
-
-      string cmd = strings::join(" ", argv);
-      cout << "Launching health check process: " << cmd << endl;
-
-      Try<Subprocess> healthProcess =
-        process::subprocess(
-          path,
-          argv,
-          // Intentionally not sending STDIN to avoid health check
-          // commands that expect STDIN input to block.
-          Subprocess::PATH("/dev/null"),
-          Subprocess::FD(STDOUT_FILENO),
-          Subprocess::FD(STDERR_FILENO));
-
-      if (healthProcess.isError()) {
-        cerr << "Unable to launch health process: "
-             << healthProcess.error() << endl;
+      // Run the health checks in-process; the checker reports
+      // results back to us via 'TaskHealthStatus' messages.
+      Try<Owned<health::HealthChecker>> _checker =
+        health::HealthChecker::create(
+            healthCheck,
+            self(),
+            task.task_id());
+
+      if (_checker.isError()) {
+        cerr << "Unable to launch health checker: "
+             << _checker.error() << endl;
       } else {
-        healthPid = healthProcess.get().pid();
+        checker = _checker.get();
+
+        cout << "Health checking task " << task.task_id().value() << endl;
 
-        cout << "Health check process launched at pid: "
-             << stringify(healthPid) << endl;
+        // NOTE: Task kills triggered by failed health checks arrive
+        // via 'TaskHealthStatus', so the returned future is ignored.
+        checker->healthCheck();
       }
     }
   }
 
   bool killed;
   bool killedByHealthCheck;
-  pid_t healthPid;
-  string healthCheckDir;
   Owned<Docker> docker;
   string containerName;
   string sandboxDirectory;
@@ -415,6 +399,7 @@ private:
   Future<Nothing> stop;
   Future<Nothing> inspect;
   Option<ExecutorDriver*> driver;
+  Owned<health::HealthChecker> checker;
 };
 
 
@@ -426,16 +411,14 @@ public:
       const string& container,
       const string& sandboxDirectory,
       const string& mappedDirectory,
-      const Duration& stopTimeout,
-      const string& healthCheckDir)
+      const Duration& stopTimeout)
   {
     process = Owned<DockerExecutorProcess>(new DockerExecutorProcess(
         docker,
         container,
         sandboxDirectory,
         mappedDirectory,
-        stopTimeout,
-        healthCheckDir));
+        stopTimeout));
 
     spawn(process.get());
   }
@@ -563,11 +546,6 @@ int main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
-  if (flags.launcher_dir.isNone()) {
-    cerr << flags.usage("Missing required option --launcher_dir") << endl;
-    return EXIT_FAILURE;
-  }
-
   // The 2nd argument for docker create is set to false so we skip
   // validation when creating a docker abstraction, as the slave
   // should have already validated docker.
@@ -586,8 +564,7 @@ int main(int argc, char** argv)
       flags.container.get(),
       flags.sandbox_directory.get(),
       flags.mapped_directory.get(),
-      flags.stop_timeout.get(),
-      flags.launcher_dir.get());
+      flags.stop_timeout.get());
 
   mesos::MesosExecutorDriver driver(&executor);
   return driver.run() == mesos::DRIVER_STOPPED ? EXIT_SUCCESS : EXIT_FAILURE;
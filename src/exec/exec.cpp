@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <signal.h>
+#include <stdlib.h>
 
 #include <sys/types.h>
 
@@ -22,6 +23,7 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include <mesos/executor.hpp>
 #include <mesos/mesos.hpp>
@@ -40,6 +42,8 @@
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/protobuf.hpp>
+#include <stout/result.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 #include <stout/synchronized.hpp>
@@ -112,6 +116,10 @@ public:
                   const string& _directory,
                   bool _checkpoint,
                   Duration _recoveryTimeout,
+                  const Option<Duration>& _batchingWindow,
+                  const Option<Duration>& _messageBatchingWindow,
+                  const Option<ExecutorRegisteredMessage>& _registration,
+                  const Option<string>& _registrationToken,
                   std::recursive_mutex* _mutex,
                   Latch* _latch)
     : ProcessBase(ID::generate("executor")),
@@ -123,13 +131,19 @@ public:
       executorId(_executorId),
       connected(false),
       connection(UUID::random()),
+      reconnection(UUID::random()),
       local(_local),
       aborted(false),
       mutex(_mutex),
       latch(_latch),
       directory(_directory),
       checkpoint(_checkpoint),
-      recoveryTimeout(_recoveryTimeout)
+      recoveryTimeout(_recoveryTimeout),
+      batchingWindow(_batchingWindow),
+      messageBatchingWindow(_messageBatchingWindow),
+      pendingMessagesSize(0),
+      registration(_registration),
+      registrationToken(_registrationToken)
   {
     LOG(INFO) << "Version: " << MESOS_VERSION;
 
@@ -141,6 +155,10 @@ public:
         &ExecutorRegisteredMessage::slave_id,
         &ExecutorRegisteredMessage::slave_info);
 
+    install<ExecutorLocallyRegisteredMessage>(
+        &ExecutorProcess::locallyRegistered,
+        &ExecutorLocallyRegisteredMessage::slave_id);
+
     install<ExecutorReregisteredMessage>(
         &ExecutorProcess::reregistered,
         &ExecutorReregisteredMessage::slave_id,
@@ -148,7 +166,8 @@ public:
 
     install<ReconnectExecutorMessage>(
         &ExecutorProcess::reconnect,
-        &ReconnectExecutorMessage::slave_id);
+        &ReconnectExecutorMessage::slave_id,
+        &ReconnectExecutorMessage::max_reregister_delay_seconds);
 
     install<RunTaskMessage>(
         &ExecutorProcess::runTask,
@@ -186,10 +205,15 @@ protected:
 
     link(slave);
 
-    // Register with slave.
+    // Register with slave. If we read the registration payload the
+    // slave wrote into our sandbox at launch, present the token so
+    // the slave can acknowledge with a slim message.
     RegisterExecutorMessage message;
     message.mutable_framework_id()->MergeFrom(frameworkId);
     message.mutable_executor_id()->MergeFrom(executorId);
+    if (registration.isSome() && registrationToken.isSome()) {
+      message.set_registration_token(registrationToken.get());
+    }
     send(slave, message);
   }
 
@@ -220,6 +244,21 @@ protected:
     VLOG(1) << "Executor::registered took " << stopwatch.elapsed();
   }
 
+  void locallyRegistered(const SlaveID& slaveId)
+  {
+    // NOTE: We only present the registration token when we have
+    // successfully read the registration payload from the sandbox,
+    // and the slave only sends this message when the token matched.
+    CHECK_SOME(registration);
+
+    registered(
+        registration.get().executor_info(),
+        registration.get().framework_id(),
+        registration.get().framework_info(),
+        slaveId,
+        registration.get().slave_info());
+  }
+
   void reregistered(const SlaveID& slaveId, const SlaveInfo& slaveInfo)
   {
     if (aborted.load()) {
@@ -243,7 +282,10 @@ protected:
     VLOG(1) << "Executor::reregistered took " << stopwatch.elapsed();
   }
 
-  void reconnect(const UPID& from, const SlaveID& slaveId)
+  void reconnect(
+      const UPID& from,
+      const SlaveID& slaveId,
+      double maxReregisterDelay)
   {
     if (aborted.load()) {
       VLOG(1) << "Ignoring reconnect message from slave " << slaveId
@@ -257,6 +299,43 @@ protected:
     slave = from;
     link(slave);
 
+    // Each reconnect request starts a new reregistration attempt,
+    // invalidating any reregistration still pending from a previous
+    // request (e.g., if the slave restarted again within the window).
+    reconnection = UUID::random();
+
+    // Reregister after a random delay within the window advertised
+    // by the slave (if any), so that the executors of a recovering
+    // agent spread their reregistrations instead of flooding the
+    // agent simultaneously.
+    Duration wait = Duration::zero();
+
+    if (maxReregisterDelay > 0.0) {
+      Try<Duration> duration = Duration::create(
+          maxReregisterDelay * (static_cast<double>(::random()) / RAND_MAX));
+
+      if (duration.isSome()) {
+        wait = duration.get();
+      }
+    }
+
+    if (wait > Duration::zero()) {
+      VLOG(1) << "Delaying reregistration with slave " << slaveId
+              << " by " << wait;
+
+      delay(wait, self(), &ExecutorProcess::_reconnect, reconnection);
+    } else {
+      _reconnect(reconnection);
+    }
+  }
+
+  void _reconnect(const UUID& _reconnection)
+  {
+    // Only reregister if this is still the latest reconnect request.
+    if (aborted.load() || reconnection != _reconnection) {
+      return;
+    }
+
     // Re-register with slave.
     ReregisterExecutorMessage message;
     message.mutable_executor_id()->MergeFrom(executorId);
@@ -404,6 +483,11 @@ protected:
 
   void stop()
   {
+    // Send out any updates and framework messages still awaiting
+    // their batching windows.
+    flushStatusUpdates();
+    flushFrameworkMessages();
+
     terminate(self());
 
     synchronized (mutex) {
@@ -493,37 +577,94 @@ protected:
 
   void sendStatusUpdate(const TaskStatus& status)
   {
-    StatusUpdateMessage message;
-    StatusUpdate* update = message.mutable_update();
-    update->mutable_framework_id()->MergeFrom(frameworkId);
-    update->mutable_executor_id()->MergeFrom(executorId);
-    update->mutable_slave_id()->MergeFrom(slaveId);
-    update->mutable_status()->MergeFrom(status);
-    update->set_timestamp(Clock::now().secs());
-    update->mutable_status()->set_timestamp(update->timestamp());
-    message.set_pid(self());
+    StatusUpdate update;
+    update.mutable_framework_id()->MergeFrom(frameworkId);
+    update.mutable_executor_id()->MergeFrom(executorId);
+    update.mutable_slave_id()->MergeFrom(slaveId);
+    update.mutable_status()->MergeFrom(status);
+    update.set_timestamp(Clock::now().secs());
+    update.mutable_status()->set_timestamp(update.timestamp());
 
     // We overwrite the UUID for this status update, however with
     // the HTTP API, the executor will have to generate a UUID
     // (which needs to be validated to be RFC-4122 compliant).
     UUID uuid = UUID::random();
-    update->set_uuid(uuid.toBytes());
-    update->mutable_status()->set_uuid(uuid.toBytes());
+    update.set_uuid(uuid.toBytes());
+    update.mutable_status()->set_uuid(uuid.toBytes());
 
     // We overwrite the SlaveID for this status update, however with
     // the HTTP API, this can be overwritten by the slave instead.
-    update->mutable_status()->mutable_slave_id()->CopyFrom(slaveId);
+    update.mutable_status()->mutable_slave_id()->CopyFrom(slaveId);
 
-    VLOG(1) << "Executor sending status update " << *update;
+    VLOG(1) << "Executor sending status update " << update;
 
     // Capture the status update.
-    updates[uuid] = *update;
+    updates[uuid] = update;
+
+    if (batchingWindow.isSome()) {
+      // Coalesce the update with any others produced within the
+      // batching window; the first pending update schedules the
+      // flush that sends them as a single message.
+      pending.push_back(update);
+
+      if (pending.size() == 1) {
+        delay(batchingWindow.get(), self(), &Self::flushStatusUpdates);
+      }
+
+      return;
+    }
+
+    StatusUpdateMessage message;
+    message.mutable_update()->CopyFrom(update);
+    message.set_pid(self());
+
+    send(slave, message);
+  }
+
+  void flushStatusUpdates()
+  {
+    if (pending.empty()) {
+      return;
+    }
+
+    VLOG(1) << "Executor sending a batch of " << pending.size()
+            << " status updates";
+
+    StatusUpdatesMessage message;
+
+    foreach (const StatusUpdate& update, pending) {
+      message.add_updates()->CopyFrom(update);
+    }
+
+    message.set_pid(self());
+
+    pending.clear();
 
     send(slave, message);
   }
 
   void sendFrameworkMessage(const string& data)
   {
+    if (messageBatchingWindow.isSome()) {
+      // Coalesce the message with any others produced within the
+      // batching window; the first pending message schedules the
+      // flush that sends them as a single message. A batch that
+      // grows past the size cap is flushed immediately so that the
+      // queue stays bounded under a message storm.
+      pendingMessages.push_back(data);
+      pendingMessagesSize += data.size();
+
+      if (pendingMessagesSize >= EXECUTOR_FRAMEWORK_MESSAGE_BATCH_BYTES) {
+        flushFrameworkMessages();
+      } else if (pendingMessages.size() == 1) {
+        delay(messageBatchingWindow.get(),
+              self(),
+              &Self::flushFrameworkMessages);
+      }
+
+      return;
+    }
+
     ExecutorToFrameworkMessage message;
     message.mutable_slave_id()->MergeFrom(slaveId);
     message.mutable_framework_id()->MergeFrom(frameworkId);
@@ -532,6 +673,30 @@ protected:
     send(slave, message);
   }
 
+  void flushFrameworkMessages()
+  {
+    if (pendingMessages.empty()) {
+      return;
+    }
+
+    VLOG(1) << "Executor sending a batch of " << pendingMessages.size()
+            << " framework messages";
+
+    ExecutorToFrameworkMessages message;
+    message.mutable_slave_id()->MergeFrom(slaveId);
+    message.mutable_framework_id()->MergeFrom(frameworkId);
+    message.mutable_executor_id()->MergeFrom(executorId);
+
+    foreach (const string& data, pendingMessages) {
+      message.add_data(data);
+    }
+
+    pendingMessages.clear();
+    pendingMessagesSize = 0;
+
+    send(slave, message);
+  }
+
 private:
   friend class mesos::MesosExecutorDriver;
 
@@ -543,6 +708,7 @@ private:
   ExecutorID executorId;
   bool connected; // Registered with the slave.
   UUID connection; // UUID to identify the connection instance.
+  UUID reconnection; // UUID to identify the latest reconnect request.
   bool local;
   std::atomic_bool aborted;
   std::recursive_mutex* mutex;
@@ -551,6 +717,29 @@ private:
   bool checkpoint;
   Duration recoveryTimeout;
 
+  // When set, status updates produced within this window are
+  // coalesced into a single 'StatusUpdatesMessage' rather than being
+  // sent to the slave one message at a time.
+  Option<Duration> batchingWindow;
+
+  // When set, framework messages produced within this window are
+  // coalesced into a single 'ExecutorToFrameworkMessages' rather
+  // than each traversing the slave and the master on its own.
+  Option<Duration> messageBatchingWindow;
+
+  size_t pendingMessagesSize; // Total bytes queued in 'pendingMessages'.
+
+  // The registration payload written into the sandbox by the slave
+  // at launch, and the token proving we have read it. When set, the
+  // slave acknowledges our registration with a slim message rather
+  // than re-sending these infos.
+  Option<ExecutorRegisteredMessage> registration;
+  Option<string> registrationToken;
+
+  std::vector<StatusUpdate> pending; // Updates awaiting a flush.
+
+  std::vector<string> pendingMessages; // Framework messages awaiting a flush.
+
   LinkedHashMap<UUID, StatusUpdate> updates; // Unacknowledged updates.
 
   // We store tasks that have not been acknowledged
@@ -703,6 +892,71 @@ Status MesosExecutorDriver::start()
       }
     }
 
+    // Get the status update batching window, if batching is enabled
+    // for this executor. When set, updates produced within the window
+    // are coalesced into a single message to the slave.
+    Option<Duration> batchingWindow;
+
+    value = os::getenv("MESOS_EXECUTOR_STATUS_UPDATE_BATCHING_WINDOW");
+
+    if (value.isSome()) {
+      Try<Duration> _batchingWindow = Duration::parse(value.get());
+
+      if (_batchingWindow.isError()) {
+        EXIT(EXIT_FAILURE)
+          << "Cannot parse MESOS_EXECUTOR_STATUS_UPDATE_BATCHING_WINDOW '"
+          << value.get() << "': " << _batchingWindow.error();
+      }
+
+      batchingWindow = _batchingWindow.get();
+    }
+
+    // Get the framework message batching window, if framework
+    // message coalescing is enabled for this executor. When set,
+    // messages produced within the window (up to a size cap) are
+    // coalesced into a single message to the slave.
+    Option<Duration> messageBatchingWindow;
+
+    value = os::getenv("MESOS_EXECUTOR_FRAMEWORK_MESSAGE_BATCHING_WINDOW");
+
+    if (value.isSome()) {
+      Try<Duration> _messageBatchingWindow = Duration::parse(value.get());
+
+      if (_messageBatchingWindow.isError()) {
+        EXIT(EXIT_FAILURE)
+          << "Cannot parse MESOS_EXECUTOR_FRAMEWORK_MESSAGE_BATCHING_WINDOW '"
+          << value.get() << "': " << _messageBatchingWindow.error();
+      }
+
+      messageBatchingWindow = _messageBatchingWindow.get();
+    }
+
+    // Read the registration payload the slave wrote into our sandbox
+    // at launch, if any. Presenting the accompanying token at
+    // registration lets the slave skip re-sending these infos. Any
+    // failure to read the payload simply falls back to the full
+    // registration exchange.
+    Option<ExecutorRegisteredMessage> registration;
+    Option<string> registrationToken;
+
+    value = os::getenv("MESOS_EXECUTOR_REGISTRATION");
+
+    if (value.isSome() &&
+        os::getenv("MESOS_EXECUTOR_REGISTRATION_TOKEN").isSome()) {
+      Result<ExecutorRegisteredMessage> _registration =
+        ::protobuf::read<ExecutorRegisteredMessage>(value.get());
+
+      if (_registration.isSome()) {
+        registration = _registration.get();
+        registrationToken = os::getenv("MESOS_EXECUTOR_REGISTRATION_TOKEN");
+      } else {
+        LOG(WARNING)
+          << "Failed to read the registration payload from '" << value.get()
+          << "': "
+          << (_registration.isError() ? _registration.error() : "empty file");
+      }
+    }
+
     CHECK(process == NULL);
 
     process = new ExecutorProcess(
@@ -716,6 +970,10 @@ Status MesosExecutorDriver::start()
         workDirectory,
         checkpoint,
         recoveryTimeout,
+        batchingWindow,
+        messageBatchingWindow,
+        registration,
+        registrationToken,
         &mutex,
         latch);
 
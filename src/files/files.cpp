@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <sys/stat.h>
@@ -21,19 +23,26 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/shared_array.hpp>
 
+#include <process/defer.hpp>
 #include <process/deferred.hpp> // TODO(benh): This is required by Clang.
+#include <process/delay.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/help.hpp>
 #include <process/http.hpp>
 #include <process/io.hpp>
 #include <process/mime.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
+#include <process/time.hpp>
 
+#include <stout/check.hpp>
+#include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/json.hpp>
@@ -48,6 +57,8 @@
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 
+#include "common/http.hpp"
+
 #include "files/files.hpp"
 
 #include "logging/logging.hpp"
@@ -63,7 +74,10 @@ using process::wait; // Necessary on some OS's to disambiguate.
 using process::http::BadRequest;
 using process::http::InternalServerError;
 using process::http::NotFound;
+using process::http::NotModified;
 using process::http::OK;
+using process::http::PartialContent;
+using process::http::RequestedRangeNotSatisfiable;
 using process::http::Response;
 using process::http::Request;
 
@@ -75,6 +89,93 @@ using std::vector;
 namespace mesos {
 namespace internal {
 
+// How often the 'follow' mode of the read endpoint checks a file for
+// appended data once it has caught up with the end of the file.
+static const Duration FILES_FOLLOW_INTERVAL = Milliseconds(500);
+
+// Maximum number of streamed but not yet transmitted bytes that the
+// 'follow' mode buffers per connection before it stops reading the
+// file, so that a client reading slower than the file grows does not
+// buffer without bound.
+static const size_t FILES_FOLLOW_MAX_OUTSTANDING = 4 * 1024 * 1024;
+
+// Upper bound on the 'poll' parameter of the read endpoint, so that
+// long-poll requests do not pin connections indefinitely.
+static const Duration FILES_POLL_MAX = Minutes(1);
+
+// Maximum number of bytes a single ranged download serves. A longer
+// range is answered with a shorter '206 Partial Content' (permitted
+// by RFC 7233) and the client continues from where it left off, so
+// that a range request never buffers unbounded amounts of file data.
+static const size_t FILES_RANGE_MAX_LENGTH = 4 * 1024 * 1024;
+
+
+// Formats a time for the 'Last-Modified' header (RFC 1123).
+static string rfc1123(time_t time)
+{
+  Try<Time> time_ = Time::create(static_cast<double>(time));
+
+  CHECK_SOME(time_);
+
+  return stringify(RFC1123(time_.get()));
+}
+
+
+// Parses an HTTP date, e.g., from an 'If-Modified-Since' header.
+// Only the RFC 1123 format is supported, which is what we emit in
+// 'Last-Modified' and what every modern client sends.
+static Option<time_t> parseHttpDate(const string& value)
+{
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm));
+
+  if (strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm) == NULL) {
+    return None();
+  }
+
+  return timegm(&tm);
+}
+
+
+// Parses a 'Range' header of the form 'bytes=START-[END]'. Returns
+// None for ranges we do not support (suffix ranges and multiple
+// ranges), in which case the caller serves the entire file, as
+// permitted by RFC 7233.
+static Option<std::pair<off_t, Option<off_t>>> parseRange(const string& value)
+{
+  if (!strings::startsWith(value, "bytes=")) {
+    return None();
+  }
+
+  vector<string> tokens = strings::split(
+      value.substr(strlen("bytes=")), "-");
+
+  if (tokens.size() != 2 || tokens[0].empty()) {
+    return None();
+  }
+
+  Try<off_t> start = numify<off_t>(tokens[0]);
+
+  if (start.isError()) {
+    return None();
+  }
+
+  Option<off_t> end = None();
+
+  if (!tokens[1].empty()) {
+    Try<off_t> end_ = numify<off_t>(tokens[1]);
+
+    if (end_.isError() || end_.get() < start.get()) {
+      return None();
+    }
+
+    end = end_.get();
+  }
+
+  return std::make_pair(start.get(), end);
+}
+
+
 class FilesProcess : public Process<FilesProcess>
 {
 public:
@@ -108,6 +209,29 @@ private:
   // See the jquery pailer for the expected behavior.
   Future<Response> read(const Request& request);
 
+  // Continuation for the 'poll' (long-poll) mode of the read
+  // endpoint: completes 'promise' once the file has grown past
+  // 'offset' or 'deadline' has passed, whichever comes first. Takes
+  // ownership of 'fd'.
+  void poll(
+      int fd,
+      off_t offset,
+      const Time& deadline,
+      const Option<string>& jsonp,
+      Owned<Promise<Response>> promise);
+
+  // Continuations for the 'follow' mode of the read endpoint: bytes
+  // appended to the file are pushed through the pipe as they arrive,
+  // instead of the client polling with increasing offsets. Takes
+  // ownership of 'fd'.
+  void follow(int fd, off_t offset, process::http::Pipe::Writer writer);
+  void _follow(
+      int fd,
+      off_t offset,
+      process::http::Pipe::Writer writer,
+      const boost::shared_array<char>& data,
+      const Future<size_t>& read);
+
   // Returns the raw file contents for a given path.
   // Requests have the following parameters:
   //   path: The directory to browse. Required.
@@ -244,12 +368,29 @@ Future<Response> FilesProcess::browse(const Request& request)
     }
   }
 
-  JSON::Array listing;
-  foreachvalue (const JSON::Object& file, files) {
-    listing.values.push_back(file);
-  }
+  // Stream the listing through a chunked response instead of
+  // materializing a JSON::Array of the entire directory (and its
+  // serialization) in memory first. The file info objects are
+  // captured by value since serialization happens on a worker
+  // thread.
+  auto serialize = [files](std::ostream* out) {
+    bool first = true;
+
+    *out << "[";
+
+    foreachvalue (const JSON::Object& file, files) {
+      if (!first) {
+        *out << ",";
+      }
+
+      *out << file;
+      first = false;
+    }
 
-  return OK(listing, request.url.query.get("jsonp"));
+    *out << "]";
+  };
+
+  return streamed(serialize, request.url.query.get("jsonp"));
 }
 
 
@@ -258,13 +399,17 @@ Future<Response> _read(int fd,
                        const size_t& size,
                        off_t offset,
                        const boost::shared_array<char>& data,
-                       const Option<string>& jsonp) {
+                       const Option<string>& jsonp,
+                       const string& lastModified) {
   JSON::Object object;
 
   object.values["offset"] = offset;
   object.values["data"] = string(data.get(), size);
 
-  return OK(object, jsonp);
+  OK response(object, jsonp);
+  response.headers["Last-Modified"] = lastModified;
+
+  return response;
 }
 
 
@@ -280,7 +425,20 @@ const string FilesProcess::READ_HELP = HELP(
         ">        path=VALUE          The path of directory to browse.",
         ">        offset=VALUE        Value added to base address to obtain "
         "a second address",
-        ">        length=VALUE        Length of file to read."));
+        ">        length=VALUE        Length of file to read.",
+        ">        follow=1            Stream bytes appended to the file as",
+        ">                            they arrive, starting at 'offset' (or",
+        ">                            the end of the file), as a chunked",
+        ">                            response of raw data.",
+        ">        poll=VALUE          Long-poll duration (e.g., '15secs',",
+        ">                            capped at 1 minute): when there is no",
+        ">                            data past 'offset' the response is",
+        ">                            delayed until the file grows or the",
+        ">                            duration expires.",
+        "",
+        "The file's modification time is returned in 'Last-Modified'",
+        "and requests with 'If-Modified-Since' are answered with '304",
+        "Not Modified' when the file has not been modified since."));
 
 
 Future<Response> FilesProcess::read(const Request& request)
@@ -316,6 +474,18 @@ Future<Response> FilesProcess::read(const Request& request)
     length = result.get();
   }
 
+  Option<Duration> poll = None();
+
+  if (request.url.query.get("poll").isSome()) {
+    Try<Duration> result = Duration::parse(request.url.query.get("poll").get());
+
+    if (result.isError()) {
+      return BadRequest("Failed to parse poll: " + result.error() + ".\n");
+    }
+
+    poll = std::min(result.get(), FILES_POLL_MAX);
+  }
+
   Result<string> resolvedPath = resolve(path.get());
 
   if (resolvedPath.isError()) {
@@ -353,6 +523,23 @@ Future<Response> FilesProcess::read(const Request& request)
     return InternalServerError(error + ".\n");
   }
 
+  // The file's modification time backs the 'Last-Modified' header
+  // and 'If-Modified-Since' requests.
+  struct stat s;
+
+  if (fstat(fd.get(), &s) == -1) {
+    string error = strings::format(
+        "Failed to stat file at '%s': %s",
+        resolvedPath.get(),
+        os::strerror(errno)).get();
+
+    LOG(WARNING) << error;
+    os::close(fd.get());
+    return InternalServerError(error + ".\n");
+  }
+
+  const string lastModified = rfc1123(s.st_mtime);
+
   if (offset == -1) {
     offset = size;
   }
@@ -364,13 +551,86 @@ Future<Response> FilesProcess::read(const Request& request)
   // Cap the read length at 16 pages.
   length = std::min<ssize_t>(length, sysconf(_SC_PAGE_SIZE) * 16);
 
+  Option<string> follow = request.url.query.get("follow");
+
+  if (follow.isSome() &&
+      (follow.get() == "1" || follow.get() == "true")) {
+    Try<Nothing> nonblock = os::nonblock(fd.get());
+    if (nonblock.isError()) {
+      string error =
+          "Failed to set file descriptor nonblocking: " + nonblock.error();
+      LOG(WARNING) << error;
+      os::close(fd.get());
+      return InternalServerError(error);
+    }
+
+    // Stream bytes appended to the file through a chunked response
+    // as they arrive, rather than having the client poll with
+    // increasing offsets. NOTE: unlike the polling reads, the
+    // response body is the raw file data rather than JSON.
+    http::Pipe pipe;
+
+    OK response;
+    response.type = Response::PIPE;
+    response.reader = pipe.reader();
+    response.headers["Content-Type"] = "text/plain";
+
+    this->follow(fd.get(), std::min(offset, size), pipe.writer());
+
+    return response;
+  }
+
+  // Answer conditional requests without reading the file. This does
+  // not apply to 'follow' mode since those clients are waiting for
+  // bytes appended in the future.
+  Option<string> ifModifiedSince = request.headers.get("If-Modified-Since");
+
+  if (ifModifiedSince.isSome()) {
+    Option<time_t> since = parseHttpDate(ifModifiedSince.get());
+
+    if (since.isSome() && s.st_mtime <= since.get()) {
+      os::close(fd.get());
+      return NotModified();
+    }
+  }
+
   if (offset >= size) {
+    // Long-poll: wait for the file to grow past 'offset' (or for the
+    // poll duration to expire) instead of returning an empty read
+    // that the client would immediately retry.
+    if (poll.isSome()) {
+      Try<Nothing> nonblock = os::nonblock(fd.get());
+      if (nonblock.isError()) {
+        string error =
+            "Failed to set file descriptor nonblocking: " + nonblock.error();
+        LOG(WARNING) << error;
+        os::close(fd.get());
+        return InternalServerError(error);
+      }
+
+      Owned<Promise<Response>> promise(new Promise<Response>());
+
+      Future<Response> future = promise->future();
+
+      this->poll(
+          fd.get(),
+          offset,
+          Clock::now() + poll.get(),
+          request.url.query.get("jsonp"),
+          promise);
+
+      return future;
+    }
+
     os::close(fd.get());
 
     JSON::Object object;
     object.values["offset"] = size;
     object.values["data"] = "";
-    return OK(object, request.url.query.get("jsonp"));
+
+    OK response(object, request.url.query.get("jsonp"));
+    response.headers["Last-Modified"] = lastModified;
+    return response;
   }
 
   // Seek to the offset we want to read from.
@@ -404,11 +664,238 @@ Future<Response> FilesProcess::read(const Request& request)
         lambda::_1,
         offset,
         data,
-        request.url.query.get("jsonp")))
+        request.url.query.get("jsonp"),
+        lastModified))
     .onAny(lambda::bind(&os::close, fd.get()));
 }
 
 
+void FilesProcess::poll(
+    int fd,
+    off_t offset,
+    const Time& deadline,
+    const Option<string>& jsonp,
+    Owned<Promise<Response>> promise)
+{
+  // Stop when the client disconnects.
+  if (promise->future().hasDiscard()) {
+    os::close(fd);
+    promise->discard();
+    return;
+  }
+
+  off_t size = lseek(fd, 0, SEEK_END);
+
+  if (size == -1) {
+    string error = "Failed to determine file size: " + os::strerror(errno);
+    LOG(WARNING) << error;
+    os::close(fd);
+    promise->set(Response(InternalServerError(error)));
+    return;
+  }
+
+  if (size > offset) {
+    // The file grew: serve the new bytes as a regular read would.
+    if (lseek(fd, offset, SEEK_SET) == -1) {
+      string error = "Failed to seek: " + os::strerror(errno);
+      LOG(WARNING) << error;
+      os::close(fd);
+      promise->set(Response(InternalServerError(error)));
+      return;
+    }
+
+    // Cap the read length at 16 pages.
+    size_t length =
+      std::min<size_t>(size - offset, sysconf(_SC_PAGE_SIZE) * 16);
+
+    struct stat s;
+
+    string lastModified;
+    if (fstat(fd, &s) != -1) {
+      lastModified = rfc1123(s.st_mtime);
+    }
+
+    boost::shared_array<char> data(new char[length]);
+
+    promise->associate(
+        io::read(fd, data.get(), length)
+          .then(lambda::bind(
+              _read,
+              fd,
+              lambda::_1,
+              offset,
+              data,
+              jsonp,
+              lastModified))
+          .onAny(lambda::bind(&os::close, fd)));
+    return;
+  }
+
+  if (Clock::now() >= deadline) {
+    // Give the client an empty read so it can poll again.
+    struct stat s;
+
+    JSON::Object object;
+    object.values["offset"] = size;
+    object.values["data"] = "";
+
+    OK response(object, jsonp);
+
+    if (fstat(fd, &s) != -1) {
+      response.headers["Last-Modified"] = rfc1123(s.st_mtime);
+    }
+
+    os::close(fd);
+    promise->set(Response(response));
+    return;
+  }
+
+  delay(FILES_FOLLOW_INTERVAL,
+        self(),
+        &FilesProcess::poll,
+        fd,
+        offset,
+        deadline,
+        jsonp,
+        promise);
+}
+
+
+void FilesProcess::follow(int fd, off_t offset, http::Pipe::Writer writer)
+{
+  // Stop when the client disconnects.
+  if (writer.readerClosed().isReady()) {
+    os::close(fd);
+    return;
+  }
+
+  // Don't read further ahead while the client has a backlog of
+  // streamed but untransmitted data.
+  if (writer.outstanding() >= FILES_FOLLOW_MAX_OUTSTANDING) {
+    delay(FILES_FOLLOW_INTERVAL,
+          self(),
+          &FilesProcess::follow,
+          fd,
+          offset,
+          writer);
+    return;
+  }
+
+  off_t size = lseek(fd, 0, SEEK_END);
+
+  if (size == -1) {
+    writer.fail("Failed to determine file size: " + os::strerror(errno));
+    os::close(fd);
+    return;
+  }
+
+  // A truncation (e.g., log rotation copying then truncating the
+  // file) moves the end of the file before the read position;
+  // continue following from the new end.
+  if (size < offset) {
+    offset = size;
+  }
+
+  if (size == offset) {
+    // Caught up with the end of the file; check for appended data
+    // again shortly.
+    delay(FILES_FOLLOW_INTERVAL,
+          self(),
+          &FilesProcess::follow,
+          fd,
+          offset,
+          writer);
+    return;
+  }
+
+  if (lseek(fd, offset, SEEK_SET) == -1) {
+    writer.fail("Failed to seek: " + os::strerror(errno));
+    os::close(fd);
+    return;
+  }
+
+  // Read the appended data in bounded chunks (16 pages, matching the
+  // cap on polling reads).
+  size_t length = std::min(
+      static_cast<size_t>(size - offset),
+      static_cast<size_t>(sysconf(_SC_PAGE_SIZE) * 16));
+
+  boost::shared_array<char> data(new char[length]);
+
+  io::read(fd, data.get(), length)
+    .onAny(defer(self(),
+                 &FilesProcess::_follow,
+                 fd,
+                 offset,
+                 writer,
+                 data,
+                 lambda::_1));
+}
+
+
+void FilesProcess::_follow(
+    int fd,
+    off_t offset,
+    http::Pipe::Writer writer,
+    const boost::shared_array<char>& data,
+    const Future<size_t>& read)
+{
+  if (!read.isReady()) {
+    writer.fail(read.isFailed() ? read.failure() : "Read discarded");
+    os::close(fd);
+    return;
+  }
+
+  size_t length = read.get();
+
+  if (length == 0) {
+    // Raced with a truncation; check for appended data again shortly.
+    delay(FILES_FOLLOW_INTERVAL,
+          self(),
+          &FilesProcess::follow,
+          fd,
+          offset,
+          writer);
+    return;
+  }
+
+  if (!writer.write(string(data.get(), length))) {
+    // The client closed the connection.
+    os::close(fd);
+    return;
+  }
+
+  follow(fd, offset + length, writer);
+}
+
+
+// Continuation for ranged downloads: wraps the bytes read in a
+// '206 Partial Content' response.
+Future<Response> _download(
+    int fd,
+    const size_t& length,
+    off_t offset,
+    off_t size,
+    const boost::shared_array<char>& data,
+    const string& contentType,
+    const string& contentDisposition,
+    const string& lastModified)
+{
+  PartialContent response(string(data.get(), length));
+
+  response.headers["Content-Type"] = contentType;
+  response.headers["Content-Disposition"] = contentDisposition;
+  response.headers["Last-Modified"] = lastModified;
+  response.headers["Content-Range"] = strings::format(
+      "bytes %jd-%jd/%jd",
+      (intmax_t) offset,
+      (intmax_t) (offset + length - 1),
+      (intmax_t) size).get();
+
+  return response;
+}
+
+
 const string FilesProcess::DOWNLOAD_HELP = HELP(
     TLDR(
         "Returns the raw file contents for a given path."),
@@ -418,7 +905,15 @@ const string FilesProcess::DOWNLOAD_HELP = HELP(
         "",
         "Query parameters:",
         "",
-        ">        path=VALUE          The path of directory to browse."));
+        ">        path=VALUE          The path of directory to browse.",
+        "",
+        "The file's modification time is returned in 'Last-Modified'",
+        "and requests with 'If-Modified-Since' are answered with '304",
+        "Not Modified' when the file has not been modified since.",
+        "",
+        "Byte ranges of the form 'Range: bytes=START-[END]' are served",
+        "with '206 Partial Content'; other range formats are ignored",
+        "and the full file is returned."));
 
 
 Future<Response> FilesProcess::download(const Request& request)
@@ -442,22 +937,126 @@ Future<Response> FilesProcess::download(const Request& request)
     return BadRequest("Cannot download a directory.\n");
   }
 
+  struct stat s;
+
+  if (stat(resolvedPath.get().c_str(), &s) == -1) {
+    string error = strings::format(
+        "Failed to stat file at '%s': %s",
+        resolvedPath.get(),
+        os::strerror(errno)).get();
+
+    LOG(WARNING) << error;
+    return InternalServerError(error + ".\n");
+  }
+
+  const string lastModified = rfc1123(s.st_mtime);
+
+  Option<string> ifModifiedSince = request.headers.get("If-Modified-Since");
+
+  if (ifModifiedSince.isSome()) {
+    Option<time_t> since = parseHttpDate(ifModifiedSince.get());
+
+    if (since.isSome() && s.st_mtime <= since.get()) {
+      return NotModified();
+    }
+  }
+
   string basename = Path(resolvedPath.get()).basename();
 
-  OK response;
-  response.type = response.PATH;
-  response.path = resolvedPath.get();
-  response.headers["Content-Type"] = "application/octet-stream";
-  response.headers["Content-Disposition"] =
-    strings::format("attachment; filename=%s", basename).get();
+  string contentType = "application/octet-stream";
 
   // Attempt to detect the mime type.
   Option<string> extension = Path(resolvedPath.get()).extension();
 
   if (extension.isSome() && mime::types.count(extension.get()) > 0) {
-    response.headers["Content-Type"] = mime::types[extension.get()];
+    contentType = mime::types[extension.get()];
   }
 
+  string contentDisposition =
+    strings::format("attachment; filename=%s", basename).get();
+
+  Option<string> rangeHeader = request.headers.get("Range");
+
+  if (rangeHeader.isSome()) {
+    Option<std::pair<off_t, Option<off_t>>> range =
+      parseRange(rangeHeader.get());
+
+    // Unsupported range formats (e.g., suffix or multiple ranges)
+    // fall through to a full response, per RFC 7233.
+    if (range.isSome()) {
+      off_t start = range.get().first;
+
+      if (start >= s.st_size) {
+        RequestedRangeNotSatisfiable response;
+        response.headers["Content-Range"] =
+          strings::format("bytes */%jd", (intmax_t) s.st_size).get();
+        return response;
+      }
+
+      off_t end = s.st_size - 1;
+
+      if (range.get().second.isSome()) {
+        end = std::min(range.get().second.get(), end);
+      }
+
+      // Cap the bytes served per request; the client continues from
+      // the end of the 'Content-Range' we return.
+      size_t length =
+        std::min<size_t>(end - start + 1, FILES_RANGE_MAX_LENGTH);
+
+      Try<int> fd = os::open(resolvedPath.get(), O_RDONLY | O_CLOEXEC);
+
+      if (fd.isError()) {
+        string error = strings::format("Failed to open file at '%s': %s",
+            resolvedPath.get(), fd.error()).get();
+        LOG(WARNING) << error;
+        return InternalServerError(error + ".\n");
+      }
+
+      if (lseek(fd.get(), start, SEEK_SET) == -1) {
+        string error = strings::format(
+            "Failed to seek file at '%s': %s",
+            resolvedPath.get(),
+            os::strerror(errno)).get();
+
+        LOG(WARNING) << error;
+        os::close(fd.get());
+        return InternalServerError(error);
+      }
+
+      Try<Nothing> nonblock = os::nonblock(fd.get());
+      if (nonblock.isError()) {
+        string error =
+            "Failed to set file descriptor nonblocking: " + nonblock.error();
+        LOG(WARNING) << error;
+        os::close(fd.get());
+        return InternalServerError(error);
+      }
+
+      boost::shared_array<char> data(new char[length]);
+
+      return io::read(fd.get(), data.get(), length)
+        .then(lambda::bind(
+            _download,
+            fd.get(),
+            lambda::_1,
+            start,
+            s.st_size,
+            data,
+            contentType,
+            contentDisposition,
+            lastModified))
+        .onAny(lambda::bind(&os::close, fd.get()));
+    }
+  }
+
+  OK response;
+  response.type = response.PATH;
+  response.path = resolvedPath.get();
+  response.headers["Content-Type"] = contentType;
+  response.headers["Content-Disposition"] = contentDisposition;
+  response.headers["Last-Modified"] = lastModified;
+
   return response;
 }
 
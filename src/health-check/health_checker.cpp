@@ -0,0 +1,378 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "health-check/health_checker.hpp"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/http.hpp>
+#include <process/id.hpp>
+#include <process/pid.hpp>
+#include <process/process.hpp>
+#include <process/protobuf.hpp>
+#include <process/subprocess.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/strings.hpp>
+
+#include "common/status_utils.hpp"
+
+#include "messages/messages.hpp"
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace health {
+
+using namespace process;
+
+class HealthCheckerProcess : public ProtobufProcess<HealthCheckerProcess>
+{
+public:
+  HealthCheckerProcess(
+      const HealthCheck& _check,
+      const UPID& _executor,
+      const TaskID& _taskID)
+    : ProcessBase(process::ID::generate("health-checker")),
+      check(_check),
+      initializing(true),
+      executor(_executor),
+      taskID(_taskID),
+      consecutiveFailures(0) {}
+
+  virtual ~HealthCheckerProcess() {}
+
+  Future<Nothing> healthCheck()
+  {
+    VLOG(2) << "Health checks starting in "
+      << Seconds(check.delay_seconds()) << ", grace period "
+      << Seconds(check.grace_period_seconds());
+
+    startTime = Clock::now();
+
+    delay(Seconds(check.delay_seconds()), self(), &Self::_healthCheck);
+    return promise.future();
+  }
+
+private:
+  void failure(const string& message)
+  {
+    if (check.grace_period_seconds() > 0 &&
+        (Clock::now() - startTime).secs() <= check.grace_period_seconds()) {
+      LOG(INFO) << "Ignoring failure as health check still in grace period";
+      reschedule();
+      return;
+    }
+
+    consecutiveFailures++;
+    VLOG(1) << "#" << consecutiveFailures << " check failed: " << message;
+
+    bool killTask = consecutiveFailures >= check.consecutive_failures();
+
+    TaskHealthStatus taskHealthStatus;
+    taskHealthStatus.set_healthy(false);
+    taskHealthStatus.set_consecutive_failures(consecutiveFailures);
+    taskHealthStatus.set_kill_task(killTask);
+    taskHealthStatus.mutable_task_id()->CopyFrom(taskID);
+    send(executor, taskHealthStatus);
+
+    if (killTask) {
+      // This is a hack to ensure the message is sent to the
+      // executor before we exit the process. Without this,
+      // we may exit before libprocess has sent the data over
+      // the socket. See MESOS-4111. Note that this is only
+      // required when the executor is remote (i.e., when running
+      // as the standalone 'mesos-health-check' helper).
+      if (executor.address != self().address) {
+        os::sleep(Seconds(1));
+      }
+
+      promise.fail(message);
+    } else {
+      reschedule();
+    }
+  }
+
+  void success()
+  {
+    VLOG(1) << "Check passed";
+
+    // Send a healthy status update on the first success,
+    // and on the first success following failure(s).
+    if (initializing || consecutiveFailures > 0) {
+      TaskHealthStatus taskHealthStatus;
+      taskHealthStatus.set_healthy(true);
+      taskHealthStatus.mutable_task_id()->CopyFrom(taskID);
+      send(executor, taskHealthStatus);
+      initializing = false;
+    }
+    consecutiveFailures = 0;
+    reschedule();
+  }
+
+  void _healthCheck()
+  {
+    Future<Nothing> checking;
+
+    if (check.has_http()) {
+      checking = httpHealthCheck();
+    } else {
+      checking = commandHealthCheck();
+    }
+
+    checking.onAny(defer(self(), &Self::__healthCheck, lambda::_1));
+  }
+
+  void __healthCheck(const Future<Nothing>& future)
+  {
+    if (future.isReady()) {
+      success();
+    } else if (future.isFailed()) {
+      failure(future.failure());
+    } else {
+      failure("discarded");
+    }
+  }
+
+  Future<Nothing> commandHealthCheck()
+  {
+    CHECK(check.has_command());
+
+    const CommandInfo& command = check.command();
+
+    map<string, string> environment = os::environment();
+
+    foreach (const Environment::Variable& variable,
+             command.environment().variables()) {
+      environment[variable.name()] = variable.value();
+    }
+
+    // Launch the subprocess.
+    Option<Try<Subprocess>> external = None();
+
+    if (command.shell()) {
+      // Use the shell variant.
+      if (!command.has_value()) {
+        return Failure("Shell command is not specified");
+      }
+
+      VLOG(2) << "Launching health command '" << command.value() << "'";
+
+      external = process::subprocess(
+          command.value(),
+          Subprocess::PATH("/dev/null"),
+          Subprocess::FD(STDERR_FILENO),
+          Subprocess::FD(STDERR_FILENO),
+          environment);
+    } else {
+      // Use the exec variant.
+      if (!command.has_value()) {
+        return Failure("Executable path is not specified");
+      }
+
+      vector<string> argv;
+      foreach (const string& arg, command.arguments()) {
+        argv.push_back(arg);
+      }
+
+      VLOG(2) << "Launching health command [" << command.value() << ", "
+              << strings::join(", ", argv) << "]";
+
+      external = process::subprocess(
+          command.value(),
+          argv,
+          Subprocess::PATH("/dev/null"),
+          Subprocess::FD(STDERR_FILENO),
+          Subprocess::FD(STDERR_FILENO),
+          None(),
+          environment);
+    }
+
+    CHECK_SOME(external);
+
+    if (external.get().isError()) {
+      return Failure(
+          "Error creating subprocess for healthcheck: " +
+          external.get().error());
+    }
+
+    const pid_t commandPid = external.get().get().pid();
+    const Duration timeout = Seconds(check.timeout_seconds());
+
+    return external.get().get().status()
+      .after(timeout, [timeout, commandPid](Future<Option<int>> future)
+          -> Future<Option<int>> {
+        future.discard();
+
+        if (commandPid != -1) {
+          // Cleanup the external command process.
+          os::killtree(commandPid, SIGKILL);
+          VLOG(1) << "Kill health check command " << commandPid;
+        }
+
+        return Failure(
+            "Command has not returned after " + stringify(timeout));
+      })
+      .then([](const Option<int>& status) -> Future<Nothing> {
+        if (status.isNone()) {
+          return Failure("Failed to reap the command process");
+        }
+
+        if (status.get() != 0) {
+          return Failure("Health command check " + WSTRINGIFY(status.get()));
+        }
+
+        return Nothing();
+      });
+  }
+
+  Future<Nothing> httpHealthCheck()
+  {
+    CHECK(check.has_http());
+
+    const HealthCheck::HTTP& http = check.http();
+
+    // NOTE: We probe over the loopback interface, which assumes the
+    // task exposes its port on the node running the executor (e.g.
+    // host networking or a mapped port).
+    const process::http::URL url(
+        "http",
+        "127.0.0.1",
+        static_cast<uint16_t>(http.port()),
+        http.path());
+
+    VLOG(2) << "Probing '" << url << "'";
+
+    const Duration timeout = Seconds(check.timeout_seconds());
+
+    return process::http::get(url)
+      .after(timeout, [url, timeout](Future<process::http::Response> future)
+          -> Future<process::http::Response> {
+        future.discard();
+
+        return Failure(
+            "HTTP check of '" + stringify(url) + "' has not returned"
+            " after " + stringify(timeout));
+      })
+      .then(defer(self(), &Self::_httpHealthCheck, lambda::_1));
+  }
+
+  Future<Nothing> _httpHealthCheck(const process::http::Response& response)
+  {
+    const HealthCheck::HTTP& http = check.http();
+
+    // Not specifying any statuses implies that any returned status
+    // is acceptable.
+    if (http.statuses().size() == 0) {
+      return Nothing();
+    }
+
+    foreach (uint32_t status, http.statuses()) {
+      if (response.code == static_cast<uint16_t>(status)) {
+        return Nothing();
+      }
+    }
+
+    return Failure("Unexpected HTTP response: " + response.status);
+  }
+
+  void reschedule()
+  {
+    VLOG(1) << "Rescheduling health check in "
+      << Seconds(check.interval_seconds());
+
+    delay(Seconds(check.interval_seconds()), self(), &Self::_healthCheck);
+  }
+
+  Promise<Nothing> promise;
+  HealthCheck check;
+  bool initializing;
+  UPID executor;
+  TaskID taskID;
+  uint32_t consecutiveFailures;
+  process::Time startTime;
+};
+
+
+Try<Owned<HealthChecker>> HealthChecker::create(
+    const HealthCheck& check,
+    const UPID& executor,
+    const TaskID& taskID)
+{
+  if (check.has_http() && check.has_command()) {
+    return Error("Both 'http' and 'command' health check requested");
+  }
+
+  if (!check.has_http() && !check.has_command()) {
+    return Error("Expecting one of 'http' or 'command' health check");
+  }
+
+  Owned<HealthCheckerProcess> process(
+      new HealthCheckerProcess(check, executor, taskID));
+
+  spawn(process.get());
+
+  return Owned<HealthChecker>(new HealthChecker(process));
+}
+
+
+HealthChecker::HealthChecker(Owned<HealthCheckerProcess> _process)
+  : process(_process) {}
+
+
+HealthChecker::~HealthChecker()
+{
+  terminate(process.get());
+  wait(process.get());
+}
+
+
+Future<Nothing> HealthChecker::healthCheck()
+{
+  return dispatch(process.get(), &HealthCheckerProcess::healthCheck);
+}
+
+
+void HealthChecker::stop()
+{
+  terminate(process.get(), true);
+}
+
+} // namespace health {
+} // namespace internal {
+} // namespace mesos {
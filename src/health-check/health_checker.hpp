@@ -0,0 +1,73 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __HEALTH_CHECKER_HPP__
+#define __HEALTH_CHECKER_HPP__
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/pid.hpp>
+
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace health {
+
+// Forward declaration.
+class HealthCheckerProcess;
+
+
+// Performs the health checks described by a 'HealthCheck' and
+// reports the results to the given executor via 'TaskHealthStatus'
+// messages. The checker runs in-process: HTTP checks are probed
+// asynchronously via libprocess and command checks fork only for the
+// duration of a single probe, so health checking a task does not
+// require a resident helper process.
+class HealthChecker
+{
+public:
+  // Validates the given health check and creates a checker. The
+  // checks do not start until 'healthCheck' is called.
+  static Try<process::Owned<HealthChecker>> create(
+      const HealthCheck& check,
+      const process::UPID& executor,
+      const TaskID& taskID);
+
+  ~HealthChecker();
+
+  // Starts the health checks. The returned future fails once the
+  // task has exceeded its allowed consecutive failures, i.e., after
+  // a 'TaskHealthStatus' with 'kill_task' set has been sent.
+  process::Future<Nothing> healthCheck();
+
+  // Stops the health checks.
+  void stop();
+
+private:
+  explicit HealthChecker(process::Owned<HealthCheckerProcess> process);
+
+  process::Owned<HealthCheckerProcess> process;
+};
+
+} // namespace health {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __HEALTH_CHECKER_HPP__
@@ -22,7 +22,6 @@
 #include <iostream>
 #include <list>
 #include <string>
-#include <vector>
 
 #include <mesos/executor.hpp>
 #include <mesos/type_utils.hpp>
@@ -31,9 +30,9 @@
 #include <process/delay.hpp>
 #include <process/future.hpp>
 #include <process/io.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
-#include <process/subprocess.hpp>
 #include <process/reap.hpp>
 #include <process/timer.hpp>
 
@@ -49,6 +48,8 @@
 #include "common/http.hpp"
 #include "common/status_utils.hpp"
 
+#include "health-check/health_checker.hpp"
+
 #ifdef __linux__
 #include "linux/fs.hpp"
 #endif
@@ -67,7 +68,6 @@ using std::cout;
 using std::cerr;
 using std::endl;
 using std::string;
-using std::vector;
 
 namespace mesos {
 namespace internal {
@@ -79,7 +79,6 @@ class CommandExecutorProcess : public ProtobufProcess<CommandExecutorProcess>
 public:
   CommandExecutorProcess(
       const Option<char**>& override,
-      const string& _healthCheckDir,
       const Option<string>& _sandboxDirectory,
       const Option<string>& _user)
     : state(REGISTERING),
@@ -87,10 +86,8 @@ public:
       killed(false),
       killedByHealthCheck(false),
       pid(-1),
-      healthPid(-1),
       escalationTimeout(slave::EXECUTOR_SIGNAL_ESCALATION_TIMEOUT),
       driver(None()),
-      healthCheckDir(_healthCheckDir),
       override(override),
       sandboxDirectory(_sandboxDirectory),
       user(_user) {}
@@ -405,9 +402,9 @@ public:
   void killTask(ExecutorDriver* driver, const TaskID& taskId)
   {
     shutdown(driver);
-    if (healthPid != -1) {
-      // Cleanup health check process.
-      os::killtree(healthPid, SIGKILL);
+    if (checker.get() != NULL) {
+      // Stop health checking the task.
+      checker->stop();
     }
   }
 
@@ -571,37 +568,25 @@ private:
   void launchHealthCheck(const TaskInfo& task)
   {
     if (task.has_health_check()) {
-      JSON::Object json = JSON::protobuf(task.health_check());
-
-      // Launch the subprocess using 'exec' style so that quotes can
-      // be properly handled.
-      vector<string> argv(4);
-      argv[0] = "mesos-health-check";
-      argv[1] = "--executor=" + stringify(self());
-      argv[2] = "--health_check_json=" + stringify(json);
-      argv[3] = "--task_id=" + task.task_id().value();
-
-      cout << "Launching health check process: "
-           << path::join(healthCheckDir, "mesos-health-check")
-           << " " << argv[1] << " " << argv[2] << " " << argv[3] << endl;
-
-      Try<Subprocess> healthProcess =
-        process::subprocess(
-          path::join(healthCheckDir, "mesos-health-check"),
-          argv,
-          // Intentionally not sending STDIN to avoid health check
-          // commands that expect STDIN input to block.
-          Subprocess::PATH("/dev/null"),
-          Subprocess::FD(STDOUT_FILENO),
-          Subprocess::FD(STDERR_FILENO));
-
-      if (healthProcess.isError()) {
-        cerr << "Unable to launch health process: " << healthProcess.error();
+      // Run the health checks in-process; the checker reports results
+      // back to us via 'TaskHealthStatus' messages.
+      Try<Owned<health::HealthChecker>> _checker =
+        health::HealthChecker::create(
+            task.health_check(),
+            self(),
+            task.task_id());
+
+      if (_checker.isError()) {
+        cerr << "Unable to launch health checker: "
+             << _checker.error() << endl;
       } else {
-        healthPid = healthProcess.get().pid();
+        checker = _checker.get();
+
+        cout << "Health checking task " << task.task_id().value() << endl;
 
-        cout << "Health check process launched at pid: "
-             << stringify(healthPid) << endl;
+        // NOTE: Task kills triggered by failed health checks arrive
+        // via 'TaskHealthStatus', so the returned future is ignored.
+        checker->healthCheck();
       }
     }
   }
@@ -616,14 +601,13 @@ private:
   bool killed;
   bool killedByHealthCheck;
   pid_t pid;
-  pid_t healthPid;
   Duration escalationTimeout;
   Timer escalationTimer;
   Option<ExecutorDriver*> driver;
-  string healthCheckDir;
   Option<char**> override;
   Option<string> sandboxDirectory;
   Option<string> user;
+  Owned<health::HealthChecker> checker;
 };
 
 
@@ -632,12 +616,11 @@ class CommandExecutor: public Executor
 public:
   CommandExecutor(
       const Option<char**>& override,
-      const string& healthCheckDir,
       const Option<string>& sandboxDirectory,
       const Option<string>& user)
   {
     process = new CommandExecutorProcess(
-        override, healthCheckDir, sandboxDirectory, user);
+        override, sandboxDirectory, user);
     spawn(process);
   }
 
@@ -773,12 +756,8 @@ int main(int argc, char** argv)
     }
   }
 
-  const Option<string> envPath = os::getenv("MESOS_LAUNCHER_DIR");
-  string path =
-    envPath.isSome() ? envPath.get()
-                     : os::realpath(Path(argv[0]).dirname()).get();
   mesos::internal::CommandExecutor executor(
-      override, path, flags.sandbox_directory, flags.user);
+      override, flags.sandbox_directory, flags.user);
   mesos::MesosExecutorDriver driver(&executor);
   return driver.run() == mesos::DRIVER_STOPPED ? EXIT_SUCCESS : EXIT_FAILURE;
 }
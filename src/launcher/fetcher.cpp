@@ -14,8 +14,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <unistd.h>
+
+#include <list>
 #include <string>
 
+#include <process/async.hpp>
+#include <process/check.hpp>
+#include <process/collect.hpp>
 #include <process/owned.hpp>
 
 #include <stout/json.hpp>
@@ -44,6 +50,7 @@ using namespace process;
 using namespace mesos;
 using namespace mesos::internal;
 
+using std::list;
 using std::string;
 
 using mesos::fetcher::FetcherInfo;
@@ -51,6 +58,14 @@ using mesos::fetcher::FetcherInfo;
 using mesos::internal::slave::Fetcher;
 
 
+// Number of URIs fetched in parallel at any given time. This must
+// leave some of the libprocess worker threads (there are at least 8)
+// free: a fetch blocks the thread it runs on, while auxiliary work
+// (e.g., the subprocess handling of the HDFS client) still needs
+// free threads to make progress.
+static const size_t MAX_CONCURRENT_FETCHES = 6;
+
+
 // Try to extract sourcePath into directory. If sourcePath is
 // recognized as an archive it will be extracted and true returned;
 // if not recognized then false will be returned. An Error is
@@ -176,6 +191,30 @@ static Try<string> copyFile(
 }
 
 
+// Materializes a cached file in the sandbox. If hardlinking is
+// enabled we try that first and fall back to copying, e.g., when the
+// cache and the sandbox reside on different filesystems.
+static Try<string> materializeFile(
+    const string& sourcePath,
+    const string& destinationPath,
+    bool hardlink)
+{
+  if (hardlink) {
+    if (::link(sourcePath.c_str(), destinationPath.c_str()) == 0) {
+      LOG(INFO) << "Hardlinked '" << sourcePath
+                << "' to '" << destinationPath << "'";
+      return destinationPath;
+    }
+
+    LOG(WARNING) << "Failed to hardlink '" << sourcePath << "' to '"
+                 << destinationPath << "': " << os::strerror(errno)
+                 << "; falling back to copying";
+  }
+
+  return copyFile(sourcePath, destinationPath);
+}
+
+
 static Try<string> download(
     const string& _sourceUri,
     const string& destinationPath,
@@ -284,7 +323,8 @@ static Try<string> fetchBypassingCache(
 static Try<string> fetchFromCache(
     const FetcherInfo::Item& item,
     const string& cacheDirectory,
-    const string& sandboxDirectory)
+    const string& sandboxDirectory,
+    bool hardlink)
 {
   LOG(INFO) << "Fetching from cache";
 
@@ -301,6 +341,8 @@ static Try<string> fetchFromCache(
   string sourcePath = path::join(cacheDirectory, item.cache_filename());
 
   if (item.uri().executable()) {
+    // NOTE: Executables are always copied: chmod'ing a hardlinked
+    // file would alter the permissions of the shared cached copy.
     Try<string> copied = copyFile(sourcePath, destinationPath);
     if (copied.isError()) {
       return Error(copied.error());
@@ -320,7 +362,7 @@ static Try<string> fetchFromCache(
     }
   }
 
-  return copyFile(sourcePath, destinationPath);
+  return materializeFile(sourcePath, destinationPath, hardlink);
 }
 
 
@@ -330,7 +372,8 @@ static Try<string> fetchThroughCache(
     const FetcherInfo::Item& item,
     const Option<string>& cacheDirectory,
     const string& sandboxDirectory,
-    const Option<string>& frameworksHome)
+    const Option<string>& frameworksHome,
+    bool hardlink)
 {
   if (cacheDirectory.isNone() || cacheDirectory.get().empty()) {
     return Error("Cache directory not specified");
@@ -364,7 +407,7 @@ static Try<string> fetchThroughCache(
     }
   }
 
-  return fetchFromCache(item, cacheDirectory.get(), sandboxDirectory);
+  return fetchFromCache(item, cacheDirectory.get(), sandboxDirectory, hardlink);
 }
 
 
@@ -374,7 +417,8 @@ static Try<string> fetch(
     const FetcherInfo::Item& item,
     const Option<string>& cacheDirectory,
     const string& sandboxDirectory,
-    const Option<string>& frameworksHome)
+    const Option<string>& frameworksHome,
+    bool hardlink)
 {
   LOG(INFO) << "Fetching URI '" << item.uri().value() << "'";
 
@@ -389,7 +433,8 @@ static Try<string> fetch(
       item,
       cacheDirectory,
       sandboxDirectory,
-      frameworksHome);
+      frameworksHome,
+      hardlink);
 }
 
 
@@ -445,16 +490,45 @@ int main(int argc, char* argv[])
       Option<string>::some(fetcherInfo.get().frameworks_home()) :
         Option<string>::none();
 
-  // Fetch each URI to a local file, chmod, then chown if a user is provided.
-  foreach (const FetcherInfo::Item& item, fetcherInfo.get().items()) {
-    Try<string> fetched =
-      fetch(item, cacheDirectory, sandboxDirectory, frameworksHome);
-    if (fetched.isError()) {
-      EXIT(1) << "Failed to fetch '" << item.uri().value()
-              << "': " + fetched.error();
-    } else {
-      LOG(INFO) << "Fetched '" << item.uri().value()
-                << "' to '" << fetched.get() << "'";
+  // Fetch the URIs in parallel, at most MAX_CONCURRENT_FETCHES at a
+  // time. Each fetch runs on a libprocess worker thread, and the
+  // URIs of a container routinely point at different servers, so
+  // fetching them one after another leaves most of the available
+  // bandwidth unused.
+  int index = 0;
+  while (index < fetcherInfo.get().items().size()) {
+    list<FetcherInfo::Item> batch;
+    list<Future<Try<string>>> fetches;
+
+    while (index < fetcherInfo.get().items().size() &&
+           fetches.size() < MAX_CONCURRENT_FETCHES) {
+      const FetcherInfo::Item& item = fetcherInfo.get().items(index++);
+      batch.push_back(item);
+      fetches.push_back(async(
+          fetch,
+          item,
+          cacheDirectory,
+          sandboxDirectory,
+          frameworksHome,
+          fetcherInfo.get().hardlink_materialization()));
+    }
+
+    await(fetches).await();
+
+    list<Future<Try<string>>>::iterator fetched = fetches.begin();
+    foreach (const FetcherInfo::Item& item, batch) {
+      CHECK_READY(*fetched);
+
+      const Try<string>& result = fetched->get();
+      if (result.isError()) {
+        EXIT(1) << "Failed to fetch '" << item.uri().value()
+                << "': " + result.error();
+      } else {
+        LOG(INFO) << "Fetched '" << item.uri().value()
+                  << "' to '" << result.get() << "'";
+      }
+
+      ++fetched;
     }
   }
 
@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <errno.h>
+#include <fcntl.h>
 #include <fts.h>
 #include <signal.h>
 #include <stdint.h>
@@ -840,6 +841,30 @@ Try<Nothing> create(
 }
 
 
+Try<Nothing> create(
+    const string& hierarchy,
+    const vector<string>& cgroups,
+    bool recursive)
+{
+  // NOTE: The hierarchy is only verified once for the whole batch
+  // since verification parses /proc/mounts.
+  Option<Error> error = verify(hierarchy);
+  if (error.isSome()) {
+    return error.get();
+  }
+
+  foreach (const string& cgroup, cgroups) {
+    Try<Nothing> create = internal::create(hierarchy, cgroup, recursive);
+    if (create.isError()) {
+      return Error(
+          "Failed to create cgroup '" + cgroup + "': " + create.error());
+    }
+  }
+
+  return Nothing();
+}
+
+
 Try<Nothing> remove(const string& hierarchy, const string& cgroup)
 {
   Option<Error> error = verify(hierarchy, cgroup);
@@ -1376,74 +1401,100 @@ Try<Nothing> state(
 
 } // namespace freezer {
 
+// Freezes or thaws a batch of cgroups. The whole batch is written in
+// one pass and the states are then polled together, sharing a single
+// retry timer, so freezing many cgroups at once (e.g., during a mass
+// teardown) does not multiply freezer round trips.
 class Freezer : public Process<Freezer>
 {
 public:
   Freezer(
       const string& _hierarchy,
-      const string& _cgroup)
+      const vector<string>& _cgroups)
     : hierarchy(_hierarchy),
-      cgroup(_cgroup),
+      cgroups(_cgroups),
       start(Clock::now()) {}
 
   virtual ~Freezer() {}
 
   void freeze()
   {
-    Try<Nothing> freeze =
-      internal::freezer::state(hierarchy, cgroup, "FROZEN");
-    if (freeze.isError()) {
-      promise.fail(freeze.error());
-      terminate(self());
-      return;
-    }
+    // Attempt to freeze every cgroup that has not been confirmed
+    // frozen yet.
+    vector<string> remaining;
+
+    foreach (const string& cgroup, pending) {
+      Try<Nothing> freeze =
+        internal::freezer::state(hierarchy, cgroup, "FROZEN");
+      if (freeze.isError()) {
+        promise.fail(freeze.error());
+        terminate(self());
+        return;
+      }
 
-    Try<string> state = internal::freezer::state(hierarchy, cgroup);
-    if (state.isError()) {
-      promise.fail(state.error());
-      terminate(self());
-      return;
+      Try<string> state = internal::freezer::state(hierarchy, cgroup);
+      if (state.isError()) {
+        promise.fail(state.error());
+        terminate(self());
+        return;
+      }
+
+      if (state.get() != "FROZEN") {
+        remaining.push_back(cgroup);
+      }
     }
 
-    if (state.get() == "FROZEN") {
-      LOG(INFO) << "Successfully froze cgroup "
-                << path::join(hierarchy, cgroup)
+    pending = remaining;
+
+    if (pending.empty()) {
+      LOG(INFO) << "Successfully froze " << cgroups.size()
+                << " cgroup(s) under hierarchy " << hierarchy
                 << " after " << (Clock::now() - start);
       promise.set(Nothing());
       terminate(self());
       return;
     }
 
-    // Attempt to freeze the freezer cgroup again.
+    // Attempt to freeze the remaining freezer cgroups again.
     delay(Milliseconds(100), self(), &Self::freeze);
   }
 
   void thaw()
   {
-    Try<Nothing> thaw = internal::freezer::state(hierarchy, cgroup, "THAWED");
-    if (thaw.isError()) {
-      promise.fail(thaw.error());
-      terminate(self());
-      return;
-    }
+    vector<string> remaining;
 
-    Try<string> state = internal::freezer::state(hierarchy, cgroup);
-    if (state.isError()) {
-      promise.fail(state.error());
-      terminate(self());
-      return;
+    foreach (const string& cgroup, pending) {
+      Try<Nothing> thaw = internal::freezer::state(hierarchy, cgroup, "THAWED");
+      if (thaw.isError()) {
+        promise.fail(thaw.error());
+        terminate(self());
+        return;
+      }
+
+      Try<string> state = internal::freezer::state(hierarchy, cgroup);
+      if (state.isError()) {
+        promise.fail(state.error());
+        terminate(self());
+        return;
+      }
+
+      if (state.get() != "THAWED") {
+        remaining.push_back(cgroup);
+      }
     }
 
-    if (state.get() == "THAWED") {
-      LOG(INFO) << "Successfullly thawed cgroup "
-                << path::join(hierarchy, cgroup)
+    pending = remaining;
+
+    if (pending.empty()) {
+      LOG(INFO) << "Successfullly thawed " << cgroups.size()
+                << " cgroup(s) under hierarchy " << hierarchy
                 << " after " << (Clock::now() - start);
       promise.set(Nothing());
       terminate(self());
       return;
     }
 
-    // Attempt to thaw the freezer cgroup again.
+    // Attempt to thaw the remaining freezer cgroups again.
     delay(Milliseconds(100), self(), &Self::thaw);
   }
 
@@ -1452,13 +1503,27 @@ public:
 protected:
   virtual void initialize()
   {
-    Option<Error> error = verify(hierarchy, cgroup, "freezer.state");
+    // NOTE: The hierarchy is only verified once for the whole batch
+    // since verification parses /proc/mounts; each cgroup is then
+    // checked for existence directly.
+    Option<Error> error = verify(hierarchy, "", "freezer.state");
     if (error.isSome()) {
       promise.fail("Invalid freezer cgroup: " + error.get().message);
       terminate(self());
       return;
     }
 
+    foreach (const string& cgroup, cgroups) {
+      if (!os::exists(path::join(hierarchy, cgroup))) {
+        promise.fail(
+            "Invalid freezer cgroup: '" + cgroup + "' is not a valid cgroup");
+        terminate(self());
+        return;
+      }
+    }
+
+    pending = cgroups;
+
     // Stop attempting to freeze/thaw if nobody cares.
     promise.future().onDiscard(lambda::bind(
           static_cast<void(*)(const UPID&, bool)>(terminate), self(), true));
@@ -1471,18 +1536,27 @@ protected:
 
 private:
   const string hierarchy;
-  const string cgroup;
+  const vector<string> cgroups;
+
+  // The cgroups whose target state has not been confirmed yet.
+  vector<string> pending;
+
   const Time start;
   Promise<Nothing> promise;
 };
 
 
-// The process used to atomically kill all tasks in a cgroup.
+// The process used to atomically kill all tasks in a batch of
+// cgroups. The cgroups are frozen, killed, and thawed together as
+// phases over the whole batch, sharing one freezer poll and one
+// freeze retry timer (see the 'Freezer' above), so that tearing down
+// many containers at once costs one freeze/thaw cycle rather than
+// one per cgroup.
 class TasksKiller : public Process<TasksKiller>
 {
 public:
-  TasksKiller(const string& _hierarchy, const string& _cgroup)
-    : hierarchy(_hierarchy), cgroup(_cgroup) {}
+  TasksKiller(const string& _hierarchy, const vector<string>& _cgroups)
+    : hierarchy(_hierarchy), cgroups(_cgroups) {}
 
   virtual ~TasksKiller() {}
 
@@ -1532,10 +1606,11 @@ private:
   }
 
   void killTasks() {
-    // Chain together the steps needed to kill all tasks in the cgroup.
-    chain = freeze()                     // Freeze the cgroup.
+    // Chain together the steps needed to kill all tasks in the
+    // cgroups.
+    chain = freeze()                     // Freeze the cgroups.
       .then(defer(self(), &Self::kill))  // Send kill signal.
-      .then(defer(self(), &Self::thaw))  // Thaw cgroup to deliver signal.
+      .then(defer(self(), &Self::thaw))  // Thaw cgroups to deliver signal.
       .then(defer(self(), &Self::reap)); // Wait until all pids are reaped.
 
     chain.onAny(defer(self(), &Self::finished, lambda::_1));
@@ -1545,27 +1620,33 @@ private:
   {
     // TODO(jieyu): This is a workaround for MESOS-1689. We will move
     // away from freezer once we have pid namespace support.
-    return cgroups::freezer::freeze(hierarchy, cgroup).after(
+    return cgroups::freezer::freeze(hierarchy, cgroups).after(
         FREEZE_RETRY_INTERVAL,
         lambda::bind(&freezeTimedout, lambda::_1, self()));
   }
 
   Future<Nothing> kill()
   {
-    Try<set<pid_t>> processes = cgroups::processes(hierarchy, cgroup);
-    if (processes.isError()) {
-      return Failure(processes.error());
-    }
+    // Scan the tasks of the whole batch in one pass before any kill
+    // is delivered.
+    foreach (const string& cgroup, cgroups) {
+      Try<set<pid_t>> processes = cgroups::processes(hierarchy, cgroup);
+      if (processes.isError()) {
+        return Failure(processes.error());
+      }
 
-    // Reaping the frozen pids before we kill (and thaw) ensures we reap the
-    // correct pids.
-    foreach (const pid_t pid, processes.get()) {
-      statuses.push_back(process::reap(pid));
+      // Reaping the frozen pids before we kill (and thaw) ensures we
+      // reap the correct pids.
+      foreach (const pid_t pid, processes.get()) {
+        statuses.push_back(process::reap(pid));
+      }
     }
 
-    Try<Nothing> kill = cgroups::kill(hierarchy, cgroup, SIGKILL);
-    if (kill.isError()) {
-      return Failure(kill.error());
+    foreach (const string& cgroup, cgroups) {
+      Try<Nothing> kill = cgroups::kill(hierarchy, cgroup, SIGKILL);
+      if (kill.isError()) {
+        return Failure(kill.error());
+      }
     }
 
     return Nothing();
@@ -1573,7 +1654,7 @@ private:
 
   Future<Nothing> thaw()
   {
-    return cgroups::freezer::thaw(hierarchy, cgroup);
+    return cgroups::freezer::thaw(hierarchy, cgroups);
   }
 
   Future<list<Option<int>>> reap()
@@ -1594,14 +1675,16 @@ private:
       return;
     }
 
-    // Verify the cgroup is now empty.
-    Try<set<pid_t>> processes = cgroups::processes(hierarchy, cgroup);
-    if (processes.isError() || !processes.get().empty()) {
-      promise.fail("Failed to kill all processes in cgroup: " +
-                   (processes.isError() ? processes.error()
-                                        : "processes remain"));
-      terminate(self());
-      return;
+    // Verify the cgroups are now empty.
+    foreach (const string& cgroup, cgroups) {
+      Try<set<pid_t>> processes = cgroups::processes(hierarchy, cgroup);
+      if (processes.isError() || !processes.get().empty()) {
+        promise.fail("Failed to kill all processes in cgroup: " +
+                     (processes.isError() ? processes.error()
+                                          : "processes remain"));
+        terminate(self());
+        return;
+      }
     }
 
     promise.set(Nothing());
@@ -1609,7 +1692,7 @@ private:
   }
 
   const string hierarchy;
-  const string cgroup;
+  const vector<string> cgroups;
   Promise<Nothing> promise;
   list<Future<Option<int>>> statuses; // List of statuses for processes.
   Future<list<Option<int>>> chain; // Used to discard all operations.
@@ -1636,27 +1719,26 @@ protected:
     promise.future().onDiscard(lambda::bind(
         static_cast<void (*)(const UPID&, bool)>(terminate), self(), true));
 
-    // Kill tasks in the given cgroups in parallel. Use collect mechanism to
-    // wait until all kill processes finish.
-    foreach (const string& cgroup, cgroups) {
-      internal::TasksKiller* killer =
-        new internal::TasksKiller(hierarchy, cgroup);
-      killers.push_back(killer->future());
-      spawn(killer, true);
-    }
+    // Kill the tasks in the given cgroups with a single killer so
+    // that the whole batch shares one freeze/thaw cycle and one
+    // retry timer.
+    internal::TasksKiller* taskskiller =
+      new internal::TasksKiller(hierarchy, cgroups);
+    killer = taskskiller->future();
+    spawn(taskskiller, true);
 
-    collect(killers)
+    killer
       .onAny(defer(self(), &Destroyer::killed, lambda::_1));
   }
 
   virtual void finalize()
   {
-    discard(killers);
+    killer.discard();
     promise.discard();
   }
 
 private:
-  void killed(const Future<list<Nothing>>& kill)
+  void killed(const Future<Nothing>& kill)
   {
     if (kill.isReady()) {
       remove();
@@ -1690,8 +1772,8 @@ private:
   const vector<string> cgroups;
   Promise<Nothing> promise;
 
-  // The killer processes used to atomically kill tasks in each cgroup.
-  list<Future<Nothing>> killers;
+  // The killer process used to atomically kill tasks in the cgroups.
+  Future<Nothing> killer;
 };
 
 } // namespace internal {
@@ -1776,6 +1858,68 @@ Future<Nothing> destroy(
 }
 
 
+Future<Nothing> destroy(const string& hierarchy, const vector<string>& cgroups)
+{
+  // Construct the vector of cgroups to destroy: each given cgroup
+  // preceded by its nested cgroups (cgroups::get() returns them in
+  // post-order, easing removal).
+  vector<string> candidates;
+
+  foreach (const string& cgroup, cgroups) {
+    Try<vector<string>> nested = cgroups::get(hierarchy, cgroup);
+    if (nested.isError()) {
+      return Failure(
+          "Failed to get nested cgroups: " + nested.error());
+    }
+
+    candidates.insert(
+        candidates.end(), nested.get().begin(), nested.get().end());
+
+    if (cgroup != "/") {
+      candidates.push_back(cgroup);
+    }
+  }
+
+  if (candidates.empty()) {
+    return Nothing();
+  }
+
+  // If the freezer subsystem is available, destroy the cgroups with a
+  // single destroyer so all the cgroups in the batch are frozen and
+  // their tasks killed in parallel, and completion is awaited as one
+  // operation.
+  // NOTE: The hierarchy is only verified once for the whole batch.
+  Option<Error> error = verify(hierarchy, "", "freezer.state");
+  if (error.isNone()) {
+    internal::Destroyer* destroyer =
+      new internal::Destroyer(hierarchy, candidates);
+    Future<Nothing> future = destroyer->future();
+    spawn(destroyer, true);
+    return future;
+  } else {
+    // Otherwise, attempt to remove the cgroups in bottom-up fashion.
+    foreach (const string& cgroup, candidates) {
+      Try<Nothing> remove = cgroups::remove(hierarchy, cgroup);
+      if (remove.isError()) {
+        return Failure(remove.error());
+      }
+    }
+  }
+
+  return Nothing();
+}
+
+
+Future<Nothing> destroy(
+    const string& hierarchy,
+    const vector<string>& cgroups,
+    const Duration& timeout)
+{
+  return destroy(hierarchy, cgroups)
+    .after(timeout, lambda::bind(&_destroy, lambda::_1, timeout));
+}
+
+
 // Forward declaration.
 Future<bool> _cleanup(const string& hierarchy);
 
@@ -1836,9 +1980,17 @@ Try<hashmap<string, uint64_t>> stat(
     return Error(contents.error());
   }
 
+  return stat(file, contents.get());
+}
+
+
+Try<hashmap<string, uint64_t>> stat(
+    const string& file,
+    const string& contents)
+{
   hashmap<string, uint64_t> result;
 
-  foreach (const string& line, strings::split(contents.get(), "\n")) {
+  foreach (const string& line, strings::split(contents, "\n")) {
     // Skip empty lines.
     if (strings::trim(line).empty()) {
       continue;
@@ -1862,6 +2014,52 @@ Try<hashmap<string, uint64_t>> stat(
 }
 
 
+Try<hashmap<string, string>> snapshot(
+    const string& hierarchy,
+    const string& cgroup,
+    const vector<string>& controls)
+{
+  Option<Error> error = verify(hierarchy, cgroup);
+  if (error.isSome()) {
+    return error.get();
+  }
+
+  hashmap<string, string> snapshot;
+
+  // A single buffer is reused across all the reads. Note that we
+  // cannot lseek control files, so we read sequentially until EOF.
+  char buffer[4096];
+
+  foreach (const string& control, controls) {
+    const string path = path::join(hierarchy, cgroup, control);
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      return ErrnoError("Failed to open '" + path + "'");
+    }
+
+    string contents;
+
+    ssize_t length;
+    while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+      contents.append(buffer, length);
+    }
+
+    if (length == -1) {
+      ErrnoError error("Failed to read '" + path + "'");
+      os::close(fd);
+      return error;
+    }
+
+    os::close(fd);
+
+    snapshot[control] = contents;
+  }
+
+  return snapshot;
+}
+
+
 namespace internal {
 
 // Helper for finding the cgroup of the specified pid for the
@@ -2338,6 +2536,17 @@ public:
     return value_;
   }
 
+  Future<uint64_t> next()
+  {
+    if (error.isSome()) {
+      return Failure(error.get());
+    }
+
+    Owned<Promise<uint64_t>> promise(new Promise<uint64_t>());
+    promises.push_back(promise);
+    return promise->future();
+  }
+
 protected:
   virtual void initialize()
   {
@@ -2364,16 +2573,34 @@ private:
 
     if (future.isReady()) {
       value_ += future.get();
+
+      // Notify anyone waiting for the next pressure event.
+      foreach (const Owned<Promise<uint64_t>>& promise, promises) {
+        promise->set(value_);
+      }
+      promises.clear();
+
       listen();
     } else if (future.isFailed()) {
       error = Error(future.failure());
+      fail();
     } else if (future.isDiscarded()) {
       error = Error("Listening stopped unexpectedly");
+      fail();
     }
   }
 
+  void fail()
+  {
+    foreach (const Owned<Promise<uint64_t>>& promise, promises) {
+      promise->fail(error.get().message);
+    }
+    promises.clear();
+  }
+
   uint64_t value_;
   Option<Error> error;
+  std::list<Owned<Promise<uint64_t>>> promises;
   process::Owned<event::Listener> process;
 };
 
@@ -2413,6 +2640,12 @@ Future<uint64_t> Counter::value() const
   return dispatch(process.get(), &CounterProcess::value);
 }
 
+
+Future<uint64_t> Counter::next() const
+{
+  return dispatch(process.get(), &CounterProcess::next);
+}
+
 } // namespace pressure {
 
 } // namespace memory {
@@ -2424,9 +2657,19 @@ Future<Nothing> freeze(
     const string& hierarchy,
     const string& cgroup)
 {
-  LOG(INFO) << "Freezing cgroup " << path::join(hierarchy, cgroup);
+  return freeze(hierarchy, vector<string>(1, cgroup));
+}
+
+
+Future<Nothing> freeze(
+    const string& hierarchy,
+    const vector<string>& cgroups)
+{
+  foreach (const string& cgroup, cgroups) {
+    LOG(INFO) << "Freezing cgroup " << path::join(hierarchy, cgroup);
+  }
 
-  internal::Freezer* freezer = new internal::Freezer(hierarchy, cgroup);
+  internal::Freezer* freezer = new internal::Freezer(hierarchy, cgroups);
   PID<internal::Freezer> pid = freezer->self();
 
   Future<Nothing> future = freezer->future();
@@ -2442,9 +2685,19 @@ Future<Nothing> thaw(
     const string& hierarchy,
     const string& cgroup)
 {
-  LOG(INFO) << "Thawing cgroup " << path::join(hierarchy, cgroup);
+  return thaw(hierarchy, vector<string>(1, cgroup));
+}
+
+
+Future<Nothing> thaw(
+    const string& hierarchy,
+    const vector<string>& cgroups)
+{
+  foreach (const string& cgroup, cgroups) {
+    LOG(INFO) << "Thawing cgroup " << path::join(hierarchy, cgroup);
+  }
 
-  internal::Freezer* freezer = new internal::Freezer(hierarchy, cgroup);
+  internal::Freezer* freezer = new internal::Freezer(hierarchy, cgroups);
   PID<internal::Freezer> pid = freezer->self();
 
   Future<Nothing> future = freezer->future();
@@ -192,6 +192,24 @@ Try<Nothing> create(
     bool recursive = false);
 
 
+// Create multiple cgroups under a given hierarchy in a single pass.
+// The hierarchy is only verified once for the whole batch, instead of
+// re-verified (which includes parsing /proc/mounts) for every cgroup
+// as happens when calling the single cgroup version in a loop. The
+// cgroups are created in the given order, so parents must precede
+// any of their children unless 'recursive' is set.
+// @param   hierarchy   Path to the hierarchy root.
+// @param   cgroups     Paths to the cgroups relative to the hierarchy root.
+// @param   recursive   Will create nested cgroups.
+// @return  Some if the operation succeeds.
+//          Error if the operation fails; cgroups created before the
+//          failure are not removed.
+Try<Nothing> create(
+    const std::string& hierarchy,
+    const std::vector<std::string>& cgroups,
+    bool recursive = false);
+
+
 // Remove a cgroup under a given hierarchy. This function will return error if
 // the given hierarchy or the given cgroup is not valid. The cgroup will NOT be
 // removed recursively. In other words, if the cgroup has sub-cgroups inside,
@@ -364,6 +382,34 @@ process::Future<Nothing> destroy(
     const Duration& timeout);
 
 
+// Destroy multiple cgroups (and, recursively, their sub-cgroups)
+// under a given hierarchy in a single batch. Compared to calling the
+// single cgroup version in a loop this verifies the hierarchy only
+// once and uses a single destroyer for the whole batch, so all the
+// cgroups are frozen and their tasks killed in parallel and the
+// completion of the batch is awaited as one operation. This keeps
+// mass teardown (e.g., cleaning up the cgroups of many exited
+// containers after a failover) from issuing per-cgroup hierarchy
+// checks and destroyers.
+// NOTE: The given cgroups must not be nested within one another;
+// sub-cgroups are destroyed automatically.
+// @param   hierarchy   Path to the hierarchy root.
+// @param   cgroups     Paths to the cgroups relative to the hierarchy root.
+// @return  A future which will become ready when all cgroups have
+//          been destroyed, or failed if any of them could not be.
+process::Future<Nothing> destroy(
+    const std::string& hierarchy,
+    const std::vector<std::string>& cgroups);
+
+
+// Batch variant of the convenience function above which wraps the
+// batch cgroups::destroy() to add a timeout for the whole batch.
+process::Future<Nothing> destroy(
+    const std::string& hierarchy,
+    const std::vector<std::string>& cgroups,
+    const Duration& timeout);
+
+
 // Cleanup the hierarchy, by first destroying all the underlying
 // cgroups, unmounting the hierarchy and deleting the mount point.
 // @param   hierarchy Path to the hierarchy root.
@@ -386,6 +432,35 @@ Try<hashmap<std::string, uint64_t>> stat(
     const std::string& file);
 
 
+// Parses already read stat file contents, i.e., lines of
+// "<name> <value>" pairs.
+// @param   file        The name of the stat file (for error messages).
+// @param   contents    The contents of the stat file.
+// @return  The stat information parsed from the contents.
+//          Error if parsing fails.
+Try<hashmap<std::string, uint64_t>> stat(
+    const std::string& file,
+    const std::string& contents);
+
+
+// Reads multiple control files from the given cgroup in a single
+// pass, verifying the hierarchy and cgroup only once and reusing a
+// single buffer across the reads. This keeps the per-poll syscall
+// count down for resource monitoring, which reads several control
+// files per container per poll; issuing one cgroups::read() per
+// control re-verifies the hierarchy (including parsing /proc/mounts)
+// for every file.
+// @param   hierarchy   Path to the hierarchy root.
+// @param   cgroup      Path to the cgroup relative to the hierarchy root.
+// @param   controls    Names of the control files to read.
+// @return  The contents of each control file, keyed by control name.
+//          Error if the hierarchy or cgroup is invalid, or a read fails.
+Try<hashmap<std::string, std::string>> snapshot(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const std::vector<std::string>& controls);
+
+
 // Cpu controls.
 namespace cpu {
 
@@ -609,6 +684,14 @@ public:
   // should consider creating a new Counter.
   process::Future<uint64_t> value() const;
 
+  // Returns the accumulated number of occurrences of the pressure
+  // event once the next event arrives, i.e., the returned future
+  // remains pending until the kernel signals the pressure level
+  // again. This allows users to react to pressure events as they
+  // happen instead of polling 'value'. Fails under the same
+  // conditions as 'value'.
+  process::Future<uint64_t> next() const;
+
 private:
   Counter(const std::string& hierarchy,
           const std::string& cgroup,
@@ -637,6 +720,17 @@ process::Future<Nothing> freeze(
     const std::string& cgroup);
 
 
+// Freeze all processes in the given batch of cgroups. The whole
+// batch is written in one pass and the states are polled together,
+// sharing a single retry timer, so freezing many cgroups at once
+// (e.g., during a mass teardown) does not multiply freezer round
+// trips. The returned future becomes ready when every cgroup in the
+// batch is in the FROZEN state.
+process::Future<Nothing> freeze(
+    const std::string& hierarchy,
+    const std::vector<std::string>& cgroups);
+
+
 // Thaw all processes in the given cgroup. The cgroup must be in a freezer
 // hierarchy. This is a revert operation of freezer::freeze. This function will
 // return a future which will become ready when all processes have been thawed
@@ -645,6 +739,15 @@ process::Future<Nothing> thaw(
     const std::string& hierarchy,
     const std::string& cgroup);
 
+
+// Thaw all processes in the given batch of cgroups. This is a revert
+// operation of the batch freezer::freeze. The returned future
+// becomes ready when every cgroup in the batch is in the THAWED
+// state.
+process::Future<Nothing> thaw(
+    const std::string& hierarchy,
+    const std::vector<std::string>& cgroups);
+
 } // namespace freezer {
 
 } // namespace cgroups {
@@ -62,11 +62,9 @@ static const char PERF_DELIMITER[] = ",";
 
 namespace internal {
 
-// Normalize a perf event name. After normalization the event name
-// should match an event field in the PerfStatistics protobuf.
-inline string normalize(const string& s)
+string normalize(const string& event)
 {
-  string lower = strings::lower(s);
+  string lower = strings::lower(event);
   return strings::replace(lower, "-", "_");
 }
 
@@ -57,6 +57,15 @@ Try<hashmap<std::string, mesos::PerfStatistics>> parse(
     const std::string& output,
     const Version& version);
 
+
+namespace internal {
+
+// Normalize a perf event name. After normalization the event name
+// matches an event field in the PerfStatistics protobuf.
+std::string normalize(const std::string& event);
+
+} // namespace internal {
+
 } // namespace perf {
 
 #endif // __PERF_HPP__
@@ -0,0 +1,479 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include <linux/perf_event.h>
+
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/process.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include "linux/perf.hpp"
+#include "linux/perf_sampler.hpp"
+
+// Cgroup-scoped counters were introduced in Linux 2.6.39; older
+// kernel headers may not export the flag.
+#ifndef PERF_FLAG_PID_CGROUP
+#define PERF_FLAG_PID_CGROUP (1U << 2)
+#endif
+
+using namespace process;
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace perf {
+
+// The value layout requested with PERF_FORMAT_TOTAL_TIME_ENABLED and
+// PERF_FORMAT_TOTAL_TIME_RUNNING. The times let us scale counters
+// that were multiplexed by the kernel because more counters were
+// opened than the PMU can count concurrently.
+struct ReadFormat
+{
+  uint64_t value;
+  uint64_t enabled;
+  uint64_t running;
+};
+
+
+static int perfEventOpen(
+    struct perf_event_attr* attr,
+    pid_t pid,
+    int cpu,
+    int groupFd,
+    unsigned long flags)
+{
+  return ::syscall(SYS_perf_event_open, attr, pid, cpu, groupFd, flags);
+}
+
+
+// Returns the perf_event_attr for the given event name, or an error
+// if the event is not known. The names accepted here mirror the event
+// names understood by 'perf stat' for hardware, software and hardware
+// cache events.
+static Try<perf_event_attr> attribute(const string& event)
+{
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  attr.size = sizeof(attr);
+  attr.read_format =
+    PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  static const hashmap<string, uint64_t> hardware = {
+    {"cycles", PERF_COUNT_HW_CPU_CYCLES},
+    {"cpu-cycles", PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache-references", PERF_COUNT_HW_CACHE_REFERENCES},
+    {"cache-misses", PERF_COUNT_HW_CACHE_MISSES},
+    {"branches", PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {"branch-instructions", PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {"branch-misses", PERF_COUNT_HW_BRANCH_MISSES},
+    {"bus-cycles", PERF_COUNT_HW_BUS_CYCLES},
+    {"stalled-cycles-frontend", PERF_COUNT_HW_STALLED_CYCLES_FRONTEND},
+    {"stalled-cycles-backend", PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+    {"ref-cycles", PERF_COUNT_HW_REF_CPU_CYCLES},
+  };
+
+  if (hardware.contains(event)) {
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = hardware.at(event);
+    return attr;
+  }
+
+  static const hashmap<string, uint64_t> software = {
+    {"cpu-clock", PERF_COUNT_SW_CPU_CLOCK},
+    {"task-clock", PERF_COUNT_SW_TASK_CLOCK},
+    {"page-faults", PERF_COUNT_SW_PAGE_FAULTS},
+    {"faults", PERF_COUNT_SW_PAGE_FAULTS},
+    {"minor-faults", PERF_COUNT_SW_PAGE_FAULTS_MIN},
+    {"major-faults", PERF_COUNT_SW_PAGE_FAULTS_MAJ},
+    {"context-switches", PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {"cpu-migrations", PERF_COUNT_SW_CPU_MIGRATIONS},
+    {"alignment-faults", PERF_COUNT_SW_ALIGNMENT_FAULTS},
+    {"emulation-faults", PERF_COUNT_SW_EMULATION_FAULTS},
+  };
+
+  if (software.contains(event)) {
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = software.at(event);
+    return attr;
+  }
+
+  // Generic hardware cache events are composed from a cache, an
+  // operation and a result, e.g., 'L1-dcache-load-misses'.
+  static const hashmap<string, uint64_t> caches = {
+    {"L1-dcache", PERF_COUNT_HW_CACHE_L1D},
+    {"L1-icache", PERF_COUNT_HW_CACHE_L1I},
+    {"LLC", PERF_COUNT_HW_CACHE_LL},
+    {"dTLB", PERF_COUNT_HW_CACHE_DTLB},
+    {"iTLB", PERF_COUNT_HW_CACHE_ITLB},
+    {"branch", PERF_COUNT_HW_CACHE_BPU},
+    {"node", PERF_COUNT_HW_CACHE_NODE},
+  };
+
+  static const hashmap<string, uint64_t> operations = {
+    {"loads", PERF_COUNT_HW_CACHE_OP_READ |
+              (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 8)},
+    {"load-misses", PERF_COUNT_HW_CACHE_OP_READ |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 8)},
+    {"stores", PERF_COUNT_HW_CACHE_OP_WRITE |
+               (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 8)},
+    {"store-misses", PERF_COUNT_HW_CACHE_OP_WRITE |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 8)},
+    {"prefetches", PERF_COUNT_HW_CACHE_OP_PREFETCH |
+                   (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 8)},
+    {"prefetch-misses", PERF_COUNT_HW_CACHE_OP_PREFETCH |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 8)},
+  };
+
+  foreachpair (const string& cache, uint64_t config, caches) {
+    if (!strings::startsWith(event, cache + "-")) {
+      continue;
+    }
+
+    const string operation = event.substr(cache.size() + 1);
+
+    if (operations.contains(operation)) {
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = config | (operations.at(operation) << 8);
+      return attr;
+    }
+  }
+
+  return Error("Unsupported perf event '" + event + "'");
+}
+
+
+class SamplerProcess : public Process<SamplerProcess>
+{
+public:
+  struct Event
+  {
+    string name; // Normalized, i.e., a PerfStatistics field name.
+    perf_event_attr attr;
+  };
+
+  SamplerProcess(
+      const string& _hierarchy,
+      const vector<Event>& _events,
+      long _cpus)
+    : hierarchy(_hierarchy),
+      events(_events),
+      cpus(_cpus) {}
+
+  virtual ~SamplerProcess() {}
+
+  Future<hashmap<string, mesos::PerfStatistics>> sample(
+      const set<string>& cgroups,
+      const Duration& duration)
+  {
+    // Is this a no-op?
+    if (cgroups.empty()) {
+      return hashmap<string, mesos::PerfStatistics>();
+    }
+
+    Owned<Session> session(new Session());
+    session->start = Clock::now();
+    session->duration = duration;
+
+    foreach (const string& cgroup, cgroups) {
+      if (!open(session.get(), cgroup)) {
+        // The cgroup is likely being destroyed; drop it from this
+        // sample rather than failing the whole window.
+        close(session.get(), cgroup);
+      }
+    }
+
+    // Counters are opened disabled and all enabled together here so
+    // that every cgroup is measured over the same window.
+    foreach (const Counter& counter, session->counters) {
+      foreach (int fd, counter.fds) {
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+
+    delay(duration, self(), &Self::_sample, session);
+
+    return session->promise.future();
+  }
+
+private:
+  struct Counter
+  {
+    string cgroup;
+    string event; // Normalized event name.
+    vector<int> fds; // One counter per CPU.
+  };
+
+  struct Session
+  {
+    ~Session()
+    {
+      // Counters are still here if the sampler was terminated before
+      // the sample window elapsed.
+      foreach (const Counter& counter, counters) {
+        foreach (int fd, counter.fds) {
+          os::close(fd);
+        }
+      }
+    }
+
+    Time start;
+    Duration duration;
+    vector<Counter> counters;
+    Promise<hashmap<string, mesos::PerfStatistics>> promise;
+  };
+
+  // Opens the counters for all events for the given cgroup. Returns
+  // false if the cgroup or one of its counters could not be opened.
+  bool open(Session* session, const string& cgroup)
+  {
+    Try<int> cgroupFd =
+      os::open(path::join(hierarchy, cgroup), O_RDONLY | O_DIRECTORY);
+
+    if (cgroupFd.isError()) {
+      LOG(WARNING) << "Failed to open perf event cgroup '" << cgroup
+                   << "': " << cgroupFd.error();
+      return false;
+    }
+
+    bool opened = true;
+
+    foreach (const Event& event, events) {
+      Counter counter;
+      counter.cgroup = cgroup;
+      counter.event = event.name;
+
+      for (long cpu = 0; cpu < cpus; cpu++) {
+        perf_event_attr attr = event.attr;
+        attr.disabled = 1;
+
+        int fd = perfEventOpen(
+            &attr, cgroupFd.get(), cpu, -1, PERF_FLAG_PID_CGROUP);
+
+        if (fd == -1) {
+          PLOG(WARNING) << "Failed to open perf event '" << event.name
+                        << "' for cgroup '" << cgroup << "'";
+          opened = false;
+          break;
+        }
+
+        os::cloexec(fd);
+        counter.fds.push_back(fd);
+      }
+
+      session->counters.push_back(counter);
+
+      if (!opened) {
+        break;
+      }
+    }
+
+    os::close(cgroupFd.get());
+
+    return opened;
+  }
+
+  // Closes and removes all counters of the given cgroup.
+  void close(Session* session, const string& cgroup)
+  {
+    for (auto it = session->counters.begin();
+         it != session->counters.end(); ) {
+      if (it->cgroup == cgroup) {
+        foreach (int fd, it->fds) {
+          os::close(fd);
+        }
+
+        it = session->counters.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void _sample(const Owned<Session>& session)
+  {
+    hashmap<string, mesos::PerfStatistics> statistics;
+
+    Option<Error> error = None();
+
+    foreach (const Counter& counter, session->counters) {
+      double total = 0;
+
+      foreach (int fd, counter.fds) {
+        ReadFormat value;
+        memset(&value, 0, sizeof(value));
+
+        if (::read(fd, &value, sizeof(value)) !=
+            static_cast<ssize_t>(sizeof(value))) {
+          error = ErrnoError(
+              "Failed to read perf event '" + counter.event + "'");
+        } else if (value.running > 0) {
+          // Scale the counter if the kernel multiplexed it because
+          // more counters were opened than the hardware can count
+          // concurrently.
+          total += value.value *
+            (static_cast<double>(value.enabled) / value.running);
+        }
+
+        os::close(fd);
+      }
+
+      if (error.isSome()) {
+        continue;
+      }
+
+      if (!statistics.contains(counter.cgroup)) {
+        statistics.put(counter.cgroup, mesos::PerfStatistics());
+      }
+
+      const google::protobuf::Reflection* reflection =
+        statistics[counter.cgroup].GetReflection();
+      const google::protobuf::FieldDescriptor* field =
+        statistics[counter.cgroup].GetDescriptor()->FindFieldByName(
+            counter.event);
+
+      if (field == NULL) {
+        error = Error("Unexpected perf event '" + counter.event + "'");
+        continue;
+      }
+
+      switch (field->type()) {
+        case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
+          // The only double fields are the software clock events,
+          // which the kernel reports in nanoseconds but which are
+          // expressed in milliseconds (matching 'perf stat' output).
+          reflection->SetDouble(
+              &statistics[counter.cgroup], field, total / 1000000.0);
+          break;
+        case google::protobuf::FieldDescriptor::TYPE_UINT64:
+          reflection->SetUInt64(
+              &statistics[counter.cgroup],
+              field,
+              static_cast<uint64_t>(total));
+          break;
+        default:
+          error = Error(
+              "Unsupported field type for perf event '" +
+              counter.event + "'");
+          break;
+      }
+    }
+
+    // All file descriptors have been closed above.
+    session->counters.clear();
+
+    if (error.isSome()) {
+      session->promise.fail("Failed to sample perf events: " +
+                            error.get().message);
+      return;
+    }
+
+    foreachvalue (mesos::PerfStatistics& _statistics, statistics) {
+      _statistics.set_timestamp(session->start.secs());
+      _statistics.set_duration(session->duration.secs());
+    }
+
+    session->promise.set(statistics);
+  }
+
+  const string hierarchy;
+  const vector<Event> events;
+  const long cpus;
+};
+
+
+Try<Owned<Sampler>> Sampler::create(
+    const string& hierarchy,
+    const set<string>& events)
+{
+  Try<long> cpus = os::cpus();
+  if (cpus.isError()) {
+    return Error("Failed to determine the number of cpus: " + cpus.error());
+  }
+
+  vector<SamplerProcess::Event> descriptors;
+
+  foreach (const string& event, events) {
+    Try<perf_event_attr> attr = attribute(event);
+    if (attr.isError()) {
+      return Error(attr.error());
+    }
+
+    // Probe the event with a cpu-wide counter: this verifies both
+    // that the kernel knows the event and that we are permitted to
+    // monitor outside our own process, which cgroup counters require.
+    int fd = perfEventOpen(&attr.get(), -1, 0, -1, 0);
+    if (fd == -1) {
+      return ErrnoError("Failed to open perf event '" + event + "'");
+    }
+
+    os::close(fd);
+
+    descriptors.push_back({internal::normalize(event), attr.get()});
+  }
+
+  return Owned<Sampler>(new Sampler(Owned<SamplerProcess>(
+      new SamplerProcess(hierarchy, descriptors, cpus.get()))));
+}
+
+
+Sampler::Sampler(Owned<SamplerProcess> _process)
+  : process(_process)
+{
+  spawn(CHECK_NOTNULL(process.get()));
+}
+
+
+Sampler::~Sampler()
+{
+  terminate(process.get());
+  wait(process.get());
+}
+
+
+Future<hashmap<string, mesos::PerfStatistics>> Sampler::sample(
+    const set<string>& cgroups,
+    const Duration& duration)
+{
+  return dispatch(
+      process.get(), &SamplerProcess::sample, cgroups, duration);
+}
+
+} // namespace perf {
@@ -0,0 +1,79 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __PERF_SAMPLER_HPP__
+#define __PERF_SAMPLER_HPP__
+
+#include <set>
+#include <string>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/try.hpp>
+
+// For PerfStatistics protobuf.
+#include "mesos/mesos.hpp"
+
+namespace perf {
+
+// Forward declaration.
+class SamplerProcess;
+
+
+// In-process perf sampler based on perf_event_open(2). Unlike
+// perf::sample, which forks the 'perf' binary per sample window and
+// parses its text output, the sampler opens one counter per (event,
+// cgroup, cpu) tuple up front and reads the counter values directly
+// from the kernel once the sample window elapses, so a sample incurs
+// no subprocess and no text parsing at all.
+class Sampler
+{
+public:
+  // Creates a sampler for the given perf events. Cgroups passed to
+  // sample() are relative to the given perf_event hierarchy root.
+  // Fails if an event is not supported by this kernel or if opening
+  // counters is not permitted (see perf_event_paranoid in
+  // Documentation/sysctl/kernel.txt).
+  static Try<process::Owned<Sampler>> create(
+      const std::string& hierarchy,
+      const std::set<std::string>& events);
+
+  ~Sampler();
+
+  // Samples the events for all processes in each cgroup over the
+  // duration. The returned hashmap is keyed by cgroup, mirroring
+  // perf::sample. Cgroups that disappear while the counters are
+  // opened (e.g., because the container is being destroyed) are
+  // dropped from the result.
+  process::Future<hashmap<std::string, mesos::PerfStatistics>> sample(
+      const std::set<std::string>& cgroups,
+      const Duration& duration);
+
+private:
+  explicit Sampler(process::Owned<SamplerProcess> process);
+
+  Sampler(const Sampler&) = delete; // Not copyable.
+  Sampler& operator=(const Sampler&) = delete; // Not assignable.
+
+  process::Owned<SamplerProcess> process;
+};
+
+} // namespace perf {
+
+#endif // __PERF_SAMPLER_HPP__
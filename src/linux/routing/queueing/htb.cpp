@@ -16,15 +16,21 @@
 
 #include <netlink/errno.h>
 
+#include <netlink/route/class.h>
 #include <netlink/route/qdisc.h>
 #include <netlink/route/tc.h>
 
+#include <netlink/route/qdisc/htb.h>
+
 #include <stout/error.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 #include <stout/result.hpp>
 
 #include "linux/routing/handle.hpp"
+#include "linux/routing/internal.hpp"
+
+#include "linux/routing/link/internal.hpp"
 
 #include "linux/routing/queueing/htb.hpp"
 #include "linux/routing/queueing/internal.hpp"
@@ -34,15 +40,6 @@ using std::string;
 namespace routing {
 namespace queueing {
 
-namespace htb {
-
-// TODO(cwang): The htb queueing discipline configuration is not
-// exposed to the user because we use all the default parameters
-// currently.
-struct Config {};
-
-} // namespace htb {
-
 /////////////////////////////////////////////////
 // Type specific {en}decoding functions.
 /////////////////////////////////////////////////
@@ -57,6 +54,10 @@ Try<Nothing> encode<htb::Config>(
     const Netlink<struct rtnl_qdisc>& qdisc,
     const htb::Config& config)
 {
+  if (config.defcls.isSome()) {
+    rtnl_htb_set_defcls(qdisc.get(), config.defcls.get());
+  }
+
   return Nothing();
 }
 
@@ -73,6 +74,9 @@ Result<htb::Config> decode<htb::Config>(
     return None();
   }
 
+  // NOTE: We do not decode the default class of the queueing
+  // discipline because libnl does not expose a getter for it on all
+  // the versions we support.
   return htb::Config();
 }
 
@@ -94,6 +98,16 @@ Try<bool> create(
     const string& link,
     const Handle& parent,
     const Option<Handle>& handle)
+{
+  return create(link, parent, handle, Config());
+}
+
+
+Try<bool> create(
+    const string& link,
+    const Handle& parent,
+    const Option<Handle>& handle,
+    const Config& config)
 {
   return internal::create(
       link,
@@ -101,7 +115,7 @@ Try<bool> create(
           KIND,
           parent,
           handle,
-          Config()));
+          config));
 }
 
 
@@ -119,6 +133,64 @@ Result<hashmap<string, uint64_t>> statistics(
 }
 
 
+namespace cls {
+
+Try<bool> create(
+    const string& link,
+    const Handle& parent,
+    const Handle& handle,
+    const Config& config)
+{
+  Result<Netlink<struct rtnl_link>> _link = link::internal::get(link);
+  if (_link.isError()) {
+    return Error(_link.error());
+  } else if (_link.isNone()) {
+    return Error("Link '" + link + "' is not found");
+  }
+
+  Try<Netlink<struct nl_sock>> socket = routing::socket();
+  if (socket.isError()) {
+    return Error(socket.error());
+  }
+
+  struct rtnl_class* c = rtnl_class_alloc();
+  if (c == NULL) {
+    return Error("Failed to allocate an htb class");
+  }
+
+  Netlink<struct rtnl_class> htbClass(c);
+
+  rtnl_tc_set_link(TC_CAST(htbClass.get()), _link.get().get());
+  rtnl_tc_set_parent(TC_CAST(htbClass.get()), parent.get());
+  rtnl_tc_set_handle(TC_CAST(htbClass.get()), handle.get());
+
+  int error = rtnl_tc_set_kind(TC_CAST(htbClass.get()), KIND);
+  if (error != 0) {
+    return Error(
+        "Failed to set the kind of the htb class: " +
+        string(nl_geterror(error)));
+  }
+
+  // NOTE: The rate in libnl is in bytes per second.
+  rtnl_htb_set_rate(htbClass.get(), (uint32_t) config.rate);
+
+  error = rtnl_class_add(
+      socket.get().get(),
+      htbClass.get(),
+      NLM_F_CREATE | NLM_F_EXCL);
+
+  if (error != 0) {
+    if (error == -NLE_EXIST) {
+      return false;
+    }
+    return Error(string(nl_geterror(error)));
+  }
+
+  return true;
+}
+
+} // namespace cls {
+
 } // namespace htb {
 } // namespace queueing {
 } // namespace routing {
@@ -22,6 +22,7 @@
 #include <string>
 
 #include <stout/hashmap.hpp>
+#include <stout/option.hpp>
 #include <stout/try.hpp>
 
 #include "linux/routing/handle.hpp"
@@ -32,6 +33,17 @@ namespace htb {
 
 constexpr char KIND[] = "htb";
 
+
+// The configuration for an htb queueing discipline. All other
+// parameters use the libnl defaults.
+struct Config
+{
+  // The default class (minor handle) to which unclassified traffic
+  // is sent. If not specified, unclassified traffic bypasses all
+  // classes attached to this queueing discipline.
+  Option<uint16_t> defcls;
+};
+
 // Returns true if there exists an htb queueing discipline on the
 // egress side of the link.
 Try<bool> exists(
@@ -48,6 +60,16 @@ Try<bool> create(
     const Option<Handle>& handle);
 
 
+// Creates a new htb queueing discipline with the given configuration
+// on the egress side of the link. Returns false if a queueing
+// discipline already exists which prevents the creation.
+Try<bool> create(
+    const std::string& link,
+    const Handle& parent,
+    const Option<Handle>& handle,
+    const Config& config);
+
+
 // Removes the htb queueing discipline from the link. Returns
 // false if the htb queueing discipline is not found.
 Try<bool> remove(
@@ -64,6 +86,31 @@ Result<hashmap<std::string, uint64_t>> statistics(
     const Handle& parent);
 
 
+namespace cls {
+
+// The configuration for an htb traffic class.
+struct Config
+{
+  explicit Config(uint64_t _rate) : rate(_rate) {}
+
+  // The maximum rate (in bytes per second) at which this class is
+  // allowed to send.
+  uint64_t rate;
+};
+
+
+// Creates an htb traffic class with the given configuration under
+// the given parent (either an htb queueing discipline or another htb
+// class) on the egress side of the link. Returns false if the class
+// already exists.
+Try<bool> create(
+    const std::string& link,
+    const Handle& parent,
+    const Handle& handle,
+    const Config& config);
+
+} // namespace cls {
+
 } // namespace htb {
 } // namespace queueing {
 } // namespace routing {
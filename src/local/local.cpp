@@ -205,7 +205,9 @@ PID<Master> launch(const Flags& flags, Allocator* _allocator)
 
     CHECK_NOTNULL(storage);
 
-    state = new state::protobuf::State(storage);
+    // Enable caching for the registrar's fetch-mutate-store loop,
+    // mirroring the full master (see master/main.cpp).
+    state = new state::protobuf::State(storage, true);
     registrar = new Registrar(flags, state);
     repairer = new Repairer();
 
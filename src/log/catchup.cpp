@@ -16,11 +16,14 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <list>
+#include <set>
 
 #include <process/collect.hpp>
 #include <process/id.hpp>
 #include <process/process.hpp>
+#include <process/protobuf.hpp>
 #include <process/timer.hpp>
 
 #include <stout/lambda.hpp>
@@ -28,12 +31,14 @@
 
 #include "log/catchup.hpp"
 #include "log/consensus.hpp"
+#include "log/replica.hpp"
 
 #include "messages/log.hpp"
 
 using namespace process;
 
 using std::list;
+using std::set;
 
 namespace mesos {
 namespace internal {
@@ -165,10 +170,22 @@ static Future<uint64_t> catchup(
 }
 
 
-// TODO(jieyu): Our current implementation catches-up each position in
-// the set sequentially. In the future, we may want to parallelize it
-// to improve the performance. Also, we may want to implement rate
-// control here so that we don't saturate the network or disk.
+// The number of positions requested from the other replicas in a
+// single bulk read during catch-up. Bigger batches amortize the
+// network round trip and the local disk sync (the replica group
+// commits all the learned actions of a batch) over more positions.
+static const uint64_t BULK_CATCHUP_BATCH_SIZE = 1024;
+
+
+// Catches-up a range of positions by first copying learned actions
+// in bulk from the other replicas (a sequential, disk/network
+// bandwidth bound transfer) and then running a consensus round for
+// each position that is still missing (e.g., unlearned everywhere).
+// The bulk phase is best-effort: any position it does not obtain is
+// simply handled by the consensus phase, which skips positions that
+// are no longer missing locally.
+// TODO(jieyu): We may want to implement rate control here so that we
+// don't saturate the network or disk.
 class BulkCatchUpProcess : public Process<BulkCatchUpProcess>
 {
 public:
@@ -198,15 +215,16 @@ protected:
     promise.future().onDiscard(lambda::bind(
         static_cast<void(*)(const UPID&, bool)>(terminate), self(), true));
 
-    // Catch-up sequentially.
+    // Start with the bulk copy phase.
     current = positions.lower();
 
-    catchup();
+    copy();
   }
 
   virtual void finalize()
   {
     catching.discard();
+    copying.discard();
 
     // TODO(benh): Discard our promise only after 'catching' has
     // completed (ready, failed, or discarded).
@@ -219,6 +237,86 @@ private:
     catching.discard();
   }
 
+  static void expired(Future<list<Future<ReadResponse> > > copying)
+  {
+    copying.discard();
+  }
+
+  void copy()
+  {
+    if (current >= positions.upper()) {
+      // Done with the bulk copy phase: run the consensus phase over
+      // the whole interval to fill whatever is still missing.
+      current = positions.lower();
+      catchup();
+      return;
+    }
+
+    ReadRequest request;
+    request.set_from(current);
+    request.set_to(
+        std::min(current + BULK_CATCHUP_BATCH_SIZE, positions.upper()) - 1);
+
+    current = request.to() + 1;
+
+    network->broadcast(protocol::read, request)
+      .onAny(defer(self(), &Self::broadcasted, lambda::_1));
+  }
+
+  void broadcasted(const Future<set<Future<ReadResponse> > >& future)
+  {
+    if (!future.isReady()) {
+      LOG(WARNING)
+        << "Failed to broadcast a bulk read request"
+        << (future.isFailed() ? ": " + future.failure() : "")
+        << "; falling back to per-position catch-up";
+
+      current = positions.lower();
+      catchup();
+      return;
+    }
+
+    copying = await(
+        list<Future<ReadResponse> >(future.get().begin(), future.get().end()));
+
+    copying.onAny(defer(self(), &Self::copied));
+
+    // Don't wait forever for unresponsive replicas; positions that
+    // don't get copied are handled by the consensus phase anyway.
+    Clock::timer(timeout, lambda::bind(&Self::expired, copying));
+  }
+
+  void copied()
+  {
+    size_t count = 0;
+
+    if (copying.isReady()) {
+      foreach (const Future<ReadResponse>& response, copying.get()) {
+        if (!response.isReady()) {
+          continue;
+        }
+
+        foreach (const Action& action, response.get().actions()) {
+          CHECK(action.has_learned() && action.learned());
+
+          // Write the learned action to the local replica. Note that
+          // the replica group commits these writes, so the whole
+          // batch only pays for a single disk sync.
+          LearnedMessage message;
+          message.mutable_action()->CopyFrom(action);
+
+          post(replica->pid(), message);
+
+          count++;
+        }
+      }
+    }
+
+    VLOG(1) << "Copied " << count << " learned actions in bulk";
+
+    copy();
+  }
+
   void catchup()
   {
     if (current >= positions.upper()) {
@@ -282,6 +380,7 @@ private:
 
   process::Promise<Nothing> promise;
   Future<uint64_t> catching;
+  Future<list<Future<ReadResponse> > > copying;
 };
 
 
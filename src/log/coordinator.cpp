@@ -17,14 +17,18 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <list>
 
 #include <mesos/type_utils.hpp>
 
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
 
 #include "log/catchup.hpp"
@@ -41,6 +45,14 @@ namespace mesos {
 namespace internal {
 namespace log {
 
+// The maximum number of positions that may have their write (and
+// learn) phases running concurrently. Since an elected coordinator
+// has implicitly promised all positions, each write is just a single
+// phase-2 round, so pipelining them overlaps the network round trips
+// instead of paying one full round trip per position.
+static const size_t MAX_PIPELINED_WRITES = 10;
+
+
 class CoordinatorProcess : public Process<CoordinatorProcess>
 {
 public:
@@ -54,7 +66,8 @@ public:
       network(_network),
       state(INITIAL),
       proposal(0),
-      index(0) {}
+      index(0),
+      epoch(0) {}
 
   virtual ~CoordinatorProcess() {}
 
@@ -68,7 +81,14 @@ protected:
   virtual void finalize()
   {
     electing.discard();
-    writing.discard();
+
+    foreachvalue (Future<Option<uint64_t> > writing, writings) {
+      writing.discard();
+    }
+
+    foreach (const Pending& pending, pendings) {
+      pending.promise->discard();
+    }
   }
 
 private:
@@ -92,6 +112,7 @@ private:
   // Writing related functions.  //
   /////////////////////////////////
 
+  Future<Option<uint64_t> > submit(const Action& action);
   Future<Option<uint64_t> > write(const Action& action);
   Future<WriteResponse> runWritePhase(const Action& action);
   Future<Option<uint64_t> > checkWritePhase(
@@ -99,10 +120,17 @@ private:
       const WriteResponse& response);
   Future<Nothing> runLearnPhase(const Action& action);
   Future<bool> checkLearnPhase(const Action& action);
-  Future<Option<uint64_t> > updateIndexAfterWritten(bool missing);
-  void writingFinished();
-  void writingFailed();
-  void writingAborted();
+  Future<Option<uint64_t> > updateIndexAfterWritten(
+      const Action& action,
+      bool missing);
+  void writingFinished(
+      uint64_t epoch,
+      uint64_t position,
+      const Option<uint64_t>& result);
+  void writingFailed(uint64_t epoch, uint64_t position);
+  void writingAborted(uint64_t epoch, uint64_t position);
+  void writingDemoted();
+  void writingContinue();
 
   const size_t quorum;
   const Shared<Replica> replica;
@@ -115,7 +143,8 @@ private:
   // coordinator does not declare itself as elected until it wins the
   // election and has filled all existing positions. A coordinator is
   // put in electing state after it decides to go for an election and
-  // before it is elected.
+  // before it is elected. A coordinator is in writing state while
+  // one or more (pipelined) writes are in flight.
   enum
   {
     INITIAL,
@@ -127,11 +156,39 @@ private:
   // The current proposal number used by this coordinator.
   uint64_t proposal;
 
-  // The position to which the next entry will be written.
+  // The position to which the next entry will be written. Note that
+  // positions are assigned when a write is submitted, not when it
+  // completes, so that multiple positions can be in flight at once.
   uint64_t index;
 
+  // Incremented whenever the in-flight writes of a reign are
+  // invalidated (i.e., on demotion). The write callbacks carry the
+  // epoch they were started in, so a late completion from a previous
+  // reign cannot erase or demote the pipeline state of a
+  // subsequently elected coordinator reusing the same positions.
+  uint64_t epoch;
+
+  // Represents a write that is waiting for the pipeline window to
+  // have room. Its position has already been assigned (writes must
+  // be started in position order).
+  struct Pending
+  {
+    explicit Pending(const Action& _action)
+      : action(_action),
+        promise(new Promise<Option<uint64_t> >()) {}
+
+    Action action;
+    Owned<Promise<Option<uint64_t> > > promise;
+  };
+
   Future<Option<uint64_t> > electing;
-  Future<Option<uint64_t> > writing;
+
+  // In-flight writes indexed by position. At most
+  // MAX_PIPELINED_WRITES writes run their write/learn phases
+  // concurrently; the rest wait in 'pendings'.
+  hashmap<uint64_t, Future<Option<uint64_t> > > writings;
+
+  std::list<Pending> pendings;
 };
 
 
@@ -307,19 +364,21 @@ Future<Option<uint64_t> > CoordinatorProcess::append(const string& bytes)
 {
   if (state == INITIAL || state == ELECTING) {
     return None();
-  } else if (state == WRITING) {
-    return Failure("Coordinator is currently writing");
   }
 
+  // NOTE: Unlike elect/demote, writes are allowed while the
+  // coordinator is already writing: they get pipelined (or queued if
+  // the pipeline window is full). The position is assigned here so
+  // concurrent writes go to consecutive positions.
   Action action;
-  action.set_position(index);
+  action.set_position(index++);
   action.set_promised(proposal);
   action.set_performed(proposal);
   action.set_type(Action::APPEND);
   Action::Append* append = action.mutable_append();
   append->set_bytes(bytes);
 
-  return write(action);
+  return submit(action);
 }
 
 
@@ -327,18 +386,27 @@ Future<Option<uint64_t> > CoordinatorProcess::truncate(uint64_t to)
 {
   if (state == INITIAL || state == ELECTING) {
     return None();
-  } else if (state == WRITING) {
-    return Failure("Coordinator is currently writing");
   }
 
   Action action;
-  action.set_position(index);
+  action.set_position(index++);
   action.set_promised(proposal);
   action.set_performed(proposal);
   action.set_type(Action::TRUNCATE);
   Action::Truncate* truncate = action.mutable_truncate();
   truncate->set_to(to);
 
+  return submit(action);
+}
+
+
+Future<Option<uint64_t> > CoordinatorProcess::submit(const Action& action)
+{
+  if (writings.size() >= MAX_PIPELINED_WRITES) {
+    pendings.push_back(Pending(action));
+    return pendings.back().promise->future();
+  }
+
   return write(action);
 }
 
@@ -348,16 +416,21 @@ Future<Option<uint64_t> > CoordinatorProcess::write(const Action& action)
   LOG(INFO) << "Coordinator attempting to write " << action.type()
             << " action at position " << action.position();
 
-  CHECK_EQ(state, ELECTED);
+  CHECK(state == ELECTED || state == WRITING) << "Unexpected state";
   CHECK(action.has_performed() && action.has_type());
 
   state = WRITING;
 
-  writing = runWritePhase(action)
-    .then(defer(self(), &Self::checkWritePhase, action, lambda::_1))
-    .onReady(defer(self(), &Self::writingFinished))
-    .onFailed(defer(self(), &Self::writingFailed))
-    .onDiscarded(defer(self(), &Self::writingAborted));
+  Future<Option<uint64_t> > writing = runWritePhase(action)
+    .then(defer(self(), &Self::checkWritePhase, action, lambda::_1));
+
+  writings[action.position()] = writing;
+
+  writing
+    .onReady(defer(
+        self(), &Self::writingFinished, epoch, action.position(), lambda::_1))
+    .onFailed(defer(self(), &Self::writingFailed, epoch, action.position()))
+    .onDiscarded(defer(self(), &Self::writingAborted, epoch, action.position()));
 
   return writing;
 }
@@ -383,7 +456,7 @@ Future<Option<uint64_t> > CoordinatorProcess::checkWritePhase(
 
   return runLearnPhase(action)
     .then(defer(self(), &Self::checkLearnPhase, action))
-    .then(defer(self(), &Self::updateIndexAfterWritten, lambda::_1));
+    .then(defer(self(), &Self::updateIndexAfterWritten, action, lambda::_1));
 }
 
 
@@ -403,38 +476,117 @@ Future<bool> CoordinatorProcess::checkLearnPhase(const Action& action)
 
 
 Future<Option<uint64_t> > CoordinatorProcess::updateIndexAfterWritten(
+    const Action& action,
     bool missing)
 {
   CHECK(!missing) << "Not expecting local replica to be missing position "
-                  << index << " after the writing is done";
+                  << action.position() << " after the writing is done";
 
-  return index++;
+  // NOTE: 'index' was already advanced when the write was submitted.
+  return Option<uint64_t>(action.position());
 }
 
 
-void CoordinatorProcess::writingFinished()
+void CoordinatorProcess::writingFinished(
+    uint64_t epoch,
+    uint64_t position,
+    const Option<uint64_t>& result)
 {
-  CHECK_EQ(state, WRITING);
-  state = ELECTED;
+  // Ignore late completions of writes from a previous reign; their
+  // pipeline state was already discarded on demotion.
+  if (epoch != this->epoch) {
+    return;
+  }
+
+  writings.erase(position);
+
+  if (result.isNone()) {
+    // Received a NACK. The position was consumed but not learned, so
+    // subsequent pipelined positions can no longer be trusted: the
+    // coordinator needs to be re-elected (which will fill any holes,
+    // e.g., with NOPs, during catch-up).
+    writingDemoted();
+  } else if (state == WRITING) {
+    writingContinue();
+  }
 }
 
 
-void CoordinatorProcess::writingFailed()
+void CoordinatorProcess::writingFailed(uint64_t epoch, uint64_t position)
 {
-  CHECK_EQ(state, WRITING);
-  state = INITIAL;
+  // See the comment in 'writingFinished'.
+  if (epoch != this->epoch) {
+    return;
+  }
+
+  writings.erase(position);
+  writingDemoted();
 }
 
 
-void CoordinatorProcess::writingAborted()
+void CoordinatorProcess::writingAborted(uint64_t epoch, uint64_t position)
 {
-  CHECK_EQ(state, WRITING);
+  // See the comment in 'writingFinished'.
+  if (epoch != this->epoch) {
+    return;
+  }
+
+  writings.erase(position);
 
   // Demote the coordinator if a write operation is discarded since we
   // don't actually know the write was successful or not and we really
   // need to "catch-up" that position before we try and do another
   // write (see MESOS-1038 for more details).
+  writingDemoted();
+}
+
+
+void CoordinatorProcess::writingDemoted()
+{
+  // Ignore late completions of writes that were in flight when the
+  // coordinator got demoted (e.g., a new election may have already
+  // been started).
+  if (state != WRITING) {
+    return;
+  }
+
   state = INITIAL;
+
+  // Invalidate the rest of the reign's pipeline: discard the other
+  // in-flight writes and bump the epoch so that their late
+  // completions (which will NACK against the higher promise of the
+  // next reign) cannot touch the pipeline state of a subsequently
+  // elected coordinator reusing the same positions.
+  epoch++;
+
+  foreachvalue (Future<Option<uint64_t> > writing, writings) {
+    writing.discard();
+  }
+  writings.clear();
+
+  // Don't bother starting the queued writes: signal them with 'none'
+  // so that their callers re-elect the coordinator and retry.
+  while (!pendings.empty()) {
+    pendings.front().promise->set(Option<uint64_t>::none());
+    pendings.pop_front();
+  }
+}
+
+
+void CoordinatorProcess::writingContinue()
+{
+  CHECK_EQ(state, WRITING);
+
+  // Fill up the pipeline window with queued writes.
+  while (!pendings.empty() && writings.size() < MAX_PIPELINED_WRITES) {
+    Pending pending = pendings.front();
+    pendings.pop_front();
+    pending.promise->associate(write(pending.action));
+  }
+
+  if (writings.empty() && pendings.empty()) {
+    state = ELECTED;
+  }
 }
 
 
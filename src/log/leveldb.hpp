@@ -21,6 +21,8 @@
 
 #include <stdint.h>
 
+#include <list>
+
 #include <stout/option.hpp>
 
 #include "log/storage.hpp"
@@ -39,9 +41,14 @@ public:
   virtual Try<State> restore(const std::string& path);
   virtual Try<Nothing> persist(const Metadata& metadata);
   virtual Try<Nothing> persist(const Action& action);
+  virtual Try<Nothing> persist(const std::list<Action>& actions);
   virtual Try<Action> read(uint64_t position);
 
 private:
+  // Attempts to delete positions no longer in the log if the
+  // specified action is a *learned* truncation.
+  void truncate(const Action& action);
+
   leveldb::DB* db;
 
   // First position still in leveldb, used during truncation.
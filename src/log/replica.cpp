@@ -17,18 +17,24 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <list>
+#include <vector>
 
 #include <mesos/type_utils.hpp>
 
+#include <process/delay.hpp>
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
 
 #include <stout/check.hpp>
+#include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/exit.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/try.hpp>
 #include <stout/utils.hpp>
@@ -46,11 +52,17 @@ namespace mesos {
 namespace internal {
 namespace log {
 
+// Number of slots in the position-keyed cache of recently learned
+// actions (see 'ReplicaProcess::learnedCache').
+static const size_t LEARNED_CACHE_SIZE = 1024;
+
+
 namespace protocol {
 
 // Some replica protocol definitions.
 Protocol<PromiseRequest, PromiseResponse> promise;
 Protocol<WriteRequest, WriteResponse> write;
+Protocol<ReadRequest, ReadResponse> read;
 Protocol<RecoverRequest, RecoverResponse> recover;
 
 } // namespace protocol {
@@ -109,15 +121,40 @@ private:
   // Handles a request from a proposer to write an action.
   void write(const UPID& from, const WriteRequest& request);
 
+  // Handles a request to read the learned actions within a range
+  // (used by lagging replicas to catch-up in bulk).
+  void read(const UPID& from, const ReadRequest& request);
+
   // Handles a request from a recover process.
   void recover(const UPID& from, const RecoverRequest& request);
 
   // Handles a message notifying of a learned action.
   void learned(const UPID& from, const Action& action);
 
-  // Persists the specified action to storage. Returns true on success
-  // and false otherwise.
-  bool persist(const Action& action);
+  // Queues the specified action for persistence to storage, along
+  // with an optional response to send back to 'from' once the action
+  // is durable, and schedules a flush. All actions queued before the
+  // flush event gets dequeued are persisted with a single disk sync
+  // (i.e., group commit), which amortizes the cost of an fsync
+  // across write bursts.
+  void persist(const Action& action);
+  void persist(
+      const UPID& from,
+      const Action& action,
+      const PromiseResponse& response);
+  void persist(
+      const UPID& from,
+      const Action& action,
+      const WriteResponse& response);
+
+  // Persists all the queued actions with a single disk sync and
+  // sends the associated responses.
+  void flush();
+
+  // Helper that queues a pending action, eagerly updates the
+  // in-memory state and schedules a flush if needed.
+  struct Pending;
+  void _persist(const Pending& pending);
 
   // Updates the highest promise this replica has given. The update
   // will be persisted to storage. Returns true on success and false
@@ -145,13 +182,49 @@ private:
 
   // Unlearned positions in the log.
   IntervalSet<uint64_t> unlearned;
+
+  // Represents an accepted action that has not yet been persisted to
+  // storage, along with the response (if any) to send back once it
+  // has been.
+  struct Pending
+  {
+    explicit Pending(const Action& _action) : action(_action) {}
+
+    Action action;
+    Option<UPID> from;
+    Option<PromiseResponse> promiseResponse;
+    Option<WriteResponse> writeResponse;
+  };
+
+  // Accepted actions waiting to be flushed, in acceptance order.
+  std::list<Pending> pendings;
+
+  // The last accepted but not yet flushed action for each position,
+  // so that reads observe accepted actions immediately. Note that
+  // the in-memory state (holes, unlearned, begin, end) is updated
+  // eagerly when an action gets accepted; only the disk write and
+  // the response are deferred until the flush.
+  hashmap<uint64_t, Action> accepted;
+
+  // A bounded, position-keyed cache of recently learned actions, so
+  // that reads of the hot tail of the log (e.g., a registrar fetch
+  // right after a store, or a coordinator catching up) skip the
+  // storage read and record deserialization. The action at position
+  // p lives in slot p % LEARNED_CACHE_SIZE and is valid only if it
+  // is for exactly that position, so newer positions simply evict
+  // older ones. Only learned actions are cached: once learned, the
+  // action at a position can never change (writes to learned
+  // positions are ignored, see the write handler), whereas accepted
+  // but unlearned actions may still be overwritten.
+  std::vector<Option<Action>> learnedCache;
 };
 
 
 ReplicaProcess::ReplicaProcess(const string& path)
   : ProcessBase(ID::generate("log-replica")),
     begin(0),
-    end(0)
+    end(0),
+    learnedCache(LEARNED_CACHE_SIZE)
 {
   // TODO(benh): Factor out and expose storage.
   storage = new LevelDBStorage();
@@ -165,6 +238,9 @@ ReplicaProcess::ReplicaProcess(const string& path)
   install<WriteRequest>(
       &ReplicaProcess::write);
 
+  install<ReadRequest>(
+      &ReplicaProcess::read);
+
   install<RecoverRequest>(
       &ReplicaProcess::recover);
 
@@ -190,6 +266,18 @@ Result<Action> ReplicaProcess::read(uint64_t position)
     return None();
   }
 
+  // Check accepted but not yet flushed actions first so that reads
+  // observe them just as if they had already been persisted.
+  if (accepted.contains(position)) {
+    return accepted.get(position).get();
+  }
+
+  // Serve recently learned actions from memory.
+  const Option<Action>& cached = learnedCache[position % LEARNED_CACHE_SIZE];
+  if (cached.isSome() && cached.get().position() == position) {
+    return cached.get();
+  }
+
   // Must exist in storage ...
   Try<Action> action = storage->read(position);
 
@@ -197,6 +285,12 @@ Result<Action> ReplicaProcess::read(uint64_t position)
     return Error(action.error());
   }
 
+  // Memoize learned actions so that subsequent reads of this
+  // position (e.g., additional catch-up rounds) stay in memory.
+  if (action.get().has_learned() && action.get().learned()) {
+    learnedCache[position % LEARNED_CACHE_SIZE] = action.get();
+  }
+
   return action.get();
 }
 
@@ -455,14 +549,13 @@ void ReplicaProcess::promise(const UPID& from, const PromiseRequest& request)
         action.set_position(request.position());
         action.set_promised(request.proposal());
 
-        if (persist(action)) {
-          PromiseResponse response;
-          response.set_type(PromiseResponse::ACCEPT);
-          response.set_okay(true);
-          response.set_proposal(request.proposal());
-          response.set_position(request.position());
-          reply(response);
-        }
+        PromiseResponse response;
+        response.set_type(PromiseResponse::ACCEPT);
+        response.set_okay(true);
+        response.set_proposal(request.proposal());
+        response.set_position(request.position());
+
+        persist(from, action, response);
       }
     } else {
       CHECK_SOME(result);
@@ -479,14 +572,13 @@ void ReplicaProcess::promise(const UPID& from, const PromiseRequest& request)
         Action original = action;
         action.set_promised(request.proposal());
 
-        if (persist(action)) {
-          PromiseResponse response;
-          response.set_type(PromiseResponse::ACCEPT);
-          response.set_okay(true);
-          response.set_proposal(request.proposal());
-          response.mutable_action()->MergeFrom(original);
-          reply(response);
-        }
+        PromiseResponse response;
+        response.set_type(PromiseResponse::ACCEPT);
+        response.set_okay(true);
+        response.set_proposal(request.proposal());
+        response.mutable_action()->MergeFrom(original);
+
+        persist(from, action, response);
       }
     }
   } else {
@@ -575,14 +667,13 @@ void ReplicaProcess::write(const UPID& from, const WriteRequest& request)
           LOG(FATAL) << "Unknown Action::Type!";
       }
 
-      if (persist(action)) {
-        WriteResponse response;
-        response.set_type(WriteResponse::ACCEPT);
-        response.set_okay(true);
-        response.set_proposal(request.proposal());
-        response.set_position(request.position());
-        reply(response);
-      }
+      WriteResponse response;
+      response.set_type(WriteResponse::ACCEPT);
+      response.set_okay(true);
+      response.set_proposal(request.proposal());
+      response.set_position(request.position());
+
+      persist(from, action, response);
     }
   } else if (result.isSome()) {
     Action action = result.get();
@@ -654,20 +745,57 @@ void ReplicaProcess::write(const UPID& from, const WriteRequest& request)
             LOG(FATAL) << "Unknown Action::Type!";
         }
 
-        if (persist(action)) {
-          WriteResponse response;
-          response.set_type(WriteResponse::ACCEPT);
-          response.set_okay(true);
-          response.set_proposal(request.proposal());
-          response.set_position(request.position());
-          reply(response);
-        }
+        WriteResponse response;
+        response.set_type(WriteResponse::ACCEPT);
+        response.set_okay(true);
+        response.set_proposal(request.proposal());
+        response.set_position(request.position());
+
+        persist(from, action, response);
       }
     }
   }
 }
 
 
+void ReplicaProcess::read(const UPID& from, const ReadRequest& request)
+{
+  LOG(INFO) << "Replica received a read request for positions "
+            << request.from() << " -> " << request.to()
+            << " from " << from;
+
+  ReadResponse response;
+
+  // Clip the requested range to the range of our log and only
+  // include *learned* actions: an unlearned action may not reflect
+  // consensus, so the requester needs to use a consensus round for
+  // any position we omit. Positions below 'begin' are omitted too;
+  // the requester will discover the truncation when it catches up
+  // the truncate action itself.
+  uint64_t from_ = std::max(request.from(), begin);
+  uint64_t to_ = std::min(request.to(), end);
+
+  for (uint64_t position = from_; position <= to_; position++) {
+    if (holes.contains(position) || unlearned.contains(position)) {
+      continue;
+    }
+
+    Result<Action> result = read(position);
+
+    if (result.isError()) {
+      LOG(ERROR) << "Error getting log record at " << position
+                 << ": " << result.error();
+    } else if (result.isSome() &&
+               result.get().has_learned() &&
+               result.get().learned()) {
+      response.add_actions()->CopyFrom(result.get());
+    }
+  }
+
+  reply(response);
+}
+
+
 void ReplicaProcess::recover(const UPID& from, const RecoverRequest& request)
 {
   LOG(INFO) << "Replica in " << status()
@@ -693,23 +821,50 @@ void ReplicaProcess::learned(const UPID& from, const Action& action)
 
   CHECK(action.learned());
 
-  if (persist(action)) {
-    LOG(INFO) << "Replica learned " << action.type()
-              << " action at position " << action.position();
-  }
+  persist(action);
 }
 
 
-bool ReplicaProcess::persist(const Action& action)
+void ReplicaProcess::persist(const Action& action)
 {
-  Try<Nothing> persisted = storage->persist(action);
+  Pending pending(action);
+  _persist(pending);
+}
 
-  if (persisted.isError()) {
-    LOG(ERROR) << "Error writing to log: " << persisted.error();
-    return false;
-  }
 
-  LOG(INFO) << "Persisted action at " << action.position();
+void ReplicaProcess::persist(
+    const UPID& from,
+    const Action& action,
+    const PromiseResponse& response)
+{
+  Pending pending(action);
+  pending.from = from;
+  pending.promiseResponse = response;
+  _persist(pending);
+}
+
+
+void ReplicaProcess::persist(
+    const UPID& from,
+    const Action& action,
+    const WriteResponse& response)
+{
+  Pending pending(action);
+  pending.from = from;
+  pending.writeResponse = response;
+  _persist(pending);
+}
+
+
+void ReplicaProcess::_persist(const Pending& pending)
+{
+  const Action& action = pending.action;
+
+  // Update the in-memory state eagerly so that requests handled
+  // before the flush runs (and thus batched into the same disk sync)
+  // observe this action; the response (if any) is only sent back
+  // once the action is durable.
+  accepted[action.position()] = action;
 
   // No longer a hole here (if there even was one).
   holes -= action.position();
@@ -718,6 +873,8 @@ bool ReplicaProcess::persist(const Action& action)
   if (action.has_learned() && action.learned()) {
     unlearned -= action.position();
 
+    learnedCache[action.position() % LEARNED_CACHE_SIZE] = action;
+
     if (action.has_type() && action.type() == Action::TRUNCATE) {
       // No longer consider truncated positions as holes (so that a
       // coordinator doesn't try and fill them).
@@ -746,7 +903,55 @@ bool ReplicaProcess::persist(const Action& action)
   // And update the end position.
   end = std::max(end, action.position());
 
-  return true;
+  pendings.push_back(pending);
+
+  // Schedule a flush when the first pending action gets queued. Any
+  // actions accepted before the flush event gets dequeued will be
+  // persisted by the same flush (i.e., with a single disk sync).
+  if (pendings.size() == 1) {
+    dispatch(self(), &Self::flush);
+  }
+}
+
+
+void ReplicaProcess::flush()
+{
+  if (pendings.empty()) {
+    return;
+  }
+
+  list<Action> actions;
+
+  foreach (const Pending& pending, pendings) {
+    actions.push_back(pending.action);
+  }
+
+  Try<Nothing> persisted = storage->persist(actions);
+
+  if (persisted.isError()) {
+    // Don't send any responses: the proposers will time out and
+    // retry, just as if each write had failed individually. We keep
+    // the actions queued (the in-memory state already reflects them)
+    // and retry the flush after a delay since we can always try
+    // again (see the comment above ReplicaProcess::promise).
+    LOG(ERROR) << "Error writing to log: " << persisted.error();
+
+    delay(Seconds(1), self(), &Self::flush);
+    return;
+  }
+
+  foreach (const Pending& pending, pendings) {
+    LOG(INFO) << "Persisted action at " << pending.action.position();
+
+    if (pending.promiseResponse.isSome()) {
+      send(pending.from.get(), pending.promiseResponse.get());
+    } else if (pending.writeResponse.isSome()) {
+      send(pending.from.get(), pending.writeResponse.get());
+    }
+  }
+
+  pendings.clear();
+  accepted.clear();
 }
 
 
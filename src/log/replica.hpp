@@ -39,6 +39,7 @@ namespace protocol {
 // Some replica protocol declarations.
 extern Protocol<PromiseRequest, PromiseResponse> promise;
 extern Protocol<WriteRequest, WriteResponse> write;
+extern Protocol<ReadRequest, ReadResponse> read;
 extern Protocol<RecoverRequest, RecoverResponse> recover;
 
 } // namespace protocol {
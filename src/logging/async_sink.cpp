@@ -0,0 +1,281 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/thread_local.hpp>
+
+#include "logging/async_sink.hpp"
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace logging {
+
+// The per-thread ring capacity in bytes (must be a power of two). At
+// ~200 bytes per formatted record this holds a few thousand records,
+// which gives the writer thread ample slack even under GLOG_v=2
+// bursts on the master.
+static const size_t RING_CAPACITY = 1 << 20;
+
+// How long the writer thread sleeps when all rings are empty.
+static const std::chrono::milliseconds WRITER_IDLE_INTERVAL(10);
+
+
+struct AsyncLogSink::Ring
+{
+  Ring()
+    : buffer(RING_CAPACITY),
+      head(0),
+      tail(0),
+      dropped(0) {}
+
+  // Returns true if the record was enqueued, false if the ring lacks
+  // the space (in which case the record is counted as dropped by the
+  // caller). Only ever called by the owning (producer) thread.
+  bool produce(const string& record)
+  {
+    const size_t produced = head.load(std::memory_order_relaxed);
+    const size_t consumed = tail.load(std::memory_order_acquire);
+
+    if (RING_CAPACITY - (produced - consumed) < record.size()) {
+      return false;
+    }
+
+    // Copy in (at most) two parts to handle wrap around.
+    const size_t index = produced & (RING_CAPACITY - 1);
+    const size_t first = std::min(record.size(), RING_CAPACITY - index);
+
+    memcpy(&buffer[index], record.data(), first);
+    memcpy(&buffer[0], record.data() + first, record.size() - first);
+
+    head.store(produced + record.size(), std::memory_order_release);
+
+    return true;
+  }
+
+  // Writes all currently available bytes to 'out' and returns the
+  // number written. Only ever called by the writer (consumer) thread.
+  size_t consume(FILE* out)
+  {
+    size_t consumed = tail.load(std::memory_order_relaxed);
+    const size_t produced = head.load(std::memory_order_acquire);
+
+    const size_t total = produced - consumed;
+
+    while (consumed != produced) {
+      const size_t index = consumed & (RING_CAPACITY - 1);
+      const size_t count =
+        std::min(produced - consumed, RING_CAPACITY - index);
+
+      fwrite(&buffer[index], 1, count, out);
+
+      consumed += count;
+    }
+
+    tail.store(consumed, std::memory_order_release);
+
+    return total;
+  }
+
+  vector<char> buffer;
+
+  // Free running byte counts; an index into 'buffer' is obtained by
+  // masking with RING_CAPACITY - 1.
+  std::atomic<size_t> head; // Written by the producer.
+  std::atomic<size_t> tail; // Written by the consumer.
+
+  // Records dropped because the ring was full, incremented by the
+  // producer and reported (and reset) by the writer thread.
+  std::atomic<size_t> dropped;
+};
+
+
+Try<Nothing> AsyncLogSink::install(
+    const Option<string>& path,
+    Format format)
+{
+  static AsyncLogSink* sink = NULL;
+
+  if (sink != NULL) {
+    return Error("Async log sink has already been installed");
+  }
+
+  FILE* out = stderr;
+
+  if (path.isSome()) {
+    out = fopen(path.get().c_str(), "a");
+    if (out == NULL) {
+      return ErrnoError("Failed to open '" + path.get() + "'");
+    }
+  }
+
+  // NOTE: Intentionally leaked; the sink (and its writer thread)
+  // lives for the remainder of the process.
+  sink = new AsyncLogSink(out, format);
+
+  google::AddLogSink(sink);
+
+  return Nothing();
+}
+
+
+AsyncLogSink::AsyncLogSink(FILE* _out, Format _format)
+  : out(_out),
+    format(_format)
+{
+  std::thread thread(&AsyncLogSink::run, this);
+  thread.detach();
+}
+
+
+void AsyncLogSink::send(
+    google::LogSeverity severity,
+    const char* full_filename,
+    const char* base_filename,
+    int line,
+    const struct ::tm* tm_time,
+    const char* message,
+    size_t message_len)
+{
+  const string record =
+    serialize(severity, base_filename, line, tm_time, message, message_len);
+
+  // Write FATAL records synchronously: glog aborts the process right
+  // after the sinks have been invoked, before the writer thread would
+  // get a chance to drain the ring. When writing to stderr glog's own
+  // FATAL output already appears there, so only the file case needs
+  // this.
+  if (severity == google::FATAL && out != stderr) {
+    std::lock_guard<std::mutex> guard(mutex);
+    fwrite(record.data(), 1, record.size(), out);
+    fflush(out);
+    return;
+  }
+
+  enqueue(record);
+}
+
+
+string AsyncLogSink::serialize(
+    google::LogSeverity severity,
+    const char* base_filename,
+    int line,
+    const struct ::tm* tm_time,
+    const char* message,
+    size_t message_len)
+{
+  if (format == TEXT) {
+    return ToString(
+        severity, base_filename, line, tm_time, message, message_len) + "\n";
+  }
+
+  // See the framing description in async_sink.hpp.
+  struct ::tm tm = *tm_time;
+  const int64_t time = static_cast<int64_t>(mktime(&tm));
+  const uint32_t length = static_cast<uint32_t>(strlen(base_filename));
+  const int32_t severity_ = static_cast<int32_t>(severity);
+  const int32_t line_ = static_cast<int32_t>(line);
+
+  const uint32_t size = static_cast<uint32_t>(
+      sizeof(severity_) + sizeof(time) + sizeof(line_) + sizeof(length) +
+      length + message_len);
+
+  string record;
+  record.reserve(sizeof(size) + size);
+  record.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  record.append(reinterpret_cast<const char*>(&severity_), sizeof(severity_));
+  record.append(reinterpret_cast<const char*>(&time), sizeof(time));
+  record.append(reinterpret_cast<const char*>(&line_), sizeof(line_));
+  record.append(reinterpret_cast<const char*>(&length), sizeof(length));
+  record.append(base_filename, length);
+  record.append(message, message_len);
+
+  return record;
+}
+
+
+void AsyncLogSink::enqueue(const string& record)
+{
+  // The calling thread's ring, lazily created and registered with the
+  // sink on the thread's first record.
+  static THREAD_LOCAL Ring* ring = NULL;
+
+  if (ring == NULL) {
+    ring = new Ring();
+
+    std::lock_guard<std::mutex> guard(mutex);
+    rings.push_back(ring);
+  }
+
+  if (!ring->produce(record)) {
+    ring->dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+
+void AsyncLogSink::run()
+{
+  vector<Ring*> snapshot;
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      snapshot = rings;
+    }
+
+    size_t written = 0;
+    size_t dropped = 0;
+
+    foreach (Ring* ring, snapshot) {
+      written += ring->consume(out);
+      dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    if (dropped > 0) {
+      // NOTE: We can't use LOG here (we'd be feeding ourselves); for
+      // the binary format this line also deliberately goes to stderr
+      // rather than corrupting the record stream.
+      fprintf(stderr,
+              "Async log sink dropped %zu record(s): writer fell behind\n",
+              dropped);
+    }
+
+    if (written > 0) {
+      fflush(out);
+    } else {
+      std::this_thread::sleep_for(WRITER_IDLE_INTERVAL);
+    }
+  }
+}
+
+} // namespace logging {
+} // namespace internal {
+} // namespace mesos {
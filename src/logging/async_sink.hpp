@@ -0,0 +1,124 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LOGGING_ASYNC_SINK_HPP__
+#define __LOGGING_ASYNC_SINK_HPP__
+
+#include <stdio.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace logging {
+
+// A glog sink that decouples log record production from the write to
+// disk (or stderr). Logging threads serialize each record into a
+// per-thread lock-free ring buffer and return immediately; a single
+// writer thread drains the rings and performs the (buffered) writes.
+// This keeps the cost of a log statement on the logging thread to the
+// formatting plus a memcpy, which makes verbose logging affordable on
+// latency sensitive paths such as the master's event loop.
+//
+// NOTE: Level filtering (FLAGS_minloglevel, FLAGS_v) happens in the
+// glog macros before the sink is invoked, so the levels remain
+// adjustable at runtime through the existing /logging/toggle
+// endpoint.
+//
+// If a logging thread outruns the writer and fills its ring the
+// record is dropped rather than blocking the logger; drops are
+// counted and reported by the writer thread.
+class AsyncLogSink : public google::LogSink
+{
+public:
+  enum Format
+  {
+    // The standard glog line format, one record per line.
+    TEXT,
+
+    // A compact binary framing, in host byte order:
+    //   uint32_t size;      // Size in bytes of the rest of the record.
+    //   int32_t severity;   // google::LogSeverity.
+    //   int64_t time;       // Seconds since the epoch.
+    //   int32_t line;
+    //   uint32_t length;    // Length of the base filename.
+    //   char file[length];
+    //   char message[];     // The remainder of the record.
+    BINARY
+  };
+
+  // Installs the (process lifetime) singleton sink, writing records
+  // to the given path, or to stderr if no path is provided. Must be
+  // called at most once, after google::InitGoogleLogging().
+  static Try<Nothing> install(const Option<std::string>& path, Format format);
+
+  virtual void send(
+      google::LogSeverity severity,
+      const char* full_filename,
+      const char* base_filename,
+      int line,
+      const struct ::tm* tm_time,
+      const char* message,
+      size_t message_len);
+
+private:
+  // A single-producer single-consumer ring of serialized records.
+  // Each record is enqueued in its entirety or dropped, so the byte
+  // stream stays record aligned. Rings are registered on first use by
+  // a thread and are never reclaimed; logging threads are expected to
+  // be long lived (e.g. the libprocess worker pool).
+  struct Ring;
+
+  AsyncLogSink(FILE* _out, Format _format);
+
+  // Serializes a record in the configured format.
+  std::string serialize(
+      google::LogSeverity severity,
+      const char* base_filename,
+      int line,
+      const struct ::tm* tm_time,
+      const char* message,
+      size_t message_len);
+
+  // Appends a serialized record to the calling thread's ring,
+  // registering a new ring on the thread's first record.
+  void enqueue(const std::string& record);
+
+  // The writer thread: repeatedly drains all rings into 'out'.
+  void run();
+
+  FILE* out;
+  const Format format;
+
+  // Guards 'rings' (registration and the writer's snapshot) and
+  // direct writes of FATAL records.
+  std::mutex mutex;
+  std::vector<Ring*> rings;
+};
+
+} // namespace logging {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __LOGGING_ASYNC_SINK_HPP__
@@ -44,6 +44,22 @@ mesos::internal::logging::Flags::Flags()
       "How many seconds to buffer log messages for",
       0);
 
+  add(&Flags::log_async,
+      "log_async",
+      "Whether to write log messages asynchronously: records are\n"
+      "serialized into per-thread ring buffers and written to disk\n"
+      "(or stderr) by a dedicated writer thread, keeping verbose\n"
+      "logging off latency sensitive paths. Records may be dropped\n"
+      "(and are counted) if the writer falls behind. Log levels\n"
+      "remain adjustable at runtime via the /logging/toggle endpoint",
+      false);
+
+  add(&Flags::async_log_format,
+      "async_log_format",
+      "Format of asynchronously written log records (requires\n"
+      "--log_async); possible values: 'text', 'binary'",
+      "text");
+
   add(&Flags::initialize_driver_logging,
       "initialize_driver_logging",
       "Whether to automatically initialize Google logging of scheduler\n"
@@ -35,6 +35,8 @@ public:
   std::string logging_level;
   Option<std::string> log_dir;
   int logbufsecs;
+  bool log_async;
+  std::string async_log_format;
   bool initialize_driver_logging;
   Option<std::string> external_log_file;
 };
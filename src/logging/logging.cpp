@@ -33,6 +33,7 @@
 
 #include <stout/os/signals.hpp>
 
+#include "logging/async_sink.hpp"
 #include "logging/logging.hpp"
 
 using process::Once;
@@ -172,6 +173,38 @@ void initialize(
   VLOG(1) << "Logging to " <<
     (flags.log_dir.isSome() ? flags.log_dir.get() : "STDERR");
 
+  if (flags.log_async) {
+    AsyncLogSink::Format format;
+    if (flags.async_log_format == "text") {
+      format = AsyncLogSink::TEXT;
+    } else if (flags.async_log_format == "binary") {
+      format = AsyncLogSink::BINARY;
+    } else {
+      EXIT(1) << "'" << flags.async_log_format << "' is not a valid async log"
+                 " format. Possible values for 'async_log_format' flag are:"
+                 " 'text', 'binary'.";
+    }
+
+    Option<string> path = None();
+    if (flags.log_dir.isSome()) {
+      path = path::join(flags.log_dir.get(), Path(argv0).basename()) + ".ASYNC";
+    }
+
+    Try<Nothing> install = AsyncLogSink::install(path, format);
+    if (install.isError()) {
+      EXIT(1) << "Could not initialize async logging: " << install.error();
+    }
+
+    // Route everything through the sink alone: disable glog's own
+    // (synchronous) log files and stderr output, except for FATAL
+    // which we still want on stderr before the process aborts.
+    for (int severity = 0; severity < google::NUM_SEVERITIES; severity++) {
+      google::SetLogDestination(severity, "");
+    }
+    FLAGS_logtostderr = false;
+    FLAGS_stderrthreshold = 3; // FATAL.
+  }
+
   if (installFailureSignalHandler) {
     // Handles SIGSEGV, SIGILL, SIGFPE, SIGABRT, SIGBUS, SIGTERM
     // by default.
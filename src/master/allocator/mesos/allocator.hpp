@@ -50,7 +50,7 @@ public:
       const Duration& allocationInterval,
       const lambda::function<
           void(const FrameworkID&,
-               const hashmap<SlaveID, Resources>&)>& offerCallback,
+               hashmap<SlaveID, Resources>)>& offerCallback,
       const lambda::function<
           void(const FrameworkID&,
                const hashmap<SlaveID, UnavailableResources>&)>&
@@ -119,6 +119,10 @@ public:
       const SlaveID& slaveId,
       const Option<Unavailability>& unavailability);
 
+  void updateUnavailability(
+      const std::vector<mesos::master::allocator::UnavailabilityUpdate>&
+        updates);
+
   void updateInverseOffer(
       const SlaveID& slaveId,
       const FrameworkID& frameworkId,
@@ -126,22 +130,40 @@ public:
       const Option<mesos::master::InverseOfferStatus>& status,
       const Option<Filters>& filters);
 
+  void updateInverseOffer(
+      const std::vector<mesos::master::allocator::InverseOfferUpdate>&
+        updates);
+
   process::Future<
       hashmap<SlaveID, hashmap<FrameworkID, mesos::master::InverseOfferStatus>>>
     getInverseOfferStatuses();
 
+  process::Future<
+      hashmap<std::string,
+              std::vector<mesos::master::allocator::ClientState>>>
+    getSorterState();
+
   void recoverResources(
       const FrameworkID& frameworkId,
       const SlaveID& slaveId,
       const Resources& resources,
       const Option<Filters>& filters);
 
+  void recoverResources(
+      const std::vector<mesos::master::allocator::ResourceRecovery>&
+        recoveries);
+
   void suppressOffers(
       const FrameworkID& frameworkId);
 
   void reviveOffers(
       const FrameworkID& frameworkId);
 
+  void updateOfferHolding(
+      const FrameworkID& frameworkId,
+      const Option<process::Time>& heldSince,
+      const Duration& threshold);
+
   void setQuota(
       const std::string& role,
       const Quota& quota);
@@ -174,7 +196,7 @@ public:
       const Duration& allocationInterval,
       const lambda::function<
           void(const FrameworkID&,
-               const hashmap<SlaveID, Resources>&)>& offerCallback,
+               hashmap<SlaveID, Resources>)>& offerCallback,
       const lambda::function<
           void(const FrameworkID&,
                const hashmap<SlaveID, UnavailableResources>&)>&
@@ -243,6 +265,10 @@ public:
       const SlaveID& slaveId,
       const Option<Unavailability>& unavailability) = 0;
 
+  virtual void updateUnavailability(
+      const std::vector<mesos::master::allocator::UnavailabilityUpdate>&
+        updates) = 0;
+
   virtual void updateInverseOffer(
       const SlaveID& slaveId,
       const FrameworkID& frameworkId,
@@ -250,22 +276,40 @@ public:
       const Option<mesos::master::InverseOfferStatus>& status,
       const Option<Filters>& filters = None()) = 0;
 
+  virtual void updateInverseOffer(
+      const std::vector<mesos::master::allocator::InverseOfferUpdate>&
+        updates) = 0;
+
   virtual process::Future<
       hashmap<SlaveID, hashmap<FrameworkID, mesos::master::InverseOfferStatus>>>
     getInverseOfferStatuses() = 0;
 
+  virtual process::Future<
+      hashmap<std::string,
+              std::vector<mesos::master::allocator::ClientState>>>
+    getSorterState() = 0;
+
   virtual void recoverResources(
       const FrameworkID& frameworkId,
       const SlaveID& slaveId,
       const Resources& resources,
       const Option<Filters>& filters) = 0;
 
+  virtual void recoverResources(
+      const std::vector<mesos::master::allocator::ResourceRecovery>&
+        recoveries) = 0;
+
   virtual void suppressOffers(
       const FrameworkID& frameworkId) = 0;
 
   virtual void reviveOffers(
       const FrameworkID& frameworkId) = 0;
 
+  virtual void updateOfferHolding(
+      const FrameworkID& frameworkId,
+      const Option<process::Time>& heldSince,
+      const Duration& threshold) = 0;
+
   virtual void setQuota(
       const std::string& role,
       const Quota& quota) = 0;
@@ -306,7 +350,7 @@ inline void MesosAllocator<AllocatorProcess>::initialize(
     const Duration& allocationInterval,
     const lambda::function<
         void(const FrameworkID&,
-             const hashmap<SlaveID, Resources>&)>& offerCallback,
+             hashmap<SlaveID, Resources>)>& offerCallback,
     const lambda::function<
         void(const FrameworkID&,
               const hashmap<SlaveID, UnavailableResources>&)>&
@@ -528,6 +572,22 @@ inline void MesosAllocator<AllocatorProcess>::updateUnavailability(
 }
 
 
+template <typename AllocatorProcess>
+inline void MesosAllocator<AllocatorProcess>::updateUnavailability(
+    const std::vector<mesos::master::allocator::UnavailabilityUpdate>& updates)
+{
+  // NOTE: The overload must be disambiguated for dispatch.
+  void (MesosAllocatorProcess::*update)(
+      const std::vector<mesos::master::allocator::UnavailabilityUpdate>&) =
+    &MesosAllocatorProcess::updateUnavailability;
+
+  process::dispatch(
+      process,
+      update,
+      updates);
+}
+
+
 template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::updateInverseOffer(
     const SlaveID& slaveId,
@@ -547,6 +607,22 @@ inline void MesosAllocator<AllocatorProcess>::updateInverseOffer(
 }
 
 
+template <typename AllocatorProcess>
+inline void MesosAllocator<AllocatorProcess>::updateInverseOffer(
+    const std::vector<mesos::master::allocator::InverseOfferUpdate>& updates)
+{
+  // NOTE: The overload must be disambiguated for dispatch.
+  void (MesosAllocatorProcess::*update)(
+      const std::vector<mesos::master::allocator::InverseOfferUpdate>&) =
+    &MesosAllocatorProcess::updateInverseOffer;
+
+  process::dispatch(
+      process,
+      update,
+      updates);
+}
+
+
 template <typename AllocatorProcess>
 inline process::Future<
     hashmap<SlaveID, hashmap<FrameworkID, mesos::master::InverseOfferStatus>>>
@@ -558,6 +634,17 @@ inline process::Future<
 }
 
 
+template <typename AllocatorProcess>
+inline process::Future<
+    hashmap<std::string, std::vector<mesos::master::allocator::ClientState>>>
+  MesosAllocator<AllocatorProcess>::getSorterState()
+{
+  return process::dispatch(
+      process,
+      &MesosAllocatorProcess::getSorterState);
+}
+
+
 template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::recoverResources(
     const FrameworkID& frameworkId,
@@ -575,6 +662,22 @@ inline void MesosAllocator<AllocatorProcess>::recoverResources(
 }
 
 
+template <typename AllocatorProcess>
+inline void MesosAllocator<AllocatorProcess>::recoverResources(
+    const std::vector<mesos::master::allocator::ResourceRecovery>& recoveries)
+{
+  // NOTE: The overload must be disambiguated for dispatch.
+  void (MesosAllocatorProcess::*recover)(
+      const std::vector<mesos::master::allocator::ResourceRecovery>&) =
+    &MesosAllocatorProcess::recoverResources;
+
+  process::dispatch(
+      process,
+      recover,
+      recoveries);
+}
+
+
 template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::suppressOffers(
     const FrameworkID& frameworkId)
@@ -597,6 +700,21 @@ inline void MesosAllocator<AllocatorProcess>::reviveOffers(
 }
 
 
+template <typename AllocatorProcess>
+inline void MesosAllocator<AllocatorProcess>::updateOfferHolding(
+    const FrameworkID& frameworkId,
+    const Option<process::Time>& heldSince,
+    const Duration& threshold)
+{
+  process::dispatch(
+      process,
+      &MesosAllocatorProcess::updateOfferHolding,
+      frameworkId,
+      heldSince,
+      threshold);
+}
+
+
 template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::setQuota(
     const std::string& role,
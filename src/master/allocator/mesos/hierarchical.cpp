@@ -16,14 +16,22 @@
 
 #include "master/allocator/mesos/hierarchical.hpp"
 
+#include <stdlib.h>
+
 #include <algorithm>
+#include <cmath>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include <mesos/attributes.hpp>
 #include <mesos/resources.hpp>
 #include <mesos/type_utils.hpp>
 
+#include <process/clock.hpp>
 #include <process/event.hpp>
 #include <process/delay.hpp>
+#include <process/dispatch.hpp>
 #include <process/id.hpp>
 #include <process/timeout.hpp>
 
@@ -32,13 +40,16 @@
 #include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 
+using std::pair;
 using std::string;
 using std::vector;
 
 using mesos::master::InverseOfferStatus;
 
+using process::Clock;
 using process::Failure;
 using process::Future;
+using process::Time;
 using process::Timeout;
 
 namespace mesos {
@@ -47,6 +58,79 @@ namespace master {
 namespace allocator {
 namespace internal {
 
+// Number of consecutive batch allocations that may be performed over
+// only the dirty slaves before a full cluster-wide pass is forced.
+// The periodic full pass acts as a safety net for state changes that
+// are not captured by the dirty set (e.g., whitelist updates).
+static const size_t MAX_BATCHES_WITHOUT_FULL_ALLOCATION = 10;
+
+
+// Minimum number of slaves each worker thread should process when
+// sharding the offer generation stage of an allocation. Sharding a
+// small slave set costs more in thread spawning than it saves.
+static const size_t MIN_SLAVES_PER_ALLOCATION_SHARD = 256;
+
+
+// Maximum number of slaves considered in one go during an allocation
+// pass. Passes over more slaves are sliced into chunks of this size
+// with a yield to the allocator's event queue in between, so that
+// interleaved events (e.g., declines, revives) are handled with
+// bounded latency even while a full pass over a large cluster is in
+// progress.
+static const size_t MAX_SLAVES_PER_ALLOCATION_CHUNK = 1000;
+
+
+// Returns the fraction of the slave's scalar resources that is
+// still unallocated, averaged across resource kinds, in [0, 1].
+// Used to weigh slaves within an allocation pass: a mostly empty
+// slave is a more profitable allocation target than a mostly full
+// one.
+static double headroom(const Resources& total, const Resources& allocated)
+{
+  hashmap<string, double> totals;
+  hashmap<string, double> used;
+
+  foreach (const Resource& resource, total.scalars()) {
+    totals[resource.name()] += resource.scalar().value();
+  }
+
+  foreach (const Resource& resource, allocated.scalars()) {
+    used[resource.name()] += resource.scalar().value();
+  }
+
+  double fraction = 0.0;
+  size_t count = 0;
+
+  foreachpair (const string& name, double value, totals) {
+    if (value > 0.0) {
+      fraction += std::max(0.0, 1.0 - used.get(name).getOrElse(0.0) / value);
+      count++;
+    }
+  }
+
+  return count == 0 ? 0.0 : fraction / count;
+}
+
+
+// Returns a random sort key for weighted random ordering (Efraimidis
+// & Spirakis): an element with weight 'w' gets the key u^(1/w) for a
+// uniform 'u' in (0, 1], and elements are visited in decreasing key
+// order. Elements with a larger weight then tend to sort earlier,
+// matching weighted sampling without replacement. The minimum weight
+// keeps elements with no headroom in the pass (they still need to be
+// visited, e.g., for inverse offers) while letting them gravitate to
+// the end.
+static double weightedOrderKey(double weight)
+{
+  static const double MINIMUM_WEIGHT = 0.001;
+
+  const double u =
+    (static_cast<double>(::random()) + 1.0) / (RAND_MAX + 2.0);
+
+  return std::pow(u, 1.0 / std::max(weight, MINIMUM_WEIGHT));
+}
+
+
 // Used to represent "filters" for resources unused in offers.
 class OfferFilter
 {
@@ -72,8 +156,12 @@ public:
     // more revocable resources only or non-revocable resources only,
     // but currently the filter only expires if there is more of both
     // revocable and non-revocable resources.
-    return resources.contains(_resources) && // Refused resources are superset.
-           timeout.remaining() > Seconds(0);
+    //
+    // NOTE: We test the timeout first since it is much cheaper than
+    // the superset check, which runs for every (framework, agent)
+    // pair in the allocation loop.
+    return timeout.remaining() > Seconds(0) &&
+           resources.contains(_resources); // Refused resources are superset.
   }
 
   const Resources resources;
@@ -120,7 +208,7 @@ void HierarchicalAllocatorProcess::initialize(
     const Duration& _allocationInterval,
     const lambda::function<
         void(const FrameworkID&,
-             const hashmap<SlaveID, Resources>&)>& _offerCallback,
+             hashmap<SlaveID, Resources>)>& _offerCallback,
     const lambda::function<
         void(const FrameworkID&,
              const hashmap<SlaveID, UnavailableResources>&)>&
@@ -444,6 +532,13 @@ void HierarchicalAllocatorProcess::addSlave(
   slaves[slaveId].activated = true;
   slaves[slaveId].hostname = slaveInfo.hostname();
 
+  // Remember the agent's failure domain (operators convey it via the
+  // `fault_domain` attribute, e.g. the rack name) so that allocation
+  // can group agents in the same domain. Agents that do not specify
+  // the attribute all end up in the "" domain.
+  slaves[slaveId].domain = Attributes(slaveInfo.attributes())
+    .get("fault_domain", Value::Text()).value();
+
   // NOTE: We currently implement maintenance in the allocator to be able to
   // leverage state and features such as the FrameworkSorter and OfferFilter.
   if (unavailability.isSome()) {
@@ -494,6 +589,7 @@ void HierarchicalAllocatorProcess::removeSlave(
       slaveId, slaves[slaveId].total.unreserved().nonRevocable());
 
   slaves.erase(slaveId);
+  dirtySlaves.erase(slaveId);
 
   // Note that we DO NOT actually delete any filters associated with
   // this slave, that will occur when the delayed
@@ -646,6 +742,11 @@ void HierarchicalAllocatorProcess::updateAllocation(
 
   slaves[slaveId].total = updatedTotal.get();
 
+  // The operations may have changed what is offerable on this slave
+  // (e.g., resources became reserved), so consider it during the next
+  // batch allocation.
+  dirtySlaves.insert(slaveId);
+
   LOG(INFO) << "Updated allocation of framework " << frameworkId
             << " on slave " << slaveId
             << " from " << frameworkAllocation
@@ -699,6 +800,39 @@ void HierarchicalAllocatorProcess::updateUnavailability(
     const Option<Unavailability>& unavailability)
 {
   CHECK(initialized);
+
+  _updateUnavailability(slaveId, unavailability);
+
+  allocate(slaveId);
+}
+
+
+void HierarchicalAllocatorProcess::updateUnavailability(
+    const vector<mesos::master::allocator::UnavailabilityUpdate>& updates)
+{
+  CHECK(initialized);
+
+  // NOTE: The point of the bulk overload is that applying a
+  // maintenance schedule triggers a single allocation pass over the
+  // affected slaves, rather than one full pass per slave.
+  hashset<SlaveID> slaveIds;
+
+  foreach (const mesos::master::allocator::UnavailabilityUpdate& update,
+           updates) {
+    _updateUnavailability(update.slaveId, update.unavailability);
+    slaveIds.insert(update.slaveId);
+  }
+
+  if (!slaveIds.empty()) {
+    allocate(slaveIds);
+  }
+}
+
+
+void HierarchicalAllocatorProcess::_updateUnavailability(
+    const SlaveID& slaveId,
+    const Option<Unavailability>& unavailability)
+{
   CHECK(slaves.contains(slaveId));
 
   // NOTE: We currently implement maintenance in the allocator to be able to
@@ -721,8 +855,6 @@ void HierarchicalAllocatorProcess::updateUnavailability(
     slaves[slaveId].maintenance =
       typename Slave::Maintenance(unavailability.get());
   }
-
-  allocate(slaveId);
 }
 
 
@@ -820,6 +952,26 @@ void HierarchicalAllocatorProcess::updateInverseOffer(
 }
 
 
+void HierarchicalAllocatorProcess::updateInverseOffer(
+    const vector<mesos::master::allocator::InverseOfferUpdate>& updates)
+{
+  CHECK(initialized);
+
+  // NOTE: The point of the bulk overload is that the master incurs a
+  // single dispatch regardless of the number of updates; the
+  // per-update bookkeeping is unavoidable either way.
+  foreach (const mesos::master::allocator::InverseOfferUpdate& update,
+           updates) {
+    updateInverseOffer(
+        update.slaveId,
+        update.frameworkId,
+        update.unavailableResources,
+        update.status,
+        update.filters);
+  }
+}
+
+
 Future<hashmap<SlaveID, hashmap<FrameworkID, InverseOfferStatus>>>
 HierarchicalAllocatorProcess::getInverseOfferStatuses()
 {
@@ -838,6 +990,24 @@ HierarchicalAllocatorProcess::getInverseOfferStatuses()
 }
 
 
+Future<hashmap<string, vector<mesos::master::allocator::ClientState>>>
+HierarchicalAllocatorProcess::getSorterState()
+{
+  CHECK(initialized);
+
+  hashmap<string, vector<mesos::master::allocator::ClientState>> result;
+
+  result["roles"] = roleSorter->state();
+  result["quota_roles"] = quotaRoleSorter->state();
+
+  foreachpair (const string& role, Sorter* sorter, frameworkSorters) {
+    result["frameworks/" + role] = sorter->state();
+  }
+
+  return result;
+}
+
+
 void HierarchicalAllocatorProcess::recoverResources(
     const FrameworkID& frameworkId,
     const SlaveID& slaveId,
@@ -884,6 +1054,10 @@ void HierarchicalAllocatorProcess::recoverResources(
 
     slaves[slaveId].allocated -= resources;
 
+    // The recovered resources are available again, so consider this
+    // slave during the next batch allocation.
+    dirtySlaves.insert(slaveId);
+
     VLOG(1) << "Recovered " << resources
             << " (total: " << slaves[slaveId].total
             << ", allocated: " << slaves[slaveId].allocated
@@ -950,6 +1124,28 @@ void HierarchicalAllocatorProcess::recoverResources(
 }
 
 
+void HierarchicalAllocatorProcess::recoverResources(
+    const vector<mesos::master::allocator::ResourceRecovery>& recoveries)
+{
+  CHECK(initialized);
+
+  // NOTE: The point of the bulk overload is that the master incurs a
+  // single dispatch regardless of the number of recoveries; sorter
+  // re-scoring is deferred (see the comment on `dirtyClients` in the
+  // sorter), so applying the recoveries one at a time here does not
+  // multiply up any per-recovery work beyond the unavoidable
+  // bookkeeping.
+  foreach (const mesos::master::allocator::ResourceRecovery& recovery,
+           recoveries) {
+    recoverResources(
+        recovery.frameworkId,
+        recovery.slaveId,
+        recovery.resources,
+        recovery.filters);
+  }
+}
+
+
 void HierarchicalAllocatorProcess::suppressOffers(
     const FrameworkID& frameworkId)
 {
@@ -961,6 +1157,24 @@ void HierarchicalAllocatorProcess::suppressOffers(
 }
 
 
+void HierarchicalAllocatorProcess::updateOfferHolding(
+    const FrameworkID& frameworkId,
+    const Option<Time>& heldSince,
+    const Duration& threshold)
+{
+  CHECK(initialized);
+
+  // The framework may have been removed concurrently with the
+  // master's offer bookkeeping.
+  if (!frameworks.contains(frameworkId)) {
+    return;
+  }
+
+  frameworks[frameworkId].offerHeldSince = heldSince;
+  frameworks[frameworkId].offerHoldThreshold = threshold;
+}
+
+
 void HierarchicalAllocatorProcess::reviveOffers(
     const FrameworkID& frameworkId)
 {
@@ -1065,7 +1279,34 @@ void HierarchicalAllocatorProcess::resume()
 
 void HierarchicalAllocatorProcess::batch()
 {
-  allocate();
+  // When only some slaves changed since the last pass, run the
+  // allocation algorithm over just those slaves: this keeps the cost
+  // of the common case proportional to the amount of change rather
+  // than the cluster size. We periodically fall back to a full
+  // cluster-wide pass for state changes that do not mark slaves
+  // dirty (e.g., whitelist updates).
+  if (paused) {
+    VLOG(1) << "Skipped batch allocation because the allocator is paused";
+  } else if (!dirtySlaves.empty() &&
+             batchesSinceFullAllocation < MAX_BATCHES_WITHOUT_FULL_ALLOCATION) {
+    batchesSinceFullAllocation++;
+
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    // NOTE: We copy the dirty set because `allocate()` removes the
+    // slaves it considers from `dirtySlaves` as it goes.
+    const hashset<SlaveID> slaveIds = dirtySlaves;
+
+    allocate(slaveIds);
+
+    VLOG(1) << "Performed batch allocation for " << slaveIds.size()
+            << " dirty slaves in " << stopwatch.elapsed();
+  } else {
+    batchesSinceFullAllocation = 0;
+    allocate();
+  }
+
   delay(allocationInterval, self(), &Self::batch);
 }
 
@@ -1110,10 +1351,208 @@ void HierarchicalAllocatorProcess::allocate(
 }
 
 
+hashmap<SlaveID, Resources> HierarchicalAllocatorProcess::availableResources(
+    const vector<SlaveID>& slaveIds)
+{
+  hashmap<SlaveID, Resources> available;
+
+  // Determine the number of shards: one per hardware thread, but
+  // never so many that a shard processes fewer than
+  // `MIN_SLAVES_PER_ALLOCATION_SHARD` slaves.
+  size_t shards = std::min<size_t>(
+      std::max<size_t>(std::thread::hardware_concurrency(), 1),
+      slaveIds.size() / MIN_SLAVES_PER_ALLOCATION_SHARD);
+
+  if (shards <= 1) {
+    foreach (const SlaveID& slaveId, slaveIds) {
+      available[slaveId] =
+        slaves[slaveId].total - slaves[slaveId].allocated;
+    }
+
+    return available;
+  }
+
+  // Compute each shard's results into a separate map so that the
+  // worker threads do not share any mutable state; the maps are
+  // merged below once all workers have joined. The workers only
+  // read `slaves` (distinct entries per shard), which is safe since
+  // the allocator actor is blocked here and cannot mutate it.
+  vector<hashmap<SlaveID, Resources>> results(shards);
+  vector<std::thread> workers;
+  workers.reserve(shards);
+
+  for (size_t shard = 0; shard < shards; shard++) {
+    workers.push_back(std::thread(
+        [this, shard, shards, &slaveIds, &results]() {
+          for (size_t i = shard; i < slaveIds.size(); i += shards) {
+            const SlaveID& slaveId = slaveIds[i];
+            const Slave& slave = slaves.at(slaveId);
+
+            results[shard][slaveId] = slave.total - slave.allocated;
+          }
+        }));
+  }
+
+  foreach (std::thread& worker, workers) {
+    worker.join();
+  }
+
+  foreach (const hashmap<SlaveID, Resources>& result, results) {
+    foreachpair (const SlaveID& slaveId, const Resources& resources, result) {
+      available[slaveId] = resources;
+    }
+  }
+
+  return available;
+}
+
+
 // TODO(alexr): Consider factoring out the quota allocation logic.
 void HierarchicalAllocatorProcess::allocate(
     const hashset<SlaveID>& slaveIds_)
 {
+  // These slaves are about to be considered for allocation, hence
+  // they are no longer dirty.
+  foreach (const SlaveID& slaveId, slaveIds_) {
+    dirtySlaves.erase(slaveId);
+  }
+
+  // Filter out non-whitelisted and deactivated slaves in order not to
+  // send offers for them, grouping the rest by their failure domain
+  // (see `Slave::domain`) and pairing each with a weighted random
+  // sort key derived from its unallocated headroom.
+  hashmap<string, vector<pair<double, SlaveID>>> domains;
+  hashmap<string, double> domainWeights;
+  vector<SlaveID> ineligible;
+  foreach (const SlaveID& slaveId, slaveIds_) {
+    if (isWhitelisted(slaveId) && slaves[slaveId].activated) {
+      const Slave& slave = slaves[slaveId];
+
+      double weight = headroom(slave.total, slave.allocated);
+
+      domains[slave.domain].push_back({weightedOrderKey(weight), slaveId});
+      domainWeights[slave.domain] += weight;
+    } else {
+      ineligible.push_back(slaveId);
+    }
+  }
+
+  // Randomize the order in which slaves' resources are allocated,
+  // but weigh the randomization by headroom: domains are visited in
+  // weighted random order (a domain weighs the sum of its agents'
+  // headrooms) and agents are ordered by their own key within their
+  // domain. Agents in the same failure domain remain adjacent, so
+  // offers that are generated back to back (and hence tend to end up
+  // in the same batch to a framework) land in the same domain, while
+  // mostly full agents gravitate to the end of the pass instead of
+  // delaying the usable offers, improving the time to first offer
+  // after resources are recovered.
+  vector<pair<double, string>> order;
+  order.reserve(domains.size());
+  foreachkey (const string& domain, domains) {
+    order.push_back({weightedOrderKey(domainWeights[domain]), domain});
+  }
+
+  std::sort(order.begin(), order.end(),
+            [](const pair<double, string>& left,
+               const pair<double, string>& right) {
+              return left.first > right.first;
+            });
+
+  vector<SlaveID> slaveIds;
+  slaveIds.reserve(slaveIds_.size());
+
+  for (size_t i = 0; i < order.size(); i++) {
+    vector<pair<double, SlaveID>>& group = domains[order[i].second];
+
+    std::sort(group.begin(), group.end(),
+              [](const pair<double, SlaveID>& left,
+                 const pair<double, SlaveID>& right) {
+                return left.first > right.first;
+              });
+
+    for (size_t j = 0; j < group.size(); j++) {
+      slaveIds.push_back(group[j].second);
+    }
+  }
+
+  // Slaves that are not eligible for offers are still visited by the
+  // pass for maintenance inverse offers (see `deallocate()`).
+  slaveIds.insert(slaveIds.end(), ineligible.begin(), ineligible.end());
+
+  // Refresh the offer hoarding penalties before the pass. A
+  // framework holding an offer longer than the threshold sorts as
+  // if its share were inflated, with the inflation growing linearly
+  // with the hold time, so that hoarders fall down the allocation
+  // order instead of distorting fairness for everybody else. The
+  // penalty disappears once the held offers are accepted, declined
+  // or rescinded.
+  const Time now = Clock::now();
+
+  foreachpair (const FrameworkID& frameworkId,
+               const Framework& framework,
+               frameworks) {
+    double penalty = 1.0;
+
+    if (framework.offerHeldSince.isSome() &&
+        framework.offerHoldThreshold > Duration::zero()) {
+      const Duration held = now - framework.offerHeldSince.get();
+
+      if (held > framework.offerHoldThreshold) {
+        penalty += (held - framework.offerHoldThreshold).secs() /
+                   framework.offerHoldThreshold.secs();
+      }
+    }
+
+    CHECK(frameworkSorters.contains(framework.role));
+    frameworkSorters[framework.role]->penalize(frameworkId.value(), penalty);
+  }
+
+  // Process the slaves in bounded chunks, yielding to the
+  // allocator's event queue in between, so that interleaved events
+  // (e.g., declines, revives) are handled with bounded latency even
+  // when a full pass over a large cluster takes a long time.
+  _allocate(slaveIds, 0);
+}
+
+
+void HierarchicalAllocatorProcess::_allocate(
+    const vector<SlaveID>& slaveIds_,
+    size_t position)
+{
+  if (paused) {
+    VLOG(1) << "Abandoned an in-progress allocation pass because the"
+            << " allocator is paused";
+
+    return;
+  }
+
+  size_t limit =
+    std::min(position + MAX_SLAVES_PER_ALLOCATION_CHUNK, slaveIds_.size());
+
+  // The slaves considered for offers in this chunk, in pass order.
+  vector<SlaveID> slaveIds;
+
+  // All slaves of this chunk that still exist, for `deallocate()`.
+  hashset<SlaveID> chunk;
+
+  // NOTE: Because the pass yields between chunks, slaves may have
+  // been removed, deactivated, or activated since the pass iteration
+  // snapshot was taken, so we re-validate the slaves here.
+  for (size_t i = position; i < limit; i++) {
+    const SlaveID& slaveId = slaveIds_[i];
+
+    if (!slaves.contains(slaveId)) {
+      continue;
+    }
+
+    chunk.insert(slaveId);
+
+    if (isWhitelisted(slaveId) && slaves[slaveId].activated) {
+      slaveIds.push_back(slaveId);
+    }
+  }
+
   // Compute the offerable resources, per framework:
   //   (1) For reserved resources on the slave, allocate these to a
   //       framework having the corresponding role.
@@ -1125,20 +1564,12 @@ void HierarchicalAllocatorProcess::allocate(
   // make sure that we don't assume cluster knowledge when summing resources
   // from that set.
 
-  vector<SlaveID> slaveIds;
-  slaveIds.reserve(slaveIds_.size());
-
-  // Filter out non-whitelisted and deactivated slaves in order not to send
-  // offers for them.
-  foreach (const SlaveID& slaveId, slaveIds_) {
-    if (isWhitelisted(slaveId) && slaves[slaveId].activated) {
-      slaveIds.push_back(slaveId);
-    }
-  }
-
-  // Randomize the order in which slaves' resources are allocated.
-  // TODO(vinod): Implement a smarter sorting algorithm.
-  std::random_shuffle(slaveIds.begin(), slaveIds.end());
+  // Precompute the available resources per slave. This is the
+  // embarrassingly parallel part of offer generation and is sharded
+  // across worker threads for large slave sets; the sequential DRF
+  // decision loops below operate on the merged result and keep it up
+  // to date as they allocate.
+  hashmap<SlaveID, Resources> available = availableResources(slaveIds);
 
   // Quota comes first and fair share second. Here we process only those
   // roles, for which quota is set (quota'ed roles). Such roles form a
@@ -1153,13 +1584,14 @@ void HierarchicalAllocatorProcess::allocate(
         continue;
       }
 
-      // Summing up resources is fine because quota is only for scalar
-      // resources.
+      // Looking at aggregated scalars is fine because quota is only
+      // for scalar resources. The sorter maintains this aggregate
+      // incrementally, so the check is O(1) in the number of agents.
       // NOTE: Reserved and revocable resources are excluded in
       // `quotaRoleSorter`.
       // TODO(alexr): Consider including dynamically reserved resources.
-      Resources roleConsumedResources =
-        Resources::sum(quotaRoleSorter->allocation(role));
+      const Resources& roleConsumedResources =
+        quotaRoleSorter->allocationScalars(role);
 
       // If quota for the role is satisfied, we do not need to do any further
       // allocations for this role, at least at this stage.
@@ -1176,17 +1608,19 @@ void HierarchicalAllocatorProcess::allocate(
         FrameworkID frameworkId;
         frameworkId.set_value(frameworkId_);
 
+        // Look the framework up once for this (framework, agent) pair.
+        Framework& framework = frameworks[frameworkId];
+
         // If the framework has suppressed offers, ignore. The Unallocated
         // part of the quota will not be allocated to other roles.
-        if (frameworks[frameworkId].suppressed) {
+        if (framework.suppressed) {
           continue;
         }
 
         // Quota is satisfied from the available unreserved non-revocable
         // resources on the agent.
         // TODO(alexr): Consider adding dynamically reserved resources.
-        Resources available = slaves[slaveId].total - slaves[slaveId].allocated;
-        Resources resources = available.unreserved().nonRevocable();
+        Resources resources = available[slaveId].unreserved().nonRevocable();
 
         // NOTE: The resources may not be allocatable here, but they can be
         // accepted by one of the frameworks during the second allocation
@@ -1210,6 +1644,7 @@ void HierarchicalAllocatorProcess::allocate(
         // quota. This is fine since quota currently represents a guarantee.
         offerable[frameworkId][slaveId] += resources;
         slaves[slaveId].allocated += resources;
+        available[slaveId] -= resources;
 
         // Resources allocated as part of the quota count towards the
         // role's and the framework's fair share.
@@ -1244,7 +1679,7 @@ void HierarchicalAllocatorProcess::allocate(
   foreachpair (const string& name, const Quota& quota, quotas) {
     // Compute the amount of quota that the role does not have allocated.
     // NOTE: Reserved and revocable resources are excluded in `quotaRoleSorter`.
-    Resources allocated = Resources::sum(quotaRoleSorter->allocation(name));
+    const Resources& allocated = quotaRoleSorter->allocationScalars(name);
     const Resources required = quota.info.guarantee();
     unallocatedQuotaResources += (required - allocated);
   }
@@ -1278,21 +1713,22 @@ void HierarchicalAllocatorProcess::allocate(
         FrameworkID frameworkId;
         frameworkId.set_value(frameworkId_);
 
+        // Look the framework up once for this (framework, agent) pair.
+        Framework& framework = frameworks[frameworkId];
+
         // If the framework has suppressed offers, ignore.
-        if (frameworks[frameworkId].suppressed) {
+        if (framework.suppressed) {
           continue;
         }
 
-        // Calculate the currently available resources on the slave.
-        Resources available = slaves[slaveId].total - slaves[slaveId].allocated;
-
         // NOTE: Currently, frameworks are allowed to have '*' role.
         // Calling reserved('*') returns an empty Resources object.
-        Resources resources = available.unreserved() + available.reserved(role);
+        Resources resources =
+          available[slaveId].unreserved() + available[slaveId].reserved(role);
 
         // Remove revocable resources if the framework has not opted
         // for them.
-        if (!frameworks[frameworkId].revocable) {
+        if (!framework.revocable) {
           resources = resources.nonRevocable();
         }
 
@@ -1325,6 +1761,7 @@ void HierarchicalAllocatorProcess::allocate(
         offerable[frameworkId][slaveId] += resources;
         allocatedStage2 += resources;
         slaves[slaveId].allocated += resources;
+        available[slaveId] -= resources;
 
         // Reserved resources are only accounted for in the framework
         // sorter, since the reserved resources are not shared across
@@ -1344,16 +1781,27 @@ void HierarchicalAllocatorProcess::allocate(
   if (offerable.empty()) {
     VLOG(1) << "No resources available to allocate!";
   } else {
-    // Now offer the resources to each framework.
+    // Now offer the resources to each framework. We move the
+    // offered resources into the callback (which takes them by
+    // value) so that they are not deep copied on their way through
+    // the deferred dispatch to the master.
     foreachkey (const FrameworkID& frameworkId, offerable) {
-      offerCallback(frameworkId, offerable[frameworkId]);
+      offerCallback(frameworkId, std::move(offerable[frameworkId]));
     }
   }
 
   // NOTE: For now, we implement maintenance inverse offers within the
   // allocator. We leverage the existing timer/cycle of offers to also do any
   // "deallocation" (inverse offers) necessary to satisfy maintenance needs.
-  deallocate(slaveIds_);
+  deallocate(chunk);
+
+  if (limit < slaveIds_.size()) {
+    VLOG(1) << "Deferring continuation of the allocation pass: "
+            << (slaveIds_.size() - limit) << " of " << slaveIds_.size()
+            << " slaves remaining";
+
+    dispatch(self(), &Self::_allocate, slaveIds_, limit);
+  }
 }
 
 
@@ -1463,6 +1911,13 @@ void HierarchicalAllocatorProcess::expire(
     if (frameworks[frameworkId].offerFilters[slaveId].empty()) {
       frameworks[frameworkId].offerFilters.erase(slaveId);
     }
+
+    // The previously filtered resources may now be offerable to this
+    // framework, so consider the slave during the next batch
+    // allocation.
+    if (slaves.contains(slaveId)) {
+      dirtySlaves.insert(slaveId);
+    }
   }
 
   delete offerFilter;
@@ -1523,16 +1978,26 @@ bool HierarchicalAllocatorProcess::isFiltered(
   CHECK(frameworks.contains(frameworkId));
   CHECK(slaves.contains(slaveId));
 
-  if (frameworks[frameworkId].offerFilters.contains(slaveId)) {
-    foreach (
-      OfferFilter* offerFilter, frameworks[frameworkId].offerFilters[slaveId]) {
-      if (offerFilter->filter(resources)) {
-        VLOG(1) << "Filtered offer with " << resources
-                << " on slave " << slaveId
-                << " for framework " << frameworkId;
+  // NOTE: This runs for every (framework, agent) pair in the
+  // allocation loops, so we locate the filter set with a single
+  // lookup per map instead of a 'contains' followed by 'operator[]'
+  // (which hash the IDs all over again).
+  Framework& framework = frameworks[frameworkId];
 
-        return true;
-      }
+  hashmap<SlaveID, hashset<OfferFilter*>>::const_iterator filters =
+    framework.offerFilters.find(slaveId);
+
+  if (filters == framework.offerFilters.end()) {
+    return false;
+  }
+
+  foreach (OfferFilter* offerFilter, filters->second) {
+    if (offerFilter->filter(resources)) {
+      VLOG(1) << "Filtered offer with " << resources
+              << " on slave " << slaveId
+              << " for framework " << frameworkId;
+
+      return true;
     }
   }
 
@@ -1547,16 +2012,21 @@ bool HierarchicalAllocatorProcess::isFiltered(
   CHECK(frameworks.contains(frameworkId));
   CHECK(slaves.contains(slaveId));
 
-  if (frameworks[frameworkId].inverseOfferFilters.contains(slaveId)) {
-    foreach (
-        InverseOfferFilter* inverseOfferFilter,
-        frameworks[frameworkId].inverseOfferFilters[slaveId]) {
-      if (inverseOfferFilter->filter()) {
-        VLOG(1) << "Filtered unavailability on slave " << slaveId
-                << " for framework " << frameworkId;
+  Framework& framework = frameworks[frameworkId];
 
-        return true;
-      }
+  hashmap<SlaveID, hashset<InverseOfferFilter*>>::const_iterator filters =
+    framework.inverseOfferFilters.find(slaveId);
+
+  if (filters == framework.inverseOfferFilters.end()) {
+    return false;
+  }
+
+  foreach (InverseOfferFilter* inverseOfferFilter, filters->second) {
+    if (inverseOfferFilter->filter()) {
+      VLOG(1) << "Filtered unavailability on slave " << slaveId
+              << " for framework " << frameworkId;
+
+      return true;
     }
   }
 
@@ -18,6 +18,7 @@
 #define __MASTER_ALLOCATOR_MESOS_HIERARCHICAL_HPP__
 
 #include <string>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
@@ -25,8 +26,10 @@
 #include <process/id.hpp>
 #include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/time.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/flat_hashmap.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/option.hpp>
@@ -71,6 +74,7 @@ public:
     : ProcessBase(process::ID::generate("hierarchical-allocator")),
       initialized(false),
       paused(true),
+      batchesSinceFullAllocation(0),
       metrics(*this),
       roleSorter(NULL),
       quotaRoleSorter(NULL),
@@ -88,7 +92,7 @@ public:
       const Duration& allocationInterval,
       const lambda::function<
           void(const FrameworkID&,
-               const hashmap<SlaveID, Resources>&)>& offerCallback,
+               hashmap<SlaveID, Resources>)>& offerCallback,
       const lambda::function<
           void(const FrameworkID&,
                const hashmap<SlaveID, UnavailableResources>&)>&
@@ -157,6 +161,10 @@ public:
       const SlaveID& slaveId,
       const Option<Unavailability>& unavailability);
 
+  void updateUnavailability(
+      const std::vector<mesos::master::allocator::UnavailabilityUpdate>&
+        updates);
+
   void updateInverseOffer(
       const SlaveID& slaveId,
       const FrameworkID& frameworkId,
@@ -164,22 +172,39 @@ public:
       const Option<mesos::master::InverseOfferStatus>& status,
       const Option<Filters>& filters);
 
+  void updateInverseOffer(
+      const std::vector<mesos::master::allocator::InverseOfferUpdate>&
+        updates);
+
   process::Future<
       hashmap<SlaveID, hashmap<FrameworkID, mesos::master::InverseOfferStatus>>>
     getInverseOfferStatuses();
 
+  process::Future<
+      hashmap<std::string, std::vector<mesos::master::allocator::ClientState>>>
+    getSorterState();
+
   void recoverResources(
       const FrameworkID& frameworkId,
       const SlaveID& slaveId,
       const Resources& resources,
       const Option<Filters>& filters);
 
+  void recoverResources(
+      const std::vector<mesos::master::allocator::ResourceRecovery>&
+        recoveries);
+
   void suppressOffers(
       const FrameworkID& frameworkId);
 
   void reviveOffers(
       const FrameworkID& frameworkId);
 
+  void updateOfferHolding(
+      const FrameworkID& frameworkId,
+      const Option<process::Time>& heldSince,
+      const Duration& threshold);
+
   void setQuota(
       const std::string& role,
       const Quota& quota);
@@ -208,9 +233,22 @@ protected:
   // Allocate resources from the specified slaves.
   void allocate(const hashset<SlaveID>& slaveIds);
 
+  // Continues an allocation pass over the given (ordered) slaves
+  // starting at 'position': processes at most one chunk of slaves
+  // and defers the remainder of the pass to the allocator's event
+  // queue, so that other events are handled with bounded latency.
+  void _allocate(const std::vector<SlaveID>& slaveIds, size_t position);
+
   // Send inverse offers from the specified slaves.
   void deallocate(const hashset<SlaveID>& slaveIds);
 
+  // Updates the maintenance state of the specified slave without
+  // triggering an allocation; shared by the single and bulk
+  // `updateUnavailability` overloads.
+  void _updateUnavailability(
+      const SlaveID& slaveId,
+      const Option<Unavailability>& unavailability);
+
   // Remove an offer filter for the specified framework.
   void expire(
       const FrameworkID& frameworkId,
@@ -244,9 +282,24 @@ protected:
 
   bool allocatable(const Resources& resources);
 
+  // Computes the available (i.e., total minus allocated) resources
+  // for each of the specified slaves. The per-slave computations are
+  // independent, hence they are sharded across a pool of worker
+  // threads when the slave count is large enough to amortize the
+  // threading overhead. The results are merged back in the calling
+  // thread, so sorters and other allocator state are only ever
+  // touched from within the allocator actor.
+  hashmap<SlaveID, Resources> availableResources(
+      const std::vector<SlaveID>& slaveIds);
+
   bool initialized;
   bool paused;
 
+  // Number of consecutive batch allocations performed over only the
+  // dirty slaves (see `dirtySlaves` below) since the last full
+  // cluster-wide pass.
+  size_t batchesSinceFullAllocation;
+
   // Recovery data.
   Option<int> expectedAgentCount;
 
@@ -254,7 +307,7 @@ protected:
 
   lambda::function<
       void(const FrameworkID&,
-           const hashmap<SlaveID, Resources>&)> offerCallback;
+           hashmap<SlaveID, Resources>)> offerCallback;
 
   lambda::function<
       void(const FrameworkID&,
@@ -291,6 +344,12 @@ protected:
     // Active offer and inverse offer filters for the framework.
     hashmap<SlaveID, hashset<OfferFilter*>> offerFilters;
     hashmap<SlaveID, hashset<InverseOfferFilter*>> inverseOfferFilters;
+
+    // When the framework started holding its oldest outstanding
+    // offer, and the hold duration beyond which held offers start
+    // to weigh on the framework's share. See 'updateOfferHolding'.
+    Option<process::Time> offerHeldSince;
+    Duration offerHoldThreshold;
   };
 
   double _event_queue_dispatches()
@@ -298,7 +357,11 @@ protected:
     return static_cast<double>(eventCount<process::DispatchEvent>());
   }
 
-  hashmap<FrameworkID, Framework> frameworks;
+  // NOTE: 'frameworks' and 'slaves' use the flat (open addressing)
+  // map since the allocation passes walk and probe them in their
+  // inner loops. Do not hold references to entries across insertions
+  // or erasures; see stout/flat_hashmap.hpp.
+  flat_hashmap<FrameworkID, Framework> frameworks;
 
   struct Slave
   {
@@ -325,6 +388,13 @@ protected:
 
     std::string hostname;
 
+    // The failure domain this agent belongs to: the text value of the
+    // agent's `fault_domain` attribute (e.g. the rack name), or "" if
+    // the agent does not specify one. Allocation iterates agents
+    // grouped by domain so that offers generated back to back tend to
+    // be in the same domain.
+    std::string domain;
+
     // Represents a scheduled unavailability due to maintenance for a specific
     // slave, and the responses from frameworks as to whether they will be able
     // to gracefully handle this unavailability.
@@ -360,7 +430,16 @@ protected:
     Option<Maintenance> maintenance;
   };
 
-  hashmap<SlaveID, Slave> slaves;
+  flat_hashmap<SlaveID, Slave> slaves;
+
+  // Slaves whose resources have changed since the last allocation
+  // pass over them. Event-driven updates (e.g., `recoverResources`,
+  // `updateAllocation`, offer filter expiration) accumulate the
+  // affected slaves here so that `batch()` can run the allocation
+  // algorithm over only these slaves instead of the whole cluster.
+  // A full cluster-wide pass is still performed periodically as a
+  // fallback for state changes that do not mark slaves dirty.
+  hashset<SlaveID> dirtySlaves;
 
   // Number of registered frameworks for each role. When a role's active
   // count drops to zero, it is removed from this map; the role is also
@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stout/foreach.hpp>
+
 #include "logging/logging.hpp"
 
 #include "master/allocator/sorter/drf/sorter.hpp"
@@ -21,12 +23,40 @@
 using std::list;
 using std::set;
 using std::string;
+using std::vector;
 
 namespace mesos {
 namespace internal {
 namespace master {
 namespace allocator {
 
+// Helpers for incrementally maintaining per resource name sums of
+// scalar values (see the 'totals' members in the sorter).
+//
+// NOTE: Scalar resources may be spread across multiple 'Resource'
+// objects. E.g. persistent volumes.
+static void increment(
+    hashmap<string, double>* totals,
+    const Resources& scalars)
+{
+  foreach (const Resource& resource, scalars) {
+    CHECK_EQ(resource.type(), Value::SCALAR);
+    (*totals)[resource.name()] += resource.scalar().value();
+  }
+}
+
+
+static void decrement(
+    hashmap<string, double>* totals,
+    const Resources& scalars)
+{
+  foreach (const Resource& resource, scalars) {
+    CHECK_EQ(resource.type(), Value::SCALAR);
+    (*totals)[resource.name()] -= resource.scalar().value();
+  }
+}
+
+
 bool DRFComparator::operator()(const Client& client1, const Client& client2)
 {
   if (client1.share == client2.share) {
@@ -42,7 +72,7 @@ bool DRFComparator::operator()(const Client& client1, const Client& client2)
 void DRFSorter::add(const string& name, double weight)
 {
   Client client(name, 0, 0);
-  clients.insert(client);
+  index[name] = clients.insert(client).first;
 
   allocations[name] = Allocation();
   weights[name] = weight;
@@ -55,10 +85,22 @@ void DRFSorter::remove(const string& name)
 
   if (it != clients.end()) {
     clients.erase(it);
+    index.erase(name);
+  }
+
+  if (allocations.contains(name)) {
+    foreachkey (const SlaveID& slaveId, allocations.at(name).resources) {
+      allocationsBySlave[slaveId].erase(name);
+      if (allocationsBySlave[slaveId].empty()) {
+        allocationsBySlave.erase(slaveId);
+      }
+    }
   }
 
+  dirtyClients.erase(name);
   allocations.erase(name);
   weights.erase(name);
+  penalties.erase(name);
 }
 
 
@@ -67,7 +109,7 @@ void DRFSorter::activate(const string& name)
   CHECK(allocations.contains(name));
 
   Client client(name, calculateShare(name), 0);
-  clients.insert(client);
+  index[name] = clients.insert(client).first;
 }
 
 
@@ -81,7 +123,26 @@ void DRFSorter::deactivate(const string& name)
     // for this client which means the fairness can be gamed by a
     // framework disconnecting and reconnecting.
     clients.erase(it);
+    index.erase(name);
   }
+
+  dirtyClients.erase(name);
+}
+
+
+void DRFSorter::penalize(const string& name, double penalty)
+{
+  CHECK_GE(penalty, 1.0);
+
+  if (penalties.get(name).getOrElse(1.0) == penalty) {
+    return;
+  }
+
+  penalties[name] = penalty;
+
+  // Put off rescoring the client until sort(), as for allocation
+  // changes.
+  dirtyClients.insert(name);
 }
 
 
@@ -100,19 +161,21 @@ void DRFSorter::allocated(
     client.allocations++;
 
     // Remove and reinsert it to update the ordering appropriately.
+    // NOTE: The share is left stale here; it is recalculated lazily
+    // in sort() since this client is marked dirty below.
     clients.erase(it);
-    clients.insert(client);
+    index[name] = clients.insert(client).first;
   }
 
   allocations[name].resources[slaveId] += resources;
   allocations[name].scalars += resources.scalars();
+  increment(&allocations[name].totals, resources.scalars());
 
-  // If the total resources have changed, we're going to
-  // recalculate all the shares, so don't bother just
-  // updating this client.
-  if (!dirty) {
-    update(name);
-  }
+  allocationsBySlave[slaveId].insert(name);
+
+  // Put off recalculating this client's share until sort() so that
+  // multiple allocations before the next sort are rescored once.
+  dirtyClients.insert(name);
 }
 
 
@@ -138,6 +201,9 @@ void DRFSorter::update(
   total.scalars -= oldAllocation.scalars();
   total.scalars += newAllocation.scalars();
 
+  decrement(&total.totals, oldAllocation.scalars());
+  increment(&total.totals, newAllocation.scalars());
+
   CHECK(allocations[name].resources[slaveId].contains(oldAllocation));
   CHECK(allocations[name].scalars.contains(oldAllocation.scalars()));
 
@@ -147,6 +213,9 @@ void DRFSorter::update(
   allocations[name].scalars -= oldAllocation.scalars();
   allocations[name].scalars += newAllocation.scalars();
 
+  decrement(&allocations[name].totals, oldAllocation.scalars());
+  increment(&allocations[name].totals, newAllocation.scalars());
+
   // Just assume the total has changed, per the TODO above.
   dirty = true;
 }
@@ -162,18 +231,23 @@ hashmap<SlaveID, Resources> DRFSorter::allocation(const string& name)
 
 hashmap<std::string, Resources> DRFSorter::allocation(const SlaveID& slaveId)
 {
-  // TODO(jmlvanre): We can index the allocation by slaveId to make this faster.
-  // It is a tradeoff between speed vs. memory. For now we use existing data
-  // structures.
-
   hashmap<std::string, Resources> result;
 
-  foreachpair (const string& name, const Allocation& allocation, allocations) {
-    if (allocation.resources.contains(slaveId)) {
-      // It is safe to use `at()` here because we've just checked the existence
-      // of the key. This avoid un-necessary copies.
-      result.emplace(name, allocation.resources.at(slaveId));
-    }
+  // We use the slave index so that only the clients with resources
+  // on this slave are touched; this is on the maintenance inverse
+  // offer path, where it runs for every draining slave.
+  hashmap<SlaveID, hashset<string>>::const_iterator it =
+    allocationsBySlave.find(slaveId);
+
+  if (it == allocationsBySlave.end()) {
+    return result;
+  }
+
+  foreach (const string& name, it->second) {
+    // It is safe to use `at()` here because the index is kept in sync
+    // with the per-slave entries of `allocations`. This avoids
+    // un-necessary copies.
+    result.emplace(name, allocations.at(name).resources.at(slaveId));
   }
 
   return result;
@@ -192,6 +266,14 @@ Resources DRFSorter::allocation(const string& name, const SlaveID& slaveId)
 }
 
 
+const Resources& DRFSorter::allocationScalars(const string& name)
+{
+  CHECK(contains(name));
+
+  return allocations[name].scalars;
+}
+
+
 void DRFSorter::unallocated(
     const string& name,
     const SlaveID& slaveId,
@@ -199,14 +281,19 @@ void DRFSorter::unallocated(
 {
   allocations[name].resources[slaveId] -= resources;
   allocations[name].scalars -= resources.scalars();
+  decrement(&allocations[name].totals, resources.scalars());
 
   if (allocations[name].resources[slaveId].empty()) {
     allocations[name].resources.erase(slaveId);
-  }
 
-  if (!dirty) {
-    update(name);
+    allocationsBySlave[slaveId].erase(name);
+    if (allocationsBySlave[slaveId].empty()) {
+      allocationsBySlave.erase(slaveId);
+    }
   }
+
+  // Put off recalculating this client's share until sort().
+  dirtyClients.insert(name);
 }
 
 
@@ -215,6 +302,7 @@ void DRFSorter::add(const SlaveID& slaveId, const Resources& resources)
   if (!resources.empty()) {
     total.resources[slaveId] += resources;
     total.scalars += resources.scalars();
+    increment(&total.totals, resources.scalars());
 
     // We have to recalculate all shares when the total resources
     // change, but we put it off until sort is called so that if
@@ -232,6 +320,7 @@ void DRFSorter::remove(const SlaveID& slaveId, const Resources& resources)
 
     total.resources[slaveId] -= resources;
     total.scalars -= resources.scalars();
+    decrement(&total.totals, resources.scalars());
 
     if (total.resources[slaveId].empty()) {
       total.resources.erase(slaveId);
@@ -249,6 +338,9 @@ void DRFSorter::update(const SlaveID& slaveId, const Resources& resources)
   total.scalars -= total.resources[slaveId].scalars();
   total.scalars += resources.scalars();
 
+  decrement(&total.totals, total.resources[slaveId].scalars());
+  increment(&total.totals, resources.scalars());
+
   total.resources[slaveId] = resources;
 
   if (total.resources[slaveId].empty()) {
@@ -262,6 +354,8 @@ void DRFSorter::update(const SlaveID& slaveId, const Resources& resources)
 list<string> DRFSorter::sort()
 {
   if (dirty) {
+    // The total resources changed, so all shares are stale and we
+    // have to rescore every client.
     set<Client, DRFComparator> temp;
 
     set<Client, DRFComparator>::iterator it;
@@ -275,8 +369,24 @@ list<string> DRFSorter::sort()
     }
 
     clients = temp;
+
+    // Rebuild the name index, since all iterators changed.
+    index.clear();
+    for (it = clients.begin(); it != clients.end(); it++) {
+      index[(*it).name] = it;
+    }
+
+    dirty = false;
+  } else {
+    // Only rescore the clients whose allocation changed since the
+    // last sort; each is an O(log n) reposition in the set.
+    foreach (const string& name, dirtyClients) {
+      update(name);
+    }
   }
 
+  dirtyClients.clear();
+
   list<string> result;
 
   set<Client, DRFComparator>::iterator it;
@@ -300,6 +410,33 @@ int DRFSorter::count()
 }
 
 
+vector<mesos::master::allocator::ClientState> DRFSorter::state()
+{
+  vector<mesos::master::allocator::ClientState> result;
+  result.reserve(allocations.size());
+
+  foreachpair (const string& name, const Allocation& allocation, allocations) {
+    mesos::master::allocator::ClientState client;
+    client.name = name;
+    client.weight = weights.get(name).getOrElse(1.0);
+
+    // NOTE: We recalculate the share rather than copying it out of
+    // `clients` since shares there may be stale (they are updated
+    // lazily in `sort`, see `dirtyClients`) and deactivated clients
+    // are not in `clients` at all. The calculation only walks the
+    // incrementally maintained per resource name totals, so this
+    // remains O(clients).
+    client.share = calculateShare(name);
+    client.active = index.contains(name);
+    client.allocation = allocation.totals;
+
+    result.push_back(client);
+  }
+
+  return result;
+}
+
+
 void DRFSorter::update(const string& name)
 {
   set<Client, DRFComparator>::iterator it = find(name);
@@ -312,7 +449,7 @@ void DRFSorter::update(const string& name)
 
     // Remove and reinsert it to update the ordering appropriately.
     clients.erase(it);
-    clients.insert(client);
+    index[name] = clients.insert(client).first;
   }
 }
 
@@ -325,45 +462,27 @@ double DRFSorter::calculateShare(const string& name)
   // currently does not take into account resources that are not
   // scalars.
 
-  foreach (const string& scalar, total.scalars.names()) {
-    double _total = 0.0;
-
-    // NOTE: Scalar resources may be spread across multiple
-    // 'Resource' objects. E.g. persistent volumes.
-    foreach (const Resource& resource, total.scalars.get(scalar)) {
-      CHECK_EQ(resource.type(), Value::SCALAR);
-      _total += resource.scalar().value();
-    }
+  const Allocation& allocation = allocations[name];
 
+  foreachpair (const string& scalar, double _total, total.totals) {
     if (_total > 0.0) {
-      double allocation = 0.0;
-
-      // NOTE: Scalar resources may be spread across multiple
-      // 'Resource' objects. E.g. persistent volumes.
-      foreach (const Resource& resource,
-               allocations[name].scalars.get(scalar)) {
-        CHECK_EQ(resource.type(), Value::SCALAR);
-        allocation += resource.scalar().value();
-      }
+      double allocated = allocation.totals.get(scalar).getOrElse(0.0);
 
-      share = std::max(share, allocation / _total);
+      share = std::max(share, allocated / _total);
     }
   }
 
-  return share / weights[name];
+  return share * penalties.get(name).getOrElse(1.0) / weights[name];
 }
 
 
 set<Client, DRFComparator>::iterator DRFSorter::find(const string& name)
 {
-  set<Client, DRFComparator>::iterator it;
-  for (it = clients.begin(); it != clients.end(); it++) {
-    if (name == (*it).name) {
-      break;
-    }
+  if (index.contains(name)) {
+    return index[name];
   }
 
-  return it;
+  return clients.end();
 }
 
 } // namespace allocator {
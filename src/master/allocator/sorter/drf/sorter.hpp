@@ -19,10 +19,13 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/resources.hpp>
 
+#include <stout/flat_hashmap.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 
 #include "master/allocator/sorter/sorter.hpp"
 
@@ -61,6 +64,8 @@ struct DRFComparator
 class DRFSorter : public Sorter
 {
 public:
+  DRFSorter() : dirty(false) {}
+
   virtual ~DRFSorter() {}
 
   virtual void add(const std::string& name, double weight = 1);
@@ -71,6 +76,8 @@ public:
 
   virtual void deactivate(const std::string& name);
 
+  virtual void penalize(const std::string& name, double penalty);
+
   virtual void allocated(
       const std::string& name,
       const SlaveID& slaveId,
@@ -93,6 +100,8 @@ public:
 
   virtual Resources allocation(const std::string& name, const SlaveID& slaveId);
 
+  virtual const Resources& allocationScalars(const std::string& name);
+
   virtual void add(const SlaveID& slaveId, const Resources& resources);
 
   virtual void remove(const SlaveID& slaveId, const Resources& resources);
@@ -105,6 +114,8 @@ public:
 
   virtual int count();
 
+  virtual std::vector<mesos::master::allocator::ClientState> state();
+
 private:
   // Recalculates the share for the client and moves
   // it in 'clients' accordingly.
@@ -117,15 +128,34 @@ private:
   // it exists in this Sorter.
   std::set<Client, DRFComparator>::iterator find(const std::string& name);
 
-  // If true, sort() will recalculate all shares.
+  // If true, sort() will recalculate all shares. This is only
+  // necessary when the total resources change, since all shares
+  // depend on the total.
   bool dirty;
 
+  // Clients whose allocation changed since the last sort(). Their
+  // shares are recalculated lazily in sort(), so that an allocation
+  // pass only rescores the clients that actually changed instead of
+  // every client. Ignored when `dirty` is set, since a full rescore
+  // subsumes it.
+  hashset<std::string> dirtyClients;
+
   // A set of Clients (names and shares) sorted by share.
   std::set<Client, DRFComparator> clients;
 
+  // An index from client name to its position in `clients`, so that
+  // lookups are O(1) instead of a linear scan over the set. Note that
+  // `std::set` iterators remain valid until erased, so the index only
+  // needs updating where `clients` itself is updated.
+  hashmap<std::string, std::set<Client, DRFComparator>::iterator> index;
+
   // Maps client names to the weights that should be applied to their shares.
   hashmap<std::string, double> weights;
 
+  // Maps client names to share penalties (see 'penalize'). Clients
+  // without an entry are unpenalized (factor 1.0).
+  hashmap<std::string, double> penalties;
+
   // Total resources.
   struct Total {
     hashmap<SlaveID, Resources> resources;
@@ -134,6 +164,11 @@ private:
     // that to speed up the calculation of shares. See MESOS-2891 for
     // the reasons why we want to do that.
     Resources scalars;
+
+    // Incrementally maintained sum of 'scalars' per resource name,
+    // so that calculating a share does not re-aggregate the
+    // 'Resource' objects for every client on every sort.
+    hashmap<std::string, double> totals;
   } total;
 
   // Allocation for a client.
@@ -142,10 +177,25 @@ private:
 
     // Similarly, we aggregated scalars across slaves. See note above.
     Resources scalars;
+
+    // Incrementally maintained sum of 'scalars' per resource name.
+    // See note above.
+    hashmap<std::string, double> totals;
   };
 
   // Maps client names to the resources they have been allocated.
-  hashmap<std::string, Allocation> allocations;
+  // Kept in a flat (open addressing) map since every allocation and
+  // recovery probes it; clients are only inserted and erased when
+  // they are added to or removed from the sorter, so references into
+  // it are safe to hold within a single allocation operation.
+  flat_hashmap<std::string, Allocation> allocations;
+
+  // An index from slave to the names of the clients that have
+  // resources allocated on it, so that `allocation(slaveId)` (used,
+  // e.g., to target maintenance inverse offers) only touches the
+  // interested clients rather than scanning every client. Kept in
+  // sync with the per-slave entries of `allocations` above.
+  hashmap<SlaveID, hashset<std::string>> allocationsBySlave;
 };
 
 } // namespace allocator {
@@ -19,10 +19,13 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <mesos/resources.hpp>
 #include <mesos/type_utils.hpp>
 
+#include <mesos/master/allocator.hpp>
+
 namespace mesos {
 namespace internal {
 namespace master {
@@ -53,6 +56,13 @@ public:
   // Removes a client from the sort, so it won't get allocated to.
   virtual void deactivate(const std::string& client) = 0;
 
+  // Sets a multiplicative penalty (>= 1.0) applied to the client's
+  // share when sorting; 1.0 means no penalty. A penalized client
+  // sorts as if its share were proportionally larger, pushing it
+  // towards the end of the allocation order (e.g., because it is
+  // hoarding offers).
+  virtual void penalize(const std::string& client, double penalty) = 0;
+
   // Specify that resources have been allocated to the given client.
   virtual void allocated(
       const std::string& client,
@@ -88,6 +98,13 @@ public:
       const std::string& client,
       const SlaveID& slaveId) = 0;
 
+  // Returns the total scalar resources that have been allocated to
+  // this client, aggregated across slaves. Sorters maintain this
+  // aggregate incrementally, so callers that only care about scalar
+  // quantities (e.g., quota accounting) should prefer this over
+  // summing up the per-slave `allocation`.
+  virtual const Resources& allocationScalars(const std::string& client) = 0;
+
   // Add resources to the total pool of resources this
   // Sorter should consider.
   virtual void add(const SlaveID& slaveId, const Resources& resources) = 0;
@@ -109,6 +126,13 @@ public:
   // Returns the number of clients this Sorter contains,
   // either active or deactivated.
   virtual int count() = 0;
+
+  // Returns a snapshot of the state of every client (active or
+  // deactivated) for introspection, see the master's '/allocator'
+  // endpoint. Implementations must maintain the underlying state
+  // incrementally: this runs on the allocator and must be O(clients)
+  // so that it does not perturb the allocation cycle.
+  virtual std::vector<mesos::master::allocator::ClientState> state() = 0;
 };
 
 } // namespace allocator {
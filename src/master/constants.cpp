@@ -35,9 +35,18 @@ const size_t DEFAULT_MAX_SLAVE_PING_TIMEOUTS = 5;
 const Duration MIN_SLAVE_REREGISTER_TIMEOUT = Minutes(10);
 const double RECOVERY_SLAVE_REMOVAL_PERCENT_LIMIT = 1.0; // 100%.
 const size_t MAX_REMOVED_SLAVES = 100000;
+const size_t MAX_RESCINDED_OFFERS = 10000;
 const size_t DEFAULT_MAX_COMPLETED_FRAMEWORKS = 50;
 const size_t DEFAULT_MAX_COMPLETED_TASKS_PER_FRAMEWORK = 1000;
+const Duration DEFAULT_STANDBY_STATE_CACHE_TTL = Seconds(5);
 const Duration WHITELIST_WATCH_INTERVAL = Seconds(5);
+const size_t RECONCILIATION_BATCH_SIZE = 1000;
+const size_t SLAVE_REMOVAL_BATCH_SIZE = 1000;
+const size_t OFFER_RESCIND_BATCH_SIZE = 1000;
+const Bytes MAX_EVENT_STREAM_BACKLOG = Megabytes(64);
+const Duration RATE_LIMIT_ADAPTATION_INTERVAL = Seconds(1);
+const size_t RATE_LIMIT_SATURATION_QUEUE_SIZE = 1000;
+const double RATE_LIMIT_MAX_HEADROOM_BOOST = 10.0;
 const uint32_t TASK_LIMIT = 100;
 const std::string MASTER_INFO_LABEL = "info";
 const std::string MASTER_INFO_JSON_LABEL = "json.info";
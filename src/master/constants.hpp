@@ -87,6 +87,10 @@ extern const double RECOVERY_SLAVE_REMOVAL_PERCENT_LIMIT;
 // Maximum number of removed slaves to store in the cache.
 extern const size_t MAX_REMOVED_SLAVES;
 
+// Maximum number of rescinded offers to remember for reconciling
+// ACCEPT calls that were in flight when the offer was rescinded.
+extern const size_t MAX_RESCINDED_OFFERS;
+
 // Default maximum number of completed frameworks to store in the cache.
 extern const size_t DEFAULT_MAX_COMPLETED_FRAMEWORKS;
 
@@ -94,9 +98,57 @@ extern const size_t DEFAULT_MAX_COMPLETED_FRAMEWORKS;
 // to store in the cache.
 extern const size_t DEFAULT_MAX_COMPLETED_TASKS_PER_FRAMEWORK;
 
+// Default time a non-leading master serves a cached copy of the
+// leading master's state before fetching a fresh one. See the
+// --standby_state_cache flag.
+extern const Duration DEFAULT_STANDBY_STATE_CACHE_TTL;
+
 // Time interval to check for updated watchers list.
 extern const Duration WHITELIST_WATCH_INTERVAL;
 
+// Maximum number of explicit reconciliation responses generated in a
+// single dispatch on the master actor. Larger reconciliation requests
+// are answered in batches of this size, interleaved with the rest of
+// the master's work.
+extern const size_t RECONCILIATION_BATCH_SIZE;
+
+// Maximum number of TASK_LOST status updates forwarded to a single
+// framework per dispatch on the master actor when a slave has been
+// removed. Denser slaves (and correlated slave failures) are handled
+// in batches of this size, interleaved with the rest of the master's
+// work.
+extern const size_t SLAVE_REMOVAL_BATCH_SIZE;
+
+// Maximum number of rescind messages sent to a single framework per
+// dispatch on the master actor when all of its offers are rescinded
+// at once (e.g., on disconnect). A framework holding many offers has
+// them rescinded in batches of this size, interleaved with the rest
+// of the master's work.
+extern const size_t OFFER_RESCIND_BATCH_SIZE;
+
+// Maximum amount of encoded event data the master will buffer for a
+// streaming HTTP scheduler connection whose consumer is not keeping
+// up. The connection is closed when the limit is exceeded, prompting
+// the scheduler to re-subscribe, rather than letting the backlog
+// grow without bound in the master's memory.
+extern const Bytes MAX_EVENT_STREAM_BACKLOG;
+
+// Interval at which the master adapts the effective framework rate
+// limits to its current load. See 'Master::adaptRateLimits'.
+extern const Duration RATE_LIMIT_ADAPTATION_INTERVAL;
+
+// Event queue length at which the master considers itself saturated
+// for the purpose of adapting framework rate limits: at or beyond
+// this backlog the configured (worst case) limits are enforced
+// as-is, with no idle boost.
+extern const size_t RATE_LIMIT_SATURATION_QUEUE_SIZE;
+
+// Maximum multiple of a framework's configured rate limit that is
+// granted when the master is completely idle. The effective limit
+// scales linearly between the configured limit (saturated) and this
+// multiple of it (idle).
+extern const double RATE_LIMIT_MAX_HEADROOM_BOOST;
+
 // Default number of tasks (limit) for /master/tasks endpoint.
 extern const uint32_t TASK_LIMIT;
 
@@ -14,8 +14,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <mutex>
 #include <set>
 #include <string>
+#include <utility>
 
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
@@ -27,8 +29,10 @@
 
 #include <stout/duration.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/protobuf.hpp>
+#include <stout/synchronized.hpp>
 
 #include "common/protobuf_utils.hpp"
 
@@ -194,6 +198,48 @@ private:
 };
 
 
+// All ZooKeeper based detectors created through
+// 'MasterDetector::create' for the same URL share one ZooKeeper
+// session (Group) per process, so that co-located drivers (e.g., a
+// host running many schedulers in a single process) do not each
+// maintain a redundant session and set of watches on the ZooKeeper
+// servers. An entry is dropped once the last detector sharing the
+// group is destroyed.
+struct SharedGroups
+{
+  std::mutex mutex;
+  hashmap<string, std::pair<Owned<Group>, size_t>> groups;
+};
+
+static SharedGroups* sharedGroups = new SharedGroups();
+
+
+// A ZooKeeperMasterDetector that releases its reference on the
+// shared Group cache when it is destroyed.
+class SharedZooKeeperMasterDetector : public ZooKeeperMasterDetector
+{
+public:
+  SharedZooKeeperMasterDetector(
+      const Owned<Group>& group,
+      const string& _key)
+    : ZooKeeperMasterDetector(group), key(_key) {}
+
+  virtual ~SharedZooKeeperMasterDetector()
+  {
+    synchronized (sharedGroups->mutex) {
+      CHECK(sharedGroups->groups.contains(key));
+
+      if (--sharedGroups->groups[key].second == 0) {
+        sharedGroups->groups.erase(key);
+      }
+    }
+  }
+
+private:
+  const string key;
+};
+
+
 Try<MasterDetector*> MasterDetector::create(const Option<string>& _mechanism)
 {
   if (_mechanism.isNone()) {
@@ -211,7 +257,29 @@ Try<MasterDetector*> MasterDetector::create(const Option<string>& _mechanism)
       return Error(
           "Expecting a (chroot) path for ZooKeeper ('/' is not supported)");
     }
-    return new ZooKeeperMasterDetector(url.get());
+
+    // Share one ZooKeeper session between all detectors created for
+    // the same URL within this process.
+    synchronized (sharedGroups->mutex) {
+      if (sharedGroups->groups.contains(mechanism)) {
+        std::pair<Owned<Group>, size_t>& entry =
+          sharedGroups->groups[mechanism];
+
+        entry.second++;
+
+        return new SharedZooKeeperMasterDetector(entry.first, mechanism);
+      }
+
+      Owned<Group> group(new Group(
+          url.get().servers,
+          MASTER_DETECTOR_ZK_SESSION_TIMEOUT,
+          url.get().path,
+          url.get().authentication));
+
+      sharedGroups->groups[mechanism] = std::make_pair(group, 1u);
+
+      return new SharedZooKeeperMasterDetector(group, mechanism);
+    }
   } else if (strings::startsWith(mechanism, "file://")) {
     // Load the configuration out of a file. While Mesos and related
     // programs always use <stout/flags> to process the command line
@@ -145,6 +145,15 @@ mesos::internal::master::Flags::Flags()
       "slaves will be removed as soon as they fail the health checks.\n"
       "The value is of the form <Number of slaves>/<Duration>.");
 
+  add(&Flags::slave_reregistration_rate_limit,
+      "slave_reregistration_rate_limit",
+      "The maximum rate (e.g., 100/1secs, 500/1mins, etc) at which slaves\n"
+      "unknown to the master (i.e., after a master failover) are readmitted\n"
+      "when they re-register. This spreads out the re-registration storm\n"
+      "that follows a master failover. By default re-registrations are\n"
+      "processed as fast as they arrive.\n"
+      "The value is of the form <Number of slaves>/<Duration>.");
+
   add(&Flags::webui_dir,
       "webui_dir",
       "Directory path of the webui files/assets",
@@ -341,6 +350,14 @@ mesos::internal::master::Flags::Flags()
       "This helps fairness when running frameworks that hold on to offers,\n"
       "or frameworks that accidentally drop offers.");
 
+  add(&Flags::offer_hoarding_threshold,
+      "offer_hoarding_threshold",
+      "Duration a framework may hold an offer before the held offer\n"
+      "starts to weigh increasingly on the framework's fair share,\n"
+      "pushing it down the allocation order. Unlike --offer_timeout,\n"
+      "this does not rescind the offer; it only stops hoarding\n"
+      "frameworks from starving everybody else of allocations.");
+
   // This help message for --modules flag is the same for
   // {master,slave,tests}/flags.hpp and should always be kept in
   // sync.
@@ -471,4 +488,21 @@ mesos::internal::master::Flags::Flags()
       "max_completed_tasks_per_framework",
       "Maximum number of completed tasks per framework to store in memory.",
       DEFAULT_MAX_COMPLETED_TASKS_PER_FRAMEWORK);
+
+  add(&Flags::standby_state_cache,
+      "standby_state_cache",
+      "If true, a non-leading master answers read-only endpoints\n"
+      "('/state', '/state-summary', '/tasks') from a cached copy of\n"
+      "the leading master's response instead of serving its own\n"
+      "(empty) state, so that monitoring read traffic can be spread\n"
+      "across standbys. Responses carry an 'X-Mesos-Staleness' header\n"
+      "with the age of the cached copy.",
+      false);
+
+  add(&Flags::standby_state_cache_ttl,
+      "standby_state_cache_ttl",
+      "How long a non-leading master serves a cached copy of the\n"
+      "leading master's state before fetching a fresh one. Only used\n"
+      "with --standby_state_cache.",
+      DEFAULT_STANDBY_STATE_CACHE_TTL);
 }
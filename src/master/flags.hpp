@@ -56,6 +56,7 @@ public:
   Duration slave_reregister_timeout;
   std::string recovery_slave_removal_limit;
   Option<std::string> slave_removal_rate_limit;
+  Option<std::string> slave_reregistration_rate_limit;
   std::string webui_dir;
   Option<Path> whitelist;
   std::string user_sorter;
@@ -72,6 +73,7 @@ public:
   Option<Firewall> firewall_rules;
   Option<RateLimits> rate_limits;
   Option<Duration> offer_timeout;
+  Option<Duration> offer_hoarding_threshold;
   Option<Modules> modules;
   std::string authenticators;
   std::string allocator;
@@ -82,6 +84,8 @@ public:
   std::string http_authenticators;
   size_t max_completed_frameworks;
   size_t max_completed_tasks_per_framework;
+  bool standby_state_cache;
+  Duration standby_state_cache_ttl;
 
 #ifdef WITH_NETWORK_ISOLATOR
   Option<size_t> max_executors_per_slave;
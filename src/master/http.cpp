@@ -14,12 +14,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <iomanip>
 #include <map>
 #include <memory>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -32,7 +34,11 @@
 
 #include <mesos/maintenance/maintenance.hpp>
 
+#include <mesos/master/allocator.hpp>
+
+#include <process/async.hpp>
 #include <process/defer.hpp>
+#include <process/dispatch.hpp>
 #include <process/help.hpp>
 
 #include <process/metrics/metrics.hpp>
@@ -126,10 +132,15 @@ namespace master {
 // Pull in model overrides from common.
 using mesos::internal::model;
 
+// Pull in allocator introspection definitions.
+using mesos::master::allocator::ClientState;
+
 // Pull in definitions from process.
 using process::http::Response;
 using process::http::Request;
+using process::dispatch;
 using process::Owned;
+using process::Promise;
 
 
 // The summary representation of `T` to support the `/state-summary` endpoint.
@@ -287,9 +298,10 @@ void json(JSON::ObjectWriter* writer, const Full<Framework>& full)
   writer->field("executors", [&framework](JSON::ArrayWriter* writer) {
     foreachpair (
         const SlaveID& slaveId, const auto& executorsMap, framework.executors) {
-      foreachvalue (const ExecutorInfo& executor, executorsMap) {
+      foreachvalue (const std::shared_ptr<const ExecutorInfo>& executor,
+                    executorsMap) {
         writer->element([&executor, &slaveId](JSON::ObjectWriter* writer) {
-          json(writer, executor);
+          json(writer, *executor);
           writer->field("slave_id", slaveId.value());
         });
       }
@@ -370,6 +382,25 @@ JSON::Object model(const Framework& framework)
   object.values["unregistered_time"] = framework.unregisteredTime.secs();
   object.values["active"] = framework.active;
 
+  // Per-framework accounting, to help attribute master load. NOTE:
+  // A Counter's value is kept inline so the future below is always
+  // ready; no blocking occurs here.
+  {
+    JSON::Object accounting;
+    accounting.values["messages_received"] =
+      framework.metrics.messages_received.value().get();
+    accounting.values["tasks_launched"] =
+      framework.metrics.tasks_launched.value().get();
+    accounting.values["offers_declined"] =
+      framework.metrics.offers_declined.value().get();
+    accounting.values["reconciliations"] =
+      framework.metrics.reconciliations.value().get();
+    accounting.values["event_stream_bytes"] =
+      framework.metrics.event_stream_bytes.value().get();
+
+    object.values["accounting"] = std::move(accounting);
+  }
+
   if (framework.info.has_principal()) {
     object.values["principal"] = framework.info.principal();
   }
@@ -439,8 +470,9 @@ JSON::Object model(const Framework& framework)
     foreachpair (const SlaveID& slaveId,
                  const auto& executorsMap,
                  framework.executors) {
-      foreachvalue (const ExecutorInfo& executor, executorsMap) {
-        JSON::Object executorJson = model(executor);
+      foreachvalue (const std::shared_ptr<const ExecutorInfo>& executor,
+                    executorsMap) {
+        JSON::Object executorJson = model(*executor);
         executorJson.values["slave_id"] = slaveId.value();
         executors.values.push_back(executorJson);
       }
@@ -511,6 +543,55 @@ void Master::Http::log(const Request& request)
 }
 
 
+// Parses, devolves and validates a v1 scheduler call. This is a pure
+// function of its arguments so that it can run on a worker thread via
+// 'process::async' instead of occupying the master actor.
+static Try<scheduler::Call> parseSchedulerCall(
+    ContentType contentType,
+    const string& body)
+{
+  v1::scheduler::Call v1Call;
+
+  switch (contentType) {
+    case ContentType::PROTOBUF: {
+      if (!v1Call.ParseFromString(body)) {
+        return Error("Failed to parse body into Call protobuf");
+      }
+      break;
+    }
+    case ContentType::JSON: {
+      Try<JSON::Value> value = JSON::parse(body);
+
+      if (value.isError()) {
+        return Error("Failed to parse body into JSON: " + value.error());
+      }
+
+      Try<v1::scheduler::Call> parse =
+        ::protobuf::parse<v1::scheduler::Call>(value.get());
+
+      if (parse.isError()) {
+        return Error("Failed to convert JSON into Call protobuf: " +
+                     parse.error());
+      }
+
+      v1Call = parse.get();
+      break;
+    }
+  }
+
+  scheduler::Call call = devolve(v1Call);
+
+  Option<Error> error = validation::scheduler::call::validate(call);
+
+  if (error.isSome()) {
+    return Error("Failed to validate Scheduler::Call: " +
+                 error.get().message);
+  }
+
+  return call;
+}
+
+
 // TODO(ijimenez): Add some information or pointers to help
 // users understand the HTTP Event/Call API.
 string Master::Http::SCHEDULER_HELP()
@@ -555,8 +636,6 @@ Future<Response> Master::Http::scheduler(const Request& request) const
         {"POST"}, "Expecting 'POST', received '" + request.method + "'");
   }
 
-  v1::scheduler::Call v1Call;
-
   // TODO(anand): Content type values are case-insensitive.
   Option<string> contentType = request.headers.get("Content-Type");
 
@@ -564,41 +643,69 @@ Future<Response> Master::Http::scheduler(const Request& request) const
     return BadRequest("Expecting 'Content-Type' to be present");
   }
 
+  ContentType callContentType;
+
   if (contentType.get() == APPLICATION_PROTOBUF) {
-    if (!v1Call.ParseFromString(request.body)) {
-      return BadRequest("Failed to parse body into Call protobuf");
-    }
+    callContentType = ContentType::PROTOBUF;
   } else if (contentType.get() == APPLICATION_JSON) {
-    Try<JSON::Value> value = JSON::parse(request.body);
-
-    if (value.isError()) {
-      return BadRequest("Failed to parse body into JSON: " + value.error());
-    }
-
-    Try<v1::scheduler::Call> parse =
-      ::protobuf::parse<v1::scheduler::Call>(value.get());
-
-    if (parse.isError()) {
-      return BadRequest("Failed to convert JSON into Call protobuf: " +
-                        parse.error());
-    }
-
-    v1Call = parse.get();
+    callContentType = ContentType::JSON;
   } else {
     return UnsupportedMediaType(
         string("Expecting 'Content-Type' of ") +
         APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
   }
 
-  scheduler::Call call = devolve(v1Call);
+  // Parsing, devolving and validating the call is a pure function of
+  // the request body and is the CPU heavy part of accepting a call
+  // (large ACCEPT calls in particular), so it runs on a worker thread
+  // instead of occupying the master actor.
+  Future<Try<scheduler::Call>> parsing =
+    process::async(parseSchedulerCall, callContentType, request.body);
+
+  // Surface each parse only after the previous call's parse has been
+  // surfaced, so that calls are processed on the master actor in
+  // arrival order even when their parses complete out of order.
+  Future<Try<scheduler::Call>> ordered = lastSchedulerCallParse
+    .then([parsing]() { return parsing; });
+
+  // NOTE: Callbacks on a future run in registration order: the
+  // processing continuation below is registered on 'ordered' before
+  // the completion of 'ordered' is chained to the next call, so the
+  // next call cannot be dispatched to the master actor ahead of this
+  // one.
+  Future<Response> response = ordered
+    .then(defer(master->self(),
+                [this, request](const Try<scheduler::Call>& call) {
+                  return _scheduler(request, call);
+                }));
+
+  lastSchedulerCallParse = ordered
+    .then([](const Try<scheduler::Call>&) { return Nothing(); });
+
+  return response;
+}
 
-  Option<Error> error = validation::scheduler::call::validate(call);
 
-  if (error.isSome()) {
-    return BadRequest("Failed to validate Scheduler::Call: " +
-                      error.get().message);
+Future<Response> Master::Http::_scheduler(
+    const Request& request,
+    const Try<scheduler::Call>& parsed) const
+{
+  // NOTE: The master may have lost its leadership while the call was
+  // being parsed, so the check in 'scheduler()' is repeated here.
+  if (!master->elected()) {
+    if (master->leader.isNone()) {
+      return ServiceUnavailable("No leader elected");
+    } else {
+      return redirect(request);
+    }
+  }
+
+  if (parsed.isError()) {
+    return BadRequest(parsed.error());
   }
 
+  const scheduler::Call& call = parsed.get();
+
   if (call.type() == scheduler::Call::SUBSCRIBE) {
     // We default to JSON since an empty 'Accept' header
     // results in all media types considered acceptable.
@@ -693,6 +800,71 @@ Future<Response> Master::Http::scheduler(const Request& request) const
 }
 
 
+string Master::Http::ALLOCATOR_HELP()
+{
+  return HELP(
+    TLDR(
+        "Information about the allocator's internal sorter state."),
+    DESCRIPTION(
+        "This endpoint exposes the state of the allocator's sorters as",
+        "a JSON object: for each sorter (e.g., \"roles\", or",
+        "\"frameworks/<role>\" for the per-role framework sorters) it",
+        "returns every client's weight, dominant share and aggregated",
+        "scalar allocations.",
+        "",
+        "The state is maintained incrementally by the allocator, so",
+        "querying this endpoint does not perturb the allocation cycle."));
+}
+
+
+Future<Response> Master::Http::allocator(const Request& request) const
+{
+  Option<string> jsonp = request.url.query.get("jsonp");
+
+  // NOTE: The continuation only renders the snapshot returned by the
+  // allocator and does not touch the master's state, so there is no
+  // need to defer it onto the master.
+  return master->allocator->getSorterState()
+    .then([jsonp](
+        const hashmap<string, vector<ClientState>>& state) -> Response {
+      JSON::Object object;
+
+      {
+        JSON::Object sorters;
+
+        foreachpair (
+            const string& name, const vector<ClientState>& clients, state) {
+          JSON::Array array;
+          array.values.reserve(clients.size());
+
+          foreach (const ClientState& client, clients) {
+            JSON::Object entry;
+            entry.values["name"] = client.name;
+            entry.values["weight"] = client.weight;
+            entry.values["share"] = client.share;
+            entry.values["active"] = client.active;
+
+            JSON::Object allocation;
+            foreachpair (
+                const string& resource, double value, client.allocation) {
+              allocation.values[resource] = value;
+            }
+            entry.values["allocation"] = std::move(allocation);
+
+            array.values.push_back(std::move(entry));
+          }
+
+          sorters.values[name] = std::move(array);
+        }
+
+        object.values["sorters"] = std::move(sorters);
+      }
+
+      return OK(object, jsonp);
+    });
+}
+
+
 string Master::Http::CREATE_VOLUMES_HELP()
 {
   return HELP(
@@ -1126,6 +1298,72 @@ Future<Response> Master::Http::redirect(const Request& request) const
 }
 
 
+Future<Response> Master::Http::standby(
+    const string& endpoint,
+    const Request& request) const
+{
+  CHECK(!master->elected());
+
+  if (master->leader.isNone()) {
+    return ServiceUnavailable("No leader elected");
+  }
+
+  // Cache per endpoint and query, so that, e.g., '/tasks?limit=10'
+  // and '/tasks?limit=100' are served separately.
+  const string key =
+    endpoint + "?" + process::http::query::encode(request.url.query);
+
+  if (standbyCache.contains(key)) {
+    const StandbyCacheEntry& entry = standbyCache[key];
+
+    Duration age = Clock::now() - entry.time;
+
+    if (age < master->flags.standby_state_cache_ttl) {
+      Response response = entry.response;
+      response.headers["X-Mesos-Staleness"] = stringify(age);
+      return response;
+    }
+  }
+
+  // Fetch a fresh copy from the leader. Requests arriving while a
+  // fetch for the same key is in flight join that fetch rather than
+  // each issuing their own request to the leader.
+  if (!standbyFetches.contains(key)) {
+    process::UPID leader(master->leader.get().pid());
+
+    standbyFetches[key] = process::http::get(
+        leader,
+        endpoint,
+        process::http::query::encode(request.url.query))
+      .onAny(defer(master->self(), [this, key](
+          const Future<Response>& response) {
+        if (response.isReady() && response.get().status == OK().status) {
+          standbyCache[key] = StandbyCacheEntry{Clock::now(), response.get()};
+        }
+        standbyFetches.erase(key);
+      }));
+  }
+
+  return standbyFetches[key]
+    .then([](const Response& response) -> Future<Response> {
+      if (response.status != OK().status) {
+        return ServiceUnavailable(
+            "Failed to fetch state from the leading master: " +
+            response.status);
+      }
+
+      Response result = response;
+      result.headers["X-Mesos-Staleness"] = stringify(Duration::zero());
+      return result;
+    })
+    .repair([](const Future<Response>& future) -> Future<Response> {
+      return ServiceUnavailable(
+          "Failed to fetch state from the leading master" +
+          (future.isFailed() ? ": " + future.failure() : ""));
+    });
+}
+
+
 string Master::Http::RESERVE_HELP()
 {
   return HELP(
@@ -1225,19 +1463,50 @@ string Master::Http::SLAVES_HELP()
         "Information about registered slaves."),
     DESCRIPTION(
         "This endpoint shows information about the slaves registered in",
-        "this master formatted as a JSON object."));
+        "this master formatted as a JSON object.",
+        "",
+        "Query parameters:",
+        "",
+        ">        attribute=name:value  Only return slaves that have the",
+        ">                              given attribute. The value must",
+        ">                              match the attribute's text form",
+        ">                              (e.g., 'rack:r1')."));
 }
 
 
 Future<Response> Master::Http::slaves(const Request& request) const
 {
+  // An optional 'attribute' query parameter restricts the response
+  // to the slaves with that attribute, resolved via the master's
+  // attribute index rather than a scan of the whole slave table.
+  Option<hashset<SlaveID>> filter = None();
+
+  Option<string> attribute = request.url.query.get("attribute");
+  if (attribute.isSome()) {
+    const vector<string> tokens = strings::split(attribute.get(), ":", 2);
+
+    if (tokens.size() != 2) {
+      return BadRequest(
+          "The 'attribute' query parameter must have the form 'name:value'");
+    }
+
+    filter = master->slaves.registered.get(tokens[0] + "=" + tokens[1]);
+  }
+
   JSON::Object object;
 
   {
     JSON::Array array;
-    array.values.reserve(master->slaves.registered.size()); // MESOS-2353.
+    array.values.reserve(
+        filter.isSome()
+          ? filter.get().size()
+          : master->slaves.registered.size()); // MESOS-2353.
 
     foreachvalue (const Slave* slave, master->slaves.registered) {
+      if (filter.isSome() && !filter.get().contains(slave->id)) {
+        continue;
+      }
+
       array.values.push_back(model(*slave));
     }
 
@@ -1298,7 +1567,108 @@ string Master::Http::STATE_HELP()
 
 Future<Response> Master::Http::state(const Request& request) const
 {
-  auto state = [this](JSON::ObjectWriter* writer) {
+  // A non-leading master optionally answers from a cached copy of
+  // the leader's response; see --standby_state_cache.
+  if (!master->elected() && master->flags.standby_state_cache) {
+    return standby("state", request);
+  }
+
+  // Queue the request for batched processing. All '/state' requests
+  // that arrive before the batch dispatch below reaches the front of
+  // the master's event queue are answered from a single rendering of
+  // the state, so a burst of polls costs one walk over the cluster
+  // instead of one per request.
+  batchedStateRequests.push_back(
+      BatchedStateRequest{
+          request.url.query.get("jsonp"),
+          Owned<Promise<Response>>(new Promise<Response>())});
+
+  Future<Response> response = batchedStateRequests.back().promise->future();
+
+  // Only the request that starts the batch dispatches the
+  // continuation; subsequent requests simply join the batch.
+  if (batchedStateRequests.size() == 1) {
+    dispatch(master->self(), &Master::processStateRequestsBatch);
+  }
+
+  return response;
+}
+
+
+// Minimum number of tasks that the cluster must contain before the
+// '/state' rendering shards the per-framework serialization across
+// worker threads; below this, rendering serially costs less than
+// spawning the threads.
+static const size_t MIN_TASKS_FOR_PARALLEL_STATE_RENDER = 10000;
+
+
+void Master::Http::processStateRequestsBatch() const
+{
+  CHECK(!batchedStateRequests.empty())
+    << "Bug in state request batching logic";
+
+  // Serialize each framework's portion of the response up front,
+  // sharded across worker threads for large clusters: the
+  // per-framework fragments include all of their tasks and dominate
+  // the rendering cost, and they are independent of one another. The
+  // worker threads only read the master's state, which is safe
+  // because the master actor is blocked here joining them and
+  // therefore cannot mutate it.
+  std::vector<const Framework*> frameworks;
+  frameworks.reserve(
+      master->frameworks.registered.size() +
+      master->frameworks.completed.size());
+
+  foreachvalue (Framework* framework, master->frameworks.registered) {
+    frameworks.push_back(framework);
+  }
+
+  const size_t registered = frameworks.size();
+
+  foreach (const std::shared_ptr<Framework>& framework,
+           master->frameworks.completed) {
+    frameworks.push_back(framework.get());
+  }
+
+  std::vector<string> fragments(frameworks.size());
+
+  if (stateCache.isNone() ||
+      stateCache.get().version != master->stateVersion) {
+    size_t tasks = 0;
+    foreach (const Framework* framework, frameworks) {
+      tasks += framework->tasks.size() + framework->completedTasks.size();
+    }
+
+    // Determine the number of shards: one per hardware thread, but
+    // never more than there are frameworks to render.
+    size_t shards = std::min<size_t>(
+        std::max<size_t>(std::thread::hardware_concurrency(), 1),
+        frameworks.size());
+
+    if (tasks < MIN_TASKS_FOR_PARALLEL_STATE_RENDER || shards <= 1) {
+      for (size_t i = 0; i < frameworks.size(); i++) {
+        fragments[i] = jsonify(Full<Framework>(*frameworks[i]));
+      }
+    } else {
+      std::vector<std::thread> workers;
+      workers.reserve(shards);
+
+      for (size_t shard = 0; shard < shards; shard++) {
+        workers.push_back(std::thread(
+            [shard, shards, &frameworks, &fragments]() {
+              for (size_t i = shard; i < frameworks.size(); i += shards) {
+                fragments[i] = jsonify(Full<Framework>(*frameworks[i]));
+              }
+            }));
+      }
+
+      foreach (std::thread& worker, workers) {
+        worker.join();
+      }
+    }
+  }
+
+  auto state = [&, this](JSON::ObjectWriter* writer) {
     writer->field("version", MESOS_VERSION);
 
     if (build::GIT_SHA.isSome()) {
@@ -1360,18 +1730,18 @@ Future<Response> Master::Http::state(const Request& request) const
       }
     });
 
-    // Model all of the frameworks.
-    writer->field("frameworks", [this](JSON::ArrayWriter* writer) {
-      foreachvalue (Framework* framework, master->frameworks.registered) {
-        writer->element(Full<Framework>(*framework));
+    // Model all of the frameworks, from the fragments rendered above.
+    writer->field("frameworks", [&](JSON::ArrayWriter* writer) {
+      for (size_t i = 0; i < registered; i++) {
+        writer->raw(fragments[i]);
       }
     });
 
-    // Model all of the completed frameworks.
-    writer->field("completed_frameworks", [this](JSON::ArrayWriter* writer) {
-      foreach (const std::shared_ptr<Framework>& framework,
-               master->frameworks.completed) {
-        writer->element(Full<Framework>(*framework));
+    // Model all of the completed frameworks, from the fragments
+    // rendered above.
+    writer->field("completed_frameworks", [&](JSON::ArrayWriter* writer) {
+      for (size_t i = registered; i < fragments.size(); i++) {
+        writer->raw(fragments[i]);
       }
     });
 
@@ -1406,156 +1776,156 @@ Future<Response> Master::Http::state(const Request& request) const
     });
   };
 
-  return OK(jsonify(state), request.url.query.get("jsonp"));
-}
+  // Re-render the response only if the master state changed since the
+  // last request. Monitoring stacks tend to poll this endpoint
+  // frequently and rendering it walks every framework, task and agent
+  // in the cluster, so repeated polls of an unchanged master are
+  // served straight from memory.
+  if (stateCache.isNone() ||
+      stateCache.get().version != master->stateVersion) {
+    std::ostringstream out;
+    out << jsonify(state);
 
+    stateCache = StateCache{master->stateVersion, out.str()};
+  }
 
-// This abstraction has no side-effects. It factors out computing the
-// mapping from 'slaves' to 'frameworks' to answer the questions 'what
-// frameworks are running on a given slave?' and 'what slaves are
-// running the given framework?'.
-class SlaveFrameworkMapping
-{
-public:
-  SlaveFrameworkMapping(const hashmap<FrameworkID, Framework*>& frameworks)
-  {
-    foreachpair (const FrameworkID& frameworkId,
-                 const Framework* framework,
-                 frameworks) {
-      foreachvalue (const TaskInfo& taskInfo, framework->pendingTasks) {
-        frameworksToSlaves[frameworkId].insert(taskInfo.slave_id());
-        slavesToFrameworks[taskInfo.slave_id()].insert(frameworkId);
-      }
+  const string& body = stateCache.get().body;
 
-      foreachvalue (const Task* task, framework->tasks) {
-        frameworksToSlaves[frameworkId].insert(task->slave_id());
-        slavesToFrameworks[task->slave_id()].insert(frameworkId);
-      }
+  // Answer every batched request from the same rendering, applying
+  // any jsonp wrapping per request.
+  foreach (const BatchedStateRequest& request, batchedStateRequests) {
+    OK response;
+    response.type = Response::BODY;
 
-      foreach (const std::shared_ptr<Task>& task, framework->completedTasks) {
-        frameworksToSlaves[frameworkId].insert(task->slave_id());
-        slavesToFrameworks[task->slave_id()].insert(frameworkId);
-      }
+    if (request.jsonp.isSome()) {
+      response.body = request.jsonp.get() + "(" + body + ");";
+      response.headers["Content-Type"] = "text/javascript";
+    } else {
+      response.body = body;
+      response.headers["Content-Type"] = "application/json";
     }
-  }
 
-  const hashset<FrameworkID>& frameworks(const SlaveID& slaveId) const
-  {
-    const auto iterator = slavesToFrameworks.find(slaveId);
-    return iterator != slavesToFrameworks.end() ?
-      iterator->second : hashset<FrameworkID>::EMPTY;
-  }
+    response.headers["Content-Length"] = stringify(response.body.size());
 
-  const hashset<SlaveID>& slaves(const FrameworkID& frameworkId) const
-  {
-    const auto iterator = frameworksToSlaves.find(frameworkId);
-    return iterator != frameworksToSlaves.end() ?
-      iterator->second : hashset<SlaveID>::EMPTY;
+    request.promise->set(response);
   }
 
-private:
-  hashmap<SlaveID, hashset<FrameworkID>> slavesToFrameworks;
-  hashmap<FrameworkID, hashset<SlaveID>> frameworksToSlaves;
-};
+  batchedStateRequests.clear();
+}
 
 
-// This abstraction has no side-effects. It factors out the accounting
-// for a 'TaskState' summary. We use this to summarize 'TaskState's
-// for both frameworks as well as slaves.
-struct TaskStateSummary
+string Master::Http::STATE_RECORDIO_HELP()
 {
-  // TODO(jmlvanre): Possibly clean this up as per MESOS-2694.
-  const static TaskStateSummary EMPTY;
+  return HELP(
+    TLDR(
+        "Binary snapshot of the cluster state."),
+    DESCRIPTION(
+        "Returns the master's state as a RecordIO framed stream of",
+        "'StateSnapshotRecord' protobuf messages (see",
+        "messages/messages.proto): one record for the master itself,",
+        "followed by one per agent, framework, task and outstanding",
+        "offer. Parsing this is considerably cheaper for tooling",
+        "than the JSON '/state' endpoint."));
+}
 
-  TaskStateSummary()
-    : staging(0),
-      starting(0),
-      running(0),
-      finished(0),
-      killed(0),
-      failed(0),
-      lost(0),
-      error(0) {}
 
-  // Account for the state of the given task.
-  void count(const Task& task)
-  {
-    switch (task.state()) {
-      case TASK_STAGING: { ++staging; break; }
-      case TASK_STARTING: { ++starting; break; }
-      case TASK_RUNNING: { ++running; break; }
-      case TASK_FINISHED: { ++finished; break; }
-      case TASK_KILLED: { ++killed; break; }
-      case TASK_FAILED: { ++failed; break; }
-      case TASK_LOST: { ++lost; break; }
-      case TASK_ERROR: { ++error; break; }
-      // No default case allows for a helpful compiler error if we
-      // introduce a new state.
-    }
-  }
-
-  size_t staging;
-  size_t starting;
-  size_t running;
-  size_t finished;
-  size_t killed;
-  size_t failed;
-  size_t lost;
-  size_t error;
-};
+Future<Response> Master::Http::stateRecordio(const Request& request) const
+{
+  // Re-render the snapshot only if the master state changed since
+  // the last request, as for '/state'.
+  if (stateRecordioCache.isNone() ||
+      stateRecordioCache.get().version != master->stateVersion) {
+    ::recordio::Encoder<StateSnapshotRecord> encoder(
+        lambda::bind(serialize, ContentType::PROTOBUF, lambda::_1));
 
+    std::ostringstream out;
 
-const TaskStateSummary TaskStateSummary::EMPTY;
+    {
+      StateSnapshotRecord record;
+      record.mutable_master()->CopyFrom(master->info());
+      out << encoder.encode(record);
+    }
 
+    foreachvalue (Slave* slave, master->slaves.registered) {
+      StateSnapshotRecord record;
+      record.mutable_slave()->CopyFrom(slave->info);
+      out << encoder.encode(record);
+    }
 
-// This abstraction has no side-effects. It factors out computing the
-// 'TaskState' summaries for frameworks and slaves. This answers the
-// questions 'How many tasks are in each state for a given framework?'
-// and 'How many tasks are in each state for a given slave?'.
-class TaskStateSummaries
-{
-public:
-  TaskStateSummaries(const hashmap<FrameworkID, Framework*>& frameworks)
-  {
-    foreachpair (const FrameworkID& frameworkId,
-                 const Framework* framework,
-                 frameworks) {
-      foreachvalue (const TaskInfo& taskInfo, framework->pendingTasks) {
-        frameworkTaskSummaries[frameworkId].staging++;
-        slaveTaskSummaries[taskInfo.slave_id()].staging++;
+    foreachvalue (Framework* framework, master->frameworks.registered) {
+      {
+        StateSnapshotRecord record;
+        record.mutable_framework()->CopyFrom(framework->info);
+        out << encoder.encode(record);
       }
 
-      foreachvalue (const Task* task, framework->tasks) {
-        frameworkTaskSummaries[frameworkId].count(*task);
-        slaveTaskSummaries[task->slave_id()].count(*task);
+      foreachvalue (Task* task, framework->tasks) {
+        StateSnapshotRecord record;
+        record.mutable_task()->CopyFrom(*task);
+        out << encoder.encode(record);
       }
 
       foreach (const std::shared_ptr<Task>& task, framework->completedTasks) {
-        frameworkTaskSummaries[frameworkId].count(*task);
-        slaveTaskSummaries[task->slave_id()].count(*task);
+        StateSnapshotRecord record;
+        record.mutable_task()->CopyFrom(*task);
+        out << encoder.encode(record);
+      }
+
+      foreach (Offer* offer, framework->offers) {
+        StateSnapshotRecord record;
+        record.mutable_offer()->CopyFrom(*offer);
+        out << encoder.encode(record);
       }
     }
-  }
 
-  const TaskStateSummary& framework(const FrameworkID& frameworkId) const
-  {
-    const auto iterator = frameworkTaskSummaries.find(frameworkId);
-    return iterator != frameworkTaskSummaries.end() ?
-      iterator->second : TaskStateSummary::EMPTY;
-  }
+    foreach (const std::shared_ptr<Framework>& framework,
+             master->frameworks.completed) {
+      {
+        StateSnapshotRecord record;
+        record.mutable_completed_framework()->CopyFrom(framework->info);
+        out << encoder.encode(record);
+      }
 
-  const TaskStateSummary& slave(const SlaveID& slaveId) const
-  {
-    const auto iterator = slaveTaskSummaries.find(slaveId);
-    return iterator != slaveTaskSummaries.end() ?
-      iterator->second : TaskStateSummary::EMPTY;
+      foreach (const std::shared_ptr<Task>& task, framework->completedTasks) {
+        StateSnapshotRecord record;
+        record.mutable_task()->CopyFrom(*task);
+        out << encoder.encode(record);
+      }
+    }
+
+    // Orphan tasks, i.e., tasks of frameworks that have not
+    // re-registered after a master failover.
+    foreachvalue (const Slave* slave, master->slaves.registered) {
+      typedef hashmap<TaskID, Task*> TaskMap;
+      foreachvalue (const TaskMap& tasks, slave->tasks) {
+        foreachvalue (const Task* task, tasks) {
+          CHECK_NOTNULL(task);
+          if (!master->frameworks.registered.contains(task->framework_id())) {
+            StateSnapshotRecord record;
+            record.mutable_task()->CopyFrom(*task);
+            out << encoder.encode(record);
+          }
+        }
+      }
+    }
+
+    stateRecordioCache = StateCache{master->stateVersion, out.str()};
   }
-private:
-  hashmap<FrameworkID, TaskStateSummary> frameworkTaskSummaries;
-  hashmap<SlaveID, TaskStateSummary> slaveTaskSummaries;
-};
 
+  OK response;
+  response.type = Response::BODY;
+  response.body = stateRecordioCache.get().body;
+  response.headers["Content-Type"] = stringify(ContentType::PROTOBUF);
+  response.headers["Content-Length"] = stringify(response.body.size());
 
+  return response;
+}
+
+
+// This abstraction has no side-effects. It factors out computing the
+// mapping from 'slaves' to 'frameworks' to answer the questions 'what
+// frameworks are running on a given slave?' and 'what slaves are
+// running the given framework?'.
 string Master::Http::STATESUMMARY_HELP()
 {
   return HELP(
@@ -1569,6 +1939,12 @@ string Master::Http::STATESUMMARY_HELP()
 
 Future<Response> Master::Http::stateSummary(const Request& request) const
 {
+  // A non-leading master optionally answers from a cached copy of
+  // the leader's response; see --standby_state_cache.
+  if (!master->elected() && master->flags.standby_state_cache) {
+    return standby("state-summary", request);
+  }
+
   JSON::Object object;
 
   object.values["hostname"] = master->info().hostname();
@@ -1584,12 +1960,26 @@ Future<Response> Master::Http::stateSummary(const Request& request) const
   // registered 3) the frameworks keep a circular buffer of completed
   // tasks that we can use to keep a limited view on the history of
   // recent completed / failed tasks.
-
-  // Generate mappings from 'slave' to 'framework' and reverse.
-  SlaveFrameworkMapping slaveFrameworkMapping(master->frameworks.registered);
-
-  // Generate 'TaskState' summaries for all framework and slave ids.
-  TaskStateSummaries taskStateSummaries(master->frameworks.registered);
+  //
+  // The active and completed task contributions to the summaries and
+  // to the slave <-> framework mappings are maintained incrementally
+  // in the 'Slave' and 'Framework' structs as tasks transition, so
+  // this request is O(frameworks + slaves) rather than O(tasks).
+  // Pending tasks are overlaid per request: there are typically few
+  // of them (they only exist while a launch is being authorized), and
+  // they are manipulated from several places which makes incremental
+  // accounting for them error prone.
+  hashmap<SlaveID, size_t> pendingStaging;
+  hashmap<SlaveID, hashset<FrameworkID>> pendingFrameworks;
+
+  foreachpair (const FrameworkID& frameworkId,
+               const Framework* framework,
+               master->frameworks.registered) {
+    foreachvalue (const TaskInfo& taskInfo, framework->pendingTasks) {
+      ++pendingStaging[taskInfo.slave_id()];
+      pendingFrameworks[taskInfo.slave_id()].insert(frameworkId);
+    }
+  }
 
   // Model all of the slaves.
   {
@@ -1600,7 +1990,8 @@ Future<Response> Master::Http::stateSummary(const Request& request) const
       JSON::Object json = summarize(*slave);
 
       // Add the 'TaskState' summary for this slave.
-      const TaskStateSummary& summary = taskStateSummaries.slave(slave->id);
+      TaskStateSummary summary = slave->taskSummary;
+      summary.staging += pendingStaging.get(slave->id).getOrElse(0);
 
       json.values["TASK_STAGING"] = summary.staging;
       json.values["TASK_STARTING"] = summary.starting;
@@ -1612,8 +2003,14 @@ Future<Response> Master::Http::stateSummary(const Request& request) const
       json.values["TASK_ERROR"] = summary.error;
 
       // Add the ids of all the frameworks running on this slave.
-      const hashset<FrameworkID>& frameworks =
-        slaveFrameworkMapping.frameworks(slave->id);
+      hashset<FrameworkID> frameworks = slave->frameworkTaskCounts.keys();
+
+      if (pendingFrameworks.contains(slave->id)) {
+        foreach (const FrameworkID& frameworkId,
+                 pendingFrameworks[slave->id]) {
+          frameworks.insert(frameworkId);
+        }
+      }
 
       JSON::Array frameworkIdArray;
       frameworkIdArray.values.reserve(frameworks.size()); // MESOS-2353.
@@ -1635,14 +2032,13 @@ Future<Response> Master::Http::stateSummary(const Request& request) const
     JSON::Array array;
     array.values.reserve(master->frameworks.registered.size()); // MESOS-2353.
 
-    foreachpair (const FrameworkID& frameworkId,
-                 Framework* framework,
-                 master->frameworks.registered) {
+    foreachvalue (Framework* framework, master->frameworks.registered) {
       JSON::Object json = summarize(*framework);
 
       // Add the 'TaskState' summary for this framework.
-      const TaskStateSummary& summary =
-        taskStateSummaries.framework(frameworkId);
+      TaskStateSummary summary = framework->taskSummary;
+      summary.staging += framework->pendingTasks.size();
+
       json.values["TASK_STAGING"] = summary.staging;
       json.values["TASK_STARTING"] = summary.starting;
       json.values["TASK_RUNNING"] = summary.running;
@@ -1653,8 +2049,11 @@ Future<Response> Master::Http::stateSummary(const Request& request) const
       json.values["TASK_ERROR"] = summary.error;
 
       // Add the ids of all the slaves running this framework.
-      const hashset<SlaveID>& slaves =
-        slaveFrameworkMapping.slaves(frameworkId);
+      hashset<SlaveID> slaves = framework->slaveTaskCounts.keys();
+
+      foreachvalue (const TaskInfo& taskInfo, framework->pendingTasks) {
+        slaves.insert(taskInfo.slave_id());
+      }
 
       JSON::Array slaveIdArray;
       slaveIdArray.values.reserve(slaves.size()); // MESOS-2353.
@@ -1685,7 +2084,11 @@ string Master::Http::ROLES_HELP()
         "It returns information about every role that is on the role"
         "whitelist (if enabled), has one or more registered frameworks,"
         "or has a non-default weight or quota. For each role, it returns"
-        "the weight, total allocated resources, and registered frameworks."));
+        "the weight, total allocated resources, and registered frameworks."
+        "Role names encode a hierarchy using '/' (e.g. 'eng/data'); the"
+        "response includes the ancestors of every such role, and each"
+        "role additionally reports 'subtree_resources': the resources"
+        "allocated to the role and all of its descendants."));
 }
 
 
@@ -1693,7 +2096,8 @@ string Master::Http::ROLES_HELP()
 JSON::Object model(
     const string& name,
     Option<double> weight,
-    Option<Role*> _role)
+    Option<Role*> _role,
+    const Resources& subtree)
 {
   JSON::Object object;
   object.values["name"] = name;
@@ -1723,62 +2127,125 @@ JSON::Object model(
     }
   }
 
+  // The resources allocated to this role and all of its descendants
+  // in the role hierarchy (role names encode the hierarchy with '/').
+  object.values["subtree_resources"] = model(subtree);
+
   return object;
 }
 
 
 Future<Response> Master::Http::roles(const Request& request) const
 {
-  JSON::Object object;
-
-  // Compute the role names to return results for. When an explicit
-  // role whitelist has been configured, we use that list of names.
-  // When using implicit roles, the right behavior is a bit more
-  // subtle. There are no constraints on possible role names, so we
-  // instead list all the "interesting" roles: the default role ("*"),
-  // all roles with one or more registered frameworks, and all roles
-  // with a non-default weight or quota.
-  //
-  // NOTE: we use a `std::set` to store the role names to ensure a
-  // deterministic output order.
-  set<string> roleList;
-  if (master->roleWhitelist.isSome()) {
-    const hashset<string>& whitelist = master->roleWhitelist.get();
-    roleList.insert(whitelist.begin(), whitelist.end());
-  } else {
-    roleList.insert("*"); // Default role.
-    roleList.insert(
-        master->activeRoles.keys().begin(),
-        master->activeRoles.keys().end());
-    roleList.insert(
-        master->weights.keys().begin(),
-        master->weights.keys().end());
-    roleList.insert(
-        master->quotas.keys().begin(),
-        master->quotas.keys().end());
-  }
+  // Re-render the response only if the master state changed since the
+  // last request. The subtree rollups below walk every role and every
+  // framework, so the rendering is memoized in the same way as
+  // '/state' and only recomputed when an allocation event (or any
+  // other state change) has bumped the version.
+  if (rolesCache.isNone() ||
+      rolesCache.get().version != master->stateVersion) {
+    // Compute the role names to return results for. When an explicit
+    // role whitelist has been configured, we use that list of names.
+    // When using implicit roles, the right behavior is a bit more
+    // subtle. There are no constraints on possible role names, so we
+    // instead list all the "interesting" roles: the default role ("*"),
+    // all roles with one or more registered frameworks, and all roles
+    // with a non-default weight or quota.
+    //
+    // NOTE: we use a `std::set` to store the role names to ensure a
+    // deterministic output order.
+    set<string> roleList;
+    if (master->roleWhitelist.isSome()) {
+      const hashset<string>& whitelist = master->roleWhitelist.get();
+      roleList.insert(whitelist.begin(), whitelist.end());
+    } else {
+      roleList.insert("*"); // Default role.
+      roleList.insert(
+          master->activeRoles.keys().begin(),
+          master->activeRoles.keys().end());
+      roleList.insert(
+          master->weights.keys().begin(),
+          master->weights.keys().end());
+      roleList.insert(
+          master->quotas.keys().begin(),
+          master->quotas.keys().end());
+    }
 
-  {
-    JSON::Array array;
+    // Role names encode a hierarchy using '/' (e.g. "eng/data/batch").
+    // Aggregate each role's resources into all of its ancestors, and
+    // include the ancestors in the response so that rollups for
+    // intermediate roles (e.g. "eng") are available even when no
+    // framework is registered under that exact name.
+    set<string> names = roleList;
+    hashmap<string, Resources> subtrees;
 
     foreach (const string& name, roleList) {
-      Option<double> weight = None();
-      if (master->weights.contains(name)) {
-        weight = master->weights[name];
+      Resources resources;
+      if (master->activeRoles.contains(name)) {
+        resources = master->activeRoles[name]->resources();
       }
 
-      Option<Role*> role = None();
-      if (master->activeRoles.contains(name)) {
-        role = master->activeRoles[name];
+      string path = name;
+      while (true) {
+        subtrees[path] += resources;
+
+        size_t index = path.rfind('/');
+        if (index == string::npos) {
+          break;
+        }
+
+        path = path.substr(0, index);
+        names.insert(path);
       }
+    }
+
+    JSON::Object object;
+
+    {
+      JSON::Array array;
+
+      foreach (const string& name, names) {
+        Option<double> weight = None();
+        if (master->weights.contains(name)) {
+          weight = master->weights[name];
+        }
+
+        Option<Role*> role = None();
+        if (master->activeRoles.contains(name)) {
+          role = master->activeRoles[name];
+        }
 
-      array.values.push_back(model(name, weight, role));
+        array.values.push_back(model(
+            name,
+            weight,
+            role,
+            subtrees.get(name).getOrElse(Resources())));
+      }
+
+      object.values["roles"] = std::move(array);
     }
 
-    object.values["roles"] = std::move(array);
+    std::ostringstream out;
+    out << object;
+
+    rolesCache = StateCache{master->stateVersion, out.str()};
   }
 
-  return OK(object, request.url.query.get("jsonp"));
+  const string& body = rolesCache.get().body;
+
+  OK response;
+  response.type = Response::BODY;
+
+  Option<string> jsonp = request.url.query.get("jsonp");
+  if (jsonp.isSome()) {
+    response.body = jsonp.get() + "(" + body + ");";
+    response.headers["Content-Type"] = "text/javascript";
+  } else {
+    response.body = body;
+    response.headers["Content-Type"] = "application/json";
+  }
+
+  return response;
 }
 
 
@@ -1887,7 +2354,15 @@ string Master::Http::TASKS_HELP()
       "(default is " + stringify(TASK_LIMIT) + ").",
       ">        offset=VALUE         Starts task list at offset.",
       ">        order=(asc|desc)     Ascending or descending sort order "
-      "(default is descending)."
+      "(default is descending).",
+      ">        framework_id=VALUE   Only tasks of the framework with "
+      "this ID.",
+      ">        slave_id=VALUE       Only tasks running on the slave with "
+      "this ID.",
+      ">        state=VALUE          Only tasks in this state (e.g., "
+      "TASK_RUNNING).",
+      ">        name_prefix=VALUE    Only tasks whose name starts with "
+      "this prefix."
       ""));
 }
 
@@ -1938,6 +2413,12 @@ struct TaskComparator
 
 Future<Response> Master::Http::tasks(const Request& request) const
 {
+  // A non-leading master optionally answers from a cached copy of
+  // the leader's response; see --standby_state_cache.
+  if (!master->elected() && master->flags.standby_state_cache) {
+    return standby("tasks", request);
+  }
+
   // Get list options (limit and offset).
   Result<int> result = numify<int>(request.url.query.get("limit"));
   size_t limit = result.isSome() ? result.get() : TASK_LIMIT;
@@ -1948,14 +2429,61 @@ Future<Response> Master::Http::tasks(const Request& request) const
   // TODO(nnielsen): Currently, formatting errors in offset and/or limit
   // will silently be ignored. This could be reported to the user instead.
 
-  // Construct framework list with both active and completed frameworks.
+  // Optional filters. These are evaluated against the master's
+  // in-memory state before any task is materialized into JSON, so
+  // that narrow queries (e.g., the tasks of one framework in one
+  // state) do not pay for serializing the entire task list.
+  const Option<string> slaveId = request.url.query.get("slave_id");
+  const Option<string> state = request.url.query.get("state");
+  const Option<string> namePrefix = request.url.query.get("name_prefix");
+
+  // Returns true if the task passes all the query filters.
+  auto selected = [&](const Task& task) {
+    if (slaveId.isSome() && task.slave_id().value() != slaveId.get()) {
+      return false;
+    }
+
+    if (state.isSome() && TaskState_Name(task.state()) != state.get()) {
+      return false;
+    }
+
+    if (namePrefix.isSome() &&
+        !strings::startsWith(task.name(), namePrefix.get())) {
+      return false;
+    }
+
+    return true;
+  };
+
+  // Construct framework list with both active and completed
+  // frameworks. If a framework id filter is present we look up the
+  // active framework in the master's index instead of scanning.
   vector<const Framework*> frameworks;
-  foreachvalue (Framework* framework, master->frameworks.registered) {
-    frameworks.push_back(framework);
-  }
-  foreach (const std::shared_ptr<Framework>& framework,
-           master->frameworks.completed) {
-    frameworks.push_back(framework.get());
+
+  const Option<string> frameworkId = request.url.query.get("framework_id");
+  if (frameworkId.isSome()) {
+    FrameworkID id;
+    id.set_value(frameworkId.get());
+
+    Framework* framework = master->getFramework(id);
+    if (framework != NULL) {
+      frameworks.push_back(framework);
+    }
+
+    foreach (const std::shared_ptr<Framework>& framework,
+             master->frameworks.completed) {
+      if (framework->id().value() == frameworkId.get()) {
+        frameworks.push_back(framework.get());
+      }
+    }
+  } else {
+    foreachvalue (Framework* framework, master->frameworks.registered) {
+      frameworks.push_back(framework);
+    }
+    foreach (const std::shared_ptr<Framework>& framework,
+             master->frameworks.completed) {
+      frameworks.push_back(framework.get());
+    }
   }
 
   // Construct task list with both running and finished tasks.
@@ -1963,10 +2491,14 @@ Future<Response> Master::Http::tasks(const Request& request) const
   foreach (const Framework* framework, frameworks) {
     foreachvalue (Task* task, framework->tasks) {
       CHECK_NOTNULL(task);
-      tasks.push_back(task);
+      if (selected(*task)) {
+        tasks.push_back(task);
+      }
     }
     foreach (const std::shared_ptr<Task>& task, framework->completedTasks) {
-      tasks.push_back(task.get());
+      if (selected(*task)) {
+        tasks.push_back(task.get());
+      }
     }
   }
 
@@ -2078,19 +2610,24 @@ Future<Response> Master::Http::maintenanceSchedule(const Request& request) const
         }
       }
 
-      // NOTE: Copies are needed because `updateUnavailability()` in this loop
-      // modifies the container.
-      foreachkey (const MachineID& id, utils::copy(master->machines)) {
+      // Accumulate the unavailability changes and apply them in bulk
+      // below: this informs the allocator once for all affected
+      // machines (triggering a single allocation pass) rather than
+      // once per machine, which matters when a schedule transitions
+      // thousands of machines at a time.
+      hashmap<MachineID, Option<Unavailability>> unavailabilities;
+
+      foreachkey (const MachineID& id, master->machines) {
         // Update the entry for each updated machine.
         if (updated.contains(id)) {
-          master->updateUnavailability(id, updated[id]);
+          unavailabilities[id] = updated[id];
           continue;
         }
 
         // Transition each removed machine back to the `UP` mode and remove the
         // unavailability.
         master->machines[id].info.set_mode(MachineInfo::UP);
-        master->updateUnavailability(id, None());
+        unavailabilities[id] = None();
       }
 
       // Save each new machine, with the unavailability
@@ -2103,10 +2640,12 @@ Future<Response> Master::Http::maintenanceSchedule(const Request& request) const
 
           master->machines[id].info.CopyFrom(info);
 
-          master->updateUnavailability(id, window.unavailability());
+          unavailabilities[id] = window.unavailability();
         }
       }
 
+      master->updateUnavailability(unavailabilities);
+
       // Replace the old schedule(s) with the new schedule.
       master->maintenance.schedules.clear();
       master->maintenance.schedules.push_back(schedule);
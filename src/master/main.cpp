@@ -316,7 +316,10 @@ int main(int argc, char** argv)
 
   CHECK_NOTNULL(storage);
 
-  state::protobuf::State* state = new state::protobuf::State(storage);
+  // Enable caching: the registrar is the only writer of the registry
+  // while this master is elected, so serving its fetch-mutate-store
+  // loop from the cache skips a full registry read per operation.
+  state::protobuf::State* state = new state::protobuf::State(storage, true);
   Registrar* registrar = new Registrar(flags, state);
   Repairer* repairer = new Repairer();
 
@@ -17,6 +17,7 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <fstream>
 #include <iomanip>
@@ -42,6 +43,7 @@
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/delay.hpp>
+#include <process/help.hpp>
 #include <process/http.hpp>
 #include <process/id.hpp>
 #include <process/limiter.hpp>
@@ -70,6 +72,7 @@
 
 #include "common/build.hpp"
 #include "common/date_utils.hpp"
+#include "common/interner.hpp"
 #include "common/protobuf_utils.hpp"
 #include "common/status_utils.hpp"
 
@@ -95,6 +98,9 @@ using std::vector;
 using process::await;
 using process::wait; // Necessary on some OS's to disambiguate.
 using process::Clock;
+using process::DESCRIPTION;
+using process::HELP;
+using process::TLDR;
 using process::ExitedEvent;
 using process::Failure;
 using process::Future;
@@ -124,6 +130,19 @@ using mesos::master::allocator::Allocator;
 using mesos::http::authentication::BasicAuthenticatorFactory;
 
 
+std::shared_ptr<const ExecutorInfo> internExecutorInfo(
+    const ExecutorInfo& executorInfo)
+{
+  // NOTE: A single interner is shared by all masters in this process
+  // (only tests run more than one); the interner is internally
+  // synchronized and sharing infos across masters is harmless since
+  // they are immutable.
+  static Interner<ExecutorInfo>* interner = new Interner<ExecutorInfo>();
+
+  return interner->intern(executorInfo);
+}
+
+
 class SlaveObserver : public ProtobufProcess<SlaveObserver>
 {
 public:
@@ -273,6 +292,73 @@ private:
 };
 
 
+// Serves the '/ready' readiness endpoint from a dedicated process so
+// that load balancers probing at high frequency are answered at
+// constant cost and never queue behind the master actor (unlike
+// '/master/health' and '/master/state'). The master publishes its
+// election and registry recovery state by writing the atomic flags
+// directly, without dispatching, and the handler only reads them.
+class ReadinessProcess : public Process<ReadinessProcess>
+{
+public:
+  ReadinessProcess()
+    : ProcessBase("ready"),
+      elected(false),
+      recovered(false) {}
+
+  // The markers below are called by the master from its own context;
+  // they are thread-safe since they only write the atomic flags.
+
+  // Marks the master as elected as the leading master.
+  void markElected()
+  {
+    elected.store(true);
+  }
+
+  // Marks the registry as recovered.
+  void markRecovered()
+  {
+    recovered.store(true);
+  }
+
+protected:
+  virtual void initialize()
+  {
+    route("/", READY_HELP(), &ReadinessProcess::ready);
+  }
+
+private:
+  static string READY_HELP()
+  {
+    return HELP(
+      TLDR(
+          "Readiness check of the Master."),
+      DESCRIPTION(
+          "Returns 200 OK iff the master is elected as the leading",
+          "master and has recovered the registry from the registrar,",
+          "and 503 Service Unavailable otherwise. Served outside of",
+          "the master actor, so probing at high frequency does not",
+          "add load to the master."));
+  }
+
+  Future<process::http::Response> ready(const process::http::Request& request)
+  {
+    if (!elected.load()) {
+      return process::http::ServiceUnavailable("Not elected");
+    }
+
+    if (!recovered.load()) {
+      return process::http::ServiceUnavailable("Registry not recovered");
+    }
+
+    return process::http::OK();
+  }
+
+  std::atomic<bool> elected;
+  std::atomic<bool> recovered;
+};
+
+
 Master::Master(
     Allocator* _allocator,
     Registrar* _registrar,
@@ -295,8 +381,11 @@ Master::Master(
     authorizer(_authorizer),
     frameworks(flags),
     authenticator(None()),
+    rescindedOffers(MAX_RESCINDED_OFFERS),
+    offerEpoch(0),
     metrics(new Metrics(*this)),
-    electedTime(None())
+    electedTime(None()),
+    stateVersion(0)
 {
   slaves.limiter = _slaveRemovalLimiter;
 
@@ -354,12 +443,19 @@ Master::~Master() {}
 // capacity is reached.
 struct BoundedRateLimiter
 {
-  BoundedRateLimiter(double qps, Option<uint64_t> _capacity)
-    : limiter(new process::RateLimiter(qps)),
+  BoundedRateLimiter(double _qps, Option<uint64_t> _capacity)
+    : limiter(new process::RateLimiter(_qps)),
+      qps(_qps),
       capacity(_capacity),
       messages(0) {}
 
   process::Owned<process::RateLimiter> limiter;
+
+  // The configured rate limit. The effective rate of 'limiter' may
+  // be boosted above this when the master has headroom, see
+  // 'Master::adaptRateLimits'.
+  const double qps;
+
   const Option<uint64_t> capacity;
 
   // Number of outstanding messages for this RateLimiter.
@@ -614,6 +710,10 @@ void Master::initialize()
     }
 
     LOG(INFO) << "Framework rate limiting enabled";
+
+    // Periodically adapt the effective rate limits to the master's
+    // load, see 'adaptRateLimits'.
+    delay(RATE_LIMIT_ADAPTATION_INTERVAL, self(), &Master::adaptRateLimits);
   }
 
   // If the rate limiter is injected for testing,
@@ -623,6 +723,42 @@ void Master::initialize()
               << flags.slave_removal_rate_limit.get();
   }
 
+  if (flags.slave_reregistration_rate_limit.isSome()) {
+    // Parse the flag value.
+    // TODO(vinod): Move this parsing logic to flags once we have a
+    // 'Rate' abstraction in stout.
+    vector<string> tokens =
+      strings::tokenize(flags.slave_reregistration_rate_limit.get(), "/");
+
+    if (tokens.size() != 2) {
+      EXIT(1) << "Invalid slave_reregistration_rate_limit: "
+              << flags.slave_reregistration_rate_limit.get()
+              << ". Format is <Number of slaves>/<Duration>";
+    }
+
+    Try<int> permits = numify<int>(tokens[0]);
+    if (permits.isError()) {
+      EXIT(1) << "Invalid slave_reregistration_rate_limit: "
+              << flags.slave_reregistration_rate_limit.get()
+              << ". Format is <Number of slaves>/<Duration>"
+              << ": " << permits.error();
+    }
+
+    Try<Duration> duration = Duration::parse(tokens[1]);
+    if (duration.isError()) {
+      EXIT(1) << "Invalid slave_reregistration_rate_limit: "
+              << flags.slave_reregistration_rate_limit.get()
+              << ". Format is <Number of slaves>/<Duration>"
+              << ": " << duration.error();
+    }
+
+    slaves.reregistrationLimiter = shared_ptr<RateLimiter>(
+        new RateLimiter(permits.get(), duration.get()));
+
+    LOG(INFO) << "Slave re-registration is rate limited to "
+              << flags.slave_reregistration_rate_limit.get();
+  }
+
   // If "--roles" is set, configure the role whitelist.
   // TODO(neilc): Remove support for explicit roles in ~Mesos 0.32.
   if (flags.roles.isSome()) {
@@ -679,6 +815,12 @@ void Master::initialize()
             << "for --offer_timeout: Must be greater than zero.";
   }
 
+  if (flags.offer_hoarding_threshold.isSome() &&
+      flags.offer_hoarding_threshold.get() <= Duration::zero()) {
+    EXIT(1) << "Invalid value '" << flags.offer_hoarding_threshold.get()
+            << "' for --offer_hoarding_threshold: Must be greater than zero.";
+  }
+
   // Initialize the allocator.
   allocator->initialize(
       flags.allocation_interval,
@@ -699,6 +841,9 @@ void Master::initialize()
       });
   spawn(whitelistWatcher);
 
+  readiness = new ReadinessProcess();
+  spawn(readiness);
+
   nextFrameworkId = 0;
   nextSlaveId = 0;
   nextOfferId = 0;
@@ -750,6 +895,11 @@ void Master::initialize()
       &KillTaskMessage::framework_id,
       &KillTaskMessage::task_id);
 
+  install<KillTasksMessage>(
+      &Master::killTasks,
+      &KillTasksMessage::framework_id,
+      &KillTasksMessage::task_ids);
+
   install<StatusUpdateAcknowledgementMessage>(
       &Master::statusUpdateAcknowledgement,
       &StatusUpdateAcknowledgementMessage::slave_id,
@@ -757,6 +907,11 @@ void Master::initialize()
       &StatusUpdateAcknowledgementMessage::task_id,
       &StatusUpdateAcknowledgementMessage::uuid);
 
+  install<StatusUpdateAcknowledgementsMessage>(
+      &Master::statusUpdateAcknowledgements,
+      &StatusUpdateAcknowledgementsMessage::framework_id,
+      &StatusUpdateAcknowledgementsMessage::acknowledgements);
+
   install<FrameworkToExecutorMessage>(
       &Master::schedulerMessage,
       &FrameworkToExecutorMessage::slave_id,
@@ -770,14 +925,10 @@ void Master::initialize()
       &RegisterSlaveMessage::checkpointed_resources,
       &RegisterSlaveMessage::version);
 
-  install<ReregisterSlaveMessage>(
-      &Master::reregisterSlave,
-      &ReregisterSlaveMessage::slave,
-      &ReregisterSlaveMessage::checkpointed_resources,
-      &ReregisterSlaveMessage::executor_infos,
-      &ReregisterSlaveMessage::tasks,
-      &ReregisterSlaveMessage::completed_frameworks,
-      &ReregisterSlaveMessage::version);
+  // NOTE: We install the whole message handler here so that the
+  // heavy repeated fields are not copied into vectors before the
+  // dedup checks in 'reregisterSlave' have run.
+  install<ReregisterSlaveMessage>(&Master::reregisterSlave);
 
   install<UnregisterSlaveMessage>(
       &Master::unregisterSlave,
@@ -798,6 +949,8 @@ void Master::initialize()
       &ExecutorToFrameworkMessage::executor_id,
       &ExecutorToFrameworkMessage::data);
 
+  install<ExecutorToFrameworkMessages>(&Master::executorMessages);
+
   install<ReconcileTasksMessage>(
       &Master::reconcileTasks,
       &ReconcileTasksMessage::framework_id,
@@ -819,6 +972,16 @@ void Master::initialize()
       &Master::authenticate,
       &AuthenticateMessage::pid);
 
+  // Mark the messages that drive task scheduling as latency-critical
+  // so that under overload they are delivered ahead of ordinary
+  // events and of (background) HTTP requests: we prefer degrading
+  // dashboards over degrading task scheduling.
+  prioritize(LaunchTasksMessage().GetTypeName());
+  prioritize(StatusUpdateMessage().GetTypeName());
+  prioritize(StatusUpdateAcknowledgementMessage().GetTypeName());
+  prioritize(StatusUpdateAcknowledgementsMessage().GetTypeName());
+  prioritize(ExitedExecutorMessage().GetTypeName());
+
   // Setup HTTP routes.
   route("/api/v1/scheduler",
         Http::SCHEDULER_HELP(),
@@ -826,6 +989,12 @@ void Master::initialize()
           Http::log(request);
           return http.scheduler(request);
         });
+  route("/allocator",
+        Http::ALLOCATOR_HELP(),
+        [this](const process::http::Request& request) {
+          Http::log(request);
+          return http.allocator(request);
+        });
   route("/create-volumes",
         DEFAULT_HTTP_AUTHENTICATION_REALM,
         Http::CREATE_VOLUMES_HELP(),
@@ -920,6 +1089,12 @@ void Master::initialize()
           Http::log(request);
           return http.state(request);
         });
+  route("/state.recordio",
+        Http::STATE_RECORDIO_HELP(),
+        [this](const process::http::Request& request) {
+          Http::log(request);
+          return http.stateRecordio(request);
+        });
   route("/state-summary",
         Http::STATESUMMARY_HELP(),
         [this](const process::http::Request& request) {
@@ -1129,6 +1304,10 @@ void Master::finalize()
   wait(whitelistWatcher);
   delete whitelistWatcher;
 
+  terminate(readiness);
+  wait(readiness);
+  delete readiness;
+
   if (authenticator.isSome()) {
     delete authenticator.get();
   }
@@ -1446,6 +1625,47 @@ void Master::exceededCapacity(
 }
 
 
+void Master::adaptRateLimits()
+{
+  // Measure the master's headroom from the backlog of its event
+  // queue: an empty queue means the master is keeping up and
+  // frameworks can be granted more than their configured rate,
+  // while a backlog at or beyond the saturation threshold means
+  // the configured (worst case) limits are enforced as-is. Since
+  // this runs as a dispatch on the master itself, the measurement
+  // reflects the backlog remaining at the time the master gets to
+  // it, which also accounts for the master falling behind on
+  // processing.
+  size_t backlog =
+    eventCount<MessageEvent>() + eventCount<process::DispatchEvent>();
+
+  double headroom = 1.0 - std::min(
+      1.0,
+      static_cast<double>(backlog) / RATE_LIMIT_SATURATION_QUEUE_SIZE);
+
+  // Scale each framework's effective limit linearly between the
+  // configured qps (no headroom) and RATE_LIMIT_MAX_HEADROOM_BOOST
+  // times it (idle). Well behaved frameworks are unaffected when
+  // the master is idle; frameworks exceeding their configured rate
+  // are squeezed back towards it first as the backlog grows.
+  double boost = 1.0 + (RATE_LIMIT_MAX_HEADROOM_BOOST - 1.0) * headroom;
+
+  foreachvalue (const Option<Owned<BoundedRateLimiter>>& limiter,
+                frameworks.limiters) {
+    if (limiter.isSome()) {
+      limiter.get()->limiter->setPermitsPerSecond(limiter.get()->qps * boost);
+    }
+  }
+
+  if (frameworks.defaultLimiter.isSome()) {
+    frameworks.defaultLimiter.get()->limiter->setPermitsPerSecond(
+        frameworks.defaultLimiter.get()->qps * boost);
+  }
+
+  delay(RATE_LIMIT_ADAPTATION_INTERVAL, self(), &Master::adaptRateLimits);
+}
+
+
 void Master::_visit(const ExitedEvent& event)
 {
   Process<Master>::visit(event);
@@ -1467,6 +1687,12 @@ Future<Nothing> Master::recover()
   if (recovered.isNone()) {
     LOG(INFO) << "Recovering from registrar";
 
+    // Start the failover phase timers. They are stopped as each
+    // phase completes, see the comments in Metrics.
+    metrics->failover_registry_recovery.start();
+    metrics->failover_slave_reregistration.start();
+    metrics->failover_framework_reregistration.start();
+
     recovered = registrar->recover(info_)
       .then(defer(self(), &Self::_recover, lambda::_1));
   }
@@ -1477,10 +1703,18 @@ Future<Nothing> Master::recover()
 
 Future<Nothing> Master::_recover(const Registry& registry)
 {
+  metrics->failover_registry_recovery.stop();
+
   foreach (const Registry::Slave& slave, registry.slaves().slaves()) {
     slaves.recovered.insert(slave.info().id());
   }
 
+  // If the registry contained no slaves there is nothing to wait
+  // for, so the re-registration phase completes immediately.
+  if (slaves.recovered.empty()) {
+    metrics->failover_slave_reregistration.stop();
+  }
+
   // Set up a timeout for slaves to re-register.
   slaves.recoveredTimer =
     delay(flags.slave_reregister_timeout,
@@ -1522,6 +1756,9 @@ Future<Nothing> Master::_recover(const Registry& registry)
             << " ; allowing " << flags.slave_reregister_timeout
             << " for slaves to re-register";
 
+  // Publish for the '/ready' endpoint.
+  readiness->markRecovered();
+
   return Nothing();
 }
 
@@ -1614,7 +1851,10 @@ Nothing Master::removeSlave(const Registry::Slave& slave)
   ++metrics->slave_shutdowns_completed;
   ++metrics->recovery_slave_removals;
 
-  slaves.recovered.erase(slave.info().id());
+  if (slaves.recovered.erase(slave.info().id()) > 0 &&
+      slaves.recovered.empty()) {
+    metrics->failover_slave_reregistration.stop();
+  }
 
   if (flags.registry_strict) {
     slaves.removing.insert(slave.info().id());
@@ -1623,7 +1863,8 @@ Nothing Master::removeSlave(const Registry::Slave& slave)
       .onAny(defer(self(),
                    &Self::_removeSlave,
                    slave.info(),
-                   vector<StatusUpdate>(), // No TASK_LOST updates to send.
+                   // No TASK_LOST updates to send.
+                   hashmap<FrameworkID, vector<StatusUpdate>>(),
                    lambda::_1,
                    "did not re-register after master failover",
                    metrics->slave_removals_reason_unhealthy));
@@ -1719,6 +1960,9 @@ void Master::detected(const Future<Option<MasterInfo>>& _leader)
   if (elected()) {
     electedTime = Clock::now();
 
+    // Publish for the '/ready' endpoint.
+    readiness->markElected();
+
     if (!wasElected) {
       LOG(INFO) << "Elected as the leading master!";
 
@@ -2119,6 +2363,8 @@ void Master::_subscribe(
     // It is now safe to update the framework fields since the request is now
     // guaranteed to be successful. We use the fields passed in during
     // re-registration.
+    stateVersion++;
+
     LOG(INFO) << "Updating info for framework " << framework->id();
 
     framework->updateFrameworkInfo(frameworkInfo);
@@ -2165,9 +2411,9 @@ void Master::_subscribe(
       foreachvalue (Task* task, slave->tasks[framework->id()]) {
         framework->addTask(task);
       }
-      foreachvalue (const ExecutorInfo& executor,
+      foreachvalue (const std::shared_ptr<const ExecutorInfo>& executor,
                     slave->executors[framework->id()]) {
-        framework->addExecutor(slave->id, executor);
+        framework->addExecutor(slave->id, *executor);
       }
     }
 
@@ -2176,6 +2422,9 @@ void Master::_subscribe(
     // currently using!
     addFramework(framework);
 
+    // Record how long after the failover this framework reconnected.
+    metrics->failover_framework_reregistration.stop();
+
     FrameworkReregisteredMessage message;
     message.mutable_framework_id()->MergeFrom(framework->id());
     message.mutable_master_info()->MergeFrom(info_);
@@ -2410,6 +2659,8 @@ void Master::_subscribe(
     // It is now safe to update the framework fields since the request is now
     // guaranteed to be successful. We use the fields passed in during
     // re-registration.
+    stateVersion++;
+
     LOG(INFO) << "Updating info for framework " << framework->id();
 
     framework->updateFrameworkInfo(frameworkInfo);
@@ -2485,9 +2736,9 @@ void Master::_subscribe(
       foreachvalue (Task* task, slave->tasks[framework->id()]) {
         framework->addTask(task);
       }
-      foreachvalue (const ExecutorInfo& executor,
+      foreachvalue (const std::shared_ptr<const ExecutorInfo>& executor,
                     slave->executors[framework->id()]) {
-        framework->addExecutor(slave->id, executor);
+        framework->addExecutor(slave->id, *executor);
       }
     }
 
@@ -2496,6 +2747,9 @@ void Master::_subscribe(
     // currently using!
     addFramework(framework);
 
+    // Record how long after the failover this framework reconnected.
+    metrics->failover_framework_reregistration.stop();
+
     // TODO(bmahler): We have to send a registered message here for
     // the re-registering framework, per the API contract. Send
     // re-register here per MESOS-786; requires deprecation or it
@@ -2593,6 +2847,8 @@ void Master::disconnect(Framework* framework)
 
 void Master::deactivate(Framework* framework)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(framework);
 
   LOG(INFO) << "Deactivating framework " << *framework;
@@ -2603,14 +2859,44 @@ void Master::deactivate(Framework* framework)
   // Tell the allocator to stop allocating resources to this framework.
   allocator->deactivateFramework(framework->id());
 
-  // Remove the framework's offers.
+  // Remove the framework's offers. A framework may hold an offer per
+  // agent, so the recoveries are batched into a single allocator call
+  // and the rescind messages are fanned out in batches.
+  CHECK_NONE(recoveries);
+  recoveries = vector<mesos::master::allocator::ResourceRecovery>();
+
+  CHECK_NONE(rescinds);
+  rescinds = vector<OfferID>();
+
   foreach (Offer* offer, utils::copy(framework->offers)) {
-    allocator->recoverResources(
+    recoverResources(
         offer->framework_id(), offer->slave_id(), offer->resources(), None());
 
     removeOffer(offer, true); // Rescind.
   }
 
+  if (!recoveries->empty()) {
+    allocator->recoverResources(recoveries.get());
+  }
+
+  recoveries = None();
+
+  Owned<vector<OfferID>> rescinded(new vector<OfferID>(rescinds.get()));
+  rescinds = None();
+
+  if (!rescinded->empty()) {
+    // All of the framework's offers are gone now, so a single update
+    // replaces the per-offer recalculations `removeOffer` skipped.
+    if (flags.offer_hoarding_threshold.isSome()) {
+      allocator->updateOfferHolding(
+          framework->id(), None(), flags.offer_hoarding_threshold.get());
+    }
+
+    // Fan the rescind messages out in batches so that a framework
+    // holding many offers does not stall the master actor.
+    _rescindOffers(framework->id(), rescinded, 0);
+  }
+
   // Remove the framework's inverse offers.
   foreach (InverseOffer* inverseOffer, utils::copy(framework->inverseOffers)) {
     allocator->updateInverseOffer(
@@ -2647,6 +2933,8 @@ void Master::disconnect(Slave* slave)
 
 void Master::deactivate(Slave* slave)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(slave);
 
   LOG(INFO) << "Deactivating slave " << *slave;
@@ -2717,6 +3005,7 @@ void Master::request(
   LOG(INFO) << "Processing REQUEST call for framework " << *framework;
 
   ++metrics->messages_resource_request;
+  ++framework->metrics.messages_received;
 
   allocator->requestResources(
       framework->id(),
@@ -2731,6 +3020,7 @@ void Master::suppress(Framework* framework)
   LOG(INFO) << "Processing SUPPRESS call for framework " << *framework;
 
   ++metrics->messages_suppress_offers;
+  ++framework->metrics.messages_received;
 
   allocator->suppressOffers(framework->id());
 }
@@ -2971,6 +3261,8 @@ Resources Master::addTask(
     Framework* framework,
     Slave* slave)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
   CHECK(slave->connected) << "Adding task " << task.task_id()
@@ -3009,16 +3301,91 @@ Resources Master::addTask(
 
 void Master::accept(
     Framework* framework,
-    const scheduler::Call::Accept& accept)
+    scheduler::Call::Accept accept)
 {
   CHECK_NOTNULL(framework);
 
+  ++framework->metrics.messages_received;
+
+  // Register task templates and expand template references before
+  // authorization and validation below, since both operate on the
+  // full task. A task that carries a 'template_id' together with a
+  // CommandInfo or ExecutorInfo (re)registers the template; a task
+  // that carries only a 'template_id' is expanded from the
+  // registered template and dropped with a TASK_ERROR if the
+  // template is unknown.
+  foreach (Offer::Operation& operation, *accept.mutable_operations()) {
+    if (operation.type() != Offer::Operation::LAUNCH) {
+      continue;
+    }
+
+    Offer::Operation::Launch* launch = operation.mutable_launch();
+
+    int i = 0;
+    while (i < launch->task_infos_size()) {
+      TaskInfo* task = launch->mutable_task_infos(i);
+
+      if (!task->has_template_id()) {
+        i++;
+        continue;
+      }
+
+      if (task->has_command() || task->has_executor()) {
+        // This full task (re)defines the template. The per-instance
+        // fields are excluded; in particular the resources, since
+        // merging appends repeated fields.
+        TaskInfo template_ = *task;
+        template_.clear_template_id();
+        template_.clear_resources();
+
+        framework->taskTemplates[task->template_id()] = template_;
+
+        task->clear_template_id();
+        i++;
+        continue;
+      }
+
+      if (!framework->taskTemplates.contains(task->template_id())) {
+        const StatusUpdate& update = protobuf::createStatusUpdate(
+            framework->id(),
+            task->slave_id(),
+            task->task_id(),
+            TASK_ERROR,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Task references unknown template '" +
+              task->template_id() + "'",
+            TaskStatus::REASON_TASK_INVALID);
+
+        metrics->tasks_error++;
+
+        metrics->incrementTasksStates(
+            TASK_ERROR,
+            TaskStatus::SOURCE_MASTER,
+            TaskStatus::REASON_TASK_INVALID);
+
+        forward(update, UPID(), framework);
+
+        launch->mutable_task_infos()->DeleteSubrange(i, 1);
+        continue;
+      }
+
+      TaskInfo expanded = framework->taskTemplates[task->template_id()];
+      expanded.MergeFrom(*task);
+      expanded.clear_template_id();
+
+      task->CopyFrom(expanded);
+      i++;
+    }
+  }
+
   foreach (const Offer::Operation& operation, accept.operations()) {
     if (operation.type() == Offer::Operation::LAUNCH) {
       if (operation.launch().task_infos().size() > 0) {
         ++metrics->messages_launch_tasks;
       } else {
         ++metrics->messages_decline_offers;
+        framework->metrics.offers_declined += accept.offer_ids().size();
       }
     }
 
@@ -3084,9 +3451,19 @@ void Master::accept(
       }
 
       // If the offer was neither in our offer or inverse offer sets, then this
-      // offer is no longer valid.
-      LOG(WARNING) << "Ignoring accept of offer " << offerId
-                   << " since it is no longer valid";
+      // offer is no longer valid. If the offer was rescinded, this is
+      // an expected race: the ACCEPT was in flight when the rescind
+      // was sent and the resources have already been re-allocated.
+      Option<uint64_t> epoch = rescindedOffers.get(offerId);
+      if (epoch.isSome()) {
+        LOG(INFO) << "Dropping accept of offer " << offerId
+                  << " from framework " << *framework
+                  << " because the offer was rescinded at offer epoch "
+                  << epoch.get() << " (current epoch " << offerEpoch << ")";
+      } else {
+        LOG(WARNING) << "Ignoring accept of offer " << offerId
+                     << " since it is no longer valid";
+      }
     }
   }
 
@@ -3521,6 +3898,18 @@ void Master::_accept(
       }
 
       case Offer::Operation::LAUNCH: {
+        // We accumulate the launched tasks so that they can be sent
+        // to the agent in a single message, rather than one message
+        // per task; bulk launches of hundreds of tasks on one agent
+        // are common for batch frameworks.
+        RunTasksMessage message;
+        message.mutable_framework()->MergeFrom(framework->info);
+
+        // TODO(anand): We set 'pid' to UPID() for http frameworks
+        // as 'pid' was made optional in 0.24.0. In 0.25.0, we
+        // no longer have to set pid here for http frameworks.
+        message.set_pid(framework->pid.getOrElse(UPID()));
+
         foreach (const TaskInfo& task, operation.launch().task_infos()) {
           Future<bool> authorization = authorizations.front();
           authorizations.pop_front();
@@ -3616,6 +4005,8 @@ void Master::_accept(
           if (pending) {
             _offeredResources -= addTask(task_, framework, slave);
 
+            ++framework->metrics.tasks_launched;
+
             // TODO(bmahler): Consider updating this log message to
             // indicate when the executor is also being launched.
             LOG(INFO) << "Launching task " << task_.task_id()
@@ -3623,27 +4014,33 @@ void Master::_accept(
                       << " with resources " << task_.resources()
                       << " on slave " << *slave;
 
-            RunTaskMessage message;
-            message.mutable_framework()->MergeFrom(framework->info);
-
-            // TODO(anand): We set 'pid' to UPID() for http frameworks
-            // as 'pid' was made optional in 0.24.0. In 0.25.0, we
-            // no longer have to set pid here for http frameworks.
-            message.set_pid(framework->pid.getOrElse(UPID()));
-            message.mutable_task()->MergeFrom(task_);
+            TaskInfo* launched = message.add_tasks();
+            launched->MergeFrom(task_);
 
             if (HookManager::hooksAvailable()) {
               // Set labels retrieved from label-decorator hooks.
-              message.mutable_task()->mutable_labels()->CopyFrom(
+              launched->mutable_labels()->CopyFrom(
                   HookManager::masterLaunchTaskLabelDecorator(
                       task_,
                       framework->info,
                       slave->info));
             }
-
-            send(slave->pid, message);
           }
         }
+
+        if (message.tasks_size() == 1) {
+          // NOTE: A single task is sent as the singular
+          // RunTaskMessage to remain compatible with agents that
+          // predate RunTasksMessage.
+          RunTaskMessage message_;
+          message_.mutable_framework()->CopyFrom(message.framework());
+          message_.set_pid(message.pid());
+          message_.mutable_task()->CopyFrom(message.tasks(0));
+
+          send(slave->pid, message_);
+        } else if (message.tasks_size() > 1) {
+          send(slave->pid, message);
+        }
         break;
       }
 
@@ -3674,6 +4071,8 @@ void Master::decline(
             << " for framework " << *framework;
 
   ++metrics->messages_decline_offers;
+  ++framework->metrics.messages_received;
+  framework->metrics.offers_declined += decline.offer_ids().size();
 
   //  Return resources to the allocator.
   foreach (const OfferID& offerId, decline.offer_ids()) {
@@ -3716,9 +4115,14 @@ void Master::decline(
     }
 
     // If the offer was neither in our offer or inverse offer sets, then this
-    // offer is no longer valid.
-    LOG(WARNING) << "Ignoring decline of offer " << offerId
-                 << " since it is no longer valid";
+    // offer is no longer valid. As in 'accept', a decline of a
+    // rescinded offer is an expected race.
+    if (rescindedOffers.get(offerId).isSome()) {
+      LOG(INFO) << "Dropping decline of rescinded offer " << offerId;
+    } else {
+      LOG(WARNING) << "Ignoring decline of offer " << offerId
+                   << " since it is no longer valid";
+    }
   }
 }
 
@@ -3752,6 +4156,7 @@ void Master::revive(Framework* framework)
   LOG(INFO) << "Processing REVIVE call for framework " << *framework;
 
   ++metrics->messages_revive_offers;
+  ++framework->metrics.messages_received;
 
   allocator->reviveOffers(framework->id());
 }
@@ -3788,11 +4193,74 @@ void Master::killTask(
 }
 
 
+void Master::killTasks(
+    const UPID& from,
+    const FrameworkID& frameworkId,
+    const vector<TaskID>& taskIds)
+{
+  LOG(INFO) << "Asked to kill " << taskIds.size()
+            << " tasks of framework " << frameworkId;
+
+  Framework* framework = getFramework(frameworkId);
+
+  if (framework == NULL) {
+    LOG(WARNING)
+      << "Ignoring kill tasks message for framework " << frameworkId
+      << " because the framework cannot be found";
+    return;
+  }
+
+  if (framework->pid != from) {
+    LOG(WARNING)
+      << "Ignoring kill tasks message for framework " << *framework
+      << " because it is not expected from " << from;
+    return;
+  }
+
+  // Accumulate the kills that would result in a message to a
+  // connected agent, so that each agent gets a single message
+  // covering all of its killed tasks.
+  hashmap<Slave*, vector<TaskID>> batch;
+
+  foreach (const TaskID& taskId, taskIds) {
+    scheduler::Call::Kill call;
+    call.mutable_task_id()->CopyFrom(taskId);
+
+    _kill(framework, call, &batch);
+  }
+
+  foreachpair (Slave* slave, const vector<TaskID>& killed, batch) {
+    LOG(INFO) << "Telling slave " << *slave
+              << " to kill " << killed.size()
+              << " tasks of framework " << *framework;
+
+    KillTasksMessage message;
+    message.mutable_framework_id()->MergeFrom(framework->id());
+
+    foreach (const TaskID& taskId, killed) {
+      message.add_task_ids()->MergeFrom(taskId);
+    }
+
+    send(slave->pid, message);
+  }
+}
+
+
 void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
+{
+  _kill(framework, kill, NULL);
+}
+
+
+void Master::_kill(
+    Framework* framework,
+    const scheduler::Call::Kill& kill,
+    hashmap<Slave*, vector<TaskID>>* batch)
 {
   CHECK_NOTNULL(framework);
 
   ++metrics->messages_kill_task;
+  ++framework->metrics.messages_received;
 
   const TaskID& taskId = kill.task_id();
   const Option<SlaveID> slaveId =
@@ -3852,6 +4320,11 @@ void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
   // NOTE: This task will be properly reconciled when the
   // disconnected slave re-registers with the master.
   if (slave->connected) {
+    if (batch != NULL) {
+      (*batch)[slave].push_back(taskId);
+      return;
+    }
+
     LOG(INFO) << "Telling slave " << *slave
               << " to kill task " << taskId
               << " of framework " << *framework;
@@ -3912,6 +4385,26 @@ void Master::statusUpdateAcknowledgement(
 }
 
 
+void Master::statusUpdateAcknowledgements(
+    const UPID& from,
+    const FrameworkID& frameworkId,
+    const vector<StatusUpdateAcknowledgementMessage>& acknowledgements)
+{
+  // NOTE: We funnel each entry through the singular handler so that
+  // the per-acknowledgement validation and metrics are identical to
+  // receiving individual messages.
+  foreach (const StatusUpdateAcknowledgementMessage& acknowledgement,
+           acknowledgements) {
+    statusUpdateAcknowledgement(
+        from,
+        acknowledgement.slave_id(),
+        frameworkId,
+        acknowledgement.task_id(),
+        acknowledgement.uuid());
+  }
+}
+
+
 void Master::acknowledge(
     Framework* framework,
     const scheduler::Call::Acknowledge& acknowledge)
@@ -3919,6 +4412,7 @@ void Master::acknowledge(
   CHECK_NOTNULL(framework);
 
   metrics->messages_status_update_acknowledgement++;
+  ++framework->metrics.messages_received;
 
   const SlaveID slaveId = acknowledge.slave_id();
   const TaskID taskId = acknowledge.task_id();
@@ -4091,6 +4585,83 @@ void Master::executorMessage(
 }
 
 
+void Master::executorMessages(
+    const UPID& from,
+    const ExecutorToFrameworkMessages& messages)
+{
+  metrics->messages_executor_to_framework += messages.data().size();
+
+  const SlaveID& slaveId = messages.slave_id();
+  const FrameworkID& frameworkId = messages.framework_id();
+  const ExecutorID& executorId = messages.executor_id();
+
+  if (slaves.removed.get(slaveId).isSome()) {
+    // If the slave is removed, we have already informed
+    // frameworks that its tasks were LOST, so the slave
+    // should shut down.
+    LOG(WARNING) << "Ignoring a batch of " << messages.data().size()
+                 << " executor messages"
+                 << " from executor" << " '" << executorId << "'"
+                 << " of framework " << frameworkId
+                 << " on removed slave " << slaveId
+                 << " ; asking slave to shutdown";
+
+    ShutdownMessage message;
+    message.set_message("Executor message from unknown slave");
+    reply(message);
+    metrics->invalid_executor_to_framework_messages += messages.data().size();
+    return;
+  }
+
+  // The slave should (re-)register with the master before
+  // forwarding executor messages.
+  if (!slaves.registered.contains(slaveId)) {
+    LOG(WARNING) << "Ignoring a batch of " << messages.data().size()
+                 << " executor messages"
+                 << " from executor '" << executorId << "'"
+                 << " of framework " << frameworkId
+                 << " on unknown slave " << slaveId;
+    metrics->invalid_executor_to_framework_messages += messages.data().size();
+    return;
+  }
+
+  Slave* slave = slaves.registered.get(slaveId);
+  CHECK_NOTNULL(slave);
+
+  Framework* framework = getFramework(frameworkId);
+
+  if (framework == NULL) {
+    LOG(WARNING) << "Not forwarding a batch of " << messages.data().size()
+                 << " executor messages"
+                 << " for executor '" << executorId << "'"
+                 << " of framework " << frameworkId
+                 << " on slave " << *slave
+                 << " because the framework is unknown";
+    metrics->invalid_executor_to_framework_messages += messages.data().size();
+    return;
+  }
+
+  if (framework->http.isSome()) {
+    // The v1 scheduler API has no batched message event, so unpack
+    // the batch into individual messages for HTTP frameworks.
+    foreach (const string& data, messages.data()) {
+      ExecutorToFrameworkMessage message;
+      message.mutable_slave_id()->MergeFrom(slaveId);
+      message.mutable_framework_id()->MergeFrom(frameworkId);
+      message.mutable_executor_id()->MergeFrom(executorId);
+      message.set_data(data);
+
+      framework->send(message);
+    }
+  } else {
+    // The scheduler driver unpacks the batch itself.
+    framework->send(messages);
+  }
+
+  metrics->valid_executor_to_framework_messages += messages.data().size();
+}
+
+
 void Master::message(
     Framework* framework,
     const scheduler::Call::Message& message)
@@ -4098,6 +4669,7 @@ void Master::message(
   CHECK_NOTNULL(framework);
 
   metrics->messages_framework_to_executor++;
+  ++framework->metrics.messages_received;
 
   Slave* slave = slaves.registered.get(message.slave_id());
 
@@ -4308,15 +4880,12 @@ void Master::_registerSlave(
 
 void Master::reregisterSlave(
     const UPID& from,
-    const SlaveInfo& slaveInfo,
-    const vector<Resource>& checkpointedResources,
-    const vector<ExecutorInfo>& executorInfos,
-    const vector<Task>& tasks,
-    const vector<Archive::Framework>& completedFrameworks,
-    const string& version)
+    const ReregisterSlaveMessage& message)
 {
   ++metrics->messages_reregister_slave;
 
+  const SlaveInfo& slaveInfo = message.slave();
+
   if (authenticating.contains(from)) {
     LOG(INFO) << "Queuing up re-registration request from " << from
               << " because authentication is still in progress";
@@ -4325,12 +4894,7 @@ void Master::reregisterSlave(
       .onReady(defer(self(),
                      &Self::reregisterSlave,
                      from,
-                     slaveInfo,
-                     checkpointedResources,
-                     executorInfos,
-                     tasks,
-                     completedFrameworks,
-                     version));
+                     message));
     return;
   }
 
@@ -4340,9 +4904,9 @@ void Master::reregisterSlave(
     // re-register without authentication.
     LOG(WARNING) << "Refusing re-registration of slave at " << from
                  << " because it is not authenticated";
-    ShutdownMessage message;
-    message.set_message("Slave is not authenticated");
-    send(from, message);
+    ShutdownMessage shutdown;
+    shutdown.set_message("Slave is not authenticated");
+    send(from, shutdown);
     return;
   }
 
@@ -4358,9 +4922,9 @@ void Master::reregisterSlave(
                  << " because the machine '" << machineId << "' that it is "
                  << "running on is `DOWN`";
 
-    ShutdownMessage message;
-    message.set_message("Machine is `DOWN`");
-    send(from, message);
+    ShutdownMessage shutdown;
+    shutdown.set_message("Machine is `DOWN`");
+    send(from, shutdown);
     return;
   }
 
@@ -4374,15 +4938,20 @@ void Master::reregisterSlave(
                  << " (" << slaveInfo.hostname() << ") attempted to "
                  << "re-register after removal; shutting it down";
 
-    ShutdownMessage message;
-    message.set_message("Slave attempted to re-register after removal");
-    send(from, message);
+    ShutdownMessage shutdown;
+    shutdown.set_message("Slave attempted to re-register after removal");
+    send(from, shutdown);
     return;
   }
 
   Slave* slave = slaves.registered.get(slaveInfo.id());
 
   if (slave != NULL) {
+    // This covers both the full and the digests-only re-registration
+    // paths below: each updates the slave's pid and re-registration
+    // time and possibly reactivates the slave.
+    stateVersion++;
+
     slave->reregisteredTime = Clock::now();
 
     // NOTE: This handles the case where a slave tries to
@@ -4406,11 +4975,11 @@ void Master::reregisterSlave(
                    << slave->pid.address.ip << " (" << slave->info.hostname()
                    << ") shutting it down";
 
-      ShutdownMessage message;
-      message.set_message(
+      ShutdownMessage shutdown;
+      shutdown.set_message(
           "Slave attempted to re-register with different IP / hostname");
 
-      send(from, message);
+      send(from, shutdown);
       return;
     }
 
@@ -4423,6 +4992,75 @@ void Master::reregisterSlave(
     slave->pid = from;
     link(slave->pid);
 
+    if (message.digests_only()) {
+      // The agent sent only per-framework digests of its task and
+      // executor state. If they all match the digests we maintain
+      // (and no kills are pending towards this slave), the states
+      // are identical and the full state transfer and reconciliation
+      // can be skipped entirely.
+      bool matched = slave->killedTasks.empty() &&
+        message.digests_size() == static_cast<int>(slave->digests.size());
+
+      if (matched) {
+        foreach (const ReregisterSlaveMessage::FrameworkDigest& digest,
+                 message.digests()) {
+          Option<uint64_t> expected =
+            slave->digests.get(digest.framework_id());
+
+          if (expected.isNone() || expected.get() != digest.digest()) {
+            matched = false;
+            break;
+          }
+        }
+      }
+
+      if (!matched) {
+        LOG(INFO) << "Requesting full state from slave " << *slave
+                  << " because its re-registration digests could not be"
+                  << " verified";
+
+        RequestSlaveStateMessage request;
+        request.mutable_slave_id()->CopyFrom(slave->id);
+        send(from, request);
+        return;
+      }
+
+      LOG(INFO) << "Re-registered slave " << *slave
+                << " via matching digests";
+
+      // Re-register the slave. No reconciliations are necessary
+      // since the digests certify that the slave's task and executor
+      // state agrees with ours.
+      Duration pingTimeout =
+        flags.slave_ping_timeout * flags.max_slave_ping_timeouts;
+      MasterSlaveConnection connection;
+      connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+
+      SlaveReregisteredMessage reregistered;
+      reregistered.mutable_slave_id()->CopyFrom(slave->id);
+      reregistered.mutable_connection()->CopyFrom(connection);
+      send(slave->pid, reregistered);
+
+      if (!slave->connected) {
+        slave->connected = true;
+        dispatch(slave->observer, &SlaveObserver::reconnect);
+        slave->active = true;
+        allocator->activateSlave(slave->id);
+      }
+
+      CHECK(slave->active)
+        << "Unexpected connected but deactivated slave " << *slave;
+
+      __reregisterSlave(slave);
+      return;
+    }
+
+    // Only materialize the heavy repeated fields now that we know
+    // this re-registration will actually be processed.
+    vector<ExecutorInfo> executorInfos =
+      google::protobuf::convert(message.executor_infos());
+    vector<Task> tasks = google::protobuf::convert(message.tasks());
+
     // Reconcile tasks between master and the slave.
     // NOTE: This sends the re-registered message, including tasks
     // that need to be reconciled by the slave.
@@ -4443,14 +5081,33 @@ void Master::reregisterSlave(
       << "Unexpected connected but deactivated slave " << *slave;
 
     // Inform the slave of the new framework pids for its tasks.
-    __reregisterSlave(slave, tasks);
+    __reregisterSlave(slave);
+
+    return;
+  }
 
+  // A digest-only re-registration cannot be admitted without the
+  // full task and executor state (e.g., the agent is re-registering
+  // with a failed over master), so ask the agent to re-send
+  // everything.
+  if (message.digests_only()) {
+    LOG(INFO) << "Requesting full state from slave " << slaveInfo.id()
+              << " at " << from << " (" << slaveInfo.hostname() << ")"
+              << " because it attempted a digest-only re-registration"
+              << " with a master that does not know it";
+
+    RequestSlaveStateMessage request;
+    request.mutable_slave_id()->CopyFrom(slaveInfo.id());
+    send(from, request);
     return;
   }
 
   // Ensure we don't remove the slave for not re-registering after
   // we've recovered it from the registry.
-  slaves.recovered.erase(slaveInfo.id());
+  if (slaves.recovered.erase(slaveInfo.id()) > 0 &&
+      slaves.recovered.empty()) {
+    metrics->failover_slave_reregistration.stop();
+  }
 
   // If we're already re-registering this slave, then no need to ask
   // the registrar again.
@@ -4467,20 +5124,51 @@ void Master::reregisterSlave(
 
   slaves.reregistering.insert(slaveInfo.id());
 
+  // After a failover all of the slaves re-register at roughly the
+  // same time and each readmission applies the slave's full task and
+  // executor state inline. If a re-registration rate limiter is
+  // configured we acquire a permit first so that the storm is spread
+  // out instead of being processed as fast as it arrives. Note that
+  // retried re-registrations are ignored above while the slave is in
+  // 'reregistering', so each slave holds at most one permit.
+  Future<Nothing> acquire = Nothing();
+
+  if (slaves.reregistrationLimiter.isSome()) {
+    acquire = slaves.reregistrationLimiter.get()->acquire();
+  }
+
+  const string failure = "Slave re-registration rate limit acquisition failed";
+
+  acquire
+    .then(defer(self(), &Self::readmitSlave, message, from))
+    .onFailed(lambda::bind(fail, failure, lambda::_1))
+    .onDiscarded(lambda::bind(fail, failure, "discarded"));
+}
+
+
+Nothing Master::readmitSlave(
+    const ReregisterSlaveMessage& message,
+    const UPID& pid)
+{
   // This handles the case when the slave tries to re-register with
   // a failed over master, in which case we must consult the
   // registrar.
-  registrar->apply(Owned<Operation>(new ReadmitSlave(slaveInfo)))
+  //
+  // The repeated fields are only copied out here, once the dedup
+  // checks in 'reregisterSlave' have passed.
+  registrar->apply(Owned<Operation>(new ReadmitSlave(message.slave())))
     .onAny(defer(self(),
                  &Self::_reregisterSlave,
-                 slaveInfo,
-                 from,
-                 checkpointedResources,
-                 executorInfos,
-                 tasks,
-                 completedFrameworks,
-                 version,
+                 message.slave(),
+                 pid,
+                 google::protobuf::convert(message.checkpointed_resources()),
+                 google::protobuf::convert(message.executor_infos()),
+                 google::protobuf::convert(message.tasks()),
+                 google::protobuf::convert(message.completed_frameworks()),
+                 message.version(),
                  lambda::_1));
+
+  return Nothing();
 }
 
 
@@ -4547,22 +5235,24 @@ void Master::_reregisterSlave(
     LOG(INFO) << "Re-registered slave " << *slave
               << " with " << slave->info.resources();
 
-    __reregisterSlave(slave, tasks);
+    __reregisterSlave(slave);
   }
 }
 
 
-void Master::__reregisterSlave(Slave* slave, const vector<Task>& tasks)
+void Master::__reregisterSlave(Slave* slave)
 {
   CHECK_NOTNULL(slave);
 
   // Send the latest framework pids to the slave.
-  hashset<FrameworkID> ids;
-
-  foreach (const Task& task, tasks) {
-    Framework* framework = getFramework(task.framework_id());
+  // NOTE: This is derived from the master's task table (which has
+  // been reconciled with the slave by this point) rather than the
+  // re-registration message, so that digest-only re-registrations
+  // (which omit the tasks) are handled uniformly.
+  foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+    Framework* framework = getFramework(frameworkId);
 
-    if (framework != NULL && !ids.contains(framework->id())) {
+    if (framework != NULL) {
       UpdateFrameworkMessage message;
       message.mutable_framework_id()->MergeFrom(framework->id());
 
@@ -4572,8 +5262,6 @@ void Master::__reregisterSlave(Slave* slave, const vector<Task>& tasks)
       message.set_pid(framework->pid.getOrElse(UPID()));
 
       send(slave->pid, message);
-
-      ids.insert(framework->id());
     }
   }
 
@@ -4615,6 +5303,8 @@ void Master::updateSlave(
     const SlaveID& slaveId,
     const Resources& oversubscribedResources)
 {
+  stateVersion++;
+
   ++metrics->messages_update_slave;
 
   if (slaves.removed.get(slaveId).isSome()) {
@@ -4675,16 +5365,43 @@ void Master::updateUnavailability(
     const MachineID& machineId,
     const Option<Unavailability>& unavailability)
 {
-  if (unavailability.isSome()) {
-    machines[machineId].info.mutable_unavailability()->CopyFrom(
-        unavailability.get());
-  } else {
-    machines[machineId].info.clear_unavailability();
-  }
+  hashmap<MachineID, Option<Unavailability>> updates;
+  updates[machineId] = unavailability;
+
+  updateUnavailability(updates);
+}
+
+
+void Master::updateUnavailability(
+    const hashmap<MachineID, Option<Unavailability>>& updates)
+{
+  stateVersion++;
+
+  // Rescinds and unavailability updates are accumulated across all
+  // machines and handed to the allocator in bulk below, so that
+  // applying a maintenance schedule incurs a constant number of
+  // allocator calls (and a single allocation pass) regardless of the
+  // number of machines transitioned.
+  CHECK_NONE(recoveries);
+  recoveries = vector<mesos::master::allocator::ResourceRecovery>();
+
+  vector<mesos::master::allocator::InverseOfferUpdate> inverseOfferUpdates;
+
+  vector<mesos::master::allocator::UnavailabilityUpdate> unavailabilities;
+
+  foreachpair (const MachineID& machineId,
+               const Option<Unavailability>& unavailability,
+               updates) {
+    if (unavailability.isSome()) {
+      machines[machineId].info.mutable_unavailability()->CopyFrom(
+          unavailability.get());
+    } else {
+      machines[machineId].info.clear_unavailability();
+    }
+
+    // TODO(jmlvanre): Only update allocator and rescind offers if the
+    // unavailability has actually changed.
 
-  // TODO(jmlvanre): Only update allocator and rescind offers if the
-  // unavailability has actually changed.
-  if (machines.contains(machineId)) {
     // For every slave on this machine, update the allocator.
     foreach (const SlaveID& slaveId, machines[machineId].slaves) {
       // The slave should not be in the machines mapping if it is removed.
@@ -4707,7 +5424,7 @@ void Master::updateUnavailability(
       // Remove and rescind offers since we want to inform frameworks of the
       // unavailability change as soon as possible.
       foreach (Offer* offer, utils::copy(slave->offers)) {
-        allocator->recoverResources(
+        recoverResources(
             offer->framework_id(), slave->id, offer->resources(), None());
 
         removeOffer(offer, true); // Rescind!
@@ -4716,28 +5433,44 @@ void Master::updateUnavailability(
       // Remove and rescind inverse offers since the allocator will send new
       // inverse offers for the updated unavailability.
       foreach (InverseOffer* inverseOffer, utils::copy(slave->inverseOffers)) {
-        allocator->updateInverseOffer(
-            slave->id,
-            inverseOffer->framework_id(),
-            UnavailableResources{
-                inverseOffer->resources(),
-                inverseOffer->unavailability()},
-            None());
+        inverseOfferUpdates.push_back(
+            mesos::master::allocator::InverseOfferUpdate{
+                slave->id,
+                inverseOffer->framework_id(),
+                UnavailableResources{
+                    inverseOffer->resources(),
+                    inverseOffer->unavailability()},
+                None(),
+                None()});
 
         removeInverseOffer(inverseOffer, true); // Rescind!
       }
 
-      // We remove / rescind all the offers first so that any calls to the
-      // allocator to modify its internal state are queued before the update of
-      // the unavailability in the allocator. We do this so that the allocator's
-      // state can start from a "clean slate" for the new unavailability.
-      // NOTE: Any calls from the Allocator back into the master, for example
-      // `offer()`, are guaranteed to happen after this function exits due to
-      // the Actor pattern.
-
-      allocator->updateUnavailability(slaveId, unavailability);
+      unavailabilities.push_back(
+          mesos::master::allocator::UnavailabilityUpdate{
+              slaveId, unavailability});
     }
   }
+
+  // We remove / rescind all the offers first so that any calls to the
+  // allocator to modify its internal state are queued before the update of
+  // the unavailability in the allocator. We do this so that the allocator's
+  // state can start from a "clean slate" for the new unavailability.
+  // NOTE: Any calls from the Allocator back into the master, for example
+  // `offer()`, are guaranteed to happen after this function exits due to
+  // the Actor pattern.
+  if (!recoveries->empty()) {
+    allocator->recoverResources(recoveries.get());
+  }
+  recoveries = None();
+
+  if (!inverseOfferUpdates.empty()) {
+    allocator->updateInverseOffer(inverseOfferUpdates);
+  }
+
+  if (!unavailabilities.empty()) {
+    allocator->updateUnavailability(unavailabilities);
+  }
 }
 
 
@@ -4922,6 +5655,8 @@ void Master::shutdown(
 {
   CHECK_NOTNULL(framework);
 
+  ++framework->metrics.messages_received;
+
   // TODO(vinod): Add a metric for executor shutdowns.
 
   if (!slaves.registered.contains(shutdown.slave_id())) {
@@ -5017,6 +5752,8 @@ void Master::_reconcileTasks(
   CHECK_NOTNULL(framework);
 
   ++metrics->messages_reconcile_tasks;
+  ++framework->metrics.messages_received;
+  ++framework->metrics.reconciliations;
 
   if (statuses.empty()) {
     // Implicit reconciliation.
@@ -5088,6 +5825,30 @@ void Master::_reconcileTasks(
   LOG(INFO) << "Performing explicit task state reconciliation for "
             << statuses.size() << " tasks of framework " << *framework;
 
+  // Generate the responses in batches so that reconciling a large
+  // number of tasks does not block the master from processing other
+  // events in the interim.
+  __reconcileTasks(
+      framework->id(),
+      Owned<vector<TaskStatus>>(new vector<TaskStatus>(statuses)),
+      0);
+}
+
+
+void Master::__reconcileTasks(
+    const FrameworkID& frameworkId,
+    const Owned<vector<TaskStatus>>& statuses,
+    size_t index)
+{
+  // NOTE: The framework is looked up again for each batch because it
+  // may be removed (or fail over) while batches are still pending.
+  Framework* framework = getFramework(frameworkId);
+  if (framework == NULL) {
+    LOG(WARNING) << "Dropping task state reconciliation for framework "
+                 << frameworkId << " because the framework has been removed";
+    return;
+  }
+
   // Explicit reconciliation occurs for the following cases:
   //   (1) Task is known, but pending: TASK_STAGING.
   //   (2) Task is known: send the latest state.
@@ -5101,7 +5862,11 @@ void Master::_reconcileTasks(
   // action for TASK_LOST. Later, if the task is running, the
   // framework can discover it with implicit reconciliation and will
   // be able to kill it.
-  foreach (const TaskStatus& status, statuses) {
+  size_t limit = std::min(index + RECONCILIATION_BATCH_SIZE, statuses->size());
+
+  for (; index < limit; index++) {
+    const TaskStatus& status = statuses->at(index);
+
     Option<SlaveID> slaveId = None();
     if (status.has_slave_id()) {
       slaveId = status.slave_id();
@@ -5187,6 +5952,10 @@ void Master::_reconcileTasks(
       framework->send(message);
     }
   }
+
+  if (index < statuses->size()) {
+    dispatch(self(), &Master::__reconcileTasks, frameworkId, statuses, index);
+  }
 }
 
 
@@ -5208,8 +5977,10 @@ void Master::frameworkFailoverTimeout(const FrameworkID& frameworkId,
 
 
 void Master::offer(const FrameworkID& frameworkId,
-                   const hashmap<SlaveID, Resources>& resources)
+                   hashmap<SlaveID, Resources> resources)
 {
+  stateVersion++;
+
   if (!frameworks.registered.contains(frameworkId) ||
       !frameworks.registered[frameworkId]->active) {
     LOG(WARNING) << "Master returning resources offered to framework "
@@ -5222,10 +5993,27 @@ void Master::offer(const FrameworkID& frameworkId,
     return;
   }
 
+  Framework* framework = CHECK_NOTNULL(frameworks.registered[frameworkId]);
+
+  // If the link to a PID based scheduler is congested (i.e., it has
+  // stopped draining its socket, perhaps due to a partial network
+  // failure), return the resources to the allocator rather than
+  // queueing more offers behind a send queue that is not moving.
+  // The offers will be re-allocated once the link drains.
+  if (framework->pid.isSome() && process::congested(framework->pid.get())) {
+    LOG(WARNING) << "Master returning resources offered to framework "
+                 << *framework << " because the link to the framework"
+                 << " is congested";
+
+    foreachpair (const SlaveID& slaveId, const Resources& offered, resources) {
+      allocator->recoverResources(frameworkId, slaveId, offered, None());
+    }
+    return;
+  }
+
   // Create an offer for each slave and add it to the message.
   ResourceOffersMessage message;
 
-  Framework* framework = CHECK_NOTNULL(frameworks.registered[frameworkId]);
   foreachpair (const SlaveID& slaveId, const Resources& offered, resources) {
     if (!slaves.registered.contains(slaveId)) {
       LOG(WARNING)
@@ -5278,27 +6066,26 @@ void Master::offer(const FrameworkID& frameworkId,
     // separate offers, so that rescinding offers with revocable
     // resources does not affect offers with regular resources.
 
-    // TODO(bmahler): Set "https" if only "https" is supported.
-    mesos::URL url;
-    url.set_scheme("http");
-    url.mutable_address()->set_hostname(slave->info.hostname());
-    url.mutable_address()->set_ip(stringify(slave->pid.address.ip));
-    url.mutable_address()->set_port(slave->pid.address.port);
-    url.set_path("/" + slave->pid.id);
-
     Offer* offer = new Offer();
     offer->mutable_id()->MergeFrom(newOfferId());
     offer->mutable_framework_id()->MergeFrom(framework->id());
     offer->mutable_slave_id()->MergeFrom(slave->id);
     offer->set_hostname(slave->info.hostname());
-    offer->mutable_url()->MergeFrom(url);
     offer->mutable_resources()->MergeFrom(offered);
     offer->mutable_attributes()->MergeFrom(slave->info.attributes());
 
+    // TODO(bmahler): Set "https" if only "https" is supported.
+    mesos::URL* url = offer->mutable_url();
+    url->set_scheme("http");
+    url->mutable_address()->set_hostname(slave->info.hostname());
+    url->mutable_address()->set_ip(stringify(slave->pid.address.ip));
+    url->mutable_address()->set_port(slave->pid.address.port);
+    url->set_path("/" + slave->pid.id);
+
     // Add all framework's executors running on this slave.
     if (slave->executors.contains(framework->id())) {
-      const hashmap<ExecutorID, ExecutorInfo>& executors =
-        slave->executors[framework->id()];
+      const hashmap<ExecutorID, std::shared_ptr<const ExecutorInfo>>&
+        executors = slave->executors[framework->id()];
       foreachkey (const ExecutorID& executorId, executors) {
         offer->add_executor_ids()->MergeFrom(executorId);
       }
@@ -5326,20 +6113,36 @@ void Master::offer(const FrameworkID& frameworkId,
               offer->id());
     }
 
+    if (flags.offer_hoarding_threshold.isSome()) {
+      offerTimes[offer->id()] = Clock::now();
+
+      // If this is the only outstanding offer, the framework holds
+      // its oldest offer from this point on. Otherwise the oldest
+      // outstanding offer is unchanged and the allocator is already
+      // up to date.
+      if (framework->offers.size() == 1) {
+        allocator->updateOfferHolding(
+            framework->id(),
+            offerTimes[offer->id()],
+            flags.offer_hoarding_threshold.get());
+      }
+    }
+
+    // Add the offer *AND* the corresponding slave's PID. Note that
+    // we copy the offer into the message directly (rather than going
+    // through a temporary) to avoid copying the resources twice.
+    Offer* offer_ = message.add_offers();
+    offer_->CopyFrom(*offer);
+
     // TODO(jieyu): For now, we strip 'ephemeral_ports' resource from
     // offers so that frameworks do not see this resource. This is a
     // short term workaround. Revisit this once we resolve MESOS-1654.
-    Offer offer_ = *offer;
-    offer_.clear_resources();
-
-    foreach (const Resource& resource, offered) {
-      if (resource.name() != "ephemeral_ports") {
-        offer_.add_resources()->CopyFrom(resource);
+    for (int i = offer_->resources().size() - 1; i >= 0; --i) {
+      if (offer_->resources(i).name() == "ephemeral_ports") {
+        offer_->mutable_resources()->DeleteSubrange(i, 1);
       }
     }
 
-    // Add the offer *AND* the corresponding slave's PID.
-    message.add_offers()->MergeFrom(offer_);
     message.add_pids(slave->pid);
   }
 
@@ -5358,6 +6161,8 @@ void Master::inverseOffer(
     const FrameworkID& frameworkId,
     const hashmap<SlaveID, UnavailableResources>& resources)
 {
+  stateVersion++;
+
   if (!frameworks.registered.contains(frameworkId) ||
       !frameworks.registered[frameworkId]->active) {
     LOG(INFO) << "Master ignoring inverse offers to framework " << frameworkId
@@ -5526,7 +6331,8 @@ void Master::authenticate(const UPID& from, const UPID& pid)
   // Save our state.
   authenticating[pid] = future;
 
-  future.onAny(defer(self(), &Self::_authenticate, pid, lambda::_1));
+  future.onAny(
+      defer(self(), &Self::_authenticate, pid, Clock::now(), lambda::_1));
 
   // Don't wait for authentication to complete forever.
   delay(Seconds(5),
@@ -5538,8 +6344,11 @@ void Master::authenticate(const UPID& from, const UPID& pid)
 
 void Master::_authenticate(
     const UPID& pid,
+    const Time& start,
     const Future<Option<string>>& future)
 {
+  metrics->authentication_secs.observe((Clock::now() - start).secs());
+
   if (!future.isReady() || future.get().isNone()) {
     const string& error = future.isReady()
         ? "Refused authentication"
@@ -5724,6 +6533,8 @@ void Master::reconcile(
 
 void Master::addFramework(Framework* framework)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(framework);
 
   CHECK(!frameworks.registered.contains(framework->id()))
@@ -5791,6 +6602,8 @@ void Master::addFramework(Framework* framework)
 
 void Master::failoverFramework(Framework* framework, const HttpConnection& http)
 {
+  stateVersion++;
+
   // Notify the old connected framework that it has failed over.
   // Note that this may be a retry in which case we'll shut down
   // the scheduler unnecessarily.
@@ -5833,6 +6646,8 @@ void Master::failoverFramework(Framework* framework, const HttpConnection& http)
 // event of a scheduler failover.
 void Master::failoverFramework(Framework* framework, const UPID& newPid)
 {
+  stateVersion++;
+
   const Option<UPID> oldPid = framework->pid;
 
   // There are a few failover cases to consider:
@@ -5874,13 +6689,24 @@ void Master::_failoverFramework(Framework* framework)
   // We do this after we have updated the pid and sent the framework
   // registered message so that the allocator can immediately re-offer
   // these resources to this framework if it wants.
+  // A framework may hold an offer per agent, so the recoveries are
+  // batched into a single allocator call.
+  CHECK_NONE(recoveries);
+  recoveries = vector<mesos::master::allocator::ResourceRecovery>();
+
   foreach (Offer* offer, utils::copy(framework->offers)) {
-    allocator->recoverResources(
+    recoverResources(
         offer->framework_id(), offer->slave_id(), offer->resources(), None());
 
     removeOffer(offer);
   }
 
+  if (!recoveries->empty()) {
+    allocator->recoverResources(recoveries.get());
+  }
+
+  recoveries = None();
+
   // Also remove the inverse offers.
   foreach (InverseOffer* inverseOffer, utils::copy(framework->inverseOffers)) {
     allocator->updateInverseOffer(
@@ -5921,13 +6747,47 @@ void Master::teardown(Framework* framework)
   LOG(INFO) << "Processing TEARDOWN call for framework " << *framework;
 
   ++metrics->messages_unregister_framework;
+  ++framework->metrics.messages_received;
 
   removeFramework(framework);
 }
 
 
+void Master::sendShutdownFrameworkMessages(
+    const FrameworkID& frameworkId,
+    const vector<UPID>& pids,
+    size_t index)
+{
+  // The number of messages encoded and sent per actor yield. Chosen
+  // so that a batch takes well under a millisecond, keeping the
+  // master responsive during the fan-out.
+  static const size_t SHUTDOWN_FRAMEWORK_BATCH_SIZE = 100;
+
+  ShutdownFrameworkMessage message;
+  message.mutable_framework_id()->MergeFrom(frameworkId);
+
+  const size_t end =
+    std::min(index + SHUTDOWN_FRAMEWORK_BATCH_SIZE, pids.size());
+
+  for (; index < end; index++) {
+    send(pids[index], message);
+  }
+
+  if (index < pids.size()) {
+    dispatch(
+        self(),
+        &Master::sendShutdownFrameworkMessages,
+        frameworkId,
+        pids,
+        index);
+  }
+}
+
+
 void Master::removeFramework(Framework* framework)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(framework);
 
   LOG(INFO) << "Removing framework " << *framework;
@@ -5939,16 +6799,29 @@ void Master::removeFramework(Framework* framework)
     allocator->deactivateFramework(framework->id());
   }
 
-  // Tell slaves to shutdown the framework.
+  // Tell slaves to shutdown the framework. The sends are spread
+  // across batches that yield the actor in between, since the
+  // messages only depend on the framework id and encoding one per
+  // registered agent inline would stall the master on large
+  // clusters.
+  vector<UPID> pids;
   foreachvalue (Slave* slave, slaves.registered) {
-    ShutdownFrameworkMessage message;
-    message.mutable_framework_id()->MergeFrom(framework->id());
-    send(slave->pid, message);
+    pids.push_back(slave->pid);
   }
 
+  sendShutdownFrameworkMessages(framework->id(), pids, 0);
+
   // Remove the pending tasks from the framework.
   framework->pendingTasks.clear();
 
+  // The loops below produce a resource recovery per non-terminal
+  // task, executor and outstanding offer. Accumulate the recoveries
+  // and hand them to the allocator in a single batch: removing a
+  // framework with tens of thousands of tasks otherwise results in
+  // one allocator dispatch per task.
+  CHECK_NONE(recoveries);
+  recoveries = vector<mesos::master::allocator::ResourceRecovery>();
+
   // Remove pointers to the framework's tasks in slaves.
   foreachvalue (Task* task, utils::copy(framework->tasks)) {
     Slave* slave = slaves.registered.get(task->slave_id());
@@ -5985,9 +6858,19 @@ void Master::removeFramework(Framework* framework)
     removeTask(task);
   }
 
+  // The framework's retained completed tasks no longer contribute to
+  // the slaves' task state summaries once the framework leaves the
+  // registered set.
+  foreach (const shared_ptr<Task>& task, framework->completedTasks) {
+    Slave* slave = slaves.registered.get(task->slave_id());
+    if (slave != NULL) {
+      slave->removeCompletedTask(*task);
+    }
+  }
+
   // Remove the framework's offers (if they weren't removed before).
   foreach (Offer* offer, utils::copy(framework->offers)) {
-    allocator->recoverResources(
+    recoverResources(
         offer->framework_id(),
         offer->slave_id(),
         offer->resources(),
@@ -6021,6 +6904,13 @@ void Master::removeFramework(Framework* framework)
     }
   }
 
+  // Recover the accumulated resources in a single batch.
+  if (!recoveries->empty()) {
+    allocator->recoverResources(recoveries.get());
+  }
+
+  recoveries = None();
+
   // TODO(benh): Similar code between removeFramework and
   // failoverFramework needs to be shared!
 
@@ -6071,6 +6961,8 @@ void Master::removeFramework(Framework* framework)
 
 void Master::removeFramework(Slave* slave, Framework* framework)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(slave);
   CHECK_NOTNULL(framework);
 
@@ -6115,10 +7007,26 @@ void Master::removeFramework(Slave* slave, Framework* framework)
 }
 
 
+void Master::updateRoleResources(
+    const string& role,
+    const Resources& subtracted,
+    const Resources& added)
+{
+  // The role might not be active, e.g., when accounting the tasks of
+  // a framework that has not yet reregistered after a master failover.
+  // Role::addFramework captures the framework's totals in that case.
+  if (activeRoles.contains(role)) {
+    activeRoles[role]->update(subtracted, added);
+  }
+}
+
+
 void Master::addSlave(
     Slave* slave,
     const vector<Archive::Framework>& completedFrameworks)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(slave);
 
   slaves.removed.erase(slave->id);
@@ -6145,11 +7053,11 @@ void Master::addSlave(
 
   // Add the slave's executors to the frameworks.
   foreachkey (const FrameworkID& frameworkId, slave->executors) {
-    foreachvalue (const ExecutorInfo& executorInfo,
+    foreachvalue (const std::shared_ptr<const ExecutorInfo>& executorInfo,
                   slave->executors[frameworkId]) {
       Framework* framework = getFramework(frameworkId);
       if (framework != NULL) { // The framework might not be re-registered yet.
-        framework->addExecutor(slave->id, executorInfo);
+        framework->addExecutor(slave->id, *executorInfo);
       }
     }
   }
@@ -6220,6 +7128,8 @@ void Master::removeSlave(
     const string& message,
     Option<Counter> reason)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(slave);
 
   LOG(INFO) << "Removing slave " << *slave << ": " << message;
@@ -6234,10 +7144,18 @@ void Master::removeSlave(
   // the slave is already removed.
   allocator->removeSlave(slave->id);
 
+  // The loops below produce a resource recovery per non-terminal
+  // task, executor and outstanding offer. Accumulate the recoveries
+  // and hand them to the allocator in a single batch: removing a
+  // dense slave otherwise results in one allocator dispatch per task.
+  CHECK_NONE(recoveries);
+  recoveries = vector<mesos::master::allocator::ResourceRecovery>();
+
   // Transition the tasks to lost and remove them, BUT do not send
-  // updates. Rather, build up the updates so that we can send them
-  // after the slave is removed from the registry.
-  vector<StatusUpdate> updates;
+  // updates. Rather, build up the updates (grouped per framework so
+  // they can be forwarded in batches) so that we can send them after
+  // the slave is removed from the registry.
+  hashmap<FrameworkID, vector<StatusUpdate>> updates;
   foreachkey (const FrameworkID& frameworkId, utils::copy(slave->tasks)) {
     foreachvalue (Task* task, utils::copy(slave->tasks[frameworkId])) {
       const StatusUpdate& update = protobuf::createStatusUpdate(
@@ -6255,7 +7173,7 @@ void Master::removeSlave(
       updateTask(task, update);
       removeTask(task);
 
-      updates.push_back(update);
+      updates[frameworkId].push_back(update);
     }
   }
 
@@ -6270,13 +7188,19 @@ void Master::removeSlave(
   foreach (Offer* offer, utils::copy(slave->offers)) {
     // TODO(vinod): We don't need to call 'Allocator::recoverResources'
     // once MESOS-621 is fixed.
-    allocator->recoverResources(
+    recoverResources(
         offer->framework_id(), slave->id, offer->resources(), None());
 
     // Remove and rescind offers.
     removeOffer(offer, true); // Rescind!
   }
 
+  if (!recoveries->empty()) {
+    allocator->recoverResources(recoveries.get());
+  }
+
+  recoveries = None();
+
   // Remove inverse offers because sending them for a slave that is
   // gone doesn't make sense.
   foreach (InverseOffer* inverseOffer, utils::copy(slave->inverseOffers)) {
@@ -6322,7 +7246,7 @@ void Master::removeSlave(
 
 void Master::_removeSlave(
     const SlaveInfo& slaveInfo,
-    const vector<StatusUpdate>& updates,
+    const hashmap<FrameworkID, vector<StatusUpdate>>& updates,
     const Future<bool>& removed,
     const string& message,
     Option<Counter> reason)
@@ -6350,16 +7274,17 @@ void Master::_removeSlave(
     ++utils::copy(reason.get()); // Remove const.
   }
 
-  // Forward the LOST updates on to the framework.
-  foreach (const StatusUpdate& update, updates) {
-    Framework* framework = getFramework(update.framework_id());
-
-    if (framework == NULL) {
-      LOG(WARNING) << "Dropping update " << update << " from unknown framework "
-                   << update.framework_id();
-    } else {
-      forward(update, UPID(), framework);
-    }
+  // Forward the LOST updates on to the frameworks. The updates are
+  // grouped per framework and forwarded in batches, interleaved with
+  // the rest of the master's work, so that a dense slave (or several
+  // slaves failing together) does not block the master actor.
+  foreachpair (const FrameworkID& frameworkId,
+               const vector<StatusUpdate>& updates_,
+               updates) {
+    __removeSlave(
+        frameworkId,
+        Owned<vector<StatusUpdate>>(new vector<StatusUpdate>(updates_)),
+        0);
   }
 
   // Notify all frameworks of the lost slave.
@@ -6379,8 +7304,37 @@ void Master::_removeSlave(
 }
 
 
+void Master::__removeSlave(
+    const FrameworkID& frameworkId,
+    const Owned<vector<StatusUpdate>>& updates,
+    size_t index)
+{
+  // NOTE: The framework is looked up again for each batch because it
+  // may be removed (or fail over) while batches are still pending.
+  Framework* framework = getFramework(frameworkId);
+  if (framework == NULL) {
+    LOG(WARNING) << "Dropping " << (updates->size() - index)
+                 << " status updates for tasks of unknown framework "
+                 << frameworkId;
+    return;
+  }
+
+  size_t limit = std::min(index + SLAVE_REMOVAL_BATCH_SIZE, updates->size());
+
+  for (; index < limit; index++) {
+    forward(updates->at(index), UPID(), framework);
+  }
+
+  if (index < updates->size()) {
+    dispatch(self(), &Master::__removeSlave, frameworkId, updates, index);
+  }
+}
+
+
 void Master::updateTask(Task* task, const StatusUpdate& update)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(task);
 
   // Get the unacknowledged status.
@@ -6395,6 +7349,8 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
     latestState = update.latest_state();
   }
 
+  const TaskState oldState = task->state();
+
   // Set 'terminated' to true if this is the first time the task
   // transitioned to terminal state. Also set the latest state.
   bool terminated;
@@ -6447,9 +7403,31 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
             << " (latest state: " << task->state()
             << ", status update state: " << status.state() << ")";
 
+  // Keep the incremental task state summaries in sync with the
+  // task's state transition.
+  if (task->state() != oldState) {
+    // The slave owns the Task object and cannot be NULL.
+    Slave* slave = slaves.registered.get(task->slave_id());
+    CHECK_NOTNULL(slave);
+
+    slave->taskSummary.subtract(oldState);
+    slave->taskSummary.add(task->state());
+
+    // Keep the re-registration digest in sync with the state change.
+    slave->digests[task->framework_id()] ^=
+      protobuf::taskDigest(task->task_id(), oldState) ^
+      protobuf::taskDigest(task->task_id(), task->state());
+
+    Framework* framework = getFramework(task->framework_id());
+    if (framework != NULL) {
+      framework->taskSummary.subtract(oldState);
+      framework->taskSummary.add(task->state());
+    }
+  }
+
   // Once the task becomes terminal, we recover the resources.
   if (terminated) {
-    allocator->recoverResources(
+    recoverResources(
         task->framework_id(),
         task->slave_id(),
         task->resources(),
@@ -6487,6 +7465,8 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
 
 void Master::removeTask(Task* task)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(task);
 
   // The slave owns the Task object and cannot be NULL.
@@ -6502,7 +7482,7 @@ void Master::removeTask(Task* task)
 
     // If the task is not terminal, then the resources have
     // not yet been recovered.
-    allocator->recoverResources(
+    recoverResources(
         task->framework_id(),
         task->slave_id(),
         task->resources(),
@@ -6532,17 +7512,19 @@ void Master::removeExecutor(
     const FrameworkID& frameworkId,
     const ExecutorID& executorId)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(slave);
   CHECK(slave->hasExecutor(frameworkId, executorId));
 
-  ExecutorInfo executor = slave->executors[frameworkId][executorId];
+  std::shared_ptr<const ExecutorInfo> executor =
+    slave->executors[frameworkId][executorId];
 
   LOG(INFO) << "Removing executor '" << executorId
-            << "' with resources " << executor.resources()
+            << "' with resources " << executor->resources()
             << " of framework " << frameworkId << " on slave " << *slave;
 
-  allocator->recoverResources(
-    frameworkId, slave->id, executor.resources(), None());
+  recoverResources(frameworkId, slave->id, executor->resources(), None());
 
   Framework* framework = getFramework(frameworkId);
   if (framework != NULL) { // The framework might not be re-registered yet.
@@ -6553,6 +7535,22 @@ void Master::removeExecutor(
 }
 
 
+void Master::recoverResources(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources,
+    const Option<Filters>& filters)
+{
+  if (recoveries.isSome()) {
+    recoveries->push_back(
+        mesos::master::allocator::ResourceRecovery{
+            frameworkId, slaveId, resources, filters});
+  } else {
+    allocator->recoverResources(frameworkId, slaveId, resources, filters);
+  }
+}
+
+
 void Master::apply(
     Framework* framework,
     Slave* slave,
@@ -6576,7 +7574,15 @@ Future<Nothing> Master::apply(Slave* slave, const Offer::Operation& operation)
 }
 
 
+void Master::processStateRequestsBatch()
+{
+  http.processStateRequestsBatch();
+}
+
+
 void Master::_apply(Slave* slave, const Offer::Operation& operation) {
+  stateVersion++;
+
   CHECK_NOTNULL(slave);
 
   slave->apply(operation);
@@ -6607,6 +7613,8 @@ void Master::offerTimeout(const OfferID& offerId)
 // 'useOffer()', 'discardOffer()' and 'rescindOffer()' for clarity.
 void Master::removeOffer(Offer* offer, bool rescind)
 {
+  stateVersion++;
+
   // Remove from framework.
   Framework* framework = getFramework(offer->framework_id());
   CHECK(framework != NULL)
@@ -6625,9 +7633,22 @@ void Master::removeOffer(Offer* offer, bool rescind)
   slave->removeOffer(offer);
 
   if (rescind) {
-    RescindResourceOfferMessage message;
-    message.mutable_offer_id()->MergeFrom(offer->id());
-    framework->send(message);
+    if (rescinds.isSome()) {
+      // A bulk path is rescinding many offers at once; it fans the
+      // messages out itself (see `_rescindOffers`).
+      rescinds->push_back(offer->id());
+    } else {
+      RescindResourceOfferMessage message;
+      message.mutable_offer_id()->MergeFrom(offer->id());
+      framework->send(message);
+    }
+
+    // Remember the rescind so that an ACCEPT already in flight from
+    // the framework can be reconciled against it. Note that callers
+    // recover the resources before rescinding, so the allocator is
+    // free to re-allocate them without waiting for the framework to
+    // observe the rescind.
+    rescindedOffers.put(offer->id(), offerEpoch++);
   }
 
   // Remove and cancel offer removal timers. Canceling the Timers is
@@ -6637,12 +7658,65 @@ void Master::removeOffer(Offer* offer, bool rescind)
     offerTimers.erase(offer->id());
   }
 
+  if (flags.offer_hoarding_threshold.isSome()) {
+    offerTimes.erase(offer->id());
+
+    // Tell the allocator when the framework's now-oldest outstanding
+    // offer was made (or that it no longer holds any offers). While a
+    // bulk path is rescinding all of the framework's offers, the scan
+    // over its remaining offers is skipped here and the path issues a
+    // single update once the batch is removed.
+    if (rescinds.isNone()) {
+      Option<process::Time> oldest = None();
+      foreach (Offer* offer_, framework->offers) {
+        if (offerTimes.contains(offer_->id()) &&
+            (oldest.isNone() || offerTimes[offer_->id()] < oldest.get())) {
+          oldest = offerTimes[offer_->id()];
+        }
+      }
+
+      allocator->updateOfferHolding(
+          framework->id(),
+          oldest,
+          flags.offer_hoarding_threshold.get());
+    }
+  }
+
   // Delete it.
   offers.erase(offer->id());
   delete offer;
 }
 
 
+void Master::_rescindOffers(
+    const FrameworkID& frameworkId,
+    const Owned<vector<OfferID>>& offerIds,
+    size_t index)
+{
+  // NOTE: The framework is looked up again for each batch because it
+  // may be removed while batches are still pending.
+  Framework* framework = getFramework(frameworkId);
+  if (framework == NULL) {
+    LOG(WARNING) << "Dropping " << (offerIds->size() - index)
+                 << " offer rescind messages for unknown framework "
+                 << frameworkId;
+    return;
+  }
+
+  size_t limit = std::min(index + OFFER_RESCIND_BATCH_SIZE, offerIds->size());
+
+  for (; index < limit; index++) {
+    RescindResourceOfferMessage message;
+    message.mutable_offer_id()->MergeFrom(offerIds->at(index));
+    framework->send(message);
+  }
+
+  if (index < offerIds->size()) {
+    dispatch(self(), &Master::_rescindOffers, frameworkId, offerIds, index);
+  }
+}
+
+
 void Master::inverseOfferTimeout(const OfferID& inverseOfferId)
 {
   InverseOffer* inverseOffer = getInverseOffer(inverseOfferId);
@@ -6662,6 +7736,8 @@ void Master::inverseOfferTimeout(const OfferID& inverseOfferId)
 
 void Master::removeInverseOffer(InverseOffer* inverseOffer, bool rescind)
 {
+  stateVersion++;
+
   // Remove from framework.
   Framework* framework = getFramework(inverseOffer->framework_id());
   CHECK(framework != NULL)
@@ -26,6 +26,7 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <mesos/attributes.hpp>
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
 #include <mesos/type_utils.hpp>
@@ -48,6 +49,7 @@
 #include <process/timer.hpp>
 
 #include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
 
 #include <stout/cache.hpp>
 #include <stout/foreach.hpp>
@@ -56,7 +58,9 @@
 #include <stout/multihashmap.hpp>
 #include <stout/option.hpp>
 #include <stout/recordio.hpp>
+#include <stout/stringify.hpp>
 
+#include "common/existence_filter.hpp"
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
 #include "common/resources_utils.hpp"
@@ -97,6 +101,7 @@ class WhitelistWatcher;
 
 namespace master {
 
+class ReadinessProcess;
 class Repairer;
 class SlaveObserver;
 
@@ -106,6 +111,77 @@ struct HttpConnection;
 struct Role;
 
 
+// Summarizes the number of tasks in each possible task state. These
+// are maintained incrementally in the 'Slave' and 'Framework' structs
+// as tasks are added, transitioned and removed, so that summary
+// endpoints (e.g., /state-summary) do not need to walk all tasks on
+// every request.
+struct TaskStateSummary
+{
+  TaskStateSummary()
+    : staging(0),
+      starting(0),
+      running(0),
+      finished(0),
+      killed(0),
+      failed(0),
+      lost(0),
+      error(0) {}
+
+  // Account for a task entering the given state.
+  void add(const TaskState& state)
+  {
+    switch (state) {
+      case TASK_STAGING: { ++staging; break; }
+      case TASK_STARTING: { ++starting; break; }
+      case TASK_RUNNING: { ++running; break; }
+      case TASK_FINISHED: { ++finished; break; }
+      case TASK_KILLED: { ++killed; break; }
+      case TASK_FAILED: { ++failed; break; }
+      case TASK_LOST: { ++lost; break; }
+      case TASK_ERROR: { ++error; break; }
+      // No default case allows for a helpful compiler error if we
+      // introduce a new state.
+    }
+  }
+
+  // Account for a task leaving the given state.
+  void subtract(const TaskState& state)
+  {
+    switch (state) {
+      case TASK_STAGING: { CHECK_GT(staging, 0u); --staging; break; }
+      case TASK_STARTING: { CHECK_GT(starting, 0u); --starting; break; }
+      case TASK_RUNNING: { CHECK_GT(running, 0u); --running; break; }
+      case TASK_FINISHED: { CHECK_GT(finished, 0u); --finished; break; }
+      case TASK_KILLED: { CHECK_GT(killed, 0u); --killed; break; }
+      case TASK_FAILED: { CHECK_GT(failed, 0u); --failed; break; }
+      case TASK_LOST: { CHECK_GT(lost, 0u); --lost; break; }
+      case TASK_ERROR: { CHECK_GT(error, 0u); --error; break; }
+      // No default case allows for a helpful compiler error if we
+      // introduce a new state.
+    }
+  }
+
+  size_t staging;
+  size_t starting;
+  size_t running;
+  size_t finished;
+  size_t killed;
+  size_t failed;
+  size_t lost;
+  size_t error;
+};
+
+
+// Returns a shared, interned copy of the given ExecutorInfo. The same
+// ExecutorInfo is stored in the 'executors' maps of both the Slave
+// and the Framework, and a framework typically runs identical
+// executors on many slaves; interning collapses all of these copies
+// into one allocation. The returned message must not be mutated.
+std::shared_ptr<const ExecutorInfo> internExecutorInfo(
+    const ExecutorInfo& executorInfo);
+
+
 struct Slave
 {
   Slave(const SlaveInfo& _info,
@@ -126,6 +202,7 @@ struct Slave
       registeredTime(_registeredTime),
       connected(true),
       active(true),
+      executorIds(1024),
       checkpointedResources(_checkpointedResources),
       observer(NULL)
   {
@@ -168,11 +245,15 @@ struct Slave
       << "Duplicate task " << taskId << " of framework " << frameworkId;
 
     tasks[frameworkId][taskId] = task;
+    digests[frameworkId] ^= protobuf::taskDigest(taskId, task->state());
 
     if (!protobuf::isTerminalState(task->state())) {
       usedResources[frameworkId] += task->resources();
     }
 
+    taskSummary.add(task->state());
+    ++frameworkTaskCounts[frameworkId];
+
     LOG(INFO) << "Adding task " << taskId
               << " with resources " << task->resources()
               << " on slave " << id << " (" << info.hostname() << ")";
@@ -205,6 +286,11 @@ struct Slave
     CHECK(tasks[frameworkId].contains(taskId))
       << "Unknown task " << taskId << " of framework " << frameworkId;
 
+    // NOTE: The digest update relies on the task's state being kept
+    // in sync by 'Master::updateTask', so XOR-ing the current state
+    // out exactly cancels the contribution added previously.
+    digests[frameworkId] ^= protobuf::taskDigest(taskId, task->state());
+
     if (!protobuf::isTerminalState(task->state())) {
       usedResources[frameworkId] -= task->resources();
       if (!tasks.contains(frameworkId) && !executors.contains(frameworkId)) {
@@ -217,9 +303,35 @@ struct Slave
       tasks.erase(frameworkId);
     }
 
+    if (!tasks.contains(frameworkId) && !executors.contains(frameworkId)) {
+      digests.erase(frameworkId);
+    }
+
+    taskSummary.subtract(task->state());
+    if (--frameworkTaskCounts[frameworkId] == 0) {
+      frameworkTaskCounts.erase(frameworkId);
+    }
+
     killedTasks.remove(frameworkId, taskId);
   }
 
+  // Account for a completed task of a registered framework that ran
+  // on this slave: the task state summaries include the completed
+  // tasks retained by the frameworks.
+  void addCompletedTask(const Task& task)
+  {
+    taskSummary.add(task.state());
+    ++frameworkTaskCounts[task.framework_id()];
+  }
+
+  void removeCompletedTask(const Task& task)
+  {
+    taskSummary.subtract(task.state());
+    if (--frameworkTaskCounts[task.framework_id()] == 0) {
+      frameworkTaskCounts.erase(task.framework_id());
+    }
+  }
+
   void addOffer(Offer* offer)
   {
     CHECK(!offers.contains(offer)) << "Duplicate offer " << offer->id();
@@ -252,9 +364,24 @@ struct Slave
     inverseOffers.erase(inverseOffer);
   }
 
+  // Hashes a (framework, executor) ID pair for 'executorIds'.
+  static size_t executorHash(const FrameworkID& frameworkId,
+                             const ExecutorID& executorId)
+  {
+    return ExistenceFilter::combine(
+        std::hash<FrameworkID>()(frameworkId),
+        std::hash<ExecutorID>()(executorId));
+  }
+
   bool hasExecutor(const FrameworkID& frameworkId,
                    const ExecutorID& executorId) const
   {
+    // Definite misses (the common case when launching a task) cost a
+    // single probe in the filter.
+    if (!executorIds.possiblyContains(executorHash(frameworkId, executorId))) {
+      return false;
+    }
+
     return executors.contains(frameworkId) &&
       executors.get(frameworkId).get().contains(executorId);
   }
@@ -266,7 +393,11 @@ struct Slave
       << "Duplicate executor '" << executorInfo.executor_id()
       << "' of framework " << frameworkId;
 
-    executors[frameworkId][executorInfo.executor_id()] = executorInfo;
+    executors[frameworkId][executorInfo.executor_id()] =
+      internExecutorInfo(executorInfo);
+    executorIds.add(executorHash(frameworkId, executorInfo.executor_id()));
+    digests[frameworkId] ^=
+      protobuf::executorDigest(executorInfo.executor_id());
     usedResources[frameworkId] += executorInfo.resources();
   }
 
@@ -277,14 +408,19 @@ struct Slave
       << "Unknown executor '" << executorId << "' of framework " << frameworkId;
 
     usedResources[frameworkId] -=
-      executors[frameworkId][executorId].resources();
+      executors[frameworkId][executorId]->resources();
 
-    // XXX Remove.
+    digests[frameworkId] ^= protobuf::executorDigest(executorId);
 
     executors[frameworkId].erase(executorId);
     if (executors[frameworkId].empty()) {
       executors.erase(frameworkId);
     }
+    executorIds.remove(executorHash(frameworkId, executorId));
+
+    if (!tasks.contains(frameworkId) && !executors.contains(frameworkId)) {
+      digests.erase(frameworkId);
+    }
   }
 
   void apply(const Offer::Operation& operation)
@@ -317,8 +453,16 @@ struct Slave
   // No offers will be made for a deactivated slave.
   bool active;
 
-  // Executors running on this slave.
-  hashmap<FrameworkID, hashmap<ExecutorID, ExecutorInfo>> executors;
+  // Executors running on this slave. The infos are interned (see
+  // 'internExecutorInfo') and must not be mutated.
+  hashmap<FrameworkID,
+          hashmap<ExecutorID, std::shared_ptr<const ExecutorInfo>>> executors;
+
+  // Fronts 'executors' so that 'hasExecutor' answers the common "no
+  // such executor" case (checked on every task launch) with a single
+  // probe instead of a nested map walk. Updated in 'addExecutor' /
+  // 'removeExecutor'.
+  ExistenceFilter executorIds;
 
   // Tasks present on this slave.
   // TODO(bmahler): The task pointer ownership complexity arises from the fact
@@ -330,6 +474,24 @@ struct Slave
   // This is used for reconciliation when the slave re-registers.
   multihashmap<FrameworkID, TaskID> killedTasks;
 
+  // Per-framework digests of the tasks and executors on this slave,
+  // maintained incrementally (see 'protobuf::taskDigest'). When the
+  // slave re-registers with only digests, matching digests certify
+  // that its task and executor state agrees with ours and the full
+  // state transfer and reconciliation can be skipped.
+  hashmap<FrameworkID, uint64_t> digests;
+
+  // Summary of the states of this slave's tasks, including the
+  // completed tasks retained by the registered frameworks. This is
+  // maintained incrementally so that /state-summary does not need
+  // to walk all tasks.
+  TaskStateSummary taskSummary;
+
+  // Number of active or retained completed tasks on this slave per
+  // framework. NOTE: Unlike 'tasks' above this may reference
+  // frameworks that no longer have active tasks on this slave.
+  hashmap<FrameworkID, size_t> frameworkTaskCounts;
+
   // Active offers on this slave.
   hashset<Offer*> offers;
 
@@ -425,6 +587,15 @@ public:
       const FrameworkID& frameworkId,
       const TaskID& taskId);
 
+  // Handles a batch of kills sent by the scheduler driver,
+  // equivalent to receiving one kill task message per entry. Kills
+  // destined for the same agent are grouped into a single outbound
+  // message.
+  void killTasks(
+      const process::UPID& from,
+      const FrameworkID& frameworkId,
+      const std::vector<TaskID>& taskIds);
+
   void statusUpdateAcknowledgement(
       const process::UPID& from,
       const SlaveID& slaveId,
@@ -432,6 +603,15 @@ public:
       const TaskID& taskId,
       const std::string& uuid);
 
+  // Handles a batch of coalesced acknowledgements sent by the
+  // scheduler driver, equivalent to receiving one acknowledgement
+  // message per entry.
+  void statusUpdateAcknowledgements(
+      const process::UPID& from,
+      const FrameworkID& frameworkId,
+      const std::vector<StatusUpdateAcknowledgementMessage>&
+        acknowledgements);
+
   void schedulerMessage(
       const process::UPID& from,
       const SlaveID& slaveId,
@@ -446,20 +626,27 @@ public:
       const ExecutorID& executorId,
       const std::string& data);
 
+  // Handles a batch of coalesced executor messages, validating it
+  // once and forwarding it wholesale to the scheduler driver (or
+  // unpacked, for HTTP frameworks).
+  void executorMessages(
+      const process::UPID& from,
+      const ExecutorToFrameworkMessages& messages);
+
   void registerSlave(
       const process::UPID& from,
       const SlaveInfo& slaveInfo,
       const std::vector<Resource>& checkpointedResources,
       const std::string& version);
 
+  // NOTE: This takes the protobuf message itself (rather than the
+  // unpacked fields) so that the heavy repeated task and executor
+  // fields are only copied out once we know the re-registration will
+  // actually be processed; duplicates that are ignored (e.g., during
+  // a failover storm) never pay for the copies.
   void reregisterSlave(
       const process::UPID& from,
-      const SlaveInfo& slaveInfo,
-      const std::vector<Resource>& checkpointedResources,
-      const std::vector<ExecutorInfo>& executorInfos,
-      const std::vector<Task>& tasks,
-      const std::vector<Archive::Framework>& completedFrameworks,
-      const std::string& version);
+      const ReregisterSlaveMessage& message);
 
   void unregisterSlave(
       const process::UPID& from,
@@ -489,6 +676,14 @@ public:
       const MachineID& machineId,
       const Option<Unavailability>& unavailability);
 
+  // Bulk overload, used when applying a maintenance schedule: all
+  // offer and inverse offer rescinds are batched and the allocator
+  // is informed of all unavailabilities in a single call, so that it
+  // performs one allocation pass over the affected slaves rather
+  // than one full pass per machine.
+  void updateUnavailability(
+      const hashmap<MachineID, Option<Unavailability>>& updates);
+
   void shutdownSlave(
       const SlaveID& slaveId,
       const std::string& message);
@@ -504,9 +699,11 @@ public:
       const FrameworkID& frameworkId,
       const process::Time& reregisteredTime);
 
+  // NOTE: Takes 'resources' by value so that the allocator can move
+  // the offered resources into the dispatch rather than copying them.
   void offer(
       const FrameworkID& framework,
-      const hashmap<SlaveID, Resources>& resources);
+      hashmap<SlaveID, Resources> resources);
 
   void inverseOffer(
       const FrameworkID& framework,
@@ -524,6 +721,13 @@ public:
   // Made public for testing purposes.
   process::Future<Nothing> _recover(const Registry& registry);
 
+  // Continuation of reregisterSlave() for slaves unknown to this
+  // master: readmits the slave through the registrar. Invoked once
+  // the re-registration rate limiter (if any) has granted a permit.
+  Nothing readmitSlave(
+      const ReregisterSlaveMessage& message,
+      const process::UPID& pid);
+
   // Continuation of reregisterSlave().
   // Made public for testing purposes.
   // TODO(vinod): Instead of doing this create and use a
@@ -574,6 +778,12 @@ protected:
       const Option<std::string>& principal,
       uint64_t capacity);
 
+  // Periodically adapts the effective framework rate limits to the
+  // master's current load so that frameworks get full throughput
+  // while the master has headroom and the configured (worst case)
+  // limits are only enforced as the master approaches saturation.
+  void adaptRateLimits();
+
   // Recovers state from the registrar.
   process::Future<Nothing> recover();
   void recoveredSlavesTimeout(const Registry& registry);
@@ -585,13 +795,14 @@ protected:
       const std::string& version,
       const process::Future<bool>& admit);
 
-  void __reregisterSlave(
-      Slave* slave,
-      const std::vector<Task>& tasks);
+  void __reregisterSlave(Slave* slave);
 
-  // 'authenticate' is the future returned by the authenticator.
+  // 'authenticate' is the future returned by the authenticator and
+  // 'start' is when the authentication request was received, used to
+  // record the authentication latency.
   void _authenticate(
       const process::UPID& pid,
+      const process::Time& start,
       const process::Future<Option<std::string>>& authenticate);
 
   void authenticationTimeout(process::Future<Option<std::string>> future);
@@ -608,6 +819,16 @@ protected:
       Framework* framework,
       const std::vector<TaskStatus>& statuses);
 
+  // Sends an explicit reconciliation response for each of the given
+  // statuses starting at 'index'. At most RECONCILIATION_BATCH_SIZE
+  // responses are generated per invocation and the remainder is
+  // dispatched back to self(), so that a framework reconciling a very
+  // large number of tasks does not starve other master work.
+  void __reconcileTasks(
+      const FrameworkID& frameworkId,
+      const process::Owned<std::vector<TaskStatus>>& statuses,
+      size_t index);
+
   // Handles a known re-registering slave by reconciling the master's
   // view of the slave's tasks and executors.
   void reconcile(
@@ -636,6 +857,17 @@ protected:
   // executors and recover the resources.
   void removeFramework(Slave* slave, Framework* framework);
 
+  // Updates the aggregate resources of the given role after the used
+  // or offered resources of one of its frameworks changed. Keeping
+  // these aggregates incrementally makes rendering '/roles' O(roles)
+  // instead of O(frameworks). Called by the Framework resource
+  // accounting methods; a no-op if the role is not active (the
+  // aggregate is then captured when the role becomes active).
+  void updateRoleResources(
+      const std::string& role,
+      const Resources& subtracted,
+      const Resources& added);
+
   void disconnect(Framework* framework);
   void deactivate(Framework* framework);
 
@@ -660,13 +892,25 @@ protected:
       const std::string& message,
       Option<process::metrics::Counter> reason = None());
 
+  // NOTE: The TASK_LOST updates are grouped per framework so that
+  // each framework is looked up once and its updates can be
+  // forwarded in batches.
   void _removeSlave(
       const SlaveInfo& slaveInfo,
-      const std::vector<StatusUpdate>& updates,
+      const hashmap<FrameworkID, std::vector<StatusUpdate>>& updates,
       const process::Future<bool>& removed,
       const std::string& message,
       Option<process::metrics::Counter> reason = None());
 
+  // Forwards a batch of at most 'SLAVE_REMOVAL_BATCH_SIZE' TASK_LOST
+  // updates for a removed slave to the framework, dispatching back
+  // to the master for the next batch so that dense slaves (and
+  // correlated slave failures) do not block the master actor.
+  void __removeSlave(
+      const FrameworkID& frameworkId,
+      const process::Owned<std::vector<StatusUpdate>>& updates,
+      size_t index);
+
   // Validates that the framework is authenticated, if required.
   Option<Error> validateFrameworkAuthentication(
       const FrameworkInfo& frameworkInfo,
@@ -786,6 +1030,17 @@ protected:
       const FrameworkID& frameworkId,
       const ExecutorID& executorId);
 
+  // Forwards a resource recovery to the allocator, either right away
+  // or, while `recoveries` is set, into the batch accumulated there.
+  // Paths that produce many recoveries at once (e.g., removing a
+  // framework with many tasks) batch them into a single allocator
+  // call; see `removeFramework`.
+  void recoverResources(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources,
+      const Option<Filters>& filters);
+
   // Updates the allocator and updates the slave's resources by
   // applying the given operation. It also sends a
   // 'CheckpointResourcesMessage' to the slave with the updated
@@ -816,6 +1071,14 @@ protected:
   // Remove an offer and optionally rescind the offer as well.
   void removeOffer(Offer* offer, bool rescind = false);
 
+  // Sends the rescind messages accumulated in `rescinds` to the
+  // framework in batches, interleaved with the rest of the master's
+  // work. See `deactivate(Framework*)`.
+  void _rescindOffers(
+      const FrameworkID& frameworkId,
+      const process::Owned<std::vector<OfferID>>& offerIds,
+      size_t index);
+
   // Remove an inverse offer after specified timeout
   void inverseOfferTimeout(const OfferID& inverseOfferId);
 
@@ -833,6 +1096,10 @@ protected:
 private:
   void _apply(Slave* slave, const Offer::Operation& operation);
 
+  // Dispatched from 'Master::Http::state' to answer all batched
+  // '/state' requests; see 'Master::Http::processStateRequestsBatch'.
+  void processStateRequestsBatch();
+
   void drop(
       const process::UPID& from,
       const scheduler::Call& call,
@@ -868,9 +1135,12 @@ private:
 
   void teardown(Framework* framework);
 
+  // NOTE: Takes 'accept' by value since task template references in
+  // LAUNCH operations are expanded in place before authorization and
+  // validation.
   void accept(
       Framework* framework,
-      const scheduler::Call::Accept& accept);
+      scheduler::Call::Accept accept);
 
   void _accept(
     const FrameworkID& frameworkId,
@@ -889,6 +1159,23 @@ private:
       Framework* framework,
       const scheduler::Call::Kill& kill);
 
+  // Continuation of 'kill()'. If 'batch' is not NULL, a kill that
+  // would result in a message to a connected agent is accumulated
+  // there instead of being sent, so that callers processing many
+  // kills can group the sends per agent (see 'killTasks').
+  void _kill(
+      Framework* framework,
+      const scheduler::Call::Kill& kill,
+      hashmap<Slave*, std::vector<TaskID>>* batch);
+
+  // Sends the shutdown framework message to the given agents in
+  // bounded batches, yielding the actor in between, so that framework
+  // teardown on a large cluster does not stall the master.
+  void sendShutdownFrameworkMessages(
+      const FrameworkID& frameworkId,
+      const std::vector<process::UPID>& pids,
+      size_t index);
+
   void shutdown(
       Framework* framework,
       const scheduler::Call::Shutdown& shutdown);
@@ -1023,7 +1310,10 @@ private:
   class Http
   {
   public:
-    explicit Http(Master* _master) : master(_master), quotaHandler(_master) {}
+    explicit Http(Master* _master)
+      : master(_master),
+        lastSchedulerCallParse(Nothing()),
+        quotaHandler(_master) {}
 
     // Logs the request, route handlers can compose this with the
     // desired request handler to get consistent request logging.
@@ -1033,6 +1323,17 @@ private:
     process::Future<process::http::Response> scheduler(
         const process::http::Request& request) const;
 
+    // Continuation of 'scheduler()': processes a call that has been
+    // parsed and validated on a worker thread. Runs as a dispatch on
+    // the master actor.
+    process::Future<process::http::Response> _scheduler(
+        const process::http::Request& request,
+        const Try<scheduler::Call>& call) const;
+
+    // /master/allocator
+    process::Future<process::http::Response> allocator(
+        const process::http::Request& request) const;
+
     // /master/create-volumes
     process::Future<process::http::Response> createVolumes(
         const process::http::Request& request,
@@ -1085,6 +1386,17 @@ private:
     process::Future<process::http::Response> state(
         const process::http::Request& request) const;
 
+    // Answers all currently batched '/state' requests from a single
+    // rendering of the master state. Runs as a dispatch on the
+    // master so that requests queued behind scheduling-critical
+    // messages join the batch instead of each triggering their own
+    // walk over the cluster state.
+    void processStateRequestsBatch() const;
+
+    // /master/state.recordio
+    process::Future<process::http::Response> stateRecordio(
+        const process::http::Request& request) const;
+
     // /master/state-summary
     process::Future<process::http::Response> stateSummary(
         const process::http::Request& request) const;
@@ -1120,6 +1432,7 @@ private:
         const Option<std::string>& principal) const;
 
     static std::string SCHEDULER_HELP();
+    static std::string ALLOCATOR_HELP();
     static std::string FLAGS_HELP();
     static std::string FRAMEWORKS();
     static std::string HEALTH_HELP();
@@ -1129,6 +1442,7 @@ private:
     static std::string TEARDOWN_HELP();
     static std::string SLAVES_HELP();
     static std::string STATE_HELP();
+    static std::string STATE_RECORDIO_HELP();
     static std::string STATESUMMARY_HELP();
     static std::string TASKS_HELP();
     static std::string MAINTENANCE_SCHEDULE_HELP();
@@ -1170,8 +1484,72 @@ private:
         Resources required,
         const Offer::Operation& operation) const;
 
+    // Serves a read-only endpoint on a non-leading master from a
+    // cached copy of the leading master's response; see the
+    // --standby_state_cache flag. 'endpoint' is the path relative to
+    // the master process, e.g., 'state'.
+    process::Future<process::http::Response> standby(
+        const std::string& endpoint,
+        const process::http::Request& request) const;
+
     Master* master;
 
+    // Cached rendering of the '/state' response along with the value
+    // of 'Master::stateVersion' at the time it was rendered. The
+    // cache is served as long as the version still matches and is
+    // re-rendered otherwise.
+    struct StateCache
+    {
+      size_t version;
+      std::string body;
+    };
+
+    // NOTE: 'mutable' since the route handlers are const.
+    mutable Option<StateCache> stateCache;
+
+    // Cached rendering of the '/roles' response, including the
+    // hierarchical subtree rollups, keyed by 'Master::stateVersion'
+    // in the same way as 'stateCache'.
+    mutable Option<StateCache> rolesCache;
+
+    // Cached rendering of the '/state.recordio' binary snapshot,
+    // keyed by 'Master::stateVersion' in the same way as
+    // 'stateCache'.
+    mutable Option<StateCache> stateRecordioCache;
+
+    // A '/state' request that has been queued for batched
+    // processing; see 'state()'.
+    struct BatchedStateRequest
+    {
+      Option<std::string> jsonp;
+      process::Owned<process::Promise<process::http::Response>> promise;
+    };
+
+    mutable std::vector<BatchedStateRequest> batchedStateRequests;
+
+    // Copies of the leading master's responses served by this master
+    // while it is a standby, keyed by endpoint and query; see
+    // 'standby()'.
+    struct StandbyCacheEntry
+    {
+      process::Time time;
+      process::http::Response response;
+    };
+
+    mutable hashmap<std::string, StandbyCacheEntry> standbyCache;
+
+    // Fetches from the leading master that are still in flight;
+    // requests for an endpoint that is already being fetched join
+    // the existing fetch instead of issuing another one.
+    mutable hashmap<std::string, process::Future<process::http::Response>>
+      standbyFetches;
+
+    // Completion of the parse of the most recently received
+    // scheduler call; used to keep the master side processing of
+    // calls in arrival order. See 'scheduler()'.
+    // NOTE: 'mutable' since the route handlers are const.
+    mutable process::Future<Nothing> lastSchedulerCallParse;
+
     // NOTE: The quota specific pieces of the Operator API are factored
     // out into this separate class.
     QuotaHandler quotaHandler;
@@ -1199,10 +1577,29 @@ private:
 
   mesos::master::allocator::Allocator* allocator;
   WhitelistWatcher* whitelistWatcher;
+
+  // Serves the '/ready' endpoint outside of the master actor, backed
+  // by atomic flags the master updates as it is elected and recovers
+  // the registry, so that load balancers can probe readiness at high
+  // frequency without adding load to the master.
+  ReadinessProcess* readiness;
   Registrar* registrar;
   Repairer* repairer;
   Files* files;
 
+  // When set, resource recoveries are being accumulated for a single
+  // bulk `Allocator::recoverResources` call instead of being
+  // forwarded to the allocator one at a time. See `recoverResources`.
+  Option<std::vector<mesos::master::allocator::ResourceRecovery>> recoveries;
+
+  // When set, `removeOffer(offer, true)` accumulates the offer ids
+  // here instead of sending a rescind message per offer, and skips
+  // the per-offer recalculation of the framework's oldest held offer.
+  // The path that set it is responsible for fanning the messages out
+  // (see `_rescindOffers`) and for issuing a single
+  // `Allocator::updateOfferHolding` once the batch is removed.
+  Option<std::vector<OfferID>> rescinds;
+
   MasterContender* contender;
   MasterDetector* detector;
 
@@ -1275,11 +1672,30 @@ private:
         return pids.get(pid).getOrElse(NULL);
       }
 
+      // Returns the slaves that have the given attribute, keyed by
+      // its text form (e.g., "rack=r1", see the `Attribute` output
+      // operator). This lets maintenance tooling and allocation
+      // constraint filtering map an attribute to the matching
+      // slaves without scanning the whole table.
+      hashset<SlaveID> get(const Attribute& attribute) const
+      {
+        return get(stringify(attribute));
+      }
+
+      hashset<SlaveID> get(const std::string& attribute) const
+      {
+        return attributes.get(attribute).getOrElse(hashset<SlaveID>());
+      }
+
       void put(Slave* slave)
       {
         CHECK_NOTNULL(slave);
         ids[slave->id] = slave;
         pids[slave->pid] = slave;
+
+        foreach (const Attribute& attribute, slave->info.attributes()) {
+          attributes[stringify(attribute)].insert(slave->id);
+        }
       }
 
       void remove(Slave* slave)
@@ -1287,12 +1703,22 @@ private:
         CHECK_NOTNULL(slave);
         ids.erase(slave->id);
         pids.erase(slave->pid);
+
+        foreach (const Attribute& attribute, slave->info.attributes()) {
+          const std::string key = stringify(attribute);
+
+          attributes[key].erase(slave->id);
+          if (attributes[key].empty()) {
+            attributes.erase(key);
+          }
+        }
       }
 
       void clear()
       {
         ids.clear();
         pids.clear();
+        attributes.clear();
       }
 
       size_t size() const { return ids.size(); }
@@ -1309,6 +1735,11 @@ private:
     private:
       hashmap<SlaveID, Slave*> ids;
       hashmap<process::UPID, Slave*> pids;
+
+      // Slaves indexed by the text form of their attributes,
+      // maintained on (re)registration and removal (see 'put' and
+      // 'remove').
+      hashmap<std::string, hashset<SlaveID>> attributes;
     } registered;
 
     // Slaves that are in the process of being removed from the
@@ -1332,6 +1763,13 @@ private:
     // a wrapper around libprocess process which is thread safe.
     Option<std::shared_ptr<process::RateLimiter>> limiter;
 
+    // This rate limiter is used to spread out the re-registration
+    // storm that follows a master failover, so that the task and
+    // executor state embedded in the re-registration messages is
+    // applied at a bounded rate rather than inline as fast as the
+    // messages arrive.
+    Option<std::shared_ptr<process::RateLimiter>> reregistrationLimiter;
+
     bool transitioning(const Option<SlaveID>& slaveId)
     {
       if (slaveId.isSome()) {
@@ -1378,6 +1816,22 @@ private:
   hashmap<OfferID, Offer*> offers;
   hashmap<OfferID, process::Timer> offerTimers;
 
+  // When each outstanding offer was made, used to inform the
+  // allocator about frameworks holding on to offers. Only populated
+  // when --offer_hoarding_threshold is set.
+  hashmap<OfferID, process::Time> offerTimes;
+
+  // Rescinded offers, mapped to the offer epoch at which the rescind
+  // occurred. Since the resources are recovered for re-allocation as
+  // soon as we decide to rescind, an ACCEPT of a rescinded offer may
+  // still be in flight from the framework; this (bounded) cache lets
+  // us reconcile such late ACCEPTs as expected races rather than
+  // treating them as invalid calls.
+  Cache<OfferID, uint64_t> rescindedOffers;
+
+  // Incremented on every rescind; see 'rescindedOffers'.
+  uint64_t offerEpoch;
+
   hashmap<OfferID, InverseOffer*> inverseOffers;
   hashmap<OfferID, process::Timer> inverseOfferTimers;
 
@@ -1477,6 +1931,12 @@ private:
 
   Option<process::Time> electedTime; // Time when this master is elected.
 
+  // Version of the cluster state exposed through the read-only HTTP
+  // endpoints. Bumped whenever frameworks, slaves, tasks, executors
+  // or offers change, so that cached endpoint responses can be
+  // invalidated. See 'Master::Http::state'.
+  size_t stateVersion;
+
   // Validates the framework including authorization.
   // Returns None if the framework is valid.
   // Returns Error if the framework is invalid.
@@ -1610,6 +2070,15 @@ struct HttpConnection
   template <typename Message>
   bool send(const Message& message)
   {
+    // Close the connection if the consumer is not keeping up: once
+    // the backlog of encoded events exceeds the limit, it is better
+    // to disconnect the scheduler (prompting it to re-subscribe)
+    // than to buffer an ever larger backlog in the master's memory.
+    if (writer.outstanding() > MAX_EVENT_STREAM_BACKLOG.bytes()) {
+      close();
+      return false;
+    }
+
     // We need to evolve the internal 'message' into a
     // 'v1::scheduler::Event'.
     return writer.write(encoder.encode(evolve(message)));
@@ -1689,7 +2158,9 @@ struct Framework
       active(true),
       registeredTime(time),
       reregisteredTime(time),
-      completedTasks(masterFlags.max_completed_tasks_per_framework) {}
+      taskIds(65536),
+      completedTasks(masterFlags.max_completed_tasks_per_framework),
+      metrics(_info.id()) {}
 
   Framework(Master* const _master,
             const Flags& masterFlags,
@@ -1703,7 +2174,9 @@ struct Framework
       active(true),
       registeredTime(time),
       reregisteredTime(time),
-      completedTasks(masterFlags.max_completed_tasks_per_framework) {}
+      taskIds(65536),
+      completedTasks(masterFlags.max_completed_tasks_per_framework),
+      metrics(_info.id()) {}
 
   ~Framework()
   {
@@ -1721,6 +2194,15 @@ struct Framework
     return NULL;
   }
 
+  // Returns whether the framework currently has a task with this ID.
+  // Definite misses (the common case when validating a launch) cost
+  // a single probe in 'taskIds'.
+  bool hasTask(const TaskID& taskId) const
+  {
+    return taskIds.possiblyContains(std::hash<TaskID>()(taskId)) &&
+      tasks.contains(taskId);
+  }
+
   void addTask(Task* task)
   {
     CHECK(!tasks.contains(task->task_id()))
@@ -1728,11 +2210,17 @@ struct Framework
       << " of framework " << task->framework_id();
 
     tasks[task->task_id()] = task;
+    taskIds.add(std::hash<TaskID>()(task->task_id()));
 
     if (!protobuf::isTerminalState(task->state())) {
       totalUsedResources += task->resources();
       usedResources[task->slave_id()] += task->resources();
+      master->updateRoleResources(
+          info.role(), Resources(), task->resources());
     }
+
+    taskSummary.add(task->state());
+    ++slaveTaskCounts[task->slave_id()];
   }
 
   // Notification of task termination, for resource accounting.
@@ -1751,6 +2239,8 @@ struct Framework
     if (usedResources[task->slave_id()].empty()) {
       usedResources.erase(task->slave_id());
     }
+
+    master->updateRoleResources(info.role(), task->resources(), Resources());
   }
 
   // Sends a message to the connected framework.
@@ -1762,6 +2252,8 @@ struct Framework
                    << " framework " << *this;
     }
 
+    metrics.event_stream_bytes += message.ByteSize();
+
     if (http.isSome()) {
       if (!http.get().send(message)) {
         LOG(WARNING) << "Unable to send event to framework " << *this << ":"
@@ -1776,7 +2268,55 @@ struct Framework
   void addCompletedTask(const Task& task)
   {
     // TODO(adam-mesos): Check if completed task already exists.
-    completedTasks.push_back(std::shared_ptr<Task>(new Task(task)));
+
+    // The circular buffer evicts the oldest completed task once
+    // full, at which point it falls out of the task state summaries.
+    if (completedTasks.full()) {
+      untrackCompletedTask(*completedTasks.front());
+    }
+
+    std::shared_ptr<Task> completed(new Task(task));
+
+    // The endpoints only expose a few fields of the retained status
+    // history, so drop the unbounded 'data' and 'message' fields
+    // (executors can attach arbitrarily large payloads to a status
+    // update). With large retention settings these otherwise
+    // dominate the memory footprint of the completed task history.
+    foreach (TaskStatus& status, *completed->mutable_statuses()) {
+      status.clear_data();
+      status.clear_message();
+    }
+
+    completedTasks.push_back(completed);
+
+    trackCompletedTask(task);
+  }
+
+  // Tracks / untracks a retained completed task in the incremental
+  // task state summaries of this framework and of the slave that the
+  // task ran on (which may no longer be registered).
+  void trackCompletedTask(const Task& task)
+  {
+    taskSummary.add(task.state());
+    ++slaveTaskCounts[task.slave_id()];
+
+    Slave* slave = master->slaves.registered.get(task.slave_id());
+    if (slave != NULL) {
+      slave->addCompletedTask(task);
+    }
+  }
+
+  void untrackCompletedTask(const Task& task)
+  {
+    taskSummary.subtract(task.state());
+    if (--slaveTaskCounts[task.slave_id()] == 0) {
+      slaveTaskCounts.erase(task.slave_id());
+    }
+
+    Slave* slave = master->slaves.registered.get(task.slave_id());
+    if (slave != NULL) {
+      slave->removeCompletedTask(task);
+    }
   }
 
   void removeTask(Task* task)
@@ -1791,11 +2331,20 @@ struct Framework
       if (usedResources[task->slave_id()].empty()) {
         usedResources.erase(task->slave_id());
       }
+
+      master->updateRoleResources(
+          info.role(), task->resources(), Resources());
+    }
+
+    taskSummary.subtract(task->state());
+    if (--slaveTaskCounts[task->slave_id()] == 0) {
+      slaveTaskCounts.erase(task->slave_id());
     }
 
     addCompletedTask(*task);
 
     tasks.erase(task->task_id());
+    taskIds.remove(std::hash<TaskID>()(task->task_id()));
   }
 
   void addOffer(Offer* offer)
@@ -1804,6 +2353,7 @@ struct Framework
     offers.insert(offer);
     totalOfferedResources += offer->resources();
     offeredResources[offer->slave_id()] += offer->resources();
+    master->updateRoleResources(info.role(), Resources(), offer->resources());
   }
 
   void removeOffer(Offer* offer)
@@ -1817,6 +2367,8 @@ struct Framework
       offeredResources.erase(offer->slave_id());
     }
 
+    master->updateRoleResources(info.role(), offer->resources(), Resources());
+
     offers.erase(offer);
   }
 
@@ -1849,9 +2401,12 @@ struct Framework
       << "Duplicate executor '" << executorInfo.executor_id()
       << "' on slave " << slaveId;
 
-    executors[slaveId][executorInfo.executor_id()] = executorInfo;
+    executors[slaveId][executorInfo.executor_id()] =
+      internExecutorInfo(executorInfo);
     totalUsedResources += executorInfo.resources();
     usedResources[slaveId] += executorInfo.resources();
+    master->updateRoleResources(
+        info.role(), Resources(), executorInfo.resources());
   }
 
   void removeExecutor(const SlaveID& slaveId,
@@ -1862,12 +2417,15 @@ struct Framework
       << "' of framework " << id()
       << " of slave " << slaveId;
 
-    totalUsedResources -= executors[slaveId][executorId].resources();
-    usedResources[slaveId] -= executors[slaveId][executorId].resources();
+    totalUsedResources -= executors[slaveId][executorId]->resources();
+    usedResources[slaveId] -= executors[slaveId][executorId]->resources();
     if (usedResources[slaveId].empty()) {
       usedResources.erase(slaveId);
     }
 
+    master->updateRoleResources(
+        info.role(), executors[slaveId][executorId]->resources(), Resources());
+
     executors[slaveId].erase(executorId);
     if (executors[slaveId].empty()) {
       executors.erase(slaveId);
@@ -2009,6 +2567,67 @@ struct Framework
     process::spawn(heartbeater.get().get());
   }
 
+  // Per-framework metrics used to attribute master load to
+  // individual frameworks. These are maintained inline with cheap
+  // atomic increments (see Counter) and exposed both via the metrics
+  // endpoint (with names prefixed by "master/frameworks/<id>/") and
+  // via the '/frameworks' and '/state' endpoints. NOTE: Unlike the
+  // per-principal metrics in master/metrics.hpp, these are scoped to
+  // a single framework and do not survive framework removal.
+  struct Metrics
+  {
+    explicit Metrics(const FrameworkID& frameworkId)
+      : messages_received(
+            "master/frameworks/" + frameworkId.value() +
+            "/messages_received"),
+        tasks_launched(
+            "master/frameworks/" + frameworkId.value() +
+            "/tasks_launched"),
+        offers_declined(
+            "master/frameworks/" + frameworkId.value() +
+            "/offers_declined"),
+        reconciliations(
+            "master/frameworks/" + frameworkId.value() +
+            "/reconciliations"),
+        event_stream_bytes(
+            "master/frameworks/" + frameworkId.value() +
+            "/event_stream_bytes")
+    {
+      process::metrics::add(messages_received);
+      process::metrics::add(tasks_launched);
+      process::metrics::add(offers_declined);
+      process::metrics::add(reconciliations);
+      process::metrics::add(event_stream_bytes);
+    }
+
+    ~Metrics()
+    {
+      process::metrics::remove(messages_received);
+      process::metrics::remove(tasks_launched);
+      process::metrics::remove(offers_declined);
+      process::metrics::remove(reconciliations);
+      process::metrics::remove(event_stream_bytes);
+    }
+
+    // Scheduler messages / calls received for this framework
+    // (after the framework has been resolved, before processing).
+    process::metrics::Counter messages_received;
+
+    // Tasks launched on behalf of this framework.
+    process::metrics::Counter tasks_launched;
+
+    // Offers explicitly declined by this framework (both via
+    // DECLINE calls and via ACCEPT calls without launch tasks).
+    process::metrics::Counter offers_declined;
+
+    // Task state reconciliation requests from this framework.
+    process::metrics::Counter reconciliations;
+
+    // Bytes serialized into this framework's event stream (both
+    // the HTTP event stream and driver-based message passing).
+    process::metrics::Counter event_stream_bytes;
+  };
+
   Master* const master;
 
   FrameworkInfo info;
@@ -2036,18 +2655,45 @@ struct Framework
   // being authorized.
   hashmap<TaskID, TaskInfo> pendingTasks;
 
+  // Task templates registered by the framework, keyed by template
+  // id. Tasks referencing a template carry only their per-instance
+  // fields and are expanded in 'Master::accept'. The stored
+  // templates exclude per-instance fields (resources in particular).
+  hashmap<std::string, TaskInfo> taskTemplates;
+
   hashmap<TaskID, Task*> tasks;
 
+  // Fronts 'tasks' for the common "no such task" case (notably the
+  // duplicate task ID validation performed on every launch): a
+  // single filter probe answers definite misses and only possible
+  // hits consult the map. Updated in 'addTask' / 'removeTask'.
+  ExistenceFilter taskIds;
+
   // NOTE: We use a shared pointer for Task because clang doesn't like
   // Boost's implementation of circular_buffer with Task (Boost
   // attempts to do some memset's which are unsafe).
   boost::circular_buffer<std::shared_ptr<Task>> completedTasks;
 
+  // Summary of the states of this framework's active and retained
+  // completed tasks, maintained incrementally so that /state-summary
+  // does not need to walk all tasks. NOTE: Pending tasks are not
+  // included; they are summarized per request since there are
+  // typically few of them.
+  TaskStateSummary taskSummary;
+
+  // Number of active or retained completed tasks of this framework
+  // per slave. NOTE: This may reference slaves that are no longer
+  // registered (from completed tasks).
+  hashmap<SlaveID, size_t> slaveTaskCounts;
+
   hashset<Offer*> offers; // Active offers for framework.
 
   hashset<InverseOffer*> inverseOffers; // Active inverse offers for framework.
 
-  hashmap<SlaveID, hashmap<ExecutorID, ExecutorInfo>> executors;
+  // The infos are interned (see 'internExecutorInfo') and must not
+  // be mutated.
+  hashmap<SlaveID,
+          hashmap<ExecutorID, std::shared_ptr<const ExecutorInfo>>> executors;
 
   // NOTE: For the used and offered resources below, we keep the
   // total as well as partitioned by SlaveID.
@@ -2082,6 +2728,8 @@ struct Framework
   // This is only set for HTTP frameworks.
   Option<process::Owned<Heartbeater>> heartbeater;
 
+  Metrics metrics;
+
 private:
   Framework(const Framework&);              // No copying.
   Framework& operator=(const Framework&); // No assigning.
@@ -2110,22 +2758,31 @@ struct Role
   void addFramework(Framework* framework)
   {
     frameworks[framework->id()] = framework;
+    allocated += framework->totalUsedResources;
+    allocated += framework->totalOfferedResources;
   }
 
   void removeFramework(Framework* framework)
   {
     frameworks.erase(framework->id());
+    allocated -= framework->totalUsedResources;
+    allocated -= framework->totalOfferedResources;
   }
 
-  Resources resources() const
+  // Called via Master::updateRoleResources when the used or offered
+  // resources of a framework in this role change.
+  void update(const Resources& subtracted, const Resources& added)
   {
-    Resources resources;
-    foreachvalue (Framework* framework, frameworks) {
-      resources += framework->totalUsedResources;
-      resources += framework->totalOfferedResources;
-    }
+    allocated -= subtracted;
+    allocated += added;
+  }
 
-    return resources;
+  // The used and offered resources of the frameworks in this role,
+  // maintained incrementally so that rendering '/roles' does not
+  // need to walk the frameworks.
+  const Resources& resources() const
+  {
+    return allocated;
   }
 
   // NOTE: The dynamic role/quota relation is stored in and administrated
@@ -2136,6 +2793,9 @@ struct Role
   // quota first is intended to contain.
 
   hashmap<FrameworkID, Framework*> frameworks;
+
+private:
+  Resources allocated;
 };
 
 } // namespace master {
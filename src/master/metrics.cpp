@@ -19,6 +19,7 @@
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/timer.hpp>
 
 #include <stout/foreach.hpp>
 
@@ -134,6 +135,8 @@ Metrics::Metrics(const Master& master)
         "master/messages_update_slave"),
     messages_authenticate(
         "master/messages_authenticate"),
+    authentication_secs(
+        "master/authentication_secs"),
     valid_framework_to_executor_messages(
         "master/valid_framework_to_executor_messages"),
     invalid_framework_to_executor_messages(
@@ -152,6 +155,12 @@ Metrics::Metrics(const Master& master)
         "master/invalid_status_update_acknowledgements"),
     recovery_slave_removals(
         "master/recovery_slave_removals"),
+    failover_registry_recovery(
+        "master/failover_registry_recovery"),
+    failover_slave_reregistration(
+        "master/failover_slave_reregistration"),
+    failover_framework_reregistration(
+        "master/failover_framework_reregistration"),
     event_queue_messages(
         "master/event_queue_messages",
         defer(master, &Master::_event_queue_messages)),
@@ -234,6 +243,8 @@ Metrics::Metrics(const Master& master)
   // Messages from both schedulers and slaves.
   process::metrics::add(messages_authenticate);
 
+  process::metrics::add(authentication_secs);
+
   process::metrics::add(valid_framework_to_executor_messages);
   process::metrics::add(invalid_framework_to_executor_messages);
 
@@ -248,6 +259,10 @@ Metrics::Metrics(const Master& master)
 
   process::metrics::add(recovery_slave_removals);
 
+  process::metrics::add(failover_registry_recovery);
+  process::metrics::add(failover_slave_reregistration);
+  process::metrics::add(failover_framework_reregistration);
+
   process::metrics::add(event_queue_messages);
   process::metrics::add(event_queue_dispatches);
   process::metrics::add(event_queue_http_requests);
@@ -369,6 +384,7 @@ Metrics::~Metrics()
 
   // Messages from both schedulers and slaves.
   process::metrics::remove(messages_authenticate);
+  process::metrics::remove(authentication_secs);
 
   process::metrics::remove(valid_framework_to_executor_messages);
   process::metrics::remove(invalid_framework_to_executor_messages);
@@ -384,6 +400,10 @@ Metrics::~Metrics()
 
   process::metrics::remove(recovery_slave_removals);
 
+  process::metrics::remove(failover_registry_recovery);
+  process::metrics::remove(failover_slave_reregistration);
+  process::metrics::remove(failover_framework_reregistration);
+
   process::metrics::remove(event_queue_messages);
   process::metrics::remove(event_queue_dispatches);
   process::metrics::remove(event_queue_http_requests);
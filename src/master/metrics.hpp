@@ -22,8 +22,11 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
+#include <process/metrics/histogram.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/timer.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 
 #include "mesos/mesos.hpp"
@@ -146,6 +149,12 @@ struct Metrics
   // Messages from both schedulers and slaves.
   process::metrics::Counter messages_authenticate;
 
+  // Distribution of authentication latencies, measured from the
+  // receipt of the authentication request to the completion (or
+  // failure) of the authenticator session. Queuing delay during
+  // re-authentication storms shows up here.
+  process::metrics::Histogram authentication_secs;
+
   process::metrics::Counter valid_framework_to_executor_messages;
   process::metrics::Counter invalid_framework_to_executor_messages;
   process::metrics::Counter valid_executor_to_framework_messages;
@@ -160,6 +169,20 @@ struct Metrics
   // Recovery counters.
   process::metrics::Counter recovery_slave_removals;
 
+  // Failover phase timings. All three timers start when the elected
+  // master begins recovery:
+  //   'failover_registry_recovery' stops once the registry has been
+  //   recovered;
+  //   'failover_slave_reregistration' stops once every recovered
+  //   slave has either re-registered or been removed;
+  //   'failover_framework_reregistration' records the elapsed time
+  //   whenever a framework unknown to this master re-registers, so
+  //   its value reflects the most recent framework to reconnect
+  //   after the failover.
+  process::metrics::Timer<Milliseconds> failover_registry_recovery;
+  process::metrics::Timer<Milliseconds> failover_slave_reregistration;
+  process::metrics::Timer<Milliseconds> failover_framework_reregistration;
+
   // Process metrics.
   process::metrics::Gauge event_queue_messages;
   process::metrics::Gauge event_queue_dispatches;
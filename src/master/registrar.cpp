@@ -431,13 +431,41 @@ void RegistrarProcess::update()
     slaveIDs.insert(slave.info().id());
   }
 
+  // Whether any operation actually mutated the registry. If none of
+  // them did (e.g., a burst of re-admissions of already admitted
+  // agents during failover), there is nothing to persist: we can
+  // answer the operations without re-serializing and storing the
+  // entire registry, which on large clusters costs a full snapshot
+  // write through the replicated log.
+  bool mutated = false;
+
   foreach (Owned<Operation> operation, operations) {
-    // No need to process the result of the operation.
-    (*operation)(&registry, &slaveIDs, flags.registry_strict);
+    Try<bool> changed =
+      (*operation)(&registry, &slaveIDs, flags.registry_strict);
+
+    if (changed.isSome() && changed.get()) {
+      mutated = true;
+    }
   }
 
   LOG(INFO) << "Applied " << operations.size() << " operations in "
-            << stopwatch.elapsed() << "; attempting to update the 'registry'";
+            << stopwatch.elapsed() << "; "
+            << (mutated ? "attempting to update the 'registry'"
+                        : "registry unchanged, skipping the update");
+
+  if (!mutated) {
+    deque<Owned<Operation>> applied;
+    applied.swap(operations);
+
+    updating = false;
+
+    while (!applied.empty()) {
+      applied.front()->set();
+      applied.pop_front();
+    }
+
+    return;
+  }
 
   // Perform the store, and time the operation.
   metrics.state_store.start();
@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,6 +23,7 @@
 
 #include <mesos/type_utils.hpp>
 
+#include <stout/cache.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
@@ -302,7 +304,7 @@ Option<Error> validateUniqueTaskID(const TaskInfo& task, Framework*
 {
   const TaskID& taskId = task.task_id();
 
-  if (framework->tasks.contains(taskId)) {
+  if (framework->hasTask(taskId)) {
     return Error("Task has duplicate ID: " + taskId.value());
   }
 
@@ -349,20 +351,20 @@ Option<Error> validateExecutorInfo(
     }
 
     const ExecutorID& executorId = task.executor().executor_id();
-    Option<ExecutorInfo> executorInfo = None();
+    Option<std::shared_ptr<const ExecutorInfo>> executorInfo = None();
 
     if (slave->hasExecutor(framework->id(), executorId)) {
       executorInfo =
         slave->executors.get(framework->id()).get().get(executorId);
     }
 
-    if (executorInfo.isSome() && !(task.executor() == executorInfo.get())) {
+    if (executorInfo.isSome() && !(task.executor() == *executorInfo.get())) {
       return Error(
           "Task has invalid ExecutorInfo (existing ExecutorInfo"
           " with same ExecutorID is not compatible).\n"
           "------------------------------------------------------------\n"
           "Existing ExecutorInfo:\n" +
-          stringify(executorInfo.get()) + "\n"
+          stringify(*executorInfo.get()) + "\n"
           "------------------------------------------------------------\n"
           "Task's ExecutorInfo:\n" +
           stringify(task.executor()) + "\n"
@@ -479,6 +481,63 @@ Option<Error> validateResources(const TaskInfo& task)
   return None();
 }
 
+
+// Frameworks commonly launch large numbers of tasks with identical
+// resource specifications, in which case re-running the resource
+// validation (which walks every resource of the task and its
+// executor) for each task is wasted work: 'validateResources' is a
+// pure function of the task's resources. We therefore memoize its
+// results, keyed by the serialized resources. Per-instance checks
+// (task ID uniqueness, slave ID, offer matching) are never cached.
+//
+// NOTE: The cache is only accessed from the master actor, so no
+// synchronization is needed.
+static const size_t VALIDATION_CACHE_CAPACITY = 1024;
+
+
+// Returns a key that uniquely identifies the resources of the task
+// (and its executor, if present). Each serialized resource is length
+// prefixed so that concatenation cannot produce collisions.
+static string validateResourcesCacheKey(const TaskInfo& task)
+{
+  string key;
+
+  foreach (const Resource& resource, task.resources()) {
+    const string serialized = resource.SerializeAsString();
+    key += stringify(serialized.size()) + ":" + serialized;
+  }
+
+  if (task.has_executor()) {
+    key += "|";
+
+    foreach (const Resource& resource, task.executor().resources()) {
+      const string serialized = resource.SerializeAsString();
+      key += stringify(serialized.size()) + ":" + serialized;
+    }
+  }
+
+  return key;
+}
+
+
+// Memoizing wrapper around 'validateResources'.
+Option<Error> validateResourcesCached(const TaskInfo& task)
+{
+  static Cache<string, Option<Error>> cache(VALIDATION_CACHE_CAPACITY);
+
+  const string key = validateResourcesCacheKey(task);
+
+  Option<Option<Error>> cached = cache.get(key);
+  if (cached.isSome()) {
+    return cached.get();
+  }
+
+  Option<Error> result = validateResources(task);
+  cache.put(key, result);
+
+  return result;
+}
+
 } // namespace internal {
 
 
@@ -500,7 +559,7 @@ Option<Error> validate(
     lambda::bind(internal::validateUniqueTaskID, task, framework),
     lambda::bind(internal::validateSlaveID, task, slave),
     lambda::bind(internal::validateExecutorInfo, task, framework, slave),
-    lambda::bind(internal::validateResources, task),
+    lambda::bind(internal::validateResourcesCached, task),
     lambda::bind(
         internal::validateResourceUsage, task, framework, slave, offered)
   };
@@ -650,6 +709,65 @@ Option<Error> validate(
 
 namespace operation {
 
+// An index of persistent volumes by role and persistence ID,
+// providing O(1) lookups for volume operation validation. The
+// 'Resources' containment checks scan all resources linearly, which
+// adds up when an agent checkpoints hundreds of volumes.
+class PersistentVolumeIndex
+{
+public:
+  explicit PersistentVolumeIndex(const Resources& resources)
+  {
+    foreach (const Resource& resource, resources) {
+      if (Resources::isPersistentVolume(resource)) {
+        add(resource);
+      }
+    }
+  }
+
+  // Returns true if a volume with the same role and persistence ID
+  // is in the index, regardless of its size.
+  bool exists(const Resource& volume) const
+  {
+    auto ids = volumes.find(volume.role());
+
+    return ids != volumes.end() &&
+           ids->second.contains(volume.disk().persistence().id());
+  }
+
+  // Returns true if the index contains the given volume (i.e., a
+  // volume with the same role and persistence ID that is at least as
+  // large).
+  bool contains(const Resource& volume) const
+  {
+    auto ids = volumes.find(volume.role());
+
+    if (ids == volumes.end()) {
+      return false;
+    }
+
+    auto found = ids->second.find(volume.disk().persistence().id());
+
+    return found != ids->second.end() && found->second.contains(volume);
+  }
+
+  void add(const Resource& volume)
+  {
+    volumes[volume.role()][volume.disk().persistence().id()] += volume;
+  }
+
+  void subtract(const Resource& volume)
+  {
+    volumes[volume.role()][volume.disk().persistence().id()] -= volume;
+  }
+
+private:
+  // Maps role and persistence ID to the volume (as 'Resources' so
+  // that containment and arithmetic retain their usual semantics).
+  hashmap<string, hashmap<string, Resources>> volumes;
+};
+
+
 Option<Error> validate(
     const Offer::Operation::Reserve& reserve,
     const Option<string>& role,
@@ -765,11 +883,22 @@ Option<Error> validate(
     return Error("Not a persistent volume: " + error.get().message);
   }
 
-  error = resource::validateUniquePersistenceID(
-      checkpointedResources + create.volumes());
+  // Check that the persistence IDs of the new volumes are unique,
+  // both among themselves and against the checkpointed volumes.
+  // NOTE: We deliberately do not concatenate the checkpointed
+  // resources and the new volumes into a single 'Resources' here
+  // (appending resources one by one scans for mergeable entries, so
+  // the concatenation alone is quadratic in the number of volumes).
+  PersistentVolumeIndex index(checkpointedResources);
 
-  if (error.isSome()) {
-    return error;
+  foreach (const Resource& volume, create.volumes()) {
+    if (index.exists(volume)) {
+      return Error(
+          "Persistence ID '" + volume.disk().persistence().id() +
+          "' is not unique");
+    }
+
+    index.add(volume);
   }
 
   return None();
@@ -790,8 +919,19 @@ Option<Error> validate(
     return Error("Not a persistent volume: " + error.get().message);
   }
 
-  if (!checkpointedResources.contains(destroy.volumes())) {
-    return Error("Persistent volumes not found");
+  // Check that each volume exists, looking it up by role and
+  // persistence ID rather than scanning all checkpointed resources.
+  // Note that a destroyed volume gets subtracted from the index so
+  // that duplicate volumes in the operation are caught, mirroring
+  // the containment semantics of 'Resources'.
+  PersistentVolumeIndex index(checkpointedResources);
+
+  foreach (const Resource& volume, destroy.volumes()) {
+    if (!index.contains(volume)) {
+      return Error("Persistent volumes not found");
+    }
+
+    index.subtract(volume);
   }
 
   return None();
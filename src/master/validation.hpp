@@ -78,6 +78,13 @@ namespace internal {
 // Validates resources of the task and executor (if present).
 Option<Error> validateResources(const TaskInfo& task);
 
+
+// Memoizing wrapper around 'validateResources' which caches results
+// keyed by the serialized resources of the task and its executor, so
+// that frameworks launching many identically shaped tasks do not pay
+// for the full resource validation on every launch.
+Option<Error> validateResourcesCached(const TaskInfo& task);
+
 } // namespace internal {
 
 } // namespace task {
@@ -216,6 +216,9 @@ protected:
         &ExecutorToFrameworkMessage::executor_id,
         &ExecutorToFrameworkMessage::data);
 
+    install<ExecutorToFrameworkMessages>(
+        &SchedulerProcess::frameworkMessages);
+
     install<FrameworkErrorMessage>(
         &SchedulerProcess::error,
         &FrameworkErrorMessage::message);
@@ -946,19 +949,8 @@ protected:
         VLOG(2) << "Sending ACK for status update " << update
                 << " to " << master.get().pid();
 
-        Call call;
-
-        CHECK(framework.has_id());
-        call.mutable_framework_id()->CopyFrom(framework.id());
-        call.set_type(Call::ACKNOWLEDGE);
-
-        Call::Acknowledge* acknowledge = call.mutable_acknowledge();
-        acknowledge->mutable_slave_id()->CopyFrom(update.slave_id());
-        acknowledge->mutable_task_id()->CopyFrom(update.status().task_id());
-        acknowledge->set_uuid(update.uuid());
-
-        CHECK_SOME(master);
-        send(master.get().pid(), call);
+        enqueueAcknowledgement(
+            update.slave_id(), update.status().task_id(), update.uuid());
       }
     }
   }
@@ -1063,6 +1055,31 @@ protected:
     VLOG(1) << "Scheduler::frameworkMessage took " << stopwatch.elapsed();
   }
 
+  void frameworkMessages(const ExecutorToFrameworkMessages& messages)
+  {
+    if (!running.load()) {
+      VLOG(1)
+        << "Ignoring framework messages because the driver is not running!";
+      return;
+    }
+
+    VLOG(2) << "Received a batch of " << messages.data().size()
+            << " framework messages";
+
+    Stopwatch stopwatch;
+    if (FLAGS_v >= 1) {
+      stopwatch.start();
+    }
+
+    foreach (const string& data, messages.data()) {
+      scheduler->frameworkMessage(
+          driver, messages.executor_id(), messages.slave_id(), data);
+    }
+
+    VLOG(1) << "Scheduler::frameworkMessage took " << stopwatch.elapsed()
+            << " for " << messages.data().size() << " messages";
+  }
+
   void error(const string& message)
   {
     if (!running.load()) {
@@ -1154,6 +1171,31 @@ protected:
     send(master.get().pid(), call);
   }
 
+  void killTasks(const vector<TaskID>& taskIds)
+  {
+    if (!connected) {
+      VLOG(1) << "Ignoring kill tasks message as master is disconnected";
+      return;
+    }
+
+    // NOTE: Unlike 'killTask' this does not go through a scheduler
+    // Call since a Call can only carry a single kill. Instead the
+    // kills are shipped to the master as one bulk message, which the
+    // master processes in a single batch and fans out with one
+    // message per agent.
+    KillTasksMessage message;
+
+    CHECK(framework.has_id());
+    message.mutable_framework_id()->CopyFrom(framework.id());
+
+    foreach (const TaskID& taskId, taskIds) {
+      message.add_task_ids()->CopyFrom(taskId);
+    }
+
+    CHECK_SOME(master);
+    send(master.get().pid(), message);
+  }
+
   void requestResources(const vector<Request>& requests)
   {
     if (!connected) {
@@ -1369,6 +1411,71 @@ protected:
               << " on slave " << status.slave_id()
               << " to " << master.get().pid();
 
+      enqueueAcknowledgement(
+          status.slave_id(), status.task_id(), status.uuid());
+    } else {
+      VLOG(2) << "Received ACK for status update"
+              << (status.has_uuid() ? " " + status.uuid() : "")
+              << " of task " << status.task_id()
+              << (status.has_slave_id()
+                  ? " on slave " + stringify(status.slave_id()) : "");
+    }
+  }
+
+  // Appends an acknowledgement to the pending batch and, if this is
+  // the first pending entry, dispatches a flush behind the events
+  // currently in the queue. Any status updates already queued are
+  // therefore acknowledged in the same message.
+  void enqueueAcknowledgement(
+      const SlaveID& slaveId,
+      const TaskID& taskId,
+      const string& uuid)
+  {
+    CHECK(connected);
+    CHECK_SOME(master);
+    CHECK(framework.has_id());
+
+    if (pendingAcknowledgements.acknowledgements_size() == 0) {
+      pendingAcknowledgements.mutable_framework_id()
+        ->CopyFrom(framework.id());
+
+      dispatch(self(), &SchedulerProcess::flushAcknowledgements);
+    }
+
+    StatusUpdateAcknowledgementMessage* acknowledgement =
+      pendingAcknowledgements.add_acknowledgements();
+
+    acknowledgement->mutable_slave_id()->CopyFrom(slaveId);
+    acknowledgement->mutable_framework_id()->CopyFrom(framework.id());
+    acknowledgement->mutable_task_id()->CopyFrom(taskId);
+    acknowledgement->set_uuid(uuid);
+  }
+
+  void flushAcknowledgements()
+  {
+    if (pendingAcknowledgements.acknowledgements_size() == 0) {
+      return;
+    }
+
+    // If we got disconnected after the acknowledgements were
+    // enqueued we simply drop them; the slaves will retry the
+    // unacknowledged updates.
+    if (!connected || master.isNone()) {
+      VLOG(1) << "Dropping "
+              << pendingAcknowledgements.acknowledgements_size()
+              << " status update acknowledgements because the driver"
+              << " is disconnected";
+      pendingAcknowledgements.Clear();
+      return;
+    }
+
+    if (pendingAcknowledgements.acknowledgements_size() == 1) {
+      // NOTE: A single acknowledgement is sent as the existing
+      // ACKNOWLEDGE call so that the wire format is unchanged when
+      // there is nothing to coalesce.
+      const StatusUpdateAcknowledgementMessage& acknowledgement =
+        pendingAcknowledgements.acknowledgements(0);
+
       Call call;
 
       CHECK(framework.has_id());
@@ -1376,18 +1483,21 @@ protected:
       call.set_type(Call::ACKNOWLEDGE);
 
       Call::Acknowledge* acknowledge = call.mutable_acknowledge();
-      acknowledge->mutable_slave_id()->CopyFrom(status.slave_id());
-      acknowledge->mutable_task_id()->CopyFrom(status.task_id());
-      acknowledge->set_uuid(status.uuid());
+      acknowledge->mutable_slave_id()->CopyFrom(acknowledgement.slave_id());
+      acknowledge->mutable_task_id()->CopyFrom(acknowledgement.task_id());
+      acknowledge->set_uuid(acknowledgement.uuid());
 
       send(master.get().pid(), call);
     } else {
-      VLOG(2) << "Received ACK for status update"
-              << (status.has_uuid() ? " " + status.uuid() : "")
-              << " of task " << status.task_id()
-              << (status.has_slave_id()
-                  ? " on slave " + stringify(status.slave_id()) : "");
+      VLOG(2) << "Sending "
+              << pendingAcknowledgements.acknowledgements_size()
+              << " coalesced status update acknowledgements to "
+              << master.get().pid();
+
+      send(master.get().pid(), pendingAcknowledgements);
     }
+
+    pendingAcknowledgements.Clear();
   }
 
   void sendFrameworkMessage(const ExecutorID& executorId,
@@ -1546,6 +1656,13 @@ private:
   // is set).
   bool implicitAcknowledgements;
 
+  // Status update acknowledgements that have not been sent to the
+  // master yet. Acknowledgements are coalesced until the flush
+  // dispatched behind the events currently in the queue runs, so
+  // that a burst of status updates results in a single message to
+  // the master rather than one message per acknowledgement.
+  StatusUpdateAcknowledgementsMessage pendingAcknowledgements;
+
   const Option<Credential> credential;
 
   Authenticatee* authenticatee;
@@ -1949,6 +2066,22 @@ Status MesosSchedulerDriver::killTask(const TaskID& taskId)
 }
 
 
+Status MesosSchedulerDriver::killTasks(const vector<TaskID>& taskIds)
+{
+  synchronized (mutex) {
+    if (status != DRIVER_RUNNING) {
+      return status;
+    }
+
+    CHECK(process != NULL);
+
+    dispatch(process, &SchedulerProcess::killTasks, taskIds);
+
+    return status;
+  }
+}
+
+
 Status MesosSchedulerDriver::launchTasks(
     const OfferID& offerId,
     const vector<TaskInfo>& tasks,
@@ -30,12 +30,18 @@ const Duration EXECUTOR_REREGISTER_TIMEOUT = Seconds(2);
 const Duration EXECUTOR_SIGNAL_ESCALATION_TIMEOUT = Seconds(3);
 const Duration STATUS_UPDATE_RETRY_INTERVAL_MIN = Seconds(10);
 const Duration STATUS_UPDATE_RETRY_INTERVAL_MAX = Minutes(10);
+const uint32_t STATUS_UPDATE_SYNC_BATCH_SIZE = 100;
+const size_t EXECUTOR_FRAMEWORK_MESSAGE_BATCH_BYTES = 1024 * 1024;
 const Duration DEFAULT_REGISTRATION_BACKOFF_FACTOR = Seconds(1);
 const Duration REGISTER_RETRY_INTERVAL_MAX = Minutes(1);
 const Duration GC_DELAY = Weeks(1);
 const double GC_DISK_HEADROOM = 0.1;
+const size_t GC_RMDIR_CONCURRENCY = 4;
+const size_t IO_SCHEDULER_CONCURRENCY = 4;
 const Duration DISK_WATCH_INTERVAL = Minutes(1);
 const Duration RECOVERY_TIMEOUT = Minutes(15);
+const size_t DEFAULT_RECOVERY_IO_PARALLELISM = 8;
+const size_t DEFAULT_CONTAINER_DESTROY_PARALLELISM = 100;
 const uint32_t MAX_COMPLETED_FRAMEWORKS = 50;
 const uint32_t MAX_COMPLETED_EXECUTORS_PER_FRAMEWORK = 150;
 const uint32_t MAX_COMPLETED_TASKS_PER_EXECUTOR = 200;
@@ -40,8 +40,29 @@ extern const Duration EXECUTOR_SHUTDOWN_GRACE_PERIOD;
 extern const Duration EXECUTOR_REREGISTER_TIMEOUT;
 extern const Duration EXECUTOR_SIGNAL_ESCALATION_TIMEOUT;
 extern const Duration RECOVERY_TIMEOUT;
+
+// Default number of worker threads used to read and parse
+// checkpointed state during recovery.
+extern const size_t DEFAULT_RECOVERY_IO_PARALLELISM;
+
+// Default bound on the number of containers the containerizer
+// destroys concurrently.
+extern const size_t DEFAULT_CONTAINER_DESTROY_PARALLELISM;
 extern const Duration STATUS_UPDATE_RETRY_INTERVAL_MIN;
 extern const Duration STATUS_UPDATE_RETRY_INTERVAL_MAX;
+
+// Maximum number of checkpointed status update records to accumulate
+// before the status update manager forces a group sync of the updates
+// files (normally the sync happens once the manager has drained the
+// events already in its queue).
+extern const uint32_t STATUS_UPDATE_SYNC_BATCH_SIZE;
+
+// Number of queued framework message bytes beyond which the executor
+// driver flushes a pending batch immediately instead of waiting for
+// the batching window to expire (see
+// MESOS_EXECUTOR_FRAMEWORK_MESSAGE_BATCHING_WINDOW).
+extern const size_t EXECUTOR_FRAMEWORK_MESSAGE_BATCH_BYTES;
+
 extern const Duration GC_DELAY;
 extern const Duration DISK_WATCH_INTERVAL;
 
@@ -58,6 +79,17 @@ extern const Duration REGISTER_RETRY_INTERVAL_MAX;
 // Minimum free disk capacity enforced by the garbage collector.
 extern const double GC_DISK_HEADROOM;
 
+// Maximum number of directory removals the garbage collector runs
+// concurrently on worker threads. This bounds the I/O issued against
+// the disk when deleting large sandboxes.
+extern const size_t GC_RMDIR_CONCURRENCY;
+
+// Maximum number of background disk operations (provisioning,
+// fetching, garbage collection, disk usage scanning) the I/O
+// scheduler runs concurrently across all classes. See
+// 'slave/io_scheduler.hpp'.
+extern const size_t IO_SCHEDULER_CONCURRENCY;
+
 // Maximum number of completed frameworks to store in memory.
 extern const uint32_t MAX_COMPLETED_FRAMEWORKS;
 
@@ -25,6 +25,7 @@
 
 #include "module/manager.hpp"
 
+#include "slave/container_loggers/rotating.hpp"
 #include "slave/container_loggers/sandbox.hpp"
 
 using std::string;
@@ -38,6 +39,8 @@ Try<ContainerLogger*> ContainerLogger::create(const Option<string>& type)
 
   if (type.isNone()) {
     logger = new internal::slave::SandboxContainerLogger();
+  } else if (type.get() == "rotating") {
+    logger = new internal::slave::RotatingContainerLogger();
   } else {
     // Try to load container logger from module.
     Try<ContainerLogger*> module =
@@ -0,0 +1,449 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include <boost/shared_array.hpp>
+
+#include <mesos/mesos.hpp>
+
+#include <mesos/slave/container_logger.hpp>
+
+#include <process/async.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/io.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+#include <process/subprocess.hpp>
+
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/error.hpp>
+#include <stout/gzip.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/try.hpp>
+
+#include "slave/container_loggers/rotating.hpp"
+
+using namespace process;
+
+using mesos::slave::ContainerLogger;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+using SubprocessInfo = ContainerLogger::SubprocessInfo;
+
+
+// The amount of time after which the logger closes its copy of the
+// write end of a container's log pipe. The containerizer duplicates
+// the descriptor when it forks the container, but there is no
+// callback to tell the logger when that has happened; closing our
+// copy after a grace period ensures the read loop observes an EOF
+// once the container (and any descendants holding the write end)
+// exit.
+static const Duration PIPE_CLOSE_GRACE_PERIOD = Minutes(1);
+
+
+// Compresses a rotated log segment in place, replacing 'path' with
+// 'path + ".gz"'. Rotated segments are bounded by --max_file_size so
+// reading the whole segment into memory is acceptable. Runs on a
+// worker thread via `async` to keep compression off the event loop.
+static Nothing compressSegment(const std::string& path)
+{
+  Try<std::string> contents = os::read(path);
+  if (contents.isError()) {
+    LOG(WARNING) << "Failed to read rotated log segment '" << path
+                 << "' for compression: " << contents.error();
+    return Nothing();
+  }
+
+  Try<std::string> compressed = gzip::compress(contents.get());
+  if (compressed.isError()) {
+    LOG(WARNING) << "Failed to compress rotated log segment '" << path
+                 << "': " << compressed.error();
+    return Nothing();
+  }
+
+  Try<Nothing> write = os::write(path + ".gz", compressed.get());
+  if (write.isError()) {
+    LOG(WARNING) << "Failed to write compressed log segment '" << path
+                 << ".gz': " << write.error();
+    return Nothing();
+  }
+
+  Try<Nothing> rm = os::rm(path);
+  if (rm.isError()) {
+    LOG(WARNING) << "Failed to remove rotated log segment '" << path
+                 << "': " << rm.error();
+  }
+
+  return Nothing();
+}
+
+
+RotatingContainerLoggerFlags::RotatingContainerLoggerFlags()
+{
+  add(&RotatingContainerLoggerFlags::max_file_size,
+      "max_file_size",
+      "Maximum size of a container's 'stdout' or 'stderr' file before\n"
+      "it is rotated.",
+      Megabytes(10));
+
+  add(&RotatingContainerLoggerFlags::max_files,
+      "max_files",
+      "Maximum number of files kept per log stream, including the file\n"
+      "currently being written to. The oldest rotated file is\n"
+      "overwritten once this many files exist.",
+      5u,
+      [](size_t value) -> Option<Error> {
+        if (value < 2) {
+          return Error("Expected --max_files to be at least 2");
+        }
+        return None();
+      });
+
+  add(&RotatingContainerLoggerFlags::compress,
+      "compress",
+      "Whether to gzip compress rotated log files in the background.",
+      false);
+}
+
+
+class RotatingContainerLoggerProcess :
+  public Process<RotatingContainerLoggerProcess>
+{
+public:
+  RotatingContainerLoggerProcess(const RotatingContainerLoggerFlags& _flags)
+    : flags(_flags) {}
+
+  Future<Nothing> recover(
+      const ExecutorInfo& executorInfo,
+      const std::string& sandboxDirectory)
+  {
+    return Nothing();
+  }
+
+  Future<ContainerLogger::SubprocessInfo> prepare(
+      const ExecutorInfo& executorInfo,
+      const std::string& sandboxDirectory)
+  {
+    Try<int> out = sink(executorInfo, sandboxDirectory, "stdout");
+    if (out.isError()) {
+      return Failure(
+          "Failed to create rotating 'stdout' sink: " + out.error());
+    }
+
+    Try<int> err = sink(executorInfo, sandboxDirectory, "stderr");
+    if (err.isError()) {
+      os::close(out.get());
+      return Failure(
+          "Failed to create rotating 'stderr' sink: " + err.error());
+    }
+
+    ContainerLogger::SubprocessInfo info;
+
+    info.out = SubprocessInfo::IO::FD(out.get());
+    info.err = SubprocessInfo::IO::FD(err.get());
+
+    return info;
+  }
+
+private:
+  // The state of a single log stream: the read end of the pipe given
+  // to the container, the file currently being written to, and how
+  // many bytes have been written into it since the last rotation.
+  struct Sink
+  {
+    Sink(
+        const std::string& _path,
+        int _readFd,
+        int _fd,
+        size_t _written,
+        const std::string& counter)
+      : path(_path),
+        readFd(_readFd),
+        fd(_fd),
+        written(_written),
+        rotation(0),
+        bytes(counter) {}
+
+    const std::string path;
+    const int readFd;
+
+    // The descriptor of the file currently being written to, or -1
+    // if writing has failed (in which case we keep draining the pipe
+    // so the container does not block).
+    int fd;
+
+    size_t written;
+    size_t rotation;
+
+    metrics::Counter bytes;
+  };
+
+  // Creates the pipe and initial file for a single log stream and
+  // starts the read loop. Returns the write end of the pipe, which
+  // the caller passes to the containerizer (the containerizer
+  // duplicates it when forking the container).
+  Try<int> sink(
+      const ExecutorInfo& executorInfo,
+      const std::string& sandboxDirectory,
+      const std::string& name)
+  {
+    int pipefd[2];
+    if (::pipe(pipefd) == -1) {
+      return ErrnoError("Failed to create pipe");
+    }
+
+    Try<Nothing> nonblock = os::nonblock(pipefd[0]);
+    if (nonblock.isError()) {
+      os::close(pipefd[0]);
+      os::close(pipefd[1]);
+      return Error("Failed to set pipe nonblocking: " + nonblock.error());
+    }
+
+    os::cloexec(pipefd[0]);
+    os::cloexec(pipefd[1]);
+
+    const std::string path = path::join(sandboxDirectory, name);
+
+    Try<int> fd = os::open(
+        path,
+        O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+        S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (fd.isError()) {
+      os::close(pipefd[0]);
+      os::close(pipefd[1]);
+      return Error("Failed to open '" + path + "': " + fd.error());
+    }
+
+    // If the file already has contents (e.g., the executor was
+    // relaunched into the same sandbox) count them towards the
+    // rotation threshold.
+    off_t size = lseek(fd.get(), 0, SEEK_END);
+
+    Owned<Sink> sink(new Sink(
+        path,
+        pipefd[0],
+        fd.get(),
+        size == static_cast<off_t>(-1) ? 0 : size,
+        "container_logger/" + stringify(executorInfo.executor_id()) +
+        "/" + name + "_bytes"));
+
+    metrics::add(sink->bytes);
+
+    read(sink);
+
+    // Close our copy of the write end once the containerizer has had
+    // a chance to duplicate it, so that the read loop sees an EOF
+    // when the container exits.
+    delay(PIPE_CLOSE_GRACE_PERIOD, self(), &Self::close, pipefd[1]);
+
+    return pipefd[1];
+  }
+
+  void close(int fd)
+  {
+    os::close(fd);
+  }
+
+  void read(const Owned<Sink>& sink)
+  {
+    size_t size = os::pagesize() * 16;
+    boost::shared_array<char> data(new char[size]);
+
+    io::read(sink->readFd, data.get(), size)
+      .onAny(defer(self(), &Self::_read, sink, data, lambda::_1));
+  }
+
+  void _read(
+      const Owned<Sink>& sink,
+      const boost::shared_array<char>& data,
+      const Future<size_t>& length)
+  {
+    // The container has exited (EOF) or the read failed; either way
+    // this stream is finished.
+    if (!length.isReady() || length.get() == 0) {
+      if (length.isFailed()) {
+        LOG(WARNING) << "Failed to read container logs for '"
+                     << sink->path << "': " << length.failure();
+      }
+
+      os::close(sink->readFd);
+      if (sink->fd >= 0) {
+        os::close(sink->fd);
+      }
+
+      metrics::remove(sink->bytes);
+      return;
+    }
+
+    sink->bytes += length.get();
+
+    if (sink->fd >= 0 &&
+        sink->written > 0 &&
+        sink->written + length.get() > flags.max_file_size.bytes()) {
+      rotate(sink);
+    }
+
+    if (sink->fd >= 0) {
+      Try<Nothing> write = os::write(
+          sink->fd, std::string(data.get(), length.get()));
+
+      if (write.isError()) {
+        // Keep draining the pipe so the container does not block on
+        // a full pipe, but stop writing (e.g., the disk is full).
+        LOG(WARNING) << "Failed to write container logs to '"
+                     << sink->path << "': " << write.error();
+
+        os::close(sink->fd);
+        sink->fd = -1;
+      } else {
+        sink->written += length.get();
+      }
+    }
+
+    read(sink);
+  }
+
+  // Rotates a log file in O(1): the current file is renamed into the
+  // next slot of the ring (overwriting the oldest rotated file) and
+  // a fresh file is opened in its place.
+  void rotate(const Owned<Sink>& sink)
+  {
+    os::close(sink->fd);
+    sink->fd = -1;
+
+    const std::string rotated =
+      sink->path + "." +
+      stringify((sink->rotation % (flags.max_files - 1)) + 1);
+
+    Try<Nothing> rename = os::rename(sink->path, rotated);
+    if (rename.isError()) {
+      LOG(WARNING) << "Failed to rotate container log '" << sink->path
+                   << "': " << rename.error();
+    } else {
+      sink->rotation++;
+
+      if (flags.compress) {
+        async(&compressSegment, rotated);
+      }
+    }
+
+    Try<int> fd = os::open(
+        sink->path,
+        O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC,
+        S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (fd.isError()) {
+      LOG(WARNING) << "Failed to reopen container log '" << sink->path
+                   << "': " << fd.error();
+      return;
+    }
+
+    sink->fd = fd.get();
+    sink->written = 0;
+  }
+
+  const RotatingContainerLoggerFlags flags;
+};
+
+
+RotatingContainerLogger::~RotatingContainerLogger()
+{
+  if (process.get() != NULL) {
+    terminate(process.get());
+    wait(process.get());
+  }
+}
+
+
+Try<Nothing> RotatingContainerLogger::initialize()
+{
+  if (process.get() != NULL) {
+    return Error("Rotating container logger has already been initialized");
+  }
+
+  // NOTE: Only the name of the logger reaches `ContainerLogger::create`,
+  // so the logger's configuration is taken from the environment.
+  Try<Nothing> load = flags.load("MESOS_CONTAINER_LOGGER_");
+  if (load.isError()) {
+    return Error("Failed to load rotating container logger flags: " +
+                 load.error());
+  }
+
+  process.reset(new RotatingContainerLoggerProcess(flags));
+  spawn(process.get());
+
+  return Nothing();
+}
+
+
+Future<Nothing> RotatingContainerLogger::recover(
+    const ExecutorInfo& executorInfo,
+    const std::string& sandboxDirectory)
+{
+  if (process.get() == NULL) {
+    return Failure("Rotating container logger is not initialized");
+  }
+
+  return dispatch(
+      process.get(),
+      &RotatingContainerLoggerProcess::recover,
+      executorInfo,
+      sandboxDirectory);
+}
+
+
+Future<ContainerLogger::SubprocessInfo>
+RotatingContainerLogger::prepare(
+    const ExecutorInfo& executorInfo,
+    const std::string& sandboxDirectory)
+{
+  if (process.get() == NULL) {
+    return Failure("Rotating container logger is not initialized");
+  }
+
+  return dispatch(
+      process.get(),
+      &RotatingContainerLoggerProcess::prepare,
+      executorInfo,
+      sandboxDirectory);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
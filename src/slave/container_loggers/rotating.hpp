@@ -0,0 +1,102 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_CONTAINER_LOGGERS_ROTATING_HPP__
+#define __SLAVE_CONTAINER_LOGGERS_ROTATING_HPP__
+
+#include <string>
+
+#include <mesos/mesos.hpp>
+
+#include <mesos/slave/container_logger.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/subprocess.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/flags.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class RotatingContainerLoggerProcess;
+
+
+// Configuration for the rotating container logger. Since only the
+// name of the logger reaches `ContainerLogger::create`, these flags
+// are loaded from the environment with the "MESOS_CONTAINER_LOGGER_"
+// prefix (e.g., MESOS_CONTAINER_LOGGER_MAX_FILE_SIZE=50MB).
+class RotatingContainerLoggerFlags : public virtual flags::FlagsBase
+{
+public:
+  RotatingContainerLoggerFlags();
+
+  Bytes max_file_size;
+  size_t max_files;
+  bool compress;
+};
+
+
+// A bundled container logger that pipes the stdout and stderr of
+// containers through the agent into a size-capped ring of files in
+// the sandbox ("stdout", "stdout.1", ...). Rotation is a single
+// rename plus reopen, overwriting the oldest file in the ring, so
+// sandbox logs are bounded regardless of how much a container
+// writes. Rotated files can optionally be gzip compressed in the
+// background.
+//
+// NOTE: Unlike the default sandbox logger, the container's log data
+// flows through the agent, so output produced while the agent is
+// down (e.g., during an upgrade) is not captured.
+class RotatingContainerLogger : public mesos::slave::ContainerLogger
+{
+public:
+  virtual ~RotatingContainerLogger();
+
+  virtual Try<Nothing> initialize();
+
+  // This is a noop. Sandboxes recovered by the agent already expose
+  // the rotated files via the `/files` endpoint; output written by
+  // the executor while the agent was down is not recovered.
+  virtual process::Future<Nothing> recover(
+      const ExecutorInfo& executorInfo,
+      const std::string& sandboxDirectory);
+
+  // Hands the container the write end of a pipe for each of stdout
+  // and stderr, and streams the read ends into rotating files in the
+  // sandbox.
+  virtual process::Future<mesos::slave::ContainerLogger::SubprocessInfo>
+  prepare(
+      const ExecutorInfo& executorInfo,
+      const std::string& sandboxDirectory);
+
+protected:
+  RotatingContainerLoggerFlags flags;
+  process::Owned<RotatingContainerLoggerProcess> process;
+};
+
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_CONTAINER_LOGGERS_ROTATING_HPP__
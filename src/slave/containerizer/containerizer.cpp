@@ -14,9 +14,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <list>
 #include <map>
 #include <vector>
 
+#include <process/collect.hpp>
 #include <process/dispatch.hpp>
 #include <process/owned.hpp>
 
@@ -43,6 +45,7 @@
 #include "slave/containerizer/mesos/linux_launcher.hpp"
 #endif // __linux__
 
+using std::list;
 using std::map;
 using std::string;
 using std::vector;
@@ -246,6 +249,39 @@ Try<Containerizer*> Containerizer::create(
 }
 
 
+Future<hashmap<ContainerID, ResourceStatistics>> Containerizer::usages(
+    const vector<ContainerID>& containerIds)
+{
+  list<Future<ResourceStatistics>> futures;
+  foreach (const ContainerID& containerId, containerIds) {
+    futures.push_back(usage(containerId));
+  }
+
+  // Use await() here so we can return partial usage statistics.
+  return await(futures)
+    .then([containerIds](const list<Future<ResourceStatistics>>& futures)
+            -> hashmap<ContainerID, ResourceStatistics> {
+      hashmap<ContainerID, ResourceStatistics> statistics;
+
+      size_t i = 0;
+      foreach (const Future<ResourceStatistics>& future, futures) {
+        const ContainerID& containerId = containerIds[i++];
+
+        if (future.isReady()) {
+          statistics.put(containerId, future.get());
+        } else {
+          LOG(WARNING) << "Skipping resource statistics for container "
+                       << containerId << " because: "
+                       << (future.isFailed() ? future.failure()
+                                             : "discarded");
+        }
+      }
+
+      return statistics;
+    });
+}
+
+
 map<string, string> executorEnvironment(
     const ExecutorInfo& executorInfo,
     const string& directory,
@@ -18,6 +18,7 @@
 #define __CONTAINERIZER_HPP__
 
 #include <map>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
@@ -29,6 +30,7 @@
 #include <process/process.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/option.hpp>
 #include <stout/try.hpp>
@@ -110,6 +112,15 @@ public:
   virtual process::Future<ResourceStatistics> usage(
       const ContainerID& containerId) = 0;
 
+  // Get resource usage statistics for many containers at once. The
+  // default implementation simply issues one 'usage' call per
+  // container; containerizers that can collect statistics for many
+  // containers in a single pass should override this. Statistics for
+  // containers that are unknown or whose collection fails are
+  // omitted from the result rather than failing the whole batch.
+  virtual process::Future<hashmap<ContainerID, ResourceStatistics>> usages(
+      const std::vector<ContainerID>& containerIds);
+
   // Wait on the container's 'Termination'. If the executor terminates, the
   // containerizer should also destroy the containerized context. The future
   // may be failed if an error occurs during termination of the executor or
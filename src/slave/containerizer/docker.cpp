@@ -29,6 +29,8 @@
 #include <process/reap.hpp>
 #include <process/subprocess.hpp>
 
+#include <process/metrics/metrics.hpp>
+
 #include <stout/fs.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
@@ -350,13 +352,14 @@ Future<Nothing> DockerContainerizerProcess::fetch(
   CHECK(containers_.contains(containerId));
   Container* container = containers_[containerId];
 
-  return fetcher->fetch(
-      containerId,
-      container->command,
-      container->directory,
-      None(),
-      slaveId,
-      flags);
+  return metrics.fetch.time(
+      fetcher->fetch(
+          containerId,
+          container->command,
+          container->directory,
+          None(),
+          slaveId,
+          flags));
 }
 
 
@@ -372,10 +375,11 @@ Future<Nothing> DockerContainerizerProcess::pull(
 
   string image = container->image();
 
-  Future<Docker::Image> future = docker->pull(
-    container->directory,
-    image,
-    container->forcePullImage());
+  Future<Docker::Image> future = metrics.pull.time(
+      docker->pull(
+          container->directory,
+          image,
+          container->forcePullImage()));
 
   containers_[containerId]->pull = future;
 
@@ -806,12 +810,15 @@ Future<bool> DockerContainerizerProcess::launch(
 
   if (taskInfo.isSome() && flags.docker_mesos_image.isNone()) {
     // Launching task by forking a subprocess to run docker executor.
-    return container.get()->launch = fetch(containerId, slaveId)
-      .then(defer(self(), [=]() { return pull(containerId); }))
-      .then(defer(self(), [=]() { return launchExecutorProcess(containerId); }))
-      .then(defer(self(), [=](pid_t pid) {
-        return reapExecutor(containerId, pid);
-      }));
+    return container.get()->launch = metrics.launch.time(
+        fetch(containerId, slaveId)
+          .then(defer(self(), [=]() { return pull(containerId); }))
+          .then(defer(self(), [=]() {
+            return launchExecutorProcess(containerId);
+          }))
+          .then(defer(self(), [=](pid_t pid) {
+            return reapExecutor(containerId, pid);
+          })));
   }
 
   string containerName = container.get()->name();
@@ -828,17 +835,18 @@ Future<bool> DockerContainerizerProcess::launch(
   // is running in a container (via docker_mesos_image flag)
   // we want the executor to keep running when the slave container
   // dies.
-  return container.get()->launch = fetch(containerId, slaveId)
-    .then(defer(self(), [=]() { return pull(containerId); }))
-    .then(defer(self(), [=]() {
-      return launchExecutorContainer(containerId, containerName);
-    }))
-    .then(defer(self(), [=](const Docker::Container& dockerContainer) {
-      return checkpointExecutor(containerId, dockerContainer);
-    }))
-    .then(defer(self(), [=](pid_t pid) {
-      return reapExecutor(containerId, pid);
-    }));
+  return container.get()->launch = metrics.launch.time(
+      fetch(containerId, slaveId)
+        .then(defer(self(), [=]() { return pull(containerId); }))
+        .then(defer(self(), [=]() {
+          return launchExecutorContainer(containerId, containerName);
+        }))
+        .then(defer(self(), [=](const Docker::Container& dockerContainer) {
+          return checkpointExecutor(containerId, dockerContainer);
+        }))
+        .then(defer(self(), [=](pid_t pid) {
+          return reapExecutor(containerId, pid);
+        })));
 }
 
 
@@ -1613,6 +1621,25 @@ Future<hashset<ContainerID>> DockerContainerizerProcess::containers()
 }
 
 
+DockerContainerizerProcess::Metrics::Metrics()
+  : launch("containerizer/docker/launch", Hours(1)),
+    fetch("containerizer/docker/fetch", Hours(1)),
+    pull("containerizer/docker/pull", Hours(1))
+{
+  process::metrics::add(launch);
+  process::metrics::add(fetch);
+  process::metrics::add(pull);
+}
+
+
+DockerContainerizerProcess::Metrics::~Metrics()
+{
+  process::metrics::remove(launch);
+  process::metrics::remove(fetch);
+  process::metrics::remove(pull);
+}
+
+
 void DockerContainerizerProcess::reaped(const ContainerID& containerId)
 {
   if (!containers_.contains(containerId)) {
@@ -22,6 +22,9 @@
 #include <process/owned.hpp>
 #include <process/shared.hpp>
 
+#include <process/metrics/timer.hpp>
+
+#include <stout/duration.hpp>
 #include <stout/flags.hpp>
 #include <stout/hashset.hpp>
 
@@ -463,6 +466,18 @@ private:
   };
 
   hashmap<ContainerID, Container*> containers_;
+
+  struct Metrics
+  {
+    Metrics();
+    ~Metrics();
+
+    // Stage-level launch latency timers, used to see where container
+    // startup time goes (e.g., image pulling vs. fetching).
+    process::metrics::Timer<Milliseconds> launch;
+    process::metrics::Timer<Milliseconds> fetch;
+    process::metrics::Timer<Milliseconds> pull;
+  } metrics;
 };
 
 
@@ -18,8 +18,10 @@
 
 #include <process/async.hpp>
 #include <process/check.hpp>
+#include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/dispatch.hpp>
+#include <process/metrics/metrics.hpp>
 #include <process/owned.hpp>
 
 #include <stout/net.hpp>
@@ -29,6 +31,7 @@
 
 #include "hdfs/hdfs.hpp"
 
+#include "slave/io_scheduler.hpp"
 #include "slave/slave.hpp"
 
 #include "slave/containerizer/fetcher.hpp"
@@ -42,6 +45,7 @@ using std::vector;
 
 using mesos::fetcher::FetcherInfo;
 
+using process::Clock;
 using process::Future;
 using process::Owned;
 
@@ -54,6 +58,10 @@ static const string FILE_URI_LOCALHOST = "file://localhost";
 
 static const string CACHE_FILE_NAME_PREFIX = "c";
 
+// How long a probed URI size may be served from the size cache
+// before the URI gets probed again.
+static const Duration URI_SIZE_CACHE_TTL = Minutes(10);
+
 
 Fetcher::Fetcher() : process(new FetcherProcess())
 {
@@ -244,6 +252,73 @@ FetcherProcess::~FetcherProcess()
 }
 
 
+FetcherProcess::Metrics::Metrics()
+  : size_cache_hits("containerizer/fetcher/size_cache_hits"),
+    size_cache_misses("containerizer/fetcher/size_cache_misses")
+{
+  process::metrics::add(size_cache_hits);
+  process::metrics::add(size_cache_misses);
+}
+
+
+FetcherProcess::Metrics::~Metrics()
+{
+  process::metrics::remove(size_cache_hits);
+  process::metrics::remove(size_cache_misses);
+}
+
+
+Option<Bytes> FetcherProcess::lookupSize(
+    const string& uri,
+    const Option<string>& frameworksHome)
+{
+  // Local URIs (and malformed ones, which will fail the fetch later
+  // anyway) are not cached: a 'stat' is cheap and reflects changes
+  // to the file immediately.
+  Result<string> path = Fetcher::uriToLocalPath(uri, frameworksHome);
+  if (!path.isNone()) {
+    return None();
+  }
+
+  if (sizeCache.contains(uri)) {
+    const SizeCacheEntry& entry = sizeCache[uri];
+
+    if (Clock::now() < entry.expiration) {
+      ++metrics.size_cache_hits;
+      return entry.size;
+    }
+
+    sizeCache.erase(uri);
+  }
+
+  ++metrics.size_cache_misses;
+
+  return None();
+}
+
+
+void FetcherProcess::recordSize(
+    const string& uri,
+    const Option<string>& frameworksHome,
+    const Try<Bytes>& size)
+{
+  if (size.isError()) {
+    return;
+  }
+
+  Result<string> path = Fetcher::uriToLocalPath(uri, frameworksHome);
+  if (!path.isNone()) {
+    return;
+  }
+
+  SizeCacheEntry entry;
+  entry.size = size.get();
+  entry.expiration = Clock::now() + URI_SIZE_CACHE_TTL;
+
+  sizeCache[uri] = entry;
+}
+
+
 // Find out how large a potential download from the given URI is.
 static Try<Bytes> fetchSize(
     const string& uri,
@@ -381,13 +456,24 @@ Future<Nothing> FetcherProcess::fetch(
 
       newEntry->reference();
 
-      entries[uri] =
-        async([=]() {
-          return fetchSize(uri.value(), flags.frameworks_home);
-        })
-        .then(defer(self(), [=](const Try<Bytes>& requestedSpace) {
-          return reserveCacheSpace(requestedSpace, newEntry);
-        }));
+      const Option<Bytes> cachedSize =
+        lookupSize(uri.value(), flags.frameworks_home);
+
+      if (cachedSize.isSome()) {
+        // We already know the size from a recent probe of the same
+        // URI, so we can reserve the cache space without asking the
+        // artifact server (or HDFS) again.
+        entries[uri] = reserveCacheSpace(cachedSize.get(), newEntry);
+      } else {
+        entries[uri] =
+          async([=]() {
+            return fetchSize(uri.value(), flags.frameworks_home);
+          })
+          .then(defer(self(), [=](const Try<Bytes>& requestedSpace) {
+            recordSize(uri.value(), flags.frameworks_home, requestedSpace);
+            return reserveCacheSpace(requestedSpace, newEntry);
+          }));
+      }
     }
   }
 
@@ -506,6 +592,7 @@ Future<Nothing> FetcherProcess::__fetch(
 
   info.set_sandbox_directory(sandboxDirectory);
   info.set_cache_directory(cacheDirectory);
+  info.set_hardlink_materialization(flags.fetcher_cache_hardlinks);
 
   if (user.isSome()) {
     info.set_user(user.get());
@@ -758,18 +845,41 @@ Future<Nothing> FetcherProcess::run(
     environment["HADOOP_HOME"] = flags.hadoop_home;
   }
 
+  // Launch through the slave's I/O scheduler so that downloads are
+  // throttled against the other background disk traffic.
+  return IOScheduler::instance()->schedule<Nothing>(
+      IOScheduler::FETCH,
+      defer(self(),
+            &FetcherProcess::_run,
+            containerId,
+            command,
+            environment,
+            out.get(),
+            err.get(),
+            stderr));
+}
+
+
+Future<Nothing> FetcherProcess::_run(
+    const ContainerID& containerId,
+    const string& command,
+    const map<string, string>& environment,
+    int out,
+    int err,
+    const string& stderrPath)
+{
   VLOG(1) << "Fetching URIs using command '" << command << "'";
 
   Try<Subprocess> fetcherSubprocess = subprocess(
       command,
       Subprocess::PIPE(),
-      Subprocess::FD(out.get()),
-      Subprocess::FD(err.get()),
+      Subprocess::FD(out),
+      Subprocess::FD(err),
       environment);
 
   if (fetcherSubprocess.isError()) {
-    os::close(out.get());
-    os::close(err.get());
+    os::close(out);
+    os::close(err);
     return Failure("Failed to execute mesos-fetcher: " +
                    fetcherSubprocess.error());
   }
@@ -797,7 +907,7 @@ Future<Nothing> FetcherProcess::run(
     .onFailed(defer(self(), [=](const string&) {
       // To aid debugging what went wrong when attempting to fetch, grab the
       // fetcher's local log output from the sandbox and log it here.
-      Try<string> text = os::read(stderr);
+      Try<string> text = os::read(stderrPath);
       if (text.isSome()) {
         LOG(WARNING) << "Begin fetcher log (stderr in sandbox) for container "
                      << containerId << " from running command: " << command
@@ -812,8 +922,8 @@ Future<Nothing> FetcherProcess::run(
       // Clear the subprocess PID remembered from running mesos-fetcher.
       subprocessPids.erase(containerId);
 
-      os::close(out.get());
-      os::close(err.get());
+      os::close(out);
+      os::close(err);
     }));
 }
 
@@ -18,6 +18,7 @@
 #define __SLAVE_CONTAINERIZER_FETCHER_HPP__
 
 #include <list>
+#include <map>
 #include <string>
 
 #include <mesos/mesos.hpp>
@@ -29,6 +30,9 @@
 #include <process/future.hpp>
 #include <process/process.hpp>
 #include <process/subprocess.hpp>
+#include <process/time.hpp>
+
+#include <process/metrics/counter.hpp>
 
 #include <stout/hashmap.hpp>
 
@@ -135,6 +139,16 @@ public:
       const mesos::fetcher::FetcherInfo& info,
       const Flags& flags);
 
+  // Continuation of 'run()': launches the mesos-fetcher once the
+  // slave's I/O scheduler admits the download.
+  process::Future<Nothing> _run(
+      const ContainerID& containerId,
+      const std::string& command,
+      const std::map<std::string, std::string>& environment,
+      int out,
+      int err,
+      const std::string& stderrPath);
+
   // Best effort attempt to kill the external mesos-fetcher process
   // running on behalf of the given container ID, if any.
   void kill(const ContainerID& containerId);
@@ -328,9 +342,48 @@ private:
       const Try<Bytes>& requestedSpace,
       const std::shared_ptr<Cache::Entry>& entry);
 
+  // An entry of 'sizeCache' below.
+  struct SizeCacheEntry
+  {
+    Bytes size;
+    process::Time expiration;
+  };
+
+  // Returns the size most recently probed for the given URI, unless
+  // the entry has expired or the URI refers to a local file, for
+  // which a 'stat' is cheap and reflects changes to the file
+  // immediately.
+  Option<Bytes> lookupSize(
+      const std::string& uri,
+      const Option<std::string>& frameworksHome);
+
+  // Records a successfully probed size for the given URI. No-op for
+  // local URIs and failed probes.
+  void recordSize(
+      const std::string& uri,
+      const Option<std::string>& frameworksHome,
+      const Try<Bytes>& size);
+
   Cache cache;
 
+  // Caches the most recently probed size per URI so that repeated
+  // launches of the same artifact do not re-issue network size
+  // probes (HTTP HEAD requests or HDFS 'du' invocations) against
+  // the artifact server. Entries expire after a TTL so that updated
+  // artifacts are eventually noticed.
+  hashmap<std::string, SizeCacheEntry> sizeCache;
+
   hashmap<ContainerID, pid_t> subprocessPids;
+
+  struct Metrics
+  {
+    Metrics();
+    ~Metrics();
+
+    // Hits and misses of 'sizeCache' for non-local URIs.
+    process::metrics::Counter size_cache_hits;
+    process::metrics::Counter size_cache_misses;
+  } metrics;
 };
 
 } // namespace slave {
@@ -53,8 +53,13 @@
 
 #include "slave/containerizer/mesos/isolators/posix/disk.hpp"
 
+#ifdef ENABLE_XFS_DISK_ISOLATOR
+#include "slave/containerizer/mesos/isolators/xfs/disk.hpp"
+#endif
+
 #ifdef __linux__
 #include "slave/containerizer/mesos/isolators/cgroups/cpushare.hpp"
+#include "slave/containerizer/mesos/isolators/cgroups/cpuset.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/mem.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/net_cls.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/perf_event.hpp"
@@ -142,6 +147,11 @@ Try<MesosContainerizer*> MesosContainerizer::create(
 
   LOG(INFO) << "Using isolation: " << flags_.isolation;
 
+  // A parallelism of zero would wedge container destruction.
+  if (flags_.container_destroy_parallelism == 0) {
+    return Error("Invalid --container_destroy_parallelism: must be non-zero");
+  }
+
   // Create the container logger for the MesosContainerizer.
   Try<ContainerLogger*> logger =
     ContainerLogger::create(flags_.container_logger);
@@ -203,8 +213,12 @@ Try<MesosContainerizer*> MesosContainerizer::create(
     {"posix/cpu", &PosixCpuIsolatorProcess::create},
     {"posix/mem", &PosixMemIsolatorProcess::create},
     {"posix/disk", &PosixDiskIsolatorProcess::create},
+#ifdef ENABLE_XFS_DISK_ISOLATOR
+    {"disk/xfs", &XfsDiskIsolatorProcess::create},
+#endif
 #ifdef __linux__
     {"cgroups/cpu", &CgroupsCpushareIsolatorProcess::create},
+    {"cgroups/cpuset", &CgroupsCpusetIsolatorProcess::create},
     {"cgroups/mem", &CgroupsMemIsolatorProcess::create},
     {"cgroups/net_cls", &CgroupsNetClsIsolatorProcess::create},
     {"cgroups/perf_event", &CgroupsPerfEventIsolatorProcess::create},
@@ -362,6 +376,16 @@ Future<ResourceStatistics> MesosContainerizer::usage(
 }
 
 
+Future<hashmap<ContainerID, ResourceStatistics>> MesosContainerizer::usages(
+    const vector<ContainerID>& containerIds)
+{
+  return dispatch(
+      process.get(),
+      &MesosContainerizerProcess::usages,
+      containerIds);
+}
+
+
 Future<containerizer::Termination> MesosContainerizer::wait(
     const ContainerID& containerId)
 {
@@ -647,46 +671,49 @@ Future<bool> MesosContainerizerProcess::launch(
   containers_.put(containerId, Owned<Container>(container));
 
   if (!executorInfo.has_container()) {
-    return prepare(containerId, executorInfo, directory, user, None())
-      .then(defer(self(),
-                  &Self::__launch,
-                  containerId,
-                  executorInfo,
-                  directory,
-                  user,
-                  slaveId,
-                  slavePid,
-                  checkpoint,
-                  lambda::_1));
+    return metrics.launch.time(
+        prepare(containerId, executorInfo, directory, user, None())
+          .then(defer(self(),
+                      &Self::__launch,
+                      containerId,
+                      executorInfo,
+                      directory,
+                      user,
+                      slaveId,
+                      slavePid,
+                      checkpoint,
+                      lambda::_1)));
   }
 
   // Provision the root filesystem if needed.
   CHECK_EQ(executorInfo.container().type(), ContainerInfo::MESOS);
 
   if (!executorInfo.container().mesos().has_image()) {
-    return _launch(containerId,
-                   executorInfo,
-                   directory,
-                   user,
-                   slaveId,
-                   slavePid,
-                   checkpoint,
-                   None());
-  }
-
-  const Image& image = executorInfo.container().mesos().image();
-
-  return provisioner->provision(containerId, image)
-    .then(defer(PID<MesosContainerizerProcess>(this),
-                &MesosContainerizerProcess::_launch,
-                containerId,
+    return metrics.launch.time(
+        _launch(containerId,
                 executorInfo,
                 directory,
                 user,
                 slaveId,
                 slavePid,
                 checkpoint,
-                lambda::_1));
+                None()));
+  }
+
+  const Image& image = executorInfo.container().mesos().image();
+
+  return metrics.launch.time(
+      metrics.provision.time(provisioner->provision(containerId, image))
+        .then(defer(PID<MesosContainerizerProcess>(this),
+                    &MesosContainerizerProcess::_launch,
+                    containerId,
+                    executorInfo,
+                    directory,
+                    user,
+                    slaveId,
+                    slavePid,
+                    checkpoint,
+                    lambda::_1)));
 }
 
 
@@ -720,7 +747,7 @@ Future<bool> MesosContainerizerProcess::_launch(
     const Image& image = volume->image();
 
     futures.push_back(
-        provisioner->provision(containerId, image)
+        metrics.provision.time(provisioner->provision(containerId, image))
           .then([volume](const ProvisionInfo& info) -> Future<Nothing> {
             volume->set_host_path(info.rootfs);
             return Nothing();
@@ -757,22 +784,30 @@ Future<bool> MesosContainerizerProcess::_launch(
 
 static list<Option<ContainerLaunchInfo>> accumulate(
     list<Option<ContainerLaunchInfo>> l,
-    const Option<ContainerLaunchInfo>& e)
+    const list<Option<ContainerLaunchInfo>>& e)
 {
-  l.push_back(e);
+  l.insert(l.end(), e.begin(), e.end());
   return l;
 }
 
 
 static Future<list<Option<ContainerLaunchInfo>>> _prepare(
-    const Owned<Isolator>& isolator,
+    const vector<Owned<Isolator>>& batch,
     const ContainerID& containerId,
     const ExecutorInfo& executorInfo,
     const ContainerConfig& containerConfig,
     const list<Option<ContainerLaunchInfo>> launchInfos)
 {
+  // Prepare the isolators in this batch concurrently. Their launch
+  // infos are appended in isolator order.
+  list<Future<Option<ContainerLaunchInfo>>> futures;
+  foreach (const Owned<Isolator>& isolator, batch) {
+    futures.push_back(
+        isolator->prepare(containerId, executorInfo, containerConfig));
+  }
+
   // Propagate any failure.
-  return isolator->prepare(containerId, executorInfo, containerConfig)
+  return collect(futures)
     .then(lambda::bind(&accumulate, launchInfos, lambda::_1));
 }
 
@@ -798,22 +833,44 @@ Future<list<Option<ContainerLaunchInfo>>> MesosContainerizerProcess::prepare(
     containerConfig.set_rootfs(provisionInfo.get().rootfs);
   }
 
-  // We prepare the isolators sequentially according to their ordering
-  // to permit basic dependency specification, e.g., preparing a
-  // filesystem isolator before other isolators.
+  // We prepare the isolators according to their ordering to permit
+  // basic dependency specification, e.g., preparing a filesystem
+  // isolator before other isolators. Adjacent isolators that declare
+  // support for parallel preparation (see
+  // `Isolator::supportsParallelPrepare`) have no ordering dependency
+  // between them and are batched so that they prepare concurrently.
+  vector<vector<Owned<Isolator>>> batches;
+
+  foreach (const Owned<Isolator>& isolator, isolators) {
+    // An isolator that does not support parallel preparation must
+    // observe the effects of all preceding isolators and complete
+    // before any subsequent isolator starts, so it forms a batch of
+    // its own.
+    if (batches.empty() ||
+        !isolator->supportsParallelPrepare() ||
+        !batches.back().back()->supportsParallelPrepare()) {
+      batches.push_back(vector<Owned<Isolator>>());
+    }
+
+    batches.back().push_back(isolator);
+  }
+
   Future<list<Option<ContainerLaunchInfo>>> f =
     list<Option<ContainerLaunchInfo>>();
 
-  foreach (const Owned<Isolator>& isolator, isolators) {
-    // Chain together preparing each isolator.
+  foreach (const vector<Owned<Isolator>>& batch, batches) {
+    // Chain together preparing each batch.
     f = f.then(lambda::bind(&_prepare,
-                            isolator,
+                            batch,
                             containerId,
                             executorInfo,
                             containerConfig,
                             lambda::_1));
   }
 
+  // Accounts for the entire isolator preparation phase.
+  f = metrics.prepare.time(f);
+
   containers_[containerId]->launchInfos = f;
 
   return f;
@@ -831,13 +888,14 @@ Future<Nothing> MesosContainerizerProcess::fetch(
     return Failure("Container is already destroyed");
   }
 
-  return fetcher->fetch(
-      containerId,
-      commandInfo,
-      directory,
-      user,
-      slaveId,
-      flags);
+  return metrics.fetch.time(
+      fetcher->fetch(
+          containerId,
+          commandInfo,
+          directory,
+          user,
+          slaveId,
+          flags));
 }
 
 
@@ -922,6 +980,14 @@ Future<bool> MesosContainerizerProcess::__launch(
   JSON::Object commands;
   commands.values["commands"] = commandArray;
 
+  // Start fetching the URIs into the sandbox. The download only
+  // needs the sandbox directory, so it proceeds concurrently with
+  // preparing the logger, forking and isolating the container
+  // below; 'exec' waits for it. This overlaps the download latency
+  // with the rest of the launch path.
+  Future<Nothing> fetched = fetch(
+      containerId, executorInfo.command(), directory, user, slaveId);
+
   return logger->prepare(executorInfo, directory)
     .then(defer(
         self(),
@@ -1002,13 +1068,7 @@ Future<bool> MesosContainerizerProcess::__launch(
     containers_[containerId]->status = status;
 
     return isolate(containerId, pid)
-      .then(defer(self(),
-                  &Self::fetch,
-                  containerId,
-                  executorInfo.command(),
-                  directory,
-                  user,
-                  slaveId))
+      .then(defer(self(), [=]() { return fetched; }))
       .then(defer(self(), &Self::exec, containerId, pipes[1]))
       .onAny(lambda::bind(&os::close, pipes[0]))
       .onAny(lambda::bind(&os::close, pipes[1]));
@@ -1040,7 +1100,7 @@ Future<bool> MesosContainerizerProcess::isolate(
   }
 
   // Wait for all isolators to complete.
-  Future<list<Nothing>> future = collect(futures);
+  Future<list<Nothing>> future = metrics.isolate.time(collect(futures));
 
   containers_[containerId]->isolation = future;
 
@@ -1190,6 +1250,96 @@ Future<ResourceStatistics> MesosContainerizerProcess::usage(
 }
 
 
+// Statistics from each isolator's batch are merged per container;
+// resources are used to set the limit fields as in '_usage' above.
+Future<hashmap<ContainerID, ResourceStatistics>> _usages(
+    const hashmap<ContainerID, Option<Resources>>& resources,
+    const list<Future<hashmap<ContainerID, ResourceStatistics>>>& statistics)
+{
+  // NOTE: The typedef keeps the comma in the map type from
+  // confusing the 'foreach' macro below.
+  typedef hashmap<ContainerID, ResourceStatistics> Statistics;
+
+  Statistics result;
+
+  // Set the timestamp now we have all statistics.
+  double timestamp = Clock::now().secs();
+
+  foreachkey (const ContainerID& containerId, resources) {
+    result[containerId].set_timestamp(timestamp);
+  }
+
+  foreach (const Future<Statistics>& statistic, statistics) {
+    if (statistic.isReady()) {
+      foreachpair (const ContainerID& containerId,
+                   const ResourceStatistics& _statistic,
+                   statistic.get()) {
+        if (result.contains(containerId)) {
+          result[containerId].MergeFrom(_statistic);
+        }
+      }
+    } else {
+      LOG(WARNING) << "Skipping batched resource statistics because: "
+                   << (statistic.isFailed() ? statistic.failure()
+                                            : "discarded");
+    }
+  }
+
+  foreachpair (const ContainerID& containerId,
+               const Option<Resources>& resources_,
+               resources) {
+    if (resources_.isSome()) {
+      // Set the resource allocations.
+      Option<Bytes> mem = resources_.get().mem();
+      if (mem.isSome()) {
+        result[containerId].set_mem_limit_bytes(mem.get().bytes());
+      }
+
+      Option<double> cpus = resources_.get().cpus();
+      if (cpus.isSome()) {
+        result[containerId].set_cpus_limit(cpus.get());
+      }
+    }
+  }
+
+  return result;
+}
+
+
+Future<hashmap<ContainerID, ResourceStatistics>>
+MesosContainerizerProcess::usages(const vector<ContainerID>& containerIds)
+{
+  // Skip containers that are unknown, e.g., because they were
+  // destroyed after the caller enumerated the containers, rather
+  // than failing the whole batch. We also snapshot the resources
+  // here since containers may be destroyed while we await the
+  // isolators.
+  vector<ContainerID> known;
+  hashmap<ContainerID, Option<Resources>> resources;
+
+  foreach (const ContainerID& containerId, containerIds) {
+    if (containers_.contains(containerId)) {
+      known.push_back(containerId);
+      resources[containerId] = containers_[containerId]->resources;
+    } else {
+      LOG(WARNING) << "Skipping usage for unknown container: " << containerId;
+    }
+  }
+
+  // Ask each isolator for the statistics of the whole batch so the
+  // cost is one dispatch per isolator rather than one per container
+  // and isolator pair.
+  list<Future<hashmap<ContainerID, ResourceStatistics>>> futures;
+  foreach (const Owned<Isolator>& isolator, isolators) {
+    futures.push_back(isolator->usages(known));
+  }
+
+  // Use await() here so we can return partial usage statistics.
+  return await(futures)
+    .then(lambda::bind(_usages, resources, lambda::_1));
+}
+
+
 void MesosContainerizerProcess::destroy(
     const ContainerID& containerId)
 {
@@ -1207,6 +1357,11 @@ void MesosContainerizerProcess::destroy(
 
   LOG(INFO) << "Destroying container '" << containerId << "'";
 
+  // NOTE: The fetch runs concurrently with forking and isolating
+  // the container, so an in-flight fetch may exist in any state up
+  // to RUNNING. Killing it when there is none is a no-op.
+  fetcher->kill(containerId);
+
   if (container->state == PREPARING) {
     VLOG(1) << "Waiting for the isolators to complete preparing before "
             << "destroying the container";
@@ -1228,10 +1383,6 @@ void MesosContainerizerProcess::destroy(
     return;
   }
 
-  if (container->state == FETCHING) {
-    fetcher->kill(containerId);
-  }
-
   if (container->state == ISOLATING) {
     VLOG(1) << "Waiting for the isolators to complete for container '"
             << containerId << "'";
@@ -1254,9 +1405,53 @@ void MesosContainerizerProcess::destroy(
 void MesosContainerizerProcess::_destroy(
     const ContainerID& containerId)
 {
+  // Queue the container so the launcher can kill the processes of
+  // multiple containers in one bounded batch. This keeps a mass
+  // teardown (e.g., draining a slave running hundreds of executors)
+  // from issuing that many concurrent destroys while still letting
+  // each batch complete with its slowest container.
+  pendingDestroys.push_back(containerId);
+
+  destroyBatch();
+}
+
+
+void MesosContainerizerProcess::destroyBatch()
+{
+  if (pendingDestroys.empty() ||
+      activeDestroys >= flags.container_destroy_parallelism) {
+    return;
+  }
+
+  vector<ContainerID> batch;
+  while (!pendingDestroys.empty() &&
+         activeDestroys < flags.container_destroy_parallelism) {
+    batch.push_back(pendingDestroys.front());
+    pendingDestroys.pop_front();
+    activeDestroys++;
+  }
+
   // Kill all processes then continue destruction.
-  launcher->destroy(containerId)
-    .onAny(defer(self(), &Self::__destroy, containerId, lambda::_1));
+  launcher->destroy(batch)
+    .onAny(defer(self(), &Self::_destroyBatch, batch, lambda::_1));
+}
+
+
+void MesosContainerizerProcess::_destroyBatch(
+    const vector<ContainerID>& batch,
+    const Future<Nothing>& future)
+{
+  CHECK_GE(activeDestroys, batch.size());
+
+  activeDestroys -= batch.size();
+
+  // NOTE: If the launcher failed the batch then the shared failure
+  // is reported for each container in it.
+  foreach (const ContainerID& containerId, batch) {
+    __destroy(containerId, future);
+  }
+
+  destroyBatch();
 }
 
 
@@ -1464,15 +1659,30 @@ Future<hashset<ContainerID>> MesosContainerizerProcess::containers()
 
 MesosContainerizerProcess::Metrics::Metrics()
   : container_destroy_errors(
-        "containerizer/mesos/container_destroy_errors")
+        "containerizer/mesos/container_destroy_errors"),
+    launch("containerizer/mesos/launch", Hours(1)),
+    provision("containerizer/mesos/provision", Hours(1)),
+    prepare("containerizer/mesos/prepare", Hours(1)),
+    fetch("containerizer/mesos/fetch", Hours(1)),
+    isolate("containerizer/mesos/isolate", Hours(1))
 {
   process::metrics::add(container_destroy_errors);
+  process::metrics::add(launch);
+  process::metrics::add(provision);
+  process::metrics::add(prepare);
+  process::metrics::add(fetch);
+  process::metrics::add(isolate);
 }
 
 
 MesosContainerizerProcess::Metrics::~Metrics()
 {
   process::metrics::remove(container_destroy_errors);
+  process::metrics::remove(launch);
+  process::metrics::remove(provision);
+  process::metrics::remove(prepare);
+  process::metrics::remove(fetch);
+  process::metrics::remove(isolate);
 }
 
 
@@ -24,7 +24,9 @@
 #include <mesos/slave/isolator.hpp>
 
 #include <process/metrics/counter.hpp>
+#include <process/metrics/timer.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/multihashmap.hpp>
 
@@ -96,6 +98,9 @@ public:
   virtual process::Future<ResourceStatistics> usage(
       const ContainerID& containerId);
 
+  virtual process::Future<hashmap<ContainerID, ResourceStatistics>> usages(
+      const std::vector<ContainerID>& containerIds);
+
   virtual process::Future<containerizer::Termination> wait(
       const ContainerID& containerId);
 
@@ -126,7 +131,8 @@ public:
       logger(_logger),
       launcher(_launcher),
       provisioner(_provisioner),
-      isolators(_isolators) {}
+      isolators(_isolators),
+      activeDestroys(0) {}
 
   virtual ~MesosContainerizerProcess() {}
 
@@ -150,6 +156,9 @@ public:
   virtual process::Future<ResourceStatistics> usage(
       const ContainerID& containerId);
 
+  virtual process::Future<hashmap<ContainerID, ResourceStatistics>> usages(
+      const std::vector<ContainerID>& containerIds);
+
   virtual process::Future<containerizer::Termination> wait(
       const ContainerID& containerId);
 
@@ -224,6 +233,17 @@ private:
   // Continues 'destroy()' once isolators has completed.
   void _destroy(const ContainerID& containerId);
 
+  // Issues launcher destroys for the queued containers, in batches
+  // bounded by --container_destroy_parallelism.
+  void destroyBatch();
+
+  // Continues 'destroyBatch()' once the launcher has destroyed the
+  // batch; resumes the per container destroy chains and issues the
+  // next batch (if any).
+  void _destroyBatch(
+      const std::vector<ContainerID>& batch,
+      const process::Future<Nothing>& future);
+
   // Continues '_destroy()' once all processes have been killed by the launcher.
   void __destroy(
       const ContainerID& containerId,
@@ -277,7 +297,6 @@ private:
   {
     PREPARING,
     ISOLATING,
-    FETCHING,
     RUNNING,
     DESTROYING
   };
@@ -319,12 +338,28 @@ private:
 
   hashmap<ContainerID, process::Owned<Container>> containers_;
 
+  // Containers queued for destruction by the launcher and the number
+  // of containers the launcher is currently destroying, used to
+  // bound the parallelism of container teardown (see
+  // 'destroyBatch()').
+  std::list<ContainerID> pendingDestroys;
+  size_t activeDestroys;
+
   struct Metrics
   {
     Metrics();
     ~Metrics();
 
     process::metrics::Counter container_destroy_errors;
+
+    // Stage-level launch latency timers, used to see where container
+    // startup time goes (e.g., provisioning vs. isolator preparation
+    // vs. fetching).
+    process::metrics::Timer<Milliseconds> launch;
+    process::metrics::Timer<Milliseconds> provision;
+    process::metrics::Timer<Milliseconds> prepare;
+    process::metrics::Timer<Milliseconds> fetch;
+    process::metrics::Timer<Milliseconds> isolate;
   } metrics;
 };
 
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <process/collect.hpp>
 #include <process/dispatch.hpp>
 
 #include "slave/containerizer/mesos/isolator.hpp"
@@ -22,6 +23,7 @@ using namespace process;
 
 using std::string;
 using std::list;
+using std::vector;
 
 using mesos::slave::ContainerConfig;
 using mesos::slave::ContainerLaunchInfo;
@@ -57,6 +59,14 @@ Future<Nothing> MesosIsolator::recover(
 }
 
 
+bool MesosIsolator::supportsParallelPrepare()
+{
+  // NOTE: This is a constant property of the isolator so we query
+  // the process directly rather than dispatching.
+  return process->supportsParallelPrepare();
+}
+
+
 Future<Option<ContainerLaunchInfo>> MesosIsolator::prepare(
     const ContainerID& containerId,
     const ExecutorInfo& executorInfo,
@@ -110,6 +120,15 @@ Future<ResourceStatistics> MesosIsolator::usage(
 }
 
 
+Future<hashmap<ContainerID, ResourceStatistics>> MesosIsolator::usages(
+    const vector<ContainerID>& containerIds)
+{
+  return dispatch(process.get(),
+                  &MesosIsolatorProcess::usages,
+                  containerIds);
+}
+
+
 Future<Nothing> MesosIsolator::cleanup(
     const ContainerID& containerId)
 {
@@ -118,6 +137,35 @@ Future<Nothing> MesosIsolator::cleanup(
                   containerId);
 }
 
+
+Future<hashmap<ContainerID, ResourceStatistics>> MesosIsolatorProcess::usages(
+    const vector<ContainerID>& containerIds)
+{
+  // NOTE: 'usage' is invoked directly since we are already executing
+  // within the isolator process, so the whole batch incurs a single
+  // dispatch.
+  list<Future<ResourceStatistics>> futures;
+  foreach (const ContainerID& containerId, containerIds) {
+    futures.push_back(usage(containerId));
+  }
+
+  return await(futures)
+    .then([containerIds](const list<Future<ResourceStatistics>>& futures)
+            -> hashmap<ContainerID, ResourceStatistics> {
+      hashmap<ContainerID, ResourceStatistics> statistics;
+
+      size_t i = 0;
+      foreach (const Future<ResourceStatistics>& future, futures) {
+        if (future.isReady()) {
+          statistics.put(containerIds[i], future.get());
+        }
+        i++;
+      }
+
+      return statistics;
+    });
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
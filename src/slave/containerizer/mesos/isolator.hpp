@@ -45,6 +45,8 @@ public:
       const std::list<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans);
 
+  virtual bool supportsParallelPrepare();
+
   virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const ExecutorInfo& executorInfo,
@@ -64,6 +66,9 @@ public:
   virtual process::Future<ResourceStatistics> usage(
       const ContainerID& containerId);
 
+  virtual process::Future<hashmap<ContainerID, ResourceStatistics>> usages(
+      const std::vector<ContainerID>& containerIds);
+
   virtual process::Future<Nothing> cleanup(
       const ContainerID& containerId);
 
@@ -81,6 +86,8 @@ public:
       const std::list<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans) = 0;
 
+  virtual bool supportsParallelPrepare() { return false; }
+
   virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const ExecutorInfo& executorInfo,
@@ -100,6 +107,13 @@ public:
   virtual process::Future<ResourceStatistics> usage(
       const ContainerID& containerId) = 0;
 
+  // Gathers statistics for all the given containers with a single
+  // dispatch to the isolator process. The default implementation
+  // calls 'usage' for each container from within the process, i.e.,
+  // without any further dispatches.
+  virtual process::Future<hashmap<ContainerID, ResourceStatistics>> usages(
+      const std::vector<ContainerID>& containerIds);
+
   virtual process::Future<Nothing> cleanup(
       const ContainerID& containerId) = 0;
 };
@@ -0,0 +1,609 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <math.h>
+
+#include <algorithm>
+#include <list>
+#include <set>
+#include <vector>
+
+#include <process/defer.hpp>
+#include <process/future.hpp>
+#include <process/pid.hpp>
+
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+#include <stout/try.hpp>
+
+#include "linux/cgroups.hpp"
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/isolators/cgroups/cpuset.hpp"
+
+using std::list;
+using std::set;
+using std::string;
+using std::vector;
+
+using process::Failure;
+using process::Future;
+using process::Owned;
+using process::PID;
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerLaunchInfo;
+using mesos::slave::ContainerLimitation;
+using mesos::slave::ContainerState;
+using mesos::slave::Isolator;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Parses a kernel cpu list, e.g., "0-3,8,10-11".
+static Try<set<unsigned int>> parseCpuList(const string& list)
+{
+  set<unsigned int> cpus;
+
+  foreach (const string& token, strings::tokenize(strings::trim(list), ",")) {
+    const vector<string> range = strings::tokenize(token, "-");
+
+    if (range.size() == 1) {
+      Try<unsigned int> cpu = numify<unsigned int>(range[0]);
+      if (cpu.isError()) {
+        return Error("Failed to parse cpu '" + token + "': " + cpu.error());
+      }
+
+      cpus.insert(cpu.get());
+    } else if (range.size() == 2) {
+      Try<unsigned int> begin = numify<unsigned int>(range[0]);
+      Try<unsigned int> end = numify<unsigned int>(range[1]);
+
+      if (begin.isError() || end.isError() || begin.get() > end.get()) {
+        return Error("Failed to parse cpu range '" + token + "'");
+      }
+
+      for (unsigned int cpu = begin.get(); cpu <= end.get(); cpu++) {
+        cpus.insert(cpu);
+      }
+    } else {
+      return Error("Failed to parse cpu range '" + token + "'");
+    }
+  }
+
+  return cpus;
+}
+
+
+// Formats cpus as a kernel cpu list. The kernel accepts a plain
+// comma separated list, so ranges are not collapsed.
+static string formatCpuList(const vector<unsigned int>& cpus)
+{
+  vector<string> tokens;
+  foreach (unsigned int cpu, cpus) {
+    tokens.push_back(stringify(cpu));
+  }
+
+  return strings::join(",", tokens);
+}
+
+
+CgroupsCpusetIsolatorProcess::CgroupsCpusetIsolatorProcess(
+    const Flags& _flags,
+    const string& _hierarchy,
+    const vector<Domain>& _domains)
+  : flags(_flags),
+    hierarchy(_hierarchy),
+    domains(_domains) {}
+
+
+CgroupsCpusetIsolatorProcess::~CgroupsCpusetIsolatorProcess() {}
+
+
+Try<Isolator*> CgroupsCpusetIsolatorProcess::create(const Flags& flags)
+{
+  Try<string> hierarchy = cgroups::prepare(
+      flags.cgroups_hierarchy,
+      "cpuset",
+      flags.cgroups_root);
+
+  if (hierarchy.isError()) {
+    return Error("Failed to create cpuset cgroup: " + hierarchy.error());
+  }
+
+  // Ensure that no other subsystem is attached to the hierarchy.
+  Try<set<string>> subsystems = cgroups::subsystems(hierarchy.get());
+  if (subsystems.isError()) {
+    return Error(
+        "Failed to get the list of attached subsystems for hierarchy " +
+        hierarchy.get());
+  } else if (subsystems.get().size() != 1) {
+    return Error(
+        "Unexpected subsystems found attached to the hierarchy " +
+        hierarchy.get());
+  }
+
+  Try<vector<Domain>> domains = parseTopology();
+  if (domains.isError()) {
+    return Error("Failed to parse the cpu topology: " + domains.error());
+  }
+
+  LOG(INFO) << "Placing containers onto " << domains.get().size()
+            << " last level cache domains";
+
+  process::Owned<MesosIsolatorProcess> process(
+      new CgroupsCpusetIsolatorProcess(flags, hierarchy.get(), domains.get()));
+
+  return new MesosIsolator(process);
+}
+
+
+Try<vector<CgroupsCpusetIsolatorProcess::Domain>>
+CgroupsCpusetIsolatorProcess::parseTopology()
+{
+  Try<string> online = os::read("/sys/devices/system/cpu/online");
+  if (online.isError()) {
+    return Error("Failed to read the online cpus: " + online.error());
+  }
+
+  Try<set<unsigned int>> cpus = parseCpuList(online.get());
+  if (cpus.isError()) {
+    return Error("Failed to parse the online cpus: " + cpus.error());
+  }
+
+  // Group the cpus by the set of cpus they share their last level
+  // cache with. If the kernel does not expose the cache topology
+  // (e.g., in some virtualized environments), fall back to grouping
+  // by physical package, which bounds socket-crossing placement.
+  vector<Domain> domains;
+  hashmap<string, size_t> ids;
+
+  foreach (unsigned int cpu, cpus.get()) {
+    const string prefix =
+      "/sys/devices/system/cpu/cpu" + stringify(cpu) + "/";
+
+    string path = prefix + "cache/index3/shared_cpu_list";
+    if (!os::exists(path)) {
+      path = prefix + "topology/core_siblings_list";
+    }
+
+    Try<string> siblings = os::read(path);
+    if (siblings.isError()) {
+      return Error(
+          "Failed to read '" + path + "': " + siblings.error());
+    }
+
+    const string id = strings::trim(siblings.get());
+
+    if (!ids.contains(id)) {
+      ids[id] = domains.size();
+
+      Domain domain;
+      domain.id = id;
+      domains.push_back(domain);
+    }
+
+    domains[ids[id]].cpus.push_back(cpu);
+  }
+
+  return domains;
+}
+
+
+Try<vector<unsigned int>> CgroupsCpusetIsolatorProcess::allocate(size_t count)
+{
+  // Best fit: of the domains that can hold the whole container, pick
+  // the one with the fewest free cpus, preserving larger free
+  // domains for larger containers.
+  Option<size_t> candidate = None();
+
+  size_t free = 0;
+
+  for (size_t i = 0; i < domains.size(); i++) {
+    size_t _free = domains[i].cpus.size() - domains[i].used.size();
+    free += _free;
+
+    if (_free >= count &&
+        (candidate.isNone() ||
+         _free < domains[candidate.get()].cpus.size() -
+                 domains[candidate.get()].used.size())) {
+      candidate = i;
+    }
+  }
+
+  if (free < count) {
+    return Error(
+        "Only " + stringify(free) + " of the requested " + stringify(count) +
+        " cpus are free");
+  }
+
+  vector<unsigned int> allocated;
+
+  if (candidate.isSome()) {
+    Domain& domain = domains[candidate.get()];
+
+    foreach (unsigned int cpu, domain.cpus) {
+      if (allocated.size() == count) {
+        break;
+      }
+
+      if (!domain.used.contains(cpu)) {
+        domain.used.insert(cpu);
+        allocated.push_back(cpu);
+      }
+    }
+
+    return allocated;
+  }
+
+  // The container does not fit in any single domain: span the
+  // emptiest domains so that the fewest caches are shared.
+  while (allocated.size() < count) {
+    Option<size_t> emptiest = None();
+
+    for (size_t i = 0; i < domains.size(); i++) {
+      size_t _free = domains[i].cpus.size() - domains[i].used.size();
+
+      if (_free > 0 &&
+          (emptiest.isNone() ||
+           _free > domains[emptiest.get()].cpus.size() -
+                   domains[emptiest.get()].used.size())) {
+        emptiest = i;
+      }
+    }
+
+    CHECK_SOME(emptiest);
+
+    Domain& domain = domains[emptiest.get()];
+
+    foreach (unsigned int cpu, domain.cpus) {
+      if (allocated.size() == count) {
+        break;
+      }
+
+      if (!domain.used.contains(cpu)) {
+        domain.used.insert(cpu);
+        allocated.push_back(cpu);
+      }
+    }
+  }
+
+  return allocated;
+}
+
+
+void CgroupsCpusetIsolatorProcess::deallocate(const vector<unsigned int>& cpus)
+{
+  foreach (unsigned int cpu, cpus) {
+    foreach (Domain& domain, domains) {
+      domain.used.erase(cpu);
+    }
+  }
+}
+
+
+Future<Nothing> CgroupsCpusetIsolatorProcess::recover(
+    const list<ContainerState>& states,
+    const hashset<ContainerID>& orphans)
+{
+  foreach (const ContainerState& state, states) {
+    const ContainerID& containerId = state.container_id();
+    const string cgroup = path::join(flags.cgroups_root, containerId.value());
+
+    Try<bool> exists = cgroups::exists(hierarchy, cgroup);
+    if (exists.isError()) {
+      infos.clear();
+      return Failure("Failed to check cgroup for container '" +
+                     stringify(containerId) + "'");
+    }
+
+    if (!exists.get()) {
+      VLOG(1) << "Couldn't find cgroup for container " << containerId;
+      // This may occur if the executor has exited and the isolator
+      // has destroyed the cgroup but the slave dies before noticing
+      // this. This will be detected when the containerizer tries to
+      // monitor the executor's pid.
+      continue;
+    }
+
+    Info info(cgroup);
+
+    // Re-mark the cpus assigned to the container as used. A container
+    // whose cpuset spans the whole machine was running unpinned.
+    Try<string> control = cgroups::read(hierarchy, cgroup, "cpuset.cpus");
+    if (control.isError()) {
+      infos.clear();
+      return Failure("Failed to read 'cpuset.cpus' for container '" +
+                     stringify(containerId) + "': " + control.error());
+    }
+
+    Try<set<unsigned int>> assigned = parseCpuList(control.get());
+    if (assigned.isError()) {
+      infos.clear();
+      return Failure("Failed to parse 'cpuset.cpus' for container '" +
+                     stringify(containerId) + "': " + assigned.error());
+    }
+
+    size_t total = 0;
+    foreach (const Domain& domain, domains) {
+      total += domain.cpus.size();
+    }
+
+    if (assigned.get().size() < total) {
+      foreach (Domain& domain, domains) {
+        foreach (unsigned int cpu, domain.cpus) {
+          if (assigned.get().count(cpu) > 0) {
+            domain.used.insert(cpu);
+            info.cpus.push_back(cpu);
+          }
+        }
+      }
+    }
+
+    infos.emplace(containerId, info);
+  }
+
+  // Remove orphan cgroups.
+  Try<vector<string>> cgroups = cgroups::get(hierarchy, flags.cgroups_root);
+  if (cgroups.isError()) {
+    infos.clear();
+    return Failure(cgroups.error());
+  }
+
+  foreach (const string& cgroup, cgroups.get()) {
+    // Ignore the slave cgroup (see the --slave_subsystems flag).
+    // TODO(idownes): Remove this when the cgroups layout is updated,
+    // see MESOS-1185.
+    if (cgroup == path::join(flags.cgroups_root, "slave")) {
+      continue;
+    }
+
+    ContainerID containerId;
+    containerId.set_value(Path(cgroup).basename());
+
+    if (infos.contains(containerId)) {
+      continue;
+    }
+
+    // Known orphan cgroups will be destroyed by the containerizer
+    // using the normal cleanup path. See MESOS-2367 for details.
+    if (orphans.contains(containerId)) {
+      infos.emplace(containerId, Info(cgroup));
+      continue;
+    }
+
+    LOG(INFO) << "Removing unknown orphaned cgroup '" << cgroup << "'";
+
+    // We don't wait on the destroy as we don't want to block recovery.
+    cgroups::destroy(hierarchy, cgroup, cgroups::DESTROY_TIMEOUT);
+  }
+
+  return Nothing();
+}
+
+
+Future<Option<ContainerLaunchInfo>> CgroupsCpusetIsolatorProcess::prepare(
+    const ContainerID& containerId,
+    const ExecutorInfo& executorInfo,
+    const ContainerConfig& containerConfig)
+{
+  if (infos.contains(containerId)) {
+    return Failure("Container has already been prepared");
+  }
+
+  // Use this info to create the cgroup, but do not insert it into
+  // infos till the cgroup has been created successfully.
+  Info info(path::join(flags.cgroups_root, containerId.value()));
+
+  // Create a cgroup for this container. Note that the created cgroup
+  // inherits the machine's 'cpuset.cpus' and 'cpuset.mems'; 'update'
+  // narrows 'cpuset.cpus' to the cores assigned to the container.
+  Try<bool> exists = cgroups::exists(hierarchy, info.cgroup);
+  if (exists.isError()) {
+    return Failure("Failed to check if the cgroup already exists: " +
+                   exists.error());
+  } else if (exists.get()) {
+    return Failure("The cgroup already exists");
+  }
+
+  Try<Nothing> create = cgroups::create(hierarchy, info.cgroup);
+  if (create.isError()) {
+    return Failure("Failed to create the cgroup: " + create.error());
+  }
+
+  // 'chown' the cgroup so the executor can create nested cgroups. Do
+  // not recurse so the control files are still owned by the slave
+  // user and thus cannot be changed by the executor.
+  if (containerConfig.has_user()) {
+    Try<Nothing> chown = os::chown(
+        containerConfig.user(),
+        path::join(hierarchy, info.cgroup),
+        false);
+
+    if (chown.isError()) {
+      return Failure("Failed to change ownership of cgroup hierarchy: " +
+                     chown.error());
+    }
+  }
+
+  infos.emplace(containerId, info);
+
+  return update(containerId, executorInfo.resources())
+    .then([]() -> Future<Option<ContainerLaunchInfo>> {
+      return None();
+    });
+}
+
+
+Future<Nothing> CgroupsCpusetIsolatorProcess::isolate(
+    const ContainerID& containerId,
+    pid_t pid)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const Info& info = infos.at(containerId);
+
+  Try<Nothing> assign = cgroups::assign(hierarchy, info.cgroup, pid);
+  if (assign.isError()) {
+    return Failure("Failed to assign container '" +
+                   stringify(containerId) + "' to its own cgroup '" +
+                   path::join(hierarchy, info.cgroup) +
+                   "': " + assign.error());
+  }
+
+  return Nothing();
+}
+
+
+// Pinning is advisory placement, not a limitation: a container that
+// saturates its cores is throttled by 'cgroups/cpu', not killed. This
+// function therefore always returns a pending future.
+Future<ContainerLimitation> CgroupsCpusetIsolatorProcess::watch(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  return Future<ContainerLimitation>();
+}
+
+
+Future<Nothing> CgroupsCpusetIsolatorProcess::update(
+    const ContainerID& containerId,
+    const Resources& resources)
+{
+  if (resources.cpus().isNone()) {
+    return Failure("No cpus resource given");
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  Info& info = infos.at(containerId);
+
+  // A container gets a core per requested cpu; fractional remainders
+  // round up since the container may run threads on every core it is
+  // given.
+  size_t count = std::max(
+      static_cast<size_t>(ceil(resources.cpus().get())), (size_t) 1);
+
+  if (info.cpus.size() == count) {
+    return Nothing();
+  }
+
+  deallocate(info.cpus);
+  info.cpus.clear();
+
+  Try<vector<unsigned int>> allocated = allocate(count);
+
+  if (allocated.isError()) {
+    // The machine's cores are oversubscribed: run the container
+    // unpinned on the full machine cpuset rather than refusing to
+    // launch it; 'cgroups/cpu' still enforces its share.
+    LOG(WARNING) << "Failed to pin container " << containerId
+                 << " onto " << count << " cpus: " << allocated.error()
+                 << "; running it unpinned";
+
+    vector<unsigned int> all;
+    foreach (const Domain& domain, domains) {
+      foreach (unsigned int cpu, domain.cpus) {
+        all.push_back(cpu);
+      }
+    }
+
+    Try<Nothing> write = cgroups::write(
+        hierarchy, info.cgroup, "cpuset.cpus", formatCpuList(all));
+
+    if (write.isError()) {
+      return Failure("Failed to update 'cpuset.cpus': " + write.error());
+    }
+
+    return Nothing();
+  }
+
+  Try<Nothing> write = cgroups::write(
+      hierarchy,
+      info.cgroup,
+      "cpuset.cpus",
+      formatCpuList(allocated.get()));
+
+  if (write.isError()) {
+    deallocate(allocated.get());
+    return Failure("Failed to update 'cpuset.cpus': " + write.error());
+  }
+
+  info.cpus = allocated.get();
+
+  LOG(INFO) << "Updated 'cpuset.cpus' to " << formatCpuList(info.cpus)
+            << " (cpus " << resources.cpus().get() << ")"
+            << " for container " << containerId;
+
+  return Nothing();
+}
+
+
+// Cpu time accounting is provided by 'cgroups/cpu'; placement has no
+// notion of usage, so an empty 'ResourceStatistics' is returned.
+Future<ResourceStatistics> CgroupsCpusetIsolatorProcess::usage(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  return ResourceStatistics();
+}
+
+
+Future<Nothing> CgroupsCpusetIsolatorProcess::cleanup(
+    const ContainerID& containerId)
+{
+  // Multiple calls may occur during test clean up.
+  if (!infos.contains(containerId)) {
+    VLOG(1) << "Ignoring cleanup request for unknown container: "
+            << containerId;
+    return Nothing();
+  }
+
+  const Info& info = infos.at(containerId);
+
+  // Return the container's cores to their domains. Together with the
+  // best-fit allocation above this keeps free cores clustered within
+  // domains as containers come and go; running containers are never
+  // migrated, since moving them across caches would cause the very
+  // misses the isolator exists to avoid.
+  deallocate(info.cpus);
+
+  return cgroups::destroy(hierarchy, info.cgroup, cgroups::DESTROY_TIMEOUT)
+    .then(defer(PID<CgroupsCpusetIsolatorProcess>(this), [=]() {
+      infos.erase(containerId);
+      return Nothing();
+    }));
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
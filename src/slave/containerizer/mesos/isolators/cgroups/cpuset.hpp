@@ -0,0 +1,135 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __CGROUPS_CPUSET_ISOLATOR_HPP__
+#define __CGROUPS_CPUSET_ISOLATOR_HPP__
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "slave/containerizer/mesos/isolator.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Uses the Linux cpuset subsystem to pin containers onto cores.
+// Unlike 'cgroups/cpu' (which only controls how much cpu time a
+// container gets), this isolator controls where a container runs:
+// each container is given ceil(cpus) cores chosen from as few last
+// level cache (LLC) domains as possible, so that its threads are not
+// migrated across caches by the scheduler. Identical containers can
+// otherwise differ substantially in throughput depending on whether
+// their threads happen to share a cache.
+//
+// If the agent's cpus are oversubscribed and no cores are free, a
+// container falls back to the full machine cpuset (i.e., it runs
+// unpinned); 'cgroups/cpu' still enforces its share.
+class CgroupsCpusetIsolatorProcess : public MesosIsolatorProcess
+{
+public:
+  static Try<mesos::slave::Isolator*> create(const Flags& flags);
+
+  virtual ~CgroupsCpusetIsolatorProcess();
+
+  virtual process::Future<Nothing> recover(
+      const std::list<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans);
+
+  virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
+      const ContainerID& containerId,
+      const ExecutorInfo& executorInfo,
+      const mesos::slave::ContainerConfig& containerConfig);
+
+  virtual process::Future<Nothing> isolate(
+      const ContainerID& containerId,
+      pid_t pid);
+
+  virtual process::Future<mesos::slave::ContainerLimitation> watch(
+      const ContainerID& containerId);
+
+  virtual process::Future<Nothing> update(
+      const ContainerID& containerId,
+      const Resources& resources);
+
+  virtual process::Future<ResourceStatistics> usage(
+      const ContainerID& containerId);
+
+  virtual process::Future<Nothing> cleanup(
+      const ContainerID& containerId);
+
+private:
+  // A set of cpus sharing a last level cache (or, if the cache
+  // topology is not exposed by the kernel, a physical package).
+  struct Domain
+  {
+    std::string id;
+    std::vector<unsigned int> cpus;
+    hashset<unsigned int> used;
+  };
+
+  CgroupsCpusetIsolatorProcess(
+      const Flags& flags,
+      const std::string& hierarchy,
+      const std::vector<Domain>& domains);
+
+  // Groups the online cpus into last level cache domains by parsing
+  // the cache (or, failing that, package) topology under
+  // /sys/devices/system/cpu.
+  static Try<std::vector<Domain>> parseTopology();
+
+  // Picks 'count' cpus from as few domains as possible: a domain that
+  // fits the whole container is chosen best-fit (fewest free cpus
+  // that still suffice) so that larger free domains are preserved for
+  // larger containers; a container that cannot fit in one domain
+  // spans the emptiest domains. Returns an error if fewer than
+  // 'count' cpus are free.
+  Try<std::vector<unsigned int>> allocate(size_t count);
+
+  // Returns the given cpus to their domains.
+  void deallocate(const std::vector<unsigned int>& cpus);
+
+  struct Info
+  {
+    Info(const std::string& _cgroup)
+      : cgroup(_cgroup) {}
+
+    const std::string cgroup;
+
+    // The cpus assigned to the container; empty if the container runs
+    // unpinned on the full machine cpuset.
+    std::vector<unsigned int> cpus;
+  };
+
+  const Flags flags;
+
+  const std::string hierarchy;
+
+  std::vector<Domain> domains;
+
+  hashmap<ContainerID, Info> infos;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __CGROUPS_CPUSET_ISOLATOR_HPP__
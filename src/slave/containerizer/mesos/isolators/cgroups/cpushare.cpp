@@ -465,14 +465,32 @@ Future<ResourceStatistics> CgroupsCpushareIsolatorProcess::usage(
 
   PCHECK(ticks > 0) << "Failed to get sysconf(_SC_CLK_TCK)";
 
-  // Add the cpuacct.stat information.
-  Try<hashmap<string, uint64_t>> stat = cgroups::stat(
-      hierarchies["cpuacct"],
-      info->cgroup,
-      "cpuacct.stat");
+  // Add the cpuacct.stat information (and cpu.stat if CFS is
+  // enabled). The 'cpu' and 'cpuacct' subsystems are typically
+  // co-mounted, in which case both stat files are read in a single
+  // batched pass over the cgroup.
+  vector<string> controls;
+  controls.push_back("cpuacct.stat");
+
+  bool batched =
+    flags.cgroups_enable_cfs && hierarchies["cpu"] == hierarchies["cpuacct"];
+
+  if (batched) {
+    controls.push_back("cpu.stat");
+  }
+
+  Try<hashmap<string, string>> snapshot =
+    cgroups::snapshot(hierarchies["cpuacct"], info->cgroup, controls);
+
+  if (snapshot.isError()) {
+    return Failure("Failed to read cpu statistics: " + snapshot.error());
+  }
+
+  Try<hashmap<string, uint64_t>> stat =
+    cgroups::stat("cpuacct.stat", snapshot.get().at("cpuacct.stat"));
 
   if (stat.isError()) {
-    return Failure("Failed to read cpuacct.stat: " + stat.error());
+    return Failure("Failed to parse cpuacct.stat: " + stat.error());
   }
 
   // TODO(bmahler): Add namespacing to cgroups to enforce the expected
@@ -487,7 +505,10 @@ Future<ResourceStatistics> CgroupsCpushareIsolatorProcess::usage(
 
   // Add the cpu.stat information only if CFS is enabled.
   if (flags.cgroups_enable_cfs) {
-    stat = cgroups::stat(hierarchies["cpu"], info->cgroup, "cpu.stat");
+    stat = batched
+      ? cgroups::stat("cpu.stat", snapshot.get().at("cpu.stat"))
+      : cgroups::stat(hierarchies["cpu"], info->cgroup, "cpu.stat");
+
     if (stat.isError()) {
       return Failure("Failed to read cpu.stat: " + stat.error());
     }
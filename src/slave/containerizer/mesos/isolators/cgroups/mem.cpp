@@ -30,11 +30,13 @@
 #include <stout/check.hpp>
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/stringify.hpp>
+#include <stout/strings.hpp>
 #include <stout/try.hpp>
 
 #include "common/protobuf_utils.hpp"
@@ -418,10 +420,30 @@ Future<ResourceStatistics> CgroupsMemIsolatorProcess::usage(
 
   ResourceStatistics result;
 
+  // Batch the control file reads so that the hierarchy and cgroup
+  // are only verified once per poll, rather than once per file.
+  vector<string> controls;
+  controls.push_back("memory.usage_in_bytes");
+  controls.push_back("memory.stat");
+
+  if (limitSwap) {
+    controls.push_back("memory.memsw.usage_in_bytes");
+  }
+
+  Try<hashmap<string, string>> snapshot =
+    cgroups::snapshot(hierarchy, info->cgroup, controls);
+
+  if (snapshot.isError()) {
+    return Failure("Failed to read memory statistics: " + snapshot.error());
+  }
+
+  const hashmap<string, string>& contents = snapshot.get();
+
   // The rss from memory.stat is wrong in two dimensions:
   //   1. It does not include child cgroups.
   //   2. It does not include any file backed pages.
-  Try<Bytes> usage = cgroups::memory::usage_in_bytes(hierarchy, info->cgroup);
+  Try<Bytes> usage = Bytes::parse(
+      strings::trim(contents.at("memory.usage_in_bytes")) + "B");
   if (usage.isError()) {
     return Failure("Failed to parse memory.usage_in_bytes: " + usage.error());
   }
@@ -429,8 +451,8 @@ Future<ResourceStatistics> CgroupsMemIsolatorProcess::usage(
   result.set_mem_total_bytes(usage.get().bytes());
 
   if (limitSwap) {
-    Try<Bytes> usage =
-      cgroups::memory::memsw_usage_in_bytes(hierarchy, info->cgroup);
+    Try<Bytes> usage = Bytes::parse(
+        strings::trim(contents.at("memory.memsw.usage_in_bytes")) + "B");
     if (usage.isError()) {
       return Failure(
         "Failed to parse memory.memsw.usage_in_bytes: " + usage.error());
@@ -442,9 +464,9 @@ Future<ResourceStatistics> CgroupsMemIsolatorProcess::usage(
   // TODO(bmahler): Add namespacing to cgroups to enforce the expected
   // structure, e.g, cgroups::memory::stat.
   Try<hashmap<string, uint64_t>> stat =
-    cgroups::stat(hierarchy, info->cgroup, "memory.stat");
+    cgroups::stat("memory.stat", contents.at("memory.stat"));
   if (stat.isError()) {
-    return Failure("Failed to read memory.stat: " + stat.error());
+    return Failure("Failed to parse memory.stat: " + stat.error());
   }
 
   Option<uint64_t> total_cache = stat.get().get("total_cache");
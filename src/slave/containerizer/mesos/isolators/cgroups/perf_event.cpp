@@ -42,6 +42,7 @@
 
 #include "linux/cgroups.hpp"
 #include "linux/perf.hpp"
+#include "linux/perf_sampler.hpp"
 
 #include "slave/containerizer/mesos/isolators/cgroups/perf_event.hpp"
 
@@ -59,6 +60,7 @@ using std::vector;
 using process::Clock;
 using process::Failure;
 using process::Future;
+using process::Owned;
 using process::PID;
 using process::Time;
 
@@ -70,10 +72,6 @@ Try<Isolator*> CgroupsPerfEventIsolatorProcess::create(const Flags& flags)
 {
   LOG(INFO) << "Creating PerfEvent isolator";
 
-  if (!perf::supported()) {
-    return Error("Perf is not supported");
-  }
-
   if (flags.perf_duration > flags.perf_interval) {
     return Error("Sampling perf for duration (" +
                  stringify(flags.perf_duration) +
@@ -92,11 +90,6 @@ Try<Isolator*> CgroupsPerfEventIsolatorProcess::create(const Flags& flags)
     events.insert(event);
   }
 
-  if (!perf::valid(events)) {
-    return Error("Failed to create PerfEvent isolator, invalid events: " +
-                 stringify(events));
-  }
-
   Try<string> hierarchy = cgroups::prepare(
       flags.cgroups_hierarchy,
       "perf_event",
@@ -106,12 +99,38 @@ Try<Isolator*> CgroupsPerfEventIsolatorProcess::create(const Flags& flags)
     return Error("Failed to create perf_event cgroup: " + hierarchy.error());
   }
 
+  // Prefer the in-process sampler: it opens the counters itself with
+  // perf_event_open(2) and never forks the 'perf' binary. Fall back
+  // to forking 'perf' per sample if it cannot be created, e.g., on a
+  // kernel without cgroup-scoped counters.
+  Option<Owned<perf::Sampler>> sampler = None();
+
+  Try<Owned<perf::Sampler>> create =
+    perf::Sampler::create(hierarchy.get(), events);
+
+  if (create.isError()) {
+    LOG(WARNING) << "Failed to create in-process perf sampler, falling"
+                 << " back to the 'perf' binary: " << create.error();
+
+    if (!perf::supported()) {
+      return Error("Perf is not supported");
+    }
+
+    if (!perf::valid(events)) {
+      return Error("Failed to create PerfEvent isolator, invalid events: " +
+                   stringify(events));
+    }
+  } else {
+    sampler = create.get();
+  }
+
   LOG(INFO) << "PerfEvent isolator will profile for " << flags.perf_duration
             << " every " << flags.perf_interval
             << " for events: " << stringify(events);
 
   process::Owned<MesosIsolatorProcess> process(
-      new CgroupsPerfEventIsolatorProcess(flags, hierarchy.get(), events));
+      new CgroupsPerfEventIsolatorProcess(
+          flags, hierarchy.get(), events, sampler));
 
   return new MesosIsolator(process);
 }
@@ -385,7 +404,11 @@ void CgroupsPerfEventIsolatorProcess::sample()
   // reaper interval to ensure we see the perf process exit.
   Duration timeout = flags.perf_duration + process::MAX_REAP_INTERVAL() * 2;
 
-  perf::sample(events, cgroups, flags.perf_duration)
+  Future<hashmap<string, PerfStatistics>> statistics = sampler.isSome()
+    ? sampler.get()->sample(cgroups, flags.perf_duration)
+    : perf::sample(events, cgroups, flags.perf_duration);
+
+  statistics
     .after(timeout,
            lambda::bind(&discardSample,
                         lambda::_1,
@@ -19,10 +19,14 @@
 
 #include <set>
 
+#include <process/owned.hpp>
 #include <process/time.hpp>
 
 #include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
+
+#include "linux/perf_sampler.hpp"
 
 #include "slave/flags.hpp"
 
@@ -43,6 +47,8 @@ public:
       const std::list<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans);
 
+  virtual bool supportsParallelPrepare() { return true; }
+
   virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const ExecutorInfo& executorInfo,
@@ -72,10 +78,12 @@ private:
   CgroupsPerfEventIsolatorProcess(
       const Flags& _flags,
       const std::string& _hierarchy,
-      const std::set<std::string>& _events)
+      const std::set<std::string>& _events,
+      const Option<process::Owned<perf::Sampler>>& _sampler)
     : flags(_flags),
       hierarchy(_hierarchy),
-      events(_events) {}
+      events(_events),
+      sampler(_sampler) {}
 
   void sample();
 
@@ -113,6 +121,10 @@ private:
   // Set of events to sample.
   std::set<std::string> events;
 
+  // In-process perf_event_open(2) based sampler, used instead of
+  // forking the 'perf' binary when available.
+  Option<process::Owned<perf::Sampler>> sampler;
+
   // TODO(jieyu): Use Owned<Info>.
   hashmap<ContainerID, Info*> infos;
 };
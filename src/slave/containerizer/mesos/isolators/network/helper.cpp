@@ -28,6 +28,7 @@ int main(int argc, char** argv)
       None(),
       argc,
       argv,
+      new PortMappingSetup(),
       new PortMappingUpdate(),
       new PortMappingStatistics());
 }
@@ -92,9 +92,7 @@ using namespace routing::queueing::statistics;
 
 using std::cerr;
 using std::cout;
-using std::dec;
 using std::endl;
-using std::hex;
 using std::list;
 using std::ostringstream;
 using std::set;
@@ -649,6 +647,261 @@ int PortMappingUpdate::execute()
   return 0;
 }
 
+/////////////////////////////////////////////////
+// Implementation for PortMappingSetup.
+/////////////////////////////////////////////////
+
+const char* PortMappingSetup::NAME = "setup";
+
+
+PortMappingSetup::Flags::Flags()
+{
+  add(&eth0_name,
+      "eth0_name",
+      "The name of the public network interface (e.g., eth0)");
+
+  add(&lo_name,
+      "lo_name",
+      "The name of the loopback network interface (e.g., lo)");
+
+  add(&host_ip,
+      "host_ip",
+      "The IP address of the host public network interface");
+
+  add(&ports,
+      "ports",
+      "A collection of port ranges (formatted as a JSON object)\n"
+      "assigned to the container. E.g.,\n"
+      "--ports={\"range\":[{\"begin\":4,\"end\":8}]}");
+
+  add(&egress_rate_limit,
+      "egress_rate_limit",
+      "The throughput limit for the container's egress traffic");
+}
+
+
+// NOTE: This subcommand is executed by the launch helper inside the
+// container's network and mount namespaces, so unlike 'update' and
+// 'statistics', it does not need to enter any namespace itself.
+int PortMappingSetup::execute()
+{
+  if (flags.help) {
+    cerr << "Usage: " << name() << " [OPTIONS]" << endl << endl
+         << "Supported options:" << endl
+         << flags.usage();
+    return 0;
+  }
+
+  if (flags.eth0_name.isNone()) {
+    cerr << "The public interface name (e.g., eth0) is not specified" << endl;
+    return 1;
+  }
+
+  if (flags.lo_name.isNone()) {
+    cerr << "The loopback interface name (e.g., lo) is not specified" << endl;
+    return 1;
+  }
+
+  if (flags.host_ip.isNone()) {
+    cerr << "The host public interface IP is not specified" << endl;
+    return 1;
+  }
+
+  if (flags.ports.isNone()) {
+    cerr << "The assigned ports are not specified" << endl;
+    return 1;
+  }
+
+  Try<net::IP> hostIP = net::IP::parse(flags.host_ip.get(), AF_INET);
+  if (hostIP.isError()) {
+    cerr << "Parsing 'host_ip' failed: " << hostIP.error() << endl;
+    return 1;
+  }
+
+  Try<vector<PortRange>> ranges = parse(flags.ports.get());
+  if (ranges.isError()) {
+    cerr << "Parsing 'ports' failed: " << ranges.error() << endl;
+    return 1;
+  }
+
+  const string eth0 = flags.eth0_name.get();
+  const string lo = flags.lo_name.get();
+
+  // Set up the ingress qdiscs on lo and eth0 so that we can attach
+  // filters below.
+  Try<bool> loIngress = ingress::create(lo);
+  if (loIngress.isError()) {
+    cerr << "Failed to create the ingress qdisc on " << lo
+         << ": " << loIngress.error() << endl;
+    return 1;
+  } else if (!loIngress.get()) {
+    cerr << "The ingress qdisc on " << lo << " already exists" << endl;
+    return 1;
+  }
+
+  Try<bool> eth0Ingress = ingress::create(eth0);
+  if (eth0Ingress.isError()) {
+    cerr << "Failed to create the ingress qdisc on " << eth0
+         << ": " << eth0Ingress.error() << endl;
+    return 1;
+  } else if (!eth0Ingress.get()) {
+    cerr << "The ingress qdisc on " << eth0 << " already exists" << endl;
+    return 1;
+  }
+
+  // Allow talking between containers and from container to host.
+  // TODO(chzhcn): Consider merging the following two filters.
+  Try<bool> loToEth0HostIP = filter::ip::create(
+      lo,
+      ingress::HANDLE,
+      ip::Classifier(None(), hostIP.get(), None(), None()),
+      Priority(IP_FILTER_PRIORITY, NORMAL),
+      action::Redirect(eth0));
+
+  if (loToEth0HostIP.isError()) {
+    cerr << "Failed to create an IP packet filter (for host IP) from "
+         << lo << " to " << eth0 << ": " << loToEth0HostIP.error() << endl;
+    return 1;
+  } else if (!loToEth0HostIP.get()) {
+    cerr << "The IP packet filter (for host IP) from "
+         << lo << " to " << eth0 << " already exists" << endl;
+    return 1;
+  }
+
+  Try<bool> loToEth0Loopback = filter::ip::create(
+      lo,
+      ingress::HANDLE,
+      ip::Classifier(
+          None(),
+          net::IPNetwork::LOOPBACK_V4().address(),
+          None(),
+          None()),
+      Priority(IP_FILTER_PRIORITY, NORMAL),
+      action::Redirect(eth0));
+
+  if (loToEth0Loopback.isError()) {
+    cerr << "Failed to create an IP packet filter (for loopback IP) from "
+         << lo << " to " << eth0 << ": " << loToEth0Loopback.error() << endl;
+    return 1;
+  } else if (!loToEth0Loopback.get()) {
+    cerr << "The IP packet filter (for loopback IP) from "
+         << lo << " to " << eth0 << " already exists" << endl;
+    return 1;
+  }
+
+  // Set up the IP filters for the ports assigned to this container so
+  // that local traffic stays on lo and loopback traffic arriving on
+  // eth0 is redirected to lo.
+  foreach (const PortRange& range, ranges.get()) {
+    Try<Nothing> add = addContainerIPFilters(range, eth0, lo);
+    if (add.isError()) {
+      cerr << "Failed to add IP filters: " << add.error() << endl;
+      return 1;
+    }
+  }
+
+  // Do not forward the ICMP packet if the destination IP is self.
+  Try<bool> icmpHostIP = filter::icmp::create(
+      lo,
+      ingress::HANDLE,
+      icmp::Classifier(hostIP.get()),
+      Priority(ICMP_FILTER_PRIORITY, NORMAL),
+      Option<Handle>(ingress::HANDLE));
+
+  if (icmpHostIP.isError()) {
+    cerr << "Failed to create an ICMP packet filter (for host IP) on "
+         << lo << ": " << icmpHostIP.error() << endl;
+    return 1;
+  } else if (!icmpHostIP.get()) {
+    cerr << "The ICMP packet filter (for host IP) on "
+         << lo << " already exists" << endl;
+    return 1;
+  }
+
+  Try<bool> icmpLoopback = filter::icmp::create(
+      lo,
+      ingress::HANDLE,
+      icmp::Classifier(net::IPNetwork::LOOPBACK_V4().address()),
+      Priority(ICMP_FILTER_PRIORITY, NORMAL),
+      Option<Handle>(ingress::HANDLE));
+
+  if (icmpLoopback.isError()) {
+    cerr << "Failed to create an ICMP packet filter (for loopback IP) on "
+         << lo << ": " << icmpLoopback.error() << endl;
+    return 1;
+  } else if (!icmpLoopback.get()) {
+    cerr << "The ICMP packet filter (for loopback IP) on "
+         << lo << " already exists" << endl;
+    return 1;
+  }
+
+  // If a throughput limit for container egress traffic exists, use an
+  // HTB qdisc to achieve traffic shaping.
+  // TBF has some known issues with GSO packets.
+  // https://git.kernel.org/cgit/linux/kernel/git/davem/net.git/:
+  // e43ac79a4bc6ca90de4ba10983b4ca39cd215b4b
+  // Additionally, HTB has a simpler interface for just capping the
+  // throughput. TBF requires other parameters such as 'burst' that
+  // HTB already has default values for.
+  if (flags.egress_rate_limit.isSome()) {
+    // Direct all unclassified traffic to the rate limiting class.
+    htb::Config config;
+    config.defcls = CONTAINER_TX_HTB_CLASS_ID.get() & 0xffff;
+
+    Try<bool> qdisc = htb::create(
+        eth0,
+        EGRESS_ROOT,
+        CONTAINER_TX_HTB_HANDLE,
+        config);
+
+    if (qdisc.isError()) {
+      cerr << "Failed to create the egress HTB qdisc on " << eth0
+           << ": " << qdisc.error() << endl;
+      return 1;
+    } else if (!qdisc.get()) {
+      cerr << "The egress HTB qdisc on " << eth0 << " already exists" << endl;
+      return 1;
+    }
+
+    Try<bool> htbClass = htb::cls::create(
+        eth0,
+        CONTAINER_TX_HTB_HANDLE,
+        CONTAINER_TX_HTB_CLASS_ID,
+        htb::cls::Config(flags.egress_rate_limit.get().bytes()));
+
+    if (htbClass.isError()) {
+      cerr << "Failed to create the egress HTB class on " << eth0
+           << ": " << htbClass.error() << endl;
+      return 1;
+    } else if (!htbClass.get()) {
+      cerr << "The egress HTB class on " << eth0 << " already exists" << endl;
+      return 1;
+    }
+
+    // Packets are buffered at the leaf qdisc if we send them faster
+    // than the HTB rate limit and may be dropped when the queue is
+    // full, so we change the default leaf qdisc from pfifo_fast to
+    // fq_codel, which has a larger buffer and better control on
+    // buffer bloat.
+    // TODO(cwang): Verify that fq_codel qdisc is available.
+    Try<bool> fqCodel = fq_codel::create(
+        eth0,
+        CONTAINER_TX_HTB_CLASS_ID,
+        None());
+
+    if (fqCodel.isError()) {
+      cerr << "Failed to create the fq_codel qdisc on " << eth0
+           << ": " << fqCodel.error() << endl;
+      return 1;
+    } else if (!fqCodel.get()) {
+      cerr << "The fq_codel qdisc on " << eth0 << " already exists" << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
 /////////////////////////////////////////////////
 // Implementation for PortMappingStatistics.
 /////////////////////////////////////////////////
@@ -3616,102 +3869,29 @@ string PortMappingIsolatorProcess::scripts(Info* info)
     script << "fi\n";
   }
 
-  // Set up filters on lo and eth0.
-  script << "tc qdisc add dev " << lo << " ingress\n";
-  script << "tc qdisc add dev " << eth0 << " ingress\n";
+  // Set up the traffic control structures (qdiscs and filters) on lo
+  // and eth0 with a single invocation of the network helper, which
+  // talks to the kernel directly through a netlink socket. This
+  // replaces the ~20 'tc' command invocations we used previously,
+  // which dominated the container network setup time.
+  // NOTE: We single quote the JSON object because it contains double
+  // quotes.
+  script << path::join(flags.launcher_dir, "mesos-network-helper")
+         << " " << PortMappingSetup::NAME
+         << " --eth0_name=" << eth0
+         << " --lo_name=" << lo
+         << " --host_ip=" << hostIPNetwork.address()
+         << " --ports='"
+         << json(getPortRanges(info->nonEphemeralPorts + info->ephemeralPorts))
+         << "'";
 
-  // Allow talking between containers and from container to host.
-  // TODO(chzhcn): Consider merging the following two filters.
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip dst " << hostIPNetwork.address()
-         << " action mirred egress redirect dev " << eth0 << "\n";
-
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip dst "
-         << net::IPNetwork::LOOPBACK_V4().address()
-         << " action mirred egress redirect dev " << eth0 << "\n";
-
-  foreach (const PortRange& range,
-           getPortRanges(info->nonEphemeralPorts + info->ephemeralPorts)) {
-    // Local traffic inside a container will not be redirected to eth0.
-    script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-           << " protocol ip"
-           << " prio " << Priority(IP_FILTER_PRIORITY, HIGH).get() << " u32"
-           << " flowid ffff:0"
-           << " match ip dport " << range.begin() << " "
-           << hex << range.mask() << dec << "\n";
-
-    // Traffic going to host loopback IP and ports assigned to this
-    // container will be redirected to lo.
-    script << "tc filter add dev " << eth0 << " parent " << ingress::HANDLE
-           << " protocol ip"
-           << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
-           << " flowid ffff:0"
-           << " match ip dst "
-           << net::IPNetwork::LOOPBACK_V4().address()
-           << " match ip dport " << range.begin() << " "
-           << hex << range.mask() << dec
-           << " action mirred egress redirect dev " << lo << "\n";
-  }
-
-  // Do not forward the ICMP packet if the destination IP is self.
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(ICMP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip protocol 1 0xff"
-         << " match ip dst " << hostIPNetwork.address() << "\n";
-
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(ICMP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip protocol 1 0xff"
-         << " match ip dst "
-         << net::IPNetwork::LOOPBACK_V4().address() << "\n";
-
-  // Display the filters created on eth0 and lo.
-  script << "tc filter show dev " << eth0
-         << " parent " << ingress::HANDLE << "\n";
-  script << "tc filter show dev " << lo
-         << " parent " << ingress::HANDLE << "\n";
-
-  // If throughput limit for container egress traffic exists, use HTB
-  // qdisc to achieve traffic shaping.
-  // TBF has some known issues with GSO packets.
-  // https://git.kernel.org/cgit/linux/kernel/git/davem/net.git/:
-  // e43ac79a4bc6ca90de4ba10983b4ca39cd215b4b
-  // Additionally, HTB has a simpler interface for just capping the
-  // throughput. TBF requires other parameters such as 'burst' that
-  // HTB already has default values for.
   if (egressRateLimitPerContainer.isSome()) {
-    script << "tc qdisc add dev " << eth0 << " root handle "
-           << CONTAINER_TX_HTB_HANDLE << " htb default 1\n";
-    script << "tc class add dev " << eth0 << " parent "
-           << CONTAINER_TX_HTB_HANDLE << " classid "
-           << CONTAINER_TX_HTB_CLASS_ID << " htb rate "
-           << egressRateLimitPerContainer.get().bytes() * 8 << "bit\n";
-
-    // Packets are buffered at the leaf qdisc if we send them faster
-    // than the HTB rate limit and may be dropped when the queue is
-    // full, so we change the default leaf qdisc from pfifo_fast to
-    // fq_codel, which has a larger buffer and better control on
-    // buffer bloat.
-    // TODO(cwang): Verity that fq_codel qdisc is available.
-    script << "tc qdisc add dev " << eth0
-           << " parent " << CONTAINER_TX_HTB_CLASS_ID << " fq_codel\n";
-
-    // Display the htb qdisc and class created on eth0.
-    script << "tc qdisc show dev " << eth0 << "\n";
-    script << "tc class show dev " << eth0 << "\n";
+    script << " --egress_rate_limit="
+           << stringify(egressRateLimitPerContainer.get());
   }
 
+  script << "\n";
+
   return script.str();
 }
 
@@ -154,6 +154,8 @@ public:
       const std::list<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans);
 
+  virtual bool supportsParallelPrepare() { return true; }
+
   virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const ExecutorInfo& executorInfo,
@@ -369,6 +371,36 @@ protected:
 };
 
 
+// Defines the subcommand for 'setup' that needs to be executed by a
+// subprocess inside the container's network namespace to set up the
+// traffic control structures (queueing disciplines and filters) on
+// the container's links before the executor is launched.
+class PortMappingSetup : public Subcommand
+{
+public:
+  static const char* NAME;
+
+  struct Flags : public flags::FlagsBase
+  {
+    Flags();
+
+    Option<std::string> eth0_name;
+    Option<std::string> lo_name;
+    Option<std::string> host_ip;
+    Option<JSON::Object> ports;
+    Option<Bytes> egress_rate_limit;
+  };
+
+  PortMappingSetup() : Subcommand(NAME) {}
+
+  Flags flags;
+
+protected:
+  virtual int execute();
+  virtual flags::FlagsBase* getFlags() { return &flags; }
+};
+
+
 // Defines the subcommand for 'statistics' that needs to be executed
 // by a subprocess to retrieve newtork statistics from inside a
 // container.
@@ -45,6 +45,8 @@
 
 #include "common/protobuf_utils.hpp"
 
+#include "slave/io_scheduler.hpp"
+
 #include "slave/containerizer/mesos/isolators/posix/disk.hpp"
 
 using namespace process;
@@ -408,6 +410,26 @@ private:
       return;
     }
 
+    // Launch through the slave's I/O scheduler so that disk usage
+    // scans are throttled against the other background disk traffic
+    // (provisioning, fetching, garbage collection).
+    IOScheduler::instance()->schedule<Nothing>(
+        IOScheduler::MONITOR,
+        defer(self(), &Self::launch));
+  }
+
+  // Launches a 'du' for the check at the front of the queue; the
+  // returned future completes when the 'du' has finished so that the
+  // I/O scheduler's pool slot is held for its duration.
+  Future<Nothing> launch()
+  {
+    // The front of the queue may have been discarded while waiting
+    // for admission.
+    if (entries.empty()) {
+      delay(interval, self(), &Self::schedule);
+      return Nothing();
+    }
+
     const Owned<Entry>& entry = entries.front();
 
     // Invoke 'du' and report number of 1K-byte blocks. We fix the
@@ -433,15 +455,21 @@ private:
 
       entries.pop_front();
       delay(interval, self(), &Self::schedule);
-      return;
+      return Nothing();
     }
 
     entry->du = s.get();
 
-    await(s.get().status(),
+    Future<std::tuple<Future<Option<int>>, Future<string>, Future<string>>>
+      result = await(
+          s.get().status(),
           io::read(s.get().out().get()),
-          io::read(s.get().err().get()))
-      .onAny(defer(self(), &Self::_schedule, lambda::_1));
+          io::read(s.get().err().get()));
+
+    result.onAny(defer(self(), &Self::_schedule, lambda::_1));
+
+    return result
+      .then([]() -> Future<Nothing> { return Nothing(); });
   }
 
   void _schedule(const Future<std::tuple<
@@ -0,0 +1,339 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "slave/containerizer/mesos/isolators/xfs/disk.hpp"
+
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/exists.hpp>
+
+using namespace process;
+
+using std::list;
+using std::string;
+using std::vector;
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerLaunchInfo;
+using mesos::slave::ContainerLimitation;
+using mesos::slave::ContainerState;
+using mesos::slave::Isolator;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Parses a project ID range in the form "[5000-10000]".
+static Try<IntervalSet<prid_t>> parseProjectRange(const string& range)
+{
+  const string stripped = strings::trim(range, strings::ANY, "[]");
+
+  vector<string> tokens = strings::tokenize(stripped, "-");
+  if (tokens.size() != 2) {
+    return Error("Expected a range in the form [begin-end]");
+  }
+
+  Try<prid_t> begin = numify<prid_t>(tokens[0]);
+  if (begin.isError()) {
+    return Error("Invalid project ID '" + tokens[0] + "'");
+  }
+
+  Try<prid_t> end = numify<prid_t>(tokens[1]);
+  if (end.isError()) {
+    return Error("Invalid project ID '" + tokens[1] + "'");
+  }
+
+  // Project ID 0 means "no project" and cannot be allocated.
+  if (begin.get() == 0 || begin.get() > end.get()) {
+    return Error("Invalid project ID range [" + stripped + "]");
+  }
+
+  IntervalSet<prid_t> projectIds;
+  projectIds += (Bound<prid_t>::closed(begin.get()),
+                 Bound<prid_t>::closed(end.get()));
+
+  return projectIds;
+}
+
+
+Try<Isolator*> XfsDiskIsolatorProcess::create(const Flags& flags)
+{
+  Try<bool> isXfs = xfs::pathIsXfs(flags.work_dir);
+  if (isXfs.isError()) {
+    return Error(
+        "Failed to check filesystem type of '" + flags.work_dir +
+        "': " + isXfs.error());
+  }
+
+  if (!isXfs.get()) {
+    return Error(
+        "The 'disk/xfs' isolator requires the work directory '" +
+        flags.work_dir + "' to be on an XFS filesystem");
+  }
+
+  Try<IntervalSet<prid_t>> projectIds =
+    parseProjectRange(flags.xfs_project_range);
+
+  if (projectIds.isError()) {
+    return Error(
+        "Failed to parse --xfs_project_range '" + flags.xfs_project_range +
+        "': " + projectIds.error());
+  }
+
+  return new MesosIsolator(process::Owned<MesosIsolatorProcess>(
+      new XfsDiskIsolatorProcess(flags, projectIds.get())));
+}
+
+
+XfsDiskIsolatorProcess::XfsDiskIsolatorProcess(
+    const Flags& _flags,
+    const IntervalSet<prid_t>& projectIds)
+  : flags(_flags),
+    totalProjectIds(projectIds),
+    freeProjectIds(projectIds)
+{
+  LOG(INFO) << "Allocating XFS project IDs from the range "
+            << flags.xfs_project_range;
+}
+
+
+XfsDiskIsolatorProcess::~XfsDiskIsolatorProcess() {}
+
+
+Future<Nothing> XfsDiskIsolatorProcess::recover(
+    const list<ContainerState>& states,
+    const hashset<ContainerID>& orphans)
+{
+  // We recover the project ID a sandbox was assigned to from its
+  // extended attributes, so no additional checkpointing is needed.
+  foreach (const ContainerState& state, states) {
+    CHECK(os::exists(state.directory()))
+      << "Executor work directory " << state.directory() << " doesn't exist";
+
+    Result<prid_t> projectId = xfs::getProjectId(state.directory());
+    if (projectId.isError()) {
+      return Failure(projectId.error());
+    }
+
+    // If the sandbox has no project ID, it was created before this
+    // isolator was enabled. We don't track its disk usage.
+    if (projectId.isNone()) {
+      LOG(WARNING) << "Container " << state.container_id()
+                   << " has no project ID assigned to its sandbox";
+      continue;
+    }
+
+    infos.put(
+        state.container_id(),
+        Owned<Info>(new Info(state.directory(), projectId.get())));
+
+    freeProjectIds -= projectId.get();
+  }
+
+  return Nothing();
+}
+
+
+Future<Option<ContainerLaunchInfo>> XfsDiskIsolatorProcess::prepare(
+    const ContainerID& containerId,
+    const ExecutorInfo& executorInfo,
+    const ContainerConfig& containerConfig)
+{
+  if (infos.contains(containerId)) {
+    return Failure("Container has already been prepared");
+  }
+
+  Option<prid_t> projectId = nextProjectId();
+  if (projectId.isNone()) {
+    return Failure(
+        "Failed to assign a project ID, range " +
+        flags.xfs_project_range + " is exhausted");
+  }
+
+  Try<Nothing> assign =
+    xfs::setProjectId(containerConfig.directory(), projectId.get());
+
+  if (assign.isError()) {
+    returnProjectId(projectId.get());
+    return Failure(
+        "Failed to assign project ID " + stringify(projectId.get()) +
+        ": " + assign.error());
+  }
+
+  LOG(INFO) << "Assigned project ID " << projectId.get()
+            << " to container " << containerId;
+
+  infos.put(
+      containerId,
+      Owned<Info>(new Info(containerConfig.directory(), projectId.get())));
+
+  return None();
+}
+
+
+Future<Nothing> XfsDiskIsolatorProcess::isolate(
+    const ContainerID& containerId,
+    pid_t pid)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  return Nothing();
+}
+
+
+Future<ContainerLimitation> XfsDiskIsolatorProcess::watch(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  // The kernel enforces the quota: once the limit is reached, writes
+  // from the container fail with EDQUOT. We never generate a
+  // limitation ourselves.
+  return Future<ContainerLimitation>();
+}
+
+
+Future<Nothing> XfsDiskIsolatorProcess::update(
+    const ContainerID& containerId,
+    const Resources& resources)
+{
+  if (!infos.contains(containerId)) {
+    LOG(WARNING) << "Ignoring update for unknown container " << containerId;
+    return Nothing();
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  // TODO(bbossy): Support persistent volumes. Only the sandbox disk
+  // quota is tracked for now (same limitation as MESOS-4263 for the
+  // 'posix/disk' isolator).
+  Option<Bytes> quota = resources.disk();
+  if (quota.isNone()) {
+    return Nothing();
+  }
+
+  // The kernel accounts project usage whether or not a limit is set,
+  // so when quota enforcement is disabled we simply never install the
+  // limit and only read the counters in 'usage()'.
+  if (flags.enforce_container_disk_quota) {
+    Try<Nothing> set = xfs::setProjectQuota(
+        flags.work_dir, info->projectId, quota.get());
+
+    if (set.isError()) {
+      return Failure(set.error());
+    }
+
+    LOG(INFO) << "Updated the disk quota for project " << info->projectId
+              << " of container " << containerId << " to " << quota.get();
+  }
+
+  info->quota = quota.get();
+
+  return Nothing();
+}
+
+
+Future<ResourceStatistics> XfsDiskIsolatorProcess::usage(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  ResourceStatistics result;
+
+  result.set_disk_limit_bytes(info->quota.bytes());
+
+  // Reading the usage is a single quotactl(2) call against the
+  // kernel's quota counters; unlike 'posix/disk' there is no scan of
+  // the sandbox and the value is always current.
+  Result<xfs::QuotaInfo> quota =
+    xfs::getProjectQuota(flags.work_dir, info->projectId);
+
+  if (quota.isError()) {
+    return Failure(quota.error());
+  }
+
+  if (quota.isSome()) {
+    result.set_disk_used_bytes(quota.get().used.bytes());
+  }
+
+  return result;
+}
+
+
+Future<Nothing> XfsDiskIsolatorProcess::cleanup(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    LOG(WARNING) << "Ignoring cleanup for unknown container " << containerId;
+    return Nothing();
+  }
+
+  const Owned<Info> info = infos[containerId];
+  infos.erase(containerId);
+
+  // NOTE: The quota is keyed by the project ID, not by the sandbox
+  // path, so it must be removed even though the sandbox itself is
+  // garbage collected later.
+  Try<Nothing> clear = xfs::clearProjectQuota(flags.work_dir, info->projectId);
+  if (clear.isError()) {
+    return Failure(clear.error());
+  }
+
+  returnProjectId(info->projectId);
+
+  return Nothing();
+}
+
+
+Option<prid_t> XfsDiskIsolatorProcess::nextProjectId()
+{
+  if (freeProjectIds.empty()) {
+    return None();
+  }
+
+  prid_t projectId = freeProjectIds.begin()->lower();
+
+  freeProjectIds -= projectId;
+  return projectId;
+}
+
+
+void XfsDiskIsolatorProcess::returnProjectId(prid_t projectId)
+{
+  // Only return project IDs that are within the configured range, in
+  // case the range was narrowed across an agent restart.
+  if (totalProjectIds.contains(projectId)) {
+    freeProjectIds += projectId;
+  }
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
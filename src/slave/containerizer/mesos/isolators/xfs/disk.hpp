@@ -0,0 +1,117 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __XFS_DISK_ISOLATOR_HPP__
+#define __XFS_DISK_ISOLATOR_HPP__
+
+#include <string>
+
+#include <process/owned.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/interval.hpp>
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/isolator.hpp"
+
+#include "slave/containerizer/mesos/isolators/xfs/utils.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// This isolator tracks sandbox disk usage with XFS project quotas.
+// Each container's sandbox is assigned a project ID from a configured
+// range when it is prepared, and the kernel maintains usage counters
+// for the project as the container writes. Reading usage is therefore
+// an O(1) quotactl(2) call instead of the recursive 'du' scan the
+// 'posix/disk' isolator performs, which avoids the periodic I/O storm
+// and page cache pollution on agents with many sandboxes.
+//
+// Quota enforcement is done by the kernel: once a container reaches
+// its limit, writes fail with EDQUOT. Unlike 'posix/disk', no
+// ContainerLimitation is generated.
+class XfsDiskIsolatorProcess : public MesosIsolatorProcess
+{
+public:
+  static Try<mesos::slave::Isolator*> create(const Flags& flags);
+
+  virtual ~XfsDiskIsolatorProcess();
+
+  virtual process::Future<Nothing> recover(
+      const std::list<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans);
+
+  virtual bool supportsParallelPrepare() { return true; }
+
+  virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
+      const ContainerID& containerId,
+      const ExecutorInfo& executorInfo,
+      const mesos::slave::ContainerConfig& containerConfig);
+
+  virtual process::Future<Nothing> isolate(
+      const ContainerID& containerId,
+      pid_t pid);
+
+  virtual process::Future<mesos::slave::ContainerLimitation> watch(
+      const ContainerID& containerId);
+
+  virtual process::Future<Nothing> update(
+      const ContainerID& containerId,
+      const Resources& resources);
+
+  virtual process::Future<ResourceStatistics> usage(
+      const ContainerID& containerId);
+
+  virtual process::Future<Nothing> cleanup(
+      const ContainerID& containerId);
+
+private:
+  XfsDiskIsolatorProcess(
+      const Flags& flags,
+      const IntervalSet<prid_t>& projectIds);
+
+  // Take the next project ID from the unallocated pool.
+  Option<prid_t> nextProjectId();
+
+  // Hand the project ID back to the unallocated pool.
+  void returnProjectId(prid_t projectId);
+
+  const Flags flags;
+
+  struct Info
+  {
+    Info(const std::string& _directory, prid_t _projectId)
+      : directory(_directory), quota(0), projectId(_projectId) {}
+
+    const std::string directory;
+    Bytes quota;
+    const prid_t projectId;
+  };
+
+  const IntervalSet<prid_t> totalProjectIds;
+  IntervalSet<prid_t> freeProjectIds;
+
+  hashmap<ContainerID, process::Owned<Info>> infos;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __XFS_DISK_ISOLATOR_HPP__
@@ -0,0 +1,263 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "slave/containerizer/mesos/isolators/xfs/utils.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <sys/quota.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/types.h>
+
+#include <string.h>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/none.hpp>
+
+#include "linux/fs.hpp"
+
+extern "C" {
+#include <xfs/xqm.h>
+} // extern "C" {
+
+// 'xfs/xfs.h' does not define the XFS superblock magic; it is only
+// exported by 'linux/magic.h' on recent kernel headers.
+#ifndef XFS_SUPER_MAGIC
+#define XFS_SUPER_MAGIC 0x58465342
+#endif
+
+using std::string;
+
+namespace mesos {
+namespace internal {
+namespace xfs {
+
+// XFS expresses quotas in basic blocks (512 bytes).
+static const Bytes BASIC_BLOCK_SIZE = Bytes(512u);
+
+
+// Returns the block device backing the (XFS) filesystem that contains
+// the given path. Quota operations are addressed to the device rather
+// than to a path within the filesystem.
+static Result<string> getDeviceForPath(const string& path)
+{
+  struct stat statbuf;
+  if (::stat(path.c_str(), &statbuf) == -1) {
+    return ErrnoError("Failed to stat '" + path + "'");
+  }
+
+  Try<fs::MountTable> mountTable = fs::MountTable::read("/proc/self/mounts");
+  if (mountTable.isError()) {
+    return Error("Failed to read mount table: " + mountTable.error());
+  }
+
+  foreach (const fs::MountTable::Entry& entry, mountTable.get().entries) {
+    if (entry.type != "xfs") {
+      continue;
+    }
+
+    struct stat mountbuf;
+    if (::stat(entry.dir.c_str(), &mountbuf) == -1) {
+      continue;
+    }
+
+    if (mountbuf.st_dev == statbuf.st_dev) {
+      return entry.fsname;
+    }
+  }
+
+  return None();
+}
+
+
+Result<QuotaInfo> getProjectQuota(
+    const string& path,
+    prid_t projectId)
+{
+  Result<string> device = getDeviceForPath(path);
+  if (device.isError()) {
+    return Error(device.error());
+  } else if (device.isNone()) {
+    return Error("'" + path + "' is not on an XFS filesystem");
+  }
+
+  fs_disk_quota_t quota;
+  memset(&quota, 0, sizeof(quota));
+
+  if (::quotactl(QCMD(Q_XGETQUOTA, PRJQUOTA),
+                 device.get().c_str(),
+                 projectId,
+                 reinterpret_cast<caddr_t>(&quota)) == -1) {
+    // ENOENT and ESRCH indicate that no quota has been set for this
+    // project ID yet.
+    if (errno == ENOENT || errno == ESRCH) {
+      return None();
+    }
+
+    return ErrnoError(
+        "Failed to get quota for project " + stringify(projectId) +
+        " on '" + device.get() + "'");
+  }
+
+  QuotaInfo info;
+  info.limit = BASIC_BLOCK_SIZE * quota.d_blk_hardlimit;
+  info.used = BASIC_BLOCK_SIZE * quota.d_bcount;
+
+  return info;
+}
+
+
+static Try<Nothing> setQuota(
+    const string& path,
+    prid_t projectId,
+    uint64_t blocks)
+{
+  Result<string> device = getDeviceForPath(path);
+  if (device.isError()) {
+    return Error(device.error());
+  } else if (device.isNone()) {
+    return Error("'" + path + "' is not on an XFS filesystem");
+  }
+
+  fs_disk_quota_t quota;
+  memset(&quota, 0, sizeof(quota));
+
+  quota.d_version = FS_DQUOT_VERSION;
+  quota.d_id = projectId;
+  quota.d_flags = XFS_PROJ_QUOTA;
+  quota.d_fieldmask = FS_DQ_BSOFT | FS_DQ_BHARD;
+  quota.d_blk_softlimit = blocks;
+  quota.d_blk_hardlimit = blocks;
+
+  if (::quotactl(QCMD(Q_XSETQLIM, PRJQUOTA),
+                 device.get().c_str(),
+                 projectId,
+                 reinterpret_cast<caddr_t>(&quota)) == -1) {
+    return ErrnoError(
+        "Failed to set quota for project " + stringify(projectId) +
+        " on '" + device.get() + "'");
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> setProjectQuota(
+    const string& path,
+    prid_t projectId,
+    Bytes limit)
+{
+  // Round the limit up to the next basic block.
+  uint64_t blocks =
+    (limit.bytes() + BASIC_BLOCK_SIZE.bytes() - 1) / BASIC_BLOCK_SIZE.bytes();
+
+  return setQuota(path, projectId, blocks);
+}
+
+
+Try<Nothing> clearProjectQuota(
+    const string& path,
+    prid_t projectId)
+{
+  return setQuota(path, projectId, 0);
+}
+
+
+Result<prid_t> getProjectId(const string& directory)
+{
+  int fd = ::open(directory.c_str(), O_RDONLY | O_NOCTTY | O_NOFOLLOW);
+  if (fd == -1) {
+    return ErrnoError("Failed to open '" + directory + "'");
+  }
+
+  struct fsxattr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  if (::ioctl(fd, XFS_IOC_FSGETXATTR, &attr) == -1) {
+    Error error = ErrnoError(
+        "Failed to get extended attributes for '" + directory + "'");
+
+    ::close(fd);
+    return error;
+  }
+
+  ::close(fd);
+
+  if (attr.fsx_projid == 0) {
+    return None();
+  }
+
+  return attr.fsx_projid;
+}
+
+
+Try<Nothing> setProjectId(const string& directory, prid_t projectId)
+{
+  int fd = ::open(directory.c_str(), O_RDONLY | O_NOCTTY | O_NOFOLLOW);
+  if (fd == -1) {
+    return ErrnoError("Failed to open '" + directory + "'");
+  }
+
+  struct fsxattr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  if (::ioctl(fd, XFS_IOC_FSGETXATTR, &attr) == -1) {
+    Error error = ErrnoError(
+        "Failed to get extended attributes for '" + directory + "'");
+
+    ::close(fd);
+    return error;
+  }
+
+  attr.fsx_projid = projectId;
+
+  // New files and directories created underneath inherit the project
+  // ID, so everything the container writes is accounted without any
+  // further labeling.
+  attr.fsx_xflags |= XFS_XFLAG_PROJINHERIT;
+
+  if (::ioctl(fd, XFS_IOC_FSSETXATTR, &attr) == -1) {
+    Error error = ErrnoError(
+        "Failed to set project ID " + stringify(projectId) +
+        " on '" + directory + "'");
+
+    ::close(fd);
+    return error;
+  }
+
+  ::close(fd);
+
+  return Nothing();
+}
+
+
+Try<bool> pathIsXfs(const string& path)
+{
+  struct statfs buf;
+  if (::statfs(path.c_str(), &buf) == -1) {
+    return ErrnoError("Failed to statfs '" + path + "'");
+  }
+
+  return buf.f_type == XFS_SUPER_MAGIC;
+}
+
+} // namespace xfs {
+} // namespace internal {
+} // namespace mesos {
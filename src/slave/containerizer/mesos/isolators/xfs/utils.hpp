@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __XFS_UTILS_HPP__
+#define __XFS_UTILS_HPP__
+
+#include <string>
+
+#include <stout/bytes.hpp>
+#include <stout/nothing.hpp>
+#include <stout/result.hpp>
+#include <stout/try.hpp>
+
+extern "C" {
+#include <xfs/xfs.h>
+} // extern "C" {
+
+namespace mesos {
+namespace internal {
+namespace xfs {
+
+struct QuotaInfo
+{
+  Bytes limit;
+  Bytes used;
+};
+
+
+// Quota operations are provided on the path of any file or directory
+// in the filesystem. The quota applies to the whole filesystem for
+// all the files labeled with the given project ID.
+
+// Returns the quota and current usage for the given project ID, or
+// None if no quota has been set for it.
+Result<QuotaInfo> getProjectQuota(
+    const std::string& path,
+    prid_t projectId);
+
+
+// Sets the block quota for the given project ID. The limit is rounded
+// up to the next XFS basic block. Once the limit is reached, writes
+// from processes in the project fail with EDQUOT.
+Try<Nothing> setProjectQuota(
+    const std::string& path,
+    prid_t projectId,
+    Bytes limit);
+
+
+// Removes the block quota for the given project ID.
+Try<Nothing> clearProjectQuota(
+    const std::string& path,
+    prid_t projectId);
+
+
+// Returns the project ID the directory is assigned to, or None if it
+// has not been assigned to any project.
+Result<prid_t> getProjectId(const std::string& directory);
+
+
+// Assigns the directory to the given project ID. New files and
+// directories created underneath inherit the project ID, so assigning
+// a sandbox directory right after it is created labels everything the
+// container subsequently writes.
+Try<Nothing> setProjectId(const std::string& directory, prid_t projectId);
+
+
+// Checks whether the filesystem containing the path is XFS.
+Try<bool> pathIsXfs(const std::string& path);
+
+} // namespace xfs {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __XFS_UTILS_HPP__
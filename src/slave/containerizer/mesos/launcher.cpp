@@ -43,6 +43,21 @@ namespace internal {
 namespace slave {
 
 
+Future<Nothing> Launcher::destroy(const vector<ContainerID>& containerIds)
+{
+  // By default there is nothing to be gained from destroying the
+  // containers in bulk so they are simply destroyed individually,
+  // in parallel.
+  list<Future<Nothing>> futures;
+  foreach (const ContainerID& containerId, containerIds) {
+    futures.push_back(destroy(containerId));
+  }
+
+  return collect(futures)
+    .then([]() { return Nothing(); });
+}
+
+
 Try<Launcher*> PosixLauncher::create(const Flags& flags)
 {
   return new PosixLauncher();
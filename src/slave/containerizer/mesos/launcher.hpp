@@ -22,6 +22,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
@@ -75,6 +76,15 @@ public:
 
   // Kill all processes in the containerized context.
   virtual process::Future<Nothing> destroy(const ContainerID& containerId) = 0;
+
+  // Kill all processes in the containerized contexts of multiple
+  // containers. The default implementation simply destroys the
+  // containers individually (in parallel); launchers that can tear
+  // down many containers more efficiently in bulk should override
+  // this. The returned future fails if destroying any of the
+  // containers failed.
+  virtual process::Future<Nothing> destroy(
+      const std::vector<ContainerID>& containerIds);
 };
 
 
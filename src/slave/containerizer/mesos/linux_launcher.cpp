@@ -489,6 +489,79 @@ Future<Nothing> LinuxLauncher::destroy(const ContainerID& containerId)
 }
 
 
+// Continuation for the batch destroy: once the processes in the
+// containers' pid namespaces (if any) have been killed, all the
+// freezer cgroups are destroyed as a single batch.
+static Future<Nothing> _destroy(
+    const string& hierarchy,
+    const vector<string>& cgroups_,
+    const list<Future<Nothing>>& kills)
+{
+  foreach (const Future<Nothing>& kill, kills) {
+    if (!kill.isReady()) {
+      return Failure(
+          "Failed to kill the processes in a pid namespace: " +
+          (kill.isFailed() ? kill.failure() : "discarded future"));
+    }
+  }
+
+  if (cgroups_.empty()) {
+    return Nothing();
+  }
+
+  return cgroups::destroy(hierarchy, cgroups_, cgroups::DESTROY_TIMEOUT);
+}
+
+
+Future<Nothing> LinuxLauncher::destroy(const vector<ContainerID>& containerIds)
+{
+  // Validate the whole batch up front so that a failure does not
+  // leave some containers' state already mutated.
+  foreach (const ContainerID& containerId, containerIds) {
+    if (!pids.contains(containerId) && !orphans.contains(containerId)) {
+      return Failure("Unknown container " + stringify(containerId));
+    }
+  }
+
+  list<Future<Nothing>> kills;
+  vector<string> cgroups_;
+
+  foreach (const ContainerID& containerId, containerIds) {
+    pids.erase(containerId);
+    orphans.erase(containerId);
+
+    // Skip the container if its cgroup was destroyed and the slave
+    // didn't receive the notification. See comment in recover().
+    Try<bool> exists = cgroups::exists(freezerHierarchy, cgroup(containerId));
+    if (exists.isError()) {
+      return Failure("Failed to check existence of freezer cgroup: " +
+                     exists.error());
+    }
+
+    if (!exists.get()) {
+      continue;
+    }
+
+    Result<ino_t> containerPidNs =
+      NamespacesPidIsolatorProcess::getNamespace(containerId);
+
+    if (containerPidNs.isSome()) {
+      LOG(INFO) << "Using pid namespace to destroy container " << containerId;
+      kills.push_back(ns::pid::destroy(containerPidNs.get()));
+    }
+
+    cgroups_.push_back(cgroup(containerId));
+  }
+
+  // The freezer cgroups are destroyed with a single batch destroyer,
+  // so the cgroups are frozen and their tasks killed in parallel and
+  // the teardown completes with the slowest container rather than
+  // the sum.
+  return await(kills)
+    .then(lambda::bind(&_destroy, freezerHierarchy, cgroups_, lambda::_1));
+}
+
+
 string LinuxLauncher::cgroup(const ContainerID& containerId)
 {
   return path::join(flags.cgroups_root, containerId.value());
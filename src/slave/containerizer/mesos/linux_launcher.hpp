@@ -55,6 +55,9 @@ public:
 
   virtual process::Future<Nothing> destroy(const ContainerID& containerId);
 
+  virtual process::Future<Nothing> destroy(
+      const std::vector<ContainerID>& containerIds);
+
 private:
   LinuxLauncher(
       const Flags& flags,
@@ -29,8 +29,8 @@ class BindBackendProcess;
 
 // This is a specialized backend that may be useful for deployments
 // using large (multi-GB) single-layer images *and* where more recent
-// kernel features such as overlayfs are not available (overlayfs-based
-// backend tracked by MESOS-2971). For small images (10's to 100's of MB)
+// kernel features such as overlayfs are not available (see the
+// overlay backend). For small images (10's to 100's of MB)
 // the copy backend may be sufficient. NOTE:
 // 1) BindBackend supports only a single layer. Multi-layer images will
 //    fail to provision and the container will fail to launch!
@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <deque>
+#include <functional>
 #include <list>
 
 #include <process/collect.hpp>
@@ -25,10 +27,18 @@
 
 
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+#include <stout/uuid.hpp>
 
 #include "common/status_utils.hpp"
 
+#include "slave/io_scheduler.hpp"
+
 #include "slave/containerizer/mesos/provisioner/backends/copy.hpp"
 
 
@@ -45,19 +55,66 @@ namespace slave {
 class CopyBackendProcess : public Process<CopyBackendProcess>
 {
 public:
+  CopyBackendProcess(size_t _poolSize, const string& _poolDir)
+    : poolSize(_poolSize), poolDir(_poolDir) {}
+
   Future<Nothing> provision(const vector<string>& layers, const string& rootfs);
 
   Future<bool> destroy(const string& rootfs);
 
 private:
+  // Copies the layers into 'target' in list order.
+  Future<Nothing> copyLayers(
+      const vector<string>& layers,
+      const string& target);
+
   Future<Nothing> _provision(string layer, const string& rootfs);
+  Future<Nothing> __provision(string layer, const string& rootfs);
+  Future<bool> _destroy(const string& rootfs);
+
+  // Pre-provisions root filesystems for the given image in the
+  // background until the pool holds 'poolSize' warm copies.
+  void replenish(const string& key, const vector<string>& layers);
+  void _replenish(
+      const string& key,
+      const string& staging,
+      const Future<Nothing>& future);
+
+  // Identifies an image by its layer paths for pool lookups.
+  static string poolKey(const vector<string>& layers);
+
+  const size_t poolSize;
+  const string poolDir;
+
+  // Warm (fully copied) root filesystems per image, ready to be
+  // renamed into place.
+  hashmap<string, std::deque<string>> pools;
+
+  // Number of warm copies per image still being filled.
+  hashmap<string, size_t> filling;
 };
 
 
-Try<Owned<Backend>> CopyBackend::create(const Flags&)
+Try<Owned<Backend>> CopyBackend::create(const Flags& flags)
 {
+  // Warm root filesystems do not survive slave restarts: a previous
+  // run's pool is thrown away rather than trying to match it against
+  // the current image stores.
+  const string poolDir =
+    path::join(flags.work_dir, "provisioner", "pool", "copy");
+
+  if (os::exists(poolDir)) {
+    Try<Nothing> rmdir = os::rmdir(poolDir, true);
+    if (rmdir.isError()) {
+      return Error(
+          "Failed to clear warm rootfs pool at '" + poolDir +
+          "': " + rmdir.error());
+    }
+  }
+
   return Owned<Backend>(new CopyBackend(
-      Owned<CopyBackendProcess>(new CopyBackendProcess())));
+      Owned<CopyBackendProcess>(new CopyBackendProcess(
+          flags.provisioner_pool_size, poolDir))));
 }
 
 
@@ -102,17 +159,58 @@ Future<Nothing> CopyBackendProcess::provision(
     return Failure("Rootfs is already provisioned");
   }
 
+  const string key = poolKey(layers);
+
+  // Bind to a warm root filesystem when one is available: a rename
+  // within the work directory replaces the layer copies, and the
+  // pool is refilled in the background.
+  if (pools.contains(key) && !pools[key].empty()) {
+    const string warm = pools[key].front();
+    pools[key].pop_front();
+
+    Try<Nothing> rename = os::mkdir(Path(rootfs).dirname());
+
+    if (rename.isSome()) {
+      rename = os::rename(warm, rootfs);
+    }
+
+    if (rename.isSome()) {
+      VLOG(1) << "Bound warm rootfs '" << warm << "' to '" << rootfs << "'";
+
+      replenish(key, layers);
+
+      return Nothing();
+    }
+
+    // Fall back to copying the layers.
+    LOG(WARNING) << "Failed to bind warm rootfs '" << warm << "' to '"
+                 << rootfs << "': " << rename.error();
+
+    os::rmdir(warm, true);
+  }
+
   Try<Nothing> mkdir = os::mkdir(rootfs);
   if (mkdir.isError()) {
     return Failure("Failed to create rootfs directory: " + mkdir.error());
   }
 
+  // Start warming the pool for this image alongside the copy.
+  replenish(key, layers);
+
+  return copyLayers(layers, rootfs);
+}
+
+
+Future<Nothing> CopyBackendProcess::copyLayers(
+    const vector<string>& layers,
+    const string& target)
+{
   list<Future<Nothing>> futures{Nothing()};
 
   foreach (const string layer, layers) {
     futures.push_back(
         futures.back().then(
-            defer(self(), &Self::_provision, layer, rootfs)));
+            defer(self(), &Self::_provision, layer, target)));
   }
 
   return collect(futures)
@@ -120,9 +218,78 @@ Future<Nothing> CopyBackendProcess::provision(
 }
 
 
+void CopyBackendProcess::replenish(
+    const string& key,
+    const vector<string>& layers)
+{
+  if (poolSize == 0) {
+    return;
+  }
+
+  size_t count = pools[key].size() + filling[key];
+
+  while (count < poolSize) {
+    filling[key]++;
+    count++;
+
+    const string staging = path::join(poolDir, key, UUID::random().toString());
+
+    Try<Nothing> mkdir = os::mkdir(staging);
+    if (mkdir.isError()) {
+      LOG(WARNING) << "Failed to create warm rootfs directory '" << staging
+                   << "': " << mkdir.error();
+      filling[key]--;
+      return;
+    }
+
+    VLOG(1) << "Warming rootfs '" << staging << "'";
+
+    copyLayers(layers, staging)
+      .onAny(defer(self(), &Self::_replenish, key, staging, lambda::_1));
+  }
+}
+
+
+void CopyBackendProcess::_replenish(
+    const string& key,
+    const string& staging,
+    const Future<Nothing>& future)
+{
+  CHECK(filling[key] > 0);
+  filling[key]--;
+
+  if (future.isReady()) {
+    pools[key].push_back(staging);
+  } else {
+    LOG(WARNING) << "Failed to warm rootfs '" << staging << "': "
+                 << (future.isFailed() ? future.failure() : "discarded");
+
+    os::rmdir(staging, true);
+  }
+}
+
+
+string CopyBackendProcess::poolKey(const vector<string>& layers)
+{
+  return stringify(std::hash<string>()(strings::join(":", layers)));
+}
+
+
 Future<Nothing> CopyBackendProcess::_provision(
   string layer,
   const string& rootfs)
+{
+  // Copies go through the slave's I/O scheduler so that image
+  // provisioning does not saturate the disk under task I/O.
+  return IOScheduler::instance()->schedule<Nothing>(
+      IOScheduler::PROVISIONING,
+      defer(self(), &Self::__provision, layer, rootfs));
+}
+
+
+Future<Nothing> CopyBackendProcess::__provision(
+  string layer,
+  const string& rootfs)
 {
   VLOG(1) << "Copying layer path '" << layer << "' to rootfs '" << rootfs
           << "'";
@@ -169,6 +336,15 @@ Future<Nothing> CopyBackendProcess::_provision(
 
 
 Future<bool> CopyBackendProcess::destroy(const string& rootfs)
+{
+  // Removals are throttled like garbage collection.
+  return IOScheduler::instance()->schedule<bool>(
+      IOScheduler::GC,
+      defer(self(), &Self::_destroy, rootfs));
+}
+
+
+Future<bool> CopyBackendProcess::_destroy(const string& rootfs)
 {
   vector<string> argv{"rm", "-rf", rootfs};
 
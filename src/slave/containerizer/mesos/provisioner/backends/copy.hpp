@@ -40,8 +40,11 @@ class CopyBackend : public Backend
 public:
   virtual ~CopyBackend();
 
-  // CopyBackend doesn't use any flag.
-  static Try<process::Owned<Backend>> create(const Flags&);
+  // With --provisioner_pool_size the backend keeps that many fully
+  // copied root filesystems warm per image (under the work
+  // directory) and binds incoming containers to them with a rename,
+  // refilling the pool in the background.
+  static Try<process::Owned<Backend>> create(const Flags& flags);
 
   // Provisions a rootfs given the layers' paths and target rootfs
   // path.
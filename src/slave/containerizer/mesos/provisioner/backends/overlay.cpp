@@ -0,0 +1,261 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <process/dispatch.hpp>
+#include <process/process.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include "linux/fs.hpp"
+
+#include "slave/containerizer/mesos/provisioner/backends/overlay.hpp"
+
+using namespace process;
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+class OverlayBackendProcess : public Process<OverlayBackendProcess>
+{
+public:
+  explicit OverlayBackendProcess(const string& _fsname) : fsname(_fsname) {}
+
+  Future<Nothing> provision(const vector<string>& layers, const string& rootfs);
+
+  Future<bool> destroy(const string& rootfs);
+
+private:
+  // The name under which the overlay filesystem is registered in the
+  // kernel: 'overlay' since Linux 4.0 and 'overlayfs' before that.
+  const string fsname;
+};
+
+
+// Returns the name under which the overlay filesystem is registered
+// in the kernel, or an error if the kernel does not support it.
+static Try<string> detectOverlayFs()
+{
+  Try<string> filesystems = os::read("/proc/filesystems");
+  if (filesystems.isError()) {
+    return Error("Failed to read /proc/filesystems: " + filesystems.error());
+  }
+
+  foreach (const string& line, strings::tokenize(filesystems.get(), "\n")) {
+    vector<string> tokens = strings::tokenize(line, "\t ");
+    foreach (const string& token, tokens) {
+      if (token == "overlay" || token == "overlayfs") {
+        return token;
+      }
+    }
+  }
+
+  return Error("Overlay filesystem is not supported by the kernel");
+}
+
+
+// Returns the scratch directory in which the upper (writable) and
+// work directories for the rootfs are created. It lives under the
+// backend directory next to 'rootfses' so that it is removed along
+// with the container directory:
+// <backend_dir>
+// |-- rootfses
+// |   |-- <rootfs_id> (the overlay mount)
+// |-- scratch
+//     |-- <rootfs_id>
+//         |-- upperdir
+//         |-- workdir
+static string getScratchDir(const string& rootfs)
+{
+  return path::join(
+      Path(Path(rootfs).dirname()).dirname(),
+      "scratch",
+      Path(rootfs).basename());
+}
+
+
+Try<Owned<Backend>> OverlayBackend::create(const Flags&)
+{
+  Result<string> user = os::user();
+  if (!user.isSome()) {
+    return Error("Failed to determine user: " +
+                 (user.isError() ? user.error() : "username not found"));
+  }
+
+  if (user.get() != "root") {
+    return Error("OverlayBackend requires root privileges");
+  }
+
+  Try<string> fsname = detectOverlayFs();
+  if (fsname.isError()) {
+    return Error(fsname.error());
+  }
+
+  return Owned<Backend>(new OverlayBackend(
+      Owned<OverlayBackendProcess>(new OverlayBackendProcess(fsname.get()))));
+}
+
+
+OverlayBackend::~OverlayBackend()
+{
+  terminate(process.get());
+  wait(process.get());
+}
+
+
+OverlayBackend::OverlayBackend(Owned<OverlayBackendProcess> _process)
+  : process(_process)
+{
+  spawn(CHECK_NOTNULL(process.get()));
+}
+
+
+Future<Nothing> OverlayBackend::provision(
+    const vector<string>& layers,
+    const string& rootfs)
+{
+  return dispatch(
+      process.get(), &OverlayBackendProcess::provision, layers, rootfs);
+}
+
+
+Future<bool> OverlayBackend::destroy(const string& rootfs)
+{
+  return dispatch(process.get(), &OverlayBackendProcess::destroy, rootfs);
+}
+
+
+Future<Nothing> OverlayBackendProcess::provision(
+    const vector<string>& layers,
+    const string& rootfs)
+{
+  if (layers.size() == 0) {
+    return Failure("No filesystem layer provided");
+  }
+
+  Try<Nothing> mkdir = os::mkdir(rootfs);
+  if (mkdir.isError()) {
+    return Failure(
+        "Failed to create container rootfs at '" + rootfs +
+        "': " + mkdir.error());
+  }
+
+  const string scratchDir = getScratchDir(rootfs);
+  const string upperdir = path::join(scratchDir, "upperdir");
+  const string workdir = path::join(scratchDir, "workdir");
+
+  mkdir = os::mkdir(upperdir);
+  if (mkdir.isError()) {
+    return Failure(
+        "Failed to create upper directory at '" + upperdir +
+        "': " + mkdir.error());
+  }
+
+  mkdir = os::mkdir(workdir);
+  if (mkdir.isError()) {
+    return Failure(
+        "Failed to create work directory at '" + workdir +
+        "': " + mkdir.error());
+  }
+
+  // The layer directories are separated by colons in the mount
+  // options, so they must not contain one.
+  foreach (const string& layer, layers) {
+    if (strings::contains(layer, ":")) {
+      return Failure(
+          "Failed to mount the overlay filesystem: layer path '" +
+          layer + "' contains a colon");
+    }
+  }
+
+  // The leftmost lower layer has the highest precedence while the
+  // Backend interface specifies that the last layer in the list can
+  // overwrite the previous ones, so we stack the layers in reverse
+  // order.
+  const string lowerdir =
+    strings::join(":", vector<string>(layers.rbegin(), layers.rend()));
+
+  Try<Nothing> mount = fs::mount(
+      fsname,
+      rootfs,
+      fsname,
+      0,
+      "lowerdir=" + lowerdir +
+      ",upperdir=" + upperdir +
+      ",workdir=" + workdir);
+
+  if (mount.isError()) {
+    return Failure(
+        "Failed to mount the overlay filesystem at '" + rootfs +
+        "': " + mount.error());
+  }
+
+  return Nothing();
+}
+
+
+Future<bool> OverlayBackendProcess::destroy(const string& rootfs)
+{
+  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
+
+  if (mountTable.isError()) {
+    return Failure("Failed to read mount table: " + mountTable.error());
+  }
+
+  foreach (const fs::MountInfoTable::Entry& entry, mountTable.get().entries) {
+    if (entry.target == rootfs) {
+      // NOTE: This would fail if the rootfs is still in use.
+      Try<Nothing> unmount = fs::unmount(entry.target);
+      if (unmount.isError()) {
+        return Failure(
+            "Failed to unmount the overlay rootfs '" + rootfs + "': " +
+            unmount.error());
+      }
+
+      Try<Nothing> rmdir = os::rmdir(rootfs);
+      if (rmdir.isError()) {
+        return Failure(
+            "Failed to remove rootfs mount point '" + rootfs + "': " +
+            rmdir.error());
+      }
+
+      // Remove the upper and work directories for this rootfs.
+      const string scratchDir = getScratchDir(rootfs);
+      if (os::exists(scratchDir)) {
+        rmdir = os::rmdir(scratchDir);
+        if (rmdir.isError()) {
+          return Failure(
+              "Failed to remove scratch directory '" + scratchDir + "': " +
+              rmdir.error());
+        }
+      }
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
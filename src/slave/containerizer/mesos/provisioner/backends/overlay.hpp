@@ -0,0 +1,64 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __PROVISIONER_BACKENDS_OVERLAY_HPP__
+#define __PROVISIONER_BACKENDS_OVERLAY_HPP__
+
+#include "slave/containerizer/mesos/provisioner/backend.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class OverlayBackendProcess;
+
+
+// This backend mounts the image layers read-only into the rootfs
+// using the overlay (or overlayfs) filesystem with a per-rootfs
+// upper (writable) directory, so provisioning requires (nearly)
+// zero IO regardless of the image size and containers only consume
+// disk space for the files they modify. It requires the kernel to
+// support the overlay filesystem (3.18 or newer, or a kernel with
+// overlayfs backported).
+class OverlayBackend : public Backend
+{
+public:
+  virtual ~OverlayBackend();
+
+  // OverlayBackend doesn't use any flag.
+  static Try<process::Owned<Backend>> create(const Flags&);
+
+  virtual process::Future<Nothing> provision(
+      const std::vector<std::string>& layers,
+      const std::string& rootfs);
+
+  virtual process::Future<bool> destroy(const std::string& rootfs);
+
+private:
+  explicit OverlayBackend(process::Owned<OverlayBackendProcess> process);
+
+  OverlayBackend(const OverlayBackend&); // Not copyable.
+  OverlayBackend& operator=(const OverlayBackend&); // Not assignable.
+
+  process::Owned<OverlayBackendProcess> process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __PROVISIONER_BACKENDS_OVERLAY_HPP__
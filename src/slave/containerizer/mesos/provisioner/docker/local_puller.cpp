@@ -58,16 +58,19 @@ public:
 
   Future<list<pair<string, string>>> pull(
       const Image::Name& name,
-      const string& directory);
+      const string& directory,
+      const hashset<string>& storedLayers);
 
 private:
   Future<list<pair<string, string>>> putImage(
       const Image::Name& name,
-      const string& directory);
+      const string& directory,
+      const hashset<string>& storedLayers);
 
   Future<list<pair<string, string>>> putLayers(
       const string& directory,
-      const vector<string>& layerIds);
+      const vector<string>& layerIds,
+      const hashset<string>& storedLayers);
 
   const string archivesDir;
 };
@@ -107,15 +110,22 @@ LocalPuller::~LocalPuller()
 
 Future<list<pair<string, string>>> LocalPuller::pull(
     const Image::Name& name,
-    const Path& directory)
+    const Path& directory,
+    const hashset<string>& storedLayers)
 {
-  return dispatch(process.get(), &LocalPullerProcess::pull, name, directory);
+  return dispatch(
+      process.get(),
+      &LocalPullerProcess::pull,
+      name,
+      directory,
+      storedLayers);
 }
 
 
 Future<list<pair<string, string>>> LocalPullerProcess::pull(
     const Image::Name& name,
-    const string& directory)
+    const string& directory,
+    const hashset<string>& storedLayers)
 {
   const string tarPath = paths::getImageArchiveTarPath(
       archivesDir,
@@ -130,7 +140,7 @@ Future<list<pair<string, string>>> LocalPullerProcess::pull(
           << "' to '" << directory << "'";
 
   return untar(tarPath, directory)
-    .then(defer(self(), &Self::putImage, name, directory));
+    .then(defer(self(), &Self::putImage, name, directory, storedLayers));
 }
 
 
@@ -163,7 +173,8 @@ static Result<string> getParentId(
 
 Future<list<pair<string, string>>> LocalPullerProcess::putImage(
     const Image::Name& name,
-    const string& directory)
+    const string& directory,
+    const hashset<string>& storedLayers)
 {
   Try<string> value =
     os::read(paths::getImageArchiveRepositoriesPath(directory));
@@ -214,16 +225,31 @@ Future<list<pair<string, string>>> LocalPullerProcess::putImage(
                    "': " + parentId.error());
   }
 
-  return putLayers(directory, layerIds);
+  return putLayers(directory, layerIds, storedLayers);
 }
 
 
 Future<list<pair<string, string>>> LocalPullerProcess::putLayers(
     const string& directory,
-    const vector<string>& layerIds)
+    const vector<string>& layerIds,
+    const hashset<string>& storedLayers)
 {
   list<Future<pair<string, string>>> futures;
   foreach (const string& layerId, layerIds) {
+    // Layers that are already in the store are not extracted again.
+    // The store skips moving them when it sees that nothing was
+    // staged.
+    if (storedLayers.contains(layerId)) {
+      VLOG(1) << "Skipping layer '" << layerId
+              << "' as it is already stored";
+
+      futures.push_back(pair<string, string>(
+          layerId,
+          paths::getImageArchiveLayerPath(directory, layerId)));
+
+      continue;
+    }
+
     const string tarredLayer =
       paths::getImageArchiveLayerTarPath(directory, layerId);
     futures.push_back(untarLayer(tarredLayer, directory, layerId));
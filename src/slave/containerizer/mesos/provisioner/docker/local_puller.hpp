@@ -47,7 +47,8 @@ public:
 
   process::Future<std::list<std::pair<std::string, std::string>>> pull(
       const Image::Name& name,
-      const Path& directory);
+      const Path& directory,
+      const hashset<std::string>& storedLayers);
 
 private:
   explicit LocalPuller(process::Owned<LocalPullerProcess>& _process);
@@ -24,6 +24,7 @@
 #include <stout/os.hpp>
 #include <stout/protobuf.hpp>
 
+#include <process/clock.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/owned.hpp>
@@ -62,18 +63,34 @@ public:
 
   Future<Option<Image>> get(const Image::Name& name);
 
-  // TODO(chenlily): Implement removal of unreferenced images.
+  Future<Nothing> putLayer(const string& layerId);
+
+  Future<hashset<string>> layers();
+
+  Future<vector<Image>> images();
+
+  Future<hashset<string>> remove(const vector<string>& imageNames);
 
 private:
   // Write out metadata manager state to persistent store.
   Try<Nothing> persist();
 
+  // Write out the set of completely stored layers to persistent
+  // store.
+  Try<Nothing> persistLayers();
+
   const Flags flags;
 
   // This is a lookup table for images that are stored in memory. It is keyed
   // by image name.
   // For example, "ubuntu:14.04" -> ubuntu14:04 Image.
   hashmap<string, Image> storedImages;
+
+  // The ids of the layers that have been completely stored on disk.
+  // Layers are checkpointed here as they are moved into the store so
+  // that an interrupted pull resumes rather than refetches after a
+  // restart.
+  hashset<string> storedLayers;
 };
 
 
@@ -123,6 +140,31 @@ Future<Option<Image>> MetadataManager::get(const Image::Name& name)
 }
 
 
+Future<Nothing> MetadataManager::putLayer(const string& layerId)
+{
+  return dispatch(process.get(), &MetadataManagerProcess::putLayer, layerId);
+}
+
+
+Future<hashset<string>> MetadataManager::layers()
+{
+  return dispatch(process.get(), &MetadataManagerProcess::layers);
+}
+
+
+Future<vector<Image>> MetadataManager::images()
+{
+  return dispatch(process.get(), &MetadataManagerProcess::images);
+}
+
+
+Future<hashset<string>> MetadataManager::remove(
+    const vector<string>& imageNames)
+{
+  return dispatch(process.get(), &MetadataManagerProcess::remove, imageNames);
+}
+
+
 Future<Image> MetadataManagerProcess::put(
     const Image::Name& name,
     const vector<string>& layerIds)
@@ -135,6 +177,8 @@ Future<Image> MetadataManagerProcess::put(
     dockerImage.add_layer_ids(layerId);
   }
 
+  dockerImage.set_last_accessed(Clock::now().secs());
+
   storedImages[imageName] = dockerImage;
 
   Try<Nothing> status = persist();
@@ -155,10 +199,91 @@ Future<Option<Image>> MetadataManagerProcess::get(
     return None();
   }
 
+  // Touch the image for least-recently-used eviction. The new access
+  // time is persisted lazily with the next checkpoint: losing it on
+  // a crash only makes eviction slightly less accurate.
+  storedImages[imageName].set_last_accessed(Clock::now().secs());
+
   return storedImages[imageName];
 }
 
 
+Future<vector<Image>> MetadataManagerProcess::images()
+{
+  vector<Image> result;
+
+  foreachvalue (const Image& image, storedImages) {
+    result.push_back(image);
+  }
+
+  return result;
+}
+
+
+Future<hashset<string>> MetadataManagerProcess::remove(
+    const vector<string>& imageNames)
+{
+  foreach (const string& imageName, imageNames) {
+    storedImages.erase(imageName);
+  }
+
+  // Compute the layers still referenced by the remaining images and
+  // drop the checkpointed layers that are no longer among them.
+  hashset<string> referenced;
+
+  foreachvalue (const Image& image, storedImages) {
+    foreach (const string& layerId, image.layer_ids()) {
+      referenced.insert(layerId);
+    }
+  }
+
+  hashset<string> remaining;
+
+  foreach (const string& layerId, storedLayers) {
+    if (referenced.contains(layerId)) {
+      remaining.insert(layerId);
+    }
+  }
+
+  storedLayers = remaining;
+
+  Try<Nothing> status = persist();
+  if (status.isError()) {
+    return Failure("Failed to save state of Docker images: " + status.error());
+  }
+
+  status = persistLayers();
+  if (status.isError()) {
+    return Failure("Failed to save state of stored layers: " + status.error());
+  }
+
+  return referenced;
+}
+
+
+Future<Nothing> MetadataManagerProcess::putLayer(const string& layerId)
+{
+  if (storedLayers.contains(layerId)) {
+    return Nothing();
+  }
+
+  storedLayers.insert(layerId);
+
+  Try<Nothing> status = persistLayers();
+  if (status.isError()) {
+    return Failure("Failed to save state of stored layers: " + status.error());
+  }
+
+  return Nothing();
+}
+
+
+Future<hashset<string>> MetadataManagerProcess::layers()
+{
+  return storedLayers;
+}
+
+
 Try<Nothing> MetadataManagerProcess::persist()
 {
   Images images;
@@ -177,8 +302,76 @@ Try<Nothing> MetadataManagerProcess::persist()
 }
 
 
+Try<Nothing> MetadataManagerProcess::persistLayers()
+{
+  Layers layers;
+
+  foreach (const string& layerId, storedLayers) {
+    layers.add_layer_ids(layerId);
+  }
+
+  Try<Nothing> status = state::checkpoint(
+      paths::getStoredLayersPath(flags.docker_store_dir), layers);
+  if (status.isError()) {
+    return Error("Failed to perform checkpoint: " + status.error());
+  }
+
+  return Nothing();
+}
+
+
+// Recover the set of completely stored layers, dropping any whose
+// rootfs is no longer on disk.
+static Try<hashset<string>> recoverLayers(const Flags& flags)
+{
+  hashset<string> recovered;
+
+  const string storedLayersPath =
+    paths::getStoredLayersPath(flags.docker_store_dir);
+
+  if (!os::exists(storedLayersPath)) {
+    return recovered;
+  }
+
+  Result<Layers> layers = ::protobuf::read<Layers>(storedLayersPath);
+  if (layers.isError()) {
+    return Error("Failed to read layers from '" + storedLayersPath + "' " +
+                 layers.error());
+  }
+
+  if (layers.isNone()) {
+    // This could happen if the slave died after opening the file for
+    // writing but before persisted on disk.
+    return Error("Unexpected empty layers file '" + storedLayersPath + "'");
+  }
+
+  foreach (const string& layerId, layers.get().layer_ids()) {
+    const string rootfsPath =
+      paths::getImageLayerRootfsPath(flags.docker_store_dir, layerId);
+
+    if (!os::exists(rootfsPath)) {
+      LOG(WARNING) << "Skipped loading stored layer '" << layerId << "'";
+      continue;
+    }
+
+    recovered.insert(layerId);
+  }
+
+  return recovered;
+}
+
+
 Future<Nothing> MetadataManagerProcess::recover()
 {
+  Try<hashset<string>> layers = recoverLayers(flags);
+  if (layers.isError()) {
+    return Failure(layers.error());
+  }
+
+  storedLayers = layers.get();
+
+  LOG(INFO) << "Loaded " << storedLayers.size() << " Docker layers";
+
   string storedImagesPath = paths::getStoredImagesPath(flags.docker_store_dir);
 
   if (!os::exists(storedImagesPath)) {
@@ -19,8 +19,10 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/option.hpp>
 #include <stout/protobuf.hpp>
@@ -49,8 +51,9 @@ class MetadataManagerProcess;
  * provisioner that are stored on disk. It keeps track of the layers
  * that Docker images are composed of and recovers Image objects
  * upon initialization by checking for dependent layers stored on disk.
- * Currently, image layers are stored indefinitely, with no garbage
- * collection of unreferenced image layers.
+ * It also records when each image was last used so the store can
+ * evict images in least-recently-used order when it exceeds its
+ * size budget.
  */
 class MetadataManager
 {
@@ -86,6 +89,39 @@ public:
    */
   process::Future<Option<Image>> get(const Image::Name& name);
 
+  /**
+   * Record that a layer has been completely stored on disk and
+   * persist the reference store state. Pulls resumed after a restart
+   * skip refetching checkpointed layers.
+   *
+   * @param layerId the id of the stored layer.
+   */
+  process::Future<Nothing> putLayer(const std::string& layerId);
+
+  /**
+   * Retrieve the ids of all completely stored layers.
+   */
+  process::Future<hashset<std::string>> layers();
+
+  /**
+   * Retrieve all stored Images, including their last access times.
+   */
+  process::Future<std::vector<Image>> images();
+
+  /**
+   * Remove the given images, drop the checkpointed layers no longer
+   * referenced by any remaining image and persist the reference
+   * store state.
+   *
+   * @param imageNames the names of the Docker images to remove.
+   *
+   * @return the ids of the layers still referenced by the remaining
+   *         images; layers outside this set can be deleted from the
+   *         store directory.
+   */
+  process::Future<hashset<std::string>> remove(
+      const std::vector<std::string>& imageNames);
+
 private:
   explicit MetadataManager(process::Owned<MetadataManagerProcess> process);
 
@@ -114,6 +114,12 @@ string getStoredImagesPath(const string& storeDir)
   return path::join(storeDir, "storedImages");
 }
 
+
+string getStoredLayersPath(const string& storeDir)
+{
+  return path::join(storeDir, "storedLayers");
+}
+
 } // namespace paths {
 } // namespace docker {
 } // namespace slave {
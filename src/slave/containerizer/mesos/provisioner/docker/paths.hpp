@@ -44,6 +44,7 @@ namespace paths {
  *           |-- json(manifest)
  *           |-- VERSION
  *    |--storedImages (file holding on cached images)
+ *    |--storedLayers (file holding on completely stored layers)
  */
 
 // TODO(gilbert): Clean up any unused method after refactoring.
@@ -98,6 +99,9 @@ std::string getImageLayerRootfsPath(
 
 std::string getStoredImagesPath(const std::string& storeDir);
 
+
+std::string getStoredLayersPath(const std::string& storeDir);
+
 } // namespace paths {
 } // namespace docker {
 } // namespace slave {
@@ -15,18 +15,14 @@
 // limitations under the License.
 
 #include <string>
-#include <tuple>
 #include <utility>
-#include <vector>
 
 #include <stout/os.hpp>
 
+#include <process/async.hpp>
 #include <process/check.hpp>
-#include <process/collect.hpp>
-#include <process/io.hpp>
-#include <process/subprocess.hpp>
 
-#include "common/status_utils.hpp"
+#include "slave/containerizer/mesos/provisioner/extractor.hpp"
 
 #include "slave/containerizer/mesos/provisioner/docker/local_puller.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
@@ -35,13 +31,10 @@
 
 using std::pair;
 using std::string;
-using std::tuple;
-using std::vector;
 
 using process::Failure;
 using process::Future;
 using process::Owned;
-using process::Subprocess;
 
 namespace mesos {
 namespace internal {
@@ -71,56 +64,18 @@ Try<Owned<Puller>> Puller::create(const Flags& flags)
 
 Future<Nothing> untar(const string& file, const string& directory)
 {
-  const vector<string> argv = {
-    "tar",
-    "-C",
-    directory,
-    "-x",
-    "-f",
-    file
-  };
-
-  Try<Subprocess> s = subprocess(
-      "tar",
-      argv,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE());
-
-  if (s.isError()) {
-    return Failure("Failed to execute the subprocess: " + s.error());
-  }
-
-  return await(
-      s.get().status(),
-      process::io::read(s.get().err().get()))
-    .then([](const tuple<
-        Future<Option<int>>,
-        Future<string>>& t) -> Future<Nothing> {
-      Future<Option<int>> status = std::get<0>(t);
-      if (!status.isReady()) {
-        return Failure(
-          "Failed to get the exit status of the subprocess: " +
-          (status.isFailed() ? status.failure() : "discarded"));
-      }
-
-      Future<string> error = std::get<1>(t);
-      if (!error.isReady()) {
+  // NOTE: The extraction makes a single blocking pass over the
+  // archive (computing its digest along the way), so we run it off
+  // the calling process.
+  return process::async(&extractor::extract, file, directory)
+    .then([file](const Try<string>& digest) -> Future<Nothing> {
+      if (digest.isError()) {
         return Failure(
-          "Failed to read stderr from the subprocess: " +
-          (error.isFailed() ? error.failure() : "discarded"));
+            "Failed to extract '" + file + "': " + digest.error());
       }
 
-      if (status->isNone()) {
-        return Failure("Failed to reap the subprocess");
-      }
-
-      if (status->get() != 0) {
-        return Failure(
-            "Unexpected result from the subprocess: " +
-            WSTRINGIFY(status->get()) +
-            ", stderr='" + error.get() + "'");
-      }
+      VLOG(1) << "Extracted '" << file << "' "
+              << "(sha512: " << digest.get() << ")";
 
       return Nothing();
     });
@@ -21,6 +21,7 @@
 #include <utility>
 
 #include <stout/duration.hpp>
+#include <stout/hashset.hpp>
 #include <stout/option.hpp>
 #include <stout/path.hpp>
 #include <stout/try.hpp>
@@ -52,12 +53,15 @@ public:
    *
    * @param name The name of the image.
    * @param directory The target directory to store the layers.
+   * @param storedLayers The ids of the layers that are already in the
+   *        store; the puller skips fetching and extracting these.
    * @return list of layers maped to its local directory ordered by its
    *         dependency.
    */
   virtual process::Future<std::list<std::pair<std::string, std::string>>> pull(
       const docker::Image::Name& name,
-      const Path& directory) = 0;
+      const Path& directory,
+      const hashset<std::string>& storedLayers) = 0;
 };
 
 
@@ -17,6 +17,7 @@
 #include <vector>
 #include <ostream>
 
+#include <process/clock.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/http.hpp>
@@ -27,6 +28,7 @@
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
@@ -42,6 +44,7 @@
 using std::string;
 using std::vector;
 
+using process::Clock;
 using process::Failure;
 using process::Future;
 using process::Owned;
@@ -81,12 +84,24 @@ private:
       const Owned<TokenManager>& tokenManager,
       const Option<Credentials>& credentials);
 
+  // Issues a GET for the URL, first consulting the redirect and
+  // authentication scope caches below so that repeated requests skip
+  // round trips that earlier requests already paid for.
   Future<http::Response> doHttpGet(
       const http::URL& url,
       const Option<http::Headers>& headers,
       bool isStreaming,
       bool resend,
-      const Option<string>& lastResponse) const;
+      const Option<string>& lastResponse);
+
+  // Issues the GET without consulting the caches; handling the '401
+  // Unauthorized' and redirect responses below is what loads them.
+  Future<http::Response> _doHttpGet(
+      const http::URL& url,
+      const Option<http::Headers>& headers,
+      bool isStreaming,
+      bool resend,
+      const Option<string>& lastResponse);
 
   Try<http::Headers> getAuthenticationAttributes(
       const http::Response& httpResponse) const;
@@ -98,12 +113,13 @@ private:
   Future<http::Response> handleHttpUnauthResponse(
       const http::Response& httpResponse,
       const http::URL& url,
-      bool isStreaming) const;
+      bool isStreaming);
 
   Future<http::Response> handleHttpRedirect(
       const http::Response& httpResponse,
+      const http::URL& url,
       const Option<http::Headers>& headers,
-      bool isStreaming) const;
+      bool isStreaming);
 
   Future<size_t> saveBlob(
       int fd,
@@ -113,10 +129,47 @@ private:
 
   std::string getAPIVersion() const;
 
+  // How long a cached redirect location stays usable. Registries
+  // typically redirect blob downloads to signed object store URLs
+  // with short lifetimes, so the cache only aims to collapse the
+  // chain for closely spaced fetches (e.g. a storm of pulls after an
+  // agent is reimaged).
+  static const Duration REDIRECT_CACHE_TTL;
+
+  // The authentication "service" and "scope" attributes a registry
+  // answered with on a previous '401 Unauthorized' for the same
+  // repository. Together with the token manager's token cache this
+  // lets later requests attach a Bearer token up front instead of
+  // paying an unauthenticated round trip per manifest and blob
+  // request. Since there is one registry client per agent, the cache
+  // is shared by all concurrent pulls.
+  struct AuthScope
+  {
+    std::string service;
+    std::string scope;
+  };
+
+  struct CachedRedirect
+  {
+    http::URL location;
+    process::Time expiry;
+  };
+
+  // Returns the repository portion of a manifest or blob URL path,
+  // under which the registry scopes authentication.
+  static std::string authScopeCacheKey(const http::URL& url);
+
+  // Returns the cached redirect location for the URL if it is still
+  // fresh; expired entries are dropped.
+  Option<http::URL> getCachedRedirect(const http::URL& url);
+
   const http::URL registryServer_;
   Owned<TokenManager> tokenManager_;
   const Option<Credentials> credentials_;
 
+  hashmap<std::string, AuthScope> authScopeCache_;
+  hashmap<std::string, CachedRedirect> redirectCache_;
+
   RegistryClientProcess(const RegistryClientProcess&) = delete;
   RegistryClientProcess& operator = (const RegistryClientProcess&) = delete;
 };
@@ -215,6 +268,9 @@ RegistryClientProcess::RegistryClientProcess(
     credentials_(credentials) {}
 
 
+const Duration RegistryClientProcess::REDIRECT_CACHE_TTL = Seconds(60);
+
+
 // RFC6750, section 3.
 Try<http::Headers> RegistryClientProcess::getAuthenticationAttributes(
     const http::Response& httpResponse) const
@@ -257,7 +313,7 @@ Try<http::Headers> RegistryClientProcess::getAuthenticationAttributes(
 Future<http::Response> RegistryClientProcess::handleHttpUnauthResponse(
     const http::Response& httpResponse,
     const http::URL& url,
-    bool isStreaming) const
+    bool isStreaming)
 {
   Try<http::Headers> authenticationAttributes =
     getAuthenticationAttributes(httpResponse);
@@ -280,10 +336,17 @@ Future<http::Response> RegistryClientProcess::handleHttpUnauthResponse(
         "from authorization server");
   }
 
+  const string service = authenticationAttributes.get().at("service");
+  const string scope = authenticationAttributes.get().at("scope");
+
+  // Remember the repository's authentication scope so that later
+  // requests can attach a token up front (see 'doHttpGet').
+  authScopeCache_[authScopeCacheKey(url)] = AuthScope{service, scope};
+
   // TODO(jojy): Currently only handling TLS/cert authentication.
   Future<Token> tokenResponse = tokenManager_->getToken(
-      authenticationAttributes.get().at("service"),
-      authenticationAttributes.get().at("scope"),
+      service,
+      scope,
       None());
 
   return tokenResponse
@@ -419,8 +482,9 @@ Future<string> RegistryClientProcess::handleHttpBadResponse(
 
 Future<http::Response> RegistryClientProcess::handleHttpRedirect(
     const http::Response& httpResponse,
+    const http::URL& url,
     const Option<http::Headers>& headers,
-    bool isStreaming) const
+    bool isStreaming)
 {
   if (httpResponse.headers.find("Location") ==
       httpResponse.headers.end()) {
@@ -443,6 +507,13 @@ Future<http::Response> RegistryClientProcess::handleHttpRedirect(
         "' found in redirect location");
   }
 
+  // Remember this hop so that later fetches of the same URL can jump
+  // straight to the location (see 'doHttpGet'). Since every hop of a
+  // multi-hop chain records its own next hop, repeated fetches
+  // collapse the whole chain.
+  redirectCache_[stringify(url)] =
+    CachedRedirect{locationUrl.get(), Clock::now() + REDIRECT_CACHE_TTL};
+
   return doHttpGet(
       locationUrl.get(),
       headers,
@@ -452,12 +523,99 @@ Future<http::Response> RegistryClientProcess::handleHttpRedirect(
 }
 
 
+string RegistryClientProcess::authScopeCacheKey(const http::URL& url)
+{
+  // Manifest and blob URLs look like
+  // "<version>/<repository>/manifests/<tag>" and
+  // "<version>/<repository>/blobs/<digest>"; the registry scopes
+  // authentication by repository.
+  const string& path = url.path;
+
+  size_t pos = path.rfind("/manifests/");
+  if (pos == string::npos) {
+    pos = path.rfind("/blobs/");
+  }
+
+  if (pos == string::npos) {
+    return path;
+  }
+
+  return path.substr(0, pos);
+}
+
+
+Option<http::URL> RegistryClientProcess::getCachedRedirect(
+    const http::URL& url)
+{
+  const string key = stringify(url);
+
+  if (redirectCache_.contains(key)) {
+    if (Clock::now() < redirectCache_.at(key).expiry) {
+      return redirectCache_.at(key).location;
+    }
+
+    redirectCache_.erase(key);
+  }
+
+  return None();
+}
+
+
 Future<http::Response> RegistryClientProcess::doHttpGet(
     const http::URL& url,
     const Option<http::Headers>& headers,
     bool isStreaming,
     bool resend,
-    const Option<string>& lastResponseStatus) const
+    const Option<string>& lastResponseStatus)
+{
+  // If a previous request for this URL was redirected, jump straight
+  // to the recorded location. If the location has gone stale (e.g.,
+  // the signature of an object store URL expired) we fall back to
+  // walking the full chain again.
+  Option<http::URL> redirect = getCachedRedirect(url);
+  if (redirect.isSome()) {
+    return _doHttpGet(redirect.get(), headers, isStreaming, false, None())
+      .repair(defer(self(), [=](const Future<http::Response>&)
+          -> Future<http::Response> {
+        redirectCache_.erase(stringify(url));
+
+        return _doHttpGet(
+            url, headers, isStreaming, resend, lastResponseStatus);
+      }));
+  }
+
+  // If we already know the authentication scope of this repository,
+  // attach a Bearer token up front (the token manager caches tokens
+  // until they expire), saving the unauthenticated round trip that
+  // would otherwise precede every manifest and blob request.
+  if (resend && headers.isNone()) {
+    Option<AuthScope> authScope = authScopeCache_.get(authScopeCacheKey(url));
+    if (authScope.isSome()) {
+      return tokenManager_->getToken(
+          authScope.get().service,
+          authScope.get().scope,
+          None())
+        .then(defer(self(), [=](const Token& token) {
+          http::Headers authHeaders = {
+            {"Authorization", "Bearer " + token.raw}
+          };
+
+          return _doHttpGet(
+              url, authHeaders, isStreaming, resend, lastResponseStatus);
+        }));
+    }
+  }
+
+  return _doHttpGet(url, headers, isStreaming, resend, lastResponseStatus);
+}
+
+
+Future<http::Response> RegistryClientProcess::_doHttpGet(
+    const http::URL& url,
+    const Option<http::Headers>& headers,
+    bool isStreaming,
+    bool resend,
+    const Option<string>& lastResponseStatus)
 {
   Future<http::Response> response;
 
@@ -506,7 +664,7 @@ Future<http::Response> RegistryClientProcess::doHttpGet(
 
       // Handle redirect.
       if (httpResponse.status == "307 Temporary Redirect") {
-        return handleHttpRedirect(httpResponse, headers, isStreaming);
+        return handleHttpRedirect(httpResponse, url, headers, isStreaming);
       }
 
       return Failure("Invalid response: " + httpResponse.status);
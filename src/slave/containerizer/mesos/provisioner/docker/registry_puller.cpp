@@ -58,7 +58,8 @@ public:
 
   process::Future<list<pair<string, string>>> pull(
       const Image::Name& imageName,
-      const Path& directory);
+      const Path& directory,
+      const hashset<string>& storedLayers);
 
 private:
   explicit RegistryPullerProcess(
@@ -71,18 +72,17 @@ private:
       const string& blobSum,
       const string& id);
 
-  Future<list<pair<string, string>>> downloadLayers(
-      const spec::v2::ImageManifest& manifest,
+  Future<pair<string, string>> downloadAndUntarLayer(
       const Image::Name& imageName,
-      const Path& downloadDir);
+      const Path& directory,
+      const string& blobSum,
+      const string& id);
 
-  process::Future<list<pair<string, string>>> _pull(
+  Future<list<pair<string, string>>> pullLayers(
+      const spec::v2::ImageManifest& manifest,
       const Image::Name& imageName,
-      const Path& downloadDir);
-
-  Future<list<pair<string, string>>> untarLayers(
-    const Future<list<pair<string, string>>>& layerFutures,
-    const Path& downloadDir);
+      const Path& downloadDir,
+      const hashset<string>& storedLayers);
 
   Owned<RegistryClient> registryClient_;
   const Duration pullTimeout_;
@@ -122,13 +122,15 @@ RegistryPuller::~RegistryPuller()
 
 Future<list<pair<string, string>>> RegistryPuller::pull(
     const Image::Name& imageName,
-    const Path& downloadDir)
+    const Path& downloadDir,
+    const hashset<string>& storedLayers)
 {
   return dispatch(
       process_.get(),
       &RegistryPullerProcess::pull,
       imageName,
-      downloadDir);
+      downloadDir,
+      storedLayers);
 }
 
 
@@ -224,20 +226,36 @@ Future<pair<string, string>> RegistryPullerProcess::downloadLayer(
 }
 
 
+Future<pair<string, string>> RegistryPullerProcess::downloadAndUntarLayer(
+    const Image::Name& imageName,
+    const Path& directory,
+    const string& blobSum,
+    const string& layerId)
+{
+  // NOTE: The untar is chained onto this layer's download so that
+  // extraction overlaps with the downloads of the other layers
+  // instead of waiting for all of them to finish.
+  return downloadLayer(imageName, directory, blobSum, layerId)
+    .then([directory](const pair<string, string>& layerInfo) {
+      VLOG(1) << "Untarring layer '" << layerInfo.first
+              << "' downloaded from registry to directory '"
+              << directory << "'";
+
+      return untarLayer(layerInfo.second, directory, layerInfo.first);
+    });
+}
+
+
 Future<list<pair<string, string>>> RegistryPullerProcess::pull(
     const Image::Name& imageName,
-    const Path& directory)
+    const Path& directory,
+    const hashset<string>& storedLayers)
 {
   // TODO(jojy): Have one outgoing manifest request per image.
   return registryClient_->getManifest(imageName)
-    .then(process::defer(self(), [this, directory, imageName](
+    .then(process::defer(self(), [this, directory, imageName, storedLayers](
         const spec::v2::ImageManifest& manifest) {
-      return downloadLayers(manifest, imageName, directory);
-    }))
-    .then(process::defer(self(), [this, directory](
-        const Future<list<pair<string, string>>>& layerFutures)
-        -> Future<list<pair<string, string>>> {
-      return untarLayers(layerFutures, directory);
+      return pullLayers(manifest, imageName, directory, storedLayers);
     }))
     .after(pullTimeout_, [imageName](
         Future<list<pair<string, string>>> future) {
@@ -248,47 +266,47 @@ Future<list<pair<string, string>>> RegistryPullerProcess::pull(
 }
 
 
-Future<list<pair<string, string>>> RegistryPullerProcess::downloadLayers(
+Future<list<pair<string, string>>> RegistryPullerProcess::pullLayers(
     const spec::v2::ImageManifest& manifest,
     const Image::Name& imageName,
-    const Path& directory)
+    const Path& directory,
+    const hashset<string>& storedLayers)
 {
-  list<Future<pair<string, string>>> downloadFutures;
+  list<Future<pair<string, string>>> layerFutures;
 
   CHECK_EQ(manifest.fslayers_size(), manifest.history_size());
 
   for (int i = 0; i < manifest.fslayers_size(); i++) {
     CHECK(manifest.history(i).has_v1());
 
-    downloadFutures.push_back(
-        downloadLayer(imageName,
-                      directory,
-                      manifest.fslayers(i).blobsum(),
-                      manifest.history(i).v1().id()));
-  }
+    const string layerId = manifest.history(i).v1().id();
 
-  // TODO(jojy): Delete downloaded files in the directory on discard and
-  // failure?
-  // TODO(jojy): Iterate through the futures and log the failed future.
-  return collect(downloadFutures);
-}
+    // Layers that are already in the store are not fetched again. The
+    // store skips moving them when it sees that nothing was staged.
+    if (storedLayers.contains(layerId)) {
+      VLOG(1) << "Skipping layer '" << layerId
+              << "' for image '" << stringify(imageName)
+              << "' as it is already stored";
 
+      layerFutures.push_back(pair<string, string>(
+          layerId,
+          paths::getImageArchiveLayerPath(directory, layerId)));
 
-Future<list<pair<string, string>>> RegistryPullerProcess::untarLayers(
-    const Future<list<pair<string, string>>>& layerFutures,
-    const Path& directory)
-{
-  list<Future<pair<string, string>>> untarFutures;
-
-  pair<string, string> layerInfo;
-  foreach (layerInfo, layerFutures.get()) {
-    VLOG(1) << "Untarring layer '" << layerInfo.first
-            << "' downloaded from registry to directory '" << directory << "'";
-    untarFutures.emplace_back(
-        untarLayer(layerInfo.second, directory, layerInfo.first));
+      continue;
+    }
+
+    layerFutures.push_back(
+        downloadAndUntarLayer(
+            imageName,
+            directory,
+            manifest.fslayers(i).blobsum(),
+            layerId));
   }
 
-  return collect(untarFutures);
+  // TODO(jojy): Delete downloaded files in the directory on discard and
+  // failure?
+  // TODO(jojy): Iterate through the futures and log the failed future.
+  return collect(layerFutures);
 }
 
 } // namespace docker {
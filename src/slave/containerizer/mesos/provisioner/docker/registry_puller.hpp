@@ -58,10 +58,13 @@ public:
    *
    * @param imageName local name of the image.
    * @param downloadDir path to which the layers should be downloaded.
+   * @param storedLayers ids of the layers already in the store that
+   *        do not need to be fetched.
    */
   process::Future<std::list<std::pair<std::string, std::string>>> pull(
       const Image::Name& imageName,
-      const Path& downloadDir);
+      const Path& downloadDir,
+      const hashset<std::string>& storedLayers);
 
 private:
   RegistryPuller(const process::Owned<RegistryPullerProcess>& process);
@@ -14,14 +14,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <list>
 #include <vector>
 
 #include <glog/logging.h>
 
+#include <stout/bytes.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
 
 #include <process/collect.hpp>
 #include <process/defer.hpp>
@@ -64,10 +68,18 @@ public:
 
   Future<ImageInfo> get(const mesos::Image& image);
 
+  Future<Nothing> prune(const std::vector<mesos::Image>& excludedImages);
+
 private:
   Future<Image> _get(const Image::Name& name, const Option<Image>& image);
   Future<ImageInfo> __get(const Image& image);
 
+  Future<Nothing> _prune(
+      const hashset<string>& excluded,
+      const std::vector<Image>& images);
+
+  Future<Nothing> __prune(const hashset<string>& referenced);
+
   Future<vector<string>> moveLayers(
       const std::list<pair<string, string>>& layerPaths);
 
@@ -154,6 +166,12 @@ Future<ImageInfo> Store::get(const mesos::Image& image)
 }
 
 
+Future<Nothing> Store::prune(const vector<mesos::Image>& excludedImages)
+{
+  return dispatch(process.get(), &StoreProcess::prune, excludedImages);
+}
+
+
 Future<ImageInfo> StoreProcess::get(const mesos::Image& image)
 {
   if (image.type() != mesos::Image::DOCKER) {
@@ -188,7 +206,15 @@ Future<Image> StoreProcess::_get(
   if (!pulling.contains(imageName)) {
     Owned<Promise<Image>> promise(new Promise<Image>());
 
-    Future<Image> future = puller->pull(name, Path(staging.get()))
+    // Pass the set of layers that are already in the store to the
+    // puller so that it does not refetch them. This lets a pull that
+    // was interrupted (e.g., by an agent restart) resume where the
+    // checkpointed layers left off.
+    Future<Image> future = metadataManager->layers()
+      .then(defer(self(), [this, name, staging](
+          const hashset<string>& storedLayers) {
+        return puller->pull(name, Path(staging.get()), storedLayers);
+      }))
       .then(defer(self(), &Self::moveLayers, lambda::_1))
       .then(defer(self(), &Self::storeImage, name, lambda::_1))
       .onAny(defer(self(), [this, imageName](const Future<Image>&) {
@@ -236,6 +262,172 @@ Future<Nothing> StoreProcess::recover()
 }
 
 
+// Returns the total size of the regular files under the given
+// directory (e.g., an image layer).
+static Bytes directorySize(const string& directory)
+{
+  Bytes total;
+
+  Try<std::list<string>> files = os::find(directory, "");
+  if (files.isError()) {
+    LOG(WARNING) << "Failed to list files under '" << directory
+                 << "': " << files.error();
+    return total;
+  }
+
+  foreach (const string& file, files.get()) {
+    Try<Bytes> size = os::stat::size(file);
+    if (size.isSome()) {
+      total += size.get();
+    }
+  }
+
+  return total;
+}
+
+
+Future<Nothing> StoreProcess::prune(const vector<mesos::Image>& excludedImages)
+{
+  // Without a size budget the store is unbounded and there is
+  // nothing to do.
+  if (flags.docker_store_size.isNone()) {
+    return Nothing();
+  }
+
+  hashset<string> excluded;
+  foreach (const mesos::Image& image, excludedImages) {
+    if (image.type() == mesos::Image::DOCKER) {
+      excluded.insert(stringify(parseImageName(image.docker().name())));
+    }
+  }
+
+  return metadataManager->images()
+    .then(defer(self(), &Self::_prune, excluded, lambda::_1));
+}
+
+
+Future<Nothing> StoreProcess::_prune(
+    const hashset<string>& excluded,
+    const vector<Image>& images)
+{
+  CHECK_SOME(flags.docker_store_size);
+
+  // Compute the size of each layer once; layers shared between
+  // images count only once towards the total.
+  hashmap<string, Bytes> layerSizes;
+
+  foreach (const Image& image, images) {
+    foreach (const string& layerId, image.layer_ids()) {
+      if (!layerSizes.contains(layerId)) {
+        layerSizes[layerId] = directorySize(
+            paths::getImageLayerPath(flags.docker_store_dir, layerId));
+      }
+    }
+  }
+
+  Bytes total;
+  foreachvalue (const Bytes& size, layerSizes) {
+    total += size;
+  }
+
+  if (total <= flags.docker_store_size.get()) {
+    return Nothing();
+  }
+
+  // Candidates for eviction: cached images not used by any active
+  // container, least recently used first.
+  vector<Image> candidates;
+  foreach (const Image& image, images) {
+    if (!excluded.contains(stringify(image.name()))) {
+      candidates.push_back(image);
+    }
+  }
+
+  std::sort(
+      candidates.begin(),
+      candidates.end(),
+      [](const Image& left, const Image& right) {
+        return left.last_accessed() < right.last_accessed();
+      });
+
+  hashset<string> evicted;
+
+  foreach (const Image& candidate, candidates) {
+    if (total <= flags.docker_store_size.get()) {
+      break;
+    }
+
+    evicted.insert(stringify(candidate.name()));
+
+    // Recompute the layers still referenced by the surviving images
+    // and the resulting store size: a layer is only freed once the
+    // last image referencing it is evicted.
+    hashset<string> referenced;
+    foreach (const Image& image, images) {
+      if (!evicted.contains(stringify(image.name()))) {
+        foreach (const string& layerId, image.layer_ids()) {
+          referenced.insert(layerId);
+        }
+      }
+    }
+
+    total = Bytes();
+    foreachpair (const string& layerId, const Bytes& size, layerSizes) {
+      if (referenced.contains(layerId)) {
+        total += size;
+      }
+    }
+  }
+
+  if (evicted.empty()) {
+    return Nothing();
+  }
+
+  LOG(INFO) << "Evicting " << evicted.size() << " Docker images to bring "
+            << "the store size under " << flags.docker_store_size.get();
+
+  vector<string> imageNames(evicted.begin(), evicted.end());
+
+  return metadataManager->remove(imageNames)
+    .then(defer(self(), &Self::__prune, lambda::_1));
+}
+
+
+Future<Nothing> StoreProcess::__prune(const hashset<string>& referenced)
+{
+  // Delete the layers that are no longer referenced by any cached
+  // image. Failures are ignored: an undeleted layer is retried the
+  // next time the store exceeds its budget.
+  const string layersDir = path::join(flags.docker_store_dir, "layers");
+
+  Try<std::list<string>> layerIds = os::ls(layersDir);
+  if (layerIds.isError()) {
+    LOG(WARNING) << "Failed to list layers under '" << layersDir
+                 << "': " << layerIds.error();
+    return Nothing();
+  }
+
+  foreach (const string& layerId, layerIds.get()) {
+    if (referenced.contains(layerId)) {
+      continue;
+    }
+
+    const string layerPath =
+      paths::getImageLayerPath(flags.docker_store_dir, layerId);
+
+    Try<Nothing> rmdir = os::rmdir(layerPath);
+    if (rmdir.isError()) {
+      LOG(WARNING) << "Failed to remove unreferenced layer '" << layerId
+                   << "': " << rmdir.error();
+    } else {
+      VLOG(1) << "Removed unreferenced layer '" << layerId << "'";
+    }
+  }
+
+  return Nothing();
+}
+
+
 Future<vector<string>> StoreProcess::moveLayers(
     const list<pair<string, string>>& layerPaths)
 {
@@ -267,14 +459,21 @@ Future<Image> StoreProcess::storeImage(
 Future<Nothing> StoreProcess::moveLayer(
     const pair<string, string>& layerPath)
 {
+  const string imageLayerPath =
+    paths::getImageLayerPath(flags.docker_store_dir, layerPath.first);
+
   if (!os::exists(layerPath.second)) {
+    // The puller skips layers that are already in the store, in which
+    // case nothing is staged and there is nothing to move.
+    if (os::exists(imageLayerPath)) {
+      VLOG(1) << "Layer '" << layerPath.first << "' is already stored";
+      return Nothing();
+    }
+
     return Failure("Unable to find layer '" + layerPath.first + "' in '" +
                    layerPath.second + "'");
   }
 
-  const string imageLayerPath =
-    paths::getImageLayerPath(flags.docker_store_dir, layerPath.first);
-
   // If image layer path exists, we should remove it and make an empty
   // directory, because os::rename can only have empty or non-existed
   // directory as destination.
@@ -300,7 +499,9 @@ Future<Nothing> StoreProcess::moveLayer(
                    "' to store directory: " + status.error());
   }
 
-  return Nothing();
+  // Checkpoint the completion of this layer so that pulls resumed
+  // after a restart do not refetch it.
+  return metadataManager->putLayer(layerPath.first);
 }
 
 } // namespace docker {
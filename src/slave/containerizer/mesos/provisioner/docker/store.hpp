@@ -17,6 +17,8 @@
 #ifndef __PROVISIONER_DOCKER_STORE_HPP__
 #define __PROVISIONER_DOCKER_STORE_HPP__
 
+#include <vector>
+
 #include <process/owned.hpp>
 
 #include <stout/try.hpp>
@@ -52,6 +54,9 @@ public:
 
   virtual process::Future<ImageInfo> get(const mesos::Image& image);
 
+  virtual process::Future<Nothing> prune(
+      const std::vector<mesos::Image>& excludedImages);
+
 private:
   explicit Store(const process::Owned<StoreProcess>& process);
 
@@ -0,0 +1,662 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stout/error.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+
+#include "slave/containerizer/mesos/provisioner/extractor.hpp"
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+namespace extractor {
+
+// A streaming SHA-512 implementation (FIPS 180-4). We implement this
+// here rather than depending on a crypto library because the build
+// does not require one; the implementation is only a page and the
+// algorithm is fixed.
+class SHA512
+{
+public:
+  SHA512() : total(0), buffered(0)
+  {
+    static const uint64_t INITIAL[8] = {
+      0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+      0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+      0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+      0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+
+    memcpy(state, INITIAL, sizeof(state));
+  }
+
+  void update(const char* data, size_t size)
+  {
+    total += size;
+
+    while (size > 0) {
+      size_t take = std::min(size, sizeof(buffer) - buffered);
+      memcpy(buffer + buffered, data, take);
+      buffered += take;
+      data += take;
+      size -= take;
+
+      if (buffered == sizeof(buffer)) {
+        transform(buffer);
+        buffered = 0;
+      }
+    }
+  }
+
+  // Returns the hex encoded digest.
+  string finalize()
+  {
+    // Pad: 0x80, zeros, then the 128-bit bit-length (we only track
+    // 64 bits of length, which allows for 2^61 bytes).
+    uint64_t bits = total * 8;
+
+    unsigned char pad = 0x80;
+    update(reinterpret_cast<const char*>(&pad), 1);
+
+    unsigned char zero = 0;
+    while (buffered != 112) {
+      update(reinterpret_cast<const char*>(&zero), 1);
+    }
+
+    unsigned char length[16] = {0};
+    for (int i = 0; i < 8; i++) {
+      length[15 - i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+    update(reinterpret_cast<const char*>(length), 16);
+
+    string result;
+    result.reserve(128);
+
+    static const char* HEX = "0123456789abcdef";
+    for (int i = 0; i < 8; i++) {
+      for (int j = 7; j >= 0; j--) {
+        unsigned char byte = static_cast<unsigned char>(state[i] >> (8 * j));
+        result.push_back(HEX[byte >> 4]);
+        result.push_back(HEX[byte & 0x0f]);
+      }
+    }
+
+    return result;
+  }
+
+private:
+  static uint64_t rotr(uint64_t x, int n)
+  {
+    return (x >> n) | (x << (64 - n));
+  }
+
+  void transform(const unsigned char* block)
+  {
+    static const uint64_t K[80] = {
+      0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+      0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+      0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+      0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+      0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+      0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+      0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+      0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+      0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+      0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+      0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+      0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+      0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+      0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+      0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+      0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+      0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+      0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+      0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+      0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+      0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+      0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+      0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+      0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+      0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+      0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+      0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+    };
+
+    uint64_t w[80];
+
+    for (int i = 0; i < 16; i++) {
+      w[i] = 0;
+      for (int j = 0; j < 8; j++) {
+        w[i] = (w[i] << 8) | block[i * 8 + j];
+      }
+    }
+
+    for (int i = 16; i < 80; i++) {
+      uint64_t s0 =
+        rotr(w[i - 15], 1) ^ rotr(w[i - 15], 8) ^ (w[i - 15] >> 7);
+      uint64_t s1 =
+        rotr(w[i - 2], 19) ^ rotr(w[i - 2], 61) ^ (w[i - 2] >> 6);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 80; i++) {
+      uint64_t S1 = rotr(e, 14) ^ rotr(e, 18) ^ rotr(e, 41);
+      uint64_t ch = (e & f) ^ (~e & g);
+      uint64_t temp1 = h + S1 + ch + K[i] + w[i];
+      uint64_t S0 = rotr(a, 28) ^ rotr(a, 34) ^ rotr(a, 39);
+      uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+      uint64_t temp2 = S0 + maj;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + temp1;
+      d = c;
+      c = b;
+      b = a;
+      a = temp1 + temp2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+  }
+
+  uint64_t state[8];
+  uint64_t total;
+  unsigned char buffer[128];
+  size_t buffered;
+};
+
+
+// Reads exactly 'size' bytes unless EOF is hit first. Returns the
+// number of bytes read, or an error.
+static Try<size_t> readFull(int fd, char* buffer, size_t size)
+{
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t length = ::read(fd, buffer + offset, size - offset);
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return ErrnoError();
+    } else if (length == 0) {
+      break; // EOF.
+    }
+    offset += length;
+  }
+
+  return offset;
+}
+
+
+// Parses the octal number in the given tar header field, which may
+// alternatively be base-256 encoded (GNU extension, flagged by the
+// high bit of the first byte) for sizes that do not fit in octal.
+static uint64_t parseNumeric(const char* field, size_t size)
+{
+  if (size > 0 && (field[0] & 0x80)) {
+    uint64_t result = field[0] & 0x7f;
+    for (size_t i = 1; i < size; i++) {
+      result = (result << 8) | static_cast<unsigned char>(field[i]);
+    }
+    return result;
+  }
+
+  uint64_t result = 0;
+  for (size_t i = 0; i < size; i++) {
+    if (field[i] == ' ' || field[i] == '\0') {
+      if (result != 0 || field[i] == '\0') {
+        break;
+      }
+      continue; // Skip leading spaces.
+    }
+    if (field[i] < '0' || field[i] > '7') {
+      break;
+    }
+    result = (result << 3) + (field[i] - '0');
+  }
+
+  return result;
+}
+
+
+// Returns the string in the given (possibly not NUL terminated)
+// fixed size tar header field.
+static string parseString(const char* field, size_t size)
+{
+  return string(field, strnlen(field, size));
+}
+
+
+// Returns an error if the given entry name escapes the extraction
+// directory (absolute paths and '..' components).
+static Option<Error> validateEntryName(const string& name)
+{
+  if (strings::startsWith(name, "/")) {
+    return Error("Absolute entry name '" + name + "'");
+  }
+
+  foreach (const string& component, strings::split(name, "/")) {
+    if (component == "..") {
+      return Error("Entry name '" + name + "' contains '..'");
+    }
+  }
+
+  return None();
+}
+
+
+// Extracts the pax value for the given key, if present. Pax data is
+// a sequence of "<decimal length> <key>=<value>\n" records.
+static Option<string> parsePax(const string& data, const string& key)
+{
+  size_t offset = 0;
+  while (offset < data.size()) {
+    size_t space = data.find(' ', offset);
+    if (space == string::npos) {
+      break;
+    }
+
+    uint64_t length = parseNumeric(data.data() + offset, space - offset);
+    if (length == 0 || offset + length > data.size()) {
+      break;
+    }
+
+    const string record = data.substr(space + 1, offset + length - space - 2);
+    offset += length;
+
+    size_t equals = record.find('=');
+    if (equals != string::npos && record.substr(0, equals) == key) {
+      return record.substr(equals + 1);
+    }
+  }
+
+  return None();
+}
+
+
+Try<string> extract(const string& file, const string& directory)
+{
+  Try<int> open = os::open(file, O_RDONLY | O_CLOEXEC);
+  if (open.isError()) {
+    return Error("Failed to open '" + file + "': " + open.error());
+  }
+
+  int fd = open.get();
+
+  SHA512 digest;
+
+  // Pending GNU long name/link or pax overrides for the next entry.
+  Option<string> longName;
+  Option<string> longLink;
+
+  char header[512];
+  char buffer[64 * 1024];
+
+  // Set once we have seen the end-of-archive marker; the remaining
+  // bytes (zero padding) are still hashed so that the digest covers
+  // the file exactly.
+  bool done = false;
+
+  while (true) {
+    Try<size_t> read = readFull(fd, header, sizeof(header));
+    if (read.isError()) {
+      os::close(fd);
+      return Error("Failed to read '" + file + "': " + read.error());
+    }
+
+    if (read.get() == 0) {
+      break; // EOF.
+    }
+
+    digest.update(header, read.get());
+
+    if (done) {
+      continue;
+    }
+
+    if (read.get() < sizeof(header)) {
+      os::close(fd);
+      return Error("Truncated header in '" + file + "'");
+    }
+
+    // An all-zero block marks the end of the archive.
+    bool zero = true;
+    for (size_t i = 0; i < sizeof(header); i++) {
+      if (header[i] != '\0') {
+        zero = false;
+        break;
+      }
+    }
+
+    if (zero) {
+      done = true;
+      continue;
+    }
+
+    // Parse the header fields we need (ustar layout).
+    string name = parseString(header, 100);
+    const uint64_t mode = parseNumeric(header + 100, 8) & 07777;
+    const uint64_t uid = parseNumeric(header + 108, 8);
+    const uint64_t gid = parseNumeric(header + 116, 8);
+    const uint64_t size = parseNumeric(header + 124, 12);
+    const char type = header[156];
+    string linkname = parseString(header + 157, 100);
+
+    // The ustar prefix field extends the entry name.
+    if (strncmp(header + 257, "ustar", 5) == 0) {
+      const string prefix = parseString(header + 345, 155);
+      if (!prefix.empty()) {
+        name = prefix + "/" + name;
+      }
+    }
+
+    if (longName.isSome()) {
+      name = longName.get();
+      longName = None();
+    }
+
+    if (longLink.isSome()) {
+      linkname = longLink.get();
+      longLink = None();
+    }
+
+    // Consume the entry data: for regular files we stream it to disk
+    // while hashing; for metadata entries we buffer it; for entries
+    // we do not materialize we just hash it.
+    const uint64_t padded = (size + 511) & ~UINT64_C(511);
+
+    // Metadata entries ('L': GNU long name, 'K': GNU long link,
+    // 'x': pax) apply to the following entry.
+    if (type == 'L' || type == 'K' || type == 'x' || type == 'g') {
+      string data;
+      data.reserve(size);
+
+      uint64_t offset = 0;
+      while (offset < padded) {
+        size_t take = std::min<uint64_t>(padded - offset, sizeof(buffer));
+        Try<size_t> read = readFull(fd, buffer, take);
+        if (read.isError() || read.get() < take) {
+          os::close(fd);
+          return Error("Truncated entry in '" + file + "'");
+        }
+
+        digest.update(buffer, take);
+
+        // Append only the unpadded portion.
+        if (offset < size) {
+          data.append(buffer, std::min<uint64_t>(take, size - offset));
+        }
+
+        offset += take;
+      }
+
+      if (type == 'L') {
+        // The data is NUL terminated.
+        longName = string(data.c_str());
+      } else if (type == 'K') {
+        longLink = string(data.c_str());
+      } else if (type == 'x') {
+        Option<string> path = parsePax(data, "path");
+        if (path.isSome()) {
+          longName = path.get();
+        }
+        Option<string> link = parsePax(data, "linkpath");
+        if (link.isSome()) {
+          longLink = link.get();
+        }
+      }
+
+      continue;
+    }
+
+    // Normalize a leading "./".
+    if (strings::startsWith(name, "./")) {
+      name = name.substr(2);
+    }
+
+    Option<Error> error = validateEntryName(name);
+    if (error.isSome()) {
+      os::close(fd);
+      return Error(
+          "Invalid entry in '" + file + "': " + error.get().message);
+    }
+
+    const string entryPath = path::join(directory, name);
+
+    // Ensure the parent directory exists: archives usually list
+    // directories before their contents, but are not required to.
+    Try<Nothing> mkdir = os::mkdir(Path(entryPath).dirname());
+    if (mkdir.isError()) {
+      os::close(fd);
+      return Error(
+          "Failed to create directory for '" + name + "': " + mkdir.error());
+    }
+
+    bool skipData = false;
+
+    switch (type) {
+      case '0':   // Regular file.
+      case '\0':  // Regular file (old format).
+      case '7': { // Contiguous file: extracted as a regular file.
+        Try<int> out = os::open(
+            entryPath,
+            O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+            static_cast<mode_t>(mode));
+
+        if (out.isError()) {
+          os::close(fd);
+          return Error(
+              "Failed to create '" + entryPath + "': " + out.error());
+        }
+
+        uint64_t remaining = size;
+        while (remaining > 0) {
+          size_t take = std::min<uint64_t>(remaining, sizeof(buffer));
+          Try<size_t> read = readFull(fd, buffer, take);
+          if (read.isError() || read.get() < take) {
+            os::close(out.get());
+            os::close(fd);
+            return Error("Truncated entry '" + name + "' in '" + file + "'");
+          }
+
+          digest.update(buffer, take);
+
+          size_t offset = 0;
+          while (offset < take) {
+            ssize_t written =
+              ::write(out.get(), buffer + offset, take - offset);
+            if (written < 0) {
+              if (errno == EINTR) {
+                continue;
+              }
+              ErrnoError error("Failed to write '" + entryPath + "'");
+              os::close(out.get());
+              os::close(fd);
+              return error;
+            }
+            offset += written;
+          }
+
+          remaining -= take;
+        }
+
+        // The open(2) mode is subject to the umask.
+        ::fchmod(out.get(), static_cast<mode_t>(mode));
+
+        // Restore ownership when permitted (e.g. running as root);
+        // failures are expected otherwise and ignored, matching the
+        // behavior of unprivileged tar.
+        ::fchown(
+            out.get(), static_cast<uid_t>(uid), static_cast<gid_t>(gid));
+
+        os::close(out.get());
+        break;
+      }
+
+      case '5': { // Directory.
+        Try<Nothing> mkdir = os::mkdir(entryPath);
+        if (mkdir.isError()) {
+          os::close(fd);
+          return Error(
+              "Failed to create directory '" + entryPath + "': " +
+              mkdir.error());
+        }
+
+        ::chmod(entryPath.c_str(), static_cast<mode_t>(mode));
+        ::chown(
+            entryPath.c_str(),
+            static_cast<uid_t>(uid),
+            static_cast<gid_t>(gid));
+        skipData = true;
+        break;
+      }
+
+      case '2': { // Symbolic link.
+        // Remove any stale entry: symlink(2) does not overwrite.
+        ::unlink(entryPath.c_str());
+
+        if (::symlink(linkname.c_str(), entryPath.c_str()) < 0) {
+          ErrnoError error("Failed to create symlink '" + entryPath + "'");
+          os::close(fd);
+          return error;
+        }
+
+        ::lchown(
+            entryPath.c_str(),
+            static_cast<uid_t>(uid),
+            static_cast<gid_t>(gid));
+        skipData = true;
+        break;
+      }
+
+      case '1': { // Hard link (to a previously extracted entry).
+        Option<Error> error = validateEntryName(linkname);
+        if (error.isSome()) {
+          os::close(fd);
+          return Error(
+              "Invalid link target in '" + file + "': " +
+              error.get().message);
+        }
+
+        ::unlink(entryPath.c_str());
+
+        const string target = path::join(directory, linkname);
+        if (::link(target.c_str(), entryPath.c_str()) < 0) {
+          ErrnoError error("Failed to link '" + entryPath + "'");
+          os::close(fd);
+          return error;
+        }
+        skipData = true;
+        break;
+      }
+
+      case '6': { // Fifo.
+        ::unlink(entryPath.c_str());
+
+        if (::mkfifo(entryPath.c_str(), static_cast<mode_t>(mode)) < 0) {
+          ErrnoError error("Failed to create fifo '" + entryPath + "'");
+          os::close(fd);
+          return error;
+        }
+
+        ::chown(
+            entryPath.c_str(),
+            static_cast<uid_t>(uid),
+            static_cast<gid_t>(gid));
+        skipData = true;
+        break;
+      }
+
+      case '3':   // Character device.
+      case '4': { // Block device.
+        const uint64_t major = parseNumeric(header + 329, 8);
+        const uint64_t minor = parseNumeric(header + 337, 8);
+
+        ::unlink(entryPath.c_str());
+
+        // Creating device nodes requires privileges; warn rather
+        // than fail since many layers are extracted unprivileged.
+        if (::mknod(
+                entryPath.c_str(),
+                static_cast<mode_t>(mode) | (type == '3' ? S_IFCHR : S_IFBLK),
+                makedev(major, minor)) < 0) {
+          LOG(WARNING) << "Failed to create device '" << entryPath
+                       << "': " << os::strerror(errno);
+        }
+        skipData = true;
+        break;
+      }
+
+      default: {
+        LOG(WARNING) << "Skipping entry '" << name << "' in '" << file
+                     << "' with unsupported type '" << type << "'";
+        skipData = true;
+        break;
+      }
+    }
+
+    // Hash (and discard) any data we did not stream above, plus the
+    // padding up to the 512 byte block boundary.
+    uint64_t remaining = skipData ? padded : padded - size;
+    while (remaining > 0) {
+      size_t take = std::min<uint64_t>(remaining, sizeof(buffer));
+      Try<size_t> read = readFull(fd, buffer, take);
+      if (read.isError() || read.get() < take) {
+        os::close(fd);
+        return Error("Truncated entry in '" + file + "'");
+      }
+
+      digest.update(buffer, take);
+      remaining -= take;
+    }
+  }
+
+  os::close(fd);
+
+  return digest.finalize();
+}
+
+} // namespace extractor {
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,53 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __PROVISIONER_EXTRACTOR_HPP__
+#define __PROVISIONER_EXTRACTOR_HPP__
+
+#include <string>
+
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+namespace extractor {
+
+// Extracts the (uncompressed) tar archive at 'file' into 'directory'
+// in a single pass, computing the SHA-512 digest of the archive
+// bytes while extracting. Returns the hex encoded digest, which for
+// image layers can be compared against a content addressed image ID
+// (e.g. the appc "sha512-<hex>" format) without re-reading the
+// archive.
+//
+// Regular files, directories, symbolic and hard links, fifos and
+// device nodes are restored, along with their permissions and (when
+// running with sufficient privileges) their ownership; timestamps
+// are not restored. GNU long name/link and pax path extensions are
+// supported. Entries that would escape 'directory' are rejected.
+//
+// NOTE: This is a blocking call; use e.g. 'process::async' to avoid
+// blocking the calling process.
+Try<std::string> extract(
+    const std::string& file,
+    const std::string& directory);
+
+} // namespace extractor {
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __PROVISIONER_EXTRACTOR_HPP__
@@ -183,6 +183,11 @@ Future<Nothing> ProvisionerProcess::recover(
   foreach (const ContainerID& containerId, containers.get()) {
     Owned<Info> info = Owned<Info>(new Info());
 
+    // The images these containers were provisioned with are not
+    // checkpointed, so we cannot tell the stores which images are
+    // still in use. Pruning is disabled until they are destroyed.
+    info->recovered = true;
+
     Try<hashmap<string, hashset<string>>> rootfses =
       provisioner::paths::listContainerRootfses(rootDir, containerId);
 
@@ -260,12 +265,13 @@ Future<ProvisionInfo> ProvisionerProcess::provision(
 
   // Get and then provision image layers from the store.
   return stores.get(image.type()).get()->get(image)
-    .then(defer(self(), &Self::_provision, containerId, lambda::_1));
+    .then(defer(self(), &Self::_provision, containerId, image, lambda::_1));
 }
 
 
 Future<ProvisionInfo> ProvisionerProcess::_provision(
     const ContainerID& containerId,
+    const Image& image,
     const ImageInfo& ImageInfo)
 {
   // TODO(jieyu): Choose a backend smartly. For instance, if there is
@@ -292,6 +298,7 @@ Future<ProvisionInfo> ProvisionerProcess::_provision(
   }
 
   infos[containerId]->rootfses[backend].insert(rootfsId);
+  infos[containerId]->images.push_back(image);
 
   return backends.get(backend).get()->provision(ImageInfo.layers, rootfs)
     .then([rootfs, ImageInfo]() -> Future<ProvisionInfo> {
@@ -361,10 +368,42 @@ Future<bool> ProvisionerProcess::_destroy(const ContainerID& containerId)
     ++metrics.remove_container_errors;
   }
 
+  // A container going away may have dropped the last reference to
+  // some image, so give the stores a chance to evict.
+  prune();
+
   return true;
 }
 
 
+void ProvisionerProcess::prune()
+{
+  vector<Image> excluded;
+
+  foreachvalue (const Owned<Info>& info, infos) {
+    // The images of containers recovered after an agent restart are
+    // unknown, so we cannot safely tell the stores what to keep.
+    // Pruning resumes once all recovered containers are destroyed.
+    if (info->recovered) {
+      VLOG(1) << "Skipped pruning image stores because containers "
+              << "with unknown images are still running";
+      return;
+    }
+
+    foreach (const Image& image, info->images) {
+      excluded.push_back(image);
+    }
+  }
+
+  foreachvalue (const Owned<Store>& store, stores) {
+    store->prune(excluded)
+      .onFailed([](const string& failure) {
+        LOG(WARNING) << "Failed to prune image store: " << failure;
+      });
+  }
+}
+
+
 ProvisionerProcess::Metrics::Metrics()
   : remove_container_errors(
       "containerizer/mesos/provisioner/remove_container_errors")
@@ -18,6 +18,7 @@
 #define __PROVISIONER_HPP__
 
 #include <list>
+#include <vector>
 
 #include <mesos/resources.hpp>
 
@@ -124,10 +125,15 @@ public:
 private:
   process::Future<ProvisionInfo> _provision(
       const ContainerID& containerId,
+      const Image& image,
       const ImageInfo& layers);
 
   process::Future<bool> _destroy(const ContainerID& containerId);
 
+  // Ask the stores to evict images no longer referenced by any
+  // container if they exceed their size budgets.
+  void prune();
+
   const Flags flags;
 
   // Absolute path to the provisioner root directory. It can be
@@ -144,6 +150,15 @@ private:
   {
     // Mappings: backend -> {rootfsId, ...}
     hashmap<std::string, hashset<std::string>> rootfses;
+
+    // The images the container was provisioned with. These keep the
+    // images referenced so the stores do not evict them while the
+    // container is running.
+    std::vector<Image> images;
+
+    // Whether the container was recovered after an agent restart, in
+    // which case its images are unknown (they are not checkpointed).
+    bool recovered = false;
   };
 
   hashmap<ContainerID, process::Owned<Info>> infos;
@@ -25,6 +25,7 @@
 #include <process/future.hpp>
 #include <process/owned.hpp>
 
+#include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
 #include "slave/flags.hpp"
@@ -83,6 +84,16 @@ public:
   // The returned future fails if the requested image or any of its
   // dependencies cannot be found or failed to be fetched.
   virtual process::Future<ImageInfo> get(const Image& image) = 0;
+
+  // Prunes images that are not in the excluded list (i.e., not used
+  // by any active container) if the store has grown beyond its
+  // configured size budget. The default implementation is a no-op
+  // for stores that do not support eviction.
+  virtual process::Future<Nothing> prune(
+      const std::vector<Image>& excludedImages)
+  {
+    return Nothing();
+  }
 };
 
 } // namespace slave {
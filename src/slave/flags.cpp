@@ -110,9 +110,19 @@ mesos::internal::slave::Flags::Flags()
   add(&Flags::image_provisioner_backend,
       "image_provisioner_backend",
       "Strategy for provisioning container rootfs from images,\n"
-      "e.g., 'bind', 'copy'.",
+      "e.g., 'bind', 'copy', 'overlay'.",
       "copy");
 
+  add(&Flags::provisioner_pool_size,
+      "provisioner_pool_size",
+      "Number of pre-provisioned root filesystems the copy provisioner\n"
+      "backend keeps warm per image. A container whose image matches a\n"
+      "warm root filesystem binds to it with a rename instead of\n"
+      "copying the layers, and the pool is refilled in the background,\n"
+      "taking provisioning off the container start path. 0 (the\n"
+      "default) disables pooling.",
+      0u);
+
   add(&Flags::appc_store_dir,
       "appc_store_dir",
       "Directory the appc provisioner will store images in.",
@@ -141,6 +151,14 @@ mesos::internal::slave::Flags::Flags()
       "Directory the Docker provisioner will store images in",
       "/tmp/mesos/store/docker");
 
+  add(&Flags::docker_store_size,
+      "docker_store_size",
+      "Size budget for the Docker image store. When the layers in the\n"
+      "store exceed this size, images that are not used by any active\n"
+      "container are evicted in least-recently-used order, together\n"
+      "with the layers that are no longer referenced by any cached\n"
+      "image. If unset (default), the store grows without bound.");
+
   add(&Flags::default_role,
       "default_role",
       "Any resources in the --resources flag that\n"
@@ -174,6 +192,21 @@ mesos::internal::slave::Flags::Flags()
       "(one subdirectory per slave).",
       "/tmp/mesos/fetch");
 
+  // NOTE: A task can modify a file hardlinked into its sandbox and
+  // thereby corrupt the cached copy that subsequent tasks retrieve,
+  // so this is only safe with trusted workloads (and is therefore
+  // not the default). Executables are always copied since making
+  // them executable would alter the shared inode.
+  add(&Flags::fetcher_cache_hardlinks,
+      "fetcher_cache_hardlinks",
+      "Whether the fetcher should materialize cached artifacts in\n"
+      "sandboxes using hardlinks instead of copying them. This avoids\n"
+      "duplicating large artifacts on disk and makes retrieval from\n"
+      "the cache O(1), but requires the cache and the sandboxes to\n"
+      "reside on the same filesystem and the workloads to be trusted\n"
+      "not to modify fetched files in place.",
+      false);
+
   add(&Flags::work_dir,
       "work_dir",
       "Directory path to place framework work directories\n", "/tmp/mesos");
@@ -290,7 +323,10 @@ mesos::internal::slave::Flags::Flags()
       "The name of the container logger to use for logging container\n"
       "(i.e., executor and task) stdout and stderr. The default\n"
       "container logger writes to 'stdout' and 'stderr' files\n"
-      "in the sandbox directory.");
+      "in the sandbox directory. The bundled 'rotating' logger\n"
+      "instead writes a size-capped ring of files, configured via\n"
+      "MESOS_CONTAINER_LOGGER_* environment variables (e.g.,\n"
+      "MESOS_CONTAINER_LOGGER_MAX_FILE_SIZE=50MB).");
 
   add(&Flags::recover,
       "recover",
@@ -309,6 +345,14 @@ mesos::internal::slave::Flags::Flags()
       "waiting to reconnect to the slave will self-terminate.\n",
       RECOVERY_TIMEOUT);
 
+  add(&Flags::recovery_io_parallelism,
+      "recovery_io_parallelism",
+      "Maximum number of worker threads used to read and parse\n"
+      "checkpointed state concurrently during recovery. This bounds\n"
+      "the I/O parallelism when recovering a slave hosting many\n"
+      "executors.",
+      DEFAULT_RECOVERY_IO_PARALLELISM);
+
   add(&Flags::strict,
       "strict",
       "If strict=true, any and all recovery errors are considered fatal.\n"
@@ -441,6 +485,16 @@ mesos::internal::slave::Flags::Flags()
       "(--containerizers=mesos).\n",
       "mesos");
 
+  add(&Flags::container_destroy_parallelism,
+      "container_destroy_parallelism",
+      "Maximum number of containers the containerizer destroys\n"
+      "concurrently. Containers queued for destruction beyond this\n"
+      "bound are handed to the launcher in batches, so draining a\n"
+      "slave running many executors completes with the slowest\n"
+      "container rather than issuing an unbounded number of\n"
+      "concurrent destroys.",
+      DEFAULT_CONTAINER_DESTROY_PARALLELISM);
+
   add(&Flags::default_container_image,
       "default_container_image",
       "The default container image to use if not specified by a task,\n"
@@ -573,6 +627,15 @@ mesos::internal::slave::Flags::Flags()
 
 #endif // WITH_NETWORK_ISOLATOR
 
+#ifdef ENABLE_XFS_DISK_ISOLATOR
+  add(&Flags::xfs_project_range,
+      "xfs_project_range",
+      "The range of XFS project IDs that the isolator can use to track\n"
+      "sandbox directories. This flag is used for the 'disk/xfs'\n"
+      "isolator.",
+      "[5000-10000]");
+#endif // ENABLE_XFS_DISK_ISOLATOR
+
   add(&Flags::container_disk_watch_interval,
       "container_disk_watch_interval",
       "The interval between disk quota checks for containers. This flag is\n"
@@ -49,17 +49,20 @@ public:
 
   Option<std::string> image_providers;
   std::string image_provisioner_backend;
+  size_t provisioner_pool_size;
   std::string appc_store_dir;
 
   std::string docker_auth_server;
   std::string docker_puller_timeout_secs;
   std::string docker_registry;
   std::string docker_store_dir;
+  Option<Bytes> docker_store_size;
 
   std::string default_role;
   Option<std::string> attributes;
   Bytes fetcher_cache_size;
   std::string fetcher_cache_dir;
+  bool fetcher_cache_hardlinks;
   std::string work_dir;
   std::string launcher_dir;
   std::string hadoop_home; // TODO(benh): Make an Option.
@@ -79,6 +82,7 @@ public:
 
   std::string recover;
   Duration recovery_timeout;
+  size_t recovery_io_parallelism;
   bool strict;
   Duration register_retry_interval_min;
 #ifdef __linux__
@@ -98,6 +102,7 @@ public:
   Option<Path> credential;
   Option<std::string> containerizer_path;
   std::string containerizers;
+  size_t container_destroy_parallelism;
   Option<std::string> default_container_image;
   std::string docker;
   Option<std::string> docker_mesos_image;
@@ -119,6 +124,9 @@ public:
 #endif
   Duration container_disk_watch_interval;
   bool enforce_container_disk_quota;
+#ifdef ENABLE_XFS_DISK_ISOLATOR
+  std::string xfs_project_range;
+#endif
   Option<Modules> modules;
   std::string authenticatee;
   Option<std::string> hooks;
@@ -16,15 +16,20 @@
 
 #include <list>
 
+#include <process/async.hpp>
+#include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
 
 #include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
 #include <stout/os.hpp>
 
 #include "logging/logging.hpp"
 
+#include "slave/constants.hpp"
 #include "slave/gc.hpp"
+#include "slave/io_scheduler.hpp"
 
 using namespace process;
 
@@ -44,6 +49,10 @@ GarbageCollectorProcess::~GarbageCollectorProcess()
   foreachvalue (const PathInfo& info, paths) {
     info.promise->discard();
   }
+
+  foreach (const PathInfo& info, pending) {
+    info.promise->discard();
+  }
 }
 
 
@@ -115,37 +124,35 @@ void GarbageCollectorProcess::reset()
   if (!paths.empty()) {
     Timeout removalTime = (*paths.begin()).first; // Get the first entry.
 
-    timer = delay(removalTime.remaining(), self(), &Self::remove, removalTime);
+    timer = delay(
+        removalTime.remaining(), self(), &Self::remove, removalTime, false);
   } else {
     timer = Timer(); // Reset the timer.
   }
 }
 
 
-void GarbageCollectorProcess::remove(const Timeout& removalTime)
+void GarbageCollectorProcess::remove(
+    const Timeout& removalTime,
+    bool prioritized)
 {
-  // TODO(bmahler): Other dispatches can block waiting for a removal
-  // operation. To fix this, the removal operation can be done
-  // asynchronously in another thread.
   if (paths.count(removalTime) > 0) {
     foreach (const PathInfo& info, paths.get(removalTime)) {
-      LOG(INFO) << "Deleting " << info.path;
-
-      Try<Nothing> rmdir = os::rmdir(info.path);
-
-      if (rmdir.isError()) {
-        LOG(WARNING) << "Failed to delete '" << info.path << "': "
-                     << rmdir.error();
-        info.promise->fail(rmdir.error());
+      // Prioritized removals (i.e., pruning triggered by disk
+      // pressure) jump ahead of the queue so that disk space is
+      // reclaimed as soon as possible.
+      if (prioritized) {
+        pending.push_front(info);
       } else {
-        LOG(INFO) << "Deleted '" << info.path << "'";
-        info.promise->set(rmdir.get());
+        pending.push_back(info);
       }
 
       timeouts.erase(info.path);
     }
 
     paths.remove(removalTime);
+
+    _remove();
   } else {
     // This occurs when either:
     //   1. The path(s) has already been removed (e.g. by prune()).
@@ -158,13 +165,68 @@ void GarbageCollectorProcess::remove(const Timeout& removalTime)
 }
 
 
+void GarbageCollectorProcess::_remove()
+{
+  // Perform the removals on worker threads so that a huge sandbox
+  // does not block this process, while bounding the number of
+  // concurrent removals to limit the I/O issued against the disk.
+  while (removing < GC_RMDIR_CONCURRENCY && !pending.empty()) {
+    const PathInfo info = pending.front();
+    pending.pop_front();
+
+    removing++;
+
+    LOG(INFO) << "Deleting " << info.path;
+
+    // Removals go through the slave's I/O scheduler so that garbage
+    // collection is throttled against the other background disk
+    // traffic (provisioning, fetching, disk usage scanning).
+    const string path = info.path;
+
+    IOScheduler::instance()->schedule<Try<Nothing>>(
+        IOScheduler::GC,
+        [path]() { return async(&os::rmdir, path, true); })
+      .onAny(defer(self(), &Self::__remove, info, lambda::_1));
+  }
+}
+
+
+void GarbageCollectorProcess::__remove(
+    const PathInfo& info,
+    const Future<Try<Nothing> >& result)
+{
+  CHECK(removing > 0);
+  removing--;
+
+  if (!result.isReady()) {
+    const string message =
+      result.isFailed() ? result.failure() : "Removal was discarded";
+
+    LOG(WARNING) << "Failed to delete '" << info.path << "': " << message;
+    info.promise->fail(message);
+  } else if (result.get().isError()) {
+    LOG(WARNING) << "Failed to delete '" << info.path << "': "
+                 << result.get().error();
+    info.promise->fail(result.get().error());
+  } else {
+    LOG(INFO) << "Deleted '" << info.path << "'";
+    info.promise->set(Nothing());
+  }
+
+  _remove(); // Continue draining the deletion queue.
+}
+
+
 void GarbageCollectorProcess::prune(const Duration& d)
 {
   foreach (const Timeout& removalTime, paths.keys()) {
     if (removalTime.remaining() <= d) {
       LOG(INFO) << "Pruning directories with remaining removal time "
                 << removalTime.remaining();
-      dispatch(self(), &GarbageCollectorProcess::remove, removalTime);
+      // NOTE: Pruning is triggered when the disk watcher detects
+      // pressure, so these removals are prioritized over any already
+      // queued removals.
+      dispatch(self(), &GarbageCollectorProcess::remove, removalTime, true);
     }
   }
 }
@@ -17,6 +17,7 @@
 #ifndef __SLAVE_GC_HPP__
 #define __SLAVE_GC_HPP__
 
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -86,6 +87,8 @@ class GarbageCollectorProcess :
     public process::Process<GarbageCollectorProcess>
 {
 public:
+  GarbageCollectorProcess() : removing(0) {}
+
   virtual ~GarbageCollectorProcess();
 
   process::Future<Nothing> schedule(
@@ -97,10 +100,6 @@ public:
   void prune(const Duration& d);
 
 private:
-  void reset();
-
-  void remove(const process::Timeout& removalTime);
-
   struct PathInfo
   {
     PathInfo(const std::string& _path,
@@ -116,6 +115,22 @@ private:
     const process::Owned<process::Promise<Nothing> > promise;
   };
 
+  void reset();
+
+  // Moves the paths that have reached their removal time onto the
+  // deletion queue. Prioritized removals (i.e., pruning triggered by
+  // disk pressure) jump ahead of the queue.
+  void remove(const process::Timeout& removalTime, bool prioritized);
+
+  // Starts asynchronous removals from the front of the deletion
+  // queue, bounded by GC_RMDIR_CONCURRENCY concurrent removals.
+  void _remove();
+
+  // Invoked when an asynchronous removal has completed.
+  void __remove(
+      const PathInfo& info,
+      const process::Future<Try<Nothing> >& result);
+
   // Store all the timeouts and corresponding paths to delete.
   // NOTE: We are using Multimap here instead of Multihashmap, because
   // we need the keys of the map (deletion time) to be sorted.
@@ -125,6 +140,13 @@ private:
   // it exists in our paths mapping.
   hashmap<std::string, process::Timeout> timeouts;
 
+  // Paths whose removal time has been reached, in the order in which
+  // they will be deleted.
+  std::deque<PathInfo> pending;
+
+  // Number of removals currently running on worker threads.
+  size_t removing;
+
   process::Timer timer;
 };
 
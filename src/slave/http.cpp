@@ -399,68 +399,98 @@ string Slave::Http::STATE_HELP() {
 
 Future<Response> Slave::Http::state(const Request& request) const
 {
-  JSON::Object object;
-  object.values["version"] = MESOS_VERSION;
+  // Re-render the response only if the agent state changed since the
+  // last request. Monitoring stacks tend to poll this endpoint on a
+  // fixed interval and rendering it walks all frameworks, executors
+  // and tasks on the agent actor, so repeated polls of an unchanged
+  // agent are served straight from memory.
+  if (stateCache.isNone() ||
+      stateCache.get().version != slave->stateVersion) {
+    JSON::Object object;
+    object.values["version"] = MESOS_VERSION;
+
+    if (build::GIT_SHA.isSome()) {
+      object.values["git_sha"] = build::GIT_SHA.get();
+    }
 
-  if (build::GIT_SHA.isSome()) {
-    object.values["git_sha"] = build::GIT_SHA.get();
-  }
+    if (build::GIT_BRANCH.isSome()) {
+      object.values["git_branch"] = build::GIT_BRANCH.get();
+    }
 
-  if (build::GIT_BRANCH.isSome()) {
-    object.values["git_branch"] = build::GIT_BRANCH.get();
-  }
+    if (build::GIT_TAG.isSome()) {
+      object.values["git_tag"] = build::GIT_TAG.get();
+    }
 
-  if (build::GIT_TAG.isSome()) {
-    object.values["git_tag"] = build::GIT_TAG.get();
-  }
+    object.values["build_date"] = build::DATE;
+    object.values["build_time"] = build::TIME;
+    object.values["build_user"] = build::USER;
+    object.values["start_time"] = slave->startTime.secs();
+    object.values["id"] = slave->info.id().value();
+    object.values["pid"] = string(slave->self());
+    object.values["hostname"] = slave->info.hostname();
+    object.values["resources"] = model(slave->info.resources());
+    object.values["attributes"] = model(slave->info.attributes());
+
+    if (slave->master.isSome()) {
+      Try<string> hostname = net::getHostname(slave->master.get().address.ip);
+      if (hostname.isSome()) {
+        object.values["master_hostname"] = hostname.get();
+      }
+    }
 
-  object.values["build_date"] = build::DATE;
-  object.values["build_time"] = build::TIME;
-  object.values["build_user"] = build::USER;
-  object.values["start_time"] = slave->startTime.secs();
-  object.values["id"] = slave->info.id().value();
-  object.values["pid"] = string(slave->self());
-  object.values["hostname"] = slave->info.hostname();
-  object.values["resources"] = model(slave->info.resources());
-  object.values["attributes"] = model(slave->info.attributes());
-
-  if (slave->master.isSome()) {
-    Try<string> hostname = net::getHostname(slave->master.get().address.ip);
-    if (hostname.isSome()) {
-      object.values["master_hostname"] = hostname.get();
+    if (slave->flags.log_dir.isSome()) {
+      object.values["log_dir"] = slave->flags.log_dir.get();
     }
-  }
 
-  if (slave->flags.log_dir.isSome()) {
-    object.values["log_dir"] = slave->flags.log_dir.get();
-  }
+    if (slave->flags.external_log_file.isSome()) {
+      object.values["external_log_file"] = slave->flags.external_log_file.get();
+    }
 
-  if (slave->flags.external_log_file.isSome()) {
-    object.values["external_log_file"] = slave->flags.external_log_file.get();
-  }
+    JSON::Array frameworks;
+    foreachvalue (Framework* framework, slave->frameworks) {
+      frameworks.values.push_back(model(*framework));
+    }
+    object.values["frameworks"] = frameworks;
 
-  JSON::Array frameworks;
-  foreachvalue (Framework* framework, slave->frameworks) {
-    frameworks.values.push_back(model(*framework));
-  }
-  object.values["frameworks"] = frameworks;
+    JSON::Array completedFrameworks;
+    foreach (const Owned<Framework>& framework, slave->completedFrameworks) {
+      completedFrameworks.values.push_back(model(*framework));
+    }
+    object.values["completed_frameworks"] = completedFrameworks;
 
-  JSON::Array completedFrameworks;
-  foreach (const Owned<Framework>& framework, slave->completedFrameworks) {
-    completedFrameworks.values.push_back(model(*framework));
+    JSON::Object flags;
+    foreachpair (const string& name, const flags::Flag& flag, slave->flags) {
+      Option<string> value = flag.stringify(slave->flags);
+      if (value.isSome()) {
+        flags.values[name] = value.get();
+      }
+    }
+    object.values["flags"] = flags;
+
+    std::ostringstream out;
+    out << object;
+
+    stateCache = StateCache{slave->stateVersion, out.str()};
   }
-  object.values["completed_frameworks"] = completedFrameworks;
 
-  JSON::Object flags;
-  foreachpair (const string& name, const flags::Flag& flag, slave->flags) {
-    Option<string> value = flag.stringify(slave->flags);
-    if (value.isSome()) {
-      flags.values[name] = value.get();
-    }
+  const string& body = stateCache.get().body;
+
+  Option<string> jsonp = request.url.query.get("jsonp");
+
+  OK response;
+  response.type = Response::BODY;
+
+  if (jsonp.isSome()) {
+    response.body = jsonp.get() + "(" + body + ");";
+    response.headers["Content-Type"] = "text/javascript";
+  } else {
+    response.body = body;
+    response.headers["Content-Type"] = "application/json";
   }
-  object.values["flags"] = flags;
 
-  return OK(object, request.url.query.get("jsonp"));
+  response.headers["Content-Length"] = stringify(response.body.size());
+
+  return response;
 }
 
 } // namespace slave {
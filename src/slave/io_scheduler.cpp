@@ -0,0 +1,175 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+
+#include <process/clock.hpp>
+#include <process/id.hpp>
+
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
+#include <stout/option.hpp>
+
+#include "slave/constants.hpp"
+#include "slave/io_scheduler.hpp"
+
+using namespace process;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Per-class operation start rates (tokens per second) and bursts.
+// Provisioning copies whole image layers and garbage collection
+// removes whole sandboxes, so their operations are long and start
+// rarely; disk usage scans are short and frequent.
+static const double PROVISIONING_RATE = 0.5;
+static const double PROVISIONING_BURST = 2.0;
+
+static const double FETCH_RATE = 2.0;
+static const double FETCH_BURST = 4.0;
+
+static const double GC_RATE = 1.0;
+static const double GC_BURST = 2.0;
+
+static const double MONITOR_RATE = 4.0;
+static const double MONITOR_BURST = 8.0;
+
+
+IOScheduler* IOScheduler::instance()
+{
+  // NOTE: The instance is created on first use and intentionally
+  // never deleted, like the other process-wide singletons.
+  static IOScheduler* scheduler = new IOScheduler();
+  return scheduler;
+}
+
+
+IOScheduler::IOScheduler()
+{
+  process = new IOSchedulerProcess();
+  spawn(process);
+}
+
+
+IOSchedulerProcess::IOSchedulerProcess()
+  : ProcessBase(ID::generate("io-scheduler")),
+    running(0),
+    timing(false)
+{
+  buckets[IOScheduler::PROVISIONING] =
+    Bucket(PROVISIONING_RATE, PROVISIONING_BURST);
+  buckets[IOScheduler::FETCH] = Bucket(FETCH_RATE, FETCH_BURST);
+  buckets[IOScheduler::GC] = Bucket(GC_RATE, GC_BURST);
+  buckets[IOScheduler::MONITOR] = Bucket(MONITOR_RATE, MONITOR_BURST);
+}
+
+
+void IOSchedulerProcess::Bucket::refill(const Time& now)
+{
+  tokens = std::min(burst, tokens + rate * (now - updated).secs());
+  updated = now;
+}
+
+
+Future<Nothing> IOSchedulerProcess::acquire(IOScheduler::Class c)
+{
+  CHECK(buckets.count(c) > 0);
+
+  Bucket& bucket = buckets[c];
+
+  bucket.refill(Clock::now());
+
+  // Fast path: admit immediately when there is no queue for this
+  // class, a token is available and the pool has a free slot.
+  if (bucket.waiters.empty() &&
+      bucket.tokens >= 1.0 &&
+      running < IO_SCHEDULER_CONCURRENCY) {
+    bucket.tokens -= 1.0;
+    running++;
+    return Nothing();
+  }
+
+  bucket.waiters.push_back(Owned<Promise<Nothing>>(new Promise<Nothing>()));
+
+  Future<Nothing> future = bucket.waiters.back()->future();
+
+  admit();
+
+  return future;
+}
+
+
+void IOSchedulerProcess::release()
+{
+  CHECK(running > 0);
+
+  running--;
+
+  admit();
+}
+
+
+void IOSchedulerProcess::admit()
+{
+  Time now = Clock::now();
+
+  // The shortest wait until some throttled class accrues its next
+  // token, across all classes with waiters.
+  Option<Duration> next = None();
+
+  foreachvalue (Bucket& bucket, buckets) {
+    bucket.refill(now);
+
+    while (!bucket.waiters.empty() &&
+           bucket.tokens >= 1.0 &&
+           running < IO_SCHEDULER_CONCURRENCY) {
+      bucket.tokens -= 1.0;
+      running++;
+      bucket.waiters.front()->set(Nothing());
+      bucket.waiters.pop_front();
+    }
+
+    if (!bucket.waiters.empty() && running < IO_SCHEDULER_CONCURRENCY) {
+      // Blocked on tokens rather than pool slots: compute when the
+      // next token accrues. (When blocked on the pool, 'release()'
+      // re-runs the admission instead.)
+      Try<Duration> wait =
+        Duration::create((1.0 - bucket.tokens) / bucket.rate);
+
+      if (wait.isSome() &&
+          (next.isNone() || wait.get() < next.get())) {
+        next = wait.get();
+      }
+    }
+  }
+
+  if (next.isSome() && !timing) {
+    timing = true;
+    delay(next.get(), self(), &IOSchedulerProcess::_admit);
+  }
+}
+
+
+void IOSchedulerProcess::_admit()
+{
+  timing = false;
+  admit();
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,156 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_IO_SCHEDULER_HPP__
+#define __SLAVE_IO_SCHEDULER_HPP__
+
+#include <deque>
+#include <map>
+
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+#include <process/time.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class IOSchedulerProcess;
+
+// Schedules the background disk traffic on the slave (image
+// provisioning, fetcher downloads, garbage collection removals and
+// disk usage scanning) so that it does not compete unchecked with
+// task I/O. Work is submitted tagged with a class; each class has a
+// token bucket limiting how often its operations may start, and all
+// classes share a bounded pool of in-flight operations. Task p99
+// latency spikes during image provisioning motivated this: without
+// throttling a single provision saturates the disk.
+class IOScheduler
+{
+public:
+  enum Class
+  {
+    PROVISIONING,
+    FETCH,
+    GC,
+    MONITOR,
+  };
+
+  // Returns the process-wide scheduler, shared by all components so
+  // that the classes are throttled against each other.
+  static IOScheduler* instance();
+
+  // Runs 'work' once the class's token bucket and the shared pool
+  // admit it. The returned future completes with the result of the
+  // work; the pool slot is released when that result is no longer
+  // pending.
+  template <typename T>
+  process::Future<T> schedule(
+      Class c,
+      const lambda::function<process::Future<T>()>& work);
+
+private:
+  IOScheduler();
+
+  IOScheduler(const IOScheduler&); // No copying.
+  IOScheduler& operator=(const IOScheduler&); // No assigning.
+
+  IOSchedulerProcess* process;
+};
+
+
+class IOSchedulerProcess : public process::Process<IOSchedulerProcess>
+{
+public:
+  IOSchedulerProcess();
+
+  // Returns a future that becomes ready once the class's token
+  // bucket has a token and the shared pool has a free slot. Admitted
+  // in FIFO order within a class.
+  process::Future<Nothing> acquire(IOScheduler::Class c);
+
+  // Releases a pool slot; invoked when an admitted operation has
+  // completed.
+  void release();
+
+private:
+  // A token bucket: 'tokens' refills at 'rate' tokens per second up
+  // to 'burst', and an operation start consumes one token.
+  struct Bucket
+  {
+    Bucket() : rate(0.0), burst(0.0), tokens(0.0) {}
+    Bucket(double _rate, double _burst)
+      : rate(_rate), burst(_burst), tokens(_burst) {}
+
+    void refill(const process::Time& now);
+
+    double rate;
+    double burst;
+    double tokens;
+    process::Time updated;
+
+    std::deque<process::Owned<process::Promise<Nothing>>> waiters;
+  };
+
+  // Admits waiters while tokens and pool slots are available, and
+  // schedules a timer for the next token otherwise.
+  void admit();
+  void _admit();
+
+  // NOTE: An ordered map (rather than a hashmap) since 'std::hash'
+  // of an enumeration requires C++14.
+  std::map<IOScheduler::Class, Bucket> buckets;
+
+  // Number of operations currently in flight across all classes.
+  size_t running;
+
+  // Whether an 'admit()' timer is already pending.
+  bool timing;
+};
+
+
+template <typename T>
+process::Future<T> IOScheduler::schedule(
+    Class c,
+    const lambda::function<process::Future<T>()>& work)
+{
+  IOSchedulerProcess* process = this->process;
+
+  return process::dispatch(process, &IOSchedulerProcess::acquire, c)
+    .then([process, work]() {
+      process::Future<T> result = work();
+
+      result.onAny([process](const process::Future<T>&) {
+        process::dispatch(process, &IOSchedulerProcess::release);
+      });
+
+      return result;
+    });
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_IO_SCHEDULER_HPP__
@@ -86,7 +86,9 @@ Metrics::Metrics(const Slave& slave)
         "slave/executor_directory_max_allowed_age_secs",
         defer(slave, &Slave::_executor_directory_max_allowed_age_secs)),
     container_launch_errors(
-        "slave/container_launch_errors")
+        "slave/container_launch_errors"),
+    executor_launch(
+        "slave/executor_launch")
 {
   // TODO(dhamon): Check return values for metric registration.
   process::metrics::add(uptime_secs);
@@ -120,6 +122,8 @@ Metrics::Metrics(const Slave& slave)
 
   process::metrics::add(container_launch_errors);
 
+  process::metrics::add(executor_launch);
+
   // Create resource gauges.
   // TODO(dhamon): Set these up dynamically when creating a slave
   // based on the resources it exposes.
@@ -205,6 +209,8 @@ Metrics::~Metrics()
 
   process::metrics::remove(container_launch_errors);
 
+  process::metrics::remove(executor_launch);
+
   foreach (const Gauge& gauge, resources_total) {
     process::metrics::remove(gauge);
   }
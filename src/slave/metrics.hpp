@@ -21,6 +21,9 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
+#include <process/metrics/timer.hpp>
+
+#include <stout/duration.hpp>
 
 
 namespace mesos {
@@ -66,6 +69,11 @@ struct Metrics
 
   process::metrics::Counter container_launch_errors;
 
+  // Time from asking the containerizer to launch an executor's
+  // container until the launch completes; this is dominated by the
+  // subprocess spawn latency for the non-image code paths.
+  process::metrics::Timer<Milliseconds> executor_launch;
+
   // Non-revocable resources.
   std::vector<process::metrics::Gauge> resources_total;
   std::vector<process::metrics::Gauge> resources_used;
@@ -18,6 +18,7 @@
 
 #include <glog/logging.h>
 
+#include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/future.hpp>
@@ -25,9 +26,12 @@
 #include <process/http.hpp>
 #include <process/limiter.hpp>
 #include <process/process.hpp>
+#include <process/time.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/json.hpp>
 #include <stout/lambda.hpp>
+#include <stout/option.hpp>
 #include <stout/protobuf.hpp>
 
 #include "slave/monitor.hpp"
@@ -40,6 +44,11 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
+// A rendered statistics snapshot is considered fresh for this long;
+// all requests within the window are served the same snapshot.
+static const Duration SNAPSHOT_INTERVAL = Seconds(1);
+
+
 static const string STATISTICS_HELP()
 {
   return HELP(
@@ -112,25 +121,39 @@ private:
 
   Future<http::Response> _statistics(const http::Request& request)
   {
-    return usage()
+    // NOTE: Collecting usage walks every container's cgroups, so
+    // rather than collecting once per request we refresh a shared
+    // snapshot at most once per SNAPSHOT_INTERVAL and serve it to
+    // all concurrent and subsequent requests within the window.
+    // Requests arriving while a collection is in progress share its
+    // result.
+    bool reuse = false;
+
+    if (snapshot.isSome()) {
+      if (snapshot.get().isPending()) {
+        reuse = true;
+      } else if (snapshot.get().isReady() &&
+                 Clock::now(this) < expiration) {
+        reuse = true;
+      }
+    }
+
+    if (!reuse) {
+      snapshot = usage()
+        .then(defer(self(), &Self::render, lambda::_1));
+    }
+
+    return snapshot.get()
       .then(defer(self(), &Self::__statistics, lambda::_1, request));
   }
 
-  Future<http::Response> __statistics(
-      const Future<ResourceUsage>& future,
-      const http::Request& request)
+  JSON::Array render(const ResourceUsage& usage)
   {
-    if (!future.isReady()) {
-      LOG(WARNING) << "Could not collect resource usage: "
-                   << (future.isFailed() ? future.failure() : "discarded");
-
-      return http::InternalServerError();
-    }
+    expiration = Clock::now(this) + SNAPSHOT_INTERVAL;
 
     JSON::Array result;
 
-    foreach (const ResourceUsage::Executor& executor,
-             future.get().executors()) {
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
       if (executor.has_statistics()) {
         const ExecutorInfo info = executor.executor_info();
 
@@ -145,7 +168,21 @@ private:
       }
     }
 
-    return http::OK(result, request.url.query.get("jsonp"));
+    return result;
+  }
+
+  Future<http::Response> __statistics(
+      const Future<JSON::Array>& future,
+      const http::Request& request)
+  {
+    if (!future.isReady()) {
+      LOG(WARNING) << "Could not collect resource usage: "
+                   << (future.isFailed() ? future.failure() : "discarded");
+
+      return http::InternalServerError();
+    }
+
+    return http::OK(future.get(), request.url.query.get("jsonp"));
   }
 
   // Callback used to retrieve resource usage information from slave.
@@ -153,6 +190,12 @@ private:
 
   // Used to rate limit the statistics endpoint.
   RateLimiter limiter;
+
+  // Cached snapshot of the rendered statistics shared by all
+  // requests that arrive while it is fresh (or while its collection
+  // is still in progress), and the time at which it goes stale.
+  Option<Future<JSON::Array>> snapshot;
+  Time expiration;
 };
 
 
@@ -51,6 +51,7 @@ const char EXECUTOR_SENTINEL_FILE[] = "executor.sentinel";
 const char HTTP_MARKER_FILE[] = "http.marker";
 const char FORKED_PID_FILE[] = "forked.pid";
 const char TASK_INFO_FILE[] = "task.info";
+const char TASK_INFOS_FILE[] = "tasks.info";
 const char TASK_UPDATES_FILE[] = "task.updates";
 const char RESOURCES_INFO_FILE[] = "resources.info";
 
@@ -356,6 +357,24 @@ string getTaskInfoPath(
 }
 
 
+string getTaskInfosPath(
+    const string& rootDir,
+    const SlaveID& slaveId,
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId)
+{
+  return path::join(
+      getExecutorRunPath(
+          rootDir,
+          slaveId,
+          frameworkId,
+          executorId,
+          containerId),
+      TASK_INFOS_FILE);
+}
+
+
 string getTaskUpdatesPath(
     const string& rootDir,
     const SlaveID& slaveId,
@@ -376,6 +395,97 @@ string getTaskUpdatesPath(
 }
 
 
+// Appends a single component to a preassembled prefix, sizing the
+// result up front (see 'RunPaths' in paths.hpp).
+static string append(const string& prefix, const string& component)
+{
+  string result;
+  result.reserve(prefix.size() + 1 + component.size());
+  result += prefix;
+  result += '/';
+  result += component;
+  return result;
+}
+
+
+// Appends two components to a preassembled prefix.
+static string append(
+    const string& prefix,
+    const string& component1,
+    const string& component2)
+{
+  string result;
+  result.reserve(
+      prefix.size() + 1 + component1.size() + 1 + component2.size());
+  result += prefix;
+  result += '/';
+  result += component1;
+  result += '/';
+  result += component2;
+  return result;
+}
+
+
+RunPaths::RunPaths(
+    const string& rootDir,
+    const SlaveID& slaveId,
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId)
+  : run(getExecutorRunPath(
+        rootDir, slaveId, frameworkId, executorId, containerId)),
+    pids(append(run, "pids")),
+    tasks(append(run, "tasks")) {}
+
+
+string RunPaths::getExecutorHttpMarkerPath() const
+{
+  return append(run, HTTP_MARKER_FILE);
+}
+
+
+string RunPaths::getExecutorSentinelPath() const
+{
+  return append(run, EXECUTOR_SENTINEL_FILE);
+}
+
+
+string RunPaths::getLibprocessPidPath() const
+{
+  return append(pids, LIBPROCESS_PID_FILE);
+}
+
+
+string RunPaths::getForkedPidPath() const
+{
+  return append(pids, FORKED_PID_FILE);
+}
+
+
+string RunPaths::getTaskInfosPath() const
+{
+  return append(run, TASK_INFOS_FILE);
+}
+
+
+string RunPaths::getTaskPath(const TaskID& taskId) const
+{
+  return append(tasks, taskId.value());
+}
+
+
+string RunPaths::getTaskInfoPath(const TaskID& taskId) const
+{
+  return append(tasks, taskId.value(), TASK_INFO_FILE);
+}
+
+
+string RunPaths::getTaskUpdatesPath(const TaskID& taskId) const
+{
+  return append(tasks, taskId.value(), TASK_UPDATES_FILE);
+}
+
+
 string getResourcesInfoPath(
     const string& rootDir)
 {
@@ -77,9 +77,10 @@ namespace paths {
 //   |                                   |-- pids
 //   |                                   |   |-- forked.pid
 //   |                                   |   |-- libprocess.pid
+//   |                                   |-- tasks.info
 //   |                                   |-- tasks
 //   |                                       |-- <task_id>
-//   |                                           |-- task.info
+//   |                                           |-- task.info (legacy)
 //   |                                           |-- task.updates
 //   |-- boot_id
 //   |-- resources
@@ -244,6 +245,9 @@ std::string getTaskPath(
     const TaskID& taskId);
 
 
+// NOTE: This is the legacy one-file-per-task location of the task
+// info; newer slaves append task infos to the per-run log returned
+// by 'getTaskInfosPath' below.
 std::string getTaskInfoPath(
     const std::string& rootDir,
     const SlaveID& slaveId,
@@ -253,6 +257,14 @@ std::string getTaskInfoPath(
     const TaskID& taskId);
 
 
+std::string getTaskInfosPath(
+    const std::string& rootDir,
+    const SlaveID& slaveId,
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId);
+
+
 std::string getTaskUpdatesPath(
     const std::string& rootDir,
     const SlaveID& slaveId,
@@ -262,6 +274,44 @@ std::string getTaskUpdatesPath(
     const TaskID& taskId);
 
 
+// Caches the preassembled path prefixes for a single executor run.
+// The helpers above rebuild the whole prefix chain (slave, framework,
+// executor, run) with one 'path::join' per level on every call, so
+// hot paths that construct many paths for the same run (e.g.,
+// checkpointing the tasks of a launch, or recovering a run) pay
+// dozens of allocations for the same prefixes. This class assembles
+// each prefix once and builds every leaf path with a single sized
+// append.
+class RunPaths
+{
+public:
+  RunPaths(
+      const std::string& rootDir,
+      const SlaveID& slaveId,
+      const FrameworkID& frameworkId,
+      const ExecutorID& executorId,
+      const ContainerID& containerId);
+
+  // Equivalents of the run-level helpers above.
+  const std::string& getExecutorRunPath() const { return run; }
+  std::string getExecutorHttpMarkerPath() const;
+  std::string getExecutorSentinelPath() const;
+  std::string getLibprocessPidPath() const;
+  std::string getForkedPidPath() const;
+  std::string getTaskInfosPath() const;
+
+  // Equivalents of the task-level helpers above.
+  std::string getTaskPath(const TaskID& taskId) const;
+  std::string getTaskInfoPath(const TaskID& taskId) const;
+  std::string getTaskUpdatesPath(const TaskID& taskId) const;
+
+private:
+  std::string run;   // '.../runs/<container_id>'.
+  std::string pids;  // '<run>/pids'.
+  std::string tasks; // '<run>/tasks'.
+};
+
+
 std::string getResourcesInfoPath(
     const std::string& rootDir);
 
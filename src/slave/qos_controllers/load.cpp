@@ -16,16 +16,25 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <mesos/module/qos_controller.hpp>
 
 #include <mesos/slave/qos_controller.hpp>
 
 #include <process/defer.hpp>
+#include <process/delay.hpp>
 #include <process/dispatch.hpp>
+#include <process/help.hpp>
+#include <process/http.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/json.hpp>
 #include <stout/lambda.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
@@ -50,6 +59,30 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
+// How often the controller refreshes its per-container usage
+// estimates. Corrections are answered from these estimates, so this
+// bounds the staleness of an eviction decision independently of the
+// slave's correction interval.
+static const Duration POLL_INTERVAL = Seconds(1);
+
+// Smoothing factor for the per-container CPU usage EWMA. A higher
+// value weighs recent samples more heavily.
+static const double EWMA_ALPHA = 0.25;
+
+
+static const string SCORE_HELP()
+{
+  return HELP(
+      TLDR(
+          "Dry-run scoring of the Load QoS Controller."),
+      DESCRIPTION(
+          "Returns the current system load, whether the controller",
+          "considers the system overloaded, and the per-container",
+          "usage estimates it maintains, including whether each",
+          "container would be evicted by a correction right now.",
+          "No corrections are performed by this endpoint."));
+}
+
 
 class LoadQoSControllerProcess : public Process<LoadQoSControllerProcess>
 {
@@ -59,17 +92,142 @@ public:
       const lambda::function<Try<os::Load>()>& _loadAverage,
       const Option<double>& _loadThreshold5Min,
       const Option<double>& _loadThreshold15Min)
-    : usage(_usage),
+    : ProcessBase("load_qos_controller"),
+      usage(_usage),
       loadAverage(_loadAverage),
       loadThreshold5Min(_loadThreshold5Min),
-      loadThreshold15Min(_loadThreshold15Min) {}
+      loadThreshold15Min(_loadThreshold15Min),
+      polled(false) {}
 
   Future<std::list<QoSCorrection>> corrections()
   {
-    return usage().then(defer(self(), &Self::_corrections, lambda::_1));
+    // Until the first poll has populated the estimates, fall back to
+    // fetching usage directly so that early corrections are not
+    // computed from an empty cache.
+    if (!polled) {
+      return usage().then(defer(self(), &Self::_corrections, lambda::_1));
+    }
+
+    return evaluate();
   }
 
   Future<std::list<QoSCorrection>> _corrections(const ResourceUsage& usage)
+  {
+    update(usage);
+    return evaluate();
+  }
+
+protected:
+  virtual void initialize()
+  {
+    route("/score", SCORE_HELP(), &Self::score);
+
+    poll();
+  }
+
+private:
+  // Per-container usage estimate, updated incrementally from the
+  // periodic resource usage polls.
+  struct ContainerUsage
+  {
+    ContainerUsage() : revocable(false) {}
+
+    FrameworkID frameworkId;
+    ExecutorID executorId;
+    bool revocable;
+
+    // EWMA of the container's CPU usage rate (in cpus), along with
+    // the sample it was last advanced from.
+    Option<double> cpusEwma;
+    Option<double> previousCpusTime;
+    Option<double> previousTimestamp;
+  };
+
+  void poll()
+  {
+    usage().onAny(defer(self(), &Self::_poll, lambda::_1));
+  }
+
+  void _poll(const Future<ResourceUsage>& future)
+  {
+    // Make sure the poll is scheduled again.
+    delay(POLL_INTERVAL, self(), &Self::poll);
+
+    if (!future.isReady()) {
+      LOG(WARNING) << "Failed to refresh resource usage: "
+                   << (future.isFailed() ? future.failure() : "discarded");
+      return;
+    }
+
+    update(future.get());
+  }
+
+  void update(const ResourceUsage& usage)
+  {
+    hashset<string> active;
+
+    for (const ResourceUsage::Executor& executor : usage.executors()) {
+      const ExecutorInfo& info = executor.executor_info();
+
+      const string key =
+        info.framework_id().value() + "/" + info.executor_id().value();
+
+      active.insert(key);
+
+      if (!containers.contains(key)) {
+        ContainerUsage container;
+        container.frameworkId = info.framework_id();
+        container.executorId = info.executor_id();
+        containers[key] = container;
+      }
+
+      ContainerUsage& container = containers[key];
+
+      container.revocable =
+        !Resources(executor.allocated()).revocable().empty();
+
+      if (executor.has_statistics() &&
+          executor.statistics().has_cpus_user_time_secs() &&
+          executor.statistics().has_cpus_system_time_secs()) {
+        const ResourceStatistics& statistics = executor.statistics();
+
+        double cpusTime = statistics.cpus_user_time_secs() +
+                          statistics.cpus_system_time_secs();
+
+        if (container.previousTimestamp.isSome() &&
+            statistics.timestamp() > container.previousTimestamp.get()) {
+          double rate = (cpusTime - container.previousCpusTime.get()) /
+            (statistics.timestamp() - container.previousTimestamp.get());
+
+          container.cpusEwma = container.cpusEwma.isSome()
+            ? EWMA_ALPHA * rate +
+              (1 - EWMA_ALPHA) * container.cpusEwma.get()
+            : rate;
+        }
+
+        container.previousCpusTime = cpusTime;
+        container.previousTimestamp = statistics.timestamp();
+      }
+    }
+
+    // Drop estimates for containers which are no longer running.
+    std::vector<string> stale;
+    foreachkey (const string& key, containers) {
+      if (!active.contains(key)) {
+        stale.push_back(key);
+      }
+    }
+
+    foreach (const string& key, stale) {
+      containers.erase(key);
+    }
+
+    polled = true;
+  }
+
+  // Computes the corrections for the current interval from the
+  // cached estimates. All corrections are returned in one batch.
+  std::list<QoSCorrection> evaluate()
   {
     Try<os::Load> load = loadAverage();
     if (load.isError()) {
@@ -77,53 +235,106 @@ public:
       return std::list<QoSCorrection>();
     }
 
-    bool overloaded = false;
+    if (!overloaded(load.get())) {
+      return std::list<QoSCorrection>();
+    }
+
+    std::list<QoSCorrection> corrections;
+
+    foreachvalue (const ContainerUsage& container, containers) {
+      // Set kill correction for all revocable executors.
+      if (container.revocable) {
+        QoSCorrection correction;
+
+        correction.set_type(mesos::slave::QoSCorrection_Type_KILL);
+        correction.mutable_kill()->mutable_framework_id()->CopyFrom(
+          container.frameworkId);
+        correction.mutable_kill()->mutable_executor_id()->CopyFrom(
+          container.executorId);
+
+        corrections.push_back(correction);
+      }
+    }
+
+    return corrections;
+  }
+
+  bool overloaded(const os::Load& load) const
+  {
+    bool result = false;
 
     if (loadThreshold5Min.isSome()) {
-      if (load.get().five > loadThreshold5Min.get()) {
-        LOG(INFO) << "System 5 minutes load average " << load.get().five
+      if (load.five > loadThreshold5Min.get()) {
+        LOG(INFO) << "System 5 minutes load average " << load.five
                   << " exceeds threshold " << loadThreshold5Min.get();
-        overloaded = true;
+        result = true;
       }
     }
 
     if (loadThreshold15Min.isSome()) {
-      if (load.get().fifteen > loadThreshold15Min.get()) {
-        LOG(INFO) << "System 15 minutes load average " << load.get().fifteen
+      if (load.fifteen > loadThreshold15Min.get()) {
+        LOG(INFO) << "System 15 minutes load average " << load.fifteen
                   << " exceeds threshold " << loadThreshold15Min.get();
-        overloaded = true;
+        result = true;
       }
     }
 
-    if (overloaded) {
-      std::list<QoSCorrection> corrections;
+    return result;
+  }
 
-      for (const ResourceUsage::Executor& executor : usage.executors()) {
-        // Set kill correction for all revocable executors.
-        if (!Resources(executor.allocated()).revocable().empty()) {
-          QoSCorrection correction;
+  // Dry-run scoring: renders the cached estimates and the eviction
+  // decision the controller would make right now, without performing
+  // any corrections.
+  Future<http::Response> score(const http::Request& request)
+  {
+    JSON::Object result;
 
-          correction.set_type(mesos::slave::QoSCorrection_Type_KILL);
-          correction.mutable_kill()->mutable_framework_id()->CopyFrom(
-            executor.executor_info().framework_id());
-          correction.mutable_kill()->mutable_executor_id()->CopyFrom(
-            executor.executor_info().executor_id());
+    bool evict = false;
 
-          corrections.push_back(correction);
-        }
+    Try<os::Load> load = loadAverage();
+    if (load.isSome()) {
+      evict = overloaded(load.get());
+
+      JSON::Object load_;
+      load_.values["five"] = load.get().five;
+      load_.values["fifteen"] = load.get().fifteen;
+
+      result.values["load"] = load_;
+      result.values["overloaded"] = JSON::Boolean(evict);
+    }
+
+    JSON::Array executors;
+
+    foreachvalue (const ContainerUsage& container, containers) {
+      JSON::Object entry;
+      entry.values["framework_id"] = container.frameworkId.value();
+      entry.values["executor_id"] = container.executorId.value();
+      entry.values["revocable"] = JSON::Boolean(container.revocable);
+
+      if (container.cpusEwma.isSome()) {
+        entry.values["cpus_ewma"] = container.cpusEwma.get();
       }
 
-      return corrections;
+      entry.values["evict"] = JSON::Boolean(evict && container.revocable);
+
+      executors.values.push_back(entry);
     }
 
-    return std::list<QoSCorrection>();
+    result.values["executors"] = executors;
+
+    return http::OK(result, request.url.query.get("jsonp"));
   }
 
-private:
   const lambda::function<Future<ResourceUsage>()> usage;
   const lambda::function<Try<os::Load>()> loadAverage;
   const Option<double> loadThreshold5Min;
   const Option<double> loadThreshold15Min;
+
+  // Per-container usage estimates, keyed by "<framework>/<executor>".
+  hashmap<string, ContainerUsage> containers;
+
+  // Whether at least one poll has populated 'containers'.
+  bool polled;
 };
 
 
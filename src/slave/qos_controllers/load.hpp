@@ -41,6 +41,14 @@ class LoadQoSControllerProcess;
 // system load (5min or 15min) is above the configured threshold.
 // NOTE: 1 minute system load is ignored, because
 // for most use cases it is a misleading signal.
+//
+// The controller maintains per-container usage estimates (EWMAs of
+// the CPU usage rate) incrementally from a periodic resource usage
+// poll, so corrections are answered from cached state rather than
+// recomputed from scratch, and all corrections for an interval are
+// returned in one batch. The estimates and the eviction decision
+// can be inspected without side effects through the controller's
+// '/load_qos_controller/score' endpoint.
 class LoadQoSController : public mesos::slave::QoSController
 {
 public:
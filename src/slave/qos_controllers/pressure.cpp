@@ -0,0 +1,241 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <list>
+#include <string>
+
+#include <mesos/module/qos_controller.hpp>
+
+#include <mesos/slave/qos_controller.hpp>
+
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+
+#include <stout/lambda.hpp>
+#include <stout/option.hpp>
+#include <stout/result.hpp>
+
+#include "linux/cgroups.hpp"
+
+#include "slave/qos_controllers/pressure.hpp"
+
+using namespace mesos;
+using namespace process;
+
+using std::list;
+using std::string;
+
+using cgroups::memory::pressure::Counter;
+using cgroups::memory::pressure::Level;
+
+using mesos::modules::Module;
+
+using mesos::slave::QoSController;
+using mesos::slave::QoSCorrection;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+
+class MemoryPressureQoSControllerProcess
+  : public Process<MemoryPressureQoSControllerProcess>
+{
+public:
+  MemoryPressureQoSControllerProcess(
+      const lambda::function<Future<ResourceUsage>()>& _usage,
+      const string& _hierarchy,
+      const string& _cgroup,
+      Level _level)
+    : usage(_usage),
+      hierarchy(_hierarchy),
+      cgroup(_cgroup),
+      level(_level) {}
+
+  Future<list<QoSCorrection>> corrections()
+  {
+    if (counter.isNone()) {
+      Try<Owned<Counter>> create = Counter::create(hierarchy, cgroup, level);
+      if (create.isError()) {
+        return Failure(
+            "Failed to create memory pressure counter: " + create.error());
+      }
+
+      counter = create.get();
+    }
+
+    // The returned future stays pending until the kernel signals the
+    // pressure level, so the slave receives the corrections when the
+    // event fires rather than at its next poll.
+    Future<uint64_t> next = counter.get()->next();
+
+    next.onAny(defer(self(), &Self::_reset, lambda::_1));
+
+    return next.then(defer(self(), &Self::_corrections, lambda::_1));
+  }
+
+  Future<list<QoSCorrection>> _corrections(uint64_t count)
+  {
+    LOG(INFO) << "Memory pressure level '" << level << "' signaled on cgroup "
+              << "'" << cgroup << "' (" << count << " events in total);"
+              << " evicting all revocable executors";
+
+    return usage().then(defer(self(), &Self::__corrections, lambda::_1));
+  }
+
+  Future<list<QoSCorrection>> __corrections(const ResourceUsage& usage)
+  {
+    list<QoSCorrection> corrections;
+
+    for (const ResourceUsage::Executor& executor : usage.executors()) {
+      // Set kill correction for all revocable executors.
+      if (!Resources(executor.allocated()).revocable().empty()) {
+        QoSCorrection correction;
+
+        correction.set_type(mesos::slave::QoSCorrection_Type_KILL);
+        correction.mutable_kill()->mutable_framework_id()->CopyFrom(
+          executor.executor_info().framework_id());
+        correction.mutable_kill()->mutable_executor_id()->CopyFrom(
+          executor.executor_info().executor_id());
+
+        corrections.push_back(correction);
+      }
+    }
+
+    return corrections;
+  }
+
+private:
+  void _reset(const Future<uint64_t>& future)
+  {
+    // Once monitoring fails the counter is dead (see
+    // cgroups::memory::pressure::Counter), so create a
+    // new one on the next 'corrections' call.
+    if (future.isFailed()) {
+      counter = None();
+    }
+  }
+
+  const lambda::function<Future<ResourceUsage>()> usage;
+  const string hierarchy;
+  const string cgroup;
+  const Level level;
+  Option<Owned<Counter>> counter;
+};
+
+
+MemoryPressureQoSController::~MemoryPressureQoSController()
+{
+  if (process.get() != NULL) {
+    terminate(process.get());
+    wait(process.get());
+  }
+}
+
+
+Try<Nothing> MemoryPressureQoSController::initialize(
+  const lambda::function<Future<ResourceUsage>()>& usage)
+{
+  if (process.get() != NULL) {
+    return Error("Memory pressure QoS Controller has already been initialized");
+  }
+
+  process.reset(
+      new MemoryPressureQoSControllerProcess(
+          usage,
+          hierarchy,
+          cgroup,
+          level));
+
+  spawn(process.get());
+
+  return Nothing();
+}
+
+
+process::Future<std::list<QoSCorrection>>
+MemoryPressureQoSController::corrections()
+{
+  if (process.get() == NULL) {
+    return Failure("Memory pressure QoS Controller is not initialized");
+  }
+
+  return dispatch(
+      process.get(),
+      &MemoryPressureQoSControllerProcess::corrections);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+
+static QoSController* create(const Parameters& parameters)
+{
+  // Obtain the pressure level and cgroup from parameters; by default
+  // we react to critical pressure on the root memory cgroup.
+  Option<string> hierarchy = None();
+  string cgroup = "/";
+  Level level = Level::CRITICAL;
+
+  for (const Parameter& parameter : parameters.parameter()) {
+    if (parameter.key() == "hierarchy") {
+      hierarchy = parameter.value();
+    } else if (parameter.key() == "cgroup") {
+      cgroup = parameter.value();
+    } else if (parameter.key() == "level") {
+      if (parameter.value() == "low") {
+        level = Level::LOW;
+      } else if (parameter.value() == "medium") {
+        level = Level::MEDIUM;
+      } else if (parameter.value() == "critical") {
+        level = Level::CRITICAL;
+      } else {
+        LOG(ERROR) << "Failed to parse memory pressure level '"
+                   << parameter.value() << "'";
+        return NULL;
+      }
+    }
+  }
+
+  if (hierarchy.isNone()) {
+    Result<string> _hierarchy = cgroups::hierarchy("memory");
+    if (!_hierarchy.isSome()) {
+      LOG(ERROR) << "Failed to determine the memory cgroup hierarchy: "
+                 << (_hierarchy.isError()
+                     ? _hierarchy.error()
+                     : "memory subsystem is not mounted");
+      return NULL;
+    }
+
+    hierarchy = _hierarchy.get();
+  }
+
+  return new mesos::internal::slave::MemoryPressureQoSController(
+      hierarchy.get(), cgroup, level);
+}
+
+
+Module<QoSController> org_apache_mesos_MemoryPressureQoSController(
+    MESOS_MODULE_API_VERSION,
+    MESOS_VERSION,
+    "Apache Mesos",
+    "modules@mesos.apache.org",
+    "Memory Pressure QoS Controller Module.",
+    NULL,
+    create);
@@ -0,0 +1,77 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_QOS_CONTROLLERS_PRESSURE_HPP__
+#define __SLAVE_QOS_CONTROLLERS_PRESSURE_HPP__
+
+#include <list>
+#include <string>
+
+#include <mesos/slave/qos_controller.hpp>
+
+#include <stout/lambda.hpp>
+#include <stout/try.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include "linux/cgroups.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class MemoryPressureQoSControllerProcess;
+
+
+// The `MemoryPressureQoSController` is a QoS Controller which evicts
+// all revocable executors as soon as the configured memory cgroup
+// signals the configured pressure level. Unlike controllers that act
+// on periodically sampled usage, it waits on the kernel's eventfd
+// based pressure notification (see cgroups::memory::pressure), so
+// corrections are delivered to the slave when the pressure event
+// fires rather than at the next poll tick.
+class MemoryPressureQoSController : public mesos::slave::QoSController
+{
+public:
+  MemoryPressureQoSController(
+      const std::string& _hierarchy,
+      const std::string& _cgroup,
+      cgroups::memory::pressure::Level _level)
+    : hierarchy(_hierarchy),
+      cgroup(_cgroup),
+      level(_level) {}
+
+  virtual ~MemoryPressureQoSController();
+
+  virtual Try<Nothing> initialize(
+      const lambda::function<process::Future<ResourceUsage>()>& usage);
+
+  virtual process::Future<std::list<mesos::slave::QoSCorrection>> corrections();
+
+private:
+  const std::string hierarchy;
+  const std::string cgroup;
+  const cgroups::memory::pressure::Level level;
+  process::Owned<MemoryPressureQoSControllerProcess> process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_QOS_CONTROLLERS_PRESSURE_HPP__
@@ -0,0 +1,367 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mesos/module/resource_estimator.hpp>
+
+#include <mesos/slave/resource_estimator.hpp>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+
+using namespace mesos;
+using namespace process;
+
+using std::deque;
+using std::pair;
+using std::string;
+using std::vector;
+
+using mesos::modules::Module;
+
+using mesos::slave::ResourceEstimator;
+
+
+// An estimator that derives the revocable capacity from the observed
+// usage of the allocated (non-revocable) resources: it periodically
+// polls the resource monitor, keeps a sliding window of total usage
+// samples and publishes 'total - percentile(usage)' as oversubscribable.
+// Unlike the fixed estimator this adapts to the actual slack on the
+// machine, at the cost of oscillating when the workload is bursty (the
+// percentile and window parameters control how conservative it is).
+class UsageResourceEstimatorProcess
+  : public Process<UsageResourceEstimatorProcess>
+{
+public:
+  UsageResourceEstimatorProcess(
+      const lambda::function<Future<ResourceUsage>()>& _usage,
+      const Resources& _total,
+      const Duration& _window,
+      const Duration& _interval,
+      double _percentile)
+    : usage(_usage),
+      total(_total),
+      window(_window),
+      interval(_interval),
+      percentile(_percentile) {}
+
+  Future<Resources> oversubscribable()
+  {
+    Resources result;
+
+    foreach (const Resource& resource, total) {
+      if (resource.name() == "cpus") {
+        result += estimate(resource, cpus);
+      } else if (resource.name() == "mem") {
+        result += estimate(resource, mem);
+      } else {
+        // We have no usage signal for other resources (e.g. disk I/O),
+        // so we expose them in full, like the fixed estimator does.
+        result += resource;
+      }
+    }
+
+    return result;
+  }
+
+protected:
+  virtual void initialize()
+  {
+    sample();
+  }
+
+private:
+  struct Samples
+  {
+    // Usage samples with the time at which they were taken, oldest
+    // first. Samples older than the window are pruned on insertion.
+    deque<pair<Time, double>> values;
+  };
+
+  void sample()
+  {
+    usage()
+      .onAny(defer(self(), &Self::_sample, lambda::_1));
+
+    delay(interval, self(), &Self::sample);
+  }
+
+  void _sample(const Future<ResourceUsage>& future)
+  {
+    if (!future.isReady()) {
+      LOG(ERROR) << "Failed to get resource usage: "
+                 << (future.isFailed() ? future.failure() : "discarded");
+      return;
+    }
+
+    const Time now = Clock::now();
+
+    double totalCpus = 0.0;
+    double totalMem = 0.0;
+
+    hashmap<string, pair<Time, double>> current;
+
+    foreach (const ResourceUsage::Executor& executor, future.get().executors()) {
+      if (!executor.has_statistics()) {
+        continue;
+      }
+
+      const ResourceStatistics& statistics = executor.statistics();
+
+      // Memory usage is reported directly; prefer the total (which
+      // includes the page cache) and fall back to the resident set.
+      if (statistics.has_mem_total_bytes()) {
+        totalMem += Bytes(statistics.mem_total_bytes()).megabytes();
+      } else if (statistics.has_mem_rss_bytes()) {
+        totalMem += Bytes(statistics.mem_rss_bytes()).megabytes();
+      }
+
+      // CPU time is cumulative, so we need two polls of the same
+      // executor to derive a rate.
+      if (statistics.has_cpus_user_time_secs() &&
+          statistics.has_cpus_system_time_secs()) {
+        const string key =
+          executor.executor_info().framework_id().value() + "/" +
+          executor.executor_info().executor_id().value();
+
+        double cpuTime =
+          statistics.cpus_user_time_secs() +
+          statistics.cpus_system_time_secs();
+
+        current[key] = {now, cpuTime};
+
+        Option<pair<Time, double>> previous_ = previous.get(key);
+        if (previous_.isSome() && now > previous_.get().first) {
+          double elapsed = (now - previous_.get().first).secs();
+          totalCpus +=
+            std::max(0.0, cpuTime - previous_.get().second) / elapsed;
+        }
+      }
+    }
+
+    previous = current;
+
+    insert(&cpus, now, totalCpus);
+    insert(&mem, now, totalMem);
+  }
+
+  void insert(Samples* samples, const Time& time, double value)
+  {
+    samples->values.push_back({time, value});
+
+    while (!samples->values.empty() &&
+           time - samples->values.front().first > window) {
+      samples->values.pop_front();
+    }
+  }
+
+  // Returns the revocable estimate for a scalar resource: the total
+  // minus the percentile of the usage samples, floored at zero. Until
+  // we have gathered any samples we estimate no usage, which matches
+  // the fixed estimator's behavior.
+  Resources estimate(const Resource& resource, const Samples& samples)
+  {
+    double used = 0.0;
+
+    if (!samples.values.empty()) {
+      vector<double> values;
+      values.reserve(samples.values.size());
+      foreach (const auto& sample, samples.values) {
+        values.push_back(sample.second);
+      }
+
+      // NOTE: the request suggested a t-digest sketch, but at one
+      // sample per poll a window holds at most a few thousand values,
+      // so we simply select on the materialized window.
+      size_t index = static_cast<size_t>(
+          (percentile / 100.0) * (values.size() - 1));
+
+      std::nth_element(values.begin(), values.begin() + index, values.end());
+
+      used = values[index];
+    }
+
+    double slack = resource.scalar().value() - used;
+    if (slack <= 0.0) {
+      return Resources();
+    }
+
+    Resource result = resource;
+    result.mutable_scalar()->set_value(slack);
+
+    return result;
+  }
+
+  const lambda::function<Future<ResourceUsage>()> usage;
+  const Resources total;
+  const Duration window;
+  const Duration interval;
+  const double percentile;
+
+  // Cumulative CPU time and poll time per executor, keyed by
+  // "<framework id>/<executor id>", from the previous poll.
+  hashmap<string, pair<Time, double>> previous;
+
+  Samples cpus;
+  Samples mem;
+};
+
+
+class UsageResourceEstimator : public ResourceEstimator
+{
+public:
+  UsageResourceEstimator(
+      const Resources& _total,
+      const Duration& _window,
+      const Duration& _interval,
+      double _percentile)
+    : total(_total),
+      window(_window),
+      interval(_interval),
+      percentile(_percentile)
+  {
+    // Mark all resources as revocable.
+    foreach (Resource& resource, total) {
+      resource.mutable_revocable();
+    }
+  }
+
+  virtual ~UsageResourceEstimator()
+  {
+    if (process.get() != NULL) {
+      terminate(process.get());
+      wait(process.get());
+    }
+  }
+
+  virtual Try<Nothing> initialize(
+      const lambda::function<Future<ResourceUsage>()>& usage)
+  {
+    if (process.get() != NULL) {
+      return Error("Usage resource estimator has already been initialized");
+    }
+
+    process.reset(new UsageResourceEstimatorProcess(
+        usage, total, window, interval, percentile));
+    spawn(process.get());
+
+    return Nothing();
+  }
+
+  virtual Future<Resources> oversubscribable()
+  {
+    if (process.get() == NULL) {
+      return Failure("Usage resource estimator is not initialized");
+    }
+
+    return dispatch(
+        process.get(),
+        &UsageResourceEstimatorProcess::oversubscribable);
+  }
+
+private:
+  Resources total;
+  const Duration window;
+  const Duration interval;
+  const double percentile;
+
+  Owned<UsageResourceEstimatorProcess> process;
+};
+
+
+static bool compatible()
+{
+  // TODO(jieyu): Check compatibility.
+  return true;
+}
+
+
+static ResourceEstimator* create(const Parameters& parameters)
+{
+  // Obtain the *total* resources eligible for oversubscription, plus
+  // the optional tuning knobs, from parameters.
+  Option<Resources> resources;
+  Duration window = Minutes(10);
+  Duration interval = Seconds(5);
+  double percentile = 99.0;
+
+  foreach (const Parameter& parameter, parameters.parameter()) {
+    if (parameter.key() == "resources") {
+      Try<Resources> _resources = Resources::parse(parameter.value());
+      if (_resources.isError()) {
+        return NULL;
+      }
+
+      resources = _resources.get();
+    } else if (parameter.key() == "window") {
+      Try<Duration> _window = Duration::parse(parameter.value());
+      if (_window.isError()) {
+        return NULL;
+      }
+
+      window = _window.get();
+    } else if (parameter.key() == "interval") {
+      Try<Duration> _interval = Duration::parse(parameter.value());
+      if (_interval.isError()) {
+        return NULL;
+      }
+
+      interval = _interval.get();
+    } else if (parameter.key() == "percentile") {
+      Try<double> _percentile = numify<double>(parameter.value());
+      if (_percentile.isError() ||
+          _percentile.get() <= 0.0 ||
+          _percentile.get() > 100.0) {
+        return NULL;
+      }
+
+      percentile = _percentile.get();
+    }
+  }
+
+  if (resources.isNone()) {
+    return NULL;
+  }
+
+  return new UsageResourceEstimator(
+      resources.get(), window, interval, percentile);
+}
+
+
+Module<ResourceEstimator> org_apache_mesos_UsageResourceEstimator(
+    MESOS_MODULE_API_VERSION,
+    MESOS_VERSION,
+    "Apache Mesos",
+    "modules@mesos.apache.org",
+    "Usage-driven Resource Estimator Module.",
+    compatible,
+    create);
@@ -56,6 +56,7 @@
 #include <stout/proc.hpp>
 #endif // __linux__
 #include <stout/numify.hpp>
+#include <stout/protobuf.hpp>
 #include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
@@ -126,6 +127,7 @@ Slave::Slave(const slave::Flags& _flags,
   : ProcessBase(process::ID::generate("slave")),
     state(RECOVERING),
     flags(_flags),
+    fullStateRequested(false),
     completedFrameworks(MAX_COMPLETED_FRAMEWORKS),
     detector(_detector),
     containerizer(_containerizer),
@@ -144,7 +146,8 @@ Slave::Slave(const slave::Flags& _flags,
     reauthenticate(false),
     executorDirectoryMaxAllowedAge(age(0)),
     resourceEstimator(_resourceEstimator),
-    qosController(_qosController) {}
+    qosController(_qosController),
+    stateVersion(0) {}
 
 
 Slave::~Slave()
@@ -426,6 +429,10 @@ void Slave::initialize()
       &SlaveReregisteredMessage::reconciliations,
       &SlaveReregisteredMessage::connection);
 
+  install<RequestSlaveStateMessage>(
+      &Slave::requestedSlaveState,
+      &RequestSlaveStateMessage::slave_id);
+
   install<RunTaskMessage>(
       &Slave::runTask,
       &RunTaskMessage::framework,
@@ -433,11 +440,22 @@ void Slave::initialize()
       &RunTaskMessage::pid,
       &RunTaskMessage::task);
 
+  install<RunTasksMessage>(
+      &Slave::runTasks,
+      &RunTasksMessage::framework,
+      &RunTasksMessage::pid,
+      &RunTasksMessage::tasks);
+
   install<KillTaskMessage>(
       &Slave::killTask,
       &KillTaskMessage::framework_id,
       &KillTaskMessage::task_id);
 
+  install<KillTasksMessage>(
+      &Slave::killTasks,
+      &KillTasksMessage::framework_id,
+      &KillTasksMessage::task_ids);
+
   install<ShutdownExecutorMessage>(
       &Slave::shutdownExecutor,
       &ShutdownExecutorMessage::framework_id,
@@ -473,20 +491,21 @@ void Slave::initialize()
   install<RegisterExecutorMessage>(
       &Slave::registerExecutor,
       &RegisterExecutorMessage::framework_id,
-      &RegisterExecutorMessage::executor_id);
+      &RegisterExecutorMessage::executor_id,
+      &RegisterExecutorMessage::registration_token);
 
-  install<ReregisterExecutorMessage>(
-      &Slave::reregisterExecutor,
-      &ReregisterExecutorMessage::framework_id,
-      &ReregisterExecutorMessage::executor_id,
-      &ReregisterExecutorMessage::tasks,
-      &ReregisterExecutorMessage::updates);
+  // NOTE: We install the whole message handler here so that the
+  // repeated 'tasks' and 'updates' fields are not copied into vectors
+  // on the paths that shut the executor down without using them.
+  install<ReregisterExecutorMessage>(&Slave::reregisterExecutor);
 
   install<StatusUpdateMessage>(
       &Slave::statusUpdate,
       &StatusUpdateMessage::update,
       &StatusUpdateMessage::pid);
 
+  install<StatusUpdatesMessage>(&Slave::statusUpdates);
+
   install<ExecutorToFrameworkMessage>(
       &Slave::executorMessage,
       &ExecutorToFrameworkMessage::slave_id,
@@ -494,6 +513,8 @@ void Slave::initialize()
       &ExecutorToFrameworkMessage::executor_id,
       &ExecutorToFrameworkMessage::data);
 
+  install<ExecutorToFrameworkMessages>(&Slave::executorMessages);
+
   install<ShutdownMessage>(
       &Slave::shutdown,
       &ShutdownMessage::message);
@@ -584,7 +605,7 @@ void Slave::initialize()
   }
 
   // Do recovery.
-  async(&state::recover, metaDir, flags.strict)
+  async(&state::recover, metaDir, flags.strict, flags.recovery_io_parallelism)
     .then(defer(self(), &Slave::recover, lambda::_1))
     .then(defer(self(), &Slave::_recover))
     .onAny(defer(self(), &Slave::__recover, lambda::_1));
@@ -879,6 +900,8 @@ void Slave::registered(
     const SlaveID& slaveId,
     const MasterSlaveConnection& connection)
 {
+  stateVersion++;
+
   if (master != from) {
     LOG(WARNING) << "Ignoring registration message from " << from
                  << " because it is not the expected master: "
@@ -909,6 +932,11 @@ void Slave::registered(
 
       state = RUNNING;
 
+      // Remember the master we registered with so that a future
+      // re-registration with the same master can be digest-only.
+      lastRegisteredMaster = master;
+      fullStateRequested = false;
+
       statusUpdateManager->resume(); // Resume status updates.
 
       info.mutable_id()->CopyFrom(slaveId); // Store the slave id.
@@ -974,6 +1002,8 @@ void Slave::reregistered(
     const vector<ReconcileTasksMessage>& reconciliations,
     const MasterSlaveConnection& connection)
 {
+  stateVersion++;
+
   if (master != from) {
     LOG(WARNING) << "Ignoring re-registration message from " << from
                  << " because it is not the expected master: "
@@ -998,6 +1028,12 @@ void Slave::reregistered(
     case DISCONNECTED:
       LOG(INFO) << "Re-registered with master " << master.get();
       state = RUNNING;
+
+      // Remember the master we re-registered with so that a future
+      // re-registration with the same master can be digest-only.
+      lastRegisteredMaster = master;
+      fullStateRequested = false;
+
       statusUpdateManager->resume(); // Resume status updates.
 
       // If we don't get a ping from the master, trigger a
@@ -1100,6 +1136,33 @@ void Slave::reregistered(
 }
 
 
+void Slave::requestedSlaveState(const UPID& from, const SlaveID& slaveId)
+{
+  if (master != from) {
+    LOG(WARNING) << "Ignoring slave state request from " << from
+                 << " because it is not the expected master: "
+                 << (master.isSome() ? stringify(master.get()) : "None");
+    return;
+  }
+
+  if (info.has_id() && !(info.id() == slaveId)) {
+    LOG(WARNING) << "Ignoring slave state request for slave " << slaveId
+                 << " because it does not match this slave's ID "
+                 << info.id();
+    return;
+  }
+
+  LOG(INFO) << "Master " << from << " could not verify our digest-only"
+            << " re-registration; re-sending the full state";
+
+  fullStateRequested = true;
+
+  if (state == DISCONNECTED) {
+    doReliableRegistration(flags.registration_backoff_factor * 2);
+  }
+}
+
+
 void Slave::doReliableRegistration(Duration maxBackoff)
 {
   if (master.isNone()) {
@@ -1145,98 +1208,166 @@ void Slave::doReliableRegistration(Duration maxBackoff)
 
     message.mutable_slave()->CopyFrom(info);
 
-    foreachvalue (Framework* framework, frameworks) {
-      // TODO(bmahler): We need to send the executors for these
-      // pending tasks, and we need to send exited events if they
-      // cannot be launched: MESOS-1715 MESOS-1720.
-
-      typedef hashmap<TaskID, TaskInfo> TaskMap;
-      foreachvalue (const TaskMap& tasks, framework->pending) {
-        foreachvalue (const TaskInfo& task, tasks) {
-          message.add_tasks()->CopyFrom(protobuf::createTask(
-              task, TASK_STAGING, framework->id()));
+    // When re-registering with the same master instance that we last
+    // registered with, first send only per-framework digests of our
+    // task and executor state; the master still holds the full state
+    // and will ask for a full re-registration if the digests do not
+    // match (see 'Slave::requestedSlaveState'). A failed over master
+    // has no slave state, so it always gets the full message.
+    bool digestsOnly =
+      lastRegisteredMaster.isSome() &&
+      lastRegisteredMaster == master &&
+      !fullStateRequested;
+
+    if (digestsOnly) {
+      message.set_digests_only(true);
+
+      foreachvalue (Framework* framework, frameworks) {
+        uint64_t digest = 0;
+        bool empty = true;
+
+        // NOTE: The digest must cover exactly the tasks and executors
+        // that the full message below would include, with the same
+        // task states, so that it agrees with the master's digest.
+        typedef hashmap<TaskID, TaskInfo> TaskMap;
+        foreachvalue (const TaskMap& tasks, framework->pending) {
+          foreachvalue (const TaskInfo& task, tasks) {
+            digest ^= protobuf::taskDigest(task.task_id(), TASK_STAGING);
+            empty = false;
+          }
         }
-      }
 
-      foreachvalue (Executor* executor, framework->executors) {
-        // Add launched, terminated, and queued tasks.
-        // Note that terminated executors will only have terminated
-        // unacknowledged tasks.
-        // Note that for each task the latest state and status update
-        // state (if any) is also included.
-        foreach (Task* task, executor->launchedTasks.values()) {
-          message.add_tasks()->CopyFrom(*task);
+        foreachvalue (Executor* executor, framework->executors) {
+          foreach (Task* task, executor->launchedTasks.values()) {
+            digest ^= protobuf::taskDigest(task->task_id(), task->state());
+            empty = false;
+          }
+
+          foreach (Task* task, executor->terminatedTasks.values()) {
+            digest ^= protobuf::taskDigest(task->task_id(), task->state());
+            empty = false;
+          }
+
+          foreach (const TaskInfo& task, executor->queuedTasks.values()) {
+            digest ^= protobuf::taskDigest(task.task_id(), TASK_STAGING);
+            empty = false;
+          }
+
+          // The master doesn't store command executors or terminated
+          // executors, so they are not part of its digests either.
+          if (!executor->isCommandExecutor() &&
+              executor->state != Executor::TERMINATED) {
+            digest ^= protobuf::executorDigest(executor->id);
+            empty = false;
+          }
         }
 
-        foreach (Task* task, executor->terminatedTasks.values()) {
-          message.add_tasks()->CopyFrom(*task);
+        if (!empty) {
+          ReregisterSlaveMessage::FrameworkDigest* frameworkDigest =
+            message.add_digests();
+          frameworkDigest->mutable_framework_id()->CopyFrom(framework->id());
+          frameworkDigest->set_digest(digest);
         }
+      }
 
-        foreach (const TaskInfo& task, executor->queuedTasks.values()) {
-          message.add_tasks()->CopyFrom(protobuf::createTask(
-              task, TASK_STAGING, framework->id()));
+      CHECK_SOME(master);
+      send(master.get(), message);
+    } else {
+      foreachvalue (Framework* framework, frameworks) {
+        // TODO(bmahler): We need to send the executors for these
+        // pending tasks, and we need to send exited events if they
+        // cannot be launched: MESOS-1715 MESOS-1720.
+
+        typedef hashmap<TaskID, TaskInfo> TaskMap;
+        foreachvalue (const TaskMap& tasks, framework->pending) {
+          foreachvalue (const TaskInfo& task, tasks) {
+            message.add_tasks()->CopyFrom(protobuf::createTask(
+                task, TASK_STAGING, framework->id()));
+          }
         }
 
-        // Do not re-register with Command Executors because the
-        // master doesn't store them; they are generated by the slave.
-        if (executor->isCommandExecutor()) {
-          // NOTE: We have to unset the executor id here for the task
-          // because the master uses the absence of task.executor_id()
-          // to detect command executors.
-          for (int i = 0; i < message.tasks_size(); ++i) {
-            message.mutable_tasks(i)->clear_executor_id();
+        foreachvalue (Executor* executor, framework->executors) {
+          // Add launched, terminated, and queued tasks.
+          // Note that terminated executors will only have terminated
+          // unacknowledged tasks.
+          // Note that for each task the latest state and status update
+          // state (if any) is also included.
+          foreach (Task* task, executor->launchedTasks.values()) {
+            message.add_tasks()->CopyFrom(*task);
           }
-        } else {
-          // Ignore terminated executors because they do not consume
-          // any resources.
-          if (executor->state != Executor::TERMINATED) {
-            ExecutorInfo* executorInfo = message.add_executor_infos();
-            executorInfo->MergeFrom(executor->info);
-
-            // Scheduler Driver will ensure the framework id is set in
-            // ExecutorInfo, effectively making it a required field.
-            CHECK(executorInfo->has_framework_id());
+
+          foreach (Task* task, executor->terminatedTasks.values()) {
+            message.add_tasks()->CopyFrom(*task);
+          }
+
+          foreach (const TaskInfo& task, executor->queuedTasks.values()) {
+            message.add_tasks()->CopyFrom(protobuf::createTask(
+                task, TASK_STAGING, framework->id()));
+          }
+
+          // Do not re-register with Command Executors because the
+          // master doesn't store them; they are generated by the slave.
+          if (executor->isCommandExecutor()) {
+            // NOTE: We have to unset the executor id here for the task
+            // because the master uses the absence of task.executor_id()
+            // to detect command executors.
+            for (int i = 0; i < message.tasks_size(); ++i) {
+              message.mutable_tasks(i)->clear_executor_id();
+            }
+          } else {
+            // Ignore terminated executors because they do not consume
+            // any resources.
+            if (executor->state != Executor::TERMINATED) {
+              ExecutorInfo* executorInfo = message.add_executor_infos();
+              executorInfo->MergeFrom(executor->info);
+
+              // Scheduler Driver will ensure the framework id is set in
+              // ExecutorInfo, effectively making it a required field.
+              CHECK(executorInfo->has_framework_id());
+            }
           }
         }
       }
-    }
 
-    // Add completed frameworks.
-    foreach (const Owned<Framework>& completedFramework, completedFrameworks) {
-      VLOG(1) << "Reregistering completed framework "
-                << completedFramework->id();
+      // Add completed frameworks.
+      foreach (const Owned<Framework>& completedFramework,
+               completedFrameworks) {
+        VLOG(1) << "Reregistering completed framework "
+                  << completedFramework->id();
 
-      Archive::Framework* completedFramework_ =
-        message.add_completed_frameworks();
+        Archive::Framework* completedFramework_ =
+          message.add_completed_frameworks();
 
-      completedFramework_->mutable_framework_info()->CopyFrom(
-          completedFramework->info);
+        completedFramework_->mutable_framework_info()->CopyFrom(
+            completedFramework->info);
 
-      if (completedFramework->pid.isSome()) {
-        completedFramework_->set_pid(completedFramework->pid.get());
-      }
+        if (completedFramework->pid.isSome()) {
+          completedFramework_->set_pid(completedFramework->pid.get());
+        }
 
-      foreach (const Owned<Executor>& executor,
-               completedFramework->completedExecutors) {
-        VLOG(2) << "Reregistering completed executor '" << executor->id
-                << "' with " << executor->terminatedTasks.size()
-                << " terminated tasks, " << executor->completedTasks.size()
-                << " completed tasks";
+        foreach (const Owned<Executor>& executor,
+                 completedFramework->completedExecutors) {
+          VLOG(2) << "Reregistering completed executor '" << executor->id
+                  << "' with " << executor->terminatedTasks.size()
+                  << " terminated tasks, " << executor->completedTasks.size()
+                  << " completed tasks";
 
-        foreach (const Task* task, executor->terminatedTasks.values()) {
-          VLOG(2) << "Reregistering terminated task " << task->task_id();
-          completedFramework_->add_tasks()->CopyFrom(*task);
-        }
+          foreach (const Task* task, executor->terminatedTasks.values()) {
+            VLOG(2) << "Reregistering terminated task " << task->task_id();
+            completedFramework_->add_tasks()->CopyFrom(*task);
+          }
 
-        foreach (const std::shared_ptr<Task>& task, executor->completedTasks) {
-          VLOG(2) << "Reregistering completed task " << task->task_id();
-          completedFramework_->add_tasks()->CopyFrom(*task);
+          foreach (const std::shared_ptr<Task>& task,
+                   executor->completedTasks) {
+            VLOG(2) << "Reregistering completed task " << task->task_id();
+            completedFramework_->add_tasks()->CopyFrom(*task);
+          }
         }
       }
-    }
 
-    CHECK_SOME(master);
-    send(master.get(), message);
+      CHECK_SOME(master);
+      send(master.get(), message);
+    }
   }
 
   // Bound the maximum backoff by 'REGISTER_RETRY_INTERVAL_MAX'.
@@ -1270,6 +1401,8 @@ void Slave::runTask(
     const UPID& pid,
     TaskInfo task)
 {
+  stateVersion++;
+
   if (master != from) {
     LOG(WARNING) << "Ignoring run task message from " << from
                  << " because it is not the expected master: "
@@ -1398,11 +1531,33 @@ void Slave::runTask(
 }
 
 
+void Slave::runTasks(
+    const UPID& from,
+    const FrameworkInfo& frameworkInfo,
+    const UPID& pid,
+    const vector<TaskInfo>& tasks)
+{
+  LOG(INFO) << "Got assigned " << tasks.size() << " tasks for framework "
+            << (frameworkInfo.has_id() ? stringify(frameworkInfo.id()) : "?");
+
+  // NOTE: We dispatch through 'runTask' for each task so that the
+  // per-task checks (e.g., a 'killTask' racing with the launch)
+  // behave exactly as if the master had sent individual
+  // RunTaskMessages. The batching saves the per-task message
+  // encoding, shipping and parsing, which dominates bulk launches.
+  foreach (const TaskInfo& task, tasks) {
+    runTask(from, frameworkInfo, frameworkInfo.id(), pid, task);
+  }
+}
+
+
 void Slave::_runTask(
     const Future<bool>& future,
     const FrameworkInfo& frameworkInfo,
     const TaskInfo& task)
 {
+  stateVersion++;
+
   const FrameworkID frameworkId = frameworkInfo.id();
 
   LOG(INFO) << "Launching task " << task.task_id()
@@ -1627,6 +1782,7 @@ void Slave::_runTask(
                 << "' for executor " << *executor;
 
       executor->queuedTasks[task.task_id()] = task;
+      executor->taskIds.add(std::hash<TaskID>()(task.task_id()));
       break;
     case Executor::RUNNING: {
       // Checkpoint the task before we do anything else.
@@ -1640,6 +1796,7 @@ void Slave::_runTask(
                 << "' for executor " << *executor;
 
       executor->queuedTasks[task.task_id()] = task;
+      executor->taskIds.add(std::hash<TaskID>()(task.task_id()));
 
       // Update the resource limits for the container. Note that the
       // resource limits include the currently queued tasks because we
@@ -1655,7 +1812,7 @@ void Slave::_runTask(
 
       containerizer->update(executor->containerId, resources)
         .onAny(defer(self(),
-                     &Self::runTasks,
+                     &Self::__runTasks,
                      lambda::_1,
                      frameworkId,
                      executorId,
@@ -1676,7 +1833,7 @@ void Slave::_runTask(
 }
 
 
-void Slave::runTasks(
+void Slave::__runTasks(
     const Future<Nothing>& future,
     const FrameworkID& frameworkId,
     const ExecutorID& executorId,
@@ -1784,6 +1941,7 @@ void Slave::runTasks(
     }
 
     executor->queuedTasks.erase(task.task_id());
+    executor->taskIds.remove(std::hash<TaskID>()(task.task_id()));
 
     // Add the task and send it to the executor.
     executor->addTask(task);
@@ -1804,11 +1962,31 @@ void Slave::runTasks(
 }
 
 
+void Slave::killTasks(
+    const UPID& from,
+    const FrameworkID& frameworkId,
+    const vector<TaskID>& taskIds)
+{
+  LOG(INFO) << "Asked to kill " << taskIds.size()
+            << " tasks of framework " << frameworkId;
+
+  // NOTE: We go through 'killTask' for each task so that the
+  // per-task checks behave exactly as if the master had sent
+  // individual KillTaskMessages. The batching saves the per-task
+  // message encoding, shipping and parsing.
+  foreach (const TaskID& taskId, taskIds) {
+    killTask(from, frameworkId, taskId);
+  }
+}
+
+
 void Slave::killTask(
     const UPID& from,
     const FrameworkID& frameworkId,
     const TaskID& taskId)
 {
+  stateVersion++;
+
   if (master != from) {
     LOG(WARNING) << "Ignoring kill task message from " << from
                  << " because it is not the expected master: "
@@ -2149,6 +2327,8 @@ void Slave::updateFramework(
     const FrameworkID& frameworkId,
     const UPID& pid)
 {
+  stateVersion++;
+
   CHECK(state == RECOVERING || state == DISCONNECTED ||
         state == RUNNING || state == TERMINATING)
     << state;
@@ -2401,6 +2581,8 @@ void Slave::subscribe(
     Framework* framework,
     Executor* executor)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(executor);
 
@@ -2510,7 +2692,7 @@ void Slave::subscribe(
 
       containerizer->update(executor->containerId, resources)
         .onAny(defer(self(),
-                     &Self::runTasks,
+                     &Self::__runTasks,
                      lambda::_1,
                      framework->id(),
                      executor->id,
@@ -2569,8 +2751,11 @@ void Slave::subscribe(
 void Slave::registerExecutor(
     const UPID& from,
     const FrameworkID& frameworkId,
-    const ExecutorID& executorId)
+    const ExecutorID& executorId,
+    const string& registrationToken)
 {
+  stateVersion++;
+
   LOG(INFO) << "Got registration for executor '" << executorId
             << "' of framework " << frameworkId << " from "
             << stringify(from);
@@ -2663,13 +2848,23 @@ void Slave::registerExecutor(
       }
 
       // Tell executor it's registered and give it any queued tasks.
-      ExecutorRegisteredMessage message;
-      message.mutable_executor_info()->MergeFrom(executor->info);
-      message.mutable_framework_id()->MergeFrom(framework->id());
-      message.mutable_framework_info()->MergeFrom(framework->info);
-      message.mutable_slave_id()->MergeFrom(info.id());
-      message.mutable_slave_info()->MergeFrom(info);
-      executor->send(message);
+      // If the executor presented the token handed to it at launch,
+      // it has already read the registration payload from its
+      // sandbox and a slim acknowledgement suffices.
+      if (!registrationToken.empty() &&
+          executor->registrationToken == registrationToken) {
+        ExecutorLocallyRegisteredMessage message;
+        message.mutable_slave_id()->MergeFrom(info.id());
+        executor->send(message);
+      } else {
+        ExecutorRegisteredMessage message;
+        message.mutable_executor_info()->MergeFrom(executor->info);
+        message.mutable_framework_id()->MergeFrom(framework->id());
+        message.mutable_framework_info()->MergeFrom(framework->info);
+        message.mutable_slave_id()->MergeFrom(info.id());
+        message.mutable_slave_info()->MergeFrom(info);
+        executor->send(message);
+      }
 
       // Update the resource limits for the container. Note that the
       // resource limits include the currently queued tasks because we
@@ -2685,7 +2880,7 @@ void Slave::registerExecutor(
 
       containerizer->update(executor->containerId, resources)
         .onAny(defer(self(),
-                     &Self::runTasks,
+                     &Self::__runTasks,
                      lambda::_1,
                      frameworkId,
                      executorId,
@@ -2703,11 +2898,13 @@ void Slave::registerExecutor(
 
 void Slave::reregisterExecutor(
     const UPID& from,
-    const FrameworkID& frameworkId,
-    const ExecutorID& executorId,
-    const vector<TaskInfo>& tasks,
-    const vector<StatusUpdate>& updates)
+    const ReregisterExecutorMessage& message)
 {
+  stateVersion++;
+
+  const FrameworkID& frameworkId = message.framework_id();
+  const ExecutorID& executorId = message.executor_id();
+
   CHECK(state == RECOVERING || state == DISCONNECTED ||
         state == RUNNING || state == TERMINATING)
     << state;
@@ -2761,10 +2958,10 @@ void Slave::reregisterExecutor(
       link(from);
 
       // Send re-registration message to the executor.
-      ExecutorReregisteredMessage message;
-      message.mutable_slave_id()->MergeFrom(info.id());
-      message.mutable_slave_info()->MergeFrom(info);
-      send(executor->pid.get(), message);
+      ExecutorReregisteredMessage reregistered;
+      reregistered.mutable_slave_id()->MergeFrom(info.id());
+      reregistered.mutable_slave_info()->MergeFrom(info);
+      send(executor->pid.get(), reregistered);
 
       // Handle all the pending updates.
       // The status update manager might have already checkpointed some
@@ -2772,7 +2969,7 @@ void Slave::reregisterExecutor(
       // after it checkpointed the update but before it could send the
       // ACK to the executor). This is ok because the status update
       // manager correctly handles duplicate updates.
-      foreach (const StatusUpdate& update, updates) {
+      foreach (const StatusUpdate& update, message.updates()) {
         // NOTE: This also updates the executor's resources!
         statusUpdate(update, executor->pid.get());
       }
@@ -2787,7 +2984,7 @@ void Slave::reregisterExecutor(
                      executor->containerId));
 
       hashmap<TaskID, TaskInfo> unackedTasks;
-      foreach (const TaskInfo& task, tasks) {
+      foreach (const TaskInfo& task, message.tasks()) {
         unackedTasks[task.task_id()] = task;
       }
 
@@ -2928,8 +3125,28 @@ void Slave::reregisterExecutorTimeout()
 // reliable delivery of status updates. Since executor driver caches
 // unacked updates it is important that whoever sent the update gets
 // acknowledgement for it.
+void Slave::statusUpdates(
+    const UPID& from,
+    const StatusUpdatesMessage& message)
+{
+  VLOG(1) << "Handling a batch of " << message.updates().size()
+          << " status updates from " << from;
+
+  Option<UPID> pid = None();
+  if (message.has_pid()) {
+    pid = UPID(message.pid());
+  }
+
+  foreach (const StatusUpdate& update, message.updates()) {
+    statusUpdate(update, pid);
+  }
+}
+
+
 void Slave::statusUpdate(StatusUpdate update, const Option<UPID>& pid)
 {
+  stateVersion++;
+
   LOG(INFO) << "Handling status update " << update
             << (pid.isSome() ? " from " + stringify(pid.get()) : "");
 
@@ -3362,6 +3579,74 @@ void Slave::executorMessage(
   metrics.valid_framework_messages++;
 }
 
+
+void Slave::executorMessages(
+    const UPID& from,
+    const ExecutorToFrameworkMessages& messages)
+{
+  CHECK(state == RECOVERING || state == DISCONNECTED ||
+        state == RUNNING || state == TERMINATING)
+    << state;
+
+  VLOG(1) << "Handling a batch of " << messages.data().size()
+          << " framework messages from " << from;
+
+  if (state != RUNNING) {
+    LOG(WARNING) << "Dropping a batch of " << messages.data().size()
+                 << " framework messages from executor '"
+                 << messages.executor_id() << "' to framework "
+                 << messages.framework_id()
+                 << " because the slave is in " << state << " state";
+    metrics.invalid_framework_messages += messages.data().size();
+    return;
+  }
+
+  Framework* framework = getFramework(messages.framework_id());
+  if (framework == NULL) {
+    LOG(WARNING) << "Cannot send a batch of " << messages.data().size()
+                 << " framework messages from executor '"
+                 << messages.executor_id() << "' to framework "
+                 << messages.framework_id()
+                 << " because framework does not exist";
+    metrics.invalid_framework_messages += messages.data().size();
+    return;
+  }
+
+  CHECK(framework->state == Framework::RUNNING ||
+        framework->state == Framework::TERMINATING)
+    << framework->state;
+
+  if (framework->state == Framework::TERMINATING) {
+    LOG(WARNING) << "Ignoring a batch of " << messages.data().size()
+                 << " framework messages from executor '"
+                 << messages.executor_id() << "' to framework "
+                 << messages.framework_id()
+                 << " because framework is terminating";
+    metrics.invalid_framework_messages += messages.data().size();
+    return;
+  }
+
+  // Forward the batch wholesale; the scheduler driver (or the
+  // master, for HTTP frameworks) unpacks it into individual
+  // messages.
+  CHECK_SOME(master);
+
+  if (framework->pid.isSome()) {
+    LOG(INFO) << "Sending a batch of " << messages.data().size()
+              << " messages for framework " << messages.framework_id()
+              << " to " << framework->pid.get();
+    send(framework->pid.get(), messages);
+  } else {
+    LOG(INFO) << "Sending a batch of " << messages.data().size()
+              << " messages for framework " << messages.framework_id()
+              << " through the master " << master.get();
+    send(master.get(), messages);
+  }
+
+  metrics.valid_framework_messages += messages.data().size();
+}
+
+
 void Slave::ping(const UPID& from, bool connected)
 {
   VLOG(1) << "Received ping from " << from;
@@ -3616,6 +3901,8 @@ void Slave::executorLaunched(
     const ContainerID& containerId,
     const Future<bool>& future)
 {
+  stateVersion++;
+
   // Set up callback for executor termination. Note that we do this
   // regardless of whether or not we have successfully launched the
   // executor because even if we failed to launch the executor the
@@ -3723,6 +4010,8 @@ void Slave::executorTerminated(
     const ExecutorID& executorId,
     const Future<containerizer::Termination>& termination)
 {
+  stateVersion++;
+
   int status;
   // A termination failure indicates the containerizer could not destroy a
   // container.
@@ -3846,6 +4135,8 @@ void Slave::executorTerminated(
 
 void Slave::removeExecutor(Framework* framework, Executor* executor)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(executor);
 
@@ -3935,6 +4226,8 @@ void Slave::removeExecutor(Framework* framework, Executor* executor)
 
 void Slave::removeFramework(Framework* framework)
 {
+  stateVersion++;
+
   CHECK_NOTNULL(framework);
 
   LOG(INFO)<< "Cleaning up framework " << framework->id();
@@ -4369,6 +4662,16 @@ Future<Nothing> Slave::_recover()
 
           ReconnectExecutorMessage message;
           message.mutable_slave_id()->MergeFrom(info.id());
+
+          // Ask the executors to spread their reregistrations over
+          // the first half of the reregister timeout so that an
+          // agent hosting many executors is not flooded by
+          // simultaneous responses; the second half is left as
+          // headroom for the responses to arrive before cleanup
+          // (see 'reregisterExecutorTimeout').
+          message.set_max_reregister_delay_seconds(
+              (EXECUTOR_REREGISTER_TIMEOUT / 2).secs());
+
           send(executor->pid.get(), message);
         } else if (executor->pid.isNone()) {
           LOG(INFO) << "Waiting for executor " << *executor
@@ -4512,6 +4815,8 @@ void Slave::__recover(const Future<Nothing>& future)
 
 void Slave::recoverFramework(const FrameworkState& state)
 {
+  stateVersion++;
+
   LOG(INFO) << "Recovering framework " << state.id;
 
   if (state.executors.empty()) {
@@ -4800,7 +5105,7 @@ Future<ResourceUsage> Slave::usage()
   // constructors. Revisit once we remove the copy constructor for
   // Owned (or C++14 lambda generalized capture is supported).
   Owned<ResourceUsage> usage(new ResourceUsage());
-  list<Future<ResourceStatistics>> futures;
+  vector<ContainerID> containerIds;
 
   foreachvalue (const Framework* framework, frameworks) {
     foreachvalue (const Executor* executor, framework->executors) {
@@ -4809,7 +5114,7 @@ Future<ResourceUsage> Slave::usage()
       entry->mutable_allocated()->CopyFrom(executor->resources);
       entry->mutable_container_id()->CopyFrom(executor->containerId);
 
-      futures.push_back(containerizer->usage(executor->containerId));
+      containerIds.push_back(executor->containerId);
     }
   }
 
@@ -4824,26 +5129,25 @@ Future<ResourceUsage> Slave::usage()
 
   usage->mutable_total()->CopyFrom(totalResources.get());
 
-  return await(futures).then(
-      [usage](const list<Future<ResourceStatistics>>& futures) {
-        // NOTE: We add ResourceUsage::Executor to 'usage' the same
-        // order as we push future to 'futures'. So the variables
-        // 'future' and 'executor' below should be in sync.
-        CHECK_EQ(futures.size(), (size_t) usage->executors_size());
+  // NOTE: We gather the statistics from the containerizer in a
+  // single batch so that the cost is independent of the number of
+  // containers on the agent; statistics that could not be gathered
+  // are simply absent from the result.
+  return containerizer->usages(containerIds).then(
+      [usage](const hashmap<ContainerID, ResourceStatistics>& statistics) {
+        for (int i = 0; i < usage->executors_size(); i++) {
+          ResourceUsage::Executor* executor = usage->mutable_executors(i);
 
-        size_t i = 0;
-        foreach (const Future<ResourceStatistics>& future, futures) {
-          ResourceUsage::Executor* executor = usage->mutable_executors(i++);
+          Option<ResourceStatistics> statistic =
+            statistics.get(executor->container_id());
 
-          if (future.isReady()) {
-            executor->mutable_statistics()->CopyFrom(future.get());
+          if (statistic.isSome()) {
+            executor->mutable_statistics()->CopyFrom(statistic.get());
           } else {
             LOG(WARNING) << "Failed to get resource statistics for executor '"
                          << executor->executor_info().executor_id() << "'"
                          << " of framework "
-                         << executor->executor_info().framework_id() << ": "
-                         << (future.isFailed() ? future.failure()
-                                               : "discarded");
+                         << executor->executor_info().framework_id();
           }
         }
 
@@ -5228,6 +5532,41 @@ Executor* Framework::launchExecutor(
   resources += taskInfo.resources();
   executorInfo_.mutable_resources()->CopyFrom(resources);
 
+  // Write the registration payload into the sandbox and hand the
+  // executor a token via its environment. An executor that reads the
+  // payload presents the token when registering, which lets the
+  // slave acknowledge with a slim message instead of re-sending the
+  // executor, framework and agent infos. Executors that don't know
+  // about the token (or fail to read the payload) fall back to the
+  // full registration exchange.
+  ExecutorRegisteredMessage registration;
+  registration.mutable_executor_info()->MergeFrom(executor->info);
+  registration.mutable_framework_id()->MergeFrom(id());
+  registration.mutable_framework_info()->MergeFrom(info);
+  registration.mutable_slave_id()->MergeFrom(slave->info.id());
+  registration.mutable_slave_info()->MergeFrom(slave->info);
+
+  const string registrationPath = path::join(directory, ".registration");
+
+  Try<Nothing> write = ::protobuf::write(registrationPath, registration);
+  if (write.isError()) {
+    LOG(WARNING) << "Failed to write registration payload to '"
+                 << registrationPath << "': " << write.error()
+                 << "; the executor will use the full registration exchange";
+  } else {
+    executor->registrationToken = UUID::random().toString();
+
+    Environment::Variable* variable =
+      executorInfo_.mutable_command()->mutable_environment()->add_variables();
+    variable->set_name("MESOS_EXECUTOR_REGISTRATION");
+    variable->set_value(registrationPath);
+
+    variable =
+      executorInfo_.mutable_command()->mutable_environment()->add_variables();
+    variable->set_name("MESOS_EXECUTOR_REGISTRATION_TOKEN");
+    variable->set_value(executor->registrationToken.get());
+  }
+
   // Launch the container.
   Future<bool> launch;
   if (!executor->isCommandExecutor()) {
@@ -5263,6 +5602,10 @@ Executor* Framework::launchExecutor(
         info.checkpoint());
   }
 
+  // Time the launch so that spawn latency regressions are visible
+  // in the metrics.
+  slave->metrics.executor_launch.time(launch);
+
   launch.onAny(defer(slave,
                      &Slave::executorLaunched,
                      id(),
@@ -5306,7 +5649,15 @@ Executor* Framework::getExecutor(const ExecutorID& executorId)
 
 Executor* Framework::getExecutor(const TaskID& taskId)
 {
+  const size_t hash = std::hash<TaskID>()(taskId);
+
   foreachvalue (Executor* executor, executors) {
+    // One probe rules out executors that definitely never saw this
+    // task, so only (rare) filter hits walk the task maps.
+    if (!executor->taskIds.possiblyContains(hash)) {
+      continue;
+    }
+
     if (executor->queuedTasks.contains(taskId) ||
         executor->launchedTasks.contains(taskId) ||
         executor->terminatedTasks.contains(taskId)) {
@@ -5467,10 +5818,16 @@ Executor::Executor(
     http(None()),
     pid(None()),
     resources(_info.resources()),
+    taskIds(512),
     completedTasks(MAX_COMPLETED_TASKS_PER_EXECUTOR)
 {
   CHECK_NOTNULL(slave);
 
+  if (checkpoint) {
+    metaRunPaths = paths::RunPaths(
+        slave->metaDir, slave->info.id(), frameworkId, id, containerId);
+  }
+
   Result<string> executorPath =
     os::realpath(path::join(slave->flags.launcher_dir, "mesos-executor"));
 
@@ -5509,6 +5866,7 @@ Task* Executor::addTask(const TaskInfo& task)
   Task* t = new Task(protobuf::createTask(task, TASK_STAGING, frameworkId));
 
   launchedTasks[task.task_id()] = t;
+  taskIds.add(std::hash<TaskID>()(task.task_id()));
 
   resources += task.resources();
 
@@ -5528,11 +5886,13 @@ void Executor::terminateTask(
     task = new Task(
         protobuf::createTask(queuedTasks[taskId], status.state(), frameworkId));
     queuedTasks.erase(taskId);
+    taskIds.remove(std::hash<TaskID>()(taskId));
   } else if (launchedTasks.contains(taskId)) {
     // Update the resources if it's been launched.
     task = launchedTasks[taskId];
     resources -= task->resources();
     launchedTasks.erase(taskId);
+    taskIds.remove(std::hash<TaskID>()(taskId));
   }
 
   switch (status.state()) {
@@ -5556,6 +5916,7 @@ void Executor::terminateTask(
 
   // TODO(dhamon): Update source/reason metrics.
   terminatedTasks[taskId] = CHECK_NOTNULL(task);
+  taskIds.add(std::hash<TaskID>()(taskId));
 }
 
 
@@ -5569,6 +5930,7 @@ void Executor::completeTask(const TaskID& taskId)
   Task* task = terminatedTasks[taskId];
   completedTasks.push_back(std::shared_ptr<Task>(task));
   terminatedTasks.erase(taskId);
+  taskIds.remove(std::hash<TaskID>()(taskId));
 }
 
 
@@ -5597,16 +5959,15 @@ void Executor::checkpointTask(const TaskInfo& task)
   CHECK(checkpoint);
 
   const Task t = protobuf::createTask(task, TASK_STAGING, frameworkId);
-  const string path = paths::getTaskInfoPath(
-      slave->metaDir,
-      slave->info.id(),
-      frameworkId,
-      id,
-      containerId,
-      t.task_id());
+
+  // Append the task to the per-run task infos log. Note that older
+  // slaves checkpointed one 'task.info' file per task; those files
+  // are still read during recovery.
+  CHECK_SOME(metaRunPaths);
+  const string path = metaRunPaths.get().getTaskInfosPath();
 
   VLOG(1) << "Checkpointing TaskInfo to '" << path << "'";
-  CHECK_SOME(state::checkpoint(path, t));
+  CHECK_SOME(state::append(path, t));
 }
 
 
@@ -5619,6 +5980,7 @@ void Executor::recoverTask(const TaskState& state)
   }
 
   launchedTasks[state.id] = new Task(state.info.get());
+  taskIds.add(std::hash<TaskID>()(state.id));
 
   // NOTE: Since some tasks might have been terminated when the
   // slave was down, the executor resources we capture here is an
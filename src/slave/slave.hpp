@@ -55,6 +55,7 @@
 #include <stout/recordio.hpp>
 #include <stout/uuid.hpp>
 
+#include "common/existence_filter.hpp"
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
 
@@ -117,6 +118,10 @@ public:
       const std::vector<ReconcileTasksMessage>& reconciliations,
       const MasterSlaveConnection& connection);
 
+  // Invoked when the master could not verify a digest-only
+  // re-registration; re-sends a full 'ReregisterSlaveMessage'.
+  void requestedSlaveState(const process::UPID& from, const SlaveID& slaveId);
+
   void doReliableRegistration(Duration maxBackoff);
 
   // Made 'virtual' for Slave mocking.
@@ -127,6 +132,16 @@ public:
       const process::UPID& pid,
       TaskInfo task);
 
+  // Handles a batch of tasks launched in a single RunTasksMessage,
+  // equivalent to receiving one RunTaskMessage per task. Note that
+  // there is no framework ID parameter since it was only kept on
+  // RunTaskMessage for legacy reasons (see MESOS-2559).
+  virtual void runTasks(
+      const process::UPID& from,
+      const FrameworkInfo& frameworkInfo,
+      const process::UPID& pid,
+      const std::vector<TaskInfo>& tasks);
+
   // Made 'virtual' for Slave mocking.
   virtual void _runTask(
       const process::Future<bool>& future,
@@ -141,6 +156,13 @@ public:
       const FrameworkID& frameworkId,
       const TaskID& taskId);
 
+  // Handles a bulk kill sent by the master, equivalent to receiving
+  // one KillTaskMessage per task.
+  virtual void killTasks(
+      const process::UPID& from,
+      const FrameworkID& frameworkId,
+      const std::vector<TaskID>& taskIds);
+
   void shutdownExecutor(
       const process::UPID& from,
       const FrameworkID& frameworkId,
@@ -171,18 +193,20 @@ public:
   void registerExecutor(
       const process::UPID& from,
       const FrameworkID& frameworkId,
-      const ExecutorID& executorId);
+      const ExecutorID& executorId,
+      const std::string& registrationToken);
 
   // Called when an executor re-registers with a recovering slave.
-  // 'tasks' : Unacknowledged tasks (i.e., tasks that the executor
-  //           driver never received an ACK for.)
-  // 'updates' : Unacknowledged updates.
+  // The message carries the unacknowledged tasks (i.e., tasks that
+  // the executor driver never received an ACK for) and unacknowledged
+  // updates.
+  //
+  // NOTE: This takes the protobuf message itself so that the repeated
+  // task and update fields are never copied out on the paths that
+  // shut the executor down without looking at them.
   void reregisterExecutor(
       const process::UPID& from,
-      const FrameworkID& frameworkId,
-      const ExecutorID& executorId,
-      const std::vector<TaskInfo>& tasks,
-      const std::vector<StatusUpdate>& updates);
+      const ReregisterExecutorMessage& message);
 
   void _reregisterExecutor(
       const process::Future<Nothing>& future,
@@ -196,6 +220,12 @@ public:
       const ExecutorID& executorId,
       const std::string& data);
 
+  // Handles a batch of coalesced framework messages from the
+  // executor driver, validating it once and forwarding it wholesale.
+  void executorMessages(
+      const process::UPID& from,
+      const ExecutorToFrameworkMessages& messages);
+
   void ping(const process::UPID& from, bool connected);
 
   // Handles the status update.
@@ -208,6 +238,13 @@ public:
   // to ensure source field is set.
   void statusUpdate(StatusUpdate update, const Option<process::UPID>& pid);
 
+  // Handles a batch of status updates sent by an executor driver
+  // with update batching enabled, equivalent to one `statusUpdate`
+  // invocation per entry.
+  void statusUpdates(
+      const process::UPID& from,
+      const StatusUpdatesMessage& message);
+
   // Continue handling the status update after optionally updating the
   // container's resources.
   void _statusUpdate(
@@ -287,10 +324,10 @@ public:
   // This is called when the resource limits of the container have
   // been updated for the given tasks. If the update is successful, we
   // flush the given tasks to the executor by sending RunTaskMessages.
-  // TODO(jieyu): Consider renaming it to '__runTasks' once the slave
-  // starts to support launching multiple tasks in one call (i.e.,
-  // multi-tasks version of 'runTask').
-  void runTasks(
+  // NOTE: This is named '__runTasks' to distinguish it from the
+  // 'runTasks' message handler above (the multi-tasks version of
+  // 'runTask').
+  void __runTasks(
       const process::Future<Nothing>& future,
       const FrameworkID& frameworkId,
       const ExecutorID& executorId,
@@ -434,6 +471,20 @@ private:
 
   private:
     Slave* slave;
+
+    // Cached rendering of the '/state' response along with the value
+    // of 'Slave::stateVersion' at the time it was rendered. Served
+    // until the agent state changes, so that frequent monitoring
+    // polls do not each walk all frameworks, executors and tasks on
+    // the agent actor.
+    struct StateCache
+    {
+      size_t version;
+      std::string body;
+    };
+
+    // NOTE: 'mutable' since the route handlers are const.
+    mutable Option<StateCache> stateCache;
   };
 
   friend struct Framework;
@@ -489,6 +540,17 @@ private:
 
   Option<process::UPID> master;
 
+  // The master that the slave last successfully (re-)registered
+  // with. When re-registering with the same master instance we first
+  // attempt a cheap digest-only re-registration (the master already
+  // holds our full task and executor state), falling back to a full
+  // 'ReregisterSlaveMessage' if the master requests it.
+  Option<process::UPID> lastRegisteredMaster;
+
+  // Whether the master requested a full 'ReregisterSlaveMessage'
+  // after it could not verify our digest-only re-registration.
+  bool fullStateRequested;
+
   hashmap<FrameworkID, Framework*> frameworks;
 
   boost::circular_buffer<process::Owned<Framework>> completedFrameworks;
@@ -564,6 +626,12 @@ private:
   // The most recent estimate of the total amount of oversubscribed
   // (allocated and oversubscribable) resources.
   Option<Resources> oversubscribedResources;
+
+  // Version of the agent state exposed through the read-only HTTP
+  // endpoints. Bumped whenever frameworks, executors or tasks
+  // change, so that cached endpoint responses can be invalidated.
+  // See 'Slave::Http::state'.
+  size_t stateVersion;
 };
 
 
@@ -684,6 +752,11 @@ struct Executor
 
   const bool checkpoint;
 
+  // Preassembled checkpoint path prefixes for this run, set iff
+  // 'checkpoint' is true. This avoids rebuilding the same prefixes
+  // for every checkpointed task (see 'checkpointTask').
+  Option<paths::RunPaths> metaRunPaths;
+
   // An Executor can either be connected via HTTP or by libprocess
   // message passing. The following are the possible states:
   //
@@ -699,6 +772,12 @@ struct Executor
   Option<HttpConnection> http;
   Option<process::UPID> pid;
 
+  // Token handed to the executor (via its environment) at launch.
+  // An executor presenting it at registration has already read the
+  // registration payload written into its sandbox, allowing the
+  // slave to acknowledge with a slim message. See 'launchExecutor'.
+  Option<std::string> registrationToken;
+
   // Currently consumed resources.
   Resources resources;
 
@@ -713,6 +792,13 @@ struct Executor
   // Terminated but pending updates.
   LinkedHashMap<TaskID, Task*> terminatedTasks;
 
+  // Fronts the three task maps above: one filter probe rules this
+  // executor out when looking up a task by ID, so scans such as
+  // 'Framework::getExecutor(TaskID)' (hit for every status update
+  // and kill) do not walk every executor's maps. Updated wherever
+  // tasks enter or leave the maps above.
+  ExistenceFilter taskIds;
+
   // Terminated and updates acked.
   // NOTE: We use a shared pointer for Task because clang doesn't like
   // Boost's implementation of circular_buffer with Task (Boost
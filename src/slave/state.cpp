@@ -16,7 +16,10 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include <process/pid.hpp>
 
@@ -51,9 +54,11 @@ namespace state {
 using std::list;
 using std::string;
 using std::max;
+using std::min;
+using std::vector;
 
 
-Result<State> recover(const string& rootDir, bool strict)
+Result<State> recover(const string& rootDir, bool strict, size_t ioParallelism)
 {
   LOG(INFO) << "Recovering state from '" << rootDir << "'";
 
@@ -114,7 +119,8 @@ Result<State> recover(const string& rootDir, bool strict)
   SlaveID slaveId;
   slaveId.set_value(Path(directory.get()).basename());
 
-  Try<SlaveState> slave = SlaveState::recover(rootDir, slaveId, strict);
+  Try<SlaveState> slave =
+    SlaveState::recover(rootDir, slaveId, strict, ioParallelism);
   if (slave.isError()) {
     return Error(slave.error());
   }
@@ -128,7 +134,8 @@ Result<State> recover(const string& rootDir, bool strict)
 Try<SlaveState> SlaveState::recover(
     const string& rootDir,
     const SlaveID& slaveId,
-    bool strict)
+    bool strict,
+    size_t ioParallelism)
 {
   SlaveState state;
   state.id = slaveId;
@@ -174,12 +181,16 @@ Try<SlaveState> SlaveState::recover(
   }
 
   // Recover each of the frameworks.
+  // NOTE: The frameworks themselves are recovered sequentially; the
+  // executors within each framework (typically the bulk of the
+  // checkpointed state) are recovered on a bounded pool of worker
+  // threads, see 'FrameworkState::recover'.
   foreach (const string& path, frameworks.get()) {
     FrameworkID frameworkId;
     frameworkId.set_value(Path(path).basename());
 
-    Try<FrameworkState> framework =
-      FrameworkState::recover(rootDir, slaveId, frameworkId, strict);
+    Try<FrameworkState> framework = FrameworkState::recover(
+        rootDir, slaveId, frameworkId, strict, ioParallelism);
 
     if (framework.isError()) {
       return Error("Failed to recover framework " + frameworkId.value() +
@@ -198,7 +209,8 @@ Try<FrameworkState> FrameworkState::recover(
     const string& rootDir,
     const SlaveID& slaveId,
     const FrameworkID& frameworkId,
-    bool strict)
+    bool strict,
+    size_t ioParallelism)
 {
   FrameworkState state;
   state.id = frameworkId;
@@ -282,13 +294,48 @@ Try<FrameworkState> FrameworkState::recover(
         ": " + executors.error());
   }
 
-  // Recover the executors.
-  foreach (const string& path, executors.get()) {
+  // Recover the executors. Each executor's checkpoints are
+  // independent, so reading and parsing them is spread across up to
+  // 'ioParallelism' worker threads. Each worker writes its results
+  // into distinct slots of 'recovered' so no mutable state is shared;
+  // the results are merged sequentially below so that error handling
+  // is deterministic.
+  const vector<string> paths(executors.get().begin(), executors.get().end());
+
+  size_t workers = min(max<size_t>(ioParallelism, 1u), paths.size());
+
+  vector<Try<ExecutorState> > recovered(paths.size(), ExecutorState());
+
+  auto recoverExecutors = [&](size_t offset, size_t stride) {
+    for (size_t i = offset; i < paths.size(); i += stride) {
+      ExecutorID executorId;
+      executorId.set_value(Path(paths[i]).basename());
+
+      recovered[i] = ExecutorState::recover(
+          rootDir, slaveId, frameworkId, executorId, strict);
+    }
+  };
+
+  if (workers <= 1) {
+    recoverExecutors(0, 1);
+  } else {
+    vector<std::thread> threads;
+    threads.reserve(workers);
+
+    for (size_t worker = 0; worker < workers; worker++) {
+      threads.push_back(std::thread(recoverExecutors, worker, workers));
+    }
+
+    foreach (std::thread& thread, threads) {
+      thread.join();
+    }
+  }
+
+  for (size_t i = 0; i < paths.size(); i++) {
     ExecutorID executorId;
-    executorId.set_value(Path(path).basename());
+    executorId.set_value(Path(paths[i]).basename());
 
-    Try<ExecutorState> executor =
-      ExecutorState::recover(rootDir, slaveId, frameworkId, executorId, strict);
+    const Try<ExecutorState>& executor = recovered[i];
 
     if (executor.isError()) {
       return Error("Failed to recover executor '" + executorId.value() +
@@ -422,15 +469,90 @@ Try<RunState> RunState::recover(
   state.id = containerId;
   string message;
 
+  // Assemble the run's path prefixes once instead of rebuilding them
+  // for every file and task below.
+  const paths::RunPaths runPaths(
+      rootDir, slaveId, frameworkId, executorId, containerId);
+
   // See if the sentinel file exists. This is done first so it is
   // known even if partial state is returned, e.g., if the libprocess
   // pid file is not recovered. It indicates the slave removed the
   // executor.
-  string path = paths::getExecutorSentinelPath(
-      rootDir, slaveId, frameworkId, executorId, containerId);
+  string path = runPaths.getExecutorSentinelPath();
 
   state.completed = os::exists(path);
 
+  // Read the task infos from the per-run log. Older slaves
+  // checkpointed one 'task.info' file per task instead, which is
+  // handled in TaskState::recover.
+  hashmap<TaskID, Task> infos;
+
+  path = runPaths.getTaskInfosPath();
+
+  if (os::exists(path)) {
+    Try<int> fd = os::open(path, O_RDWR | O_CLOEXEC);
+
+    if (fd.isError()) {
+      message = "Failed to open task infos file '" + path +
+                "': " + fd.error();
+
+      if (strict) {
+        return Error(message);
+      } else {
+        LOG(WARNING) << message;
+        state.errors++;
+      }
+    } else {
+      Result<Task> task = None();
+      while (true) {
+        // Ignore errors due to partial protobuf read and enable
+        // undoing failed reads by reverting to the previous seek
+        // position.
+        task = ::protobuf::read<Task>(fd.get(), true, true);
+        if (!task.isSome()) {
+          break;
+        }
+
+        infos[task.get().task_id()] = task.get();
+      }
+
+      off_t offset = lseek(fd.get(), 0, SEEK_CUR);
+      if (offset < 0) {
+        os::close(fd.get());
+        return ErrnoError("Failed to lseek task infos file '" + path + "'");
+      }
+
+      // Always truncate the file to contain only valid task infos.
+      // NOTE: This is safe even though we ignore partial protobuf
+      // read errors above, because the 'fd' is properly set to the
+      // end of the last valid task info by 'protobuf::read()'.
+      Try<Nothing> truncated = os::ftruncate(fd.get(), offset);
+
+      if (truncated.isError()) {
+        os::close(fd.get());
+        return Error(
+            "Failed to truncate task infos file '" + path +
+            "': " + truncated.error());
+      }
+
+      os::close(fd.get());
+
+      // After reading a non-corrupted task infos file, 'task' should
+      // be 'none'.
+      if (task.isError()) {
+        message = "Failed to read task infos file '" + path +
+                  "': " + task.error();
+
+        if (strict) {
+          return Error(message);
+        } else {
+          LOG(WARNING) << message;
+          state.errors++;
+        }
+      }
+    }
+  }
+
   // Find the tasks.
   Try<list<string> > tasks = paths::getTaskPaths(
       rootDir,
@@ -445,13 +567,26 @@ Try<RunState> RunState::recover(
         ": " + tasks.error());
   }
 
-  // Recover tasks.
+  // Recover all the tasks for this run: those with a task directory
+  // (which may contain status updates) as well as those only present
+  // in the task infos log (e.g., the slave died before any status
+  // update was checkpointed for the task).
+  hashset<TaskID> taskIds;
+
   foreach (const string& path, tasks.get()) {
     TaskID taskId;
     taskId.set_value(Path(path).basename());
+    taskIds.insert(taskId);
+  }
 
+  foreachkey (const TaskID& taskId, infos) {
+    taskIds.insert(taskId);
+  }
+
+  // Recover tasks.
+  foreach (const TaskID& taskId, taskIds) {
     Try<TaskState> task = TaskState::recover(
-        rootDir, slaveId, frameworkId, executorId, containerId, taskId, strict);
+        runPaths, taskId, infos.get(taskId), strict);
 
     if (task.isError()) {
       return Error(
@@ -463,8 +598,7 @@ Try<RunState> RunState::recover(
   }
 
   // Read the forked pid.
-  path = paths::getForkedPidPath(
-      rootDir, slaveId, frameworkId, executorId, containerId);
+  path = runPaths.getForkedPidPath();
   if (!os::exists(path)) {
     // This could happen if the slave died before the isolator
     // checkpointed the forked pid.
@@ -503,8 +637,7 @@ Try<RunState> RunState::recover(
   state.forkedPid = forkedPid.get();
 
   // Read the libprocess pid.
-  path = paths::getLibprocessPidPath(
-      rootDir, slaveId, frameworkId, executorId, containerId);
+  path = runPaths.getLibprocessPidPath();
 
   if (os::exists(path)) {
     pid = os::read(path);
@@ -536,8 +669,7 @@ Try<RunState> RunState::recover(
     return state;
   }
 
-  path = paths::getExecutorHttpMarkerPath(
-      rootDir, slaveId, frameworkId, executorId, containerId);
+  path = runPaths.getExecutorHttpMarkerPath();
 
   if (!os::exists(path)) {
     // This could happen if the slave died before the executor
@@ -553,54 +685,57 @@ Try<RunState> RunState::recover(
 
 
 Try<TaskState> TaskState::recover(
-    const string& rootDir,
-    const SlaveID& slaveId,
-    const FrameworkID& frameworkId,
-    const ExecutorID& executorId,
-    const ContainerID& containerId,
+    const paths::RunPaths& runPaths,
     const TaskID& taskId,
+    const Option<Task>& info,
     bool strict)
 {
   TaskState state;
   state.id = taskId;
   string message;
+  string path;
+
+  if (info.isSome()) {
+    // The task was checkpointed in the per-run 'tasks.info' log.
+    state.info = info.get();
+  } else {
+    // Read the legacy per-task info file checkpointed by older
+    // slaves.
+    path = runPaths.getTaskInfoPath(taskId);
+    if (!os::exists(path)) {
+      // This could happen if the slave died after creating the task
+      // directory but before it checkpointed the task info.
+      LOG(WARNING) << "Failed to find task info file '" << path << "'";
+      return state;
+    }
 
-  // Read the task info.
-  string path = paths::getTaskInfoPath(
-      rootDir, slaveId, frameworkId, executorId, containerId, taskId);
-  if (!os::exists(path)) {
-    // This could happen if the slave died after creating the task
-    // directory but before it checkpointed the task info.
-    LOG(WARNING) << "Failed to find task info file '" << path << "'";
-    return state;
-  }
+    const Result<Task>& task = ::protobuf::read<Task>(path);
 
-  const Result<Task>& task = ::protobuf::read<Task>(path);
+    if (task.isError()) {
+      message = "Failed to read task info from '" + path +
+                "': " + task.error();
 
-  if (task.isError()) {
-    message = "Failed to read task info from '" + path + "': " + task.error();
+      if (strict) {
+        return Error(message);
+      } else {
+        LOG(WARNING) << message;
+        state.errors++;
+        return state;
+      }
+    }
 
-    if (strict) {
-      return Error(message);
-    } else {
-      LOG(WARNING) << message;
-      state.errors++;
+    if (task.isNone()) {
+      // This could happen if the slave died after opening the file
+      // for writing but before it checkpointed anything.
+      LOG(WARNING) << "Found empty task info file '" << path << "'";
       return state;
     }
-  }
 
-  if (task.isNone()) {
-    // This could happen if the slave died after opening the file for
-    // writing but before it checkpointed anything.
-    LOG(WARNING) << "Found empty task info file '" << path << "'";
-    return state;
+    state.info = task.get();
   }
 
-  state.info = task.get();
-
   // Read the status updates.
-  path = paths::getTaskUpdatesPath(
-      rootDir, slaveId, frameworkId, executorId, containerId, taskId);
+  path = runPaths.getTaskUpdatesPath(taskId);
   if (!os::exists(path)) {
     // This could happen if the slave died before it checkpointed any
     // status updates for this task.
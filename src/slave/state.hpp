@@ -37,14 +37,19 @@
 #include <stout/utils.hpp>
 #include <stout/uuid.hpp>
 
+#include <stout/os/close.hpp>
+#include <stout/os/exists.hpp>
 #include <stout/os/mkdir.hpp>
 #include <stout/os/mktemp.hpp>
+#include <stout/os/open.hpp>
 #include <stout/os/rename.hpp>
 #include <stout/os/rm.hpp>
 #include <stout/os/write.hpp>
 
 #include "messages/messages.hpp"
 
+#include "slave/paths.hpp"
+
 namespace mesos {
 namespace internal {
 namespace slave {
@@ -71,7 +76,13 @@ struct TaskState;
 // includes the 'errors' encountered recursively. In other words,
 // 'State.errors' is the sum total of all recovery errors. If the
 // machine has rebooted since the last slave run, None is returned.
-Result<State> recover(const std::string& rootDir, bool strict);
+// Executor checkpoints are independent of each other, so up to
+// 'ioParallelism' worker threads are used to read and parse them
+// concurrently; the results are merged deterministically.
+Result<State> recover(
+    const std::string& rootDir,
+    bool strict,
+    size_t ioParallelism = 1);
 
 
 namespace internal {
@@ -127,12 +138,20 @@ inline Try<Nothing> checkpoint(
 template <typename T>
 Try<Nothing> checkpoint(const std::string& path, const T& t)
 {
-  // Create the base directory.
+  // Create the base directory. Note that we check for its existence
+  // first: almost all checkpoints land in a directory created by an
+  // earlier checkpoint, and a single stat is much cheaper than
+  // having os::mkdir probe (and attempt to create) every ancestor
+  // component on every write. Tasks checkpoint several items in a
+  // row, so this shows up in the task launch path.
   std::string base = Path(path).dirname();
 
-  Try<Nothing> mkdir = os::mkdir(base);
-  if (mkdir.isError()) {
-    return Error("Failed to create directory '" + base + "': " + mkdir.error());
+  if (!os::exists(base)) {
+    Try<Nothing> mkdir = os::mkdir(base);
+    if (mkdir.isError()) {
+      return Error(
+          "Failed to create directory '" + base + "': " + mkdir.error());
+    }
   }
 
   // NOTE: We create the temporary file at 'base/XXXXXX' to make sure
@@ -170,6 +189,51 @@ Try<Nothing> checkpoint(const std::string& path, const T& t)
 }
 
 
+// Appends a protobuf message to the checkpoint log at the given
+// path, creating the log (and its parent directory) if necessary.
+// Records are framed with their size (see stout's protobuf::write)
+// so a log can be replayed with successive protobuf::read calls.
+//
+// NOTE: Unlike 'checkpoint' this does not provide all-or-nothing
+// semantics: a crash can leave a partial record at the end of the
+// log, which readers must tolerate (e.g., by passing 'ignorePartial'
+// to protobuf::read and truncating the tail), just like the status
+// updates and resources checkpoint files.
+inline Try<Nothing> append(
+    const std::string& path,
+    const google::protobuf::Message& message)
+{
+  std::string base = Path(path).dirname();
+
+  if (!os::exists(base)) {
+    Try<Nothing> mkdir = os::mkdir(base);
+    if (mkdir.isError()) {
+      return Error(
+          "Failed to create directory '" + base + "': " + mkdir.error());
+    }
+  }
+
+  Try<int> fd = os::open(
+      path,
+      O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "': " + fd.error());
+  }
+
+  Try<Nothing> write = ::protobuf::write(fd.get(), message);
+
+  os::close(fd.get());
+
+  if (write.isError()) {
+    return Error("Failed to write '" + path + "': " + write.error());
+  }
+
+  return Nothing();
+}
+
+
 // NOTE: The *State structs (e.g., TaskState, RunState, etc) are
 // defined in reverse dependency order because many of them have
 // Option<*State> dependencies which means we need them declared in
@@ -180,13 +244,13 @@ struct TaskState
 {
   TaskState () : errors(0) {}
 
+  // Recovers the task's state. If 'info' is provided (i.e., the task
+  // was found in the per-run 'tasks.info' log) it is used directly,
+  // otherwise the legacy per-task 'task.info' file is read.
   static Try<TaskState> recover(
-      const std::string& rootDir,
-      const SlaveID& slaveId,
-      const FrameworkID& frameworkId,
-      const ExecutorID& executorId,
-      const ContainerID& containerId,
+      const paths::RunPaths& runPaths,
       const TaskID& taskId,
+      const Option<Task>& info,
       bool strict);
 
   TaskID id;
@@ -252,7 +316,8 @@ struct FrameworkState
       const std::string& rootDir,
       const SlaveID& slaveId,
       const FrameworkID& frameworkId,
-      bool strict);
+      bool strict,
+      size_t ioParallelism = 1);
 
   FrameworkID id;
   Option<FrameworkInfo> info;
@@ -286,7 +351,8 @@ struct SlaveState
   static Try<SlaveState> recover(
       const std::string& rootDir,
       const SlaveID& slaveId,
-      bool strict);
+      bool strict,
+      size_t ioParallelism = 1);
 
   SlaveID id;
   Option<SlaveInfo> info;
@@ -14,7 +14,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <unistd.h>
+
+#include <utility>
+
 #include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/timer.hpp>
 
@@ -48,7 +54,9 @@ using std::string;
 using process::wait; // Necessary on some OS's to disambiguate.
 using process::Failure;
 using process::Future;
+using process::Owned;
 using process::PID;
+using process::Promise;
 using process::Timeout;
 using process::UPID;
 
@@ -109,6 +117,25 @@ private:
       const Option<ExecutorID>& executorId,
       const Option<ContainerID>& containerId);
 
+  // Forwards the front of the stream's queue to the master if no
+  // update is currently in flight. For checkpointed streams this is
+  // called once the update's record has been committed to disk.
+  Future<Nothing> __update(
+      const TaskID& taskId,
+      const FrameworkID& frameworkId);
+
+  // Registers a checkpointed record written by 'stream' for the next
+  // group sync and returns a future that completes once the record
+  // is durable on disk. The sync is dispatched behind the events
+  // currently in the queue (or performed eagerly once enough records
+  // accumulate), so that a burst of updates across streams is
+  // committed with a single fsync per file rather than a synchronous
+  // fsync per record.
+  Future<Nothing> sync(StatusUpdateStream* stream);
+
+  // Performs the group sync and completes the corresponding promises.
+  void flush();
+
   // Status update timeout.
   void timeout(const Duration& duration);
 
@@ -144,11 +171,18 @@ private:
   function<void(StatusUpdate)> forward_;
 
   hashmap<FrameworkID, hashmap<TaskID, StatusUpdateStream*> > streams;
+
+  // Streams with checkpointed records written but not yet committed
+  // to disk, along with the promise completed once they are.
+  hashmap<StatusUpdateStream*, Owned<Promise<Nothing> > > unsynced;
+
+  // Number of records written since the last group sync.
+  uint32_t pendingRecords;
 };
 
 
 StatusUpdateManagerProcess::StatusUpdateManagerProcess(const Flags& _flags)
-  : flags(_flags), paused(false) {}
+  : flags(_flags), paused(false), pendingRecords(0) {}
 
 
 StatusUpdateManagerProcess::~StatusUpdateManagerProcess()
@@ -348,10 +382,36 @@ Future<Nothing> StatusUpdateManagerProcess::_update(
     return Nothing();
   }
 
-  // Forward the status update to the master if this is the first in the stream.
-  // Subsequent status updates will get sent in 'acknowledgement()'.
-  if (!paused && stream->pending.size() == 1) {
-    CHECK_NONE(stream->timeout);
+  if (!stream->checkpoint) {
+    // Nothing to commit to disk; forward right away.
+    return __update(taskId, frameworkId);
+  }
+
+  // The update's record is committed to disk with the next group
+  // sync; only forward the update (and let the slave acknowledge the
+  // executor) once it is durable.
+  return sync(stream)
+    .then(defer(self(), &Self::__update, taskId, frameworkId));
+}
+
+
+Future<Nothing> StatusUpdateManagerProcess::__update(
+    const TaskID& taskId,
+    const FrameworkID& frameworkId)
+{
+  StatusUpdateStream* stream = getStatusUpdateStream(taskId, frameworkId);
+
+  // The stream could have been cleaned up (e.g., the framework was
+  // removed) while the update was awaiting the group sync.
+  if (stream == NULL) {
+    return Nothing();
+  }
+
+  // Forward the status update to the master if there is no update in
+  // flight for this stream ('timeout' is only set while an update is
+  // awaiting its ACK; subsequent status updates get sent in
+  // 'acknowledgement()').
+  if (!paused && stream->timeout.isNone() && !stream->pending.empty()) {
     const Result<StatusUpdate>& next = stream->next();
     if (next.isError()) {
       return Failure(next.error());
@@ -365,6 +425,58 @@ Future<Nothing> StatusUpdateManagerProcess::_update(
 }
 
 
+Future<Nothing> StatusUpdateManagerProcess::sync(StatusUpdateStream* stream)
+{
+  // If this is the first record since the last group sync, schedule
+  // a flush once we have drained the events currently in the queue,
+  // so that updates arriving in a burst share a single sync.
+  if (unsynced.empty()) {
+    dispatch(self(), &StatusUpdateManagerProcess::flush);
+  }
+
+  if (!unsynced.contains(stream)) {
+    unsynced[stream] = Owned<Promise<Nothing> >(new Promise<Nothing>());
+  }
+
+  Future<Nothing> future = unsynced[stream]->future();
+
+  if (++pendingRecords >= STATUS_UPDATE_SYNC_BATCH_SIZE) {
+    flush();
+  }
+
+  return future;
+}
+
+
+void StatusUpdateManagerProcess::flush()
+{
+  // The flush might have already been performed, either because the
+  // batch size threshold was reached before the dispatch was served
+  // or because multiple flushes were dispatched.
+  if (unsynced.empty()) {
+    return;
+  }
+
+  pendingRecords = 0;
+
+  // Swap out the pending syncs first, since completing a promise may
+  // run continuations that register new records for the next batch.
+  hashmap<StatusUpdateStream*, Owned<Promise<Nothing> > > syncing;
+  std::swap(syncing, unsynced);
+
+  foreachpair (StatusUpdateStream* stream,
+               const Owned<Promise<Nothing> >& promise,
+               syncing) {
+    Try<Nothing> sync = stream->sync();
+    if (sync.isError()) {
+      promise->fail(sync.error());
+    } else {
+      promise->set(Nothing());
+    }
+  }
+}
+
+
 Timeout StatusUpdateManagerProcess::forward(
     const StatusUpdate& update,
     const Duration& duration)
@@ -447,13 +559,27 @@ Future<bool> StatusUpdateManagerProcess::acknowledgement(
                    << " status update " << update.get()
                    << " but updates are still pending";
     }
+
+    // NOTE: This commits any unsynced records (including the ACK
+    // record written above) before closing the updates file.
     cleanupStatusUpdateStream(taskId, frameworkId);
-  } else if (!paused && next.isSome()) {
+
+    return false;
+  }
+
+  if (!paused && next.isSome()) {
     // Forward the next queued status update.
     stream->timeout = forward(next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
   }
 
-  return !terminated;
+  if (stream->checkpoint) {
+    // Only report the acknowledgement as handled once its record is
+    // durable on disk.
+    return sync(stream)
+      .then([]() { return true; });
+  }
+
+  return true;
 }
 
 
@@ -542,7 +668,20 @@ void StatusUpdateManagerProcess::cleanupStatusUpdateStream(
     streams.erase(frameworkId);
   }
 
+  // If the stream has records awaiting a group sync, commit them now
+  // (the destructor syncs before closing the file) and complete the
+  // corresponding promise.
+  Option<Owned<Promise<Nothing> > > promise = None();
+  if (unsynced.contains(stream)) {
+    promise = unsynced[stream];
+    unsynced.erase(stream);
+  }
+
   delete stream;
+
+  if (promise.isSome()) {
+    promise.get()->set(Nothing());
+  }
 }
 
 
@@ -651,6 +790,7 @@ StatusUpdateStream::StatusUpdateStream(
       frameworkId(_frameworkId),
       slaveId(_slaveId),
       flags(_flags),
+      dirty(false),
       error(None())
 {
   if (checkpoint) {
@@ -672,10 +812,12 @@ StatusUpdateStream::StatusUpdateStream(
       return;
     }
 
-    // Open the updates file.
+    // Open the updates file. Note that we don't open with O_SYNC;
+    // written records are committed to disk by the status update
+    // manager's group sync (see 'sync()').
     Try<int> result = os::open(
         path.get(),
-        O_CREAT | O_WRONLY | O_APPEND | O_SYNC | O_CLOEXEC,
+        O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC,
         S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 
     if (result.isError()) {
@@ -693,6 +835,14 @@ StatusUpdateStream::StatusUpdateStream(
 StatusUpdateStream::~StatusUpdateStream()
 {
   if (fd.isSome()) {
+    // Make sure any records not yet group-synced reach the disk
+    // before the descriptor is closed.
+    if (dirty && ::fsync(fd.get()) == -1) {
+      CHECK_SOME(path);
+      LOG(ERROR) << "Failed to sync file '" << path.get()
+                 << "': " << os::strerror(errno);
+    }
+
     Try<Nothing> close = os::close(fd.get());
     if (close.isError()) {
       CHECK_SOME(path);
@@ -840,6 +990,10 @@ Try<Nothing> StatusUpdateStream::handle(
               " to '" + path.get() + "': " + write.error();
       return Error(error.get());
     }
+
+    // The record is only in the page cache at this point; it reaches
+    // the disk with the next group sync (see 'sync()').
+    dirty = true;
   }
 
   // Now actually handle the update.
@@ -849,6 +1003,25 @@ Try<Nothing> StatusUpdateStream::handle(
 }
 
 
+Try<Nothing> StatusUpdateStream::sync()
+{
+  if (dirty) {
+    CHECK_SOME(fd);
+
+    if (::fsync(fd.get()) == -1) {
+      CHECK_SOME(path);
+      error = "Failed to sync status updates file '" + path.get() +
+              "': " + os::strerror(errno);
+      return Error(error.get());
+    }
+
+    dirty = false;
+  }
+
+  return Nothing();
+}
+
+
 void StatusUpdateStream::_handle(
     const StatusUpdate& update,
     const StatusUpdateRecord::Type& type)
@@ -166,6 +166,12 @@ struct StatusUpdateStream
       const std::vector<StatusUpdate>& updates,
       const hashset<UUID>& acks);
 
+  // Commits any records written since the last sync to disk. This is
+  // called by the status update manager when performing a group sync
+  // across streams, so that a burst of updates costs one fsync per
+  // file rather than one per record.
+  Try<Nothing> sync();
+
   // TODO(vinod): Explore semantics to make these private.
   const bool checkpoint;
   bool terminated;
@@ -199,6 +205,8 @@ private:
   Option<std::string> path; // File path of the update stream.
   Option<int> fd; // File descriptor to the update stream.
 
+  bool dirty; // Whether there are written records pending a sync.
+
   Option<std::string> error; // Potential non-retryable error.
 };
 
@@ -26,6 +26,7 @@
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/mutex.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 
 #include <process/metrics/metrics.hpp>
@@ -36,6 +37,7 @@
 #include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/nothing.hpp>
 #include <stout/option.hpp>
 #include <stout/svn.hpp>
@@ -96,8 +98,11 @@ private:
       const Log::Position& beginning,
       const Log::Position& position);
 
-  // Helper for applying log entries.
+  // Helpers for applying log entries.
   Future<Nothing> apply(const list<Log::Entry>& entries);
+  Try<Nothing> apply(
+      const Operation& operation,
+      const Log::Position& position);
 
   // Helper for performing truncation.
   void truncate();
@@ -109,12 +114,34 @@ private:
   // Continuations.
   Future<Option<state::Entry> > _get(const string& name);
 
-  Future<bool> _set(const state::Entry& entry, const UUID& uuid);
-  Future<bool> __set(const state::Entry& entry, const UUID& uuid);
-  Future<bool> ___set(
-      const state::Entry& entry,
-      size_t diff,
-      Option<Log::Position> position);
+  // Represents a queued 'set' that has yet to be appended to the
+  // log. The 'diffs' field holds the number of Operation::DIFFs that
+  // will make up the resulting snapshot (see Snapshot::diffs).
+  struct Write
+  {
+    Write(const state::Entry& _entry, const UUID& _uuid)
+      : entry(_entry),
+        uuid(_uuid),
+        diffs(0),
+        promise(new Promise<bool>()) {}
+
+    state::Entry entry;
+    UUID uuid;
+    size_t diffs;
+    Owned<Promise<bool>> promise;
+  };
+
+  Future<Nothing> _set();
+  Future<Nothing> __set();
+  Future<Nothing> ___set(
+      const list<Write>& batch,
+      const Option<Log::Position>& position);
+
+  // Helpers that complete writes with a failure when the append
+  // pipeline fails, so that their futures don't remain pending
+  // forever (see 'set').
+  void failWrites(const string& message);
+  void failBatch(const list<Write>& batch, const string& message);
 
   Future<bool> _expunge(const state::Entry& entry);
   Future<bool> __expunge(const state::Entry& entry);
@@ -196,6 +223,12 @@ private:
   // a default/empty constructor.
   hashmap<string, Snapshot> snapshots;
 
+  // Queued writes that have yet to be appended to the log. All
+  // writes queued while an append is in flight get coalesced into a
+  // single append in '__set' which amortizes the cost of a consensus
+  // round across concurrent mutations.
+  list<Write> writes;
+
   struct Metrics
   {
     Metrics()
@@ -316,47 +349,76 @@ Future<Nothing> LogStorageProcess::apply(const list<Log::Entry>& entries)
         return Failure("Failed to deserialize Operation");
       }
 
-      switch (operation.type()) {
-        case Operation::SNAPSHOT: {
-          CHECK(operation.has_snapshot());
+      Try<Nothing> applied = apply(operation, entry.position);
 
-          // Add or update (override) the snapshot.
-          Snapshot snapshot(entry.position, operation.snapshot().entry());
-          snapshots.put(snapshot.entry.name(), snapshot);
-          break;
-        }
+      if (applied.isError()) {
+        return Failure(applied.error());
+      }
+
+      index = entry.position;
+    }
+  }
 
-        case Operation::DIFF: {
-          CHECK(operation.has_diff());
+  return Nothing();
+}
 
-          Option<Snapshot> snapshot =
-            snapshots.get(operation.diff().entry().name());
 
-          CHECK_SOME(snapshot);
+Try<Nothing> LogStorageProcess::apply(
+    const Operation& operation,
+    const Log::Position& position)
+{
+  switch (operation.type()) {
+    case Operation::SNAPSHOT: {
+      CHECK(operation.has_snapshot());
+
+      // Add or update (override) the snapshot.
+      Snapshot snapshot(position, operation.snapshot().entry());
+      snapshots.put(snapshot.entry.name(), snapshot);
+      break;
+    }
 
-          Try<Snapshot> patched = snapshot.get().patch(operation.diff());
+    case Operation::DIFF: {
+      CHECK(operation.has_diff());
 
-          if (patched.isError()) {
-            return Failure("Failed to apply the diff: " + patched.error());
-          }
+      Option<Snapshot> snapshot =
+        snapshots.get(operation.diff().entry().name());
 
-          // Replace the snapshot with the patched snapshot.
-          snapshots.put(patched.get().entry.name(), patched.get());
-          break;
-        }
+      CHECK_SOME(snapshot);
 
-        case Operation::EXPUNGE: {
-          CHECK(operation.has_expunge());
-          snapshots.erase(operation.expunge().name());
-          break;
-        }
+      Try<Snapshot> patched = snapshot.get().patch(operation.diff());
 
-        default:
-          return Failure("Unknown operation: " + stringify(operation.type()));
+      if (patched.isError()) {
+        return Error("Failed to apply the diff: " + patched.error());
       }
 
-      index = entry.position;
+      // Replace the snapshot with the patched snapshot.
+      snapshots.put(patched.get().entry.name(), patched.get());
+      break;
     }
+
+    case Operation::EXPUNGE: {
+      CHECK(operation.has_expunge());
+      snapshots.erase(operation.expunge().name());
+      break;
+    }
+
+    case Operation::BATCH: {
+      CHECK(operation.has_batch());
+
+      // Note that batches are not nested (see state.proto), so this
+      // recursion is at most one level deep.
+      foreach (const Operation& op, operation.batch().operations()) {
+        Try<Nothing> applied = apply(op, position);
+
+        if (applied.isError()) {
+          return applied;
+        }
+      }
+      break;
+    }
+
+    default:
+      return Error("Unknown operation: " + stringify(operation.type()));
   }
 
   return Nothing();
@@ -454,122 +516,226 @@ Future<bool> LogStorageProcess::set(
     const state::Entry& entry,
     const UUID& uuid)
 {
-  return mutex.lock()
-    .then(defer(self(), &Self::_set, entry, uuid))
+  // Queue the write and grab the mutex. If other writes get queued
+  // while we're waiting on the mutex (i.e., an append is already in
+  // flight) they all get flushed by a single '__set' and the
+  // remaining '_set' continuations find an empty queue.
+  writes.push_back(Write(entry, uuid));
+
+  Future<bool> future = writes.back().promise->future();
+
+  // NOTE: If the chain fails (e.g., the writer failed to start) the
+  // '_set' continuations never run, so any writes still queued must
+  // be explicitly failed here lest their futures remain pending
+  // until the caller times out with a misleading error.
+  mutex.lock()
+    .then(defer(self(), &Self::_set))
+    .onFailed(defer(self(), &Self::failWrites, lambda::_1))
     .onAny(lambda::bind(&Mutex::unlock, mutex));
+
+  return future;
 }
 
 
-Future<bool> LogStorageProcess::_set(
-    const state::Entry& entry,
-    const UUID& uuid)
+Future<Nothing> LogStorageProcess::_set()
 {
+  if (writes.empty()) {
+    return Nothing(); // Already flushed as part of an earlier batch.
+  }
+
   return start()
-    .then(defer(self(), &Self::__set, entry, uuid));
+    .then(defer(self(), &Self::__set));
 }
 
 
-Future<bool> LogStorageProcess::__set(
-    const state::Entry& entry,
-    const UUID& uuid)
+Future<Nothing> LogStorageProcess::__set()
 {
-  Option<Snapshot> snapshot = snapshots.get(entry.name());
+  // Grab all queued writes, including any that got queued while we
+  // were starting: they get coalesced into a single log append.
+  list<Write> batch;
+  batch.swap(writes);
 
-  // Check the version first (if we've already got a snapshot).
-  if (snapshot.isSome() &&
-      UUID::fromBytes(snapshot.get().entry.uuid()) != uuid) {
-    return false;
+  if (batch.empty()) {
+    return Nothing();
   }
 
-  // Check if we should try to compute a diff.
-  if (snapshot.isSome() && snapshot.get().diffs < diffsBetweenSnapshots) {
-    // Keep metrics for the time to calculate diffs.
-    metrics.diff.start();
+  // Names written earlier in this batch: a subsequent write to the
+  // same name necessarily has a stale UUID (the client couldn't have
+  // seen the result of the earlier write yet) so it must fail, just
+  // as it would have had the writes been appended sequentially.
+  hashset<string> names;
+
+  // The writes that pass the version check and their operations.
+  list<Write> appended;
+  Operation::Batch operations;
+
+  foreach (Write& write, batch) {
+    Option<Snapshot> snapshot = snapshots.get(write.entry.name());
+
+    // Check the version first (if we've already got a snapshot).
+    if (names.contains(write.entry.name()) ||
+        (snapshot.isSome() &&
+         UUID::fromBytes(snapshot.get().entry.uuid()) != write.uuid)) {
+      write.promise->set(false);
+      continue;
+    }
 
-    // Construct the diff of the last snapshot.
-    Try<svn::Diff> diff = svn::diff(
-        snapshot.get().entry.value(),
-        entry.value());
+    Operation* operation = operations.add_operations();
 
-    Duration elapsed = metrics.diff.stop();
+    // Check if we should try to compute a diff.
+    bool diffed = false;
 
-    if (diff.isError()) {
-      // TODO(benh): Fallback and try and write a whole snapshot?
-      return Failure("Failed to construct diff: " + diff.error());
-    }
+    if (snapshot.isSome() && snapshot.get().diffs < diffsBetweenSnapshots) {
+      // Keep metrics for the time to calculate diffs.
+      metrics.diff.start();
 
-    VLOG(1) << "Created an SVN diff in " << elapsed
-            << " of size " << Bytes(diff.get().data.size()) << " which is "
-            << (diff.get().data.size() / (double) entry.value().size()) * 100.0
-            << "% the original size (" << Bytes(entry.value().size()) << ")";
+      // Construct the diff of the last snapshot.
+      Try<svn::Diff> diff = svn::diff(
+          snapshot.get().entry.value(),
+          write.entry.value());
 
-    // Only write the diff if it provides a reduction in size.
-    if (diff.get().data.size() < entry.value().size()) {
-      // Append a diff operation.
-      Operation operation;
-      operation.set_type(Operation::DIFF);
-      operation.mutable_diff()->mutable_entry()->CopyFrom(entry);
-      operation.mutable_diff()->mutable_entry()->set_value(diff.get().data);
+      Duration elapsed = metrics.diff.stop();
+
+      if (diff.isError()) {
+        // TODO(benh): Fallback and try and write a whole snapshot?
+        operations.mutable_operations()->RemoveLast();
+        write.promise->fail("Failed to construct diff: " + diff.error());
+        continue;
+      }
 
-      string value;
-      if (!operation.SerializeToString(&value)) {
-        return Failure("Failed to serialize DIFF Operation");
+      VLOG(1) << "Created an SVN diff in " << elapsed
+              << " of size " << Bytes(diff.get().data.size()) << " which is "
+              << (diff.get().data.size() /
+                  (double) write.entry.value().size()) * 100.0
+              << "% the original size ("
+              << Bytes(write.entry.value().size()) << ")";
+
+      // Only write the diff if it provides a reduction in size.
+      if (diff.get().data.size() < write.entry.value().size()) {
+        operation->set_type(Operation::DIFF);
+        operation->mutable_diff()->mutable_entry()->CopyFrom(write.entry);
+        operation->mutable_diff()->mutable_entry()->set_value(
+            diff.get().data);
+
+        write.diffs = snapshot.get().diffs + 1;
+        diffed = true;
       }
+    }
 
-      return writer.append(value)
-        .then(defer(self(),
-                    &Self::___set,
-                    entry,
-                    snapshot.get().diffs + 1,
-                    lambda::_1));
+    if (!diffed) {
+      // Write the full snapshot.
+      operation->set_type(Operation::SNAPSHOT);
+      operation->mutable_snapshot()->mutable_entry()->CopyFrom(write.entry);
     }
+
+    names.insert(write.entry.name());
+    appended.push_back(write);
   }
 
-  // Write the full snapshot.
-  Operation operation;
-  operation.set_type(Operation::SNAPSHOT);
-  operation.mutable_snapshot()->mutable_entry()->CopyFrom(entry);
+  if (appended.empty()) {
+    return Nothing();
+  }
 
+  // In the common case of a single write we append its operation
+  // directly so that the log format is unchanged in the absence of
+  // write concurrency; otherwise we wrap the operations in a BATCH.
   string value;
-  if (!operation.SerializeToString(&value)) {
-    return Failure("Failed to serialize SNAPSHOT Operation");
+  bool serialized = false;
+
+  if (appended.size() == 1) {
+    serialized = operations.operations(0).SerializeToString(&value);
+  } else {
+    VLOG(1) << "Coalescing " << appended.size() << " writes"
+            << " into a single log append";
+
+    Operation operation;
+    operation.set_type(Operation::BATCH);
+    operation.mutable_batch()->CopyFrom(operations);
+
+    serialized = operation.SerializeToString(&value);
   }
 
-  return writer.append(value)
-    .then(defer(self(), &Self::___set, entry, 0, lambda::_1));
+  if (!serialized) {
+    foreach (const Write& write, appended) {
+      write.promise->fail("Failed to serialize Operation");
+    }
+    return Nothing();
+  }
+
+  Future<Option<Log::Position> > appending = writer.append(value);
+
+  // The batch was swapped out of 'writes' above, so a failed append
+  // leaves these writes out of reach of 'failWrites'; fail them here
+  // (the '.then' below only runs if the append completes).
+  appending
+    .onFailed(defer(self(), &Self::failBatch, appended, lambda::_1));
+
+  return appending
+    .then(defer(self(), &Self::___set, appended, lambda::_1));
 }
 
 
-Future<bool> LogStorageProcess::___set(
-    const state::Entry& entry,
-    size_t diffs,
-    Option<Log::Position> position)
+void LogStorageProcess::failWrites(const string& message)
+{
+  list<Write> failed;
+  failed.swap(writes);
+
+  foreach (const Write& write, failed) {
+    write.promise->fail(message);
+  }
+}
+
+
+void LogStorageProcess::failBatch(
+    const list<Write>& batch,
+    const string& message)
+{
+  foreach (const Write& write, batch) {
+    write.promise->fail(message);
+  }
+}
+
+
+Future<Nothing> LogStorageProcess::___set(
+    const list<Write>& batch,
+    const Option<Log::Position>& position)
 {
   if (position.isNone()) {
     starting = None(); // Reset 'starting' so we try again.
-    return false;
+
+    foreach (const Write& write, batch) {
+      write.promise->set(false);
+    }
+
+    return Nothing();
   }
 
   // Update index so we don't bother reading anything before this
   // position again (if we don't have to).
   index = max(index, position);
 
-  // Determine the position that represents the snapshot: if we just
-  // wrote a diff then we want to use the existing position of the
-  // snapshot, otherwise we just overwrote the snapshot so we should
-  // use the returned position (i.e., do nothing).
-  if (diffs > 0) {
-    CHECK(snapshots.contains(entry.name()));
-    position = snapshots.get(entry.name()).get().position;
-  }
+  foreach (const Write& write, batch) {
+    // Determine the position that represents the snapshot: if we
+    // just wrote a diff then we want to use the existing position of
+    // the snapshot, otherwise we just overwrote the snapshot so we
+    // should use the returned position.
+    Log::Position snapshotPosition = position.get();
+
+    if (write.diffs > 0) {
+      CHECK(snapshots.contains(write.entry.name()));
+      snapshotPosition = snapshots.get(write.entry.name()).get().position;
+    }
+
+    Snapshot snapshot(snapshotPosition, write.entry, write.diffs);
+    snapshots.put(snapshot.entry.name(), snapshot);
 
-  Snapshot snapshot(position.get(), entry, diffs);
-  snapshots.put(snapshot.entry.name(), snapshot);
+    write.promise->set(true);
+  }
 
   // And truncate the log if necessary.
   truncate();
 
-  return true;
+  return Nothing();
 }
 
 
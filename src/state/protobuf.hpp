@@ -45,7 +45,7 @@ template <typename T>
 class Variable
 {
 public:
-  T get() const
+  const T& get() const
   {
     return t;
   }
@@ -72,7 +72,9 @@ private:
 class State : public state::State
 {
 public:
-  explicit State(Storage* storage) : state::State(storage) {}
+  // See state::State for the semantics of 'caching'.
+  explicit State(Storage* storage, bool caching = false)
+    : state::State(storage, caching) {}
   virtual ~State() {}
 
   // Returns a variable from the state, creating a new one if one
@@ -122,7 +124,15 @@ process::Future<Variable<T> > State::_fetch(
     return process::Failure(t.error());
   }
 
-  return Variable<T>(variable, t.get());
+  // NOTE: We swap the parsed protobuf into the variable rather than
+  // copying it, and we do not retain the serialized value alongside
+  // it: for a large variable (e.g., the master's registry with tens
+  // of thousands of slaves) each extra copy is another registry's
+  // worth of transient memory during master failover, and 'store'
+  // re-serializes from the protobuf anyway.
+  Variable<T> result(variable.mutate(std::string()), T());
+  result.t.Swap(&t.get());
+  return result;
 }
 
 
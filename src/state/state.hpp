@@ -23,6 +23,8 @@
 #include <process/deferred.hpp> // TODO(benh): This is required by Clang.
 #include <process/future.hpp>
 
+#include <stout/gzip.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
@@ -67,7 +69,10 @@ class State;
 class Variable
 {
 public:
-  std::string value() const
+  // NOTE: Returned by const reference since values can be large
+  // (e.g., the master's registry) and callers mostly just parse
+  // them; copy explicitly if you need to outlive the variable.
+  const std::string& value() const
   {
     return entry.value();
   }
@@ -93,7 +98,18 @@ private:
 class State
 {
 public:
-  explicit State(Storage* _storage) : storage(_storage) {}
+  // When 'caching' is true the state keeps a write-through cache of
+  // the variables it has fetched and stored, and serves subsequent
+  // fetches from the cache without a storage round trip. This is
+  // intended for single-writer users (e.g., the registrar's
+  // fetch-mutate-store loop, which otherwise pays a full storage
+  // read per operation cycle). It is safe even if another writer
+  // sneaks in: 'store' always validates the variable's version
+  // against the storage, and a failed store invalidates the cached
+  // variable so that the next fetch goes back to the storage.
+  explicit State(Storage* _storage, bool _caching = false)
+    : storage(_storage), caching(_caching) {}
+
   virtual ~State() {}
 
   // Returns a variable from the state, creating a new one if one
@@ -112,25 +128,42 @@ public:
   process::Future<std::set<std::string> > names();
 
 private:
-  // Helpers to handle future results from fetch and swap. We make
-  // these static members of State for friend access to Variable's
-  // constructor.
-  static process::Future<Variable> _fetch(
+  // Helpers to handle future results from fetch and swap. These are
+  // members of State both for friend access to Variable's
+  // constructor and to maintain the cache (when enabled).
+  process::Future<Variable> _fetch(
       const std::string& name,
       const Option<Entry>& option);
 
-  static process::Future<Option<Variable> > _store(
+  process::Future<Option<Variable> > _store(
       const Entry& entry,
       const bool& b); // TODO(benh): Remove 'const &' after fixing libprocess.
 
   Storage* storage;
+
+  const bool caching;
+
+  // Last known entries (with uncompressed values), maintained by the
+  // fetch and store continuations when caching is enabled. NOTE:
+  // like the rest of this class, the cache assumes the caller
+  // serializes its operations (e.g., a fetch-mutate-store loop that
+  // awaits each result before continuing).
+  hashmap<std::string, Entry> cache;
 };
 
 
 inline process::Future<Variable> State::fetch(const std::string& name)
 {
+  if (caching) {
+    Option<Entry> entry = cache.get(name);
+
+    if (entry.isSome()) {
+      return Variable(entry.get());
+    }
+  }
+
   return storage->get(name)
-    .then(lambda::bind(&State::_fetch, name, lambda::_1));
+    .then(lambda::bind(&State::_fetch, this, name, lambda::_1));
 }
 
 
@@ -139,11 +172,36 @@ inline process::Future<Variable> State::_fetch(
     const Option<Entry>& option)
 {
   if (option.isSome()) {
-    return Variable(option.get());
+    Entry entry = option.get();
+
+    // Values are transparently compressed on 'store'. Entries
+    // written before compression was introduced (or whose values did
+    // not shrink) are recognized by the absence of the gzip magic
+    // bytes and used as-is.
+    if (entry.value().size() >= 2 &&
+        static_cast<unsigned char>(entry.value()[0]) == 0x1f &&
+        static_cast<unsigned char>(entry.value()[1]) == 0x8b) {
+      Try<std::string> decompressed = gzip::decompress(entry.value());
+
+      if (decompressed.isError()) {
+        return process::Failure(
+            "Failed to decompress value of variable '" + entry.name() +
+            "': " + decompressed.error());
+      }
+
+      entry.set_value(decompressed.get());
+    }
+
+    if (caching) {
+      cache[name] = entry;
+    }
+
+    return Variable(entry);
   }
 
   // Otherwise, construct a Variable with a new Entry (with a random
-  // UUID and no value to start).
+  // UUID and no value to start). Note that we do not cache it: the
+  // variable only becomes part of the state once it is stored.
   Entry entry;
   entry.set_name(name);
   entry.set_uuid(UUID::random().toBytes());
@@ -164,8 +222,23 @@ inline process::Future<Option<Variable> > State::store(const Variable& variable)
   entry.set_uuid(UUID::random().toBytes());
   entry.set_value(variable.entry.value());
 
-  return storage->set(entry, uuid)
-    .then(lambda::bind(&State::_store, entry, lambda::_1));
+  // Transparently compress the value handed to the storage: large
+  // values (e.g., the master's registry) contain highly repetitive
+  // strings and compress several-fold, which cuts storage write
+  // volume and fetch time. Values that do not shrink are stored
+  // as-is; 'fetch' recognizes compressed values by the gzip magic
+  // bytes. Note that the variable returned to the caller retains the
+  // uncompressed value.
+  Entry stored = entry;
+
+  Try<std::string> compressed = gzip::compress(entry.value());
+
+  if (compressed.isSome() && compressed.get().size() < entry.value().size()) {
+    stored.set_value(compressed.get());
+  }
+
+  return storage->set(stored, uuid)
+    .then(lambda::bind(&State::_store, this, entry, lambda::_1));
 }
 
 
@@ -174,15 +247,34 @@ inline process::Future<Option<Variable > > State::_store(
     const bool& b) // TODO(benh): Remove 'const &' after fixing libprocess.
 {
   if (b) {
+    if (caching) {
+      cache[entry.name()] = entry;
+    }
+
     return Some(Variable(entry));
   }
 
+  // The version of the variable was no longer valid, i.e., another
+  // writer has stored it since our fetch. Whatever we have cached is
+  // stale as well, so invalidate it to force the next fetch back to
+  // the storage.
+  if (caching) {
+    cache.erase(entry.name());
+  }
+
   return None();
 }
 
 
 inline process::Future<bool> State::expunge(const Variable& variable)
 {
+  // Conservatively invalidate the cached variable up front: should
+  // the expunge fail, the only cost is that the next fetch goes to
+  // the storage.
+  if (caching) {
+    cache.erase(variable.entry.name());
+  }
+
   return storage->expunge(variable.entry);
 }
 
@@ -18,6 +18,7 @@
 
 #include <google/protobuf/io/zero_copy_stream_impl.h> // For ArrayInputStream.
 
+#include <functional>
 #include <queue>
 #include <set>
 #include <string>
@@ -29,10 +30,14 @@
 
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/format.hpp>
 #include <stout/none.hpp>
+#include <stout/nothing.hpp>
 #include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/some.hpp>
+#include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 #include <stout/uuid.hpp>
@@ -62,6 +67,41 @@ namespace mesos {
 namespace internal {
 namespace state {
 
+// The ZooKeeper server rejects znodes larger than 1 MB (the default
+// jute buffer limit), so entries whose serialized size exceeds this
+// bound are split across chunk znodes (see Entry::Manifest).
+static const size_t MAX_ZNODE_SIZE = 1024 * 1024;
+
+// Size of each chunk znode for entries that do not fit into a single
+// znode. Kept well under MAX_ZNODE_SIZE to leave room for request
+// framing and manifest overhead.
+static const size_t CHUNK_SIZE = 512 * 1024;
+
+// Name of the hidden child znode under which chunks are stored. The
+// chunks are scoped by the UUID of the entry version that wrote them,
+// i.e., the chunks of entry 'name' written for the version with UUID
+// 'uuid' live in '<znode>/.chunks/<name>/<uuid>/'. Scoping by writer
+// gives garbage collection clear ownership: a version's chunks can
+// only be collected once that version is known to be superseded, so a
+// concurrent writer's not yet published chunks are never touched.
+// This znode is filtered out of names().
+static const char CHUNKS_ZNODE[] = ".chunks";
+
+// Number of times a chunked read is retried when it races with a
+// concurrent update garbage collecting the chunks of the version
+// being read (see doGet).
+static const int MAX_CHUNKED_GET_ATTEMPTS = 3;
+
+
+// Returns the name of the chunk znode holding the given contents.
+// The content hash makes the name self-describing, which helps when
+// inspecting the znode tree by hand.
+static string chunkName(size_t index, const string& contents)
+{
+  return stringify(index) + "-" +
+         strings::format("%016zx", std::hash<string>()(contents)).get();
+}
+
 
 class ZooKeeperStorageProcess : public Process<ZooKeeperStorageProcess>
 {
@@ -97,6 +137,15 @@ private:
   Result<bool> doSet(const Entry& entry, const UUID& uuid);
   Result<bool> doExpunge(const Entry& entry);
 
+  // Helpers for managing chunked entries, i.e., entries whose value
+  // does not fit into a single znode (see Entry::Manifest).
+  string chunksPath(const string& name) const;
+  string chunksPath(const string& name, const string& uuid) const;
+  Result<Nothing> writeChunks(
+      const Entry& entry,
+      const Entry::Manifest& manifest);
+  void removeChunks(const string& name, const string& uuid);
+
   const string servers;
 
   // The session timeout requested by the client.
@@ -438,7 +487,12 @@ Result<std::set<string> > ZooKeeperStorageProcess::doNames()
   // TODO(benh): It might make sense to "mangle" the names so that we
   // can determine when a znode has incorrectly been added that
   // actually doesn't store an Entry.
-  return std::set<string>(results.begin(), results.end());
+  std::set<string> names(results.begin(), results.end());
+
+  // The chunks znode holds chunked entry data, not an Entry.
+  names.erase(CHUNKS_ZNODE);
+
+  return names;
 }
 
 
@@ -447,31 +501,94 @@ Result<Option<Entry> > ZooKeeperStorageProcess::doGet(const string& name)
   CHECK_NONE(error) << ": " << error.get();
   CHECK(state == CONNECTED);
 
-  string result;
-  Stat stat;
+  // Reading a chunked entry can race with a concurrent update that
+  // supersedes the version being read and garbage collects its
+  // chunks, in which case we retry against the new current version.
+  // The retry is bounded so that an entry whose chunks are gone for
+  // good (e.g., removed by hand) surfaces as an error rather than
+  // retrying forever.
+  for (int attempt = 0; attempt < MAX_CHUNKED_GET_ATTEMPTS; attempt++) {
+    string result;
+    Stat stat;
 
-  int code = zk->get(znode + "/" + name, false, &result, &stat);
+    int code = zk->get(znode + "/" + name, false, &result, &stat);
 
-  if (code == ZNONODE) {
-    return Option<Entry>::none();
-  } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
-    CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
-    return None(); // Try again later.
-  } else if (code != ZOK) {
-    return Error(
-        "Failed to get '" + znode + "/" + name +
-        "' in ZooKeeper: " + zk->message(code));
-  }
+    if (code == ZNONODE) {
+      return Option<Entry>::none();
+    } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK) {
+      return Error(
+          "Failed to get '" + znode + "/" + name +
+          "' in ZooKeeper: " + zk->message(code));
+    }
 
-  google::protobuf::io::ArrayInputStream stream(result.data(), result.size());
+    google::protobuf::io::ArrayInputStream stream(result.data(), result.size());
 
-  Entry entry;
+    Entry entry;
 
-  if (!entry.ParseFromZeroCopyStream(&stream)) {
-    return Error("Failed to deserialize Entry");
+    if (!entry.ParseFromZeroCopyStream(&stream)) {
+      return Error("Failed to deserialize Entry");
+    }
+
+    if (!entry.has_manifest()) {
+      return Some(entry);
+    }
+
+    // Reassemble the value of a chunked entry from its chunk znodes.
+    const string uuid = UUID::fromBytes(entry.uuid()).toString();
+
+    string value;
+    bool collected = false;
+
+    foreach (const Entry::Manifest::Chunk& chunk, entry.manifest().chunks()) {
+      string contents;
+      Stat chunkStat;
+
+      code = zk->get(
+          chunksPath(name, uuid) + "/" + chunk.name(),
+          false,
+          &contents,
+          &chunkStat);
+
+      if (code == ZNONODE) {
+        // A concurrent update superseded this version and garbage
+        // collected its chunks; retry against the current version.
+        collected = true;
+        break;
+      } else if (code == ZINVALIDSTATE ||
+                 (code != ZOK && zk->retryable(code))) {
+        CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+        return None(); // Try again later.
+      } else if (code != ZOK) {
+        return Error(
+            "Failed to get chunk '" + chunk.name() + "' of '" + znode + "/" +
+            name + "' in ZooKeeper: " + zk->message(code));
+      }
+
+      if (contents.size() != chunk.size()) {
+        return Error(
+            "Chunk '" + chunk.name() + "' of '" + znode + "/" + name +
+            "' has unexpected size " + stringify(contents.size()));
+      }
+
+      value += contents;
+    }
+
+    if (collected) {
+      continue;
+    }
+
+    entry.clear_manifest();
+    entry.set_value(value);
+
+    return Some(entry);
   }
 
-  return Some(entry);
+  return Error(
+      "Failed to get a consistent copy of '" + znode + "/" + name +
+      "' after " + stringify(MAX_CHUNKED_GET_ATTEMPTS) + " attempts");
 }
 
 
@@ -481,16 +598,45 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
   CHECK_NONE(error) << ": " << error.get();
   CHECK(state == CONNECTED);
 
-  // Serialize to make sure we're under the 1 MB limit.
+  // Serialize to see whether we're under the znode limit.
   string data;
 
   if (!entry.SerializeToString(&data)) {
     return Error("Failed to serialize Entry");
   }
 
-  if (data.size() > 1024 * 1024) { // 1 MB
+  // Entries that don't fit into a single znode get their value split
+  // across chunk znodes; the variable's znode then only stores a
+  // manifest naming the chunks. The chunks are written under this
+  // version's UUID (see CHUNKS_ZNODE) before the manifest becomes
+  // visible, so a reader never observes a manifest referencing chunks
+  // that don't exist yet.
+  Entry stored = entry;
+
+  if (data.size() > MAX_ZNODE_SIZE) {
     // TODO(benh): Use stout/gzip.hpp for compression.
-    return Error("Serialized data is too big (> 1 MB)");
+    stored.set_value("");
+
+    const string& value = entry.value();
+
+    size_t index = 0;
+    for (size_t offset = 0; offset < value.size(); offset += CHUNK_SIZE) {
+      const string contents = value.substr(offset, CHUNK_SIZE);
+
+      Entry::Manifest::Chunk* chunk = stored.mutable_manifest()->add_chunks();
+      chunk->set_name(chunkName(index++, contents));
+      chunk->set_size(contents.size());
+    }
+
+    data.clear();
+
+    if (!stored.SerializeToString(&data)) {
+      return Error("Failed to serialize Entry");
+    }
+
+    if (data.size() > MAX_ZNODE_SIZE) {
+      return Error("Serialized manifest is too big (> 1 MB)");
+    }
   }
 
   string result;
@@ -521,10 +667,29 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
       }
     }
 
+    // Write the chunks before creating the variable's znode so that
+    // a reader never observes a manifest referencing chunks that
+    // don't exist yet.
+    if (stored.has_manifest()) {
+      Result<Nothing> written = writeChunks(entry, stored.manifest());
+
+      if (written.isNone()) {
+        return None(); // Try again later.
+      } else if (written.isError()) {
+        return Error(written.error());
+      }
+    }
+
     code = zk->create(znode + "/" + entry.name(), data, acl, 0, NULL);
 
     if (code == ZNODEEXISTS) {
-      return false; // Lost a race with someone else.
+      // Lost a race with someone else. Our chunks were never
+      // published so nobody else will collect them; clean up after
+      // ourselves.
+      if (stored.has_manifest()) {
+        removeChunks(entry.name(), UUID::fromBytes(entry.uuid()).toString());
+      }
+      return false;
     } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
       CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
       return None(); // Try again later.
@@ -556,10 +721,25 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
     return false;
   }
 
+  if (stored.has_manifest()) {
+    Result<Nothing> written = writeChunks(entry, stored.manifest());
+
+    if (written.isNone()) {
+      return None(); // Try again later.
+    } else if (written.isError()) {
+      return Error(written.error());
+    }
+  }
+
   // Okay, do the set, we get atomicity by requiring 'stat.version'.
   code = zk->set(znode + "/" + entry.name(), data, stat.version);
 
   if (code == ZBADVERSION) {
+    // Lost a race with someone else. Our chunks were never published
+    // so nobody else will collect them; clean up after ourselves.
+    if (stored.has_manifest()) {
+      removeChunks(entry.name(), UUID::fromBytes(entry.uuid()).toString());
+    }
     return false;
   } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
     CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
@@ -570,6 +750,17 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
         "' in ZooKeeper: " + zk->message(code));
   }
 
+  // Now that the new version is visible, garbage collect the chunks
+  // of the version it replaced. Only that version's chunks can be
+  // collected here: a concurrent writer's not yet published chunks
+  // live under its own UUID, which we never observed, so they are
+  // never touched (a writer that crashes mid-write leaks its chunks,
+  // which is preferable to a published manifest having its chunks
+  // collected out from under it).
+  if (current.has_manifest()) {
+    removeChunks(entry.name(), UUID::fromBytes(current.uuid()).toString());
+  }
+
   return true;
 }
 
@@ -621,10 +812,95 @@ Result<bool> ZooKeeperStorageProcess::doExpunge(const Entry& entry)
         "' in ZooKeeper: " + zk->message(code));
   }
 
+  // Garbage collect the chunks of a chunked entry.
+  if (current.has_manifest()) {
+    removeChunks(entry.name(), UUID::fromBytes(current.uuid()).toString());
+  }
+
   return true;
 }
 
 
+string ZooKeeperStorageProcess::chunksPath(const string& name) const
+{
+  return znode + "/" + CHUNKS_ZNODE + "/" + name;
+}
+
+
+string ZooKeeperStorageProcess::chunksPath(
+    const string& name,
+    const string& uuid) const
+{
+  return chunksPath(name) + "/" + uuid;
+}
+
+
+Result<Nothing> ZooKeeperStorageProcess::writeChunks(
+    const Entry& entry,
+    const Entry::Manifest& manifest)
+{
+  const string uuid = UUID::fromBytes(entry.uuid()).toString();
+
+  for (int i = 0; i < manifest.chunks_size(); i++) {
+    const Entry::Manifest::Chunk& chunk = manifest.chunks(i);
+
+    const string contents = entry.value().substr(i * CHUNK_SIZE, CHUNK_SIZE);
+
+    int code = zk->create(
+        chunksPath(entry.name(), uuid) + "/" + chunk.name(),
+        contents,
+        acl,
+        0,
+        NULL,
+        true);
+
+    if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK && code != ZNODEEXISTS) {
+      return Error(
+          "Failed to create chunk '" + chunk.name() + "' of '" + znode + "/" +
+          entry.name() + "' in ZooKeeper: " + zk->message(code));
+    }
+  }
+
+  return Nothing();
+}
+
+
+void ZooKeeperStorageProcess::removeChunks(
+    const string& name,
+    const string& uuid)
+{
+  // This is best effort: a removal that fails here leaks the chunks
+  // (see the comment in doSet), which is harmless beyond the space
+  // they occupy, so failures are simply ignored.
+  const string path = chunksPath(name, uuid);
+
+  vector<string> children;
+
+  int code = zk->getChildren(path, false, &children);
+
+  if (code != ZOK) {
+    return;
+  }
+
+  foreach (const string& child, children) {
+    // NOTE: A reader holding this version's manifest may race with
+    // this removal; it observes the missing chunk and retries
+    // against the current version (see doGet).
+    zk->remove(path + "/" + child, -1);
+  }
+
+  zk->remove(path, -1);
+
+  // Remove the chunks znode as well once no chunked versions of the
+  // entry remain. This fails with ZNOTEMPTY while other versions
+  // (e.g., one being written concurrently) still have chunks.
+  zk->remove(chunksPath(name), -1);
+}
+
+
 ZooKeeperStorage::ZooKeeperStorage(
     const string& servers,
     const Duration& timeout,
@@ -145,24 +145,73 @@ ACTION_P(InvokeUpdateUnavailability, allocator)
 }
 
 
+// NOTE: As with `InvokeBatchRecoverResources` below, the default
+// actions for the bulk overloads funnel each update through the
+// mocked single-update overload, so that expectations placed on the
+// latter keep seeing every update regardless of batching.
+ACTION_P(InvokeBatchUpdateUnavailability, allocator)
+{
+  foreach (const mesos::master::allocator::UnavailabilityUpdate& update,
+           arg0) {
+    allocator->updateUnavailability(update.slaveId, update.unavailability);
+  }
+}
+
+
 ACTION_P(InvokeUpdateInverseOffer, allocator)
 {
   return allocator->real->updateInverseOffer(arg0, arg1, arg2, arg3, arg4);
 }
 
 
+ACTION_P(InvokeBatchUpdateInverseOffer, allocator)
+{
+  foreach (const mesos::master::allocator::InverseOfferUpdate& update, arg0) {
+    allocator->updateInverseOffer(
+        update.slaveId,
+        update.frameworkId,
+        update.unavailableResources,
+        update.status,
+        update.filters);
+  }
+}
+
+
 ACTION_P(InvokeGetInverseOfferStatuses, allocator)
 {
   return allocator->real->getInverseOfferStatuses();
 }
 
 
+ACTION_P(InvokeGetSorterState, allocator)
+{
+  return allocator->real->getSorterState();
+}
+
+
 ACTION_P(InvokeRecoverResources, allocator)
 {
   allocator->real->recoverResources(arg0, arg1, arg2, arg3);
 }
 
 
+// NOTE: The default action for the bulk overload funnels each
+// recovery through the mocked single-recovery overload (rather than
+// straight into the real allocator), so that expectations placed on
+// the latter keep seeing every recovery regardless of whether the
+// master batches them.
+ACTION_P(InvokeBatchRecoverResources, allocator)
+{
+  foreach (const mesos::master::allocator::ResourceRecovery& recovery, arg0) {
+    allocator->recoverResources(
+        recovery.frameworkId,
+        recovery.slaveId,
+        recovery.resources,
+        recovery.filters);
+  }
+}
+
+
 ACTION_P2(InvokeRecoverResourcesWithFilters, allocator, timeout)
 {
   Filters filters;
@@ -184,6 +233,12 @@ ACTION_P(InvokeReviveOffers, allocator)
 }
 
 
+ACTION_P(InvokeUpdateOfferHolding, allocator)
+{
+  allocator->real->updateOfferHolding(arg0, arg1, arg2);
+}
+
+
 ACTION_P(InvokeSetQuota, allocator)
 {
   allocator->real->setQuota(arg0, arg1);
@@ -308,21 +363,41 @@ public:
     EXPECT_CALL(*this, updateUnavailability(_, _))
       .WillRepeatedly(DoDefault());
 
+    ON_CALL(*this, updateUnavailability(_))
+      .WillByDefault(InvokeBatchUpdateUnavailability(this));
+    EXPECT_CALL(*this, updateUnavailability(_))
+      .WillRepeatedly(DoDefault());
+
     ON_CALL(*this, updateInverseOffer(_, _, _, _, _))
       .WillByDefault(InvokeUpdateInverseOffer(this));
     EXPECT_CALL(*this, updateInverseOffer(_, _, _, _, _))
       .WillRepeatedly(DoDefault());
 
+    ON_CALL(*this, updateInverseOffer(_))
+      .WillByDefault(InvokeBatchUpdateInverseOffer(this));
+    EXPECT_CALL(*this, updateInverseOffer(_))
+      .WillRepeatedly(DoDefault());
+
     ON_CALL(*this, getInverseOfferStatuses())
       .WillByDefault(InvokeGetInverseOfferStatuses(this));
     EXPECT_CALL(*this, getInverseOfferStatuses())
       .WillRepeatedly(DoDefault());
 
+    ON_CALL(*this, getSorterState())
+      .WillByDefault(InvokeGetSorterState(this));
+    EXPECT_CALL(*this, getSorterState())
+      .WillRepeatedly(DoDefault());
+
     ON_CALL(*this, recoverResources(_, _, _, _))
       .WillByDefault(InvokeRecoverResources(this));
     EXPECT_CALL(*this, recoverResources(_, _, _, _))
       .WillRepeatedly(DoDefault());
 
+    ON_CALL(*this, recoverResources(_))
+      .WillByDefault(InvokeBatchRecoverResources(this));
+    EXPECT_CALL(*this, recoverResources(_))
+      .WillRepeatedly(DoDefault());
+
     ON_CALL(*this, suppressOffers(_))
       .WillByDefault(InvokeSuppressOffers(this));
     EXPECT_CALL(*this, suppressOffers(_))
@@ -333,6 +408,11 @@ public:
     EXPECT_CALL(*this, reviveOffers(_))
       .WillRepeatedly(DoDefault());
 
+    ON_CALL(*this, updateOfferHolding(_, _, _))
+      .WillByDefault(InvokeUpdateOfferHolding(this));
+    EXPECT_CALL(*this, updateOfferHolding(_, _, _))
+      .WillRepeatedly(DoDefault());
+
     ON_CALL(*this, setQuota(_, _))
       .WillByDefault(InvokeSetQuota(this));
     EXPECT_CALL(*this, setQuota(_, _))
@@ -350,7 +430,7 @@ public:
       const Duration&,
       const lambda::function<
           void(const FrameworkID&,
-               const hashmap<SlaveID, Resources>&)>&,
+               hashmap<SlaveID, Resources>)>&,
       const lambda::function<
           void(const FrameworkID&,
                const hashmap<SlaveID, UnavailableResources>&)>&,
@@ -418,6 +498,9 @@ public:
       const SlaveID&,
       const Option<Unavailability>&));
 
+  MOCK_METHOD1(updateUnavailability, void(
+      const std::vector<mesos::master::allocator::UnavailabilityUpdate>&));
+
   MOCK_METHOD5(updateInverseOffer, void(
       const SlaveID&,
       const FrameworkID&,
@@ -425,23 +508,38 @@ public:
       const Option<mesos::master::InverseOfferStatus>&,
       const Option<Filters>&));
 
+  MOCK_METHOD1(updateInverseOffer, void(
+      const std::vector<mesos::master::allocator::InverseOfferUpdate>&));
+
   MOCK_METHOD0(getInverseOfferStatuses, process::Future<
       hashmap<SlaveID, hashmap<
           FrameworkID,
           mesos::master::InverseOfferStatus>>>());
 
+  MOCK_METHOD0(getSorterState, process::Future<
+      hashmap<std::string, std::vector<
+          mesos::master::allocator::ClientState>>>());
+
   MOCK_METHOD4(recoverResources, void(
       const FrameworkID&,
       const SlaveID&,
       const Resources&,
       const Option<Filters>& filters));
 
+  MOCK_METHOD1(recoverResources, void(
+      const std::vector<mesos::master::allocator::ResourceRecovery>&));
+
   MOCK_METHOD1(suppressOffers, void(
       const FrameworkID&));
 
   MOCK_METHOD1(reviveOffers, void(
       const FrameworkID&));
 
+  MOCK_METHOD3(updateOfferHolding, void(
+      const FrameworkID&,
+      const Option<process::Time>&,
+      const Duration&));
+
   MOCK_METHOD2(setQuota, void(
       const std::string&,
       const Quota&));
@@ -0,0 +1,404 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A benchmark driver for allocators. It loads any allocator (the
+// built-in hierarchical DRF allocator or one provided by a module),
+// replays a recorded cluster event trace against it and reports
+// cycle-time and throughput metrics. This allows A/B comparison of
+// allocator implementations with production traces before rollout.
+//
+// The trace is a file with one JSON object per line:
+//
+//   {"type":"ADD_FRAMEWORK","id":"fw1","role":"analytics"}
+//   {"type":"ADD_SLAVE","id":"slave1","resources":"cpus:24;mem:4096"}
+//   {"type":"DECLINE","id":"fw1"}
+//   {"type":"DECLINE_ALL"}
+//   {"type":"ALLOCATE"}
+//   {"type":"REMOVE_FRAMEWORK","id":"fw1"}
+//   {"type":"REMOVE_SLAVE","id":"slave1"}
+//
+// 'DECLINE' permanently declines all resources currently offered to
+// the given framework and 'DECLINE_ALL' does so for all frameworks.
+// 'ALLOCATE' drives one batch allocation cycle and times it.
+
+#include <limits.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <mesos/resources.hpp>
+
+#include <mesos/master/allocator.hpp>
+
+#include <process/clock.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/flags.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/json.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/strings.hpp>
+#include <stout/try.hpp>
+
+#include "common/parse.hpp"
+
+#include "master/constants.hpp"
+
+#include "module/manager.hpp"
+
+using namespace mesos;
+
+using mesos::master::allocator::Allocator;
+
+using mesos::modules::ModuleManager;
+
+using process::Clock;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+
+class Flags : public virtual flags::FlagsBase
+{
+public:
+  Flags()
+  {
+    add(&Flags::allocator,
+        "allocator",
+        "Allocator to benchmark. The default is the built-in\n"
+        "hierarchical DRF allocator; other allocators need to be\n"
+        "loaded through the --modules flag.",
+        mesos::internal::master::DEFAULT_ALLOCATOR);
+
+    add(&Flags::modules,
+        "modules",
+        "List of modules to be loaded and available to the benchmark,\n"
+        "either as a path to a file containing a JSON formatted\n"
+        "'Modules' object, prefixed with 'file://', or as the JSON\n"
+        "itself.");
+
+    add(&Flags::trace,
+        "trace",
+        "Path to the cluster event trace to replay (one JSON object\n"
+        "per line).");
+
+    add(&Flags::allocation_interval,
+        "allocation_interval",
+        "Allocation interval passed to the allocator.",
+        Seconds(1));
+  }
+
+  string allocator;
+  Option<Modules> modules;
+  Option<string> trace;
+  Duration allocation_interval;
+};
+
+
+// Resources offered to a framework, retained so that a later
+// 'DECLINE' event in the trace can recover them.
+struct OfferedResources
+{
+  FrameworkID frameworkId;
+  SlaveID slaveId;
+  Resources resources;
+};
+
+
+// Extracts a required string field from a trace event.
+static Try<string> field(const JSON::Object& event, const string& name)
+{
+  Result<JSON::String> value = event.find<JSON::String>(name);
+
+  if (!value.isSome()) {
+    return Error(
+        "Expected '" + name + "' in event: " +
+        (value.isError() ? value.error() : "not found"));
+  }
+
+  return value.get().value;
+}
+
+
+int main(int argc, char** argv)
+{
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  Flags flags;
+
+  Try<Nothing> load = flags.load(None(), argc, argv);
+
+  if (load.isError()) {
+    cerr << flags.usage(load.error()) << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (flags.help) {
+    cout << flags.usage() << endl;
+    return EXIT_SUCCESS;
+  }
+
+  if (flags.trace.isNone()) {
+    cerr << flags.usage("Missing required option --trace") << endl;
+    return EXIT_FAILURE;
+  }
+
+  Try<string> trace = os::read(flags.trace.get());
+
+  if (trace.isError()) {
+    cerr << "Failed to read trace '" << flags.trace.get()
+         << "': " << trace.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (flags.modules.isSome()) {
+    Try<Nothing> result = ModuleManager::load(flags.modules.get());
+    if (result.isError()) {
+      cerr << "Error loading modules: " << result.error() << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  Try<Allocator*> allocator = Allocator::create(flags.allocator);
+
+  if (allocator.isError()) {
+    cerr << "Failed to create '" << flags.allocator
+         << "' allocator: " << allocator.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Pause the clock so that batch allocations are driven manually
+  // through the 'ALLOCATE' trace events.
+  Clock::pause();
+
+  // Offers outstanding per framework. The offer callback runs in the
+  // allocator's context; we only read this map after 'Clock::settle'
+  // so there are no concurrent accesses.
+  hashmap<FrameworkID, vector<OfferedResources>> offered;
+
+  size_t offerCount = 0;
+
+  auto offerCallback = [&offered, &offerCount](
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources) {
+    foreachpair (const SlaveID& slaveId, const Resources& offer, resources) {
+      offered[frameworkId].push_back(
+          OfferedResources{frameworkId, slaveId, offer});
+      offerCount++;
+    }
+  };
+
+  auto inverseOfferCallback = [](
+      const FrameworkID&,
+      const hashmap<SlaveID, UnavailableResources>&) {};
+
+  allocator.get()->initialize(
+      flags.allocation_interval,
+      offerCallback,
+      inverseOfferCallback,
+      {});
+
+  // Permanently declines all offers outstanding for a framework.
+  auto decline = [&allocator, &offered](const FrameworkID& frameworkId) {
+    Filters filters;
+    filters.set_refuse_seconds(INT_MAX);
+
+    foreach (const OfferedResources& offer, offered[frameworkId]) {
+      allocator.get()->recoverResources(
+          offer.frameworkId, offer.slaveId, offer.resources, filters);
+    }
+
+    offered.erase(frameworkId);
+  };
+
+  size_t events = 0;
+  size_t cycles = 0;
+  Duration allocationTime = Duration::zero();
+  Option<Duration> minCycle;
+  Option<Duration> maxCycle;
+
+  Stopwatch total;
+  total.start();
+
+  foreach (const string& line, strings::split(trace.get(), "\n")) {
+    if (strings::trim(line).empty()) {
+      continue;
+    }
+
+    Try<JSON::Object> event = JSON::parse<JSON::Object>(line);
+
+    if (event.isError()) {
+      cerr << "Failed to parse trace event '" << line
+           << "': " << event.error() << endl;
+      return EXIT_FAILURE;
+    }
+
+    Try<string> type = field(event.get(), "type");
+
+    if (type.isError()) {
+      cerr << type.error() << endl;
+      return EXIT_FAILURE;
+    }
+
+    events++;
+
+    if (type.get() == "ADD_FRAMEWORK") {
+      Try<string> id = field(event.get(), "id");
+
+      if (id.isError()) {
+        cerr << id.error() << endl;
+        return EXIT_FAILURE;
+      }
+
+      Result<JSON::String> role = event.get().find<JSON::String>("role");
+
+      FrameworkInfo framework;
+      framework.set_user("benchmark");
+      framework.set_name(id.get());
+      framework.set_role(role.isSome() ? role.get().value : "*");
+      framework.mutable_id()->set_value(id.get());
+
+      allocator.get()->addFramework(framework.id(), framework, {});
+    } else if (type.get() == "REMOVE_FRAMEWORK") {
+      Try<string> id = field(event.get(), "id");
+
+      if (id.isError()) {
+        cerr << id.error() << endl;
+        return EXIT_FAILURE;
+      }
+
+      FrameworkID frameworkId;
+      frameworkId.set_value(id.get());
+
+      allocator.get()->removeFramework(frameworkId);
+      offered.erase(frameworkId);
+    } else if (type.get() == "ADD_SLAVE") {
+      Try<string> id = field(event.get(), "id");
+      Try<string> resources = field(event.get(), "resources");
+
+      if (id.isError() || resources.isError()) {
+        cerr << (id.isError() ? id.error() : resources.error()) << endl;
+        return EXIT_FAILURE;
+      }
+
+      Try<Resources> parsed = Resources::parse(resources.get());
+
+      if (parsed.isError()) {
+        cerr << "Failed to parse resources '" << resources.get()
+             << "': " << parsed.error() << endl;
+        return EXIT_FAILURE;
+      }
+
+      SlaveInfo slave;
+      slave.set_hostname(id.get());
+      slave.mutable_resources()->CopyFrom(parsed.get());
+      slave.mutable_id()->set_value(id.get());
+
+      allocator.get()->addSlave(
+          slave.id(), slave, None(), slave.resources(), {});
+    } else if (type.get() == "REMOVE_SLAVE") {
+      Try<string> id = field(event.get(), "id");
+
+      if (id.isError()) {
+        cerr << id.error() << endl;
+        return EXIT_FAILURE;
+      }
+
+      SlaveID slaveId;
+      slaveId.set_value(id.get());
+
+      allocator.get()->removeSlave(slaveId);
+    } else if (type.get() == "DECLINE") {
+      Try<string> id = field(event.get(), "id");
+
+      if (id.isError()) {
+        cerr << id.error() << endl;
+        return EXIT_FAILURE;
+      }
+
+      FrameworkID frameworkId;
+      frameworkId.set_value(id.get());
+
+      Clock::settle();
+      decline(frameworkId);
+    } else if (type.get() == "DECLINE_ALL") {
+      Clock::settle();
+
+      foreach (const FrameworkID& frameworkId, offered.keys()) {
+        decline(frameworkId);
+      }
+    } else if (type.get() == "ALLOCATE") {
+      // Make sure all the event-driven allocations triggered by the
+      // preceding events have been processed so the cycle time below
+      // only measures the batch allocation.
+      Clock::settle();
+
+      size_t before = offerCount;
+
+      Stopwatch watch;
+      watch.start();
+
+      Clock::advance(flags.allocation_interval);
+      Clock::settle();
+
+      Duration elapsed = watch.elapsed();
+
+      cycles++;
+      allocationTime += elapsed;
+
+      if (minCycle.isNone() || elapsed < minCycle.get()) {
+        minCycle = elapsed;
+      }
+
+      if (maxCycle.isNone() || elapsed > maxCycle.get()) {
+        maxCycle = elapsed;
+      }
+
+      cout << "cycle " << cycles << " took " << elapsed
+           << " to make " << (offerCount - before) << " offers" << endl;
+    } else {
+      cerr << "Unknown event type '" << type.get() << "'" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Wait for any trailing event-driven allocations.
+  Clock::settle();
+
+  Duration elapsed = total.elapsed();
+
+  cout << endl
+       << "Replayed " << events << " events in " << elapsed
+       << " (" << (events / elapsed.secs()) << " events/s)" << endl
+       << "Made " << offerCount << " offers" << endl;
+
+  if (cycles > 0) {
+    cout << "Allocation cycles: " << cycles
+         << " min " << minCycle.get()
+         << " max " << maxCycle.get()
+         << " mean " << (allocationTime / cycles) << endl;
+  }
+
+  delete allocator.get();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "common/existence_filter.hpp"
+
+using std::hash;
+using std::string;
+
+using mesos::internal::ExistenceFilter;
+
+
+// Elements that were never added must be reported as definitely
+// absent; added elements must always be reported as possibly
+// present until they are removed as many times as they were added.
+TEST(ExistenceFilterTest, AddRemove)
+{
+  ExistenceFilter filter(1024);
+
+  size_t element = hash<string>()("task-1");
+
+  EXPECT_FALSE(filter.possiblyContains(element));
+
+  filter.add(element);
+  EXPECT_TRUE(filter.possiblyContains(element));
+
+  // A second addition requires a second removal (counting).
+  filter.add(element);
+  filter.remove(element);
+  EXPECT_TRUE(filter.possiblyContains(element));
+
+  filter.remove(element);
+  EXPECT_FALSE(filter.possiblyContains(element));
+}
+
+
+// The filter never produces false negatives, even with many
+// resident elements and interleaved removals.
+TEST(ExistenceFilterTest, NoFalseNegatives)
+{
+  ExistenceFilter filter(1024);
+
+  for (int i = 0; i < 1000; i++) {
+    filter.add(hash<int>()(i));
+  }
+
+  for (int i = 0; i < 1000; i += 2) {
+    filter.remove(hash<int>()(i));
+  }
+
+  for (int i = 1; i < 1000; i += 2) {
+    EXPECT_TRUE(filter.possiblyContains(hash<int>()(i)));
+  }
+}
+
+
+// Compound keys mixed with 'combine' must be distinguishable from
+// their components and from differently ordered combinations.
+TEST(ExistenceFilterTest, Combine)
+{
+  ExistenceFilter filter(1024);
+
+  size_t first = hash<string>()("framework");
+  size_t second = hash<string>()("executor");
+
+  filter.add(ExistenceFilter::combine(first, second));
+
+  EXPECT_TRUE(
+      filter.possiblyContains(ExistenceFilter::combine(first, second)));
+  EXPECT_FALSE(filter.possiblyContains(first));
+  EXPECT_FALSE(filter.possiblyContains(second));
+  EXPECT_FALSE(
+      filter.possiblyContains(ExistenceFilter::combine(second, first)));
+}
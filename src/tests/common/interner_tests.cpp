@@ -0,0 +1,78 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <mesos/mesos.hpp>
+#include <mesos/type_utils.hpp>
+
+#include "common/interner.hpp"
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+using namespace mesos;
+using namespace mesos::internal;
+
+
+// Interning identical messages should yield the same allocation,
+// while different messages remain distinct.
+TEST(InternerTest, Intern)
+{
+  Interner<ExecutorInfo> interner;
+
+  ExecutorInfo executor;
+  executor.mutable_executor_id()->set_value("executor");
+  executor.mutable_command()->set_value("sleep 100");
+
+  shared_ptr<const ExecutorInfo> interned1 = interner.intern(executor);
+  shared_ptr<const ExecutorInfo> interned2 = interner.intern(executor);
+
+  EXPECT_EQ(interned1.get(), interned2.get());
+  EXPECT_EQ(executor, *interned1);
+
+  executor.mutable_executor_id()->set_value("other");
+
+  shared_ptr<const ExecutorInfo> interned3 = interner.intern(executor);
+
+  EXPECT_NE(interned1.get(), interned3.get());
+  EXPECT_EQ(executor, *interned3);
+}
+
+
+// The interner holds only weak references: once all callers drop an
+// interned message it is freed, and interning it again yields a
+// fresh allocation.
+TEST(InternerTest, WeakReference)
+{
+  Interner<ExecutorInfo> interner;
+
+  ExecutorInfo executor;
+  executor.mutable_executor_id()->set_value("executor");
+
+  shared_ptr<const ExecutorInfo> interned = interner.intern(executor);
+  weak_ptr<const ExecutorInfo> weak = interned;
+
+  interned.reset();
+
+  EXPECT_TRUE(weak.expired());
+
+  interned = interner.intern(executor);
+
+  EXPECT_EQ(executor, *interned);
+}
@@ -364,6 +364,33 @@ TEST_F(CgroupsAnyHierarchyWithCpuMemoryTest, ROOT_CGROUPS_CreateRemove)
 }
 
 
+TEST_F(CgroupsAnyHierarchyTest, ROOT_CGROUPS_CreateDestroyMultiple)
+{
+  string hierarchy = path::join(baseHierarchy, "cpu");
+
+  std::vector<string> cgroups;
+  cgroups.push_back("mesos_test1");
+  cgroups.push_back("mesos_test2");
+
+  EXPECT_ERROR(cgroups::create("/tmp", cgroups));
+  ASSERT_SOME(cgroups::create(hierarchy, cgroups));
+
+  Try<std::vector<string>> get = cgroups::get(hierarchy);
+  ASSERT_SOME(get);
+
+  EXPECT_NE(get->end(), find(get->begin(), get->end(), "mesos_test1"));
+  EXPECT_NE(get->end(), find(get->begin(), get->end(), "mesos_test2"));
+
+  AWAIT_READY(cgroups::destroy(hierarchy, cgroups));
+
+  get = cgroups::get(hierarchy);
+  ASSERT_SOME(get);
+
+  EXPECT_EQ(get->end(), find(get->begin(), get->end(), "mesos_test1"));
+  EXPECT_EQ(get->end(), find(get->begin(), get->end(), "mesos_test2"));
+}
+
+
 TEST_F(CgroupsAnyHierarchyTest, ROOT_CGROUPS_Get)
 {
   string hierarchy = path::join(baseHierarchy, "cpu");
@@ -542,6 +569,30 @@ TEST_F(CgroupsAnyHierarchyWithCpuAcctMemoryTest, ROOT_CGROUPS_Stat)
 }
 
 
+TEST_F(CgroupsAnyHierarchyWithCpuAcctMemoryTest, ROOT_CGROUPS_Snapshot)
+{
+  std::vector<string> controls;
+  controls.push_back("cpuacct.stat");
+
+  EXPECT_ERROR(cgroups::snapshot(
+      path::join(baseHierarchy, "cpuacct"), "invalid", controls));
+
+  controls.push_back("cpuacct.usage");
+
+  Try<hashmap<string, string> > snapshot = cgroups::snapshot(
+      path::join(baseHierarchy, "cpuacct"), "/", controls);
+  ASSERT_SOME(snapshot);
+  ASSERT_TRUE(snapshot->contains("cpuacct.stat"));
+  ASSERT_TRUE(snapshot->contains("cpuacct.usage"));
+
+  Try<hashmap<string, uint64_t> > stat =
+    cgroups::stat("cpuacct.stat", snapshot->get("cpuacct.stat").get());
+  ASSERT_SOME(stat);
+  EXPECT_TRUE(stat->contains("user"));
+  EXPECT_TRUE(stat->contains("system"));
+}
+
+
 TEST_F(CgroupsAnyHierarchyWithCpuMemoryTest, ROOT_CGROUPS_Listen)
 {
   string hierarchy = path::join(baseHierarchy, "memory");
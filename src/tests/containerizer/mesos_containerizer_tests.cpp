@@ -29,6 +29,7 @@
 #include <process/future.hpp>
 #include <process/owned.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/net.hpp>
 #include <stout/strings.hpp>
 
@@ -564,6 +565,41 @@ public:
 };
 
 
+// The default 'usages' implementation should gather statistics via
+// the per-container 'usage', omitting containers whose statistics
+// could not be gathered rather than failing the whole batch.
+TEST(MesosIsolatorTest, BulkUsage)
+{
+  MockIsolator isolator;
+
+  ContainerID containerId1;
+  containerId1.set_value("container1");
+
+  ContainerID containerId2;
+  containerId2.set_value("container2");
+
+  ResourceStatistics statistics;
+  statistics.set_timestamp(0);
+  statistics.set_processes(2);
+
+  EXPECT_CALL(isolator, usage(containerId1))
+    .WillOnce(Return(statistics));
+
+  EXPECT_CALL(isolator, usage(containerId2))
+    .WillOnce(Return(Future<ResourceStatistics>(Failure("Injected failure"))));
+
+  Future<hashmap<ContainerID, ResourceStatistics>> usages =
+    isolator.usages({containerId1, containerId2});
+
+  AWAIT_READY(usages);
+
+  EXPECT_EQ(1u, usages.get().size());
+  ASSERT_TRUE(usages.get().contains(containerId1));
+  EXPECT_EQ(2u, usages.get().at(containerId1).processes());
+  EXPECT_FALSE(usages.get().contains(containerId2));
+}
+
+
 // Destroying a mesos containerizer while it is fetching should
 // complete without waiting for the fetching to finish.
 TEST_F(MesosContainerizerDestroyTest, DestroyWhileFetching)
@@ -806,6 +842,60 @@ TEST_F(MesosContainerizerDestroyTest, LauncherDestroyFailure)
 }
 
 
+// Destroying more containers than --container_destroy_parallelism
+// allows should queue the excess destroys and still terminate all
+// the containers.
+TEST_F(MesosContainerizerDestroyTest, BoundedParallelism)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.container_destroy_parallelism = 1;
+
+  Fetcher fetcher;
+
+  Try<MesosContainerizer*> create =
+    MesosContainerizer::create(flags, true, &fetcher);
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  ContainerID containerId1;
+  containerId1.set_value("test_container_1");
+
+  ContainerID containerId2;
+  containerId2.set_value("test_container_2");
+
+  TaskInfo taskInfo;
+  CommandInfo commandInfo;
+  taskInfo.mutable_command()->MergeFrom(commandInfo);
+
+  vector<ContainerID> containerIds = {containerId1, containerId2};
+
+  foreach (const ContainerID& containerId, containerIds) {
+    Future<bool> launch = containerizer->launch(
+        containerId,
+        taskInfo,
+        CREATE_EXECUTOR_INFO("executor", "sleep 1000"),
+        os::getcwd(),
+        None(),
+        SlaveID(),
+        PID<Slave>(),
+        false);
+
+    AWAIT_READY(launch);
+  }
+
+  Future<containerizer::Termination> wait1 = containerizer->wait(containerId1);
+  Future<containerizer::Termination> wait2 = containerizer->wait(containerId2);
+
+  containerizer->destroy(containerId1);
+  containerizer->destroy(containerId2);
+
+  AWAIT_READY(wait1);
+  AWAIT_READY(wait2);
+}
+
+
 class MesosContainerizerRecoverTest : public MesosTest {};
 
 
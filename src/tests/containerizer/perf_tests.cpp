@@ -22,11 +22,14 @@
 
 #include <process/clock.hpp>
 #include <process/gtest.hpp>
+#include <process/owned.hpp>
 
 #include <stout/gtest.hpp>
+#include <stout/os.hpp>
 #include <stout/stringify.hpp>
 
 #include "linux/perf.hpp"
+#include "linux/perf_sampler.hpp"
 
 using std::set;
 using std::string;
@@ -62,6 +65,29 @@ TEST_F(PerfTest, ROOT_Sample)
 }
 
 
+TEST_F(PerfTest, ROOT_SamplerEvents)
+{
+  // The hierarchy is only used once counters are opened for a
+  // cgroup, so any path will do for validating events.
+  Try<Owned<perf::Sampler>> sampler =
+    perf::Sampler::create(os::getcwd(), {"cycles", "task-clock"});
+
+  ASSERT_SOME(sampler);
+
+  // Sampling an empty set of cgroups should be a no-op.
+  Future<hashmap<string, PerfStatistics>> sample =
+    sampler.get()->sample({}, Seconds(1));
+
+  AWAIT_READY(sample);
+
+  EXPECT_TRUE(sample->empty());
+
+  // Invalid event among valid events.
+  EXPECT_ERROR(
+      perf::Sampler::create(os::getcwd(), {"cycles", "invalid-event"}));
+}
+
+
 TEST_F(PerfTest, Parse)
 {
   // Parse multiple cgroups with uint64 and floats.
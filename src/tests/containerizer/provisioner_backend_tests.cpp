@@ -31,6 +31,7 @@
 
 #include "slave/containerizer/mesos/provisioner/backends/bind.hpp"
 #include "slave/containerizer/mesos/provisioner/backends/copy.hpp"
+#include "slave/containerizer/mesos/provisioner/backends/overlay.hpp"
 
 #include "tests/flags.hpp"
 
@@ -97,6 +98,83 @@ TEST_F(BindBackendTest, ROOT_BindBackend)
 
   EXPECT_FALSE(os::exists(target));
 }
+
+
+class OverlayBackendTest : public TemporaryDirectoryTest
+{
+protected:
+  void TearDown()
+  {
+    // Clean up by unmounting any leftover mounts in 'sandbox'.
+    Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
+    ASSERT_SOME(mountTable);
+
+    ASSERT_SOME(sandbox);
+    foreach (const fs::MountInfoTable::Entry& entry, mountTable.get().entries) {
+      if (strings::startsWith(entry.target, sandbox.get())) {
+        fs::unmount(entry.target, MNT_DETACH);
+      }
+    }
+
+    TemporaryDirectoryTest::TearDown();
+  }
+};
+
+
+// Provision a rootfs using multiple layers with the overlay backend
+// and verify that writes go to the upper directory without modifying
+// the layers.
+TEST_F(OverlayBackendTest, ROOT_OVERLAYFS_OverlayFSBackend)
+{
+  string layer1 = path::join(os::getcwd(), "source1");
+  ASSERT_SOME(os::mkdir(layer1));
+  ASSERT_SOME(os::mkdir(path::join(layer1, "dir1")));
+  ASSERT_SOME(os::write(path::join(layer1, "dir1", "1"), "1"));
+  ASSERT_SOME(os::write(path::join(layer1, "file"), "test1"));
+
+  string layer2 = path::join(os::getcwd(), "source2");
+  ASSERT_SOME(os::mkdir(layer2));
+  ASSERT_SOME(os::mkdir(path::join(layer2, "dir2")));
+  ASSERT_SOME(os::write(path::join(layer2, "dir2", "2"), "2"));
+  ASSERT_SOME(os::write(path::join(layer2, "file"), "test2"));
+
+  hashmap<string, Owned<Backend>> backends = Backend::create(slave::Flags());
+  ASSERT_TRUE(backends.contains("overlay"));
+
+  // Use a rootfs that is nested like the provisioner's so that the
+  // backend can create its scratch directories next to 'rootfses'.
+  string rootfs = path::join(os::getcwd(), "backend", "rootfses", "rootfs");
+
+  AWAIT_READY(backends["overlay"]->provision({layer1, layer2}, rootfs));
+
+  EXPECT_TRUE(os::exists(path::join(rootfs, "dir1", "1")));
+  Try<string> read = os::read(path::join(rootfs, "dir1", "1"));
+  ASSERT_SOME(read);
+  EXPECT_EQ(read.get(), "1");
+
+  EXPECT_TRUE(os::exists(path::join(rootfs, "dir2", "2")));
+  read = os::read(path::join(rootfs, "dir2", "2"));
+  ASSERT_SOME(read);
+  EXPECT_EQ(read.get(), "2");
+
+  // Last layer should shadow the file in the first layer.
+  EXPECT_TRUE(os::exists(path::join(rootfs, "file")));
+  read = os::read(path::join(rootfs, "file"));
+  ASSERT_SOME(read);
+  EXPECT_EQ(read.get(), "test2");
+
+  // The rootfs should be writable and writes should not modify the
+  // layers.
+  ASSERT_SOME(os::write(path::join(rootfs, "file"), "test3"));
+
+  read = os::read(path::join(layer2, "file"));
+  ASSERT_SOME(read);
+  EXPECT_EQ(read.get(), "test2");
+
+  AWAIT_READY(backends["overlay"]->destroy(rootfs));
+
+  EXPECT_FALSE(os::exists(rootfs));
+}
 #endif // __linux__
 
 
@@ -147,6 +225,49 @@ TEST_F(CopyBackendTest, ROOT_CopyBackend)
   EXPECT_FALSE(os::exists(rootfs));
 }
 
+
+// Provision with warm rootfs pooling enabled: every provision serves
+// the same content whether it binds a warm rootfs or copies the
+// layers, and the pool is populated in the background.
+TEST_F(CopyBackendTest, ROOT_CopyBackendPool)
+{
+  string layer = path::join(os::getcwd(), "source");
+  ASSERT_SOME(os::mkdir(layer));
+  ASSERT_SOME(os::write(path::join(layer, "file"), "test"));
+
+  slave::Flags flags;
+  flags.work_dir = os::getcwd();
+  flags.provisioner_pool_size = 1;
+
+  hashmap<string, Owned<Backend>> backends = Backend::create(flags);
+  ASSERT_TRUE(backends.contains("copy"));
+
+  string rootfs1 = path::join(os::getcwd(), "rootfs1");
+
+  AWAIT_READY(backends["copy"]->provision({layer}, rootfs1));
+
+  Try<string> read = os::read(path::join(rootfs1, "file"));
+  ASSERT_SOME(read);
+  EXPECT_EQ(read.get(), "test");
+
+  // The first provision starts warming the pool.
+  string poolDir = path::join(flags.work_dir, "provisioner", "pool", "copy");
+  EXPECT_TRUE(os::exists(poolDir));
+
+  // A subsequent provision serves the same content, from the pool
+  // when the warm copy has completed and by copying otherwise.
+  string rootfs2 = path::join(os::getcwd(), "rootfs2");
+
+  AWAIT_READY(backends["copy"]->provision({layer}, rootfs2));
+
+  read = os::read(path::join(rootfs2, "file"));
+  ASSERT_SOME(read);
+  EXPECT_EQ(read.get(), "test");
+
+  AWAIT_READY(backends["copy"]->destroy(rootfs1));
+  AWAIT_READY(backends["copy"]->destroy(rootfs2));
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -23,6 +23,7 @@
 #include <stout/duration.hpp>
 
 #include <stout/gtest.hpp>
+#include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
@@ -823,7 +824,8 @@ TEST_F(RegistryClientTest, SimpleRegistryPuller)
   ASSERT_SOME(imageName);
 
   Future<list<pair<string, string>>> registryPullerFuture =
-    registryPuller.get()->pull(imageName.get(), registryPullerPath);
+    registryPuller.get()->pull(
+        imageName.get(), registryPullerPath, hashset<string>());
 
   const string unauthResponseHeaders = "WWW-Authenticate: Bearer"
     " realm=\"https://auth.docker.io/token\","
@@ -1192,26 +1194,75 @@ TEST_F(ProvisionerDockerLocalStoreTest, MetadataManagerInitialization)
 }
 
 
+// This test verifies that the store evicts an unreferenced image when
+// it exceeds its size budget and that the evicted image is fetched
+// again by the next get.
+TEST_F(ProvisionerDockerLocalStoreTest, PruneEvictsUnreferencedImage)
+{
+  slave::Flags flags;
+  flags.docker_registry = "file://" + path::join(os::getcwd(), "images");
+  flags.docker_store_dir = path::join(os::getcwd(), "store");
+  flags.docker_store_size = Bytes(1);
+
+  Try<Owned<slave::Store>> store = slave::docker::Store::create(flags);
+  ASSERT_SOME(store);
+
+  Image image;
+  image.set_type(Image::DOCKER);
+  image.mutable_docker()->set_name("abc");
+
+  Future<slave::ImageInfo> imageInfo = store.get()->get(image);
+  AWAIT_READY(imageInfo);
+
+  // The image is excluded because a container still uses it, so it
+  // survives pruning even though the store exceeds its budget.
+  Future<Nothing> prune = store.get()->prune({image});
+  AWAIT_READY(prune);
+
+  EXPECT_TRUE(os::exists(
+      getImageLayerRootfsPath(flags.docker_store_dir, "123")));
+  EXPECT_TRUE(os::exists(
+      getImageLayerRootfsPath(flags.docker_store_dir, "456")));
+
+  // Once no container references the image it is evicted along with
+  // its layers.
+  prune = store.get()->prune({});
+  AWAIT_READY(prune);
+
+  EXPECT_FALSE(os::exists(
+      getImageLayerRootfsPath(flags.docker_store_dir, "123")));
+  EXPECT_FALSE(os::exists(
+      getImageLayerRootfsPath(flags.docker_store_dir, "456")));
+
+  // The next get refetches the evicted image.
+  imageInfo = store.get()->get(image);
+  AWAIT_READY(imageInfo);
+  verifyLocalDockerImage(flags, imageInfo.get().layers);
+}
+
+
 class MockPuller : public Puller
 {
 public:
   MockPuller()
   {
-    EXPECT_CALL(*this, pull(_, _))
+    EXPECT_CALL(*this, pull(_, _, _))
       .WillRepeatedly(Invoke(this, &MockPuller::unmocked_pull));
   }
 
   virtual ~MockPuller() {}
 
-  MOCK_METHOD2(
+  MOCK_METHOD3(
       pull,
       Future<list<pair<string, string>>>(
           const slave::docker::Image::Name&,
-          const Path&));
+          const Path&,
+          const hashset<string>&));
 
   Future<list<pair<string, string>>> unmocked_pull(
       const slave::docker::Image::Name& name,
-      const Path& directory)
+      const Path& directory,
+      const hashset<string>& storedLayers)
   {
     // TODO(gilbert): Allow return list to be overridden.
     return list<pair<string, string>>();
@@ -1237,7 +1288,7 @@ TEST_F(ProvisionerDockerLocalStoreTest, PullingSameImageSimutanuously)
   Future<Nothing> pull;
   Promise<list<pair<string, string>>> promise;
 
-  EXPECT_CALL(*puller, pull(_, _))
+  EXPECT_CALL(*puller, pull(_, _, _))
     .WillOnce(testing::DoAll(FutureSatisfy(&pull),
                              Return(promise.future())));
 
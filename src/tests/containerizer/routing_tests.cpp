@@ -563,6 +563,46 @@ TEST_F(RoutingVethTest, ROOT_HTBQdisc)
 }
 
 
+TEST_F(RoutingVethTest, ROOT_HTBClass)
+{
+  EXPECT_SOME(link::create(TEST_VETH_LINK, TEST_PEER_LINK, None()));
+
+  EXPECT_SOME_TRUE(link::exists(TEST_VETH_LINK));
+  EXPECT_SOME_TRUE(link::exists(TEST_PEER_LINK));
+
+  const Handle handle = Handle(1, 0);
+  const Handle classid = Handle(handle, 1);
+
+  // Create an htb qdisc to which the class can be attached.
+  EXPECT_SOME_TRUE(htb::create(TEST_VETH_LINK, EGRESS_ROOT, handle));
+
+  // Try to create an htb class on a nonexistent interface.
+  EXPECT_ERROR(htb::cls::create(
+      "noSuchInterface",
+      handle,
+      classid,
+      htb::cls::Config(10000000)));
+
+  // Create an htb class on an existing interface.
+  EXPECT_SOME_TRUE(htb::cls::create(
+      TEST_VETH_LINK,
+      handle,
+      classid,
+      htb::cls::Config(10000000)));
+
+  // Try to create the same htb class again.
+  EXPECT_SOME_FALSE(htb::cls::create(
+      TEST_VETH_LINK,
+      handle,
+      classid,
+      htb::cls::Config(10000000)));
+
+  // Removing the htb qdisc removes the class as well.
+  EXPECT_SOME_TRUE(htb::remove(TEST_VETH_LINK, EGRESS_ROOT));
+  EXPECT_SOME_FALSE(htb::exists(TEST_VETH_LINK, EGRESS_ROOT));
+}
+
+
 TEST_F(RoutingVethTest, ROOT_FqCodeQdisc)
 {
   // Test for a qdisc on a nonexistent interface should fail.
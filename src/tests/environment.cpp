@@ -432,6 +432,39 @@ private:
 };
 
 
+class OverlayFsFilter : public TestFilter
+{
+public:
+  OverlayFsFilter()
+  {
+    hasOverlayFs = false;
+#ifdef __linux__
+    Try<string> filesystems = os::read("/proc/filesystems");
+    if (filesystems.isSome() &&
+        (strings::contains(filesystems.get(), "overlay"))) {
+      hasOverlayFs = true;
+    }
+#endif // __linux__
+    if (!hasOverlayFs) {
+      std::cerr
+        << "-------------------------------------------------------------\n"
+        << "We cannot run any overlayfs tests because the kernel does\n"
+        << "not support the overlay filesystem\n"
+        << "-------------------------------------------------------------"
+        << std::endl;
+    }
+  }
+
+  bool disable(const ::testing::TestInfo* test) const
+  {
+    return matches(test, "OVERLAYFS_") && !hasOverlayFs;
+  }
+
+private:
+  bool hasOverlayFs;
+};
+
+
 class PerfCPUCyclesFilter : public TestFilter
 {
 public:
@@ -613,6 +646,7 @@ Environment::Environment(const Flags& _flags) : flags(_flags)
   filters.push_back(Owned<TestFilter>(new NetcatFilter()));
   filters.push_back(Owned<TestFilter>(new NetClsCgroupsFilter()));
   filters.push_back(Owned<TestFilter>(new NetworkIsolatorTestFilter()));
+  filters.push_back(Owned<TestFilter>(new OverlayFsFilter()));
   filters.push_back(Owned<TestFilter>(new PerfCPUCyclesFilter()));
   filters.push_back(Owned<TestFilter>(new PerfFilter()));
   filters.push_back(Owned<TestFilter>(new RootFilter()));
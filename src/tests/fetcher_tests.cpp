@@ -16,6 +16,8 @@
 
 #include <unistd.h>
 
+#include <sys/stat.h>
+
 #include <map>
 #include <string>
 
@@ -464,6 +466,48 @@ TEST_F(FetcherTest, NoExtractNotExecutable)
 }
 
 
+// Tests that a cached artifact is hardlinked into the sandbox
+// instead of copied when hardlink materialization is enabled.
+TEST_F(FetcherTest, CacheHardlink)
+{
+  // First construct a temporary file that can be fetched.
+  Try<string> path = os::mktemp();
+
+  ASSERT_SOME(path);
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  CommandInfo commandInfo;
+  CommandInfo::URI* uri = commandInfo.add_uris();
+  uri->set_value(path.get());
+  uri->set_executable(false);
+  uri->set_extract(false);
+  uri->set_cache(true);
+
+  slave::Flags flags;
+  flags.launcher_dir = path::join(tests::flags.build_dir, "src");
+  flags.fetcher_cache_dir = path::join(os::getcwd(), "cache");
+  flags.fetcher_cache_hardlinks = true;
+
+  Fetcher fetcher;
+  SlaveID slaveId;
+
+  Future<Nothing> fetch = fetcher.fetch(
+      containerId, commandInfo, os::getcwd(), None(), slaveId, flags);
+  AWAIT_READY(fetch);
+
+  string basename = Path(path.get()).basename();
+
+  // The file in the sandbox and the cached copy share an inode.
+  struct stat s;
+  ASSERT_EQ(0, ::stat(basename.c_str(), &s));
+  EXPECT_EQ(2u, s.st_nlink);
+
+  ASSERT_SOME(os::rm(path.get()));
+}
+
+
 TEST_F(FetcherTest, NoExtractExecutable)
 {
   // First construct a temporary file that can be fetched.
@@ -37,7 +37,10 @@ using process::Future;
 
 using process::http::BadRequest;
 using process::http::NotFound;
+using process::http::NotModified;
 using process::http::OK;
+using process::http::PartialContent;
+using process::http::RequestedRangeNotSatisfiable;
 using process::http::Response;
 
 using std::string;
@@ -134,6 +137,39 @@ TEST_F(FilesTest, ReadTest)
 }
 
 
+TEST_F(FilesTest, ReadFollowTest)
+{
+  Files files;
+  process::UPID upid("files", process::address());
+
+  ASSERT_SOME(os::write("file", "hello"));
+  AWAIT_EXPECT_READY(files.attach("file", "myname"));
+
+  Future<Response> response = process::http::streaming::get(
+      upid, "read", "path=myname&offset=0&follow=1");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  ASSERT_SOME(response.get().reader);
+  process::http::Pipe::Reader reader = response.get().reader.get();
+
+  // The data already in the file gets streamed first.
+  Future<string> data = reader.read();
+  AWAIT_EXPECT_EQ("hello", data);
+
+  // Appended data gets pushed through the stream.
+  Try<int> fd = os::open("file", O_WRONLY | O_APPEND);
+  ASSERT_SOME(fd);
+  ASSERT_SOME(os::write(fd.get(), " world"));
+  os::close(fd.get());
+
+  data = reader.read();
+  AWAIT_EXPECT_EQ(" world", data);
+
+  EXPECT_TRUE(reader.close());
+}
+
+
 TEST_F(FilesTest, ResolveTest)
 {
   Files files;
@@ -297,6 +333,82 @@ TEST_F(FilesTest, DownloadTest)
   AWAIT_EXPECT_RESPONSE_BODY_EQ(data, response);
 }
 
+
+TEST_F(FilesTest, DownloadRangeTest)
+{
+  Files files;
+  process::UPID upid("files", process::address());
+
+  ASSERT_SOME(os::write("file", "0123456789"));
+  AWAIT_EXPECT_READY(files.attach("file", "myname"));
+
+  process::http::Headers headers;
+  headers["Range"] = "bytes=2-5";
+
+  Future<Response> response =
+    process::http::get(upid, "download", "path=myname", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(PartialContent().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ("bytes 2-5/10", "Content-Range", response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("2345", response);
+
+  // An open-ended range runs to the end of the file.
+  headers["Range"] = "bytes=7-";
+
+  response = process::http::get(upid, "download", "path=myname", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(PartialContent().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ("bytes 7-9/10", "Content-Range", response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("789", response);
+
+  // A range starting past the end of the file cannot be satisfied.
+  headers["Range"] = "bytes=100-";
+
+  response = process::http::get(upid, "download", "path=myname", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      RequestedRangeNotSatisfiable().status, response);
+
+  // Unsupported range formats are ignored and the whole file served.
+  headers["Range"] = "bytes=-5";
+
+  response = process::http::get(upid, "download", "path=myname", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("0123456789", response);
+}
+
+
+TEST_F(FilesTest, ConditionalTest)
+{
+  Files files;
+  process::UPID upid("files", process::address());
+
+  ASSERT_SOME(os::write("file", "body"));
+  AWAIT_EXPECT_READY(files.attach("file", "myname"));
+
+  Future<Response> response =
+    process::http::get(upid, "download", "path=myname");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Option<string> lastModified = response.get().headers.get("Last-Modified");
+  ASSERT_SOME(lastModified);
+
+  process::http::Headers headers;
+  headers["If-Modified-Since"] = lastModified.get();
+
+  // The file has not been modified since.
+  response = process::http::get(upid, "download", "path=myname", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(NotModified().status, response);
+
+  // The read endpoint answers conditional requests as well.
+  response = process::http::get(upid, "read", "path=myname&offset=0", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(NotModified().status, response);
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <string>
@@ -137,11 +138,12 @@ protected:
       const master::Flags& _flags = master::Flags(),
       Option<lambda::function<
           void(const FrameworkID&,
-               const hashmap<SlaveID, Resources>&)>> offerCallback = None(),
+               hashmap<SlaveID, Resources>)>> offerCallback = None(),
       Option<lambda::function<
           void(const FrameworkID&,
                const hashmap<SlaveID, UnavailableResources>&)>>
-                 inverseOfferCallback = None())
+                 inverseOfferCallback = None(),
+      const hashmap<string, double>& weights = hashmap<string, double>())
   {
     flags = _flags;
 
@@ -173,7 +175,7 @@ protected:
         flags.allocation_interval,
         offerCallback.get(),
         inverseOfferCallback.get(),
-        hashmap<string, double>());
+        weights);
   }
 
   SlaveInfo createSlaveInfo(const string& resources)
@@ -2293,6 +2295,166 @@ TEST_F(HierarchicalAllocator_BENCHMARK_Test, DeclineOffers)
   Clock::resume();
 }
 
+
+class HierarchicalAllocatorCluster_BENCHMARK_Test
+  : public HierarchicalAllocatorTestBase,
+    public WithParamInterface<
+        std::tr1::tuple<size_t, size_t, size_t, size_t>> {};
+
+
+// The synthetic cluster benchmarks are parameterized by the number
+// of slaves, the number of frameworks, the number of (weighted)
+// roles the frameworks are spread over, and the percentage of
+// frameworks that permanently decline the offers they receive.
+INSTANTIATE_TEST_CASE_P(
+    SyntheticCluster,
+    HierarchicalAllocatorCluster_BENCHMARK_Test,
+    ::testing::Combine(
+        ::testing::Values(1000U, 5000U, 20000U),
+        ::testing::Values(50U, 500U),
+        ::testing::Values(1U, 10U),
+        ::testing::Values(0U, 50U, 100U)));
+
+
+// This benchmark generates a synthetic cluster with the parameterized
+// shape, drives a fixed number of allocation cycles against it, and
+// reports the cycle latency distribution, which is what we compare
+// across allocator changes.
+TEST_P(HierarchicalAllocatorCluster_BENCHMARK_Test, AllocationCycle)
+{
+  size_t slaveCount = std::tr1::get<0>(GetParam());
+  size_t frameworkCount = std::tr1::get<1>(GetParam());
+  size_t roleCount = std::tr1::get<2>(GetParam());
+  size_t declinePercent = std::tr1::get<3>(GetParam());
+
+  master::Flags flags;
+
+  // Choose an interval longer than the time we expect a single cycle to take so
+  // that we don't back up the process queue.
+  flags.allocation_interval = Hours(1);
+
+  // Pause the clock because we want to manually drive the allocations.
+  Clock::pause();
+
+  struct OfferedResources {
+    FrameworkID   frameworkId;
+    SlaveID       slaveId;
+    Resources     resources;
+  };
+
+  std::vector<OfferedResources> offers;
+
+  auto offerCallback = [&offers](
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources_)
+  {
+    for (auto resources : resources_) {
+      offers.push_back(
+          OfferedResources{frameworkId, resources.first, resources.second});
+    }
+  };
+
+  cout << "Using " << slaveCount << " slaves and "
+       << frameworkCount << " frameworks"
+       << " in " << roleCount << " roles"
+       << " with " << declinePercent << "% declining" << endl;
+
+  // Give the roles distinct weights.
+  hashmap<string, double> weights;
+  for (size_t i = 0; i < roleCount; i++) {
+    weights["role" + stringify(i)] = static_cast<double>(i + 1);
+  }
+
+  initialize(flags, offerCallback, None(), weights);
+
+  vector<FrameworkInfo> frameworks;
+  frameworks.reserve(frameworkCount);
+
+  // Remember each framework's position so that the decliners are
+  // spread deterministically across roles.
+  hashmap<FrameworkID, size_t> indices;
+
+  for (size_t i = 0; i < frameworkCount; i++) {
+    frameworks.push_back(
+        createFrameworkInfo("role" + stringify(i % roleCount)));
+    indices[frameworks[i].id()] = i;
+    allocator->addFramework(frameworks[i].id(), frameworks[i], {});
+  }
+
+  vector<SlaveInfo> slaves;
+  slaves.reserve(slaveCount);
+
+  // Add the slaves with a chunk of each slave's resources already in
+  // use by some framework, as in a running cluster.
+  Resources used = Resources::parse("cpus:8;mem:2048;disk:1024").get();
+
+  for (size_t i = 0; i < slaveCount; i++) {
+    slaves.push_back(createSlaveInfo(
+        "cpus:24;mem:4096;disk:4096;ports:[31000-32000]"));
+
+    hashmap<FrameworkID, Resources> used_;
+    used_[frameworks[i % frameworkCount].id()] = used;
+
+    allocator->addSlave(
+        slaves[i].id(), slaves[i], None(), slaves[i].resources(), used_);
+  }
+
+  // Wait for all the 'addSlave' operations to be processed.
+  Clock::settle();
+
+  // Drive the allocation cycles. Between cycles each framework
+  // either permanently declines what it was offered (the configured
+  // percentage of frameworks) or returns it without a filter.
+  const size_t cycles = 10;
+
+  vector<Duration> latencies;
+  latencies.reserve(cycles);
+
+  for (size_t cycle = 0; cycle < cycles; cycle++) {
+    for (auto offer : offers) {
+      if (indices[offer.frameworkId] % 100 < declinePercent) {
+        Filters filters;
+        filters.set_refuse_seconds(INT_MAX);
+
+        allocator->recoverResources(
+            offer.frameworkId, offer.slaveId, offer.resources, filters);
+      } else {
+        allocator->recoverResources(
+            offer.frameworkId, offer.slaveId, offer.resources, None());
+      }
+    }
+
+    // Wait for the recoveries to be processed.
+    Clock::settle();
+    offers.clear();
+
+    Stopwatch watch;
+    watch.start();
+
+    // Advance the clock and trigger a background allocation cycle.
+    Clock::advance(flags.allocation_interval);
+    Clock::settle();
+
+    latencies.push_back(watch.elapsed());
+
+    cout << "cycle " << cycle
+         << " allocate took " << latencies.back()
+         << " to make " << offers.size() << " offers"
+         << endl;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  cout << "allocation cycle latency:"
+       << " min " << latencies.front()
+       << " p50 " << latencies[latencies.size() / 2]
+       << " p90 " << latencies[(9 * latencies.size()) / 10]
+       << " max " << latencies.back()
+       << endl;
+
+  Clock::resume();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -0,0 +1,103 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <list>
+
+#include <gmock/gmock.h>
+
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+#include <process/owned.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+
+#include "slave/io_scheduler.hpp"
+
+using process::Future;
+using process::Owned;
+using process::Promise;
+
+using std::list;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+
+// The result of scheduled work is propagated through the returned
+// future, for successes and failures alike.
+TEST(IOSchedulerTest, Schedule)
+{
+  slave::IOScheduler* scheduler = slave::IOScheduler::instance();
+
+  Future<Nothing> success = scheduler->schedule<Nothing>(
+      slave::IOScheduler::GC,
+      []() -> Future<Nothing> { return Nothing(); });
+
+  AWAIT_READY(success);
+
+  Future<Nothing> failure = scheduler->schedule<Nothing>(
+      slave::IOScheduler::GC,
+      []() -> Future<Nothing> { return process::Failure("failed"); });
+
+  AWAIT_FAILED(failure);
+}
+
+
+// The shared pool bounds the number of operations in flight: work
+// submitted beyond the pool size is not started until earlier work
+// completes.
+TEST(IOSchedulerTest, Concurrency)
+{
+  slave::IOScheduler* scheduler = slave::IOScheduler::instance();
+
+  // More work than the pool admits; each blocks on its own promise.
+  // The bursts configured for the MONITOR class exceed the pool
+  // size, so admission here is bounded by the pool alone.
+  list<Owned<Promise<Nothing>>> promises;
+  list<Future<Nothing>> futures;
+
+  for (size_t i = 0; i < slave::IO_SCHEDULER_CONCURRENCY + 1; i++) {
+    promises.push_back(Owned<Promise<Nothing>>(new Promise<Nothing>()));
+
+    Owned<Promise<Nothing>> promise = promises.back();
+
+    futures.push_back(scheduler->schedule<Nothing>(
+        slave::IOScheduler::MONITOR,
+        [promise]() { return promise->future(); }));
+  }
+
+  // Completing one operation admits the queued one.
+  promises.front()->set(Nothing());
+  promises.pop_front();
+
+  AWAIT_READY(futures.front());
+  futures.pop_front();
+
+  foreach (const Owned<Promise<Nothing>>& promise, promises) {
+    promise->set(Nothing());
+  }
+
+  foreach (const Future<Nothing>& future, futures) {
+    AWAIT_READY(future);
+  }
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
@@ -316,6 +316,54 @@ TYPED_TEST(LogStorageTest, TruncateWithManyHoles)
 }
 
 
+// Tests that large entries, which the storage transparently
+// compresses on disk, survive a persist/read/restore round trip
+// unchanged.
+TYPED_TEST(LogStorageTest, CompressedRoundTrip)
+{
+  // A highly repetitive payload, similar to a registry snapshot.
+  string bytes;
+  for (size_t i = 0; i < 1000; i++) {
+    bytes += "slave" + stringify(i % 10) + ";cpus:4;mem:4096;";
+  }
+
+  {
+    TypeParam storage;
+
+    Try<Storage::State> state = storage.restore(os::getcwd() + "/.log");
+    ASSERT_SOME(state);
+
+    Action action;
+    action.set_position(1);
+    action.set_promised(1);
+    action.set_performed(1);
+    action.set_learned(true);
+    action.set_type(Action::APPEND);
+    action.mutable_append()->set_bytes(bytes);
+
+    ASSERT_SOME(storage.persist(action));
+
+    Try<Action> read = storage.read(1);
+    ASSERT_SOME(read);
+    EXPECT_EQ(bytes, read.get().append().bytes());
+  }
+
+  // Restore the storage from disk and read the entry again.
+  {
+    TypeParam storage;
+
+    Try<Storage::State> state = storage.restore(os::getcwd() + "/.log");
+    ASSERT_SOME(state);
+
+    EXPECT_EQ(1u, state.get().end);
+
+    Try<Action> read = storage.read(1);
+    ASSERT_SOME(read);
+    EXPECT_EQ(bytes, read.get().append().bytes());
+  }
+}
+
+
 class ReplicaTest : public TemporaryDirectoryTest
 {
 protected:
@@ -16,7 +16,10 @@
 
 #include <unistd.h>
 
+#include <deque>
+#include <iostream>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -24,6 +27,7 @@
 
 #include <mesos/executor.hpp>
 #include <mesos/scheduler.hpp>
+#include <mesos/version.hpp>
 
 #include <mesos/master/allocator.hpp>
 
@@ -33,23 +37,32 @@
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/http.hpp>
+#include <process/owned.hpp>
 #include <process/pid.hpp>
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/metrics.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/json.hpp>
 #include <stout/net.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/recordio.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 
 #include "common/build.hpp"
+#include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
 
+#include "log/log.hpp"
+
 #include "master/flags.hpp"
 #include "master/master.hpp"
+#include "master/registrar.hpp"
 
 #include "master/allocator/mesos/allocator.hpp"
 
@@ -60,6 +73,9 @@
 
 #include "slave/containerizer/mesos/containerizer.hpp"
 
+#include "state/log.hpp"
+#include "state/protobuf.hpp"
+
 #include "tests/containerizer.hpp"
 #include "tests/limiter.hpp"
 #include "tests/mesos.hpp"
@@ -84,6 +100,8 @@ using process::Promise;
 using process::http::OK;
 using process::http::Response;
 
+using std::cout;
+using std::endl;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -1513,6 +1531,143 @@ TEST_F(MasterTest, LaunchDuplicateOfferTest)
 }
 
 
+// This test verifies that a task carrying a template id together
+// with an ExecutorInfo registers the template, and that a subsequent
+// task carrying only the template id and its per-instance fields is
+// expanded from the template and launched.
+TEST_F(MasterTest, LaunchTaskTemplate)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Try<PID<Slave>> slave = StartSlave(&containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+    &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  Resources resources = Resources::parse("cpus:0.1;mem:32").get();
+
+  // This task defines the template.
+  TaskInfo task1 = createTask(
+      offers.get()[0].slave_id(), resources, "", DEFAULT_EXECUTOR_ID);
+  task1.set_template_id("sleeper");
+
+  // This task carries only the template id and its per-instance
+  // fields; the executor is filled in by the master.
+  TaskInfo task2;
+  task2.set_name("test-task");
+  task2.mutable_task_id()->set_value("instance");
+  task2.mutable_slave_id()->CopyFrom(offers.get()[0].slave_id());
+  task2.mutable_resources()->CopyFrom(resources);
+  task2.set_template_id("sleeper");
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Future<TaskInfo> launched1;
+  Future<TaskInfo> launched2;
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(DoAll(FutureArg<1>(&launched1),
+                    SendStatusUpdateFromTask(TASK_RUNNING)))
+    .WillOnce(DoAll(FutureArg<1>(&launched2),
+                    SendStatusUpdateFromTask(TASK_RUNNING)));
+
+  Future<TaskStatus> status1;
+  Future<TaskStatus> status2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  driver.launchTasks(offers.get()[0].id(), {task1, task2});
+
+  AWAIT_READY(status1);
+  EXPECT_EQ(TASK_RUNNING, status1.get().state());
+
+  AWAIT_READY(status2);
+  EXPECT_EQ(TASK_RUNNING, status2.get().state());
+
+  // The second task should have been expanded from the template.
+  AWAIT_READY(launched2);
+  ASSERT_TRUE(launched2.get().has_executor());
+  EXPECT_EQ(
+      DEFAULT_EXECUTOR_ID, launched2.get().executor().executor_id());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown(); // Must shutdown before 'containerizer' gets deallocated.
+}
+
+
+// This test verifies that a task referencing a template that has not
+// been registered is dropped with a TASK_ERROR.
+TEST_F(MasterTest, LaunchTaskTemplateUnknown)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Try<PID<Slave>> slave = StartSlave();
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+    &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task;
+  task.set_name("test-task");
+  task.mutable_task_id()->set_value("instance");
+  task.mutable_slave_id()->CopyFrom(offers.get()[0].slave_id());
+  task.mutable_resources()->CopyFrom(offers.get()[0].resources());
+  task.set_template_id("unknown");
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_ERROR, status.get().state());
+  EXPECT_EQ(TaskStatus::REASON_TASK_INVALID, status.get().reason());
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
 // TODO(vinod): These tests only verify that the master metrics exist
 // but we need tests that verify that these metrics are updated.
 TEST_F(MasterTest, MetricsInMetricsEndpoint)
@@ -1623,6 +1778,30 @@ TEST_F(MasterTest, MetricsInMetricsEndpoint)
 }
 
 
+// Verifies that the '/ready' endpoint, which is served outside of
+// the master actor, reports 200 once the master is elected and has
+// recovered the registry.
+TEST_F(MasterTest, ReadyEndpoint)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  // Ensure the election and the registry recovery have been
+  // processed before probing.
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  process::UPID ready("ready", master.get().address);
+
+  Future<Response> response = process::http::get(ready, None());
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Shutdown();
+}
+
+
 // Ensures that an empty response arrives if information about
 // registered slaves is requested from a master where no slaves
 // have been registered.
@@ -1696,6 +1875,54 @@ TEST_F(MasterTest, SlavesEndpointTwoSlaves)
 }
 
 
+// Ensures that the 'attribute' query parameter of /master/slaves
+// returns only the slaves with the given attribute, resolved via the
+// master's attribute index.
+TEST_F(MasterTest, SlavesEndpointAttributeFilter)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), master.get(), _);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.attributes = "rack:r1";
+
+  Try<PID<Slave>> slave = StartSlave(flags);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  // Query with a matching attribute.
+  Future<Response> response =
+    process::http::get(master.get(), "slaves", "attribute=rack:r1");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  Result<JSON::Array> array = parse.get().find<JSON::Array>("slaves");
+  ASSERT_SOME(array);
+  EXPECT_EQ(1u, array.get().values.size());
+
+  // Query with a non-matching attribute.
+  response = process::http::get(master.get(), "slaves", "attribute=rack:r2");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response.get().body);
+  ASSERT_SOME(parse);
+
+  array = parse.get().find<JSON::Array>("slaves");
+  ASSERT_SOME(array);
+  EXPECT_EQ(0u, array.get().values.size());
+
+  Shutdown();
+}
+
+
 // This test ensures that when a slave is recovered from the registry
 // but does not re-register with the master, it is removed from the
 // registry and the framework is informed that the slave is lost, and
@@ -2900,6 +3127,40 @@ TEST_F(MasterTest, StateEndpoint)
 }
 
 
+// This test verifies that the master's binary state snapshot
+// endpoint serves a decodable RecordIO stream of snapshot records,
+// starting with a record describing the master itself.
+TEST_F(MasterTest, StateRecordioEndpoint)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<Response> response =
+    process::http::get(master.get(), "state.recordio");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      stringify(ContentType::PROTOBUF), "Content-Type", response);
+
+  ::recordio::Decoder<StateSnapshotRecord> decoder(
+      [](const string& data) {
+        return deserialize<StateSnapshotRecord>(ContentType::PROTOBUF, data);
+      });
+
+  Try<std::deque<Try<StateSnapshotRecord>>> records =
+    decoder.decode(response.get().body);
+
+  ASSERT_SOME(records);
+  ASSERT_FALSE(records.get().empty());
+
+  ASSERT_SOME(records.get().front());
+  ASSERT_TRUE(records.get().front().get().has_master());
+  EXPECT_NE("", records.get().front().get().master().id());
+
+  Shutdown();
+}
+
+
 TEST_F(MasterTest, StateSummaryEndpoint)
 {
   master::Flags flags = CreateMasterFlags();
@@ -3002,6 +3263,94 @@ TEST_F(MasterTest, StateSummaryEndpoint)
 }
 
 
+// This test ensures that the query filters of the master's /tasks
+// endpoint only return the matching tasks.
+TEST_F(MasterTest, TasksEndpointQueryFilters)
+{
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  Try<PID<Slave>> slave = StartSlave(&exec);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  FrameworkID frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(SaveArg<1>(&frameworkId));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task;
+  task.set_name("test-task");
+  task.mutable_task_id()->set_value("1");
+  task.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task.mutable_resources()->MergeFrom(offers.get()[0].resources());
+  task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .Times(1);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  // Helper to query /tasks and return the number of tasks returned.
+  auto count = [&master](const string& query) -> size_t {
+    Future<Response> response =
+      process::http::get(master.get(), "tasks", query);
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+    CHECK_SOME(parse);
+
+    CHECK(parse.get().values["tasks"].is<JSON::Array>());
+    return parse.get().values["tasks"].as<JSON::Array>().values.size();
+  };
+
+  EXPECT_EQ(1u, count("state=TASK_RUNNING"));
+  EXPECT_EQ(0u, count("state=TASK_FINISHED"));
+
+  EXPECT_EQ(1u, count("framework_id=" + frameworkId.value()));
+  EXPECT_EQ(0u, count("framework_id=unknown"));
+
+  EXPECT_EQ(1u, count("slave_id=" + offers.get()[0].slave_id().value()));
+  EXPECT_EQ(0u, count("slave_id=unknown"));
+
+  EXPECT_EQ(1u, count("name_prefix=test"));
+  EXPECT_EQ(0u, count("name_prefix=other"));
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
 // This test ensures that the web UI and capabilities of a framework
 // are included in the master's state endpoint, if provided by the
 // framework.
@@ -4088,6 +4437,241 @@ TEST_F(MasterTest, MaxCompletedTasksPerFrameworkFlag)
   }
 }
 
+
+class MasterFailover_BENCHMARK_Test
+  : public MesosTest,
+    public ::testing::WithParamInterface<size_t> {};
+
+
+// The master failover benchmark is parameterized by the number of
+// agents in the registry.
+INSTANTIATE_TEST_CASE_P(
+    SlaveCount,
+    MasterFailover_BENCHMARK_Test,
+    ::testing::Values(1000U, 5000U, 10000U));
+
+
+// This benchmark simulates a master failover: the registry is
+// populated with a number of agents, a new master is started, and
+// once it has recovered the registry all the agents re-register at
+// once. We report the failover phase timings exposed by the master's
+// metrics, which break the failover into registry recovery and agent
+// re-registration.
+TEST_P(MasterFailover_BENCHMARK_Test, AgentReregistrationStorm)
+{
+  size_t slaveCount = GetParam();
+
+  master::Flags masterFlags = CreateMasterFlags();
+
+  // The fake agents below are bare libprocess PIDs, so they cannot
+  // authenticate.
+  masterFlags.authenticate_slaves = false;
+
+  cout << "Using " << slaveCount << " agents" << endl;
+
+  vector<SlaveInfo> infos;
+  infos.reserve(slaveCount);
+
+  Resources resources =
+    Resources::parse("cpus(*):4.0;mem(*):4096;disk(*):16384").get();
+
+  for (size_t i = 0; i < slaveCount; i++) {
+    // Simulate real agent information.
+    SlaveInfo info;
+    info.set_hostname("slave" + stringify(i));
+    info.mutable_id()->set_value(
+        "20150101-000000-16777343-5050-12345-" + stringify(i));
+    info.mutable_resources()->MergeFrom(resources);
+    infos.push_back(info);
+  }
+
+  // Populate the registry with the agents, as if they had registered
+  // with a previous master, by writing directly to the replicated
+  // log that the new master will recover from.
+  {
+    log::Log log(
+        1,
+        path::join(masterFlags.work_dir.get(), "replicated_log"),
+        std::set<process::UPID>(),
+        masterFlags.log_auto_initialize);
+
+    state::LogStorage storage(&log);
+    state::protobuf::State state(&storage);
+    master::Registrar registrar(masterFlags, &state);
+
+    MasterInfo masterInfo;
+    masterInfo.set_id("master");
+    masterInfo.set_ip(10000000);
+    masterInfo.set_port(5050);
+
+    AWAIT_READY(registrar.recover(masterInfo));
+
+    Future<bool> admit;
+    foreach (const SlaveInfo& info, infos) {
+      admit = registrar.apply(
+          process::Owned<master::Operation>(new master::AdmitSlave(info)));
+    }
+    AWAIT_READY_FOR(admit, Minutes(5));
+  }
+
+  // Start the new master and wait for it to recover the registry.
+  Stopwatch watch;
+  watch.start();
+
+  Try<PID<Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  JSON::Object metrics = Metrics();
+  while (metrics.values.count("master/failover_registry_recovery_ms") == 0) {
+    os::sleep(Milliseconds(10));
+    metrics = Metrics();
+  }
+
+  cout << "Recovered " << slaveCount << " agents from the registry in "
+       << watch.elapsed() << endl;
+
+  // Now re-register all the agents at once, each from its own fake
+  // agent PID, and wait for the re-registration storm to drain.
+  watch.start(); // Reset.
+
+  for (size_t i = 0; i < slaveCount; i++) {
+    ReregisterSlaveMessage message;
+    message.mutable_slave()->CopyFrom(infos[i]);
+    message.set_version(MESOS_VERSION);
+
+    process::UPID pid("fake-slave" + stringify(i), process::address());
+
+    process::post(pid, master.get(), message);
+  }
+
+  metrics = Metrics();
+  while (
+      metrics.values.count("master/failover_slave_reregistration_ms") == 0) {
+    os::sleep(Milliseconds(10));
+    metrics = Metrics();
+  }
+
+  cout << "Re-registered " << slaveCount << " agents in "
+       << watch.elapsed() << endl;
+
+  cout << "master/failover_registry_recovery_ms: "
+       << metrics.values["master/failover_registry_recovery_ms"] << endl;
+  cout << "master/failover_slave_reregistration_ms: "
+       << metrics.values["master/failover_slave_reregistration_ms"] << endl;
+
+  Stop(master.get());
+}
+
+
+class MasterPipeline_BENCHMARK_Test
+  : public MesosTest,
+    public ::testing::WithParamInterface<size_t> {};
+
+
+// The message pipeline benchmark is parameterized by the number of
+// messages to replay.
+INSTANTIATE_TEST_CASE_P(
+    MessageCount,
+    MasterPipeline_BENCHMARK_Test,
+    ::testing::Values(10000U, 50000U));
+
+
+// This benchmark replays a trace of serialized messages directly
+// into the master's message pipeline, as they would appear on the
+// wire, and reports the sustained processing rate along with the
+// mailbox age sampled while the backlog drains. It exercises message
+// parsing and handler dispatch without scheduler or agent overhead,
+// and serves as a regression gate for master message throughput.
+TEST_P(MasterPipeline_BENCHMARK_Test, ReplaySerializedTrace)
+{
+  size_t messageCount = GetParam();
+
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), master.get(), _);
+
+  Try<PID<Slave>> slave = StartSlave();
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  const SlaveID slaveId = slaveRegisteredMessage.get().slave_id();
+
+  // The trace consists of agent oversubscription updates, which are
+  // parsed and handled entirely within the master. Each entry is the
+  // serialized body together with the message name, i.e., exactly
+  // what a capture of the wire traffic contains.
+  UpdateSlaveMessage message;
+  message.mutable_slave_id()->CopyFrom(slaveId);
+  message.mutable_oversubscribed_resources()->CopyFrom(
+      createRevocableResources("cpus", "1"));
+
+  const string name = message.GetTypeName();
+
+  string body;
+  ASSERT_TRUE(message.SerializeToString(&body));
+
+  process::UPID from("fake-slave", process::address());
+
+  cout << "Replaying " << messageCount << " messages" << endl;
+
+  JSON::Object metrics = Metrics();
+
+  double baseline = metrics.values["master/messages_update_slave"]
+    .as<JSON::Number>().as<double>();
+
+  double maxAge = 0.0;
+
+  Stopwatch watch;
+  watch.start();
+
+  // Replay in bursts, sampling the mailbox age after each burst so
+  // we observe how far the master falls behind at this rate.
+  size_t replayed = 0;
+  while (replayed < messageCount) {
+    size_t burst = messageCount - replayed;
+    if (burst > 1000) {
+      burst = 1000;
+    }
+
+    for (size_t i = 0; i < burst; i++) {
+      process::post(from, master.get(), name, body.data(), body.size());
+    }
+
+    replayed += burst;
+
+    metrics = Metrics();
+
+    if (metrics.values.count("libprocess/event_queue/age_ms") > 0) {
+      double age = metrics.values["libprocess/event_queue/age_ms"]
+        .as<JSON::Number>().as<double>();
+
+      if (age > maxAge) {
+        maxAge = age;
+      }
+    }
+  }
+
+  // Wait for the master to drain the backlog.
+  double processed = 0;
+  do {
+    os::sleep(Milliseconds(1));
+    metrics = Metrics();
+    processed = metrics.values["master/messages_update_slave"]
+      .as<JSON::Number>().as<double>() - baseline;
+  } while (processed < messageCount);
+
+  Duration elapsed = watch.elapsed();
+
+  cout << "Processed " << messageCount << " messages in " << elapsed
+       << " (" << (messageCount / elapsed.secs()) << " messages/s)" << endl;
+  cout << "Max sampled mailbox age: " << maxAge << " ms" << endl;
+
+  Shutdown();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -1190,6 +1190,44 @@ TEST_F(TaskValidationTest, TaskAndExecutorUseRevocableResources)
 }
 
 
+// This test verifies that the memoized resource validation agrees
+// with the uncached validation, both for repeated identical tasks
+// and after the task's resources change.
+TEST_F(TaskValidationTest, CachedResourceValidation)
+{
+  TaskInfo task;
+  task.set_name("");
+  task.mutable_task_id()->set_value("task");
+  task.mutable_slave_id()->set_value("slave");
+
+  Resource cpus;
+  cpus.set_name("cpus");
+  cpus.set_type(Value::SCALAR);
+  cpus.mutable_scalar()->set_value(2);
+
+  task.add_resources()->CopyFrom(cpus);
+
+  // Repeated validations of an identical task (the second of which
+  // is served from the cache) both succeed.
+  EXPECT_NONE(task::internal::validateResourcesCached(task));
+  EXPECT_NONE(task::internal::validateResourcesCached(task));
+
+  // Changing the resources must not hit the stale cache entry: a
+  // task mixing revocable and non-revocable cpus is invalid.
+  Resource revocableCpus = cpus;
+  revocableCpus.mutable_revocable();
+  task.add_resources()->CopyFrom(revocableCpus);
+
+  EXPECT_SOME(task::internal::validateResourcesCached(task));
+  EXPECT_SOME(task::internal::validateResourcesCached(task));
+
+  // A distinct task ID with the same resources shares the cached
+  // result.
+  task.mutable_task_id()->set_value("task2");
+  EXPECT_SOME(task::internal::validateResourcesCached(task));
+}
+
+
 // TODO(jieyu): Add tests for checking duplicated persistence ID
 // against offered resources.
 
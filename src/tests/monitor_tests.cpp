@@ -22,6 +22,7 @@
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
 
+#include <process/clock.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/gtest.hpp>
@@ -170,6 +171,39 @@ TEST(MonitorTest, MissingStatistics)
 }
 
 
+// This test verifies that requests arriving while a statistics
+// snapshot is still fresh are served from the cached snapshot
+// without collecting resource usage again.
+TEST(MonitorTest, CachedStatistics)
+{
+  Clock::pause();
+
+  int collections = 0;
+
+  ResourceMonitor monitor([&collections]() -> Future<ResourceUsage> {
+    collections++;
+    return ResourceUsage();
+  });
+
+  UPID upid("monitor", process::address());
+
+  Future<http::Response> response = http::get(upid, "statistics");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("[]", response);
+
+  // The clock is paused so the snapshot cannot expire.
+  response = http::get(upid, "statistics");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("[]", response);
+
+  EXPECT_EQ(1, collections);
+
+  Clock::resume();
+}
+
+
 class MonitorIntegrationTest : public MesosTest {};
 
 
@@ -216,6 +216,59 @@ TEST_F(PathsTest, Task)
 }
 
 
+// The cached per-run paths must match the corresponding helpers.
+TEST_F(PathsTest, RunPaths)
+{
+  const paths::RunPaths runPaths(
+      rootDir, slaveId, frameworkId, executorId, containerId);
+
+  EXPECT_EQ(
+      paths::getExecutorRunPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      runPaths.getExecutorRunPath());
+
+  EXPECT_EQ(
+      paths::getExecutorHttpMarkerPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      runPaths.getExecutorHttpMarkerPath());
+
+  EXPECT_EQ(
+      paths::getExecutorSentinelPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      runPaths.getExecutorSentinelPath());
+
+  EXPECT_EQ(
+      paths::getLibprocessPidPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      runPaths.getLibprocessPidPath());
+
+  EXPECT_EQ(
+      paths::getForkedPidPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      runPaths.getForkedPidPath());
+
+  EXPECT_EQ(
+      paths::getTaskInfosPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      runPaths.getTaskInfosPath());
+
+  EXPECT_EQ(
+      paths::getTaskPath(
+          rootDir, slaveId, frameworkId, executorId, containerId, taskId),
+      runPaths.getTaskPath(taskId));
+
+  EXPECT_EQ(
+      paths::getTaskInfoPath(
+          rootDir, slaveId, frameworkId, executorId, containerId, taskId),
+      runPaths.getTaskInfoPath(taskId));
+
+  EXPECT_EQ(
+      paths::getTaskUpdatesPath(
+          rootDir, slaveId, frameworkId, executorId, containerId, taskId),
+      runPaths.getTaskUpdatesPath(taskId));
+}
+
+
 TEST_F(PathsTest, PersistentVolume)
 {
   string dir = path::join(rootDir, "volumes", "roles", role, persistenceId);
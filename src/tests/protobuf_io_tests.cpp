@@ -161,6 +161,63 @@ TEST_F(ProtobufIOTest, RepeatedPtrField)
   }
 }
 
+#ifndef __WINDOWS__
+// Verifies that reading protobufs out of a memory mapped file (which
+// is what the path based read does under the covers) yields the same
+// messages that were written, both for a single message and for a
+// repeated field, and that a truncated record is detected.
+TEST_F(ProtobufIOTest, MappedRegion)
+{
+  const string file = ".protobuf_io_test_mapped_region";
+
+  const size_t writes = 10;
+  for (size_t i = 0; i < writes; i++) {
+    FrameworkID frameworkId;
+    frameworkId.set_value(stringify(i));
+
+    Try<Nothing> result = ::protobuf::append(file, frameworkId);
+    ASSERT_SOME(result);
+  }
+
+  Try<os::MappedRegion> region = os::mmap(file);
+  ASSERT_SOME(region);
+
+  // A single message read returns the first record.
+  Result<FrameworkID> single = ::protobuf::read<FrameworkID>(region.get());
+  ASSERT_SOME(single);
+  EXPECT_EQ("0", single.get().value());
+
+  Result<RepeatedPtrField<FrameworkID>> read =
+    ::protobuf::read<RepeatedPtrField<FrameworkID>>(region.get());
+  ASSERT_SOME(read);
+
+  RepeatedPtrField<FrameworkID> actual = read.get();
+
+  ASSERT_EQ(static_cast<int>(writes), actual.size());
+  for (size_t i = 0; i < writes; i++) {
+    EXPECT_EQ(stringify(i), actual.Get(i).value());
+  }
+
+  // Truncate the last record and expect the partial record to be
+  // detected (or ignored, when requested).
+  Try<string> data = os::read(file);
+  ASSERT_SOME(data);
+
+  const string truncated = file + ".truncated";
+  ASSERT_SOME(os::write(truncated, data.get().substr(0, data.get().size() - 1)));
+
+  Try<os::MappedRegion> partial = os::mmap(truncated);
+  ASSERT_SOME(partial);
+
+  read = ::protobuf::read<RepeatedPtrField<FrameworkID>>(partial.get());
+  EXPECT_ERROR(read);
+
+  read = ::protobuf::read<RepeatedPtrField<FrameworkID>>(partial.get(), true);
+  ASSERT_SOME(read);
+  EXPECT_EQ(static_cast<int>(writes) - 1, read.get().size());
+}
+#endif // __WINDOWS__
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -283,6 +283,11 @@ TEST_F(RoleTest, EndpointEmpty)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
       "    }"
       "  ]"
@@ -328,6 +333,11 @@ TEST_F(RoleTest, EndpointNoFrameworks)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
       "    },"
       "    {"
@@ -338,6 +348,11 @@ TEST_F(RoleTest, EndpointNoFrameworks)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 5.0"
       "    },"
       "    {"
@@ -348,6 +363,11 @@ TEST_F(RoleTest, EndpointNoFrameworks)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
       "    }"
       "  ]"
@@ -421,6 +441,11 @@ TEST_F(RoleTest, EndpointImplicitRolesWeights)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
       "    },"
       "    {"
@@ -431,6 +456,11 @@ TEST_F(RoleTest, EndpointImplicitRolesWeights)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 5.0"
       "    },"
       "    {"
@@ -441,6 +471,11 @@ TEST_F(RoleTest, EndpointImplicitRolesWeights)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 4.0"
       "    },"
       "    {"
@@ -451,6 +486,11 @@ TEST_F(RoleTest, EndpointImplicitRolesWeights)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
       "    }"
       "  ]"
@@ -520,6 +560,11 @@ TEST_F(RoleTest, EndpointImplicitRolesQuotas)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
       "    },"
       "    {"
@@ -530,6 +575,11 @@ TEST_F(RoleTest, EndpointImplicitRolesQuotas)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
       "    }"
       "  ]"
@@ -570,7 +620,93 @@ TEST_F(RoleTest, EndpointImplicitRolesQuotas)
       "        \"disk\": 0,"
       "        \"mem\":  0"
       "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
+      "      \"weight\": 1.0"
+      "    }"
+      "  ]"
+      "}");
+
+  ASSERT_SOME(expected);
+  EXPECT_EQ(expected.get(), parse.get());
+
+  Shutdown();
+}
+
+
+// This test checks that the "/roles" endpoint includes the ancestors
+// of hierarchical role names (which encode the hierarchy with '/'),
+// along with the subtree resource rollups.
+TEST_F(RoleTest, EndpointHierarchicalRoles)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.weights = "eng/data=2";
+
+  Try<PID<Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Future<Response> response = process::http::get(master.get(), "roles");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response)
+    << response.get().body;
+
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(APPLICATION_JSON, "Content-Type", response);
+
+  Try<JSON::Value> parse = JSON::parse(response.get().body);
+  ASSERT_SOME(parse);
+
+  // Note that the ancestor role "eng" is included even though only
+  // "eng/data" is "interesting" (it has a configured weight).
+  Try<JSON::Value> expected = JSON::parse(
+      "{"
+      "  \"roles\": ["
+      "    {"
+      "      \"frameworks\": [],"
+      "      \"name\": \"*\","
+      "      \"resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
+      "      \"weight\": 1.0"
+      "    },"
+      "    {"
+      "      \"frameworks\": [],"
+      "      \"name\": \"eng\","
+      "      \"resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
       "      \"weight\": 1.0"
+      "    },"
+      "    {"
+      "      \"frameworks\": [],"
+      "      \"name\": \"eng/data\","
+      "      \"resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
+      "      \"subtree_resources\": {"
+      "        \"cpus\": 0,"
+      "        \"disk\": 0,"
+      "        \"mem\":  0"
+      "      },"
+      "      \"weight\": 2.0"
       "    }"
       "  ]"
       "}");
@@ -615,6 +751,8 @@ TEST(RolesTest, Validate)
   EXPECT_NONE(roles::validate("foo-bar"));
   EXPECT_NONE(roles::validate("foo.bar"));
   EXPECT_NONE(roles::validate("foo..bar"));
+  EXPECT_NONE(roles::validate("foo/bar"));
+  EXPECT_NONE(roles::validate("eng/data/batch"));
 
   EXPECT_SOME(roles::validate(""));
   EXPECT_SOME(roles::validate("."));
@@ -622,6 +760,10 @@ TEST(RolesTest, Validate)
   EXPECT_SOME(roles::validate("-foo"));
   EXPECT_SOME(roles::validate("/"));
   EXPECT_SOME(roles::validate("/foo"));
+  EXPECT_SOME(roles::validate("foo/"));
+  EXPECT_SOME(roles::validate("foo//bar"));
+  EXPECT_SOME(roles::validate("foo/./bar"));
+  EXPECT_SOME(roles::validate("foo/-bar"));
   EXPECT_SOME(roles::validate("foo bar"));
   EXPECT_SOME(roles::validate("foo\tbar"));
   EXPECT_SOME(roles::validate("foo\nbar"));
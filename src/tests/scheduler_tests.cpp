@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <deque>
+#include <iostream>
 #include <string>
 #include <queue>
 
@@ -34,9 +36,14 @@
 #include <process/pid.hpp>
 #include <process/queue.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/lambda.hpp>
+#include <stout/recordio.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/try.hpp>
 
+#include "common/http.hpp"
+
 #include "internal/devolve.hpp"
 #include "internal/evolve.hpp"
 
@@ -1230,6 +1237,74 @@ TEST_P(SchedulerTest, Request)
 // TODO(benh): Write test for sending Call::Acknowledgement through
 // master to slave when Event::Update was generated locally.
 
+
+class Scheduler_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<ContentType> {};
+
+
+// The benchmark is parameterized by the content type of the event
+// stream so that the 'application/x-protobuf' and 'application/json'
+// wire formats can be compared.
+INSTANTIATE_TEST_CASE_P(
+    ContentType,
+    Scheduler_BENCHMARK_Test,
+    ::testing::Values(ContentType::PROTOBUF, ContentType::JSON));
+
+
+// Measures the cost of encoding and decoding a v1 event stream,
+// which is where a high-rate framework spends its API-related CPU
+// time.
+TEST_P(Scheduler_BENCHMARK_Test, EventStreamThroughput)
+{
+  const size_t eventCount = 100000;
+
+  ContentType contentType = GetParam();
+
+  // A representative status update event.
+  Event event;
+  event.set_type(Event::UPDATE);
+
+  v1::TaskStatus* status = event.mutable_update()->mutable_status();
+  status->mutable_task_id()->set_value("d2dcbe77-8936-495e-a485-9d1d5a142eb3");
+  status->mutable_agent_id()->set_value("1b325cd0-a681-4e34-b304-ab2b9dcc426b");
+  status->set_state(v1::TASK_RUNNING);
+  status->set_uuid("cf9653a6-7fb8-41de-aee0-a6a3d2a0a207");
+  status->set_message("Reconciliation: Latest task state");
+
+  ::recordio::Encoder<Event> encoder(
+      lambda::bind(serialize, contentType, lambda::_1));
+
+  Stopwatch watch;
+  watch.start();
+
+  string stream;
+  for (size_t i = 0; i < eventCount; i++) {
+    stream += encoder.encode(event);
+  }
+
+  watch.stop();
+
+  std::cout << "Encoded " << eventCount << " events ("
+            << Bytes(stream.size()) << ") as " << contentType << " in "
+            << watch.elapsed() << std::endl;
+
+  ::recordio::Decoder<Event> decoder(
+      lambda::bind(deserialize<Event>, contentType, lambda::_1));
+
+  watch.start();
+
+  Try<std::deque<Try<Event>>> records = decoder.decode(stream);
+
+  watch.stop();
+
+  ASSERT_SOME(records);
+  ASSERT_EQ(eventCount, records.get().size());
+
+  std::cout << "Decoded " << eventCount << " events as " << contentType
+            << " in " << watch.elapsed() << std::endl;
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -2052,6 +2052,12 @@ TEST_F(SlaveTest, ReregisterWithStatusUpdateTaskState)
   Future<ReregisterSlaveMessage> reregisterSlaveMessage =
     FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, _);
 
+  // Intercept the master's request for the full slave state so that
+  // we can install an expectation for the full re-registration before
+  // the slave acts on it.
+  Future<RequestSlaveStateMessage> requestSlaveStateMessage =
+    DROP_PROTOBUF(RequestSlaveStateMessage(), _, _);
+
   // Drop any updates to the failed over master.
   DROP_PROTOBUFS(StatusUpdateMessage(), _, master.get());
 
@@ -2059,9 +2065,26 @@ TEST_F(SlaveTest, ReregisterWithStatusUpdateTaskState)
   // so that the slave will do a re-registration.
   detector.appoint(master.get());
 
-  // Capture and inspect the slave reregistration message.
+  // Since the slave is re-registering with the same master it first
+  // sends only state digests. The master cannot verify them (the
+  // task's status updates were dropped above) and requests the full
+  // slave state.
+  AWAIT_READY(reregisterSlaveMessage);
+
+  EXPECT_TRUE(reregisterSlaveMessage.get().digests_only());
+  EXPECT_EQ(0, reregisterSlaveMessage.get().tasks_size());
+
+  AWAIT_READY(requestSlaveStateMessage);
+
+  reregisterSlaveMessage = FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, _);
+
+  process::post(master.get(), slave.get(), requestSlaveStateMessage.get());
+
+  // Capture and inspect the full slave reregistration message.
   AWAIT_READY(reregisterSlaveMessage);
 
+  EXPECT_FALSE(reregisterSlaveMessage.get().digests_only());
+
   ASSERT_EQ(1, reregisterSlaveMessage.get().tasks_size());
 
   // The latest state of the task should be TASK_FINISHED.
@@ -2085,6 +2108,55 @@ TEST_F(SlaveTest, ReregisterWithStatusUpdateTaskState)
 }
 
 
+// This test ensures that a slave re-registering with the same master
+// instance sends only state digests, and that the master accepts the
+// re-registration directly when the digests match.
+TEST_F(SlaveTest, ReregisterWithMatchingDigests)
+{
+  // Start a master.
+  Try<PID<Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  // Create a StandaloneMasterDetector to enable the slave to trigger
+  // re-registration later.
+  StandaloneMasterDetector detector(master.get());
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  // Start a slave.
+  Try<PID<Slave>> slave = StartSlave(&detector);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  Future<ReregisterSlaveMessage> reregisterSlaveMessage =
+    FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, _);
+
+  Future<RequestSlaveStateMessage> requestSlaveStateMessage =
+    FUTURE_PROTOBUF(RequestSlaveStateMessage(), _, _);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), _, _);
+
+  // Simulate a new master detected event on the slave,
+  // so that the slave will do a re-registration.
+  detector.appoint(master.get());
+
+  AWAIT_READY(reregisterSlaveMessage);
+
+  EXPECT_TRUE(reregisterSlaveMessage.get().digests_only());
+  EXPECT_EQ(0, reregisterSlaveMessage.get().tasks_size());
+
+  // The master verifies the digests and accepts the re-registration
+  // without requesting the full slave state.
+  AWAIT_READY(slaveReregisteredMessage);
+  EXPECT_TRUE(requestSlaveStateMessage.isPending());
+
+  Shutdown();
+}
+
+
 // This test verifies that the slave should properly handle the case
 // where the containerizer usage call fails when getting the usage
 // information.
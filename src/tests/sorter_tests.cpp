@@ -176,6 +176,39 @@ TEST(SorterTest, WDRFSorter)
 }
 
 
+// This test ensures that a share penalty pushes a client down the
+// allocation order and that clearing the penalty restores it.
+TEST(SorterTest, Penalty)
+{
+  DRFSorter sorter;
+
+  SlaveID slaveId;
+  slaveId.set_value("slaveId");
+
+  sorter.add(slaveId, Resources::parse("cpus:100;mem:100").get());
+
+  sorter.add("a");
+  sorter.allocated("a", slaveId, Resources::parse("cpus:5;mem:5").get());
+
+  sorter.add("b");
+  sorter.allocated("b", slaveId, Resources::parse("cpus:6;mem:6").get());
+
+  // shares: a = .05, b = .06
+  EXPECT_EQ(list<string>({"a", "b"}), sorter.sort());
+
+  // Penalizing 'a' makes it sort as if its share were doubled.
+  // shares: a = .05 * 2 = .1, b = .06
+  sorter.penalize("a", 2);
+
+  EXPECT_EQ(list<string>({"b", "a"}), sorter.sort());
+
+  // Clearing the penalty restores the original order.
+  sorter.penalize("a", 1);
+
+  EXPECT_EQ(list<string>({"a", "b"}), sorter.sort());
+}
+
+
 // Some resources are split across multiple resource objects (e.g.
 // persistent volumes). This test ensures that the shares for these
 // are accounted correctly.
@@ -276,6 +309,66 @@ TEST(SorterTest, MultipleSlaves)
   EXPECT_EQ(2u, sorter.allocation("framework").size());
   EXPECT_EQ(slaveResources, sorter.allocation("framework", slaveA));
   EXPECT_EQ(slaveResources, sorter.allocation("framework", slaveB));
+
+  // Scalar resources are aggregated across slaves.
+  EXPECT_EQ(
+      Resources::parse("cpus:4;mem:1024").get(),
+      sorter.allocationScalars("framework"));
+}
+
+
+// Tests the per-slave allocation lookup (used, e.g., to target
+// maintenance inverse offers): only clients with resources on the
+// queried slave are returned, and the slave index is kept in sync
+// as allocations are recovered and clients are removed.
+TEST(SorterTest, AllocationForSlave)
+{
+  DRFSorter sorter;
+
+  SlaveID slaveA;
+  slaveA.set_value("slaveA");
+
+  SlaveID slaveB;
+  slaveB.set_value("slaveB");
+
+  sorter.add("a");
+  sorter.add("b");
+
+  Resources slaveResources = Resources::parse("cpus:2;mem:512").get();
+
+  sorter.add(slaveA, slaveResources);
+  sorter.add(slaveB, slaveResources);
+
+  sorter.allocated("a", slaveA, slaveResources);
+  sorter.allocated("b", slaveA, slaveResources);
+  sorter.allocated("b", slaveB, slaveResources);
+
+  hashmap<string, Resources> allocation = sorter.allocation(slaveA);
+  EXPECT_EQ(2u, allocation.size());
+  EXPECT_EQ(slaveResources, allocation["a"]);
+  EXPECT_EQ(slaveResources, allocation["b"]);
+
+  allocation = sorter.allocation(slaveB);
+  EXPECT_EQ(1u, allocation.size());
+  EXPECT_FALSE(allocation.contains("a"));
+  EXPECT_EQ(slaveResources, allocation["b"]);
+
+  // Recovering a client's whole allocation on a slave removes the
+  // client from that slave's lookup.
+  sorter.unallocated("b", slaveA, slaveResources);
+
+  allocation = sorter.allocation(slaveA);
+  EXPECT_EQ(1u, allocation.size());
+  EXPECT_EQ(slaveResources, allocation["a"]);
+
+  // Removing a client removes it from all slave lookups.
+  sorter.remove("a");
+
+  EXPECT_TRUE(sorter.allocation(slaveA).empty());
+
+  allocation = sorter.allocation(slaveB);
+  EXPECT_EQ(1u, allocation.size());
+  EXPECT_EQ(slaveResources, allocation["b"]);
 }
 
 
@@ -391,6 +391,135 @@ TEST_F(InMemoryStateTest, Names)
 }
 
 
+// Runs the state tests against a caching state to verify that the
+// write-through cache preserves the fetch/store/expunge semantics.
+class CachingStateTest : public ::testing::Test
+{
+public:
+  CachingStateTest()
+    : storage(NULL),
+      state(NULL) {}
+
+protected:
+  virtual void SetUp()
+  {
+    storage = new state::InMemoryStorage();
+    state = new State(storage, true);
+  }
+
+  virtual void TearDown()
+  {
+    delete state;
+    delete storage;
+  }
+
+  state::Storage* storage;
+  State* state;
+};
+
+
+TEST_F(CachingStateTest, FetchAndStoreAndFetch)
+{
+  FetchAndStoreAndFetch(state);
+}
+
+
+TEST_F(CachingStateTest, FetchAndStoreAndStoreAndFetch)
+{
+  FetchAndStoreAndStoreAndFetch(state);
+}
+
+
+TEST_F(CachingStateTest, FetchAndStoreAndStoreFailAndFetch)
+{
+  FetchAndStoreAndStoreFailAndFetch(state);
+}
+
+
+TEST_F(CachingStateTest, FetchAndStoreAndExpungeAndFetch)
+{
+  FetchAndStoreAndExpungeAndFetch(state);
+}
+
+
+TEST_F(CachingStateTest, FetchAndStoreAndExpungeAndExpunge)
+{
+  FetchAndStoreAndExpungeAndExpunge(state);
+}
+
+
+TEST_F(CachingStateTest, FetchAndStoreAndExpungeAndStoreAndFetch)
+{
+  FetchAndStoreAndExpungeAndStoreAndFetch(state);
+}
+
+
+TEST_F(CachingStateTest, Names)
+{
+  Names(state);
+}
+
+
+// Verifies that a store through another (non-caching) state over the
+// same storage invalidates the cached variable: the caching state's
+// store fails the version validation and its next fetch goes back to
+// the storage and observes the other writer's value.
+TEST_F(CachingStateTest, ConflictingWriterInvalidatesCache)
+{
+  State other(storage);
+
+  Future<Variable<Slaves> > future1 = state->fetch<Slaves>("slaves");
+  AWAIT_READY(future1);
+
+  Variable<Slaves> variable1 = future1.get();
+
+  Slaves slaves1 = variable1.get();
+  ASSERT_EQ(0, slaves1.slaves().size());
+
+  Slave* slave1 = slaves1.add_slaves();
+  slave1->mutable_info()->set_hostname("localhost1");
+
+  Future<Option<Variable<Slaves> > > future2 =
+    state->store(variable1.mutate(slaves1));
+  AWAIT_READY(future2);
+  ASSERT_SOME(future2.get());
+
+  variable1 = future2.get().get();
+
+  // Store through the other state, bypassing the cache.
+  future1 = other.fetch<Slaves>("slaves");
+  AWAIT_READY(future1);
+
+  Variable<Slaves> variable2 = future1.get();
+
+  Slaves slaves2 = variable2.get();
+  ASSERT_EQ(1, slaves2.slaves().size());
+
+  slaves2.mutable_slaves(0)->mutable_info()->set_hostname("localhost2");
+
+  future2 = other.store(variable2.mutate(slaves2));
+  AWAIT_READY(future2);
+  ASSERT_SOME(future2.get());
+
+  // The caching state's store is now based on a stale version and
+  // must fail, invalidating the cached variable.
+  slaves1 = variable1.get();
+  slaves1.mutable_slaves(0)->mutable_info()->set_hostname("localhost3");
+
+  future2 = state->store(variable1.mutate(slaves1));
+  AWAIT_READY(future2);
+  EXPECT_TRUE(future2.get().isNone());
+
+  // The next fetch observes the other writer's value.
+  future1 = state->fetch<Slaves>("slaves");
+  AWAIT_READY(future1);
+
+  Slaves slaves3 = future1.get().get();
+  ASSERT_EQ(1, slaves3.slaves().size());
+  EXPECT_EQ("localhost2", slaves3.slaves(0).info().hostname());
+}
+
+
 class LevelDBStateTest : public ::testing::Test
 {
 public:
@@ -755,6 +884,48 @@ TEST_F(ZooKeeperStateTest, Names)
 {
   Names(state);
 }
+
+
+// Tests that a value too large for a single znode gets split across
+// chunk znodes and reassembled on fetch, and that the chunks znode
+// does not show up in names().
+TEST_F(ZooKeeperStateTest, FetchAndStoreChunkedAndFetch)
+{
+  Future<Variable<Slaves> > future1 = state->fetch<Slaves>("slaves");
+  AWAIT_READY(future1);
+
+  Variable<Slaves> variable = future1.get();
+
+  Slaves slaves1 = variable.get();
+  ASSERT_EQ(0, slaves1.slaves().size());
+
+  // Large enough that the serialized entry exceeds the 1 MB znode
+  // limit and must be chunked.
+  const string hostname(3 * 1024 * 1024, 'x');
+
+  Slave* slave = slaves1.add_slaves();
+  slave->mutable_info()->set_hostname(hostname);
+
+  variable = variable.mutate(slaves1);
+
+  Future<Option<Variable<Slaves> > > future2 = state->store(variable);
+  AWAIT_READY(future2);
+  ASSERT_SOME(future2.get());
+
+  future1 = state->fetch<Slaves>("slaves");
+  AWAIT_READY(future1);
+
+  variable = future1.get();
+
+  Slaves slaves2 = variable.get();
+  ASSERT_EQ(1, slaves2.slaves().size());
+  EXPECT_EQ(hostname, slaves2.slaves(0).info().hostname());
+
+  Future<set<string> > names = state->names();
+  AWAIT_READY(names);
+  ASSERT_EQ(1u, names.get().size());
+  EXPECT_NE(names.get().find("slaves"), names.get().end());
+}
 #endif // MESOS_HAS_JAVA
 
 } // namespace tests {
@@ -55,8 +55,12 @@ using std::vector;
 
 namespace zookeeper {
 
-// Time to wait after retryable errors.
-const Duration GroupProcess::RETRY_INTERVAL = Seconds(2);
+// Time to wait after retryable errors. We start low and back off
+// exponentially (see 'retry') so that transient errors during
+// ZooKeeper churn are recovered from in hundreds of milliseconds
+// (e.g., leader detection after a master failover), while persistent
+// errors quickly back off to multi-second retries.
+const Duration GroupProcess::RETRY_INTERVAL = Milliseconds(250);
 
 
 // Helper for failing a queue of promises.